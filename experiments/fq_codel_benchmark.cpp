@@ -0,0 +1,481 @@
+// Benchmark: ping latency during a saturating download, drop-tail FIFO versus
+// FQ-CoDel.
+//
+// A simulated 20 Mbit/s bottleneck (the tunnel's send side) carries four TCP-like bulk
+// flows with 20 ms of base RTT: each keeps a congestion window of full packets in
+// flight, grows it by one packet per RTT and halves it once per RTT on loss, as Reno
+// does. A ping (84 bytes) goes through the same queue every 100 ms. The queue is one
+// of:
+//   fifo     - one queue dropping arrivals past 512 KB, the old session backlog
+//   fq-codel - FqCodelQueue with the default 5 ms target and 100 ms interval
+//   session  - SendScheduler as TransportSession uses it (classes over FQ-CoDel)
+// The table shows the ping RTT percentiles, the time bulk packets wait in the queue,
+// and the bulk goodput. Under FIFO the bulk flows fill the whole buffer and the ping
+// waits behind it (bufferbloat); FQ-CoDel should hold the ping near the base RTT and
+// the bulk queue near target while the link stays busy.
+//
+// The last rows run the same flows, sized to the session's max_payload_size() as the
+// TUN MTU would be, through a client and server TransportSession in the default
+// configuration (datagram mode negotiated, departures from pace_packet()) to a
+// drop-tail router buffer of kRouterBuffer at the bottleneck:
+//   tunnel   - datagram loss feedback, the default: the session's window bounds what
+//              is in flight and the excess waits in its SendScheduler
+//   no-fb    - datagram_loss_feedback off on the receiver, as the default was: nothing
+//              governs datagrams and the backlog forms in the router
+// Bulk queue there is the one-way delay less the base. The window is loss-based, so it
+// still grows until the router drops: with the bottleneck outside the tunnel the ping
+// waits behind the router buffer either way, and the scheduler only holds the bursts
+// past a congestion event (the count under each row).
+//
+// Build: cmake -DVEIL_BUILD_EXPERIMENTS=ON, target fq_codel_benchmark
+// Run: ./fq_codel_benchmark
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <vector>
+
+#include "common/handshake/handshake_processor.h"
+#include "common/logging/logger.h"
+#include "common/utils/rate_limiter.h"
+#include "transport/mux/ack_scheduler.h"
+#include "transport/mux/fq_codel.h"
+#include "transport/mux/payload_compression.h"
+#include "transport/mux/send_scheduler.h"
+#include "transport/session/transport_session.h"
+
+using namespace veil;
+
+namespace {
+
+constexpr double kLinkBitsPerSecond = 20e6;
+constexpr double kBaseRtt = 0.020;
+constexpr double kPingInterval = 0.100;
+constexpr double kDuration = 60.0;
+// Leave out the first seconds, while the flows first ramp up.
+constexpr double kWarmup = 5.0;
+constexpr int kBulkFlows = 4;
+constexpr int kPingFlow = kBulkFlows;
+constexpr std::size_t kBulkSize = 1400;
+constexpr std::size_t kPingSize = 84;
+constexpr std::size_t kFifoLimit = 512 * 1024;
+constexpr std::size_t kRouterBuffer = 256 * 1024;
+constexpr double kStep = 0.00005;
+
+using TimePoint = mux::FqCodelQueue::TimePoint;
+
+TimePoint at(double seconds) {
+  return TimePoint{} + std::chrono::duration_cast<TimePoint::duration>(
+                           std::chrono::duration<double>(1.0 + seconds));
+}
+
+// IPv4 TCP (bulk) or ICMP (ping) packet; the flow and its sequence number follow the
+// header, then the time it was queued in microseconds.
+std::vector<std::uint8_t> ip_packet(int flow, std::uint32_t seq, std::size_t size, double now) {
+  std::vector<std::uint8_t> packet(size, 0);
+  packet[0] = 0x45;
+  packet[9] = flow == kPingFlow ? 1 : 6;
+  packet[12] = 10;
+  packet[15] = 2;
+  packet[16] = 93;
+  packet[19] = 1;
+  packet[20] = 0x01;
+  packet[21] = 0xBB;
+  packet[22] = 0xC0;
+  packet[23] = static_cast<std::uint8_t>(flow);
+  packet[24] = static_cast<std::uint8_t>(flow);
+  const auto micros = static_cast<std::uint64_t>(now * 1e6);
+  for (std::size_t i = 0; i < 4; ++i) {
+    packet[25 + i] = static_cast<std::uint8_t>(seq >> (8 * i));
+  }
+  for (std::size_t i = 0; i < 8; ++i) {
+    packet[29 + i] = static_cast<std::uint8_t>(micros >> (8 * i));
+  }
+  return packet;
+}
+
+double queued_at(const std::vector<std::uint8_t>& packet) {
+  std::uint64_t micros = 0;
+  for (std::size_t i = 0; i < 8; ++i) {
+    micros |= static_cast<std::uint64_t>(packet[29 + i]) << (8 * i);
+  }
+  return static_cast<double>(micros) / 1e6;
+}
+
+int flow_of(const std::vector<std::uint8_t>& packet) { return packet[24]; }
+
+std::uint32_t seq_of(const std::vector<std::uint8_t>& packet) {
+  std::uint32_t seq = 0;
+  for (std::size_t i = 0; i < 4; ++i) {
+    seq |= static_cast<std::uint32_t>(packet[25 + i]) << (8 * i);
+  }
+  return seq;
+}
+
+class Fifo {
+ public:
+  void enqueue(std::vector<std::uint8_t> packet, double) {
+    if (bytes_ + packet.size() > kFifoLimit) {
+      return;
+    }
+    bytes_ += packet.size();
+    queue_.push_back(std::move(packet));
+  }
+  std::optional<std::vector<std::uint8_t>> dequeue(double) {
+    if (queue_.empty()) {
+      return std::nullopt;
+    }
+    auto packet = std::move(queue_.front());
+    queue_.pop_front();
+    bytes_ -= packet.size();
+    return packet;
+  }
+
+ private:
+  std::deque<std::vector<std::uint8_t>> queue_;
+  std::size_t bytes_{0};
+};
+
+class FqCodel {
+ public:
+  void enqueue(std::vector<std::uint8_t> packet, double now) {
+    const auto flow = mux::ip_flow_id(packet);
+    queue_.enqueue(flow, std::move(packet), at(now));
+  }
+  std::optional<std::vector<std::uint8_t>> dequeue(double now) { return queue_.dequeue(at(now)); }
+
+ private:
+  mux::FqCodelQueue queue_;
+};
+
+class Session {
+ public:
+  void enqueue(std::vector<std::uint8_t> packet, double now) {
+    now_ = now;
+    const auto traffic_class =
+        mux::classify_ip_packet(packet, mux::SendSchedulerConfig{}.small_packet_size);
+    scheduler_.enqueue(traffic_class, std::move(packet));
+  }
+  std::optional<std::vector<std::uint8_t>> dequeue(double now) {
+    now_ = now;
+    return scheduler_.dequeue();
+  }
+
+ private:
+  double now_{0};
+  mux::SendScheduler scheduler_{{}, [this] { return at(now_); }};
+};
+
+struct Flow {
+  double cwnd{2};
+  std::uint32_t in_flight{0};
+  std::uint32_t next_seq{0};
+  // Next sequence number the receiver expects.
+  std::uint32_t expected{0};
+  double recovery_until{0};
+};
+
+// An acknowledgment on its way back: the packets it covers, lost ones included.
+struct Ack {
+  double arrives_at;
+  int flow;
+  std::uint32_t covered;
+  bool loss;
+};
+
+template <typename Queue>
+void run(const char* name) {
+  Queue queue;
+  std::vector<Flow> flows(kBulkFlows);
+  std::deque<Ack> acks;
+  std::vector<double> rtts;
+  std::vector<double> bulk_delays;
+  std::uint32_t pings = 0;
+  std::uint64_t delivered_bytes = 0;
+  double link_free_at = 0;
+  double next_ping = 0;
+
+  for (double now = 0; now < kDuration; now += kStep) {
+    while (!acks.empty() && acks.front().arrives_at <= now) {
+      const auto ack = acks.front();
+      acks.pop_front();
+      auto& flow = flows[static_cast<std::size_t>(ack.flow)];
+      flow.in_flight -= ack.covered;
+      if (ack.loss && now >= flow.recovery_until) {
+        flow.cwnd = std::max(2.0, flow.cwnd / 2);
+        flow.recovery_until = now + kBaseRtt;
+      } else {
+        flow.cwnd += 1.0 / flow.cwnd;
+      }
+    }
+
+    for (int f = 0; f < kBulkFlows; ++f) {
+      auto& flow = flows[static_cast<std::size_t>(f)];
+      while (flow.in_flight < static_cast<std::uint32_t>(flow.cwnd)) {
+        queue.enqueue(ip_packet(f, flow.next_seq++, kBulkSize, now), now);
+        ++flow.in_flight;
+      }
+    }
+    if (now >= next_ping) {
+      queue.enqueue(ip_packet(kPingFlow, pings++, kPingSize, now), now);
+      next_ping += kPingInterval;
+    }
+
+    if (now < link_free_at) {
+      continue;
+    }
+    auto packet = queue.dequeue(now);
+    if (!packet) {
+      continue;
+    }
+    link_free_at = now + static_cast<double>(packet->size() * 8) / kLinkBitsPerSecond;
+    const int f = flow_of(*packet);
+    const double sent = queued_at(*packet);
+    if (f == kPingFlow) {
+      if (sent >= kWarmup) {
+        rtts.push_back((link_free_at - sent + kBaseRtt) * 1000.0);
+      }
+      continue;
+    }
+    if (sent >= kWarmup) {
+      bulk_delays.push_back((now - sent) * 1000.0);
+    }
+    // The receiver acknowledges up to this packet; a gap before it is loss.
+    auto& flow = flows[static_cast<std::size_t>(f)];
+    const auto seq = seq_of(*packet);
+    acks.push_back(Ack{link_free_at + kBaseRtt, f, seq + 1 - flow.expected, seq != flow.expected});
+    flow.expected = seq + 1;
+    if (now >= kWarmup) {
+      delivered_bytes += packet->size();
+    }
+  }
+
+  const auto percentile = [](std::vector<double>& values, double p) {
+    std::sort(values.begin(), values.end());
+    return values[static_cast<std::size_t>(p * static_cast<double>(values.size() - 1))];
+  };
+  std::cout << std::left << std::setw(10) << name << std::fixed << std::setprecision(1)
+            << std::setw(12) << percentile(rtts, 0.5) << std::setw(12) << percentile(rtts, 0.99)
+            << std::setw(12) << rtts.back() << std::setw(16) << percentile(bulk_delays, 0.99)
+            << std::setw(12)
+            << static_cast<double>(delivered_bytes * 8) / (kDuration - kWarmup) / 1e6 << "\n";
+}
+
+std::optional<std::pair<handshake::HandshakeSession, handshake::HandshakeSession>> handshake_pair() {
+  using namespace std::chrono_literals;
+  const std::vector<std::uint8_t> psk(32, 0xAB);
+  handshake::HandshakeInitiator initiator(psk, 5000ms);
+  handshake::HandshakeResponder responder(psk, 5000ms, utils::TokenBucket(1e9, 1ms));
+  auto response = responder.handle_init(initiator.create_init());
+  if (!response) {
+    return std::nullopt;
+  }
+  auto client = initiator.consume_response(response->response);
+  if (!client) {
+    return std::nullopt;
+  }
+  return std::make_pair(*client, response->session);
+}
+
+// An encrypted packet on its way: when it arrives and its bytes.
+struct Wire {
+  double arrives_at;
+  std::vector<std::uint8_t> bytes;
+};
+
+void run_tunnel(const char* name, bool loss_feedback) {
+  auto sessions = handshake_pair();
+  if (!sessions) {
+    std::cerr << "handshake failed\n";
+    return;
+  }
+  double now = 0;
+  auto now_fn = [&now] { return at(now); };
+  transport::TransportSessionConfig server_config;
+  server_config.datagram_loss_feedback = loss_feedback;
+  transport::TransportSession client(sessions->first, {}, now_fn);
+  transport::TransportSession server(sessions->second, server_config, now_fn);
+  mux::AckScheduler server_acks({}, now_fn);
+
+  // Negotiate, as the first packets of a connection would.
+  for (auto* side : {&client, &server}) {
+    auto* peer = side == &client ? &server : &client;
+    for (auto offer : {side->take_datagram_mode_frame(), side->take_frame_packing_frame(),
+                       side->take_ack_ranges_frame()}) {
+      if (offer) {
+        peer->decrypt_packet(side->encrypt_frame(*offer));
+      }
+    }
+  }
+  const auto bulk_size = client.max_payload_size();
+  const double one_way = kBaseRtt / 2;
+
+  std::vector<Flow> flows(kBulkFlows);
+  std::deque<Ack> acks;
+  std::deque<Wire> uplink;
+  std::deque<Wire> downlink;
+  // Departure times from the router queue, and the bytes it holds.
+  std::deque<std::pair<double, std::size_t>> router;
+  std::size_t router_bytes = 0;
+  double link_free_at = 0;
+  std::vector<double> rtts;
+  std::vector<double> bulk_delays;
+  std::uint32_t pings = 0;
+  std::uint64_t delivered_bytes = 0;
+  double next_ping = 0;
+
+  const auto send_up = [&](std::vector<std::vector<std::uint8_t>> packets) {
+    for (auto& packet : packets) {
+      const double departs = std::max(
+          now, std::chrono::duration<double>(client.pace_packet(packet.size()) - at(0)).count());
+      while (!router.empty() && router.front().first <= departs) {
+        router_bytes -= router.front().second;
+        router.pop_front();
+      }
+      if (router_bytes + packet.size() > kRouterBuffer) {
+        continue;
+      }
+      link_free_at = std::max(link_free_at, departs) +
+                     static_cast<double>(packet.size() * 8) / kLinkBitsPerSecond;
+      router_bytes += packet.size();
+      router.emplace_back(link_free_at, packet.size());
+      uplink.push_back(Wire{link_free_at + one_way, std::move(packet)});
+    }
+  };
+  const auto send_ack = [&](std::uint64_t stream_id) {
+    if (auto ranges = server_acks.get_pending_ack_ranges(stream_id)) {
+      auto packets = server.queue_frame(mux::make_ack_ranges_frame(*ranges));
+      for (auto& packet : server.flush_packed()) {
+        packets.push_back(std::move(packet));
+      }
+      for (auto& packet : packets) {
+        downlink.push_back(Wire{now + one_way, std::move(packet)});
+      }
+    }
+    server_acks.ack_sent(stream_id);
+  };
+
+  for (; now < kDuration; now += kStep) {
+    while (!acks.empty() && acks.front().arrives_at <= now) {
+      const auto ack = acks.front();
+      acks.pop_front();
+      auto& flow = flows[static_cast<std::size_t>(ack.flow)];
+      flow.in_flight -= ack.covered;
+      if (ack.loss && now >= flow.recovery_until) {
+        flow.cwnd = std::max(2.0, flow.cwnd / 2);
+        flow.recovery_until = now + kBaseRtt;
+      } else {
+        flow.cwnd += 1.0 / flow.cwnd;
+      }
+    }
+
+    // The inner stack stops writing while the session pushes back.
+    if (!client.send_backlogged()) {
+      for (int f = 0; f < kBulkFlows; ++f) {
+        auto& flow = flows[static_cast<std::size_t>(f)];
+        while (flow.in_flight < static_cast<std::uint32_t>(flow.cwnd)) {
+          send_up(client.queue_ip_packet(ip_packet(f, flow.next_seq++, bulk_size, now)));
+          ++flow.in_flight;
+        }
+      }
+    }
+    if (now >= next_ping) {
+      send_up(client.queue_ip_packet(ip_packet(kPingFlow, pings++, kPingSize, now)));
+      next_ping += kPingInterval;
+    }
+    send_up(client.flush_packed());
+
+    while (!uplink.empty() && uplink.front().arrives_at <= now) {
+      auto frames = server.decrypt_packet(uplink.front().bytes);
+      uplink.pop_front();
+      if (!frames) {
+        continue;
+      }
+      for (const auto& frame : *frames) {
+        if (frame.kind != mux::FrameKind::kDatagram) {
+          continue;
+        }
+        if (loss_feedback &&
+            server_acks.on_packet_received(mux::kDatagramStreamId, frame.datagram.sequence)) {
+          send_ack(mux::kDatagramStreamId);
+        }
+        const auto& packet = frame.datagram.payload;
+        const int f = flow_of(packet);
+        const double sent = queued_at(packet);
+        if (f == kPingFlow) {
+          if (sent >= kWarmup) {
+            rtts.push_back((now - sent + one_way) * 1000.0);
+          }
+          continue;
+        }
+        if (sent >= kWarmup) {
+          bulk_delays.push_back((now - sent - one_way) * 1000.0);
+        }
+        // As run(): the receiver acknowledges up to this packet; a gap is loss.
+        auto& flow = flows[static_cast<std::size_t>(f)];
+        const auto seq = seq_of(packet);
+        acks.push_back(Ack{now + one_way, f, seq + 1 - flow.expected, seq != flow.expected});
+        flow.expected = seq + 1;
+        if (now >= kWarmup) {
+          delivered_bytes += packet.size();
+        }
+      }
+    }
+    if (const auto stream_id = server_acks.check_ack_timer()) {
+      send_ack(*stream_id);
+    }
+
+    while (!downlink.empty() && downlink.front().arrives_at <= now) {
+      auto frames = client.decrypt_packet(downlink.front().bytes);
+      downlink.pop_front();
+      if (!frames) {
+        continue;
+      }
+      for (const auto& frame : *frames) {
+        if (frame.kind == mux::FrameKind::kAckRanges) {
+          client.process_ack(frame.ack_ranges);
+        }
+      }
+    }
+  }
+
+  const auto percentile = [](std::vector<double>& values, double p) {
+    std::sort(values.begin(), values.end());
+    return values[static_cast<std::size_t>(p * static_cast<double>(values.size() - 1))];
+  };
+  std::cout << std::left << std::setw(10) << name << std::fixed << std::setprecision(1)
+            << std::setw(12) << percentile(rtts, 0.5) << std::setw(12) << percentile(rtts, 0.99)
+            << std::setw(12) << rtts.back() << std::setw(16) << percentile(bulk_delays, 0.99)
+            << std::setw(12)
+            << static_cast<double>(delivered_bytes * 8) / (kDuration - kWarmup) / 1e6 << "\n";
+  std::uint64_t held = 0;
+  for (const auto packets : client.send_scheduler_stats().packets_queued) {
+    held += packets;
+  }
+  std::cout << "          " << held << " of " << client.stats().datagrams_sent
+            << " datagrams held by the window, " << client.stats().datagrams_lost
+            << " reported lost\n";
+}
+
+}  // namespace
+
+int main() {
+  logging::configure_logging(logging::LogLevel::off, false);
+
+  std::cout << "Ping during " << kBulkFlows << " bulk flows at " << kLinkBitsPerSecond / 1e6
+            << " Mbit/s, base RTT " << kBaseRtt * 1000 << " ms, " << kDuration << " s\n";
+  std::cout << std::left << std::setw(10) << "queue" << std::setw(12) << "p50 ms" << std::setw(12)
+            << "p99 ms" << std::setw(12) << "max ms" << std::setw(16) << "bulk queue p99"
+            << "bulk Mbit/s\n";
+  run<Fifo>("fifo");
+  run<FqCodel>("fq-codel");
+  run<Session>("session");
+  std::cout << "Through TransportSession, router buffer " << kRouterBuffer / 1024 << " KB\n";
+  run_tunnel("tunnel", true);
+  run_tunnel("no-fb", false);
+  return 0;
+}
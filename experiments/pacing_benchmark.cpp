@@ -0,0 +1,345 @@
+// Benchmark: loss at a shallow bottleneck buffer from send-loop bursts, unpaced versus
+// the pacing calendar, with and without kernel pacing (SO_TXTIME).
+//
+// A sender produces 80 Mbit/s of 1400-byte packets towards a 100 Mbit/s bottleneck
+// with a 32 KB buffer, over a 1 Gbit/s access link. The send loop is one of:
+//   10ms-loop - wakes every 10 ms and sends what was produced meanwhile (poll timeout
+//               without pacing), so each wake-up is a 10 ms burst at access speed
+//   calendar  - departures stamped at the pacing rate (1.25x, as pace_packet()),
+//               released up to release_ahead early; the loop wakes for the next
+//               release at millisecond granularity
+//   txtime    - the same calendar, with each packet leaving at its departure time, as
+//               the fq qdisc does with SO_TXTIME
+// The table shows the packets dropped at the bottleneck, its peak queue, and the loop
+// wake-ups (batches handed to the socket).
+//
+// The last rows send the same traffic, as IP packets of the session's
+// max_payload_size(), through a client and server TransportSession in the default
+// configuration with 20 ms of base RTT. Departures come from pace_packet() through the
+// calendar (no SO_TXTIME) and the loop also wakes when an ACK arrives:
+//   session  - datagram loss feedback, the default: the server acknowledges datagrams
+//              and the pacing rate follows the window and the RTT they give
+//   no-fb    - datagram_loss_feedback off on the receiver: no rate, so departures
+//              are not paced and go out as the 10 ms loop produced them
+//
+// Build: cmake -DVEIL_BUILD_EXPERIMENTS=ON, target pacing_benchmark
+// Run: ./pacing_benchmark
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "common/handshake/handshake_processor.h"
+#include "common/logging/logger.h"
+#include "common/utils/rate_limiter.h"
+#include "transport/mux/ack_scheduler.h"
+#include "transport/session/transport_session.h"
+#include "transport/udp_socket/pacing_calendar.h"
+
+using namespace veil;
+
+namespace {
+
+using namespace std::chrono_literals;
+using TimePoint = transport::PacingCalendar::TimePoint;
+using Duration = std::chrono::nanoseconds;
+
+constexpr double kAppBitsPerSecond = 80e6;
+constexpr double kPacingGain = 1.25;
+constexpr double kBottleneckBitsPerSecond = 100e6;
+constexpr double kAccessBitsPerSecond = 1e9;
+constexpr std::size_t kBottleneckBuffer = 32 * 1024;
+constexpr std::size_t kPacketSize = 1400;
+constexpr std::size_t kMaxBurst = 10;
+constexpr auto kDuration = 10s;
+// Time one loop iteration takes when poll() returns at once.
+constexpr auto kLoopCost = 20us;
+constexpr auto kBaseRtt = 20ms;
+
+enum class Mode { kLoop10ms, kCalendar, kTxtime };
+
+Duration serialization(double bits_per_second, std::size_t bytes = kPacketSize) {
+  return Duration(
+      static_cast<std::int64_t>(static_cast<double>(bytes * 8) * 1e9 / bits_per_second));
+}
+
+// Drop-tail bottleneck: packets arrive at given times and drain at the bottleneck rate.
+class Bottleneck {
+ public:
+  // When the packet has left the bottleneck, or nullopt if it was dropped.
+  std::optional<TimePoint> arrive(TimePoint at, std::size_t bytes = kPacketSize) {
+    // Drain what left since the last arrival.
+    while (!queue_.empty() && queue_.front().first <= at) {
+      queued_bytes_ -= queue_.front().second;
+      queue_.pop_front();
+    }
+    if (queued_bytes_ + bytes > kBottleneckBuffer) {
+      ++dropped_;
+      return std::nullopt;
+    }
+    const auto start = queue_.empty() ? at : std::max(at, queue_.back().first);
+    queue_.emplace_back(start + serialization(kBottleneckBitsPerSecond, bytes), bytes);
+    queued_bytes_ += bytes;
+    peak_ = std::max(peak_, queued_bytes_);
+    ++delivered_;
+    return queue_.back().first;
+  }
+  std::uint64_t dropped() const { return dropped_; }
+  std::uint64_t delivered() const { return delivered_; }
+  std::size_t peak() const { return peak_; }
+
+ private:
+  // Time each queued packet finishes leaving the bottleneck, and its size.
+  std::deque<std::pair<TimePoint, std::size_t>> queue_;
+  std::size_t queued_bytes_{0};
+  std::uint64_t dropped_{0};
+  std::uint64_t delivered_{0};
+  std::size_t peak_{0};
+};
+
+void print_row(const char* name, const Bottleneck& bottleneck, std::uint64_t wakeups) {
+  const auto sent = bottleneck.delivered() + bottleneck.dropped();
+  std::cout << std::left << std::setw(12) << name << std::setw(10) << sent << std::fixed
+            << std::setprecision(2) << std::setw(10)
+            << 100.0 * static_cast<double>(bottleneck.dropped()) / static_cast<double>(sent)
+            << std::setprecision(1) << std::setw(16)
+            << static_cast<double>(bottleneck.peak()) / 1024.0 << wakeups << "\n";
+}
+
+void run(const char* name, Mode mode) {
+  const TimePoint start = TimePoint{} + 1s;
+  const auto produce_gap = serialization(kAppBitsPerSecond);
+  const auto pace_gap = serialization(kAppBitsPerSecond * kPacingGain);
+  const auto access_gap = serialization(kAccessBitsPerSecond);
+
+  transport::PacingCalendar calendar;
+  Bottleneck bottleneck;
+  std::vector<transport::UdpPacket> batch;
+  TimePoint produced_until = start;
+  TimePoint next_departure = start;
+  TimePoint access_free = start;
+  std::uint64_t wakeups = 0;
+
+  for (TimePoint now = start; now < start + kDuration;) {
+    ++wakeups;
+    // Packets the application wrote since the last wake-up (read from the TUN).
+    std::size_t produced = 0;
+    for (; produced_until + produce_gap <= now; produced_until += produce_gap) {
+      ++produced;
+    }
+
+    batch.clear();
+    if (mode == Mode::kLoop10ms) {
+      batch.resize(produced);
+    } else {
+      for (std::size_t i = 0; i < produced; ++i) {
+        next_departure =
+            std::max(next_departure, now - pace_gap * static_cast<std::int64_t>(kMaxBurst));
+        transport::UdpPacket packet;
+        packet.send_at = std::max(next_departure, now);
+        next_departure += pace_gap;
+        calendar.schedule(std::move(packet));
+      }
+      calendar.release(now, batch);
+    }
+
+    // The batch leaves back to back at access speed, or at its departure times.
+    for (const auto& packet : batch) {
+      auto leaves = std::max(access_free, now);
+      if (mode == Mode::kTxtime) {
+        leaves = std::max(leaves, packet.send_at);
+      }
+      access_free = leaves + access_gap;
+      bottleneck.arrive(access_free);
+    }
+
+    Duration wait = 10ms;
+    if (mode != Mode::kLoop10ms) {
+      if (const auto until = calendar.time_until_release(now)) {
+        wait = std::min<Duration>(wait, std::chrono::ceil<std::chrono::milliseconds>(*until));
+      }
+    }
+    now += std::max<Duration>(wait, kLoopCost);
+  }
+
+  print_row(name, bottleneck, wakeups);
+}
+
+std::optional<std::pair<handshake::HandshakeSession, handshake::HandshakeSession>> handshake_pair() {
+  const std::vector<std::uint8_t> psk(32, 0xAB);
+  handshake::HandshakeInitiator initiator(psk, 5000ms);
+  handshake::HandshakeResponder responder(psk, 5000ms, utils::TokenBucket(1e9, 1ms));
+  auto response = responder.handle_init(initiator.create_init());
+  if (!response) {
+    return std::nullopt;
+  }
+  auto client = initiator.consume_response(response->response);
+  if (!client) {
+    return std::nullopt;
+  }
+  return std::make_pair(*client, response->session);
+}
+
+// An encrypted packet on its way: when it arrives and its bytes.
+struct Wire {
+  TimePoint arrives_at;
+  std::vector<std::uint8_t> bytes;
+};
+
+void run_session(const char* name, bool loss_feedback) {
+  auto sessions = handshake_pair();
+  if (!sessions) {
+    std::cerr << "handshake failed\n";
+    return;
+  }
+  const TimePoint start = TimePoint{} + 1s;
+  // The two ends have their own clocks: the server handles each packet as it arrives,
+  // the client only when its loop wakes up.
+  TimePoint now = start;
+  TimePoint server_now = start;
+  transport::TransportSessionConfig server_config;
+  server_config.datagram_loss_feedback = loss_feedback;
+  transport::TransportSession client(sessions->first, {}, [&now] { return now; });
+  transport::TransportSession server(sessions->second, server_config,
+                                     [&server_now] { return server_now; });
+  mux::AckScheduler server_acks({}, [&server_now] { return server_now; });
+
+  // Negotiate, as the first packets of a connection would.
+  for (auto* side : {&client, &server}) {
+    auto* peer = side == &client ? &server : &client;
+    for (auto offer : {side->take_datagram_mode_frame(), side->take_frame_packing_frame(),
+                       side->take_ack_ranges_frame()}) {
+      if (offer) {
+        peer->decrypt_packet(side->encrypt_frame(*offer));
+      }
+    }
+  }
+  std::vector<std::uint8_t> ip_packet(client.max_payload_size(), 0);
+  ip_packet[0] = 0x45;
+  ip_packet[9] = 17;
+  const auto produce_gap = serialization(kAppBitsPerSecond, ip_packet.size());
+  const auto access_bytes = [](std::size_t bytes) {
+    return serialization(kAccessBitsPerSecond, bytes);
+  };
+  const auto one_way = kBaseRtt / 2;
+
+  transport::PacingCalendar calendar;
+  Bottleneck bottleneck;
+  std::vector<transport::UdpPacket> batch;
+  std::deque<Wire> uplink;
+  std::deque<Wire> downlink;
+  TimePoint produced_until = start;
+  TimePoint access_free = start;
+  std::uint64_t wakeups = 0;
+
+  const auto schedule = [&](std::vector<std::vector<std::uint8_t>> packets) {
+    for (auto& data : packets) {
+      transport::UdpPacket packet;
+      packet.send_at = std::max(client.pace_packet(data.size()), now);
+      packet.data = std::move(data);
+      calendar.schedule(std::move(packet));
+    }
+  };
+  const auto send_ack = [&](std::uint64_t stream_id) {
+    if (auto ranges = server_acks.get_pending_ack_ranges(stream_id)) {
+      auto packets = server.queue_frame(mux::make_ack_ranges_frame(*ranges));
+      for (auto& packet : server.flush_packed()) {
+        packets.push_back(std::move(packet));
+      }
+      for (auto& packet : packets) {
+        downlink.push_back(Wire{server_now + one_way, std::move(packet)});
+      }
+    }
+    server_acks.ack_sent(stream_id);
+  };
+
+  for (; now < start + kDuration;) {
+    ++wakeups;
+    // Server side: the packets that arrived by now, each at its own time.
+    while (!uplink.empty() && uplink.front().arrives_at <= now) {
+      server_now = uplink.front().arrives_at;
+      auto frames = server.decrypt_packet(uplink.front().bytes);
+      uplink.pop_front();
+      if (!frames) {
+        continue;
+      }
+      for (const auto& frame : *frames) {
+        if (frame.kind == mux::FrameKind::kDatagram && loss_feedback &&
+            server_acks.on_packet_received(mux::kDatagramStreamId, frame.datagram.sequence)) {
+          send_ack(mux::kDatagramStreamId);
+        }
+      }
+    }
+    server_now = now;
+    if (const auto stream_id = server_acks.check_ack_timer()) {
+      send_ack(*stream_id);
+    }
+
+    while (!downlink.empty() && downlink.front().arrives_at <= now) {
+      auto frames = client.decrypt_packet(downlink.front().bytes);
+      downlink.pop_front();
+      if (!frames) {
+        continue;
+      }
+      for (const auto& frame : *frames) {
+        if (frame.kind == mux::FrameKind::kAckRanges) {
+          client.process_ack(frame.ack_ranges);
+        }
+      }
+    }
+
+    // The inner stack stops writing while the session pushes back; what it produced
+    // meanwhile waits for the next wake-up.
+    if (!client.send_backlogged()) {
+      for (; produced_until + produce_gap <= now; produced_until += produce_gap) {
+        schedule(client.queue_ip_packet(ip_packet));
+      }
+    }
+    schedule(client.flush_packed());
+
+    batch.clear();
+    calendar.release(now, batch);
+    for (auto& packet : batch) {
+      access_free = std::max(access_free, now) + access_bytes(packet.data.size());
+      if (const auto leaves = bottleneck.arrive(access_free, packet.data.size())) {
+        uplink.push_back(Wire{*leaves + one_way, std::move(packet.data)});
+      }
+    }
+
+    Duration wait = 10ms;
+    if (const auto until = calendar.time_until_release(now)) {
+      wait = std::min<Duration>(wait, std::chrono::ceil<std::chrono::milliseconds>(*until));
+    }
+    if (!downlink.empty()) {
+      wait = std::min<Duration>(wait, downlink.front().arrives_at - now);
+    }
+    now += std::max<Duration>(wait, kLoopCost);
+  }
+
+  print_row(name, bottleneck, wakeups);
+}
+
+}  // namespace
+
+int main() {
+  logging::configure_logging(logging::LogLevel::off, false);
+
+  std::cout << kAppBitsPerSecond / 1e6 << " Mbit/s into a " << kBottleneckBitsPerSecond / 1e6
+            << " Mbit/s bottleneck with a " << kBottleneckBuffer / 1024 << " KB buffer\n";
+  std::cout << std::left << std::setw(12) << "loop" << std::setw(10) << "packets"
+            << std::setw(10) << "loss %" << std::setw(16) << "peak queue KB"
+            << "wake-ups\n";
+  run("10ms-loop", Mode::kLoop10ms);
+  run("calendar", Mode::kCalendar);
+  run("txtime", Mode::kTxtime);
+  std::cout << "Through TransportSession, base RTT " << kBaseRtt.count() << " ms\n";
+  run_session("session", true);
+  run_session("no-fb", false);
+  return 0;
+}
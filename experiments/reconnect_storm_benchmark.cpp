@@ -0,0 +1,138 @@
+// Benchmark: server handshake cost of a reconnect storm after a server restart,
+// with and without persisted ticket keys.
+//
+// N clients hold session tickets issued before the restart and all reconnect at
+// once. Without persisted keys the restarted server cannot open any ticket, so
+// every client gets a 0-RTT REJECT and falls back to a full 1-RTT X25519
+// handshake. With persisted keys (SessionTicketManager::load_or_create_keys) the
+// tickets still validate and every client resumes with 0-RTT.
+//
+// Build: cmake -DVEIL_BUILD_EXPERIMENTS=ON, target reconnect_storm_benchmark
+// Run: ./reconnect_storm_benchmark
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "common/handshake/handshake_processor.h"
+#include "common/handshake/session_ticket.h"
+#include "common/logging/logger.h"
+#include "common/utils/rate_limiter.h"
+
+using namespace veil;
+
+namespace {
+
+constexpr auto kSkew = std::chrono::milliseconds(5000);
+
+struct Result {
+  double server_us_per_client{0};
+  double total_ms{0};
+  std::size_t zero_rtt{0};
+  std::size_t full{0};
+};
+
+std::vector<std::uint8_t> make_psk() { return std::vector<std::uint8_t>(32, 0xAA); }
+
+utils::TokenBucket make_bucket() {
+  return utils::TokenBucket(1e9, std::chrono::milliseconds(1));
+}
+
+Result run(std::size_t clients, bool persist_keys) {
+  const auto key_path =
+      (std::filesystem::temp_directory_path() / "veil_reconnect_storm_keys.bin").string();
+  std::filesystem::remove(key_path);
+
+  // Before the restart: every client completed a handshake and holds a ticket.
+  std::vector<handshake::SessionTicket> tickets;
+  {
+    handshake::SessionTicketManager manager;
+    std::error_code ec;
+    if (persist_keys && !manager.load_or_create_keys(key_path, ec)) {
+      std::cerr << "failed to persist ticket keys: " << ec.message() << "\n";
+    }
+    handshake::HandshakeResponder responder(make_psk(), kSkew, make_bucket());
+    for (std::size_t i = 0; i < clients; ++i) {
+      handshake::HandshakeInitiator initiator(make_psk(), kSkew);
+      auto response = responder.handle_init(initiator.create_init());
+      auto session = response ? initiator.consume_response(response->response) : std::nullopt;
+      if (session) {
+        tickets.push_back(manager.issue_ticket(session->keys));
+      }
+    }
+  }
+
+  // After the restart.
+  auto manager = std::make_shared<handshake::SessionTicketManager>();
+  if (persist_keys) {
+    std::error_code ec;
+    if (!manager->load_or_create_keys(key_path, ec)) {
+      std::cerr << "failed to load ticket keys: " << ec.message() << "\n";
+    }
+  }
+  handshake::ZeroRttResponder zero_rtt_responder(make_psk(), manager, kSkew, make_bucket());
+  handshake::HandshakeResponder responder(make_psk(), kSkew, make_bucket());
+
+  Result r;
+  std::chrono::steady_clock::duration server_time{};
+  const auto start = std::chrono::steady_clock::now();
+  for (const auto& ticket : tickets) {
+    handshake::ZeroRttInitiator zero_rtt(make_psk(), ticket);
+    const auto zero_rtt_init = zero_rtt.create_zero_rtt_init();
+
+    auto t0 = std::chrono::steady_clock::now();
+    auto result = zero_rtt_responder.handle_zero_rtt_init(zero_rtt_init);
+    server_time += std::chrono::steady_clock::now() - t0;
+
+    if (result && zero_rtt.consume_zero_rtt_response(result->response)) {
+      ++r.zero_rtt;
+      continue;
+    }
+
+    // Fallback: full 1-RTT handshake.
+    handshake::HandshakeInitiator initiator(make_psk(), kSkew);
+    const auto init = initiator.create_init();
+    t0 = std::chrono::steady_clock::now();
+    auto response = responder.handle_init(init);
+    server_time += std::chrono::steady_clock::now() - t0;
+    if (response && initiator.consume_response(response->response)) {
+      ++r.full;
+    }
+  }
+  const auto total = std::chrono::steady_clock::now() - start;
+
+  std::filesystem::remove(key_path);
+  r.server_us_per_client = std::chrono::duration<double, std::micro>(server_time).count() /
+                           static_cast<double>(tickets.size());
+  r.total_ms = std::chrono::duration<double, std::milli>(total).count();
+  return r;
+}
+
+}  // namespace
+
+int main() {
+  logging::configure_logging(logging::LogLevel::off, false);
+
+  std::cout << "Reconnect storm after server restart\n";
+  std::cout << std::left << std::setw(10) << "clients" << std::setw(16) << "ticket keys"
+            << std::setw(18) << "server us/client" << std::setw(14) << "total ms"
+            << "0-RTT/1-RTT\n";
+
+  for (std::size_t clients : {100U, 1000U, 4000U}) {
+    for (bool persist : {false, true}) {
+      const auto r = run(clients, persist);
+      std::cout << std::left << std::setw(10) << clients << std::setw(16)
+                << (persist ? "persisted" : "ephemeral") << std::setw(18) << std::fixed
+                << std::setprecision(1) << r.server_us_per_client << std::setw(14) << r.total_ms
+                << r.zero_rtt << "/" << r.full << "\n";
+    }
+  }
+  return 0;
+}
@@ -254,6 +254,22 @@ bool load_config_file(const std::string& path, ClientConfig& config, std::error_
         config.tunnel.reconnect_delay = std::chrono::milliseconds(interval);
       } else if (key == "auto_reconnect") {
         config.tunnel.auto_reconnect = (value == "true" || value == "1" || value == "yes");
+      } else if (key == "zero_rtt") {
+        config.tunnel.enable_zero_rtt = (value == "true" || value == "1" || value == "yes");
+      } else if (key == "ticket_cache_file") {
+        config.tunnel.ticket_cache_file = value;
+      }
+    } else if (section == "transport") {
+      // Offers made to the server; a feature is used once the server offers it too.
+      if (key == "datagram_mode") {
+        config.tunnel.transport.datagram_mode = (value == "true" || value == "1" || value == "yes");
+      } else if (key == "frame_packing") {
+        config.tunnel.transport.frame_packing = (value == "true" || value == "1" || value == "yes");
+      } else if (key == "ack_ranges") {
+        config.tunnel.transport.ack_ranges = (value == "true" || value == "1" || value == "yes");
+      } else if (key == "path_mtu_discovery") {
+        config.tunnel.transport.enable_path_mtu_discovery =
+            (value == "true" || value == "1" || value == "yes");
       }
     } else if (section == "daemon") {
       if (key == "pid_file") {
@@ -345,6 +345,18 @@ std::uint64_t deobfuscate_sequence(std::uint64_t obfuscated_sequence,
   return (static_cast<std::uint64_t>(left) << 32) | right;
 }
 
+std::array<std::uint8_t, 8> header_protection_mask(
+    std::span<const std::uint8_t, kAeadKeyLen> obfuscation_key,
+    std::span<const std::uint8_t, kHeaderProtectionSampleLen> sample) {
+  ensure_sodium_ready();
+
+  // The tag is pseudorandom, so sampled nonces repeat only by chance (2^-64).
+  static_assert(crypto_stream_chacha20_NONCEBYTES == kHeaderProtectionSampleLen);
+  std::array<std::uint8_t, 8> mask{};
+  crypto_stream_chacha20(mask.data(), mask.size(), sample.data(), obfuscation_key.data());
+  return mask;
+}
+
 std::vector<std::uint8_t> aead_encrypt(std::span<const std::uint8_t, kAeadKeyLen> key,
                                        std::span<const std::uint8_t, kNonceLen> nonce,
                                        std::span<const std::uint8_t> aad,
@@ -80,6 +80,14 @@ std::uint64_t obfuscate_sequence(std::uint64_t sequence,
 std::uint64_t deobfuscate_sequence(std::uint64_t obfuscated_sequence,
                                     std::span<const std::uint8_t, kAeadKeyLen> obfuscation_key);
 
+// Mask for a truncated (wire format v2) packet header, after QUIC header protection
+// (RFC 9001 section 5.4.4): ChaCha20 keystream keyed by the obfuscation key, with the
+// nonce taken from a sample of the packet's ciphertext (the start of its AEAD tag).
+inline constexpr std::size_t kHeaderProtectionSampleLen = 8;
+std::array<std::uint8_t, 8> header_protection_mask(
+    std::span<const std::uint8_t, kAeadKeyLen> obfuscation_key,
+    std::span<const std::uint8_t, kHeaderProtectionSampleLen> sample);
+
 std::vector<std::uint8_t> aead_encrypt(std::span<const std::uint8_t, kAeadKeyLen> key,
                                        std::span<const std::uint8_t, kNonceLen> nonce,
                                        std::span<const std::uint8_t> aad,
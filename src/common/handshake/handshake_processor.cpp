@@ -6,6 +6,7 @@
 #include <array>
 #include <chrono>
 #include <cstdint>
+#include <mutex>
 #include <optional>
 #include <span>
 #include <stdexcept>
@@ -28,6 +29,7 @@ constexpr std::array<std::uint8_t, 24> kHandshakeKeyLabel{
 // Handshake padding configuration (DPI resistance)
 constexpr std::uint16_t kMinPaddingSize = 32;   // Minimum padding bytes
 constexpr std::uint16_t kMaxPaddingSize = 400;  // Maximum padding bytes
+constexpr std::size_t kMaxRetryPaddingSize = 64;  // RETRY padding (flood path, kept small)
 
 // Derive a key for handshake packet obfuscation from PSK
 std::array<std::uint8_t, veil::crypto::kAeadKeyLen> derive_handshake_key(
@@ -164,6 +166,89 @@ bool timestamp_valid(std::uint64_t remote_ts, std::chrono::milliseconds skew,
   return diff <= static_cast<std::uint64_t>(skew.count());  // NOLINT(modernize-use-integer-sign-comparison)
 }
 
+// 0-RTT early data key: HKDF(salt = anti-replay nonce, ikm = client send key).
+// The nonce is fresh for every INIT, so each key seals exactly one message and a
+// fixed AEAD nonce is safe.
+constexpr std::array<std::uint8_t, 23> kEarlyDataKeyLabel{
+    'v', 'e', 'i', 'l', '-', '0', 'r', 't', 't', '-', 'e', 'a',
+    'r', 'l', 'y', '-', 'd', 'a', 't', 'a', '-', 'v', '1'};
+
+std::array<std::uint8_t, veil::crypto::kAeadKeyLen> derive_early_data_key(
+    std::span<const std::uint8_t, veil::crypto::kAeadKeyLen> client_send_key,
+    std::span<const std::uint8_t, veil::handshake::kAntiReplayNonceSize> anti_replay_nonce) {
+  auto prk = veil::crypto::hkdf_extract(anti_replay_nonce, client_send_key);
+  auto key_material =
+      veil::crypto::hkdf_expand(prk, kEarlyDataKeyLabel, veil::crypto::kAeadKeyLen);
+  std::array<std::uint8_t, veil::crypto::kAeadKeyLen> key{};
+  std::copy_n(key_material.begin(), key.size(), key.begin());
+
+  // SECURITY: Clear intermediate key material
+  sodium_memzero(prk.data(), prk.size());
+  sodium_memzero(key_material.data(), key_material.size());
+  return key;
+}
+
+// Early data plaintext: repeated pkt_len(2) | pkt.
+std::optional<std::vector<std::vector<std::uint8_t>>> parse_early_data(
+    std::span<const std::uint8_t> data) {
+  std::vector<std::vector<std::uint8_t>> packets;
+  std::size_t offset = 0;
+  while (offset < data.size()) {
+    if (data.size() - offset < 2) {
+      return std::nullopt;
+    }
+    const auto len = static_cast<std::size_t>((data[offset] << 8) | data[offset + 1]);
+    offset += 2;
+    if (len == 0 || data.size() - offset < len) {
+      return std::nullopt;
+    }
+    packets.emplace_back(data.begin() + static_cast<std::ptrdiff_t>(offset),
+                         data.begin() + static_cast<std::ptrdiff_t>(offset + len));
+    offset += len;
+  }
+  return packets;
+}
+
+// RETRY plaintext: magic(2) | version(1) | type(1) | cookie(16) | padding_len(2) | padding.
+// Shared by the 1-RTT and 0-RTT initiators, which both echo the cookie.
+std::optional<veil::handshake::RetryCookie> parse_retry(std::span<const std::uint8_t> psk,
+                                                        std::span<const std::uint8_t> retry) {
+  using veil::handshake::kRetryCookieSize;
+  using veil::handshake::MessageType;
+
+  auto handshake_key = derive_handshake_key(psk);
+  auto decrypted = decrypt_handshake_packet(handshake_key, retry);
+
+  // SECURITY: Clear handshake key after use
+  sodium_memzero(handshake_key.data(), handshake_key.size());
+
+  if (!decrypted.has_value()) {
+    return std::nullopt;
+  }
+
+  const auto& plaintext = *decrypted;
+  constexpr std::size_t header_size = kMagic.size() + 1 + 1 + kRetryCookieSize + 2;
+  if (plaintext.size() < header_size || plaintext.size() > header_size + kMaxPaddingSize) {
+    return std::nullopt;
+  }
+  if (!std::equal(kMagic.begin(), kMagic.end(), plaintext.begin())) {
+    return std::nullopt;
+  }
+  if (plaintext[2] != kVersion || plaintext[3] != static_cast<std::uint8_t>(MessageType::kRetry)) {
+    return std::nullopt;
+  }
+  const auto padding_len_offset = 4 + kRetryCookieSize;
+  const auto padding_len = static_cast<std::size_t>(
+      (plaintext[padding_len_offset] << 8) | plaintext[padding_len_offset + 1]);
+  if (plaintext.size() != header_size + padding_len) {
+    return std::nullopt;
+  }
+
+  veil::handshake::RetryCookie cookie{};
+  std::copy_n(plaintext.begin() + 4, cookie.size(), cookie.begin());
+  return cookie;
+}
+
 }  // namespace
 
 namespace veil::handshake {
@@ -239,9 +324,28 @@ std::vector<std::uint8_t> HandshakeInitiator::create_init() {
   // SECURITY: Clear handshake key after use
   sodium_memzero(handshake_key.data(), handshake_key.size());
 
+  // Echo a retry cookie in front of the INIT: [16-byte cookie][nonce][ciphertext].
+  // The cookie is pseudorandom, so the packet still looks like random bytes.
+  if (retry_cookie_.has_value()) {
+    encrypted.insert(encrypted.begin(), retry_cookie_->begin(), retry_cookie_->end());
+    retry_cookie_.reset();
+  }
+
   return encrypted;
 }
 
+bool HandshakeInitiator::consume_retry(std::span<const std::uint8_t> retry) {
+  if (!init_sent_) {
+    return false;
+  }
+  auto cookie = parse_retry(psk_, retry);
+  if (!cookie.has_value()) {
+    return false;
+  }
+  retry_cookie_ = *cookie;
+  return true;
+}
+
 std::optional<HandshakeSession> HandshakeInitiator::consume_response(
     std::span<const std::uint8_t> response) {
   if (!init_sent_) {
@@ -347,14 +451,17 @@ std::optional<HandshakeSession> HandshakeInitiator::consume_response(
 HandshakeResponder::HandshakeResponder(std::vector<std::uint8_t> psk,
                                        std::chrono::milliseconds skew_tolerance,
                                        utils::TokenBucket rate_limiter,
-                                       std::function<Clock::time_point()> now_fn)
+                                       std::function<Clock::time_point()> now_fn,
+                                       utils::SourceAdmissionConfig source_admission)
     : psk_(std::move(psk)),
       skew_tolerance_(skew_tolerance),
       rate_limiter_(std::move(rate_limiter)),
+      source_admission_(source_admission),
       now_fn_(std::move(now_fn)) {
   if (psk_.empty()) {
     throw std::invalid_argument("psk required");
   }
+  retry_key_ = derive_handshake_key(psk_);
 }
 
 HandshakeResponder::~HandshakeResponder() {
@@ -362,26 +469,39 @@ HandshakeResponder::~HandshakeResponder() {
   if (!psk_.empty()) {
     sodium_memzero(psk_.data(), psk_.size());
   }
+  sodium_memzero(retry_key_.data(), retry_key_.size());
 }
 
 std::optional<HandshakeResponder::Result> HandshakeResponder::handle_init(
     std::span<const std::uint8_t> init_bytes) {
-  // Rate limit before attempting decryption (prevents DoS via decrypt operations)
-  if (!rate_limiter_.allow()) {
+  auto plaintext = open_init(init_bytes);
+  if (!plaintext.has_value()) {
     return std::nullopt;
   }
+  return handle_decrypted_init(*plaintext);
+}
+
+std::optional<std::vector<std::uint8_t>> HandshakeResponder::open_init(
+    std::span<const std::uint8_t> init_bytes) {
+  // Rate limit before attempting decryption (prevents DoS via decrypt operations)
+  {
+    std::lock_guard<std::mutex> lock(rate_limiter_mutex_);
+    if (!rate_limiter_.allow()) {
+      return std::nullopt;
+    }
+  }
 
-  // Derive handshake key and attempt decryption
   auto handshake_key = derive_handshake_key(psk_);
   auto decrypted = decrypt_handshake_packet(handshake_key, init_bytes);
+  // SECURITY: Clear handshake key even on failure
+  sodium_memzero(handshake_key.data(), handshake_key.size());
+  return decrypted;
+}
 
-  if (!decrypted.has_value()) {
-    // SECURITY: Clear handshake key even on failure
-    sodium_memzero(handshake_key.data(), handshake_key.size());
-    return std::nullopt;
-  }
-
-  const auto& plaintext = *decrypted;
+std::optional<HandshakeResponder::Result> HandshakeResponder::handle_decrypted_init(
+    std::span<const std::uint8_t> plaintext) {
+  // Derive the handshake key again to encrypt the RESPONSE.
+  auto handshake_key = derive_handshake_key(psk_);
 
   // Minimum size: header + fields + HMAC + padding_length (2 bytes)
   constexpr std::size_t min_init_size =
@@ -514,16 +634,47 @@ std::optional<HandshakeResponder::Result> HandshakeResponder::handle_init(
   return Result{.response = std::move(encrypted_response), .session = session};
 }
 
+std::vector<std::uint8_t> HandshakeResponder::create_retry(const RetryCookie& cookie,
+                                                           std::size_t max_size) const {
+  // [nonce][magic, version, type, cookie, padding_len, padding][tag]
+  constexpr std::size_t overhead =
+      crypto::kNonceLen + kMagic.size() + 1 + 1 + kRetryCookieSize + 2 + kAeadTagLen;
+  if (max_size < overhead) {
+    return {};
+  }
+
+  // SECURITY: Never answer with more bytes than we received (anti-amplification).
+  // A short random padding is enough to avoid a fixed-size RETRY and keeps it cheap.
+  const auto budget = std::min<std::size_t>(max_size - overhead, kMaxRetryPaddingSize);
+  const auto padding_size =
+      static_cast<std::uint16_t>(veil::crypto::random_uint64() % (budget + 1));
+  const auto padding = veil::crypto::random_bytes(padding_size);
+
+  std::vector<std::uint8_t> plaintext;
+  plaintext.reserve(kMagic.size() + 1 + 1 + cookie.size() + 2 + padding_size);
+  plaintext.insert(plaintext.end(), kMagic.begin(), kMagic.end());
+  plaintext.push_back(kVersion);
+  plaintext.push_back(static_cast<std::uint8_t>(MessageType::kRetry));
+  plaintext.insert(plaintext.end(), cookie.begin(), cookie.end());
+  plaintext.push_back(static_cast<std::uint8_t>((padding_size >> 8) & 0xFF));
+  plaintext.push_back(static_cast<std::uint8_t>(padding_size & 0xFF));
+  plaintext.insert(plaintext.end(), padding.begin(), padding.end());
+
+  return encrypt_handshake_packet(retry_key_, plaintext);
+}
+
 // =============================================================================
 // MultiClientHandshakeResponder Implementation (Issue #87)
 // =============================================================================
 
 MultiClientHandshakeResponder::MultiClientHandshakeResponder(
     std::shared_ptr<auth::ClientRegistry> registry, std::chrono::milliseconds skew_tolerance,
-    utils::TokenBucket rate_limiter, std::function<Clock::time_point()> now_fn)
+    utils::TokenBucket rate_limiter, std::function<Clock::time_point()> now_fn,
+    utils::SourceAdmissionConfig source_admission)
     : registry_(std::move(registry)),
       skew_tolerance_(skew_tolerance),
       rate_limiter_(std::move(rate_limiter)),
+      source_admission_(source_admission),
       now_fn_(std::move(now_fn)) {
   if (!registry_) {
     throw std::invalid_argument("registry required");
@@ -735,7 +886,8 @@ ZeroRttInitiator::~ZeroRttInitiator() {
   sodium_memzero(ticket_.cached_keys.recv_key.data(), ticket_.cached_keys.recv_key.size());
 }
 
-std::vector<std::uint8_t> ZeroRttInitiator::create_zero_rtt_init() {
+std::vector<std::uint8_t> ZeroRttInitiator::create_zero_rtt_init(
+    std::span<const std::vector<std::uint8_t>> early_data) {
   ephemeral_ = crypto::generate_x25519_keypair();
   init_timestamp_ms_ = to_millis(now_fn_());
   init_sent_ = true;
@@ -765,7 +917,7 @@ std::vector<std::uint8_t> ZeroRttInitiator::create_zero_rtt_init() {
   // Build 0-RTT INIT plaintext:
   // magic(2) | version(1) | type(1) | timestamp(8) | ephemeral_pub(32) |
   // anti_replay_nonce(16) | ticket_len(2) | ticket_data(var) | hmac(32) |
-  // padding_len(2) | padding(var)
+  // padding_len(2) | padding(var) [| early_len(2) | early_data(var)]
   const auto ticket_len = static_cast<std::uint16_t>(ticket_.ticket_data.size());
   std::vector<std::uint8_t> plaintext;
   plaintext.reserve(kMagic.size() + 1 + 1 + 8 + 32 + kAntiReplayNonceSize +
@@ -794,6 +946,33 @@ std::vector<std::uint8_t> ZeroRttInitiator::create_zero_rtt_init() {
   // Random padding
   plaintext.insert(plaintext.end(), padding.begin(), padding.end());
 
+  // Optional early data trailer: whole packets, in order, while they fit.
+  // Sealed under a key only the ticket holder and the server can derive, so the
+  // PSK alone does not reveal it.
+  early_data_packets_ = 0;
+  std::vector<std::uint8_t> early_plaintext;
+  for (const auto& packet : early_data) {
+    if (packet.empty() || packet.size() > 0xFFFF ||
+        early_plaintext.size() + 2 + packet.size() > kMaxEarlyDataSize) {
+      break;
+    }
+    early_plaintext.push_back(static_cast<std::uint8_t>((packet.size() >> 8) & 0xFF));
+    early_plaintext.push_back(static_cast<std::uint8_t>(packet.size() & 0xFF));
+    early_plaintext.insert(early_plaintext.end(), packet.begin(), packet.end());
+    ++early_data_packets_;
+  }
+  if (!early_plaintext.empty()) {
+    auto early_key = derive_early_data_key(ticket_.cached_keys.send_key, anti_replay_nonce_);
+    const std::array<std::uint8_t, crypto::kNonceLen> zero_nonce{};
+    const auto early_ciphertext = crypto::aead_encrypt(early_key, zero_nonce, {}, early_plaintext);
+    sodium_memzero(early_key.data(), early_key.size());
+    sodium_memzero(early_plaintext.data(), early_plaintext.size());
+
+    plaintext.push_back(static_cast<std::uint8_t>((early_ciphertext.size() >> 8) & 0xFF));
+    plaintext.push_back(static_cast<std::uint8_t>(early_ciphertext.size() & 0xFF));
+    plaintext.insert(plaintext.end(), early_ciphertext.begin(), early_ciphertext.end());
+  }
+
   // Encrypt with PSK-derived handshake key
   auto handshake_key = derive_handshake_key(psk_);
   auto encrypted = encrypt_handshake_packet(handshake_key, plaintext);
@@ -801,9 +980,27 @@ std::vector<std::uint8_t> ZeroRttInitiator::create_zero_rtt_init() {
   // SECURITY: Clear handshake key after use
   sodium_memzero(handshake_key.data(), handshake_key.size());
 
+  // Echo a retry cookie exactly as create_init() does.
+  if (retry_cookie_.has_value()) {
+    encrypted.insert(encrypted.begin(), retry_cookie_->begin(), retry_cookie_->end());
+    retry_cookie_.reset();
+  }
+
   return encrypted;
 }
 
+bool ZeroRttInitiator::consume_retry(std::span<const std::uint8_t> retry) {
+  if (!init_sent_) {
+    return false;
+  }
+  auto cookie = parse_retry(psk_, retry);
+  if (!cookie.has_value()) {
+    return false;
+  }
+  retry_cookie_ = *cookie;
+  return true;
+}
+
 std::optional<HandshakeSession> ZeroRttInitiator::consume_zero_rtt_response(
     std::span<const std::uint8_t> response) {
   if (!init_sent_) {
@@ -959,20 +1156,27 @@ ZeroRttResponder::~ZeroRttResponder() {
 std::optional<ZeroRttResponder::Result> ZeroRttResponder::handle_zero_rtt_init(
     std::span<const std::uint8_t> init_bytes) {
   // Rate limit
-  if (!rate_limiter_.allow()) {
-    return std::nullopt;
+  {
+    std::lock_guard<std::mutex> lock(rate_limiter_mutex_);
+    if (!rate_limiter_.allow()) {
+      return std::nullopt;
+    }
   }
 
   // Decrypt
   auto handshake_key = derive_handshake_key(psk_);
   auto decrypted = decrypt_handshake_packet(handshake_key, init_bytes);
-
+  sodium_memzero(handshake_key.data(), handshake_key.size());
   if (!decrypted.has_value()) {
-    sodium_memzero(handshake_key.data(), handshake_key.size());
     return std::nullopt;
   }
+  return handle_decrypted_zero_rtt_init(*decrypted);
+}
 
-  const auto& plaintext = *decrypted;
+std::optional<ZeroRttResponder::Result> ZeroRttResponder::handle_decrypted_zero_rtt_init(
+    std::span<const std::uint8_t> plaintext) {
+  // Derive the handshake key again to encrypt the ACCEPT or REJECT.
+  auto handshake_key = derive_handshake_key(psk_);
 
   // Minimum 0-RTT INIT size:
   // magic(2) + version(1) + type(1) + timestamp(8) + ephemeral_pub(32) +
@@ -1080,12 +1284,29 @@ std::optional<ZeroRttResponder::Result> ZeroRttResponder::handle_zero_rtt_init(
     sodium_memzero(handshake_key.data(), handshake_key.size());
     return std::nullopt;
   }
-  const std::size_t expected_total = padding_len_offset + 2 + padding_len;
-  if (plaintext.size() != expected_total) {
+  const std::size_t padded_end = padding_len_offset + 2 + padding_len;
+  if (plaintext.size() < padded_end) {
     sodium_memzero(handshake_key.data(), handshake_key.size());
     return std::nullopt;
   }
 
+  // Optional early data trailer: early_len(2) | AEAD(early data)
+  std::span<const std::uint8_t> early_ciphertext;
+  if (plaintext.size() != padded_end) {
+    if (plaintext.size() < padded_end + 2) {
+      sodium_memzero(handshake_key.data(), handshake_key.size());
+      return std::nullopt;
+    }
+    const auto early_len = static_cast<std::size_t>(
+        (plaintext[padded_end] << 8) | plaintext[padded_end + 1]);
+    if (early_len <= kAeadTagLen || early_len > kMaxEarlyDataSize + kAeadTagLen ||
+        plaintext.size() != padded_end + 2 + early_len) {
+      sodium_memzero(handshake_key.data(), handshake_key.size());
+      return std::nullopt;
+    }
+    early_ciphertext = std::span<const std::uint8_t>(plaintext).subspan(padded_end + 2);
+  }
+
   // Validate the session ticket
   auto ticket_payload = ticket_manager_->validate_ticket(ticket_data_span);
 
@@ -1132,24 +1353,48 @@ std::optional<ZeroRttResponder::Result> ZeroRttResponder::handle_zero_rtt_init(
         .response = std::move(encrypted_reject),
         .session = reject_session,
         .accepted = false,
+        .early_data = {},
     };
   }
 
-  // Ticket valid: accept 0-RTT
+  // Ticket valid: open the early data, if any, before committing to accept.
+  std::vector<std::vector<std::uint8_t>> early_data;
+  if (!early_ciphertext.empty()) {
+    auto early_key = derive_early_data_key(ticket_payload->send_key, anti_replay_nonce);
+    const std::array<std::uint8_t, crypto::kNonceLen> zero_nonce{};
+    auto early_plaintext = crypto::aead_decrypt(early_key, zero_nonce, {}, early_ciphertext);
+    sodium_memzero(early_key.data(), early_key.size());
+    auto packets = early_plaintext ? parse_early_data(*early_plaintext) : std::nullopt;
+    if (early_plaintext) {
+      sodium_memzero(early_plaintext->data(), early_plaintext->size());
+    }
+    if (!packets) {
+      sodium_memzero(handshake_key.data(), handshake_key.size());
+      sodium_memzero(ticket_payload->send_key.data(), ticket_payload->send_key.size());
+      sodium_memzero(ticket_payload->recv_key.data(), ticket_payload->recv_key.size());
+      return std::nullopt;
+    }
+    early_data = std::move(*packets);
+  }
+
+  // Accept 0-RTT
   const auto session_id = veil::crypto::random_uint64();
 
   // Derive fresh nonces to prevent nonce reuse across sessions (Issue #221).
   // The cached nonces from the ticket would collide with the original session's
   // nonces when the packet counter resets to 0. Using HKDF with the new
   // session_id as domain separation produces unique nonces for each resumption.
+  // Both sides derive from the client's view of the nonces (as stored in the ticket).
   auto fresh_nonces = crypto::derive_resumed_nonces(
       ticket_payload->send_nonce, ticket_payload->recv_nonce, session_id);
 
+  // The ticket holds the client's view of the keys: the server sends on the
+  // client's receive direction and vice versa.
   crypto::SessionKeys session_keys{
-      .send_key = ticket_payload->send_key,
-      .recv_key = ticket_payload->recv_key,
-      .send_nonce = fresh_nonces.send_nonce,
-      .recv_nonce = fresh_nonces.recv_nonce,
+      .send_key = ticket_payload->recv_key,
+      .recv_key = ticket_payload->send_key,
+      .send_nonce = fresh_nonces.recv_nonce,
+      .recv_nonce = fresh_nonces.send_nonce,
   };
 
   // Build accept HMAC payload
@@ -1203,6 +1448,7 @@ std::optional<ZeroRttResponder::Result> ZeroRttResponder::handle_zero_rtt_init(
       .response = std::move(encrypted_accept),
       .session = session,
       .accepted = true,
+      .early_data = std::move(early_data),
   };
 }
 
@@ -5,16 +5,20 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "common/auth/client_registry.h"
 #include "common/crypto/crypto_engine.h"
 #include "common/handshake/handshake_replay_cache.h"
+#include "common/handshake/retry_cookie.h"
 #include "common/handshake/session_ticket.h"
 #include "common/utils/rate_limiter.h"
+#include "common/utils/source_admission.h"
 
 namespace veil::handshake {
 
@@ -22,14 +26,29 @@ namespace veil::handshake {
 /// Kept small to avoid bloating handshake packets.
 inline constexpr std::size_t kMaxHandshakeClientIdLength = 64;
 
+/// Maximum 0-RTT early data carried in a 0-RTT INIT (sum of packet sizes plus
+/// 2 bytes of framing each). Keeps the INIT, with maximum padding, under 1232
+/// bytes so it is never fragmented.
+inline constexpr std::size_t kMaxEarlyDataSize = 512;
+
 enum class MessageType : std::uint8_t {
   kInit = 1,
   kResponse = 2,
   kZeroRttInit = 3,     // 0-RTT INIT with session ticket (Issue #86)
   kZeroRttAccept = 4,   // Server accepts 0-RTT (Issue #86)
   kZeroRttReject = 5,   // Server rejects 0-RTT, fallback to 1-RTT (Issue #86)
+  kRetry = 6,           // Server under load: echo the cookie in a new INIT
 };
 
+/// Message type of a decrypted handshake plaintext, or nullopt if it is too short.
+inline std::optional<MessageType> init_message_type(std::span<const std::uint8_t> plaintext) {
+  // [magic(2)][version(1)][type(1)]...
+  if (plaintext.size() < 4) {
+    return std::nullopt;
+  }
+  return static_cast<MessageType>(plaintext[3]);
+}
+
 struct HandshakeSession {
   std::uint64_t session_id;
   crypto::SessionKeys keys;
@@ -69,9 +88,14 @@ class HandshakeInitiator {
   HandshakeInitiator(HandshakeInitiator&&) = default;
   HandshakeInitiator& operator=(HandshakeInitiator&&) = default;
 
+  /// Build an INIT. If a RETRY was consumed, the cookie is prepended (once).
   std::vector<std::uint8_t> create_init();
   std::optional<HandshakeSession> consume_response(std::span<const std::uint8_t> response);
 
+  /// Process a RETRY sent by a server under load instead of a RESPONSE.
+  /// On success the cookie is stored and echoed by the next create_init().
+  bool consume_retry(std::span<const std::uint8_t> retry);
+
   /// Get the client_id associated with this initiator (may be empty).
   const std::string& client_id() const { return client_id_; }
 
@@ -84,6 +108,7 @@ class HandshakeInitiator {
   crypto::KeyPair ephemeral_;
   std::uint64_t init_timestamp_ms_{0};
   bool init_sent_{false};
+  std::optional<RetryCookie> retry_cookie_;
 };
 
 class HandshakeResponder {
@@ -96,7 +121,8 @@ class HandshakeResponder {
 
   HandshakeResponder(std::vector<std::uint8_t> psk, std::chrono::milliseconds skew_tolerance,
                      utils::TokenBucket rate_limiter,
-                     std::function<Clock::time_point()> now_fn = Clock::now);
+                     std::function<Clock::time_point()> now_fn = Clock::now,
+                     utils::SourceAdmissionConfig source_admission = {});
 
   /// SECURITY: Destructor clears all sensitive key material
   ~HandshakeResponder();
@@ -109,14 +135,54 @@ class HandshakeResponder {
   HandshakeResponder(HandshakeResponder&&) = delete;
   HandshakeResponder& operator=(HandshakeResponder&&) = delete;
 
+  /// Process an INIT message and build the RESPONSE.
+  ///
+  /// Thread Safety: May be called concurrently from several handshake workers.
+  /// The PSK is read-only, the replay cache is internally synchronized and the
+  /// rate limiter is guarded by its own mutex.
+  /// @see docs/thread_model.md
   std::optional<Result> handle_init(std::span<const std::uint8_t> init_bytes);
 
+  /// Rate-limit and decrypt an INIT of either kind (1-RTT and 0-RTT INITs share the
+  /// handshake key), so a server accepting both decrypts each datagram once. Pass
+  /// the plaintext to handle_decrypted_init() or
+  /// ZeroRttResponder::handle_decrypted_zero_rtt_init() according to
+  /// init_message_type(). Returns nullopt if rate limited or not authentic.
+  /// Thread Safety: Same as handle_init().
+  std::optional<std::vector<std::uint8_t>> open_init(std::span<const std::uint8_t> init_bytes);
+
+  /// Process a 1-RTT INIT plaintext returned by open_init().
+  std::optional<Result> handle_decrypted_init(std::span<const std::uint8_t> plaintext);
+
+  /// Per-source-prefix admission for an INIT from `source_host`. Call before any
+  /// crypto (cookie check, decryption); a false return means drop the packet.
+  /// The global rate limiter still applies to admitted INITs.
+  /// Thread Safety: Thread-safe (lock-free sketch).
+  bool admit_source(std::string_view source_host) {
+    return source_admission_.admit_host(source_host);
+  }
+
+  [[nodiscard]] const utils::SourceAdmissionFilter& source_admission() const {
+    return source_admission_;
+  }
+
+  /// Build an encrypted RETRY carrying `cookie` (stateless retry under load).
+  /// The RETRY is never larger than `max_size` (the size of the INIT it answers),
+  /// so it cannot be used for amplification. Returns an empty vector if it cannot fit.
+  /// Thread Safety: Thread-safe (only reads the PSK).
+  std::vector<std::uint8_t> create_retry(const RetryCookie& cookie, std::size_t max_size) const;
+
  private:
   std::vector<std::uint8_t> psk_;
   std::chrono::milliseconds skew_tolerance_;
+  std::mutex rate_limiter_mutex_;
   utils::TokenBucket rate_limiter_;
+  utils::SourceAdmissionFilter source_admission_;
   HandshakeReplayCache replay_cache_;
   std::function<Clock::time_point()> now_fn_;
+  // PERFORMANCE: RETRYs are built on the flood path, so the PSK-derived handshake
+  // key is derived once instead of per packet. Cleared in the destructor.
+  std::array<std::uint8_t, crypto::kAeadKeyLen> retry_key_{};
 };
 
 /// MultiClientHandshakeResponder handles handshakes with per-client PSKs.
@@ -156,10 +222,12 @@ class MultiClientHandshakeResponder {
   /// @param skew_tolerance Maximum allowed timestamp difference.
   /// @param rate_limiter Token bucket for rate limiting handshake attempts.
   /// @param now_fn Clock function for timestamp generation.
+  /// @param source_admission Per-source-prefix admission sketch parameters.
   MultiClientHandshakeResponder(std::shared_ptr<auth::ClientRegistry> registry,
                                 std::chrono::milliseconds skew_tolerance,
                                 utils::TokenBucket rate_limiter,
-                                std::function<Clock::time_point()> now_fn = Clock::now);
+                                std::function<Clock::time_point()> now_fn = Clock::now,
+                                utils::SourceAdmissionConfig source_admission = {});
 
   /// SECURITY: Destructor clears sensitive key material.
   ~MultiClientHandshakeResponder();
@@ -178,6 +246,12 @@ class MultiClientHandshakeResponder {
   /// Returns nullopt if handshake fails (wrong PSK, replay, rate limit, etc.).
   std::optional<Result> handle_init(std::span<const std::uint8_t> init_bytes);
 
+  /// Per-source-prefix admission for an INIT from `source_host`. Call before any
+  /// crypto; a false return means drop the packet.
+  bool admit_source(std::string_view source_host) {
+    return source_admission_.admit_host(source_host);
+  }
+
   /// Get the client registry.
   std::shared_ptr<auth::ClientRegistry> registry() const { return registry_; }
 
@@ -192,6 +266,7 @@ class MultiClientHandshakeResponder {
   std::shared_ptr<auth::ClientRegistry> registry_;
   std::chrono::milliseconds skew_tolerance_;
   utils::TokenBucket rate_limiter_;
+  utils::SourceAdmissionFilter source_admission_;
   HandshakeReplayCache replay_cache_;
   std::function<Clock::time_point()> now_fn_;
 };
@@ -213,8 +288,8 @@ class MultiClientHandshakeResponder {
 /// SessionTicketStore store;
 /// auto ticket = store.get_ticket("server:4430");
 /// if (ticket) {
-///   ZeroRttInitiator initiator(psk, *ticket, skew_tolerance);
-///   auto init_bytes = initiator.create_zero_rtt_init();
+///   ZeroRttInitiator initiator(psk, *ticket);
+///   auto init_bytes = initiator.create_zero_rtt_init(queued_packets);
 ///   // Send init_bytes to server
 ///   // Server responds with kZeroRttAccept or kZeroRttReject
 ///   auto session = initiator.consume_zero_rtt_response(response);
@@ -244,8 +319,17 @@ class ZeroRttInitiator {
   ZeroRttInitiator& operator=(ZeroRttInitiator&&) = delete;
 
   /// Create a 0-RTT INIT message containing the session ticket.
+  /// @param early_data Packets to send as early data. Leading packets are taken
+  ///        in order while they fit in kMaxEarlyDataSize; see early_data_packets().
+  ///        Early data is encrypted under a key derived from the ticket's keys and
+  ///        the anti-replay nonce, and is only delivered if the server accepts.
   /// @return Encrypted 0-RTT INIT packet.
-  std::vector<std::uint8_t> create_zero_rtt_init();
+  std::vector<std::uint8_t> create_zero_rtt_init(
+      std::span<const std::vector<std::uint8_t>> early_data = {});
+
+  /// Number of leading early_data packets carried by the last 0-RTT INIT.
+  /// If the server rejects, the caller must resend them over the 1-RTT session.
+  std::size_t early_data_packets() const { return early_data_packets_; }
 
   /// Process the server's response to a 0-RTT attempt.
   /// @param response The server's response bytes.
@@ -256,6 +340,11 @@ class ZeroRttInitiator {
   /// Check if 0-RTT was rejected (need to fallback to 1-RTT).
   bool was_rejected() const { return rejected_; }
 
+  /// Process a RETRY sent instead of an accept/reject by a server requiring cookies.
+  /// On success the cookie is stored and echoed by the next create_zero_rtt_init();
+  /// the ticket is still good and the caller should resend the 0-RTT INIT.
+  bool consume_retry(std::span<const std::uint8_t> retry);
+
  private:
   std::vector<std::uint8_t> psk_;
   SessionTicket ticket_;
@@ -264,6 +353,8 @@ class ZeroRttInitiator {
   crypto::KeyPair ephemeral_;
   std::array<std::uint8_t, kAntiReplayNonceSize> anti_replay_nonce_{};
   std::uint64_t init_timestamp_ms_{0};
+  std::size_t early_data_packets_{0};
+  std::optional<RetryCookie> retry_cookie_;
   bool init_sent_{false};
   bool rejected_{false};
 };
@@ -280,6 +371,19 @@ class ZeroRttInitiator {
 /// - Rate limiting.
 /// - Fallback rejection (kZeroRttReject) when ticket is invalid.
 ///
+/// Early data is only returned for accepted INITs, so a replayed INIT never
+/// delivers it twice to the same server instance. A server restarted with
+/// persisted ticket keys has an empty replay table, so an INIT captured before
+/// the restart can be replayed once within the skew window; callers should
+/// treat early data like any duplicated IP packet.
+///
+/// Tickets carry the client's view of the session keys; the accepted session
+/// uses the server's view (send and receive swapped).
+///
+/// Thread Safety: handle_zero_rtt_init() may be called concurrently from several
+/// handshake workers.
+/// @see docs/thread_model.md
+///
 /// Usage:
 /// ```cpp
 /// auto ticket_manager = std::make_shared<SessionTicketManager>();
@@ -301,6 +405,7 @@ class ZeroRttResponder {
     std::vector<std::uint8_t> response;
     HandshakeSession session;
     bool accepted;  // true = 0-RTT accepted, false = rejected (fallback to 1-RTT)
+    std::vector<std::vector<std::uint8_t>> early_data;  // Only set when accepted
   };
 
   /// Create a 0-RTT responder with a ticket manager.
@@ -328,6 +433,10 @@ class ZeroRttResponder {
   /// @return Result with accept/reject status, or nullopt on complete failure.
   std::optional<Result> handle_zero_rtt_init(std::span<const std::uint8_t> init_bytes);
 
+  /// Process a 0-RTT INIT plaintext returned by HandshakeResponder::open_init().
+  /// Does not take a rate-limiter token: open_init() already did.
+  std::optional<Result> handle_decrypted_zero_rtt_init(std::span<const std::uint8_t> plaintext);
+
   /// Get the ticket manager.
   std::shared_ptr<SessionTicketManager> ticket_manager() const { return ticket_manager_; }
 
@@ -335,6 +444,7 @@ class ZeroRttResponder {
   std::vector<std::uint8_t> psk_;
   std::shared_ptr<SessionTicketManager> ticket_manager_;
   std::chrono::milliseconds skew_tolerance_;
+  std::mutex rate_limiter_mutex_;
   utils::TokenBucket rate_limiter_;
   HandshakeReplayCache replay_cache_;
   std::function<Clock::time_point()> now_fn_;
@@ -3,17 +3,14 @@
 #include <array>
 #include <chrono>
 #include <cstdint>
-#include <list>
-#include <mutex>
-#include <optional>
-#include <unordered_map>
 
 #include "common/crypto/crypto_engine.h"
+#include "common/handshake/replay_table.h"
 
 namespace veil::handshake {
 
 /**
- * LRU Replay Cache for handshake INIT messages.
+ * Replay Cache for handshake INIT messages.
  *
  * Prevents replay attacks by tracking recently seen (timestamp, ephemeral_public_key) pairs.
  * When an INIT packet arrives:
@@ -22,61 +19,26 @@ namespace veil::handshake {
  * 3. If duplicate, silently drop (anti-probing requirement)
  *
  * Implementation details:
- * - Fixed capacity with LRU eviction policy
- * - O(1) lookup, insert, and eviction operations
- * - Automatic cleanup of expired entries
+ * - Backed by TimeBucketedReplayTable: fixed-size open-addressed buckets, one per
+ *   epoch of the time window, so expiry is bucket rotation instead of a list walk
+ * - The whole (timestamp, ephemeral_key) pair is hashed with a keyed SipHash
+ * - No allocation after construction
+ * - If more than `capacity` INITs arrive within one epoch, older entries may be
+ *   overwritten (the timestamp check in the responder still bounds replays)
  *
  * Thread Safety:
- *   This class IS thread-safe. All public methods are protected by an internal
- *   mutex, allowing safe concurrent access from multiple threads. This is
- *   necessary because handshake processing may occur on different threads
- *   than the main event loop.
- *
- *   Note: This is one of the few classes in VEIL that provides internal
- *   synchronization. Most other components rely on single-threaded access
- *   patterns enforced by the event loop.
+ *   This class IS thread-safe and lock-free: several handshake workers may call
+ *   mark_and_check() concurrently without serializing on a mutex.
  *
  * @see docs/thread_model.md for the VEIL threading model documentation.
  */
 class HandshakeReplayCache {
  public:
-  /**
-   * Entry identifier combining timestamp and ephemeral public key.
-   * This uniquely identifies each handshake INIT message.
-   */
-  struct CacheKey {
-    std::uint64_t timestamp_ms;
-    std::array<std::uint8_t, crypto::kX25519PublicKeySize> ephemeral_key;
-
-    bool operator==(const CacheKey& other) const {
-      return timestamp_ms == other.timestamp_ms && ephemeral_key == other.ephemeral_key;
-    }
-  };
-
-  /**
-   * Hash function for CacheKey to use in unordered_map.
-   */
-  struct CacheKeyHash {
-    std::size_t operator()(const CacheKey& key) const noexcept {
-      // Combine timestamp hash with first 8 bytes of ephemeral key
-      std::size_t hash = std::hash<std::uint64_t>{}(key.timestamp_ms);
-
-      // Mix in ephemeral key bytes (use first 8 bytes for efficiency)
-      std::uint64_t key_prefix = 0;
-      for (std::size_t i = 0; i < 8 && i < key.ephemeral_key.size(); ++i) {
-        key_prefix = (key_prefix << 8) | key.ephemeral_key[i];
-      }
-      hash ^= std::hash<std::uint64_t>{}(key_prefix) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
-
-      return hash;
-    }
-  };
-
   /**
    * Construct replay cache with specified capacity and time window.
    *
-   * @param capacity Maximum number of entries to cache (default: 4096)
-   * @param time_window_ms Maximum age of entries in milliseconds (default: 60000ms = 60s)
+   * @param capacity Entries per time bucket that fit without eviction (default: 4096)
+   * @param time_window Minimum retention of entries (default: 60000ms = 60s)
    */
   explicit HandshakeReplayCache(
       std::size_t capacity = 4096,
@@ -95,8 +57,8 @@ class HandshakeReplayCache {
                       const std::array<std::uint8_t, crypto::kX25519PublicKeySize>& ephemeral_key);
 
   /**
-   * Remove entries older than the time window.
-   * Called automatically during mark_and_check, but can be called manually for cleanup.
+   * Remove entries whose time bucket is older than the time window.
+   * Expired buckets are reused automatically by mark_and_check; this only frees them early.
    *
    * @param current_time_ms Current time in milliseconds
    * @return Number of entries removed
@@ -111,7 +73,7 @@ class HandshakeReplayCache {
   /**
    * Get maximum capacity of the cache.
    */
-  [[nodiscard]] std::size_t capacity() const { return capacity_; }
+  [[nodiscard]] std::size_t capacity() const { return table_.capacity(); }
 
   /**
    * Clear all entries from the cache.
@@ -119,21 +81,7 @@ class HandshakeReplayCache {
   void clear();
 
  private:
-  using LruList = std::list<CacheKey>;
-  using LruIterator = LruList::iterator;
-  using CacheMap = std::unordered_map<CacheKey, LruIterator, CacheKeyHash>;
-
-  void evict_lru();
-  void touch(const CacheKey& key);
-  std::size_t cleanup_expired_locked(std::uint64_t current_time_ms);
-
-  const std::size_t capacity_;
-  const std::chrono::milliseconds time_window_;
-
-  LruList lru_list_;           // Most recently used at back, least recently used at front
-  CacheMap cache_map_;         // Maps CacheKey -> position in LRU list
-
-  mutable std::mutex mutex_;   // Protects all internal state
+  TimeBucketedReplayTable table_;
 };
 
 }  // namespace veil::handshake
@@ -0,0 +1,182 @@
+#include "common/handshake/replay_table.h"
+
+#include <sodium.h>
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+#include "common/crypto/random.h"
+
+namespace veil::handshake {
+
+namespace {
+
+// Slot layout: [ fingerprint:40 | epoch tag:24 ]. Zero is an empty slot.
+constexpr unsigned kTagBits = 24;
+constexpr std::uint64_t kTagMask = (1ULL << kTagBits) - 1;
+constexpr std::uint64_t kTagHalfRange = 1ULL << (kTagBits - 1);
+
+// Linear probing stops after this many slots; beyond that the home slot is evicted.
+constexpr std::size_t kMaxProbe = 16;
+
+std::uint64_t slot_tag(std::uint64_t slot) { return slot & kTagMask; }
+
+// Serial-number comparison of 24-bit epoch tags: true if `tag` is before `epoch`.
+bool tag_older(std::uint64_t tag, std::uint64_t epoch) {
+  const auto diff = (epoch - tag) & kTagMask;
+  return diff != 0 && diff < kTagHalfRange;
+}
+
+// A slot is free for an insert at `epoch` if it is empty or holds an older epoch.
+bool slot_free(std::uint64_t slot, std::uint64_t epoch) {
+  return slot == 0 || tag_older(slot_tag(slot), epoch);
+}
+
+}  // namespace
+
+TimeBucketedReplayTable::TimeBucketedReplayTable(std::size_t capacity,
+                                                 std::chrono::milliseconds window)
+    : capacity_(capacity), window_(window) {
+  if (capacity_ == 0) {
+    throw std::invalid_argument("replay table capacity must be > 0");
+  }
+  const auto window_ms = static_cast<std::uint64_t>(std::max<std::int64_t>(window_.count(), 1));
+  epoch_ms_ = std::max<std::uint64_t>(window_ms / (kBuckets - 1), 1);
+  bucket_slots_ = std::bit_ceil(capacity_) * 2;
+  probe_limit_ = std::min(bucket_slots_, kMaxProbe);
+
+  const auto key = crypto::random_bytes(hash_key_.size());
+  std::copy_n(key.begin(), hash_key_.size(), hash_key_.begin());
+
+  // PERFORMANCE: All slots are allocated here; mark_and_check() never allocates.
+  slots_ = std::make_unique<std::atomic<std::uint64_t>[]>(bucket_slots_ * kBuckets);
+}
+
+std::uint64_t TimeBucketedReplayTable::epoch_of(std::uint64_t time_ms) const {
+  return time_ms / epoch_ms_;
+}
+
+bool TimeBucketedReplayTable::contains(std::uint64_t epoch, std::uint64_t fingerprint,
+                                       std::size_t home) const {
+  const std::uint64_t wanted = (fingerprint << kTagBits) | (epoch & kTagMask);
+  const auto* bucket = slots_.get() + static_cast<std::size_t>(epoch % kBuckets) * bucket_slots_;
+  const auto mask = bucket_slots_ - 1;
+  for (std::size_t i = 0; i < probe_limit_; ++i) {
+    const auto value = bucket[(home + i) & mask].load(std::memory_order_acquire);
+    if (value == wanted) {
+      return true;
+    }
+    if (value == 0) {
+      return false;
+    }
+  }
+  return false;
+}
+
+bool TimeBucketedReplayTable::mark_and_check(std::span<const std::uint8_t> key,
+                                             std::uint64_t time_ms) {
+  const auto epoch = epoch_of(time_ms);
+  const auto tag = epoch & kTagMask;
+
+  // Full-key keyed hash (SipHash-2-4): low bits pick the home slot, high bits
+  // form the fingerprint.
+  std::array<std::uint8_t, crypto_shorthash_BYTES> digest{};
+  crypto_shorthash(digest.data(), key.data(), key.size(), hash_key_.data());
+  std::uint64_t hash = 0;
+  for (const auto b : digest) {
+    hash = (hash << 8) | b;
+  }
+  std::uint64_t fingerprint = hash >> kTagBits;
+  if (fingerprint == 0) {
+    fingerprint = 1;
+  }
+  const std::uint64_t mine = (fingerprint << kTagBits) | tag;
+
+  auto* bucket = slots_.get() + static_cast<std::size_t>(epoch % kBuckets) * bucket_slots_;
+  const auto mask = bucket_slots_ - 1;
+  const auto home = static_cast<std::size_t>(hash) & mask;
+
+  // SECURITY: A key marked in an earlier epoch that is still retained is a replay
+  // too; otherwise replaying it just after an epoch boundary would pass.
+  for (std::uint64_t back = 1; back < kBuckets && back <= epoch; ++back) {
+    if (contains(epoch - back, fingerprint, home)) {
+      return true;
+    }
+  }
+
+  for (;;) {
+    for (std::size_t i = 0; i < probe_limit_; ++i) {
+      auto& slot = bucket[(home + i) & mask];
+      auto value = slot.load(std::memory_order_acquire);
+      for (;;) {
+        if (value == mine) {
+          return true;
+        }
+        if (!slot_free(value, tag)) {
+          break;  // Same or newer epoch: keep probing.
+        }
+        // On failure `value` is reloaded and re-examined: a racing insert of the
+        // same key lands here and is reported as a replay.
+        if (slot.compare_exchange_weak(value, mine, std::memory_order_acq_rel,
+                                       std::memory_order_acquire)) {
+          return false;
+        }
+      }
+    }
+
+    // Probe window full of live entries: evict the home slot (fail open).
+    auto& slot = bucket[home];
+    auto value = slot.load(std::memory_order_acquire);
+    if (value == mine) {
+      return true;
+    }
+    if (tag_older(tag, slot_tag(value))) {
+      // Only newer epochs here; an out-of-window timestamp is not worth an eviction.
+      return false;
+    }
+    if (slot.compare_exchange_strong(value, mine, std::memory_order_acq_rel,
+                                     std::memory_order_acquire)) {
+      return false;
+    }
+  }
+}
+
+std::size_t TimeBucketedReplayTable::cleanup_expired(std::uint64_t current_time_ms) {
+  const auto window_ms = static_cast<std::uint64_t>(window_.count());
+  const auto cutoff_ms = current_time_ms > window_ms ? current_time_ms - window_ms : 0;
+  const auto cutoff_tag = epoch_of(cutoff_ms) & kTagMask;
+
+  std::size_t removed = 0;
+  const auto total = bucket_slots_ * kBuckets;
+  for (std::size_t i = 0; i < total; ++i) {
+    auto value = slots_[i].load(std::memory_order_acquire);
+    // Clearing an expired slot never hides a live entry: it was already free for
+    // every epoch that is still inside the window.
+    if (value != 0 && tag_older(slot_tag(value), cutoff_tag) &&
+        slots_[i].compare_exchange_strong(value, 0, std::memory_order_acq_rel)) {
+      ++removed;
+    }
+  }
+  return removed;
+}
+
+std::size_t TimeBucketedReplayTable::size() const {
+  std::size_t count = 0;
+  const auto total = bucket_slots_ * kBuckets;
+  for (std::size_t i = 0; i < total; ++i) {
+    if (slots_[i].load(std::memory_order_relaxed) != 0) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+void TimeBucketedReplayTable::clear() {
+  const auto total = bucket_slots_ * kBuckets;
+  for (std::size_t i = 0; i < total; ++i) {
+    slots_[i].store(0, std::memory_order_release);
+  }
+}
+
+}  // namespace veil::handshake
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace veil::handshake {
+
+/**
+ * Lock-free, fixed-size replay table with time-bucketed expiry.
+ *
+ * Backs HandshakeReplayCache (INIT replays) and SessionTicketManager (0-RTT
+ * anti-replay nonces). Keys are arbitrary byte strings stamped with a time in
+ * milliseconds; a key is reported as a replay if the same bytes were marked
+ * with a time in the same epoch or one of the kBuckets - 1 before it (so at
+ * least `window` earlier) and the entry has not rotated out.
+ *
+ * Layout:
+ * - kBuckets buckets, each an open-addressed array of 64-bit slots. An epoch
+ *   (window / (kBuckets - 1) long) maps to bucket `epoch % kBuckets`, so an
+ *   entry is retained for at least `window` and at most `window + epoch`.
+ * - A slot packs a 40-bit fingerprint of the FULL key (keyed SipHash-2-4 with a
+ *   random per-table key, so collisions cannot be precomputed) with a 24-bit
+ *   epoch tag. Slots tagged with an older epoch are free, so expiry is just
+ *   bucket rotation: no per-entry timers, no list walk.
+ * - Slot tags only ever move forward, which keeps linear probing correct
+ *   without deletion markers.
+ *
+ * Capacity: each bucket holds 2 * bit_ceil(capacity) slots, so `capacity`
+ * entries per epoch fit at load factor <= 0.5. If a probe window is full the
+ * home slot is overwritten (fail open, like the LRU eviction it replaces);
+ * callers must still enforce their own timestamp window.
+ *
+ * False positives require a 40-bit fingerprint match in the same epoch along
+ * one probe path (~2^-36 per lookup); the caller simply sees a spurious replay.
+ *
+ * Thread Safety:
+ *   mark_and_check(), cleanup_expired() and size() are lock-free and may be
+ *   called concurrently. clear() is not atomic with respect to concurrent
+ *   inserts. No allocation happens after construction.
+ *
+ * @see docs/thread_model.md for the VEIL threading model documentation.
+ */
+class TimeBucketedReplayTable {
+ public:
+  static constexpr std::size_t kBuckets = 4;
+
+  /**
+   * @param capacity Entries per epoch that fit without eviction (must be > 0).
+   * @param window Minimum retention of an entry.
+   */
+  TimeBucketedReplayTable(std::size_t capacity, std::chrono::milliseconds window);
+
+  TimeBucketedReplayTable(const TimeBucketedReplayTable&) = delete;
+  TimeBucketedReplayTable& operator=(const TimeBucketedReplayTable&) = delete;
+  TimeBucketedReplayTable(TimeBucketedReplayTable&&) = delete;
+  TimeBucketedReplayTable& operator=(TimeBucketedReplayTable&&) = delete;
+
+  /**
+   * Mark `key` as seen at `time_ms`.
+   * @return true if it was already marked in this epoch or a retained earlier
+   *         one (replay).
+   */
+  bool mark_and_check(std::span<const std::uint8_t> key, std::uint64_t time_ms);
+
+  /**
+   * Free entries whose epoch ended before `current_time_ms - window`.
+   * Rotation reuses such slots anyway; this only makes size() exact.
+   * @return Number of entries removed.
+   */
+  std::size_t cleanup_expired(std::uint64_t current_time_ms);
+
+  /// Number of occupied slots (O(slots); diagnostics and tests).
+  [[nodiscard]] std::size_t size() const;
+
+  [[nodiscard]] std::size_t capacity() const { return capacity_; }
+
+  void clear();
+
+ private:
+  [[nodiscard]] std::uint64_t epoch_of(std::uint64_t time_ms) const;
+  // Whether the bucket for `epoch` holds `fingerprint` (read-only probe).
+  [[nodiscard]] bool contains(std::uint64_t epoch, std::uint64_t fingerprint,
+                              std::size_t home) const;
+
+  std::size_t capacity_;
+  std::chrono::milliseconds window_;
+  std::uint64_t epoch_ms_;
+  std::size_t bucket_slots_;
+  std::size_t probe_limit_;
+  std::array<std::uint8_t, 16> hash_key_{};
+  std::unique_ptr<std::atomic<std::uint64_t>[]> slots_;
+};
+
+}  // namespace veil::handshake
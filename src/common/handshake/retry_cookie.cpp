@@ -0,0 +1,78 @@
+#include "common/handshake/retry_cookie.h"
+
+#include <sodium.h>
+
+#include <algorithm>
+
+#include "common/crypto/random.h"
+
+namespace veil::handshake {
+
+RetryCookieGenerator::RetryCookieGenerator(std::chrono::seconds window,
+                                           std::function<Clock::time_point()> now_fn)
+    : window_(window.count() > 0 ? window : kDefaultRetryCookieWindow),
+      now_fn_(std::move(now_fn)) {
+  const auto secret = crypto::random_bytes(secret_.size());
+  std::copy_n(secret.begin(), secret_.size(), secret_.begin());
+}
+
+RetryCookieGenerator::~RetryCookieGenerator() {
+  sodium_memzero(secret_.data(), secret_.size());
+}
+
+std::uint64_t RetryCookieGenerator::current_window() const {
+  const auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+      now_fn_().time_since_epoch());
+  return static_cast<std::uint64_t>(elapsed.count() / window_.count());
+}
+
+RetryCookie RetryCookieGenerator::compute(std::string_view source, std::uint64_t window) const {
+  crypto_generichash_state state;
+  crypto_generichash_init(&state, secret_.data(), secret_.size(), kRetryCookieSize);
+  crypto_generichash_update(&state, reinterpret_cast<const std::uint8_t*>(source.data()),
+                            source.size());
+  std::array<std::uint8_t, 8> window_bytes{};
+  for (std::size_t i = 0; i < window_bytes.size(); ++i) {
+    window_bytes[i] = static_cast<std::uint8_t>(window >> (8 * (7 - i)));
+  }
+  crypto_generichash_update(&state, window_bytes.data(), window_bytes.size());
+
+  RetryCookie cookie{};
+  crypto_generichash_final(&state, cookie.data(), cookie.size());
+  return cookie;
+}
+
+RetryCookie RetryCookieGenerator::issue(std::string_view source) const {
+  return compute(source, current_window());
+}
+
+bool RetryCookieGenerator::verify(std::span<const std::uint8_t> cookie,
+                                  std::string_view source) const {
+  if (cookie.size() != kRetryCookieSize) {
+    return false;
+  }
+  const auto window = current_window();
+  // SECURITY: Constant-time comparison (CWE-208)
+  const auto current = compute(source, window);
+  if (sodium_memcmp(current.data(), cookie.data(), current.size()) == 0) {
+    return true;
+  }
+  if (window == 0) {
+    return false;
+  }
+  const auto previous = compute(source, window - 1);
+  return sodium_memcmp(previous.data(), cookie.data(), previous.size()) == 0;
+}
+
+std::optional<std::span<const std::uint8_t>> RetryCookieGenerator::strip(
+    std::span<const std::uint8_t> packet, std::string_view source) const {
+  if (packet.size() <= kRetryCookieSize) {
+    return std::nullopt;
+  }
+  if (!verify(packet.first(kRetryCookieSize), source)) {
+    return std::nullopt;
+  }
+  return packet.subspan(kRetryCookieSize);
+}
+
+}  // namespace veil::handshake
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace veil::handshake {
+
+/// Size of a stateless retry cookie on the wire.
+inline constexpr std::size_t kRetryCookieSize = 16;
+
+/// Default validity window of a retry cookie. A cookie is accepted in the
+/// window it was issued in and in the following one.
+inline constexpr auto kDefaultRetryCookieWindow = std::chrono::seconds(10);
+
+using RetryCookie = std::array<std::uint8_t, kRetryCookieSize>;
+
+/// Stateless handshake retry cookies (DTLS HelloVerifyRequest / QUIC Retry style).
+///
+/// Under a spoofed-source INIT flood the server answers with a RETRY carrying a
+/// cookie instead of doing the handshake; only INITs that echo a valid cookie are
+/// admitted to AEAD decryption and X25519. The cookie is
+///
+///   BLAKE2b-128(secret, source || window)
+///
+/// so the server keeps no per-client state and verification costs one keyed
+/// hash. The cookie is pseudorandom, so an INIT prefixed with it is still
+/// indistinguishable from random bytes to DPI.
+///
+/// Thread Safety: Thread-safe after construction (the secret is immutable).
+/// @see docs/thread_model.md
+class RetryCookieGenerator {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /// Create a generator with a fresh random secret.
+  /// @param window Validity window of issued cookies.
+  /// @param now_fn Clock function (injectable for tests).
+  explicit RetryCookieGenerator(std::chrono::seconds window = kDefaultRetryCookieWindow,
+                                std::function<Clock::time_point()> now_fn = Clock::now);
+
+  /// SECURITY: Destructor clears the cookie secret.
+  ~RetryCookieGenerator();
+
+  RetryCookieGenerator(const RetryCookieGenerator&) = delete;
+  RetryCookieGenerator& operator=(const RetryCookieGenerator&) = delete;
+  RetryCookieGenerator(RetryCookieGenerator&&) = delete;
+  RetryCookieGenerator& operator=(RetryCookieGenerator&&) = delete;
+
+  /// Issue a cookie bound to `source` (e.g. "host:port") and the current window.
+  [[nodiscard]] RetryCookie issue(std::string_view source) const;
+
+  /// Check a cookie for `source` against the current and previous window.
+  [[nodiscard]] bool verify(std::span<const std::uint8_t> cookie, std::string_view source) const;
+
+  /// If `packet` starts with a valid cookie for `source`, return the remainder
+  /// (the actual INIT). Otherwise return nullopt.
+  [[nodiscard]] std::optional<std::span<const std::uint8_t>> strip(
+      std::span<const std::uint8_t> packet, std::string_view source) const;
+
+ private:
+  [[nodiscard]] std::uint64_t current_window() const;
+  [[nodiscard]] RetryCookie compute(std::string_view source, std::uint64_t window) const;
+
+  std::array<std::uint8_t, 32> secret_{};
+  std::chrono::seconds window_;
+  std::function<Clock::time_point()> now_fn_;
+};
+
+}  // namespace veil::handshake
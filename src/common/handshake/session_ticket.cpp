@@ -1,13 +1,25 @@
 #include "common/handshake/session_ticket.h"
 
 #include <sodium.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <sddl.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #include <algorithm>
+#include <cerrno>
 #include <chrono>
 #include <cstdint>
 #include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
 #include <optional>
 #include <span>
+#include <string>
 #include <vector>
 
 #include "common/crypto/random.h"
@@ -94,26 +106,234 @@ std::optional<veil::handshake::TicketPayload> deserialize_payload(std::span<cons
   return payload;
 }
 
+void write_u16_be(std::vector<std::uint8_t>& out, std::size_t value) {
+  out.push_back(static_cast<std::uint8_t>((value >> 8) & 0xFF));
+  out.push_back(static_cast<std::uint8_t>(value & 0xFF));
+}
+
+void append_u64_be(std::vector<std::uint8_t>& out, std::uint64_t value) {
+  std::array<std::uint8_t, 8> bytes{};
+  write_u64_be(bytes.data(), value);
+  out.insert(out.end(), bytes.begin(), bytes.end());
+}
+
+// Bounds-checked sequential reader for the on-disk formats.
+class ByteReader {
+ public:
+  explicit ByteReader(std::span<const std::uint8_t> data) : data_(data) {}
+
+  bool read(std::span<std::uint8_t> out) {
+    if (data_.size() - offset_ < out.size()) {
+      return false;
+    }
+    std::copy_n(data_.begin() + static_cast<std::ptrdiff_t>(offset_), out.size(), out.begin());
+    offset_ += out.size();
+    return true;
+  }
+
+  bool read_u16(std::size_t& value) {
+    std::array<std::uint8_t, 2> bytes{};
+    if (!read(bytes)) {
+      return false;
+    }
+    value = (static_cast<std::size_t>(bytes[0]) << 8) | bytes[1];
+    return true;
+  }
+
+  bool read_u64(std::uint64_t& value) {
+    std::array<std::uint8_t, 8> bytes{};
+    if (!read(bytes)) {
+      return false;
+    }
+    value = read_u64_be(bytes.data());
+    return true;
+  }
+
+  bool read_bytes(std::size_t size, std::vector<std::uint8_t>& out) {
+    if (data_.size() - offset_ < size) {
+      return false;
+    }
+    out.assign(data_.begin() + static_cast<std::ptrdiff_t>(offset_),
+               data_.begin() + static_cast<std::ptrdiff_t>(offset_ + size));
+    offset_ += size;
+    return true;
+  }
+
+  bool done() const { return offset_ == data_.size(); }
+
+ private:
+  std::span<const std::uint8_t> data_;
+  std::size_t offset_{0};
+};
+
+// Write `data` to `path` via a temporary file and rename, so a crash never
+// leaves a truncated file behind.
+// SECURITY: The temporary file is created exclusively under an unpredictable name and
+// is owner-only from the start, so no key byte is ever readable by anyone else.
+#ifdef _WIN32
+bool write_file_atomic(const std::string& path, std::span<const std::uint8_t> data,
+                       std::error_code& ec) {
+  const auto last_error = [] {
+    return std::error_code(static_cast<int>(GetLastError()), std::system_category());
+  };
+  // Protected DACL: full access for the owner and SYSTEM only, nothing inherited.
+  PSECURITY_DESCRIPTOR descriptor = nullptr;
+  if (!ConvertStringSecurityDescriptorToSecurityDescriptorA(
+          "D:P(A;;FA;;;OW)(A;;FA;;;SY)", SDDL_REVISION_1, &descriptor, nullptr)) {
+    ec = last_error();
+    return false;
+  }
+  SECURITY_ATTRIBUTES attributes{};
+  attributes.nLength = sizeof(attributes);
+  attributes.lpSecurityDescriptor = descriptor;
+  attributes.bInheritHandle = FALSE;
+
+  std::string tmp_path;
+  HANDLE file = INVALID_HANDLE_VALUE;
+  for (int attempt = 0; attempt < 8 && file == INVALID_HANDLE_VALUE; ++attempt) {
+    tmp_path = path + ".tmp" + std::to_string(veil::crypto::random_uint64());
+    file = CreateFileA(tmp_path.c_str(), GENERIC_WRITE, 0, &attributes, CREATE_NEW,
+                       FILE_ATTRIBUTE_NORMAL, nullptr);
+  }
+  LocalFree(descriptor);
+  if (file == INVALID_HANDLE_VALUE) {
+    ec = last_error();
+    return false;
+  }
+  DWORD written = 0;
+  const bool ok = WriteFile(file, data.data(), static_cast<DWORD>(data.size()), &written,
+                            nullptr) != 0 &&
+                  written == data.size() && FlushFileBuffers(file) != 0;
+  if (!ok) {
+    ec = last_error();
+  }
+  CloseHandle(file);
+  if (!ok || MoveFileExA(tmp_path.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) == 0) {
+    if (ok) {
+      ec = last_error();
+    }
+    DeleteFileA(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+#else
+bool write_file_atomic(const std::string& path, std::span<const std::uint8_t> data,
+                       std::error_code& ec) {
+  // mkstemp creates the file with O_EXCL and mode 0600.
+  std::string tmp_path = path + ".tmpXXXXXX";
+  const int fd = ::mkstemp(tmp_path.data());
+  if (fd < 0) {
+    ec = std::error_code(errno, std::generic_category());
+    return false;
+  }
+  std::size_t offset = 0;
+  while (offset < data.size()) {
+    const auto written = ::write(fd, data.data() + offset, data.size() - offset);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    offset += static_cast<std::size_t>(written);
+  }
+  if (offset != data.size() || ::fsync(fd) != 0) {
+    ec = std::error_code(errno, std::generic_category());
+    ::close(fd);
+    ::unlink(tmp_path.c_str());
+    return false;
+  }
+  ::close(fd);
+  if (::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    ec = std::error_code(errno, std::generic_category());
+    ::unlink(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+#endif
+
+std::optional<std::vector<std::uint8_t>> read_file(const std::string& path, std::error_code& ec) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    ec = std::make_error_code(std::errc::no_such_file_or_directory);
+    return std::nullopt;
+  }
+  std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(file)),
+                                 std::istreambuf_iterator<char>());
+  return data;
+}
+
+// Key ring file: magic(4) | flags(1) | current created(8) | current key(32) |
+//                previous created(8) | previous key(32)
+constexpr std::array<std::uint8_t, 4> kKeyFileMagic{'V', 'T', 'K', '1'};
+constexpr std::uint8_t kKeyFileHasPrevious = 0x01;
+constexpr std::size_t kKeyFileSize = 4 + 1 + 2 * (8 + veil::handshake::kTicketKeySize);
+
+// Ticket cache file: magic(4) | nonce(12) | AEAD(entries), magic as associated data.
+constexpr std::array<std::uint8_t, 4> kStoreFileMagic{'V', 'T', 'S', '1'};
+
 }  // namespace
 
 namespace veil::handshake {
 
+crypto::SessionKeys reverse_session_keys(const crypto::SessionKeys& keys) {
+  crypto::SessionKeys reversed;
+  reversed.send_key = keys.recv_key;
+  reversed.recv_key = keys.send_key;
+  reversed.send_nonce = keys.recv_nonce;
+  reversed.recv_nonce = keys.send_nonce;
+  return reversed;
+}
+
+std::vector<std::uint8_t> encode_ticket_message(const SessionTicket& ticket) {
+  std::vector<std::uint8_t> body;
+  body.reserve(8 + ticket.ticket_data.size());
+  append_u64_be(body, ticket.lifetime_ms);
+  body.insert(body.end(), ticket.ticket_data.begin(), ticket.ticket_data.end());
+  return body;
+}
+
+std::optional<SessionTicket> decode_ticket_message(std::span<const std::uint8_t> body,
+                                                   const crypto::SessionKeys& keys,
+                                                   std::uint64_t now_ms) {
+  // lifetime(8) + at least one byte of opaque ticket data
+  if (body.size() <= 8) {
+    return std::nullopt;
+  }
+  SessionTicket ticket;
+  ticket.lifetime_ms = read_u64_be(body.data());
+  ticket.issued_at_ms = now_ms;
+  ticket.ticket_data.assign(body.begin() + 8, body.end());
+  ticket.cached_keys = keys;
+  return ticket;
+}
+
 // =============================================================================
 // SessionTicketManager Implementation
 // =============================================================================
 
 SessionTicketManager::SessionTicketManager(std::chrono::milliseconds ticket_lifetime,
-                                           std::function<Clock::time_point()> now_fn)
-    : ticket_lifetime_(ticket_lifetime), now_fn_(std::move(now_fn)) {
+                                           std::function<Clock::time_point()> now_fn,
+                                           std::chrono::milliseconds rotation_interval)
+    : ticket_lifetime_(ticket_lifetime),
+      rotation_interval_(rotation_interval.count() > 0 ? rotation_interval : ticket_lifetime),
+      now_fn_(std::move(now_fn)),
+      used_nonces_(kMaxTotalTickets, ticket_lifetime) {
   // Generate a random ticket encryption key
   auto key_bytes = crypto::random_bytes(kTicketKeySize);
-  std::copy_n(key_bytes.begin(), kTicketKeySize, ticket_key_.begin());
+  std::copy_n(key_bytes.begin(), kTicketKeySize, current_key_.key.begin());
   sodium_memzero(key_bytes.data(), key_bytes.size());
+  current_key_.created_at_ms = to_millis(now_fn_());
 }
 
 SessionTicketManager::~SessionTicketManager() {
-  // SECURITY: Clear ticket encryption key
-  sodium_memzero(ticket_key_.data(), ticket_key_.size());
+  // SECURITY: Clear ticket encryption keys
+  sodium_memzero(current_key_.key.data(), current_key_.key.size());
+  if (previous_key_) {
+    sodium_memzero(previous_key_->key.data(), previous_key_->key.size());
+  }
 }
 
 SessionTicket SessionTicketManager::issue_ticket(const crypto::SessionKeys& keys,
@@ -142,7 +362,13 @@ SessionTicket SessionTicketManager::issue_ticket(const crypto::SessionKeys& keys
   std::array<std::uint8_t, crypto::kNonceLen> nonce{};
   std::copy_n(nonce_bytes.begin(), nonce.size(), nonce.begin());
 
-  auto ciphertext = crypto::aead_encrypt(ticket_key_, nonce, {}, plaintext);
+  std::array<std::uint8_t, kTicketKeySize> ticket_key{};
+  {
+    std::lock_guard lock(key_mutex_);
+    ticket_key = current_key_.key;
+  }
+  auto ciphertext = crypto::aead_encrypt(ticket_key, nonce, {}, plaintext);
+  sodium_memzero(ticket_key.data(), ticket_key.size());
 
   // SECURITY: Clear plaintext after encryption
   sodium_memzero(plaintext.data(), plaintext.size());
@@ -164,14 +390,8 @@ SessionTicket SessionTicketManager::issue_ticket(const crypto::SessionKeys& keys
   return ticket;
 }
 
-std::optional<TicketPayload> SessionTicketManager::validate_ticket(
-    std::span<const std::uint8_t> ticket_data) {
-  // Minimum size: nonce(12) + payload(104) + tag(16)
-  constexpr std::size_t min_ticket_size = crypto::kNonceLen + kTicketPayloadSize + kAeadTagLen;
-  if (ticket_data.size() != min_ticket_size) {
-    return std::nullopt;
-  }
-
+std::optional<TicketPayload> SessionTicketManager::open_ticket(
+    std::span<const std::uint8_t> ticket_data, const TicketKey& key) const {
   // Extract nonce
   std::array<std::uint8_t, crypto::kNonceLen> nonce{};
   std::copy_n(ticket_data.begin(), nonce.size(), nonce.begin());
@@ -180,7 +400,7 @@ std::optional<TicketPayload> SessionTicketManager::validate_ticket(
   auto ciphertext = ticket_data.subspan(crypto::kNonceLen);
 
   // Decrypt
-  auto plaintext = crypto::aead_decrypt(ticket_key_, nonce, {}, ciphertext);
+  auto plaintext = crypto::aead_decrypt(key.key, nonce, {}, ciphertext);
   if (!plaintext.has_value()) {
     return std::nullopt;
   }
@@ -189,6 +409,37 @@ std::optional<TicketPayload> SessionTicketManager::validate_ticket(
 
   // SECURITY: Clear plaintext
   sodium_memzero(plaintext->data(), plaintext->size());
+  return payload;
+}
+
+std::optional<TicketPayload> SessionTicketManager::validate_ticket(
+    std::span<const std::uint8_t> ticket_data) {
+  // Minimum size: nonce(12) + payload(104) + tag(16)
+  constexpr std::size_t min_ticket_size = crypto::kNonceLen + kTicketPayloadSize + kAeadTagLen;
+  if (ticket_data.size() != min_ticket_size) {
+    return std::nullopt;
+  }
+
+  // Copy the key ring out so the AEAD work runs without holding the lock.
+  TicketKey current;
+  std::optional<TicketKey> previous;
+  {
+    std::lock_guard lock(key_mutex_);
+    current = current_key_;
+    previous = previous_key_;
+  }
+
+  // Tickets sealed before the last rotation are still accepted.
+  auto payload = open_ticket(ticket_data, current);
+  if (!payload.has_value() && previous.has_value()) {
+    payload = open_ticket(ticket_data, *previous);
+  }
+
+  // SECURITY: Clear key copies
+  sodium_memzero(current.key.data(), current.key.size());
+  if (previous) {
+    sodium_memzero(previous->key.data(), previous->key.size());
+  }
 
   if (!payload.has_value()) {
     return std::nullopt;
@@ -208,45 +459,114 @@ std::optional<TicketPayload> SessionTicketManager::validate_ticket(
 
 bool SessionTicketManager::check_and_mark_nonce(
     std::span<const std::uint8_t, kAntiReplayNonceSize> nonce) {
-  // FNV-1a hash the nonce for compact storage.
-  // Trade-off: with ~4096 active nonces, collision probability is ~2^-49 (negligible).
-  // A hash collision would cause a false positive (legitimate request falsely rejected as replay),
-  // which is acceptable for this use case — the client simply falls back to a 1-RTT handshake.
-  std::uint64_t nonce_hash = 14695981039346656037ULL;
-  for (std::size_t i = 0; i < kAntiReplayNonceSize; ++i) {
-    nonce_hash ^= static_cast<std::uint64_t>(nonce[i]);
-    nonce_hash *= 1099511628211ULL;
+  // The table hashes the full nonce (keyed SipHash) and keeps it for at least the
+  // ticket lifetime. A fingerprint collision only causes a false replay, and the
+  // client falls back to a 1-RTT handshake.
+  return used_nonces_.mark_and_check(nonce, to_millis(now_fn_()));
+}
+
+void SessionTicketManager::cleanup_expired_nonces() {
+  used_nonces_.cleanup_expired(to_millis(now_fn_()));
+}
+
+void SessionTicketManager::rotate_keys() {
+  TicketKey fresh;
+  auto key_bytes = crypto::random_bytes(kTicketKeySize);
+  std::copy_n(key_bytes.begin(), kTicketKeySize, fresh.key.begin());
+  sodium_memzero(key_bytes.data(), key_bytes.size());
+  fresh.created_at_ms = to_millis(now_fn_());
+
+  std::lock_guard lock(key_mutex_);
+  if (previous_key_) {
+    sodium_memzero(previous_key_->key.data(), previous_key_->key.size());
   }
+  previous_key_ = current_key_;
+  current_key_ = fresh;
+  sodium_memzero(fresh.key.data(), fresh.key.size());
+}
 
+bool SessionTicketManager::maybe_rotate_keys() {
   const auto now_ms = to_millis(now_fn_());
-  const auto expiry_ms = now_ms + static_cast<std::uint64_t>(ticket_lifetime_.count());
+  {
+    std::lock_guard lock(key_mutex_);
+    if (now_ms < current_key_.created_at_ms + static_cast<std::uint64_t>(rotation_interval_.count())) {
+      return false;
+    }
+  }
+  rotate_keys();
+  return true;
+}
 
-  std::lock_guard lock(nonce_mutex_);
+bool SessionTicketManager::save_keys(const std::string& path, std::error_code& ec) const {
+  std::vector<std::uint8_t> data;
+  data.reserve(kKeyFileSize);
+  data.insert(data.end(), kKeyFileMagic.begin(), kKeyFileMagic.end());
+  {
+    std::lock_guard lock(key_mutex_);
+    data.push_back(previous_key_ ? kKeyFileHasPrevious : 0);
+    append_u64_be(data, current_key_.created_at_ms);
+    data.insert(data.end(), current_key_.key.begin(), current_key_.key.end());
+    const TicketKey empty{};
+    const auto& previous = previous_key_ ? *previous_key_ : empty;
+    append_u64_be(data, previous.created_at_ms);
+    data.insert(data.end(), previous.key.begin(), previous.key.end());
+  }
+  const bool ok = write_file_atomic(path, data, ec);
+  // SECURITY: Clear serialized keys
+  sodium_memzero(data.data(), data.size());
+  return ok;
+}
 
-  auto it = used_nonces_.find(nonce_hash);
-  if (it != used_nonces_.end()) {
-    return true;  // Replay detected
+bool SessionTicketManager::load_keys(const std::string& path, std::error_code& ec) {
+  auto data = read_file(path, ec);
+  if (!data) {
+    return false;
   }
 
-  // Limit nonce cache size
-  if (used_nonces_.size() >= kMaxTotalTickets) {
-    cleanup_expired_nonces();
+  ByteReader reader(*data);
+  std::array<std::uint8_t, 4> magic{};
+  std::array<std::uint8_t, 1> flags{};
+  TicketKey current;
+  TicketKey previous;
+  const bool parsed = data->size() == kKeyFileSize && reader.read(magic) && magic == kKeyFileMagic &&
+                      reader.read(flags) && reader.read_u64(current.created_at_ms) &&
+                      reader.read(current.key) && reader.read_u64(previous.created_at_ms) &&
+                      reader.read(previous.key);
+  // SECURITY: Clear file contents
+  sodium_memzero(data->data(), data->size());
+  if (!parsed) {
+    sodium_memzero(current.key.data(), current.key.size());
+    sodium_memzero(previous.key.data(), previous.key.size());
+    ec = std::make_error_code(std::errc::invalid_argument);
+    return false;
   }
 
-  used_nonces_[nonce_hash] = expiry_ms;
-  return false;
+  {
+    std::lock_guard lock(key_mutex_);
+    sodium_memzero(current_key_.key.data(), current_key_.key.size());
+    if (previous_key_) {
+      sodium_memzero(previous_key_->key.data(), previous_key_->key.size());
+    }
+    current_key_ = current;
+    if ((flags[0] & kKeyFileHasPrevious) != 0) {
+      previous_key_ = previous;
+    } else {
+      previous_key_.reset();
+    }
+  }
+  sodium_memzero(current.key.data(), current.key.size());
+  sodium_memzero(previous.key.data(), previous.key.size());
+  return true;
 }
 
-void SessionTicketManager::cleanup_expired_nonces() {
-  // Note: caller must hold nonce_mutex_ (or this is called from check_and_mark_nonce which holds it)
-  const auto now_ms = to_millis(now_fn_());
-  for (auto it = used_nonces_.begin(); it != used_nonces_.end();) {
-    if (it->second <= now_ms) {
-      it = used_nonces_.erase(it);
-    } else {
-      ++it;
+bool SessionTicketManager::load_or_create_keys(const std::string& path, std::error_code& ec) {
+  if (!std::filesystem::exists(path, ec)) {
+    if (ec) {
+      return false;
     }
+    return save_keys(path, ec);
   }
+  return load_keys(path, ec);
 }
 
 std::uint64_t SessionTicketManager::fnv1a_hash(const std::string& str) {
@@ -323,4 +643,148 @@ std::size_t SessionTicketStore::size() const {
   return tickets_.size();
 }
 
+std::array<std::uint8_t, kTicketStoreKeySize> SessionTicketStore::derive_storage_key(
+    std::span<const std::uint8_t> psk) {
+  static constexpr std::array<std::uint8_t, 17> kSalt{'v', 'e', 'i', 'l', '-', 't', 'i', 'c', 'k',
+                                                      'e', 't', '-', 's', 't', 'o', 'r', 'e'};
+  static constexpr std::array<std::uint8_t, 12> kInfo{'c', 'a', 'c', 'h', 'e', '-',
+                                                      'k', 'e', 'y', '-', 'v', '1'};
+  auto prk = crypto::hkdf_extract(kSalt, psk);
+  auto okm = crypto::hkdf_expand(prk, kInfo, kTicketStoreKeySize);
+  std::array<std::uint8_t, kTicketStoreKeySize> key{};
+  std::copy_n(okm.begin(), key.size(), key.begin());
+  // SECURITY: Clear intermediate key material
+  sodium_memzero(prk.data(), prk.size());
+  sodium_memzero(okm.data(), okm.size());
+  return key;
+}
+
+bool SessionTicketStore::save(const std::string& path,
+                              std::span<const std::uint8_t, kTicketStoreKeySize> storage_key,
+                              std::error_code& ec) const {
+  const auto now_ms = to_millis(now_fn_());
+
+  // Entry: server_id_len(2) | server_id | ticket_len(2) | ticket | issued(8) |
+  //        lifetime(8) | send_key(32) | recv_key(32) | send_nonce(12) |
+  //        recv_nonce(12) | client_id_len(2) | client_id
+  std::vector<std::uint8_t> plaintext(4, 0);
+  std::uint32_t count = 0;
+  {
+    std::lock_guard lock(mutex_);
+    for (const auto& [server_id, ticket] : tickets_) {
+      if (ticket.is_expired(now_ms) || server_id.size() > 0xFFFF ||
+          ticket.ticket_data.size() > 0xFFFF || ticket.client_id.size() > 0xFFFF) {
+        continue;
+      }
+      write_u16_be(plaintext, server_id.size());
+      plaintext.insert(plaintext.end(), server_id.begin(), server_id.end());
+      write_u16_be(plaintext, ticket.ticket_data.size());
+      plaintext.insert(plaintext.end(), ticket.ticket_data.begin(), ticket.ticket_data.end());
+      append_u64_be(plaintext, ticket.issued_at_ms);
+      append_u64_be(plaintext, ticket.lifetime_ms);
+      const auto& keys = ticket.cached_keys;
+      plaintext.insert(plaintext.end(), keys.send_key.begin(), keys.send_key.end());
+      plaintext.insert(plaintext.end(), keys.recv_key.begin(), keys.recv_key.end());
+      plaintext.insert(plaintext.end(), keys.send_nonce.begin(), keys.send_nonce.end());
+      plaintext.insert(plaintext.end(), keys.recv_nonce.begin(), keys.recv_nonce.end());
+      write_u16_be(plaintext, ticket.client_id.size());
+      plaintext.insert(plaintext.end(), ticket.client_id.begin(), ticket.client_id.end());
+      ++count;
+    }
+  }
+  for (std::size_t i = 0; i < 4; ++i) {
+    plaintext[i] = static_cast<std::uint8_t>((count >> (24 - 8 * i)) & 0xFF);
+  }
+
+  std::array<std::uint8_t, crypto::kNonceLen> nonce{};
+  const auto nonce_bytes = crypto::random_bytes(nonce.size());
+  std::copy_n(nonce_bytes.begin(), nonce.size(), nonce.begin());
+  const auto ciphertext = crypto::aead_encrypt(storage_key, nonce, kStoreFileMagic, plaintext);
+  // SECURITY: Clear serialized resumption keys
+  sodium_memzero(plaintext.data(), plaintext.size());
+
+  std::vector<std::uint8_t> data;
+  data.reserve(kStoreFileMagic.size() + nonce.size() + ciphertext.size());
+  data.insert(data.end(), kStoreFileMagic.begin(), kStoreFileMagic.end());
+  data.insert(data.end(), nonce.begin(), nonce.end());
+  data.insert(data.end(), ciphertext.begin(), ciphertext.end());
+  return write_file_atomic(path, data, ec);
+}
+
+bool SessionTicketStore::load(const std::string& path,
+                              std::span<const std::uint8_t, kTicketStoreKeySize> storage_key,
+                              std::error_code& ec) {
+  if (!std::filesystem::exists(path, ec)) {
+    // No cache yet (first run): nothing to load.
+    return !ec;
+  }
+  auto data = read_file(path, ec);
+  if (!data) {
+    return false;
+  }
+
+  ByteReader header(*data);
+  std::array<std::uint8_t, 4> magic{};
+  std::array<std::uint8_t, crypto::kNonceLen> nonce{};
+  if (!header.read(magic) || magic != kStoreFileMagic || !header.read(nonce)) {
+    ec = std::make_error_code(std::errc::invalid_argument);
+    return false;
+  }
+  const auto ciphertext =
+      std::span<const std::uint8_t>(*data).subspan(kStoreFileMagic.size() + nonce.size());
+  auto plaintext = crypto::aead_decrypt(storage_key, nonce, kStoreFileMagic, ciphertext);
+  if (!plaintext) {
+    // Wrong key (PSK changed) or tampered file.
+    ec = std::make_error_code(std::errc::permission_denied);
+    return false;
+  }
+
+  const auto now_ms = to_millis(now_fn_());
+  std::vector<std::pair<std::string, SessionTicket>> loaded;
+  ByteReader reader(*plaintext);
+  std::array<std::uint8_t, 4> count_bytes{};
+  bool ok = reader.read(count_bytes);
+  const std::uint32_t count = (static_cast<std::uint32_t>(count_bytes[0]) << 24) |
+                              (static_cast<std::uint32_t>(count_bytes[1]) << 16) |
+                              (static_cast<std::uint32_t>(count_bytes[2]) << 8) | count_bytes[3];
+  for (std::uint32_t i = 0; ok && i < count; ++i) {
+    std::size_t len = 0;
+    std::vector<std::uint8_t> server_id;
+    std::vector<std::uint8_t> client_id;
+    SessionTicket ticket;
+    auto& keys = ticket.cached_keys;
+    ok = reader.read_u16(len) && reader.read_bytes(len, server_id) && reader.read_u16(len) &&
+         reader.read_bytes(len, ticket.ticket_data) && reader.read_u64(ticket.issued_at_ms) &&
+         reader.read_u64(ticket.lifetime_ms) && reader.read(keys.send_key) &&
+         reader.read(keys.recv_key) && reader.read(keys.send_nonce) &&
+         reader.read(keys.recv_nonce) && reader.read_u16(len) && reader.read_bytes(len, client_id);
+    if (!ok || ticket.is_expired(now_ms)) {
+      sodium_memzero(keys.send_key.data(), keys.send_key.size());
+      sodium_memzero(keys.recv_key.data(), keys.recv_key.size());
+      continue;
+    }
+    ticket.client_id.assign(client_id.begin(), client_id.end());
+    loaded.emplace_back(std::string(server_id.begin(), server_id.end()), std::move(ticket));
+  }
+  ok = ok && reader.done();
+  // SECURITY: Clear decrypted resumption keys
+  sodium_memzero(plaintext->data(), plaintext->size());
+
+  if (!ok) {
+    for (auto& entry : loaded) {
+      auto& keys = entry.second.cached_keys;
+      sodium_memzero(keys.send_key.data(), keys.send_key.size());
+      sodium_memzero(keys.recv_key.data(), keys.recv_key.size());
+    }
+    ec = std::make_error_code(std::errc::invalid_argument);
+    return false;
+  }
+
+  std::lock_guard lock(mutex_);
+  for (auto& [server_id, ticket] : loaded) {
+    tickets_.insert_or_assign(std::move(server_id), std::move(ticket));
+  }
+  return true;
+}
+
 }  // namespace veil::handshake
@@ -6,11 +6,14 @@
 #include <functional>
 #include <mutex>
 #include <optional>
+#include <span>
 #include <string>
+#include <system_error>
 #include <unordered_map>
 #include <vector>
 
 #include "common/crypto/crypto_engine.h"
+#include "common/handshake/replay_table.h"
 
 namespace veil::handshake {
 
@@ -31,6 +34,9 @@ inline constexpr std::size_t kAntiReplayNonceSize = 16;
 /// Size of the ticket encryption key (server-only secret).
 inline constexpr std::size_t kTicketKeySize = 32;
 
+/// Size of the key protecting the client's on-disk ticket cache.
+inline constexpr std::size_t kTicketStoreKeySize = 32;
+
 /// Session ticket issued by the server after a successful handshake.
 /// The client caches this and presents it on reconnection for 0-RTT.
 ///
@@ -73,8 +79,31 @@ struct TicketPayload {
   std::array<std::uint8_t, crypto::kNonceLen> recv_nonce{};
 };
 
+/// The peer's view of `keys`: send and receive directions swapped.
+/// Tickets carry the client's view, so the server reverses its own session keys
+/// when issuing one and reverses the ticket's keys again when resuming.
+crypto::SessionKeys reverse_session_keys(const crypto::SessionKeys& keys);
+
+/// Encode the body of a session ticket control message (server -> client):
+/// lifetime_ms(8) | ticket_data. Session keys never leave the server.
+std::vector<std::uint8_t> encode_ticket_message(const SessionTicket& ticket);
+
+/// Decode a session ticket control message into a ticket for the client's store.
+/// @param keys The client's keys for the session the message arrived on.
+/// @param now_ms Receive time (milliseconds since epoch), used as the issue time.
+std::optional<SessionTicket> decode_ticket_message(std::span<const std::uint8_t> body,
+                                                   const crypto::SessionKeys& keys,
+                                                   std::uint64_t now_ms);
+
 /// Server-side ticket manager that issues and validates session tickets.
 ///
+/// Ticket keys rotate: new tickets are sealed with the current key, and tickets
+/// sealed with the previous key are still accepted. With the default rotation
+/// interval (the ticket lifetime) every ticket stays valid for its whole life.
+/// The key ring can be persisted with save_keys()/load_keys() so a restarted
+/// server still accepts tickets issued before the restart, and reconnecting
+/// clients resume with 0-RTT instead of a full X25519 handshake.
+///
 /// Thread safety: All public methods are thread-safe (internally synchronized).
 ///
 /// Usage:
@@ -97,10 +126,12 @@ class SessionTicketManager {
   /// Create a ticket manager with a random encryption key.
   /// @param ticket_lifetime How long tickets remain valid.
   /// @param now_fn Clock function for timestamp generation.
+  /// @param rotation_interval Ticket key rotation period (0 = ticket_lifetime).
   explicit SessionTicketManager(
       std::chrono::milliseconds ticket_lifetime =
           std::chrono::duration_cast<std::chrono::milliseconds>(kDefaultTicketLifetime),
-      std::function<Clock::time_point()> now_fn = Clock::now);
+      std::function<Clock::time_point()> now_fn = Clock::now,
+      std::chrono::milliseconds rotation_interval = std::chrono::milliseconds(0));
 
   /// SECURITY: Destructor clears ticket encryption key.
   ~SessionTicketManager();
@@ -109,7 +140,7 @@ class SessionTicketManager {
   SessionTicketManager(const SessionTicketManager&) = delete;
   SessionTicketManager& operator=(const SessionTicketManager&) = delete;
 
-  // Non-movable (contains mutex).
+  // Non-movable (contains the anti-replay table).
   SessionTicketManager(SessionTicketManager&&) = delete;
   SessionTicketManager& operator=(SessionTicketManager&&) = delete;
 
@@ -135,17 +166,48 @@ class SessionTicketManager {
   /// Get the current ticket lifetime.
   std::chrono::milliseconds ticket_lifetime() const { return ticket_lifetime_; }
 
+  /// Replace the current key with a fresh random one; the old current key
+  /// becomes the previous key and the old previous key is discarded.
+  void rotate_keys();
+
+  /// Rotate if the current key is older than the rotation interval.
+  /// @return true if the keys were rotated (callers persisting keys should save).
+  bool maybe_rotate_keys();
+
+  /// Persist the key ring (current and previous key) to `path`.
+  /// The file is written atomically and readable only by the owner.
+  bool save_keys(const std::string& path, std::error_code& ec) const;
+
+  /// Replace the key ring with the one stored at `path`.
+  bool load_keys(const std::string& path, std::error_code& ec);
+
+  /// Load the key ring from `path`, or save the current one if the file does not exist.
+  bool load_or_create_keys(const std::string& path, std::error_code& ec);
+
  private:
+  struct TicketKey {
+    std::array<std::uint8_t, kTicketKeySize> key{};
+    std::uint64_t created_at_ms{0};
+  };
+
   /// Compute FNV-1a hash of a string for fast lookup.
   static std::uint64_t fnv1a_hash(const std::string& str);
 
-  std::array<std::uint8_t, kTicketKeySize> ticket_key_{};
+  std::optional<TicketPayload> open_ticket(std::span<const std::uint8_t> ticket_data,
+                                           const TicketKey& key) const;
+
   std::chrono::milliseconds ticket_lifetime_;
+  std::chrono::milliseconds rotation_interval_;
   std::function<Clock::time_point()> now_fn_;
 
-  /// Anti-replay nonce tracking: nonce -> expiry timestamp (ms).
-  mutable std::mutex nonce_mutex_;
-  std::unordered_map<std::uint64_t, std::uint64_t> used_nonces_;
+  /// Ticket key ring. Guarded by key_mutex_; copied out under the lock so the
+  /// AEAD work itself runs unlocked.
+  mutable std::mutex key_mutex_;
+  TicketKey current_key_;
+  std::optional<TicketKey> previous_key_;
+
+  /// Anti-replay nonce tracking (lock-free, fixed size, expires by bucket rotation).
+  TimeBucketedReplayTable used_nonces_;
 };
 
 /// Client-side ticket store for caching session tickets.
@@ -190,6 +252,23 @@ class SessionTicketStore {
   /// Get the number of cached tickets.
   std::size_t size() const;
 
+  /// Derive the key protecting the on-disk cache from the client's PSK.
+  static std::array<std::uint8_t, kTicketStoreKeySize> derive_storage_key(
+      std::span<const std::uint8_t> psk);
+
+  /// Write all non-expired tickets to `path`, encrypted with `storage_key`.
+  /// The cache holds resumption keys, so it is AEAD-sealed, written atomically
+  /// and readable only by the owner.
+  bool save(const std::string& path,
+            std::span<const std::uint8_t, kTicketStoreKeySize> storage_key,
+            std::error_code& ec) const;
+
+  /// Merge the non-expired tickets stored at `path` into this store.
+  /// A missing file is not an error; a corrupt or foreign file is.
+  bool load(const std::string& path,
+            std::span<const std::uint8_t, kTicketStoreKeySize> storage_key,
+            std::error_code& ec);
+
  private:
   std::function<Clock::time_point()> now_fn_;
   mutable std::mutex mutex_;
@@ -1,6 +1,7 @@
 #include "common/session/replay_window.h"
 
 #include <algorithm>
+#include <bit>
 #include <cstddef>
 #include <cstdint>
 #include <limits>
@@ -10,29 +11,47 @@ namespace veil::session {
 
 namespace {
 constexpr std::size_t kBitsPerWord = std::numeric_limits<std::uint64_t>::digits;
+
+// Words for the window plus the spare one, rounded up to a power of two.
+std::size_t ring_words(std::size_t window_size) {
+  return std::bit_ceil((window_size + kBitsPerWord - 1) / kBitsPerWord + 1);
 }
+}  // namespace
 
 ReplayWindow::ReplayWindow(std::size_t window_size)
     : window_size_(window_size),
-      bits_((window_size + kBitsPerWord - 1) / kBitsPerWord) {}
+      bits_(ring_words(window_size)),
+      word_mask_(bits_.size() - 1) {}
+
+bool ReplayWindow::check(std::uint64_t sequence) const {
+  if (!initialized_ || sequence > highest_) {
+    return true;
+  }
+  return highest_ - sequence < window_size_ && !get_bit(sequence);
+}
 
 bool ReplayWindow::mark_and_check(std::uint64_t sequence) {
   if (!initialized_) {
     highest_ = sequence;
     initialized_ = true;
-    set_bit(0);
+    set_bit(sequence);
     return true;
   }
 
   if (sequence > highest_) {
-    const std::size_t delta = static_cast<std::size_t>(sequence - highest_);
-    if (delta >= window_size_) {
+    // Clear the words between the old highest and the new one: they hold sequences
+    // that left the window a full ring ago.
+    const std::uint64_t current_word = highest_ / kBitsPerWord;
+    const std::uint64_t advance = sequence / kBitsPerWord - current_word;
+    if (advance >= bits_.size()) {
       std::fill(bits_.begin(), bits_.end(), 0);
     } else {
-      shift(delta);
+      for (std::uint64_t i = 1; i <= advance; ++i) {
+        bits_[static_cast<std::size_t>((current_word + i) & word_mask_)] = 0;
+      }
     }
     highest_ = sequence;
-    set_bit(0);
+    set_bit(sequence);
     return true;
   }
 
@@ -41,54 +60,28 @@ bool ReplayWindow::mark_and_check(std::uint64_t sequence) {
     return false;
   }
 
-  const std::size_t index = static_cast<std::size_t>(diff);
-  if (get_bit(index)) {
+  if (get_bit(sequence)) {
     return false;
   }
-  set_bit(index);
+  set_bit(sequence);
   return true;
 }
 
-void ReplayWindow::shift(std::size_t delta) {
-  const auto word_shift = delta / kBitsPerWord;
-  const auto bit_shift = delta % kBitsPerWord;
-
-  if (word_shift >= bits_.size()) {
-    std::fill(bits_.begin(), bits_.end(), 0);
-    return;
-  }
-
-  for (std::size_t i = bits_.size(); i-- > 0;) {
-    std::uint64_t value = 0;
-    if (i >= word_shift) {
-      value = bits_[i - word_shift];
-      if (bit_shift != 0) {
-        value <<= bit_shift;
-        if (i > word_shift) {
-          value |= bits_[i - word_shift - 1] >> (kBitsPerWord - bit_shift);
-        }
-      }
-    }
-    bits_[i] = value;
-  }
-  mask_tail();
-}
-
-bool ReplayWindow::get_bit(std::size_t index) const {
-  const auto word = index / kBitsPerWord;
-  const auto bit = index % kBitsPerWord;
+bool ReplayWindow::get_bit(std::uint64_t sequence) const {
+  const auto word = static_cast<std::size_t>((sequence / kBitsPerWord) & word_mask_);
+  const auto bit = sequence % kBitsPerWord;
   return ((bits_[word] >> bit) & 1U) != 0U;
 }
 
-void ReplayWindow::set_bit(std::size_t index) {
-  const auto word = index / kBitsPerWord;
-  const auto bit = index % kBitsPerWord;
+void ReplayWindow::set_bit(std::uint64_t sequence) {
+  const auto word = static_cast<std::size_t>((sequence / kBitsPerWord) & word_mask_);
+  const auto bit = sequence % kBitsPerWord;
   bits_[word] |= (std::uint64_t(1) << bit);
 }
 
-void ReplayWindow::clear_bit(std::size_t index) {
-  const auto word = index / kBitsPerWord;
-  const auto bit = index % kBitsPerWord;
+void ReplayWindow::clear_bit(std::uint64_t sequence) {
+  const auto word = static_cast<std::size_t>((sequence / kBitsPerWord) & word_mask_);
+  const auto bit = sequence % kBitsPerWord;
   bits_[word] &= ~(std::uint64_t(1) << bit);
 }
 
@@ -107,17 +100,7 @@ void ReplayWindow::unmark(std::uint64_t sequence) {
     return;
   }
 
-  const std::size_t index = static_cast<std::size_t>(diff);
-  clear_bit(index);
-}
-
-void ReplayWindow::mask_tail() {
-  const auto remainder = window_size_ % kBitsPerWord;
-  if (remainder == 0) {
-    return;
-  }
-  const std::uint64_t mask = (std::uint64_t(1) << remainder) - 1;
-  bits_.back() &= mask;
+  clear_bit(sequence);
 }
 
 }  // namespace veil::session
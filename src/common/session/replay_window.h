@@ -6,11 +6,22 @@
 
 namespace veil::session {
 
+// Anti-replay window over the last window_size sequences below the highest seen.
+//
+// PERFORMANCE: The bitmap is a ring of 64-bit words indexed by sequence (RFC 6479):
+// sequence s is bit s % 64 of word (s / 64) % words. Advancing the highest sequence
+// only clears the words it enters, so each check is O(1) amortized whatever the window
+// size, where shifting the whole bitmap cost O(window / 64) per packet. One spare word
+// keeps the window's oldest sequences while the newest word is being cleared.
 class ReplayWindow {
  public:
   explicit ReplayWindow(std::size_t window_size = 1024);
   bool mark_and_check(std::uint64_t sequence);
 
+  // Whether mark_and_check() would accept sequence, without marking it: lets a packet
+  // be authenticated before it moves the window.
+  [[nodiscard]] bool check(std::uint64_t sequence) const;
+
   // Issue #78: Unmark sequence to allow retransmission after decryption failure
   void unmark(std::uint64_t sequence);
 
@@ -22,13 +33,13 @@ class ReplayWindow {
   std::size_t window_size_;
   std::uint64_t highest_{0};
   bool initialized_{false};
+  // Ring of words; its size is a power of two, word_mask_ = size - 1.
   std::vector<std::uint64_t> bits_;
+  std::uint64_t word_mask_;
 
-  void shift(std::size_t delta);
-  bool get_bit(std::size_t index) const;
-  void set_bit(std::size_t index);
-  void clear_bit(std::size_t index);
-  void mask_tail();
+  bool get_bit(std::uint64_t sequence) const;
+  void set_bit(std::uint64_t sequence);
+  void clear_bit(std::uint64_t sequence);
 };
 
 }  // namespace veil::session
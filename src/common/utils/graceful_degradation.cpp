@@ -50,6 +50,7 @@ DegradationActions get_default_actions(DegradationLevel level) {
       actions.retransmit_multiplier = 1.5;
       actions.accept_new_connections = true;
       actions.drop_low_priority = true;
+      actions.require_handshake_cookie = true;
       break;
 
     case DegradationLevel::kSevere:
@@ -58,6 +59,7 @@ DegradationActions get_default_actions(DegradationLevel level) {
       actions.retransmit_multiplier = 2.0;
       actions.accept_new_connections = false;
       actions.drop_low_priority = true;
+      actions.require_handshake_cookie = true;
       break;
 
     case DegradationLevel::kCritical:
@@ -66,6 +68,7 @@ DegradationActions get_default_actions(DegradationLevel level) {
       actions.retransmit_multiplier = 3.0;
       actions.accept_new_connections = false;
       actions.drop_low_priority = true;
+      actions.require_handshake_cookie = true;
       actions.max_concurrent_ops = 10;
       break;
   }
@@ -219,6 +222,22 @@ DegradationLevel GracefulDegradation::calculate_level(const SystemMetrics& metri
     }
   }
 
+  // Check queue pressure (e.g. pending handshakes under a connection storm).
+  if (metrics.max_packet_queue > 0) {
+    double queue_pct = (static_cast<double>(metrics.pending_packets) /
+                        static_cast<double>(metrics.max_packet_queue)) *
+                       100.0;
+    if (queue_pct >= config_.queue_critical_threshold) {
+      return DegradationLevel::kCritical;
+    }
+    if (queue_pct >= config_.queue_severe_threshold) {
+      return DegradationLevel::kSevere;
+    }
+    if (queue_pct >= config_.queue_moderate_threshold) {
+      return DegradationLevel::kModerate;
+    }
+  }
+
   return DegradationLevel::kNormal;
 }
 
@@ -267,6 +286,16 @@ bool GracefulDegradation::should_recover([[maybe_unused]] DegradationLevel new_l
       return true;
   }
 
+  // Queue pressure must also have eased before recovering.
+  if (level >= DegradationLevel::kModerate && last_metrics_.max_packet_queue > 0) {
+    double queue_pct = (static_cast<double>(last_metrics_.pending_packets) /
+                        static_cast<double>(last_metrics_.max_packet_queue)) *
+                       100.0;
+    if (queue_pct >= config_.queue_moderate_threshold - config_.recovery_hysteresis) {
+      return false;
+    }
+  }
+
   // Must be below threshold - hysteresis.
   return last_metrics_.cpu_usage_percent < (cpu_threshold - config_.recovery_hysteresis) &&
          last_metrics_.memory_usage_percent < (mem_threshold - config_.recovery_hysteresis);
@@ -42,6 +42,11 @@ struct DegradationConfig {
   double connections_severe_threshold{90.0};
   double connections_critical_threshold{95.0};
 
+  // Packet/handshake queue thresholds (percentage of max_packet_queue).
+  double queue_moderate_threshold{50.0};
+  double queue_severe_threshold{75.0};
+  double queue_critical_threshold{90.0};
+
   // Hysteresis - percentage below threshold before recovery.
   double recovery_hysteresis{5.0};
 
@@ -80,6 +85,8 @@ struct DegradationActions {
   bool accept_new_connections{true};
   // Whether to drop low-priority traffic.
   bool drop_low_priority{false};
+  // Whether new handshakes must echo a stateless retry cookie before any crypto.
+  bool require_handshake_cookie{false};
   // Maximum concurrent operations.
   std::optional<std::size_t> max_concurrent_ops;
 };
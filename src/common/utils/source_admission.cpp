@@ -0,0 +1,200 @@
+#include "common/utils/source_admission.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <string>
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#endif
+
+#include "common/crypto/random.h"
+
+namespace veil::utils {
+
+namespace {
+
+// Tags keep IPv4 and IPv6 prefixes from mapping to the same key.
+constexpr std::uint64_t kIpv4Tag = 0x4ULL << 56;
+constexpr std::uint64_t kIpv6Tag = 0x9E3779B97F4A7C15ULL;
+
+std::uint64_t prefix_mask(std::uint8_t prefix_len, std::uint8_t bits) {
+  const auto len = std::min(prefix_len, bits);
+  if (len == 0) {
+    return 0;
+  }
+  const std::uint64_t all = bits == 64 ? ~0ULL : ((1ULL << bits) - 1);
+  return all & ~((1ULL << (bits - len)) - 1);
+}
+
+// Statistics counter increment without a locked RMW (may lose counts under contention).
+void bump(std::atomic<std::uint64_t>& counter) {
+  counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+SourceAdmissionFilter::SourceAdmissionFilter(SourceAdmissionConfig config,
+                                             std::function<Clock::time_point()> now_fn)
+    : config_(config), now_fn_(std::move(now_fn)) {
+  config_.width = std::bit_ceil(std::max<std::size_t>(config_.width, 1));
+  config_.depth = std::clamp<std::size_t>(config_.depth, 1, kMaxSourceAdmissionDepth);
+  config_.threshold = std::max<std::uint16_t>(config_.threshold, 1);
+  if (config_.decay_interval.count() <= 0) {
+    config_.decay_interval = SourceAdmissionConfig{}.decay_interval;
+  }
+  mask_ = config_.width - 1;
+
+  const auto seed_bytes = crypto::random_bytes(sizeof(std::uint64_t) * config_.depth);
+  std::memcpy(seeds_.data(), seed_bytes.data(), seed_bytes.size());
+
+  // PERFORMANCE: One contiguous allocation at construction; admit() never allocates.
+  counters_ = std::make_unique<std::atomic<std::uint16_t>[]>(config_.width * config_.depth);
+
+  const auto now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          now_fn_().time_since_epoch())
+                          .count();
+  next_decay_ns_.store(
+      now_ns + std::chrono::duration_cast<std::chrono::nanoseconds>(config_.decay_interval).count(),
+      std::memory_order_relaxed);
+}
+
+std::size_t SourceAdmissionFilter::index(std::size_t row, std::uint64_t key) const noexcept {
+  // Seeded 64-bit finalizer (murmur3 fmix64); rows are laid out back to back.
+  std::uint64_t h = key ^ seeds_[row];
+  h ^= h >> 33;
+  h *= 0xFF51AFD7ED558CCDULL;
+  h ^= h >> 33;
+  h *= 0xC4CEB9FE1A85EC53ULL;
+  h ^= h >> 33;
+  return row * config_.width + (static_cast<std::size_t>(h) & mask_);
+}
+
+bool SourceAdmissionFilter::maybe_decay() {
+  const auto now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          now_fn_().time_since_epoch())
+                          .count();
+  auto next = next_decay_ns_.load(std::memory_order_relaxed);
+  if (now_ns < next) {
+    return false;
+  }
+  const auto interval_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(config_.decay_interval).count();
+  const auto periods = (now_ns - next) / interval_ns + 1;
+  // Only the caller that advances the deadline runs the halving pass.
+  if (!next_decay_ns_.compare_exchange_strong(next, next + periods * interval_ns,
+                                              std::memory_order_relaxed)) {
+    // Another caller is running (or just ran) this pass.
+    return true;
+  }
+  const auto shift = static_cast<int>(std::min<std::int64_t>(periods, 16));
+  const auto total = config_.width * config_.depth;
+  for (std::size_t i = 0; i < total; ++i) {
+    const auto value = counters_[i].load(std::memory_order_relaxed);
+    if (value != 0) {
+      counters_[i].store(static_cast<std::uint16_t>(value >> shift), std::memory_order_relaxed);
+    }
+  }
+  return true;
+}
+
+bool SourceAdmissionFilter::admit(std::uint64_t prefix_key) {
+  std::array<std::size_t, kMaxSourceAdmissionDepth> slots{};
+  std::array<std::uint16_t, kMaxSourceAdmissionDepth> values{};
+  std::uint16_t min_value = UINT16_MAX;
+  const auto load_values = [&] {
+    min_value = UINT16_MAX;
+    for (std::size_t row = 0; row < config_.depth; ++row) {
+      values[row] = counters_[slots[row]].load(std::memory_order_relaxed);
+      min_value = std::min(min_value, values[row]);
+    }
+  };
+  for (std::size_t row = 0; row < config_.depth; ++row) {
+    slots[row] = index(row, prefix_key);
+  }
+  load_values();
+
+  // PERFORMANCE: The clock is read only when a prefix is at its limit. Decay can only
+  // lower counters, so below the threshold the answer is "admit" either way; skipping
+  // the clock read there keeps the common path free of syscalls and vDSO calls.
+  if (min_value >= config_.threshold && maybe_decay()) {
+    load_values();
+  }
+  if (min_value >= config_.threshold) {
+    bump(dropped_);
+    return false;
+  }
+
+  // Conservative update: raise only the counters that hold the current minimum.
+  // PERFORMANCE: Plain relaxed stores instead of CAS/fetch_add keep locked instructions
+  // off the per-packet path. Concurrent admits of colliding prefixes may lose an
+  // increment, which only makes the estimate slightly low for that instant.
+  const auto next_value = static_cast<std::uint16_t>(min_value + 1);
+  for (std::size_t row = 0; row < config_.depth; ++row) {
+    if (values[row] == min_value) {
+      counters_[slots[row]].store(next_value, std::memory_order_relaxed);
+    }
+  }
+  bump(admitted_);
+  return true;
+}
+
+bool SourceAdmissionFilter::admit_host(std::string_view host) {
+  const auto key = prefix_key(host);
+  if (!key) {
+    return true;
+  }
+  return admit(*key);
+}
+
+std::uint16_t SourceAdmissionFilter::estimate(std::uint64_t prefix_key) const {
+  std::uint16_t min_value = UINT16_MAX;
+  for (std::size_t row = 0; row < config_.depth; ++row) {
+    min_value = std::min(min_value, counters_[index(row, prefix_key)].load(std::memory_order_relaxed));
+  }
+  return min_value;
+}
+
+std::optional<std::uint64_t> SourceAdmissionFilter::prefix_key(std::string_view host) const {
+  // Accept "[v6]" as printed in some endpoint strings.
+  if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+    host = host.substr(1, host.size() - 2);
+  }
+  if (host.empty() || host.size() >= INET6_ADDRSTRLEN) {
+    return std::nullopt;
+  }
+  const std::string text(host);
+
+  const auto ipv4_key = [this](const std::uint8_t* b) {
+    const std::uint64_t addr = (static_cast<std::uint64_t>(b[0]) << 24) |
+                               (static_cast<std::uint64_t>(b[1]) << 16) |
+                               (static_cast<std::uint64_t>(b[2]) << 8) | b[3];
+    return kIpv4Tag | (addr & prefix_mask(config_.ipv4_prefix_len, 32));
+  };
+
+  std::array<std::uint8_t, 4> v4{};
+  if (inet_pton(AF_INET, text.c_str(), v4.data()) == 1) {
+    return ipv4_key(v4.data());
+  }
+
+  std::array<std::uint8_t, 16> v6{};
+  if (inet_pton(AF_INET6, text.c_str(), v6.data()) == 1) {
+    // IPv4-mapped addresses (dual-stack sockets) share the IPv4 prefix budget.
+    constexpr std::array<std::uint8_t, 12> kMappedPrefix{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF};
+    if (std::equal(kMappedPrefix.begin(), kMappedPrefix.end(), v6.begin())) {
+      return ipv4_key(v6.data() + 12);
+    }
+    // Prefixes longer than /64 are not useful for grouping; only the routing half is kept.
+    std::uint64_t hi = 0;
+    for (std::size_t i = 0; i < 8; ++i) {
+      hi = (hi << 8) | v6[i];
+    }
+    return kIpv6Tag ^ (hi & prefix_mask(config_.ipv6_prefix_len, 64));
+  }
+  return std::nullopt;
+}
+
+}  // namespace veil::utils
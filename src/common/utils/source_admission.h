@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+namespace veil::utils {
+
+// Configuration for per-source-prefix admission.
+struct SourceAdmissionConfig {
+  // Counters per sketch row. Rounded up to a power of two.
+  std::size_t width{4096};
+  // Number of sketch rows (independent hash functions), at most kMaxSourceAdmissionDepth.
+  std::size_t depth{4};
+  // A prefix whose estimated count reaches this value is dropped.
+  std::uint16_t threshold{64};
+  // All counters are halved once per interval. With halving, a prefix can sustain
+  // about threshold / 2 INITs per interval and burst up to threshold.
+  std::chrono::milliseconds decay_interval{1000};
+  // Prefix lengths used to group sources (a /24 is one operator or NAT pool).
+  std::uint8_t ipv4_prefix_len{24};
+  std::uint8_t ipv6_prefix_len{48};
+};
+
+inline constexpr std::size_t kMaxSourceAdmissionDepth = 8;
+
+// Per-source-prefix handshake admission using a count-min sketch.
+//
+// The global TokenBucket in the handshake responders lets one noisy source exhaust
+// the budget for everyone. This filter estimates the recent INIT rate of each source
+// prefix (/24 for IPv4, /48 for IPv6) and drops heavy hitters before any crypto.
+//
+// - Memory is fixed (width * depth 16-bit counters) regardless of how many sources
+//   are attacking; a flood from many prefixes only inflates estimates, never memory.
+// - Counters decay by halving every decay_interval.
+// - Conservative update: only the rows holding the minimum are incremented, which
+//   keeps over-estimation for innocent prefixes low.
+// - Row hash seeds are random per instance, so collisions cannot be precomputed.
+//
+// Performance: admit() is depth multiply-xorshift hashes plus depth relaxed atomic
+// loads (and increments). The clock is only consulted for prefixes at their limit,
+// and the halving pass runs at most once per interval.
+//
+// Thread Safety: admit() may be called concurrently; counters are relaxed atomics
+// updated without read-modify-write, so racing callers may lose increments (the
+// estimate and the statistics are approximate by design). Exactly one caller runs
+// each decay pass.
+// @see docs/thread_model.md
+class SourceAdmissionFilter {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit SourceAdmissionFilter(SourceAdmissionConfig config = {},
+                                 std::function<Clock::time_point()> now_fn = Clock::now);
+
+  SourceAdmissionFilter(const SourceAdmissionFilter&) = delete;
+  SourceAdmissionFilter& operator=(const SourceAdmissionFilter&) = delete;
+  SourceAdmissionFilter(SourceAdmissionFilter&&) = delete;
+  SourceAdmissionFilter& operator=(SourceAdmissionFilter&&) = delete;
+
+  // Account one INIT from `prefix_key` and return whether it may proceed.
+  bool admit(std::uint64_t prefix_key);
+
+  // Convenience: parse a textual IPv4/IPv6 address and admit its prefix.
+  // Unparseable addresses are admitted (nothing to group them by).
+  bool admit_host(std::string_view host);
+
+  // Estimated recent count for a prefix (for tests and diagnostics).
+  [[nodiscard]] std::uint16_t estimate(std::uint64_t prefix_key) const;
+
+  // Map an address to its prefix key (/ipv4_prefix_len or /ipv6_prefix_len).
+  [[nodiscard]] std::optional<std::uint64_t> prefix_key(std::string_view host) const;
+
+  [[nodiscard]] std::uint64_t admitted() const noexcept {
+    return admitted_.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] std::uint64_t dropped() const noexcept {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] const SourceAdmissionConfig& config() const noexcept { return config_; }
+
+ private:
+  [[nodiscard]] std::size_t index(std::size_t row, std::uint64_t key) const noexcept;
+  // Run the halving pass if its deadline passed. Returns true if counters may have changed.
+  bool maybe_decay();
+
+  SourceAdmissionConfig config_;
+  std::function<Clock::time_point()> now_fn_;
+  std::size_t mask_;
+  std::array<std::uint64_t, kMaxSourceAdmissionDepth> seeds_{};
+  std::unique_ptr<std::atomic<std::uint16_t>[]> counters_;
+
+  std::atomic<std::int64_t> next_decay_ns_;
+  std::atomic<std::uint64_t> admitted_{0};
+  std::atomic<std::uint64_t> dropped_{0};
+};
+
+}  // namespace veil::utils
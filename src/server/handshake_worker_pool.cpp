@@ -0,0 +1,106 @@
+#include "server/handshake_worker_pool.h"
+
+#include <utility>
+
+#include "common/logging/logger.h"
+
+namespace veil::server {
+
+HandshakeWorkerPool::HandshakeWorkerPool(Handler handler, HandshakeWorkerConfig config)
+    : handler_(std::move(handler)),
+      config_(config),
+      pool_(config.num_workers == 0 ? 1 : config.num_workers) {
+  if (config_.max_pending == 0) {
+    config_.max_pending = 1;
+  }
+  LOG_INFO("Handshake worker pool started: {} workers, {} pending max", pool_.num_threads(),
+           config_.max_pending);
+}
+
+HandshakeWorkerPool::~HandshakeWorkerPool() {
+  // Queued INITs are dropped rather than processed during shutdown.
+  stopping_.store(true, std::memory_order_release);
+}
+
+std::string HandshakeWorkerPool::endpoint_key(const transport::UdpEndpoint& endpoint) {
+  return endpoint.host + ":" + std::to_string(endpoint.port);
+}
+
+bool HandshakeWorkerPool::submit(const transport::UdpEndpoint& remote,
+                                 std::span<const std::uint8_t> init_bytes) {
+  // Shed before copying anything: this is the only cost a flood imposes on the data plane.
+  if (pending_.load(std::memory_order_acquire) >= config_.max_pending) {
+    shed_queue_full_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // A client retransmitting its INIT while the first is still in flight would only burn a
+  // worker on an INIT the replay cache is going to reject anyway.
+  auto key = endpoint_key(remote);
+  if (!in_flight_.insert(key).second) {
+    shed_duplicate_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  pending_.fetch_add(1, std::memory_order_acq_rel);
+  submitted_.fetch_add(1, std::memory_order_relaxed);
+  pool_.submit_detached(
+      [this, remote, key = std::move(key),
+       init = std::vector<std::uint8_t>(init_bytes.begin(), init_bytes.end())]() mutable {
+        process(std::move(remote), std::move(key), std::move(init));
+      });
+  return true;
+}
+
+void HandshakeWorkerPool::process(transport::UdpEndpoint remote, std::string key,
+                                  std::vector<std::uint8_t> init) {
+  Outcome outcome{std::move(key), std::nullopt};
+  if (!stopping_.load(std::memory_order_acquire)) {
+    auto result = handler_(init);
+    if (result) {
+      completed_.fetch_add(1, std::memory_order_relaxed);
+      outcome.completion = HandshakeCompletion{std::move(remote), std::move(*result)};
+    } else {
+      failed_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(outcomes_mutex_);
+    outcomes_.push_back(std::move(outcome));
+  }
+  pending_.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+std::size_t HandshakeWorkerPool::drain(std::vector<HandshakeCompletion>& out) {
+  std::vector<Outcome> ready;
+  {
+    std::lock_guard<std::mutex> lock(outcomes_mutex_);
+    if (outcomes_.empty()) {
+      return 0;
+    }
+    ready.swap(outcomes_);
+  }
+
+  std::size_t moved = 0;
+  for (auto& outcome : ready) {
+    in_flight_.erase(outcome.endpoint_key);
+    if (outcome.completion) {
+      out.push_back(std::move(*outcome.completion));
+      ++moved;
+    }
+  }
+  return moved;
+}
+
+HandshakeWorkerStats HandshakeWorkerPool::stats() const {
+  HandshakeWorkerStats stats;
+  stats.submitted = submitted_.load(std::memory_order_relaxed);
+  stats.shed_queue_full = shed_queue_full_.load(std::memory_order_relaxed);
+  stats.shed_duplicate = shed_duplicate_.load(std::memory_order_relaxed);
+  stats.completed = completed_.load(std::memory_order_relaxed);
+  stats.failed = failed_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+}  // namespace veil::server
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "common/handshake/handshake_processor.h"
+#include "common/utils/thread_pool.h"
+#include "transport/udp_socket/udp_socket.h"
+
+namespace veil::server {
+
+// Configuration for the off-loop handshake workers.
+struct HandshakeWorkerConfig {
+  // Number of worker threads running handle_init().
+  std::size_t num_workers{2};
+  // Maximum number of INITs queued or in progress. Further INITs are shed.
+  std::size_t max_pending{256};
+};
+
+// Handshake worker statistics.
+struct HandshakeWorkerStats {
+  std::uint64_t submitted{0};
+  std::uint64_t shed_queue_full{0};
+  std::uint64_t shed_duplicate{0};
+  std::uint64_t completed{0};
+  std::uint64_t failed{0};
+};
+
+// What a worker hands back for one INIT: the reply to send and, unless the INIT was a
+// rejected 0-RTT attempt, the session to create.
+struct HandshakeReply {
+  HandshakeReply() = default;
+  // A completed 1-RTT handshake.
+  HandshakeReply(handshake::HandshakeResponder::Result result)  // NOLINT(google-explicit-constructor)
+      : response(std::move(result.response)), session(std::move(result.session)) {}
+
+  std::vector<std::uint8_t> response;
+  handshake::HandshakeSession session{};
+  // False for a 0-RTT REJECT: send the response, the client falls back to 1-RTT.
+  bool establish_session{true};
+  // Resumed from a session ticket (0-RTT).
+  bool resumed{false};
+  // 0-RTT early data (IP packets) to deliver once the session exists.
+  std::vector<std::vector<std::uint8_t>> early_data;
+};
+
+// A handshake that finished on a worker thread, ready to become a session.
+struct HandshakeCompletion {
+  transport::UdpEndpoint remote;
+  HandshakeReply result;
+};
+
+// Runs handshake INIT processing (X25519, HKDF, HMAC, AEAD) off the data-plane thread.
+//
+// PERFORMANCE: Handshakes used to run inline in the UDP receive callback, so a burst of
+// connection attempts delayed decrypt-and-forward for every established session. The
+// data-plane thread now only copies the INIT into a bounded queue; completed sessions are
+// posted back and picked up with drain(), where the caller creates the transport session.
+// When the queue is full, INITs are shed before any crypto is done.
+//
+// Thread Safety:
+//   submit() and drain() must be called from the data-plane thread. The handler runs on
+//   worker threads and must be safe to call concurrently (HandshakeResponder::handle_init
+//   and ZeroRttResponder::handle_zero_rtt_init are).
+//   stats() may be called from any thread.
+//   @see docs/thread_model.md
+class HandshakeWorkerPool {
+ public:
+  using Result = HandshakeReply;
+  using Handler = std::function<std::optional<Result>(std::span<const std::uint8_t>)>;
+
+  HandshakeWorkerPool(Handler handler, HandshakeWorkerConfig config = {});
+  ~HandshakeWorkerPool();
+
+  HandshakeWorkerPool(const HandshakeWorkerPool&) = delete;
+  HandshakeWorkerPool& operator=(const HandshakeWorkerPool&) = delete;
+  HandshakeWorkerPool(HandshakeWorkerPool&&) = delete;
+  HandshakeWorkerPool& operator=(HandshakeWorkerPool&&) = delete;
+
+  // Queue an INIT for processing.
+  // Returns false if the INIT was shed (queue full, or one from the same endpoint is
+  // already in flight).
+  bool submit(const transport::UdpEndpoint& remote, std::span<const std::uint8_t> init_bytes);
+
+  // Move all completed handshakes into `out` (appended). Returns the number moved.
+  std::size_t drain(std::vector<HandshakeCompletion>& out);
+
+  // Number of INITs queued or being processed.
+  [[nodiscard]] std::size_t pending() const noexcept {
+    return pending_.load(std::memory_order_acquire);
+  }
+
+  [[nodiscard]] HandshakeWorkerStats stats() const;
+
+  [[nodiscard]] const HandshakeWorkerConfig& config() const { return config_; }
+
+ private:
+  struct Outcome {
+    std::string endpoint_key;
+    std::optional<HandshakeCompletion> completion;
+  };
+
+  static std::string endpoint_key(const transport::UdpEndpoint& endpoint);
+
+  void process(transport::UdpEndpoint remote, std::string key, std::vector<std::uint8_t> init);
+
+  Handler handler_;
+  HandshakeWorkerConfig config_;
+
+  // Endpoints with an INIT in flight (data-plane thread only).
+  std::unordered_set<std::string> in_flight_;
+
+  std::atomic<bool> stopping_{false};
+  std::atomic<std::size_t> pending_{0};
+  std::atomic<std::uint64_t> submitted_{0};
+  std::atomic<std::uint64_t> shed_queue_full_{0};
+  std::atomic<std::uint64_t> shed_duplicate_{0};
+  std::atomic<std::uint64_t> completed_{0};
+  std::atomic<std::uint64_t> failed_{0};
+
+  std::mutex outcomes_mutex_;
+  std::vector<Outcome> outcomes_;
+
+  // Declared last so workers are joined before the state above is destroyed.
+  utils::ThreadPool pool_;
+};
+
+}  // namespace veil::server
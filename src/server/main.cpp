@@ -1,25 +1,36 @@
 #include <arpa/inet.h>
 
+#include <algorithm>
 #include <array>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <chrono>
 #include <iomanip>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
 
 #include "common/cli/cli_utils.h"
 #include "common/crypto/crypto_engine.h"
 #include "common/daemon/daemon.h"
 #include "common/handshake/handshake_processor.h"
+#include "common/handshake/retry_cookie.h"
+#include "common/handshake/session_ticket.h"
 #include "common/logging/logger.h"
 #include "common/signal/signal_handler.h"
+#include "common/utils/graceful_degradation.h"
 #include "common/utils/rate_limiter.h"
+#include "common/utils/source_admission.h"
+#include "server/handshake_worker_pool.h"
 #include "server/server_config.h"
 #include "server/session_table.h"
 #include "transport/mux/ack_scheduler.h"
 #include "transport/mux/frame.h"
 #include "transport/mux/mux_codec.h"
 #include "transport/session/transport_session.h"
+#include "transport/udp_socket/pacing_calendar.h"
 #include "transport/udp_socket/udp_socket.h"
 #include "tun/routing.h"
 #include "tun/tun_device.h"
@@ -36,6 +47,9 @@ constexpr std::size_t kMaxPacketSize = 65535;
 // Value: nonce (12 bytes) + min ciphertext (1 byte) + AEAD tag (16 bytes) = 29 bytes
 constexpr std::size_t kMinPacketSize = 29;
 
+// TUN packets read per loop iteration; packets for the same client are packed together.
+constexpr std::size_t kTunReadBatch = 32;
+
 // Statistics for display
 struct ServerStats {
   std::atomic<uint64_t> total_bytes_sent{0};
@@ -44,6 +58,8 @@ struct ServerStats {
   std::atomic<uint64_t> total_packets_received{0};
   std::atomic<uint64_t> connections_total{0};
   std::atomic<uint64_t> connections_active{0};
+  // TUN packets dropped because their session's send backlog was full.
+  std::atomic<uint64_t> tun_packets_dropped_backlog{0};
   std::chrono::steady_clock::time_point start_time;
 };
 
@@ -103,6 +119,59 @@ void log_handshake_send_error(const std::error_code& ec) {
   LOG_ERROR("Failed to send handshake response: {}", ec.message());
 }
 
+void log_handshake_shed([[maybe_unused]] const std::string& host,
+                        [[maybe_unused]] std::uint16_t port) {
+  LOG_DEBUG("Handshake from {}:{} shed (worker queue full or already in flight)", host, port);
+}
+
+void log_handshake_prefix_drop([[maybe_unused]] const std::string& host,
+                               [[maybe_unused]] std::uint16_t port) {
+  LOG_DEBUG("Handshake from {}:{} dropped (source prefix over admission limit)", host, port);
+}
+
+void log_ticket_key_error(const std::string& path, const std::error_code& ec) {
+  LOG_ERROR("Failed to persist session ticket keys to {}: {}", path, ec.message());
+}
+
+void log_zero_rtt_resumed([[maybe_unused]] std::uint64_t session_id,
+                          [[maybe_unused]] std::size_t early_packets) {
+  LOG_DEBUG("Session {} resumed with 0-RTT, {} early data packet(s)", session_id, early_packets);
+}
+
+void log_ticket_send_error(const std::error_code& ec) {
+  LOG_WARN("Failed to send session ticket: {}", ec.message());
+}
+
+// Source address of an IPv4 packet, or nullopt for anything else (or 0.0.0.0).
+std::optional<std::string> ipv4_source_address(std::span<const std::uint8_t> packet) {
+  // Minimum 20 bytes header AND IPv4 version (first nibble == 4)
+  if (packet.size() < 20 || (packet[0] >> 4) != 4) {
+    return std::nullopt;
+  }
+  // Source IP lives in bytes 12-15 of the IPv4 header
+  std::uint32_t src_ip = (static_cast<std::uint32_t>(packet[12]) << 24) |
+                         (static_cast<std::uint32_t>(packet[13]) << 16) |
+                         (static_cast<std::uint32_t>(packet[14]) << 8) |
+                         static_cast<std::uint32_t>(packet[15]);
+  if (src_ip == 0) {
+    return std::nullopt;
+  }
+  struct in_addr src_addr {};
+  src_addr.s_addr = htonl(src_ip);
+  char src_ip_str[INET_ADDRSTRLEN];
+  inet_ntop(AF_INET, &src_addr, src_ip_str, sizeof(src_ip_str));
+  return std::string(src_ip_str);
+}
+
+void log_degradation_level_change(utils::DegradationLevel old_level,
+                                  utils::DegradationLevel new_level) {
+  LOG_WARN("Server load level {} -> {}{}", utils::degradation_level_to_string(old_level),
+           utils::degradation_level_to_string(new_level),
+           utils::get_default_actions(new_level).require_handshake_cookie
+               ? " (handshake retry cookies required)"
+               : "");
+}
+
 void log_retransmit_error(const std::error_code& ec) {
   LOG_WARN("Failed to retransmit to client: {}", ec.message());
 }
@@ -152,14 +221,94 @@ void log_ack_processing() {
 // Helper functions for ACK sending logging (Issue #72 fix)
 // These avoid the bugprone-lambda-function-name clang-tidy warning
 // Changed to DEBUG level to avoid performance impact in hot path (Issue #92)
-void log_ack_send_error([[maybe_unused]] const std::error_code& ec) {
-  LOG_DEBUG("Failed to send ACK to client: {}", ec.message());
-}
-
 void log_ack_sent([[maybe_unused]] std::uint64_t ack, [[maybe_unused]] std::uint32_t bitmap) {
   LOG_DEBUG("Sent ACK to client: ack={}, bitmap={:#010x}", ack, bitmap);
 }
 
+// Send encrypted packets to a client, updating session and server stats.
+// Returns false if any send failed.
+bool send_to_client(server::ClientSession& session, transport::UdpSocket& socket,
+                    const std::vector<std::vector<std::uint8_t>>& packets) {
+  bool all_sent = true;
+  for (const auto& pkt : packets) {
+    std::error_code ec;
+    if (!socket.send(pkt, session.endpoint, ec, session.transport->outgoing_ecn())) {
+      LOG_ERROR("Failed to send to client: {}", ec.message());
+      all_sent = false;
+      continue;
+    }
+    session.packets_sent++;
+    session.bytes_sent += pkt.size();
+    g_stats.total_packets_sent++;
+    g_stats.total_bytes_sent += pkt.size();
+  }
+  return all_sent;
+}
+
+// Queue data packets for a client on the calendar shared by all sessions, at the
+// departure times its congestion controller paces them to. Stats count them now: the
+// session may be gone by the time release_paced() sends them.
+void send_paced(server::ClientSession& session, transport::PacingCalendar& calendar,
+                const std::vector<std::vector<std::uint8_t>>& packets) {
+  for (const auto& pkt : packets) {
+    transport::UdpPacket paced{pkt, session.endpoint, session.transport->outgoing_ecn()};
+    paced.send_at = session.transport->pace_packet(pkt.size());
+    calendar.schedule(std::move(paced));
+    session.packets_sent++;
+    session.bytes_sent += pkt.size();
+    g_stats.total_packets_sent++;
+    g_stats.total_bytes_sent += pkt.size();
+  }
+}
+
+// Send the calendar's due packets, of every session, as one batch.
+void release_paced(transport::UdpSocket& socket, transport::PacingCalendar& calendar,
+                   std::vector<transport::UdpPacket>& batch) {
+  batch.clear();
+  calendar.release(std::chrono::steady_clock::now(), batch);
+  std::error_code ec;
+  if (!socket.send_batch(batch, ec)) {
+    LOG_ERROR("Failed to send paced packets: {}", ec.message());
+  }
+}
+
+// Send the session's pending ACK for a stream, if the AckScheduler has one.
+void send_pending_ack(server::ClientSession& session, transport::UdpSocket& socket,
+                      std::uint64_t stream_id) {
+  auto ack_frame_opt = session.ack_scheduler.get_pending_ack(stream_id);
+  if (!ack_frame_opt) {
+    return;
+  }
+  // IMPORTANT: Queue the ACK frame itself instead of using encrypt_data(), which would
+  // wrap it in a DATA frame that the receiver would try to write to TUN. The ACK rides
+  // in the next packed packet, or goes out alone at the end of the loop iteration.
+  // Extended ACKs carry every received range. Reliable DATA is acknowledged by packet
+  // sequence, which only the session sees (fragments never reach this loop); datagram
+  // sequences are recorded by the scheduler.
+  mux::MuxFrame ack_mux_frame;
+  if (!session.transport->ack_ranges_enabled()) {
+    ack_mux_frame = mux::make_ack_frame(
+        ack_frame_opt->stream_id, ack_frame_opt->ack, ack_frame_opt->bitmap);
+  } else if (stream_id == mux::kDatagramStreamId) {
+    ack_mux_frame = mux::make_ack_ranges_frame(*session.ack_scheduler.get_pending_ack_ranges(stream_id));
+  } else {
+    ack_mux_frame = mux::make_ack_ranges_frame(session.transport->generate_ack_ranges(stream_id));
+  }
+  if (send_to_client(session, socket, session.transport->queue_frame(std::move(ack_mux_frame)))) {
+    log_ack_sent(ack_frame_opt->ack, ack_frame_opt->bitmap);
+  }
+  session.ack_scheduler.ack_sent(stream_id);
+}
+
+// Send the session's flow control credit and blocked reports, and the data that credit
+// from the client has released.
+void send_flow_control(server::ClientSession& session, transport::UdpSocket& socket) {
+  for (auto& frame : session.transport->take_flow_control_frames()) {
+    send_to_client(session, socket, session.transport->queue_frame(std::move(frame)));
+  }
+  send_to_client(session, socket, session.transport->release_flow_blocked());
+}
+
 void log_new_client(const std::string& host, std::uint16_t port, std::uint64_t session_id) {
   LOG_INFO("New client connected from {}:{}, session {}", host, port, session_id);
 
@@ -238,6 +387,7 @@ void print_server_status(std::size_t max_clients) {
   cli::print_row("Bytes Received", cli::format_bytes(g_stats.total_bytes_received.load()));
   cli::print_row("Packets Sent", std::to_string(g_stats.total_packets_sent.load()));
   cli::print_row("Packets Received", std::to_string(g_stats.total_packets_received.load()));
+  cli::print_row("Backlog Drops", std::to_string(g_stats.tun_packets_dropped_backlog.load()));
   std::cout << '\n';
 }
 
@@ -402,13 +552,97 @@ int main(int argc, char* argv[]) {
                      std::to_string(config.listen_port));
   LOG_INFO("Listening on {}:{}", config.listen_address, config.listen_port);
 
+  // Data packets of all sessions leave from one departure calendar. Where the kernel
+  // supports SO_TXTIME it holds each until its departure; otherwise they leave when due.
+  transport::PacingCalendar pacing_calendar;
+  std::vector<transport::UdpPacket> paced_batch;
+  if (udp_socket.enable_txtime(ec)) {
+    LOG_INFO("Kernel pacing (SO_TXTIME) enabled");
+  } else {
+    LOG_DEBUG("Kernel pacing unavailable: {}", ec.message());
+    ec.clear();
+  }
+  // DF only while sessions probe the path MTU: otherwise routers may fragment packets
+  // the path cannot carry whole. Best effort: without DF, probes may pass as fragments
+  // and overestimate the path.
+  if (!udp_socket.set_dont_fragment(config.tunnel.transport.enable_path_mtu_discovery, ec)) {
+    LOG_WARN("Failed to set DF for path MTU discovery: {}", ec.message());
+    ec.clear();
+  }
+
   // Create session table
   server::SessionTable session_table(config.max_clients, config.session_timeout,
                                       config.ip_pool_start, config.ip_pool_end);
 
   // Create handshake responder
   utils::TokenBucket rate_limiter(100.0, std::chrono::milliseconds(10));  // 100 tokens, 10ms refill
-  handshake::HandshakeResponder responder(psk, config.tunnel.handshake_skew_tolerance, rate_limiter);
+  // Per-source-prefix admission keeps one noisy /24 or /48 from using up the global budget.
+  utils::SourceAdmissionConfig source_admission;
+  source_admission.threshold = config.handshake_prefix_limit;
+  handshake::HandshakeResponder responder(psk, config.tunnel.handshake_skew_tolerance, rate_limiter,
+                                          handshake::HandshakeResponder::Clock::now,
+                                          source_admission);
+
+  // Session tickets: every new session gets one, and a returning client presents it in a
+  // 0-RTT INIT carrying its first packets, skipping the X25519 handshake and a round trip.
+  auto ticket_manager = std::make_shared<handshake::SessionTicketManager>();
+  if (config.zero_rtt && !config.ticket_key_file.empty() &&
+      !ticket_manager->load_or_create_keys(config.ticket_key_file, ec)) {
+    cli::print_error("Failed to load ticket keys: " + ec.message());
+    LOG_ERROR("Failed to load ticket keys from {}: {}", config.ticket_key_file, ec.message());
+    return EXIT_FAILURE;
+  }
+  std::unique_ptr<handshake::ZeroRttResponder> zero_rtt_responder;
+  if (config.zero_rtt) {
+    zero_rtt_responder = std::make_unique<handshake::ZeroRttResponder>(
+        psk, ticket_manager, config.tunnel.handshake_skew_tolerance,
+        utils::TokenBucket(100.0, std::chrono::milliseconds(10)));
+  }
+
+  // Handshakes run on worker threads so a connection storm cannot stall the data plane.
+  // Both INIT kinds share the handshake key: each INIT is decrypted once, charged one
+  // rate-limiter token, and dispatched on its message type.
+  server::HandshakeWorkerPool handshake_workers(
+      [&responder, &zero_rtt_responder](
+          std::span<const std::uint8_t> init) -> std::optional<server::HandshakeReply> {
+        const auto plaintext = responder.open_init(init);
+        if (!plaintext) {
+          return std::nullopt;
+        }
+        if (handshake::init_message_type(*plaintext) != handshake::MessageType::kZeroRttInit) {
+          auto result = responder.handle_decrypted_init(*plaintext);
+          if (!result) {
+            return std::nullopt;
+          }
+          return server::HandshakeReply(std::move(*result));
+        }
+        if (!zero_rtt_responder) {
+          return std::nullopt;
+        }
+        auto resumed = zero_rtt_responder->handle_decrypted_zero_rtt_init(*plaintext);
+        if (!resumed) {
+          return std::nullopt;
+        }
+        server::HandshakeReply reply;
+        reply.response = std::move(resumed->response);
+        reply.session = std::move(resumed->session);
+        reply.establish_session = resumed->accepted;
+        reply.resumed = resumed->accepted;
+        reply.early_data = std::move(resumed->early_data);
+        return reply;
+      },
+      server::HandshakeWorkerConfig{.num_workers = config.handshake_workers,
+                                    .max_pending = config.handshake_queue_depth});
+  std::vector<server::HandshakeCompletion> completed_handshakes;
+
+  // Stateless retry cookies: while the server is degraded (e.g. by an INIT flood filling the
+  // handshake queue), INITs without a valid cookie get a cheap RETRY instead of any crypto.
+  handshake::RetryCookieGenerator retry_cookies;
+  utils::SystemResourceMonitor resource_monitor;
+  utils::DegradationCallbacks degradation_callbacks;
+  degradation_callbacks.on_level_change = log_degradation_level_change;
+  utils::GracefulDegradation degradation(utils::DegradationConfig{}, degradation_callbacks);
+  auto last_degradation_check = std::chrono::steady_clock::now();
 
   // Setup signal handlers
   auto& sig_handler = signal::SignalHandler::instance();
@@ -452,7 +686,13 @@ int main(int argc, char* argv[]) {
   std::array<std::uint8_t, kMaxPacketSize> buffer{};
 
   while (running.load() && !sig_handler.should_terminate()) {
-    // Poll UDP socket
+    // Poll UDP socket, waking up for the next paced departure.
+    int poll_timeout_ms = 10;
+    if (const auto wait = pacing_calendar.time_until_release(std::chrono::steady_clock::now())) {
+      poll_timeout_ms = std::min(
+          poll_timeout_ms,
+          static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(*wait).count()));
+    }
     udp_socket.poll(
         [&](const transport::UdpPacket& pkt) {
           // Early rejection of obviously malformed packets (DoS prevention).
@@ -480,6 +720,9 @@ int main(int argc, char* argv[]) {
                                     pkt.remote.port, pkt.data.size());
               auto frames = session->transport->decrypt_packet(pkt.data);
               if (frames) {
+                // ECN counts for the next ACK, and a CE mark carried over to the inner
+                // packets.
+                session->transport->apply_outer_ecn(pkt.ecn, *frames);
                 // Use helper functions for Issue #72 debugging (avoid bugprone-lambda-function-name)
                 log_decrypted_frames(frames->size(), session->session_id);
                 for (const auto& frame : *frames) {
@@ -492,25 +735,10 @@ int main(int argc, char* argv[]) {
                     // IP (e.g., 10.8.0.254). Without this fix, return packets from the internet
                     // cannot be routed back to the correct client because the destination IP
                     // in return packets matches the client's source IP, not the server-assigned IP.
-                    const auto& payload = frame.data.payload;
-                    // Check for valid IPv4 packet: minimum 20 bytes header AND IPv4 version (first nibble == 4)
-                    if (payload.size() >= 20 && ((payload[0] >> 4) == 4)) {
-                      // Extract source IP from IPv4 header (bytes 12-15)
-                      std::uint32_t src_ip = (static_cast<std::uint32_t>(payload[12]) << 24) |
-                                             (static_cast<std::uint32_t>(payload[13]) << 16) |
-                                             (static_cast<std::uint32_t>(payload[14]) << 8) |
-                                             static_cast<std::uint32_t>(payload[15]);
-                      // Only update if source IP is non-zero (valid)
-                      if (src_ip != 0) {
-                        struct in_addr src_addr {};
-                        src_addr.s_addr = htonl(src_ip);
-                        char src_ip_str[INET_ADDRSTRLEN];
-                        inet_ntop(AF_INET, &src_addr, src_ip_str, sizeof(src_ip_str));
-
-                        // Update session's tunnel IP if it differs from the packet's source IP
-                        // This ensures return packets can be routed back to this client
-                        session_table.update_tunnel_ip(session->session_id, src_ip_str);
-                      }
+                    if (auto src_ip = ipv4_source_address(frame.data.payload)) {
+                      // Update session's tunnel IP if it differs from the packet's source IP
+                      // This ensures return packets can be routed back to this client
+                      session_table.update_tunnel_ip(session->session_id, *src_ip);
                     }
 
                     // Write to TUN device
@@ -529,27 +757,71 @@ int main(int argc, char* argv[]) {
 
                     if (should_send_ack) {
                       // Scheduler determined immediate ACK is needed (e.g., out-of-order or every N packets)
-                      auto ack_frame_opt = session->ack_scheduler.get_pending_ack(frame.data.stream_id);
-                      if (ack_frame_opt) {
-                        // IMPORTANT: Use encrypt_frame() instead of encrypt_data() to preserve the ACK frame kind.
-                        // encrypt_data() wraps data in a DATA frame, which would cause the receiver to
-                        // incorrectly interpret the ACK as data and try to write it to TUN.
-                        auto ack_mux_frame = mux::make_ack_frame(
-                            ack_frame_opt->stream_id, ack_frame_opt->ack, ack_frame_opt->bitmap);
-                        auto ack_packet = session->transport->encrypt_frame(ack_mux_frame);
-                        if (!udp_socket.send(ack_packet, pkt.remote, ec)) {
-                          log_ack_send_error(ec);
-                        } else {
-                          log_ack_sent(ack_frame_opt->ack, ack_frame_opt->bitmap);
-                        }
-                        session->ack_scheduler.ack_sent(frame.data.stream_id);
-                      }
+                      send_pending_ack(*session, udp_socket, frame.data.stream_id);
+                    }
+                  } else if (frame.kind == mux::FrameKind::kDatagram) {
+                    // Unreliable IP packet: no reordering, straight to TUN.
+                    if (auto src_ip = ipv4_source_address(frame.datagram.payload)) {
+                      session_table.update_tunnel_ip(session->session_id, *src_ip);
+                    }
+                    log_tun_write_attempt(frame.datagram.payload.size(), session->session_id);
+                    if (!tun_device.write(frame.datagram.payload, ec)) {
+                      log_tun_write_error(ec);
+                    } else {
+                      log_tun_write_success(frame.datagram.payload.size());
+                    }
+
+                    // Loss feedback only: the ACK feeds the client's congestion controller.
+                    if (session->transport->datagram_loss_feedback() &&
+                        session->ack_scheduler.on_packet_received(mux::kDatagramStreamId,
+                                                                  frame.datagram.sequence)) {
+                      send_pending_ack(*session, udp_socket, mux::kDatagramStreamId);
                     }
                   } else if (frame.kind == mux::FrameKind::kAck) {
                     log_ack_processing();
                     session->transport->process_ack(frame.ack);
+                  } else if (frame.kind == mux::FrameKind::kAckRanges) {
+                    log_ack_processing();
+                    session->transport->process_ack(frame.ack_ranges);
                   }
                 }
+                // FEC: answer the client's offer, or advertise a new group size.
+                if (auto params = session->transport->take_fec_params_frame()) {
+                  send_to_client(*session, udp_socket,
+                                 session->transport->queue_frame(std::move(*params)));
+                }
+                // Wire format: answer the client's v2 offer.
+                if (auto offer = session->transport->take_wire_format_frame()) {
+                  send_to_client(*session, udp_socket,
+                                 session->transport->queue_frame(std::move(*offer)));
+                }
+                // Datagram mode, frame packing and extended ACKs: answer the client's offers.
+                if (auto offer = session->transport->take_datagram_mode_frame()) {
+                  send_to_client(*session, udp_socket,
+                                 session->transport->queue_frame(std::move(*offer)));
+                }
+                if (auto offer = session->transport->take_frame_packing_frame()) {
+                  send_to_client(*session, udp_socket,
+                                 session->transport->queue_frame(std::move(*offer)));
+                }
+                if (auto offer = session->transport->take_ack_ranges_frame()) {
+                  send_to_client(*session, udp_socket,
+                                 session->transport->queue_frame(std::move(*offer)));
+                }
+                // Header compression: answer the client's offer.
+                if (auto offer = session->transport->take_header_compression_frame()) {
+                  send_to_client(*session, udp_socket,
+                                 session->transport->queue_frame(std::move(*offer)));
+                }
+                // Payload compression: answer the client's offer.
+                if (auto offer = session->transport->take_payload_compression_frame()) {
+                  send_to_client(*session, udp_socket,
+                                 session->transport->queue_frame(std::move(*offer)));
+                }
+                // Path MTU: acknowledge probes, and probe further once one is acknowledged.
+                send_to_client(*session, udp_socket, session->transport->take_path_mtu_packets());
+                // Flow control: grant the credit just freed, and send what new credit covers.
+                send_flow_control(*session, udp_socket);
               } else {
                 // Log decryption failure for diagnostics
                 log_decryption_failure(session->session_id, pkt.remote.host,
@@ -560,30 +832,94 @@ int main(int argc, char* argv[]) {
             // Log when packet doesn't match any existing session
             LOG_DEBUG("No session found for endpoint {}:{}, treating as potential handshake",
                       pkt.remote.host, pkt.remote.port);
-            // New connection - handle handshake
-            auto hs_result = responder.handle_init(pkt.data);
-            if (hs_result) {
-              if (!udp_socket.send(hs_result->response, pkt.remote, ec)) {
-                log_handshake_send_error(ec);
-              } else {
-                // Create transport session
-                auto transport = std::make_unique<transport::TransportSession>(
-                    hs_result->session, config.tunnel.transport);
-
-                // Create client session
-                auto session_id = session_table.create_session(pkt.remote, std::move(transport));
-                if (session_id) {
-                  log_new_client(pkt.remote.host, pkt.remote.port, *session_id);
+            // Over-limit source prefixes are dropped before any crypto (cookie or AEAD).
+            if (config.handshake_prefix_limit != 0 && !responder.admit_source(pkt.remote.host)) {
+              log_handshake_prefix_drop(pkt.remote.host, pkt.remote.port);
+              return;
+            }
+            std::span<const std::uint8_t> init = pkt.data;
+            if (config.handshake_retry_cookies) {
+              const auto source = pkt.remote.host + ":" + std::to_string(pkt.remote.port);
+              if (auto echoed = retry_cookies.strip(init, source)) {
+                init = *echoed;
+              } else if (degradation.current_actions().require_handshake_cookie) {
+                // No valid cookie while under load: answer with a RETRY, no decryption.
+                auto retry = responder.create_retry(retry_cookies.issue(source), pkt.data.size());
+                if (!retry.empty() && !udp_socket.send(retry, pkt.remote, ec)) {
+                  log_handshake_send_error(ec);
                 }
+                return;
               }
             }
+
+            // New connection - hand the INIT to the handshake workers. Shed INITs are
+            // dropped silently, exactly like INITs rejected by the responder.
+            if (!handshake_workers.submit(pkt.remote, init)) {
+              log_handshake_shed(pkt.remote.host, pkt.remote.port);
+            }
           }
         },
-        10, ec);
+        poll_timeout_ms, ec);
+    release_paced(udp_socket, pacing_calendar, paced_batch);
+
+    // Turn handshakes completed by the workers into sessions (data-plane thread only).
+    completed_handshakes.clear();
+    handshake_workers.drain(completed_handshakes);
+    for (auto& hs : completed_handshakes) {
+      if (!udp_socket.send(hs.result.response, hs.remote, ec)) {
+        log_handshake_send_error(ec);
+        continue;
+      }
+      // A rejected 0-RTT attempt only gets its REJECT; the client retries with 1-RTT.
+      if (!hs.result.establish_session) {
+        continue;
+      }
+      // Create transport session
+      auto transport = std::make_unique<transport::TransportSession>(
+          hs.result.session, config.tunnel.transport);
+
+      // Create client session
+      auto session_id = session_table.create_session(hs.remote, std::move(transport));
+      if (!session_id) {
+        continue;
+      }
+      log_new_client(hs.remote.host, hs.remote.port, *session_id);
+      auto* session = session_table.find_by_id(*session_id);
+      if (session == nullptr || !session->transport) {
+        continue;
+      }
+
+      // 0-RTT early data: the client's first packets, delivered like DATA frames.
+      if (hs.result.resumed) {
+        log_zero_rtt_resumed(*session_id, hs.result.early_data.size());
+      }
+      for (const auto& packet : hs.result.early_data) {
+        if (auto src_ip = ipv4_source_address(packet)) {
+          session_table.update_tunnel_ip(*session_id, *src_ip);
+        }
+        if (!tun_device.write(packet, ec)) {
+          log_tun_write_error(ec);
+        }
+      }
+
+      // Hand out a ticket for the next reconnect. Tickets carry the client's view of the keys.
+      if (config.zero_rtt) {
+        auto ticket = ticket_manager->issue_ticket(
+            handshake::reverse_session_keys(hs.result.session.keys), hs.result.session.client_id);
+        auto ticket_packet = session->transport->encrypt_frame(mux::make_control_frame(
+            mux::kControlSessionTicket, handshake::encode_ticket_message(ticket)));
+        if (!udp_socket.send(ticket_packet, hs.remote, ec)) {
+          log_ticket_send_error(ec);
+        }
+      }
+    }
 
-    // Read from TUN and route to appropriate client
-    auto tun_read = tun_device.read_into(buffer, ec);
-    if (tun_read > 0) {
+    // Read a batch from TUN and route each packet to the appropriate client
+    for (std::size_t tun_batch = 0; tun_batch < kTunReadBatch; ++tun_batch) {
+      auto tun_read = tun_device.read_into(buffer, ec);
+      if (tun_read <= 0) {
+        break;
+      }
       // Parse IP header to find destination
       if (tun_read >= 20) {
         // Check if this is an IPv4 packet (version nibble == 4)
@@ -617,22 +953,22 @@ int main(int argc, char* argv[]) {
 
           // Find session by tunnel IP
           auto* session = session_table.find_by_tunnel_ip(dst_ip_str);
-          if (session != nullptr && session->transport) {
+          if (session != nullptr && session->transport &&
+              session->transport->paced_backlog_bytes() >
+                  config.tunnel.transport.send_scheduler_config.backpressure_bytes) {
+            // The TUN device is shared, so one client's backlog cannot stop the reads
+            // as in the tunnel: drop its packets instead, which its inner senders see as
+            // loss, so its packets on the calendar stay bounded. (Its send scheduler
+            // bounds and drops on its own.)
+            g_stats.tun_packets_dropped_backlog++;
+          } else if (session != nullptr && session->transport) {
             LOG_DEBUG("Routing {} bytes to session {} ({}:{})",
                       tun_read, session->session_id, session->endpoint.host, session->endpoint.port);
-            // Encrypt and send
-            auto packets = session->transport->encrypt_data(
-                std::span<const std::uint8_t>(buffer.data(), static_cast<std::size_t>(tun_read)));
-            for (const auto& pkt : packets) {
-              if (!udp_socket.send(pkt, session->endpoint, ec)) {
-                LOG_ERROR("Failed to send to client: {}", ec.message());
-              } else {
-                session->packets_sent++;
-                session->bytes_sent += pkt.size();
-                g_stats.total_packets_sent++;
-                g_stats.total_bytes_sent += pkt.size();
-              }
-            }
+            // Encrypt and send (as a DATAGRAM frame once both sides offered datagram_mode).
+            // Small packets are packed; the pacing calendar spaces out what is ready.
+            send_paced(*session, pacing_calendar,
+                       session->transport->queue_ip_packet(std::span<const std::uint8_t>(
+                           buffer.data(), static_cast<std::size_t>(tun_read))));
           } else {
             LOG_DEBUG("No session found for tunnel IP {}, packet dropped", dst_ip_str);
           }
@@ -653,9 +989,24 @@ int main(int argc, char* argv[]) {
         cli::print_info("Cleaned up " + std::to_string(expired) + " expired session(s)");
         LOG_INFO("Cleaned up {} expired sessions", expired);
       }
+      // Rotate ticket keys once they reach the rotation interval, and persist the new ring
+      // so tickets issued from now on also survive a restart.
+      if (config.zero_rtt && ticket_manager->maybe_rotate_keys() &&
+          !config.ticket_key_file.empty() &&
+          !ticket_manager->save_keys(config.ticket_key_file, ec)) {
+        log_ticket_key_error(config.ticket_key_file, ec);
+      }
       last_cleanup = now;
     }
 
+    // Re-evaluate load once per second; handshake queue pressure drives retry cookies.
+    if (now - last_degradation_check >= std::chrono::seconds(1)) {
+      resource_monitor.set_connection_info(session_table.session_count(), config.max_clients);
+      resource_monitor.set_queue_info(handshake_workers.pending(), config.handshake_queue_depth);
+      degradation.update(resource_monitor.get_metrics());
+      last_degradation_check = now;
+    }
+
     // Periodic stats display (every 60 seconds in verbose mode)
     if (config.verbose && (now - last_stats >= std::chrono::seconds(60))) {
       print_server_status(config.max_clients);
@@ -667,7 +1018,7 @@ int main(int argc, char* argv[]) {
       if (session->transport) {
         auto retransmits = session->transport->get_retransmit_packets();
         for (const auto& pkt : retransmits) {
-          if (!udp_socket.send(pkt, session->endpoint, ec)) {
+          if (!udp_socket.send(pkt, session->endpoint, ec, session->transport->outgoing_ecn())) {
             log_retransmit_error(ec);
           }
         }
@@ -676,26 +1027,26 @@ int main(int argc, char* argv[]) {
 
     // Issue #95: Check for delayed ACKs (ACK coalescing).
     // The scheduler uses a timer to batch ACKs, reducing overhead.
-    // Check each session's ACK scheduler for pending delayed ACKs.
+    // Check each session's ACK scheduler for pending delayed ACKs, then send what this
+    // iteration packed for the session (TUN packets and ACKs share packets).
     session_table.for_each_session([&](server::ClientSession* session) {
       if (session->transport) {
         auto stream_id_opt = session->ack_scheduler.check_ack_timer();
         if (stream_id_opt) {
-          auto ack_frame_opt = session->ack_scheduler.get_pending_ack(*stream_id_opt);
-          if (ack_frame_opt) {
-            auto ack_mux_frame = mux::make_ack_frame(
-                ack_frame_opt->stream_id, ack_frame_opt->ack, ack_frame_opt->bitmap);
-            auto ack_packet = session->transport->encrypt_frame(ack_mux_frame);
-            if (!udp_socket.send(ack_packet, session->endpoint, ec)) {
-              log_ack_send_error(ec);
-            } else {
-              log_ack_sent(ack_frame_opt->ack, ack_frame_opt->bitmap);
-            }
-            session->ack_scheduler.ack_sent(*stream_id_opt);
-          }
+          send_pending_ack(*session, udp_socket, *stream_id_opt);
+        }
+        // Repeat blocked reports while the client's credit holds data back.
+        if (session->transport->flow_blocked()) {
+          send_flow_control(*session, udp_socket);
+        }
+        // Path MTU probes are timed, and a lost one is sent again.
+        send_to_client(*session, udp_socket, session->transport->take_path_mtu_packets());
+        if (session->transport->has_packed_frames()) {
+          send_paced(*session, pacing_calendar, session->transport->flush_packed());
         }
       }
     });
+    release_paced(udp_socket, pacing_calendar, paced_batch);
   }
 
   // Cleanup
@@ -181,6 +181,13 @@ bool parse_args(int argc, char* argv[], ServerConfig& config, std::error_code& e
   app.add_option("--session-timeout", session_timeout_seconds, "Session timeout in seconds")
       ->default_val(300);
 
+  app.add_option("--handshake-workers", config.handshake_workers,
+                 "Number of handshake worker threads")
+      ->default_val(2);
+  app.add_option("--handshake-queue", config.handshake_queue_depth,
+                 "Maximum queued handshakes before new ones are dropped")
+      ->default_val(256);
+
   // IP pool.
   app.add_option("--ip-pool-start", config.ip_pool_start, "IP pool start")->default_val("10.8.0.2");
   app.add_option("--ip-pool-end", config.ip_pool_end, "IP pool end")->default_val("10.8.0.254");
@@ -307,6 +314,42 @@ bool load_config_file(const std::string& path, ServerConfig& config, std::error_
           return false;
         }
         config.cleanup_interval = std::chrono::seconds(interval);
+      } else if (key == "handshake_workers") {
+        std::size_t workers;
+        if (!safe_parse_int(value, workers, "handshake_workers", ec)) {
+          return false;
+        }
+        config.handshake_workers = workers;
+      } else if (key == "handshake_queue_depth") {
+        std::size_t depth;
+        if (!safe_parse_int(value, depth, "handshake_queue_depth", ec)) {
+          return false;
+        }
+        config.handshake_queue_depth = depth;
+      } else if (key == "handshake_retry_cookies") {
+        config.handshake_retry_cookies = (value == "true" || value == "1" || value == "yes");
+      } else if (key == "handshake_prefix_limit") {
+        std::uint16_t limit;
+        if (!safe_parse_int(value, limit, "handshake_prefix_limit", ec)) {
+          return false;
+        }
+        config.handshake_prefix_limit = limit;
+      } else if (key == "zero_rtt") {
+        config.zero_rtt = (value == "true" || value == "1" || value == "yes");
+      } else if (key == "ticket_key_file") {
+        config.ticket_key_file = value;
+      }
+    } else if (section == "transport") {
+      // Offers made to each client; a feature is used once the client offers it too.
+      if (key == "datagram_mode") {
+        config.tunnel.transport.datagram_mode = (value == "true" || value == "1" || value == "yes");
+      } else if (key == "frame_packing") {
+        config.tunnel.transport.frame_packing = (value == "true" || value == "1" || value == "yes");
+      } else if (key == "ack_ranges") {
+        config.tunnel.transport.ack_ranges = (value == "true" || value == "1" || value == "yes");
+      } else if (key == "path_mtu_discovery") {
+        config.tunnel.transport.enable_path_mtu_discovery =
+            (value == "true" || value == "1" || value == "yes");
       }
     } else if (section == "ip_pool") {
       if (key == "start") {
@@ -448,6 +491,17 @@ bool validate_config(const ServerConfig& config, std::string& error) {
     return false;
   }
 
+  constexpr std::size_t kMaxHandshakeWorkers = 64;
+  if (config.handshake_workers == 0 || config.handshake_workers > kMaxHandshakeWorkers) {
+    error = "Handshake workers must be between 1 and " + std::to_string(kMaxHandshakeWorkers);
+    return false;
+  }
+
+  if (config.handshake_queue_depth == 0) {
+    error = "Handshake queue depth must be greater than 0";
+    return false;
+  }
+
   // Validate IP pool
   if (config.ip_pool_start.empty()) {
     error = "IP pool start address is required";
@@ -36,6 +36,20 @@ struct ServerConfig {
   std::chrono::seconds session_timeout{300};
   std::chrono::seconds cleanup_interval{60};
 
+  // Off-loop handshake processing: worker threads and maximum queued INITs.
+  std::size_t handshake_workers{2};
+  std::size_t handshake_queue_depth{256};
+  // Answer INITs with a stateless retry cookie while the server is degraded.
+  bool handshake_retry_cookies{true};
+  // INITs per source prefix (/24, /48) before that prefix is dropped; halves every second.
+  // 0 disables per-prefix admission.
+  std::uint16_t handshake_prefix_limit{64};
+  // Issue session tickets and accept 0-RTT resumption (with early data).
+  bool zero_rtt{true};
+  // Ticket key ring file. Lets a restarted server accept tickets issued before the
+  // restart; empty keeps the keys in memory only.
+  std::string ticket_key_file;
+
   // Network.
   std::string listen_address{"0.0.0.0"};
   std::uint16_t listen_port{4433};
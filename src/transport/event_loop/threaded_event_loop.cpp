@@ -66,6 +66,8 @@ bool ThreadedEventLoop::add_session(TransportSession* session,
       for (const auto& frame : *decrypted) {
         if (frame.kind == mux::FrameKind::kData) {
           on_packet(sid, frame.data.payload, source);
+        } else if (frame.kind == mux::FrameKind::kDatagram) {
+          on_packet(sid, frame.datagram.payload, source);
         }
       }
     }
@@ -160,6 +162,8 @@ void ThreadedEventLoop::run() {
           for (const auto& frame : frames) {
             if (frame.kind == mux::FrameKind::kData) {
               info.on_packet(sid, frame.data.payload, source);
+            } else if (frame.kind == mux::FrameKind::kDatagram) {
+              info.on_packet(sid, frame.datagram.payload, source);
             }
           }
         }
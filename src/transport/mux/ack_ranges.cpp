@@ -0,0 +1,92 @@
+#include "transport/mux/ack_ranges.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace veil::mux {
+
+AckRangeSet::AckRangeSet(std::size_t max_ranges) : max_ranges_(std::max<std::size_t>(max_ranges, 1)) {}
+
+bool AckRangeSet::add(std::uint64_t seq) {
+  // ranges_ is descending; find the first range at or below seq.
+  std::size_t i = 0;
+  for (; i < ranges_.size(); ++i) {
+    if (seq >= ranges_[i].smallest) {
+      if (seq <= ranges_[i].largest) {
+        return false;
+      }
+      break;
+    }
+  }
+
+  // seq sits between ranges_[i - 1] (above) and ranges_[i] (below).
+  const bool joins_below = i < ranges_.size() && seq == ranges_[i].largest + 1;
+  const bool joins_above = i > 0 && ranges_[i - 1].smallest == seq + 1;
+  if (joins_below && joins_above) {
+    ranges_[i - 1].smallest = ranges_[i].smallest;
+    ranges_.erase(ranges_.begin() + static_cast<std::ptrdiff_t>(i));
+  } else if (joins_below) {
+    ranges_[i].largest = seq;
+  } else if (joins_above) {
+    ranges_[i - 1].smallest = seq;
+  } else {
+    ranges_.insert(ranges_.begin() + static_cast<std::ptrdiff_t>(i), AckRange{seq, seq});
+    if (ranges_.size() > max_ranges_) {
+      // Forget the oldest range: its sequences were ACKed before. A late arrival below
+      // it (usually a retransmission) has not been, so it displaces the next oldest.
+      const auto oldest = i + 1 == ranges_.size() ? ranges_.size() - 2 : ranges_.size() - 1;
+      ranges_.erase(ranges_.begin() + static_cast<std::ptrdiff_t>(oldest));
+    }
+  }
+  return true;
+}
+
+bool AckRangeSet::contains(std::uint64_t seq) const {
+  return std::any_of(ranges_.begin(), ranges_.end(), [seq](const AckRange& range) {
+    return seq >= range.smallest && seq <= range.largest;
+  });
+}
+
+std::uint32_t AckRangeSet::bitmap() const {
+  const auto head = largest();
+  if (head == 0) {
+    return 0;
+  }
+  const std::uint64_t low = head > 32 ? head - 32 : 0;
+  std::uint32_t bits = 0;
+  for (const auto& range : ranges_) {
+    if (range.largest < low) {
+      break;
+    }
+    const auto top = std::min(range.largest, head - 1);
+    for (auto seq = std::max(range.smallest, low); seq <= top; ++seq) {
+      bits |= 1U << static_cast<std::uint32_t>(head - 1 - seq);
+    }
+  }
+  return bits;
+}
+
+bool ack_ranges_contain(std::span<const AckRange> ranges, std::uint64_t seq) {
+  // Descending ranges: the candidate is the first one starting at or below seq.
+  const auto range = std::partition_point(ranges.begin(), ranges.end(),
+                                          [seq](const AckRange& r) { return r.smallest > seq; });
+  return range != ranges.end() && seq <= range->largest;
+}
+
+std::vector<AckRange> ack_ranges_from_bitmap(std::uint64_t ack, std::uint32_t bitmap) {
+  std::vector<AckRange> ranges{AckRange{ack, ack}};
+  for (std::uint32_t i = 0; i < 32 && i < ack; ++i) {
+    const std::uint64_t seq = ack - 1 - i;
+    if (((bitmap >> i) & 1U) == 0U) {
+      continue;
+    }
+    if (ranges.back().smallest == seq + 1) {
+      ranges.back().smallest = seq;
+    } else {
+      ranges.push_back(AckRange{seq, seq});
+    }
+  }
+  return ranges;
+}
+
+}  // namespace veil::mux
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "transport/mux/frame.h"
+
+namespace veil::mux {
+
+// Receive-side set of acknowledged sequences, kept as disjoint ranges for
+// AckRangesFrame. Where AckBitmap only remembers the 32 sequences below its head,
+// this covers the whole window: only the oldest ranges are forgotten once there are
+// more than max_ranges holes, and never one that was just recorded.
+//
+// Sequences usually arrive in order, so the newest range is kept at the front and a
+// new largest sequence extends it in O(1); a late packet is merged by a short scan.
+class AckRangeSet {
+ public:
+  AckRangeSet() = default;
+  explicit AckRangeSet(std::size_t max_ranges);
+
+  // Record a sequence. Returns false if it was already recorded.
+  bool add(std::uint64_t seq);
+
+  bool contains(std::uint64_t seq) const;
+  bool empty() const { return ranges_.empty(); }
+
+  // Largest recorded sequence (0 if empty).
+  std::uint64_t largest() const { return ranges_.empty() ? 0 : ranges_.front().largest; }
+
+  // Disjoint ranges, largest first.
+  const std::vector<AckRange>& ranges() const { return ranges_; }
+
+  // AckFrame encoding of the 32 sequences below largest(): bit i is largest() - 1 - i.
+  std::uint32_t bitmap() const;
+
+  void clear() { ranges_.clear(); }
+
+ private:
+  std::size_t max_ranges_{kMaxAckRanges};
+  std::vector<AckRange> ranges_;
+};
+
+// Whether seq lies in one of the descending ranges of an AckRangesFrame.
+bool ack_ranges_contain(std::span<const AckRange> ranges, std::uint64_t seq);
+
+// Ranges equivalent to an AckFrame's ack and bitmap (bit i is ack - 1 - i).
+std::vector<AckRange> ack_ranges_from_bitmap(std::uint64_t ack, std::uint32_t bitmap);
+
+}  // namespace veil::mux
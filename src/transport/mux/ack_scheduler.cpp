@@ -20,17 +20,16 @@ bool AckScheduler::on_packet_received(std::uint64_t stream_id, std::uint64_t seq
   auto& state = it->second;
 
   // Check for gap (out-of-order).
-  if (sequence > state.highest_received + 1 && state.highest_received > 0) {
+  if (!state.received.empty() && sequence > state.received.largest() + 1) {
     state.gap_detected = true;
     ++stats_.gaps_detected;
   }
 
   // Update state.
-  update_bitmap(state, sequence);
-
-  if (sequence > state.highest_received) {
-    state.highest_received = sequence;
+  if (state.received.empty() || sequence > state.received.largest()) {
+    state.largest_received_time = now_fn_();
   }
+  state.received.add(sequence);
 
   ++state.packets_since_ack;
   state.needs_ack = true;
@@ -82,13 +81,31 @@ std::optional<AckFrame> AckScheduler::get_pending_ack(std::uint64_t stream_id) {
 
   AckFrame frame{
       .stream_id = stream_id,
-      .ack = state.highest_received,
-      .bitmap = state.received_bitmap,
+      .ack = state.received.largest(),
+      .bitmap = state.received.bitmap(),
   };
 
   return frame;
 }
 
+std::optional<AckRangesFrame> AckScheduler::get_pending_ack_ranges(std::uint64_t stream_id) {
+  auto it = std::find_if(streams_.begin(), streams_.end(),
+                         [stream_id](const auto& pair) { return pair.first == stream_id; });
+
+  if (it == streams_.end() || !it->second.needs_ack) {
+    return std::nullopt;
+  }
+
+  const auto& state = it->second;
+
+  AckRangesFrame frame;
+  frame.stream_id = stream_id;
+  frame.ack_delay = std::chrono::duration_cast<std::chrono::microseconds>(
+      now_fn_() - state.largest_received_time);
+  frame.ranges = state.received.ranges();
+  return frame;
+}
+
 void AckScheduler::ack_sent(std::uint64_t stream_id) {
   auto it = std::find_if(streams_.begin(), streams_.end(),
                          [stream_id](const auto& pair) { return pair.first == stream_id; });
@@ -108,7 +125,6 @@ void AckScheduler::ack_sent(std::uint64_t stream_id) {
   state.packets_since_ack = 0;
   state.needs_ack = false;
   state.gap_detected = false;
-  state.received_bitmap = 0;
 }
 
 std::optional<std::chrono::milliseconds> AckScheduler::time_until_next_ack() const {
@@ -145,31 +161,6 @@ void AckScheduler::reset_stream(std::uint64_t stream_id) {
   }
 }
 
-void AckScheduler::update_bitmap(StreamAckState& state, std::uint64_t sequence) {
-  // Bitmap tracks which packets in the last 32 before highest_received have been received.
-  if (state.highest_received == 0) {
-    state.received_bitmap = 0;
-    return;
-  }
-
-  if (sequence <= state.highest_received) {
-    // This is a packet before or at highest_received.
-    const auto offset = state.highest_received - sequence;
-    if (offset < 32) {
-      state.received_bitmap |= (1U << static_cast<std::uint32_t>(offset));
-    }
-  } else {
-    // New highest received - shift bitmap.
-    const auto shift = static_cast<std::uint32_t>(sequence - state.highest_received);
-    if (shift < 32) {
-      state.received_bitmap <<= shift;
-      state.received_bitmap |= (1U << (shift - 1));  // Mark previous highest as received.
-    } else {
-      state.received_bitmap = 0;
-    }
-  }
-}
-
 bool AckScheduler::should_send_immediate_ack(const StreamAckState& state, bool fin) const {
   // Immediate ACK for FIN packets.
   if (fin && config_.immediate_ack_on_fin) {
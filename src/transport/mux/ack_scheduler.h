@@ -6,6 +6,7 @@
 #include <optional>
 #include <vector>
 
+#include "transport/mux/ack_ranges.h"
 #include "transport/mux/frame.h"
 
 namespace veil::mux {
@@ -63,6 +64,10 @@ class AckScheduler {
   // Call this when on_packet_received returns true or check_ack_timer returns a stream_id.
   std::optional<AckFrame> get_pending_ack(std::uint64_t stream_id);
 
+  // Same as get_pending_ack(), as an extended ACK: every received range (not just the
+  // 32 packets below the highest) and the time the highest packet has waited for it.
+  std::optional<AckRangesFrame> get_pending_ack_ranges(std::uint64_t stream_id);
+
   // Mark that an ACK was sent for a stream.
   void ack_sent(std::uint64_t stream_id);
 
@@ -77,15 +82,15 @@ class AckScheduler {
 
  private:
   struct StreamAckState {
-    std::uint64_t highest_received{0};
-    std::uint32_t received_bitmap{0};
+    // Kept across ACKs, so a lost ACK's ranges are repeated by the next one.
+    AckRangeSet received;
+    TimePoint largest_received_time;
     std::uint32_t packets_since_ack{0};
     TimePoint first_unacked_time;
     bool needs_ack{false};
     bool gap_detected{false};
   };
 
-  void update_bitmap(StreamAckState& state, std::uint64_t sequence);
   bool should_send_immediate_ack(const StreamAckState& state, bool fin) const;
 
   AckSchedulerConfig config_;
@@ -0,0 +1,355 @@
+#include "transport/mux/bbr_controller.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+
+#include "common/logging/logger.h"
+
+namespace veil::mux {
+
+namespace {
+
+// ProbeBW pacing gains, one phase per min RTT: probe for more bandwidth, drain the
+// queue that probe built, then cruise.
+constexpr std::array<double, BbrController::kGainCycleLength> kPacingGainCycle{
+    1.25, 0.75, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0};
+
+// ProbeBW starts in a cruising phase so a new flow does not probe straight after Drain.
+constexpr std::size_t kInitialCycleIndex = 2;
+
+}  // namespace
+
+BbrController::BbrController(CongestionConfig config, std::function<TimePoint()> now_fn)
+    : config_(config), now_fn_(std::move(now_fn)), cwnd_(config_.initial_cwnd) {
+  const auto now = now_fn_();
+  next_send_time_ = now;
+  min_rtt_stamp_ = now;
+  update_pacing_rate();
+
+  LOG_DEBUG("BbrController initialized: cwnd={}, pacing_rate={}", cwnd_, pacing_rate_);
+}
+
+void BbrController::on_ack(std::size_t acked_bytes) {
+  if (acked_bytes == 0) {
+    return;
+  }
+  dup_ack_count_ = 0;
+  delivered_ += acked_bytes;
+
+  const std::size_t min_pipe = 4 * config_.mss;
+  const std::size_t before = cwnd_;
+  if (timeout_recovery_) {
+    // The model survived the timeout: go back to the window it supported.
+    cwnd_ = std::max(cwnd_, prior_cwnd_);
+    timeout_recovery_ = false;
+    if (mode_ != BbrMode::kProbeRtt) {
+      prior_cwnd_ = 0;
+    }
+  }
+
+  const std::size_t target = target_cwnd(cwnd_gain_);
+  if (filled_pipe_) {
+    cwnd_ = std::min(cwnd_ + acked_bytes, target);
+  } else if (cwnd_ < target || delivered_ < config_.initial_cwnd) {
+    cwnd_ += acked_bytes;
+  }
+  cwnd_ = std::clamp(cwnd_, std::min(min_pipe, config_.max_cwnd), config_.max_cwnd);
+  if (mode_ == BbrMode::kProbeRtt) {
+    cwnd_ = std::min(cwnd_, min_pipe);
+  }
+
+  if (cwnd_ > before) {
+    ++stats_.cwnd_increases;
+  } else if (cwnd_ < before) {
+    ++stats_.cwnd_decreases;
+  }
+  if (cwnd_ > stats_.peak_cwnd) {
+    stats_.peak_cwnd = cwnd_;
+  }
+}
+
+void BbrController::on_rate_sample(const RateSample& sample) {
+  const auto now = now_fn_();
+  if (sample.bytes_in_flight > stats_.peak_bytes_in_flight) {
+    stats_.peak_bytes_in_flight = sample.bytes_in_flight;
+  }
+
+  update_round(sample);
+  update_bandwidth(sample);
+  check_full_pipe();
+
+  if (mode_ == BbrMode::kStartup && filled_pipe_) {
+    ++stats_.slow_start_exits;
+    enter_mode(BbrMode::kDrain, now);
+  }
+  if (mode_ == BbrMode::kDrain && sample.bytes_in_flight <= target_cwnd(1.0)) {
+    enter_mode(BbrMode::kProbeBw, now);
+  }
+  if (mode_ == BbrMode::kProbeBw) {
+    update_gain_cycle(sample, now);
+  }
+  update_min_rtt(sample, now);
+  update_pacing_rate();
+}
+
+bool BbrController::on_duplicate_ack() {
+  ++dup_ack_count_;
+  ++stats_.duplicate_acks;
+  if (dup_ack_count_ == config_.fast_retransmit_threshold) {
+    ++stats_.fast_retransmits;
+    return true;
+  }
+  return false;
+}
+
+void BbrController::on_timeout_loss() {
+  ++stats_.timeout_retransmits;
+  ++stats_.cwnd_decreases;
+
+  // Packet conservation until the next ACK shows the path is delivering again.
+  prior_cwnd_ = std::max(prior_cwnd_, cwnd_);
+  cwnd_ = config_.mss;
+  timeout_recovery_ = true;
+
+  LOG_INFO("BBR timeout loss: cwnd={}, restoring {} on next ACK", cwnd_, prior_cwnd_);
+}
+
+void BbrController::on_fast_retransmit_loss() {
+  // Loss is not a congestion signal to BBR: the bandwidth model already bounds the
+  // queue, and random loss on a lossy link would otherwise collapse the window.
+  LOG_DEBUG("BBR loss ignored by the model: cwnd={}", cwnd_);
+}
+
+void BbrController::on_ecn_ce() {
+  ++stats_.ecn_ce_events;
+  LOG_DEBUG("BBR ECN-CE ignored by the model: cwnd={}", cwnd_);
+}
+
+bool BbrController::can_send(std::size_t bytes_in_flight) const {
+  return bytes_in_flight < cwnd_;
+}
+
+std::size_t BbrController::sendable_bytes(std::size_t bytes_in_flight) const {
+  if (bytes_in_flight >= cwnd_) {
+    return 0;
+  }
+  return cwnd_ - bytes_in_flight;
+}
+
+bool BbrController::check_pacing() {
+  if (!config_.enable_pacing) {
+    return true;
+  }
+
+  const auto now = now_fn_();
+  if (now < next_send_time_) {
+    ++stats_.pacing_delays;
+    return false;
+  }
+
+  // Time not spent sending while idle buys at most max_pacing_burst back-to-back packets.
+  const auto interval = pacing_interval();
+  const auto burst_credit =
+      interval * static_cast<std::int64_t>(std::max<std::size_t>(config_.max_pacing_burst, 1) - 1);
+  next_send_time_ = std::max(next_send_time_, now - burst_credit) + interval;
+  ++stats_.pacing_tokens_granted;
+  return true;
+}
+
+std::optional<std::chrono::microseconds> BbrController::time_until_next_send() const {
+  if (!config_.enable_pacing) {
+    return std::nullopt;
+  }
+  const auto now = now_fn_();
+  if (now >= next_send_time_) {
+    return std::nullopt;
+  }
+  return std::chrono::duration_cast<std::chrono::microseconds>(next_send_time_ - now);
+}
+
+void BbrController::reset() {
+  const auto now = now_fn_();
+  mode_ = BbrMode::kStartup;
+  pacing_gain_ = kHighGain;
+  cwnd_gain_ = kHighGain;
+  cwnd_ = config_.initial_cwnd;
+  prior_cwnd_ = 0;
+  timeout_recovery_ = false;
+  delivered_ = 0;
+  next_round_delivered_ = 0;
+  round_count_ = 0;
+  round_start_ = false;
+  bandwidth_by_round_.fill(0);
+  bandwidth_round_ = 0;
+  min_rtt_.reset();
+  min_rtt_stamp_ = now;
+  full_bandwidth_ = 0;
+  full_bandwidth_rounds_ = 0;
+  filled_pipe_ = false;
+  cycle_index_ = 0;
+  probe_rtt_done_.reset();
+  pacing_rate_ = 0;
+  next_send_time_ = now;
+  dup_ack_count_ = 0;
+  update_pacing_rate();
+
+  LOG_DEBUG("BbrController reset: cwnd={}", cwnd_);
+}
+
+void BbrController::set_srtt(std::chrono::milliseconds srtt) {
+  srtt_ = srtt;
+  update_pacing_rate();
+}
+
+std::uint64_t BbrController::bottleneck_bandwidth() const {
+  return *std::max_element(bandwidth_by_round_.begin(), bandwidth_by_round_.end());
+}
+
+void BbrController::update_round(const RateSample& sample) {
+  round_start_ = false;
+  if (sample.prior_delivered >= next_round_delivered_) {
+    next_round_delivered_ = delivered_;
+    ++round_count_;
+    round_start_ = true;
+  }
+}
+
+void BbrController::update_bandwidth(const RateSample& sample) {
+  if (sample.delivery_rate == 0) {
+    return;
+  }
+  // Expire the rounds that passed since the last sample.
+  const auto elapsed = std::min<std::uint64_t>(round_count_ - bandwidth_round_,
+                                               kBandwidthWindowRounds);
+  for (std::uint64_t i = 1; i <= elapsed; ++i) {
+    bandwidth_by_round_[(bandwidth_round_ + i) % kBandwidthWindowRounds] = 0;
+  }
+  bandwidth_round_ = round_count_;
+
+  auto& slot = bandwidth_by_round_[round_count_ % kBandwidthWindowRounds];
+  slot = std::max(slot, sample.delivery_rate);
+}
+
+void BbrController::check_full_pipe() {
+  if (filled_pipe_ || !round_start_) {
+    return;
+  }
+  const auto bandwidth = bottleneck_bandwidth();
+  if (static_cast<double>(bandwidth) >= static_cast<double>(full_bandwidth_) * 1.25) {
+    full_bandwidth_ = bandwidth;
+    full_bandwidth_rounds_ = 0;
+    return;
+  }
+  if (++full_bandwidth_rounds_ >= kFullBandwidthRounds) {
+    filled_pipe_ = true;
+    LOG_DEBUG("BBR pipe full: bandwidth={} B/s", bandwidth);
+  }
+}
+
+void BbrController::update_gain_cycle(const RateSample& sample, TimePoint now) {
+  const auto phase = min_rtt_.value_or(std::chrono::duration_cast<std::chrono::microseconds>(srtt_));
+  const bool full_length = now - cycle_stamp_ > phase;
+  // The draining phase may end as soon as the queue it targets is gone.
+  const bool advance = full_length || (pacing_gain_ < 1.0 &&
+                                       sample.bytes_in_flight <= target_cwnd(1.0));
+  if (!advance) {
+    return;
+  }
+  cycle_index_ = (cycle_index_ + 1) % kGainCycleLength;
+  cycle_stamp_ = now;
+  pacing_gain_ = kPacingGainCycle[cycle_index_];
+}
+
+void BbrController::update_min_rtt(const RateSample& sample, TimePoint now) {
+  const bool expired = min_rtt_ && now > min_rtt_stamp_ + kMinRttWindow;
+  if (sample.rtt.count() > 0 && (!min_rtt_ || sample.rtt <= *min_rtt_ || expired)) {
+    min_rtt_ = sample.rtt;
+    min_rtt_stamp_ = now;
+  }
+
+  if (expired && mode_ != BbrMode::kProbeRtt) {
+    prior_cwnd_ = std::max(prior_cwnd_, cwnd_);
+    enter_mode(BbrMode::kProbeRtt, now);
+    cwnd_ = std::min(cwnd_, 4 * config_.mss);
+    return;
+  }
+  if (mode_ != BbrMode::kProbeRtt) {
+    return;
+  }
+  if (!probe_rtt_done_) {
+    if (sample.bytes_in_flight <= 4 * config_.mss) {
+      probe_rtt_done_ = now + kProbeRttDuration;
+    }
+  } else if (now >= *probe_rtt_done_) {
+    min_rtt_stamp_ = now;
+    cwnd_ = std::max(cwnd_, prior_cwnd_);
+    prior_cwnd_ = 0;
+    enter_mode(filled_pipe_ ? BbrMode::kProbeBw : BbrMode::kStartup, now);
+  }
+}
+
+void BbrController::update_pacing_rate() {
+  const auto bandwidth = bottleneck_bandwidth();
+  std::size_t rate = 0;
+  if (bandwidth == 0) {
+    // No sample yet: pace the initial window over the smoothed RTT.
+    const auto srtt_ms = static_cast<std::size_t>(std::max<std::int64_t>(srtt_.count(), 1));
+    rate = static_cast<std::size_t>(kHighGain * static_cast<double>(cwnd_ * 1000 / srtt_ms));
+  } else {
+    rate = static_cast<std::size_t>(pacing_gain_ * static_cast<double>(bandwidth));
+  }
+  // Startup only speeds up: an early low sample must not slow the search.
+  if (!filled_pipe_ && rate < pacing_rate_) {
+    return;
+  }
+  pacing_rate_ = rate;
+}
+
+void BbrController::enter_mode(BbrMode mode, TimePoint now) {
+  mode_ = mode;
+  ++stats_.state_transitions;
+  switch (mode) {
+    case BbrMode::kStartup:
+      pacing_gain_ = kHighGain;
+      cwnd_gain_ = kHighGain;
+      break;
+    case BbrMode::kDrain:
+      pacing_gain_ = 1.0 / kHighGain;
+      cwnd_gain_ = kHighGain;
+      break;
+    case BbrMode::kProbeBw:
+      cycle_index_ = kInitialCycleIndex;
+      cycle_stamp_ = now;
+      pacing_gain_ = kPacingGainCycle[cycle_index_];
+      cwnd_gain_ = kProbeBwCwndGain;
+      break;
+    case BbrMode::kProbeRtt:
+      probe_rtt_done_.reset();
+      pacing_gain_ = 1.0;
+      cwnd_gain_ = 1.0;
+      break;
+  }
+  LOG_DEBUG("BBR entered mode {}", static_cast<int>(mode));
+}
+
+std::size_t BbrController::target_cwnd(double gain) const {
+  const auto bandwidth = bottleneck_bandwidth();
+  if (bandwidth == 0 || !min_rtt_) {
+    return config_.initial_cwnd;
+  }
+  const auto bdp = static_cast<double>(bandwidth) * static_cast<double>(min_rtt_->count()) / 1e6;
+  const auto target = static_cast<std::size_t>(gain * bdp) + 3 * config_.mss;
+  return std::max(target, 4 * config_.mss);
+}
+
+std::chrono::microseconds BbrController::pacing_interval() const {
+  if (pacing_rate_ == 0) {
+    return config_.min_pacing_interval;
+  }
+  const auto interval_us = (config_.mss * 1000000) / pacing_rate_;
+  return std::chrono::microseconds(std::max<std::size_t>(interval_us, 1));
+}
+
+}  // namespace veil::mux
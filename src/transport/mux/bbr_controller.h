@@ -0,0 +1,148 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+
+#include "transport/mux/congestion_controller.h"
+
+namespace veil::mux {
+
+// BBR state machine (see BbrController).
+enum class BbrMode : std::uint8_t {
+  kStartup = 0,   // Doubling the sending rate each round until bandwidth stops growing
+  kDrain = 1,     // Draining the queue Startup built
+  kProbeBw = 2,   // Cycling the pacing gain around the bandwidth estimate
+  kProbeRtt = 3   // Briefly shrinking inflight to re-measure the minimum RTT
+};
+
+/**
+ * BBR congestion control (model-based, after BBR v1).
+ *
+ * Instead of reading loss as congestion, BBR keeps a model of the path: the bottleneck
+ * bandwidth (maximum delivery rate over the last 10 round trips, from RetransmitBuffer
+ * rate samples) and the propagation delay (minimum RTT over 10 seconds). It paces at
+ * the bandwidth estimate times a gain and caps inflight at twice the bandwidth-delay
+ * product, so random loss on a long, lossy link does not collapse the sending rate
+ * the way it does for AIMD.
+ *
+ * Losses are counted but do not shrink the model. A retransmit timeout falls back to
+ * one packet in flight until the next ACK, which restores the window.
+ *
+ * Thread Safety:
+ *   This class is NOT thread-safe. All methods must be called from a single thread.
+ */
+class BbrController : public CongestionControl {
+ public:
+  // 2 / ln(2): the smallest gain that doubles the delivery rate each round.
+  static constexpr double kHighGain = 2.885;
+  static constexpr double kProbeBwCwndGain = 2.0;
+  static constexpr std::size_t kBandwidthWindowRounds = 10;
+  static constexpr std::size_t kGainCycleLength = 8;
+  static constexpr std::chrono::seconds kMinRttWindow{10};
+  static constexpr std::chrono::milliseconds kProbeRttDuration{200};
+  // Startup ends after this many rounds without 25% bandwidth growth.
+  static constexpr std::uint32_t kFullBandwidthRounds = 3;
+
+  explicit BbrController(CongestionConfig config = {},
+                         std::function<TimePoint()> now_fn = Clock::now);
+
+  CongestionAlgorithm algorithm() const override { return CongestionAlgorithm::kBbr; }
+
+  void on_ack(std::size_t acked_bytes) override;
+  void on_rate_sample(const RateSample& sample) override;
+  bool on_duplicate_ack() override;
+  void on_timeout_loss() override;
+  void on_fast_retransmit_loss() override;
+  void on_recovery_complete() override {}
+  void on_ecn_ce() override;
+
+  bool can_send(std::size_t bytes_in_flight) const override;
+  std::size_t sendable_bytes(std::size_t bytes_in_flight) const override;
+
+  bool check_pacing() override;
+  std::optional<std::chrono::microseconds> time_until_next_send() const override;
+
+  std::size_t cwnd() const override { return cwnd_; }
+  // BBR has no slow start threshold; this is the window the model currently targets.
+  std::size_t ssthresh() const override { return target_cwnd(cwnd_gain_); }
+  CongestionState state() const override {
+    return mode_ == BbrMode::kStartup ? CongestionState::kSlowStart
+                                      : CongestionState::kCongestionAvoidance;
+  }
+  std::size_t pacing_rate() const override { return pacing_rate_; }
+  const CongestionStats& stats() const override { return stats_; }
+
+  void reset() override;
+  void set_srtt(std::chrono::milliseconds srtt) override;
+
+  // ========== Model ==========
+
+  BbrMode mode() const { return mode_; }
+  // Bottleneck bandwidth estimate in bytes per second (0 until the first sample).
+  std::uint64_t bottleneck_bandwidth() const;
+  // Minimum RTT over the last kMinRttWindow (nullopt until the first sample).
+  std::optional<std::chrono::microseconds> min_rtt() const { return min_rtt_; }
+  std::uint64_t round_count() const { return round_count_; }
+
+ private:
+  void update_round(const RateSample& sample);
+  void update_bandwidth(const RateSample& sample);
+  void check_full_pipe();
+  void update_gain_cycle(const RateSample& sample, TimePoint now);
+  void update_min_rtt(const RateSample& sample, TimePoint now);
+  void update_pacing_rate();
+  void enter_mode(BbrMode mode, TimePoint now);
+
+  // gain * estimated bandwidth-delay product, plus headroom for delayed ACKs.
+  std::size_t target_cwnd(double gain) const;
+  std::chrono::microseconds pacing_interval() const;
+
+  CongestionConfig config_;
+  std::function<TimePoint()> now_fn_;
+
+  BbrMode mode_{BbrMode::kStartup};
+  double pacing_gain_{kHighGain};
+  double cwnd_gain_{kHighGain};
+  std::size_t cwnd_;
+  // Window saved by a retransmit timeout or ProbeRTT, restored afterwards.
+  std::size_t prior_cwnd_{0};
+  bool timeout_recovery_{false};
+
+  // Round trips: a round ends when a packet sent after its start is acknowledged.
+  std::uint64_t delivered_{0};
+  std::uint64_t next_round_delivered_{0};
+  std::uint64_t round_count_{0};
+  bool round_start_{false};
+
+  // Windowed max filter: the highest delivery rate seen in each of the last rounds.
+  std::array<std::uint64_t, kBandwidthWindowRounds> bandwidth_by_round_{};
+  std::uint64_t bandwidth_round_{0};
+
+  std::optional<std::chrono::microseconds> min_rtt_;
+  TimePoint min_rtt_stamp_{};
+
+  // Startup exit.
+  std::uint64_t full_bandwidth_{0};
+  std::uint32_t full_bandwidth_rounds_{0};
+  bool filled_pipe_{false};
+
+  // ProbeBW gain cycle.
+  std::size_t cycle_index_{0};
+  TimePoint cycle_stamp_{};
+
+  // ProbeRTT exit time; unset until inflight has drained to the minimum window.
+  std::optional<TimePoint> probe_rtt_done_;
+
+  // Pacing state.
+  std::size_t pacing_rate_{0};
+  TimePoint next_send_time_{};
+  std::chrono::milliseconds srtt_{100};
+
+  std::uint32_t dup_ack_count_{0};
+  CongestionStats stats_;
+};
+
+}  // namespace veil::mux
@@ -6,9 +6,25 @@
 #include <utility>
 
 #include "common/logging/logger.h"
+#include "transport/mux/bbr_controller.h"
+#include "transport/mux/cubic_controller.h"
 
 namespace veil::mux {
 
+std::unique_ptr<CongestionControl> make_congestion_control(
+    CongestionAlgorithm algorithm, CongestionConfig config,
+    std::function<CongestionControl::TimePoint()> now_fn) {
+  switch (algorithm) {
+    case CongestionAlgorithm::kCubic:
+      return std::make_unique<CubicController>(config, std::move(now_fn));
+    case CongestionAlgorithm::kBbr:
+      return std::make_unique<BbrController>(config, std::move(now_fn));
+    case CongestionAlgorithm::kReno:
+      break;
+  }
+  return std::make_unique<CongestionController>(config, std::move(now_fn));
+}
+
 CongestionController::CongestionController(CongestionConfig config,
                                            std::function<TimePoint()> now_fn)
     : config_(config),
@@ -50,16 +66,11 @@ void CongestionController::on_ack(std::size_t acked_bytes) {
     }
 
     case CongestionState::kCongestionAvoidance: {
-      // Congestion avoidance: Linear increase.
-      // RFC 5681: cwnd += SMSS * SMSS / cwnd for each ACK.
-      // This results in ~1 MSS increase per RTT.
-      if (cwnd_ > 0) {
-        const std::size_t increase = (config_.mss * acked_bytes) / cwnd_;
-        if (increase > 0) {
-          cwnd_ = std::min(cwnd_ + increase, config_.max_cwnd);
-          ++stats_.cwnd_increases;
-          LOG_DEBUG("Congestion avoidance: cwnd increased to {} (+{})", cwnd_, increase);
-        }
+      const std::size_t increase = avoidance_increase(acked_bytes);
+      if (increase > 0) {
+        cwnd_ = std::min(cwnd_ + increase, config_.max_cwnd);
+        ++stats_.cwnd_increases;
+        LOG_DEBUG("Congestion avoidance: cwnd increased to {} (+{})", cwnd_, increase);
       }
       break;
     }
@@ -108,7 +119,8 @@ void CongestionController::on_timeout_loss() {
   // RFC 5681: On timeout, enter slow start.
   // ssthresh = max(FlightSize / 2, 2 * MSS)
   // cwnd = 1 MSS (or IW in RFC 6928)
-  ssthresh_ = std::max(cwnd_ / 2, 2 * config_.mss);
+  save_undo_state();
+  ssthresh_ = ssthresh_after_congestion();
   cwnd_ = config_.mss;  // Conservative: 1 MSS on timeout.
 
   LOG_INFO("Timeout loss: ssthresh={}, cwnd={}", ssthresh_, cwnd_);
@@ -123,7 +135,8 @@ void CongestionController::on_fast_retransmit_loss() {
   // RFC 5681 Fast Retransmit/Fast Recovery:
   // ssthresh = max(FlightSize / 2, 2 * MSS)
   // cwnd = ssthresh + 3 * MSS (accounting for the 3 dup ACKs)
-  ssthresh_ = std::max(cwnd_ / 2, 2 * config_.mss);
+  save_undo_state();
+  ssthresh_ = ssthresh_after_congestion();
   cwnd_ = ssthresh_ + 3 * config_.mss;
 
   LOG_INFO("Fast retransmit loss: ssthresh={}, cwnd={}", ssthresh_, cwnd_);
@@ -145,6 +158,39 @@ void CongestionController::on_recovery_complete() {
   enter_congestion_avoidance();
 }
 
+void CongestionController::on_ecn_ce() {
+  ++stats_.ecn_ce_events;
+  ++stats_.cwnd_decreases;
+  // Marks are certain congestion: no later finding can justify undoing this.
+  undo_valid_ = false;
+
+  ssthresh_ = ssthresh_after_congestion();
+  cwnd_ = ssthresh_;
+
+  LOG_INFO("ECN congestion experienced: ssthresh={}, cwnd={}", ssthresh_, cwnd_);
+
+  dup_ack_count_ = 0;
+  enter_congestion_avoidance();
+}
+
+void CongestionController::on_spurious_loss() {
+  if (!undo_valid_) {
+    return;
+  }
+  undo_valid_ = false;
+  ++stats_.loss_undos;
+  restore_undo_state();
+  dup_ack_count_ = 0;
+
+  LOG_INFO("Spurious loss: cwnd restored to {}, ssthresh={}", cwnd_, ssthresh_);
+
+  if (cwnd_ < ssthresh_) {
+    enter_slow_start();
+  } else {
+    enter_congestion_avoidance();
+  }
+}
+
 bool CongestionController::can_send(std::size_t bytes_in_flight) const {
   // Can send if bytes_in_flight < cwnd.
   return bytes_in_flight < cwnd_;
@@ -234,6 +280,7 @@ void CongestionController::reset() {
   ssthresh_ = config_.initial_ssthresh;
   state_ = CongestionState::kSlowStart;
   dup_ack_count_ = 0;
+  undo_valid_ = false;
   pacing_burst_remaining_ = config_.max_pacing_burst;
   last_send_time_ = now_fn_();
   update_pacing_rate(srtt_);
@@ -241,6 +288,33 @@ void CongestionController::reset() {
   LOG_DEBUG("CongestionController reset: cwnd={}, ssthresh={}", cwnd_, ssthresh_);
 }
 
+std::size_t CongestionController::ssthresh_after_congestion() {
+  return std::max(cwnd_ / 2, 2 * config_.mss);
+}
+
+std::size_t CongestionController::avoidance_increase(std::size_t acked_bytes) {
+  // RFC 5681: cwnd += SMSS * SMSS / cwnd for each ACK.
+  // This results in ~1 MSS increase per RTT.
+  if (cwnd_ == 0) {
+    return 0;
+  }
+  return (config_.mss * acked_bytes) / cwnd_;
+}
+
+void CongestionController::save_undo_state() {
+  if (undo_valid_) {
+    return;  // Same episode: keep the state from before its first reduction.
+  }
+  undo_valid_ = true;
+  undo_cwnd_ = cwnd_;
+  undo_ssthresh_ = ssthresh_;
+}
+
+void CongestionController::restore_undo_state() {
+  cwnd_ = std::max(cwnd_, undo_cwnd_);
+  ssthresh_ = std::max(ssthresh_, undo_ssthresh_);
+}
+
 void CongestionController::enter_slow_start() {
   if (state_ != CongestionState::kSlowStart) {
     state_ = CongestionState::kSlowStart;
@@ -3,8 +3,11 @@
 #include <chrono>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <optional>
 
+#include "transport/mux/retransmit_buffer.h"
+
 namespace veil::mux {
 
 // Congestion control state.
@@ -14,6 +17,13 @@ enum class CongestionState : std::uint8_t {
   kFastRecovery = 2         // After fast retransmit, before full recovery
 };
 
+// Congestion control algorithm (TransportSessionConfig::congestion_algorithm).
+enum class CongestionAlgorithm : std::uint8_t {
+  kReno = 0,   // CongestionController: loss-based AIMD
+  kCubic = 1,  // CubicController: RFC 8312 cubic window growth
+  kBbr = 2     // BbrController: paced at a model of bottleneck bandwidth and RTT
+};
+
 // Configuration for congestion control behavior.
 struct CongestionConfig {
   // Initial congestion window in bytes.
@@ -61,6 +71,10 @@ struct CongestionStats {
   std::uint64_t fast_retransmits{0};
   std::uint64_t timeout_retransmits{0};
   std::uint64_t duplicate_acks{0};
+  // Congestion reported by ECN-CE marks in extended ACKs.
+  std::uint64_t ecn_ce_events{0};
+  // Loss reductions undone because the losses were spurious.
+  std::uint64_t loss_undos{0};
 
   // State transitions.
   std::uint64_t state_transitions{0};
@@ -74,6 +88,88 @@ struct CongestionStats {
   std::size_t peak_bytes_in_flight{0};
 };
 
+/**
+ * Interface implemented by each congestion control algorithm.
+ *
+ * TransportSession reports ACKs, losses and RTT to the controller it selected through
+ * make_congestion_control(); senders gate transmission with can_send() and
+ * check_pacing(). Not thread-safe, like the session that owns it.
+ */
+class CongestionControl {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+  using Duration = std::chrono::microseconds;
+
+  virtual ~CongestionControl() = default;
+
+  virtual CongestionAlgorithm algorithm() const = 0;
+
+  // ========== Congestion Window Management ==========
+
+  // Called when an ACK is received for acked_bytes of data.
+  virtual void on_ack(std::size_t acked_bytes) = 0;
+
+  // Called after on_ack() with the retransmit buffer's delivery-rate sample for that
+  // ACK. Loss-based controllers ignore it.
+  virtual void on_rate_sample(const RateSample& /*sample*/) {}
+
+  // Called when a duplicate ACK is received.
+  // Returns true if fast retransmit should be triggered.
+  virtual bool on_duplicate_ack() = 0;
+
+  // Called when packet loss is detected via timeout.
+  virtual void on_timeout_loss() = 0;
+
+  // Called when packet loss is detected via fast retransmit.
+  virtual void on_fast_retransmit_loss() = 0;
+
+  // Called when exiting fast recovery.
+  virtual void on_recovery_complete() = 0;
+
+  // Called when the peer reports new ECN-CE marks.
+  virtual void on_ecn_ce() = 0;
+
+  // Called when every loss behind the last window reductions proved spurious (the
+  // original transmissions were delivered): restore the window from before them.
+  virtual void on_spurious_loss() {}
+
+  // Called when one of those losses proved real: the reductions stand.
+  virtual void on_loss_confirmed() {}
+
+  // ========== Send Permission ==========
+
+  virtual bool can_send(std::size_t bytes_in_flight) const = 0;
+  virtual std::size_t sendable_bytes(std::size_t bytes_in_flight) const = 0;
+
+  // ========== Pacing ==========
+
+  // Returns true if a packet may be sent now; consumes the pacing allowance.
+  virtual bool check_pacing() = 0;
+
+  // Time to wait before the next send, or nullopt if a packet can be sent now.
+  virtual std::optional<std::chrono::microseconds> time_until_next_send() const = 0;
+
+  // ========== State Queries ==========
+
+  virtual std::size_t cwnd() const = 0;
+  virtual std::size_t ssthresh() const = 0;
+  virtual CongestionState state() const = 0;
+  // Pacing rate in bytes per second.
+  virtual std::size_t pacing_rate() const = 0;
+  virtual const CongestionStats& stats() const = 0;
+
+  virtual void reset() = 0;
+
+  // Set the current smoothed RTT (used for pacing calculations).
+  virtual void set_srtt(std::chrono::milliseconds srtt) = 0;
+};
+
+// Create the controller for an algorithm.
+std::unique_ptr<CongestionControl> make_congestion_control(
+    CongestionAlgorithm algorithm, CongestionConfig config = {},
+    std::function<CongestionControl::TimePoint()> now_fn = CongestionControl::Clock::now);
+
 /**
  * Implements TCP-like congestion control (AIMD) for reliable UDP transport.
  *
@@ -93,51 +189,59 @@ struct CongestionStats {
  *   - RFC 5681: TCP Congestion Control
  *   - RFC 6928: Increasing TCP's Initial Window
  */
-class CongestionController {
+class CongestionController : public CongestionControl {
  public:
-  using Clock = std::chrono::steady_clock;
-  using TimePoint = Clock::time_point;
-  using Duration = std::chrono::microseconds;
-
   explicit CongestionController(CongestionConfig config = {},
                                  std::function<TimePoint()> now_fn = Clock::now);
 
+  CongestionAlgorithm algorithm() const override { return CongestionAlgorithm::kReno; }
+
   // ========== Congestion Window Management ==========
 
   // Called when an ACK is received for acked_bytes of data.
   // Updates congestion window based on current state.
-  void on_ack(std::size_t acked_bytes);
+  void on_ack(std::size_t acked_bytes) override;
 
   // Called when a duplicate ACK is received.
   // Returns true if fast retransmit should be triggered.
-  bool on_duplicate_ack();
+  bool on_duplicate_ack() override;
 
   // Called when packet loss is detected via timeout.
-  void on_timeout_loss();
+  void on_timeout_loss() override;
 
   // Called when packet loss is detected via fast retransmit.
-  void on_fast_retransmit_loss();
+  void on_fast_retransmit_loss() override;
 
   // Called when exiting fast recovery.
-  void on_recovery_complete();
+  void on_recovery_complete() override;
+
+  // Called when the peer reports new ECN-CE marks (RFC 3168: respond as to a loss, but
+  // nothing needs retransmitting, so go straight to congestion avoidance).
+  void on_ecn_ce() override;
+
+  // Undo the loss reductions since the last on_loss_confirmed() (Eifel response,
+  // RFC 4015): back to the earlier window and slow start threshold.
+  void on_spurious_loss() override;
+
+  void on_loss_confirmed() override { undo_valid_ = false; }
 
   // ========== Send Permission ==========
 
   // Check if we can send more data given current bytes in flight.
-  bool can_send(std::size_t bytes_in_flight) const;
+  bool can_send(std::size_t bytes_in_flight) const override;
 
   // Get the number of bytes that can be sent now.
-  std::size_t sendable_bytes(std::size_t bytes_in_flight) const;
+  std::size_t sendable_bytes(std::size_t bytes_in_flight) const override;
 
   // ========== Pacing ==========
 
   // Check if a packet can be sent now according to pacing.
   // Returns true if the packet can be sent, false if it should be delayed.
-  bool check_pacing();
+  bool check_pacing() override;
 
   // Get the time to wait before sending the next packet.
   // Returns nullopt if a packet can be sent immediately.
-  std::optional<std::chrono::microseconds> time_until_next_send() const;
+  std::optional<std::chrono::microseconds> time_until_next_send() const override;
 
   // Update pacing rate based on current RTT.
   void update_pacing_rate(std::chrono::milliseconds rtt);
@@ -145,29 +249,39 @@ class CongestionController {
   // ========== State Queries ==========
 
   // Current congestion window in bytes.
-  std::size_t cwnd() const { return cwnd_; }
+  std::size_t cwnd() const override { return cwnd_; }
 
   // Current slow start threshold.
-  std::size_t ssthresh() const { return ssthresh_; }
+  std::size_t ssthresh() const override { return ssthresh_; }
 
   // Current state.
-  CongestionState state() const { return state_; }
+  CongestionState state() const override { return state_; }
 
   // Current pacing rate in bytes per second.
-  std::size_t pacing_rate() const { return pacing_rate_; }
+  std::size_t pacing_rate() const override { return pacing_rate_; }
 
   // Get statistics.
-  const CongestionStats& stats() const { return stats_; }
+  const CongestionStats& stats() const override { return stats_; }
 
   // Reset controller to initial state.
-  void reset();
+  void reset() override;
 
   // ========== RTT Integration ==========
 
   // Set the current smoothed RTT (used for pacing calculations).
-  void set_srtt(std::chrono::milliseconds srtt);
+  void set_srtt(std::chrono::milliseconds srtt) override;
+
+ protected:
+  // Slow start threshold after a congestion event (loss or ECN-CE): max(cwnd / 2, 2 MSS).
+  virtual std::size_t ssthresh_after_congestion();
+
+  // Window increase in congestion avoidance for acked_bytes: ~1 MSS per RTT.
+  virtual std::size_t avoidance_increase(std::size_t acked_bytes);
+
+  // Record the state before the first loss reduction of an episode, and restore it.
+  virtual void save_undo_state();
+  virtual void restore_undo_state();
 
- private:
   // Internal state transitions.
   void enter_slow_start();
   void enter_congestion_avoidance();
@@ -187,6 +301,11 @@ class CongestionController {
   // Duplicate ACK tracking.
   std::uint32_t dup_ack_count_{0};
 
+  // State before the current loss episode, for on_spurious_loss().
+  bool undo_valid_{false};
+  std::size_t undo_cwnd_{0};
+  std::size_t undo_ssthresh_{0};
+
   // Pacing state.
   std::size_t pacing_rate_{0};
   TimePoint last_send_time_;
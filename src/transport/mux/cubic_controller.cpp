@@ -0,0 +1,87 @@
+#include "transport/mux/cubic_controller.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+#include "common/logging/logger.h"
+
+namespace veil::mux {
+
+CubicController::CubicController(CongestionConfig config, std::function<TimePoint()> now_fn)
+    : CongestionController(config, std::move(now_fn)) {}
+
+void CubicController::reset() {
+  CongestionController::reset();
+  epoch_start_.reset();
+  w_max_ = 0;
+  w_last_max_ = 0;
+}
+
+std::size_t CubicController::ssthresh_after_congestion() {
+  const auto cwnd = static_cast<double>(cwnd_);
+  // Fast convergence: a flow whose window keeps shrinking releases bandwidth sooner.
+  w_max_ = cwnd < w_last_max_ ? cwnd * (1.0 + kBeta) / 2.0 : cwnd;
+  w_last_max_ = cwnd;
+  epoch_start_.reset();
+
+  const auto reduced = static_cast<std::size_t>(cwnd * kBeta);
+  LOG_DEBUG("CUBIC congestion event: w_max={}, ssthresh={}", w_max_, reduced);
+  return std::max(reduced, 2 * config_.mss);
+}
+
+void CubicController::save_undo_state() {
+  if (!undo_valid_) {
+    undo_w_max_ = w_max_;
+    undo_w_last_max_ = w_last_max_;
+  }
+  CongestionController::save_undo_state();
+}
+
+void CubicController::restore_undo_state() {
+  CongestionController::restore_undo_state();
+  // The loss never happened: the curve goes back to the previous congestion event.
+  w_max_ = undo_w_max_;
+  w_last_max_ = undo_w_last_max_;
+  epoch_start_.reset();
+}
+
+std::size_t CubicController::avoidance_increase(std::size_t acked_bytes) {
+  if (cwnd_ == 0) {
+    return 0;
+  }
+  const auto now = now_fn_();
+  const auto mss = static_cast<double>(config_.mss);
+  const auto cwnd = static_cast<double>(cwnd_);
+
+  if (!epoch_start_) {
+    epoch_start_ = now;
+    if (cwnd < w_max_) {
+      k_ = std::cbrt((w_max_ - cwnd) / mss / kC);
+      origin_ = w_max_;
+    } else {
+      k_ = 0;
+      origin_ = cwnd;
+    }
+    w_est_ = cwnd;
+  }
+
+  // Target one RTT ahead: W(t) = C * (t - K)^3 + W_max, in MSS units.
+  const double t = std::chrono::duration<double>(now - *epoch_start_ + srtt_).count();
+  double target = origin_ + kC * std::pow(t - k_, 3.0) * mss;
+
+  // TCP-friendly region: never below what Reno with the same beta would reach.
+  w_est_ += 3.0 * (1.0 - kBeta) / (1.0 + kBeta) * mss * static_cast<double>(acked_bytes) / cwnd;
+  target = std::max(target, w_est_);
+
+  // RFC 8312 4.1: grow by (target - cwnd) / cwnd per acknowledged MSS, at most 1.5x per RTT.
+  target = std::min(target, 1.5 * cwnd);
+  if (target <= cwnd) {
+    return 0;
+  }
+  return static_cast<std::size_t>((target - cwnd) * static_cast<double>(acked_bytes) / cwnd);
+}
+
+}  // namespace veil::mux
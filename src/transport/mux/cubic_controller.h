@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+
+#include "transport/mux/congestion_controller.h"
+
+namespace veil::mux {
+
+/**
+ * CUBIC congestion control (RFC 8312).
+ *
+ * Shares slow start, fast recovery and pacing with CongestionController. After a loss,
+ * the window shrinks by beta = 0.7 rather than half, then grows as a cubic function of
+ * the time since the loss: quickly back towards the window where the loss happened,
+ * flat around it, then probing beyond. Growth depends on elapsed time rather than on
+ * ACK arrivals, so a long RTT recovers as fast as a short one. It never grows more
+ * slowly than Reno would (the TCP-friendly region).
+ *
+ * Thread Safety:
+ *   This class is NOT thread-safe, like CongestionController.
+ */
+class CubicController : public CongestionController {
+ public:
+  // RFC 8312 constants.
+  static constexpr double kBeta = 0.7;
+  static constexpr double kC = 0.4;
+
+  explicit CubicController(CongestionConfig config = {},
+                           std::function<TimePoint()> now_fn = Clock::now);
+
+  CongestionAlgorithm algorithm() const override { return CongestionAlgorithm::kCubic; }
+
+  void reset() override;
+
+  // Window in bytes when the last congestion event happened.
+  double w_max() const { return w_max_; }
+
+ protected:
+  std::size_t ssthresh_after_congestion() override;
+  std::size_t avoidance_increase(std::size_t acked_bytes) override;
+  void save_undo_state() override;
+  void restore_undo_state() override;
+
+ private:
+  // Start of the current congestion avoidance epoch; unset until the first ACK after
+  // slow start or a congestion event.
+  std::optional<TimePoint> epoch_start_;
+  // Window at the last congestion event, and the one before it (for fast convergence).
+  double w_max_{0};
+  double w_last_max_{0};
+  // Seconds for the cubic curve to reach the epoch's origin, and that origin in bytes.
+  double k_{0};
+  double origin_{0};
+  // Reno-equivalent window for the TCP-friendly region, in bytes.
+  double w_est_{0};
+  // w_max_ and w_last_max_ before the current loss episode.
+  double undo_w_max_{0};
+  double undo_w_last_max_{0};
+};
+
+}  // namespace veil::mux
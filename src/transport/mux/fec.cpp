@@ -0,0 +1,205 @@
+#include "transport/mux/fec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace veil::mux {
+
+namespace {
+
+// Sequences one repair can cover (bits in FecRepairFrame::mask).
+constexpr std::uint64_t kMaxGroupSpan = 64;
+
+// Repairs held by the decoder while their group misses more than one packet.
+constexpr std::size_t kMaxHeldRepairs = 64;
+
+// Weight of one protected packet's outcome in the loss rate estimate.
+constexpr double kLossRateGain = 1.0 / 256;
+
+void xor_into(std::vector<std::uint8_t>& acc, std::span<const std::uint8_t> data) {
+  if (acc.size() < data.size()) {
+    acc.resize(data.size(), 0);
+  }
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    acc[i] ^= data[i];
+  }
+}
+
+// Chance that a group of n packets (the protected ones and the repair) loses two or
+// more at independent loss rate p.
+double unrepairable_share(std::size_t n, double p) {
+  const auto count = static_cast<double>(n);
+  return 1.0 - std::pow(1.0 - p, count) - count * p * std::pow(1.0 - p, count - 1);
+}
+
+FecConfig normalized(FecConfig config) {
+  config.min_group_size = std::clamp<std::size_t>(config.min_group_size, 2, kMaxGroupSpan);
+  config.max_group_size =
+      std::clamp<std::size_t>(config.max_group_size, config.min_group_size, kMaxGroupSpan);
+  config.initial_group_size =
+      std::clamp(config.initial_group_size, config.min_group_size, config.max_group_size);
+  return config;
+}
+
+// The largest group that keeps double losses within the target: fewer repairs on a
+// clean path, more as it gets lossier.
+std::size_t group_size_for(const FecConfig& config, double loss_rate) {
+  std::size_t size = config.max_group_size;
+  while (size > config.min_group_size &&
+         unrepairable_share(size + 1, loss_rate) > config.max_unrepairable_groups) {
+    --size;
+  }
+  return size;
+}
+
+}  // namespace
+
+FecEncoder::FecEncoder(FecConfig config, std::function<TimePoint()> now_fn)
+    : config_(normalized(config)),
+      now_fn_(std::move(now_fn)),
+      group_size_(config_.initial_group_size) {}
+
+std::optional<FecRepairFrame> FecEncoder::protect(std::uint64_t sequence,
+                                                  std::span<const std::uint8_t> plaintext) {
+  std::optional<FecRepairFrame> repair;
+  if (group_packets_ > 0 && sequence - group_.first_sequence >= kMaxGroupSpan) {
+    repair = close_group();
+  }
+  if (group_packets_ == 0) {
+    group_.first_sequence = sequence;
+    group_opened_ = now_fn_();
+  }
+  group_.mask |= std::uint64_t{1} << (sequence - group_.first_sequence);
+  group_.length_xor ^= static_cast<std::uint16_t>(plaintext.size());
+  xor_into(group_.payload, plaintext);
+  ++group_packets_;
+  ++stats_.packets_protected;
+
+  if (!repair && group_packets_ >= group_size_) {
+    repair = close_group();
+  }
+  return repair;
+}
+
+std::optional<FecRepairFrame> FecEncoder::poll() {
+  if (group_packets_ == 0 || now_fn_() < group_opened_ + config_.max_group_delay) {
+    return std::nullopt;
+  }
+  return close_group();
+}
+
+FecRepairFrame FecEncoder::close_group() {
+  FecRepairFrame repair = std::move(group_);
+  group_ = FecRepairFrame{};
+  group_packets_ = 0;
+  ++stats_.repairs_sent;
+  return repair;
+}
+
+void FecEncoder::set_group_size(std::size_t group_size) {
+  group_size_ = std::clamp(group_size, config_.min_group_size, config_.max_group_size);
+}
+
+FecDecoder::FecDecoder(FecConfig config, std::size_t window)
+    : config_(normalized(config)),
+      window_(std::max<std::size_t>(window, kMaxGroupSpan)),
+      group_size_(config_.initial_group_size) {}
+
+std::vector<RecoveredPacket> FecDecoder::on_packet(std::uint64_t sequence,
+                                                   std::span<const std::uint8_t> plaintext) {
+  std::vector<RecoveredPacket> out;
+  if (!received_.try_emplace(sequence, plaintext.begin(), plaintext.end()).second) {
+    return out;
+  }
+  highest_ = std::max(highest_, sequence);
+  forget_old();
+  if (!repairs_.empty()) {
+    drain(out);
+  }
+  return out;
+}
+
+std::vector<RecoveredPacket> FecDecoder::on_repair(FecRepairFrame repair) {
+  ++stats_.repairs_received;
+  sample_loss(repair);
+  if (repairs_.size() >= kMaxHeldRepairs) {
+    repairs_.pop_front();
+    ++stats_.repairs_unusable;
+  }
+  repairs_.push_back(std::move(repair));
+  std::vector<RecoveredPacket> out;
+  drain(out);
+  return out;
+}
+
+void FecDecoder::sample_loss(const FecRepairFrame& repair) {
+  for (std::uint64_t bit = 0; bit < kMaxGroupSpan; ++bit) {
+    if (((repair.mask >> bit) & 1U) == 0) {
+      continue;
+    }
+    const bool lost = received_.count(repair.first_sequence + bit) == 0;
+    loss_rate_ += kLossRateGain * ((lost ? 1.0 : 0.0) - loss_rate_);
+  }
+  group_size_ = group_size_for(config_, loss_rate_);
+}
+
+void FecDecoder::drain(std::vector<RecoveredPacket>& out) {
+  bool progress = true;
+  while (progress) {
+    progress = false;
+    for (auto it = repairs_.begin(); it != repairs_.end();) {
+      std::size_t missing_count = 0;
+      std::uint64_t missing = 0;
+      for (std::uint64_t bit = 0; bit < kMaxGroupSpan && missing_count < 2; ++bit) {
+        const auto seq = it->first_sequence + bit;
+        if (((it->mask >> bit) & 1U) != 0 && received_.count(seq) == 0) {
+          ++missing_count;
+          missing = seq;
+        }
+      }
+      if (missing_count > 1) {
+        ++it;
+        continue;
+      }
+      if (missing_count == 1) {
+        // XOR out every packet that arrived; what is left is the missing one.
+        auto payload = std::move(it->payload);
+        std::uint16_t length = it->length_xor;
+        for (std::uint64_t bit = 0; bit < kMaxGroupSpan; ++bit) {
+          const auto seq = it->first_sequence + bit;
+          if (((it->mask >> bit) & 1U) == 0 || seq == missing) {
+            continue;
+          }
+          const auto& data = received_.at(seq);
+          xor_into(payload, data);
+          length ^= static_cast<std::uint16_t>(data.size());
+        }
+        if (length <= payload.size()) {
+          payload.resize(length);
+          received_.emplace(missing, payload);
+          out.push_back(RecoveredPacket{missing, std::move(payload)});
+          ++stats_.packets_recovered;
+          progress = true;
+        }
+      }
+      it = repairs_.erase(it);
+    }
+  }
+}
+
+void FecDecoder::forget_old() {
+  if (highest_ < window_) {
+    return;
+  }
+  const auto oldest = highest_ - window_;
+  received_.erase(received_.begin(), received_.lower_bound(oldest));
+  while (!repairs_.empty() && repairs_.front().first_sequence + kMaxGroupSpan <= oldest) {
+    repairs_.pop_front();
+    ++stats_.repairs_unusable;
+  }
+}
+
+}  // namespace veil::mux
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "transport/mux/frame.h"
+
+namespace veil::mux {
+
+// Configuration for forward error correction.
+struct FecConfig {
+  // Protected packets per repair packet (K), adapted between these bounds from the loss
+  // rate the receiver measures. One repair rebuilds one lost packet of its group.
+  std::size_t min_group_size{4};
+  std::size_t max_group_size{32};
+  std::size_t initial_group_size{16};
+  // Largest share of groups allowed to lose two or more packets, which one XOR repair
+  // cannot rebuild and retransmission has to. K is the largest group size that meets it.
+  double max_unrepairable_groups{0.01};
+  // An open group is closed with a repair once its first packet is this old, so the
+  // tail of a burst is protected too.
+  std::chrono::milliseconds max_group_delay{20};
+};
+
+// Statistics for the sending side.
+struct FecEncoderStats {
+  std::uint64_t packets_protected{0};
+  std::uint64_t repairs_sent{0};
+};
+
+// Statistics for the receiving side.
+struct FecDecoderStats {
+  std::uint64_t repairs_received{0};
+  std::uint64_t packets_recovered{0};
+  // Repairs given up on: their group lost more than one packet.
+  std::uint64_t repairs_unusable{0};
+};
+
+// A packet rebuilt from a repair: its sequence and plaintext, as if it had arrived.
+struct RecoveredPacket {
+  std::uint64_t sequence{0};
+  std::vector<std::uint8_t> plaintext;
+};
+
+// Sending side of XOR forward error correction. Every group_size() protected packets
+// (by plaintext, before encryption) yield one FecRepairFrame, sent as a packet of its
+// own. On a path with random loss this repairs most losses within one packet time
+// instead of the round trip a retransmission takes.
+//
+// The group size is set by the receiver (FecDecoder::group_size(), carried in
+// kControlFecParams): only it sees which protected packets the path lost, before FEC
+// and retransmission hide them.
+class FecEncoder {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+
+  explicit FecEncoder(FecConfig config = {}, std::function<TimePoint()> now_fn = Clock::now);
+
+  // Add the plaintext of a protected packet sent under sequence. Returns a repair when
+  // this completes the group, or when the packet is too far past the group's first one
+  // for FecRepairFrame::mask (the group is then closed without it, and it starts the next).
+  std::optional<FecRepairFrame> protect(std::uint64_t sequence,
+                                        std::span<const std::uint8_t> plaintext);
+
+  // Repair for the open group once it has waited max_group_delay, if any.
+  std::optional<FecRepairFrame> poll();
+
+  // Use the group size the peer asked for, within the configured bounds.
+  void set_group_size(std::size_t group_size);
+
+  std::size_t group_size() const { return group_size_; }
+  const FecEncoderStats& stats() const { return stats_; }
+
+ private:
+  FecRepairFrame close_group();
+
+  FecConfig config_;
+  std::function<TimePoint()> now_fn_;
+  std::size_t group_size_;
+
+  // The open group: its repair so far, packet count, and when it was opened.
+  FecRepairFrame group_;
+  std::size_t group_packets_{0};
+  TimePoint group_opened_{};
+  FecEncoderStats stats_;
+};
+
+// Receiving side: keeps the plaintexts of recent protected packets and the repairs
+// still missing more than one of theirs, and rebuilds a packet as soon as it is the
+// only one its group is missing.
+//
+// Each repair also samples the loss rate (the share of its group missing when it
+// arrives), from which group_size() picks the largest group that keeps groups with
+// two or more losses within FecConfig::max_unrepairable_groups.
+class FecDecoder {
+ public:
+  // Packets are kept while within window sequences of the highest seen.
+  explicit FecDecoder(FecConfig config = {}, std::size_t window = 256);
+
+  // Record a received protected packet. Returns packets rebuilt now that it arrived.
+  std::vector<RecoveredPacket> on_packet(std::uint64_t sequence,
+                                         std::span<const std::uint8_t> plaintext);
+
+  // Take a repair. Returns the packet it rebuilds, if its group is missing only one.
+  std::vector<RecoveredPacket> on_repair(FecRepairFrame repair);
+
+  // Group size to ask the sender for, from the measured loss rate.
+  std::size_t group_size() const { return group_size_; }
+  double loss_rate() const { return loss_rate_; }
+  const FecDecoderStats& stats() const { return stats_; }
+
+ private:
+  // Update the loss rate from a repair's group as it arrives.
+  void sample_loss(const FecRepairFrame& repair);
+
+  // Rebuild from every held repair that is missing exactly one packet, repeatedly, since
+  // a rebuilt packet can complete another group. Repairs missing none are dropped.
+  void drain(std::vector<RecoveredPacket>& out);
+  void forget_old();
+
+  FecConfig config_;
+  std::size_t window_;
+  std::size_t group_size_;
+  double loss_rate_{0.0};
+  std::uint64_t highest_{0};
+  std::map<std::uint64_t, std::vector<std::uint8_t>> received_;
+  std::deque<FecRepairFrame> repairs_;
+  FecDecoderStats stats_;
+};
+
+}  // namespace veil::mux
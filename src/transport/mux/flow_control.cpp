@@ -0,0 +1,123 @@
+#include "transport/mux/flow_control.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "transport/mux/mux_codec.h"
+
+namespace veil::mux {
+
+namespace {
+
+constexpr std::size_t kFlowCreditSize = 1 + 1 + 8 + 8;
+
+// Round trips within which half a window must drain for the window to grow.
+constexpr int kAutoTuneRtts = 2;
+
+void write_u64(std::vector<std::uint8_t>& out, std::uint64_t value) {
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    out.push_back(static_cast<std::uint8_t>(value >> shift));
+  }
+}
+
+std::uint64_t read_u64(const std::uint8_t* in) {
+  std::uint64_t value = 0;
+  for (int i = 0; i < 8; ++i) {
+    value = (value << 8) | in[i];
+  }
+  return value;
+}
+
+}  // namespace
+
+MuxFrame make_flow_credit_frame(const FlowCredit& credit) {
+  std::vector<std::uint8_t> payload;
+  payload.reserve(kFlowCreditSize);
+  payload.push_back(kFlowCreditVersion);
+  payload.push_back(static_cast<std::uint8_t>(credit.kind));
+  write_u64(payload, credit.stream_id);
+  write_u64(payload, credit.offset);
+  return make_control_frame(kControlFlowCredit, std::move(payload));
+}
+
+std::optional<FlowCredit> parse_flow_credit(const ControlFrame& control) {
+  const auto& payload = control.payload;
+  if (control.type != kControlFlowCredit || payload.size() < kFlowCreditSize ||
+      payload[0] != kFlowCreditVersion) {
+    return std::nullopt;
+  }
+  if (payload[1] > static_cast<std::uint8_t>(FlowCreditKind::kBlocked)) {
+    return std::nullopt;
+  }
+  FlowCredit credit;
+  credit.kind = static_cast<FlowCreditKind>(payload[1]);
+  credit.stream_id = read_u64(payload.data() + 2);
+  credit.offset = read_u64(payload.data() + 10);
+  return credit;
+}
+
+ReceiveWindow::ReceiveWindow(std::uint64_t initial_window, std::uint64_t max_window)
+    : window_(initial_window),
+      max_window_(std::max(initial_window, max_window)),
+      limit_(initial_window) {}
+
+bool ReceiveWindow::on_received(std::uint64_t bytes) {
+  received_ += bytes;
+  return !advertised_ || received_ <= limit_;
+}
+
+void ReceiveWindow::on_consumed(std::uint64_t bytes) { consumed_ += bytes; }
+
+void ReceiveWindow::on_peer_blocked(std::uint64_t offset) {
+  // Blocked below our limit: the peer missed the update that raised it.
+  if (advertised_ && offset < limit_) {
+    resend_ = true;
+  }
+}
+
+std::optional<std::uint64_t> ReceiveWindow::take_update(TimePoint now,
+                                                        std::chrono::microseconds rtt) {
+  // limit_ was consumed_ + window_ when sent, and both only grow since.
+  const auto freed = consumed_ + window_ - limit_;
+  if (advertised_ && freed < window_ / 2) {
+    if (!resend_) {
+      return std::nullopt;
+    }
+    resend_ = false;
+    return limit_;
+  }
+  if (advertised_ && now - last_update_ < kAutoTuneRtts * rtt) {
+    window_ = std::min(window_ * 2, max_window_);
+  }
+  advertised_ = true;
+  resend_ = false;
+  last_update_ = now;
+  limit_ = consumed_ + window_;
+  return limit_;
+}
+
+void SendWindow::on_limit(std::uint64_t limit) {
+  if (active_ && limit <= limit_) {
+    return;
+  }
+  active_ = true;
+  limit_ = limit;
+  blocked_ = false;
+  last_blocked_report_.reset();
+}
+
+void SendWindow::on_abandoned(std::uint64_t bytes) { sent_ -= std::min(sent_, bytes); }
+
+std::optional<std::uint64_t> SendWindow::take_blocked_report(TimePoint now,
+                                                             std::chrono::microseconds interval) {
+  if (!blocked_ || (last_blocked_report_ && now - *last_blocked_report_ < interval)) {
+    return std::nullopt;
+  }
+  last_blocked_report_ = now;
+  return sent_;
+}
+
+}  // namespace veil::mux
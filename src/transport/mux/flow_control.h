@@ -0,0 +1,130 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+#include "transport/mux/frame.h"
+
+namespace veil::mux {
+
+// Configuration for receiver-advertised flow control. Windows are in bytes of DATA
+// payload, per stream and for the whole session (all streams together).
+struct FlowControlConfig {
+  // Credit granted before anything is known about the path. A single message larger
+  // than the stream window can never be sent, so it must exceed the largest IP packet.
+  std::uint64_t initial_stream_window{128 * 1024};
+  std::uint64_t initial_session_window{192 * 1024};
+  // Auto-tuning ceilings (see ReceiveWindow).
+  std::uint64_t max_stream_window{8 << 20};
+  std::uint64_t max_session_window{12 << 20};
+  // DATA held by a sender waiting for credit; beyond it new messages are dropped, as
+  // a full socket buffer would.
+  std::size_t max_blocked_bytes{1 << 20};
+};
+
+// Credit kinds carried in kControlFlowCredit.
+enum class FlowCreditKind : std::uint8_t {
+  // Receiver -> sender: payload bytes may be sent up to offset (a limit only grows).
+  kLimit = 0,
+  // Sender -> receiver: blocked with offset bytes sent. A receiver that has advertised
+  // more sends its limit again (the update was lost).
+  kBlocked = 1,
+};
+
+// Stream id of the session-wide window. DATA never uses kDatagramStreamId.
+inline constexpr std::uint64_t kSessionCreditId = kDatagramStreamId;
+
+struct FlowCredit {
+  FlowCreditKind kind{FlowCreditKind::kLimit};
+  std::uint64_t stream_id{0};
+  std::uint64_t offset{0};
+};
+
+MuxFrame make_flow_credit_frame(const FlowCredit& credit);
+
+// Parse a kControlFlowCredit payload; nullopt if malformed or of another version.
+std::optional<FlowCredit> parse_flow_credit(const ControlFrame& control);
+
+// Receive side of one credit window: a stream's, or the session's. The limit advertised
+// is the payload consumed (handed to the caller) plus the window, so the peer never has
+// more outstanding than the receiver agreed to hold. An update is due once half the
+// window has been consumed since the last one.
+//
+// Auto-tuning: when that half window was consumed within two round trips of the last
+// update, the window rather than the path limits the sender, so it doubles (up to the
+// maximum). A window thus grows to the bandwidth-delay product the peer reaches and no
+// further; a slow consumer keeps its window, and the memory it commits, small.
+class ReceiveWindow {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+
+  ReceiveWindow(std::uint64_t initial_window, std::uint64_t max_window);
+
+  // Account received payload bytes. Returns false if they go past the advertised limit
+  // (never before the first one is advertised).
+  bool on_received(std::uint64_t bytes);
+
+  // Payload bytes consumed, which frees their credit.
+  void on_consumed(std::uint64_t bytes);
+
+  // The peer reported it is blocked at offset (FlowCreditKind::kBlocked).
+  void on_peer_blocked(std::uint64_t offset);
+
+  // The limit to advertise, if an update is due. rtt is the current round-trip estimate.
+  std::optional<std::uint64_t> take_update(TimePoint now, std::chrono::microseconds rtt);
+
+  std::uint64_t window() const { return window_; }
+  std::uint64_t limit() const { return limit_; }
+  std::uint64_t received() const { return received_; }
+  std::uint64_t consumed() const { return consumed_; }
+
+ private:
+  std::uint64_t window_;
+  std::uint64_t max_window_;
+  std::uint64_t received_{0};
+  std::uint64_t consumed_{0};
+  std::uint64_t limit_;
+  bool advertised_{false};
+  bool resend_{false};
+  TimePoint last_update_{};
+};
+
+// Send side of one credit window: the limit the peer advertised and the payload bytes
+// sent against it. Unlimited until the first limit arrives, so a peer without flow
+// control (which never sends one) is not throttled.
+class SendWindow {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+
+  // Take an advertised limit. Lower (reordered) limits are ignored.
+  void on_limit(std::uint64_t limit);
+
+  bool can_send(std::uint64_t bytes) const { return !active_ || sent_ + bytes <= limit_; }
+  void on_sent(std::uint64_t bytes) { sent_ += bytes; }
+
+  // Payload of a packet given up on (never delivered): its credit can be used again.
+  void on_abandoned(std::uint64_t bytes);
+
+  // Mark the window as holding up a send, until a higher limit arrives.
+  void set_blocked() { blocked_ = true; }
+
+  // The offset to report as blocked at, if blocked and not reported within interval.
+  std::optional<std::uint64_t> take_blocked_report(TimePoint now, std::chrono::microseconds interval);
+
+  bool active() const { return active_; }
+  bool blocked() const { return blocked_; }
+  std::uint64_t limit() const { return limit_; }
+  std::uint64_t sent() const { return sent_; }
+
+ private:
+  bool active_{false};
+  bool blocked_{false};
+  std::uint64_t limit_{0};
+  std::uint64_t sent_{0};
+  std::optional<TimePoint> last_blocked_report_;
+};
+
+}  // namespace veil::mux
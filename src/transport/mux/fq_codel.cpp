@@ -0,0 +1,210 @@
+#include "transport/mux/fq_codel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace veil::mux {
+
+bool mark_ecn_ce(std::vector<std::uint8_t>& packet) {
+  constexpr std::uint8_t kCe = 0x03;
+  if (packet.size() >= 20 && (packet[0] >> 4) == 4) {
+    if ((packet[1] & kCe) == 0) {
+      return false;
+    }
+    // Incremental checksum update for the first header word (RFC 1624).
+    const auto old_word = static_cast<std::uint16_t>((packet[0] << 8) | packet[1]);
+    packet[1] |= kCe;
+    const auto new_word = static_cast<std::uint16_t>((packet[0] << 8) | packet[1]);
+    std::uint32_t sum = static_cast<std::uint16_t>(~((packet[10] << 8) | packet[11]));
+    sum += static_cast<std::uint16_t>(~old_word);
+    sum += new_word;
+    sum = (sum & 0xFFFFU) + (sum >> 16);
+    sum = (sum & 0xFFFFU) + (sum >> 16);
+    const auto checksum = static_cast<std::uint16_t>(~sum);
+    packet[10] = static_cast<std::uint8_t>(checksum >> 8);
+    packet[11] = static_cast<std::uint8_t>(checksum);
+    return true;
+  }
+  if (packet.size() >= 40 && (packet[0] >> 4) == 6) {
+    // The ECN field is the low two bits of the traffic class, bits 4-5 of byte 1.
+    if ((packet[1] & (kCe << 4)) == 0) {
+      return false;
+    }
+    packet[1] |= kCe << 4;
+    return true;
+  }
+  return false;
+}
+
+FqCodelQueue::FqCodelQueue(FqCodelConfig config) : config_(config) {
+  config_.flows = std::max<std::size_t>(config_.flows, 1);
+  config_.quantum = std::max<std::size_t>(config_.quantum, 1);
+}
+
+void FqCodelQueue::enqueue(std::uint64_t flow, std::vector<std::uint8_t> packet, TimePoint now) {
+  // PERFORMANCE: buckets are allocated on first use; most sessions never back up.
+  if (buckets_.empty()) {
+    buckets_.resize(config_.flows);
+  }
+  const std::size_t index = flow % buckets_.size();
+  auto& bucket = buckets_[index];
+  bucket.bytes += packet.size();
+  bytes_ += packet.size();
+  ++packets_;
+  bucket.entries.push_back(Entry{std::move(packet), now});
+  if (bucket.list == Bucket::List::kNone) {
+    bucket.list = Bucket::List::kNew;
+    bucket.deficit = static_cast<std::int64_t>(config_.quantum);
+    new_flows_.push_back(index);
+  }
+}
+
+std::optional<std::vector<std::uint8_t>> FqCodelQueue::dequeue(TimePoint now) {
+  for (;;) {
+    auto* list = !new_flows_.empty() ? &new_flows_ : &old_flows_;
+    if (list->empty()) {
+      return std::nullopt;
+    }
+    const std::size_t index = list->front();
+    auto& bucket = buckets_[index];
+    if (bucket.deficit <= 0) {
+      // Used up its turn: back of the old flows, with a fresh quantum.
+      bucket.deficit += static_cast<std::int64_t>(config_.quantum);
+      list->pop_front();
+      old_flows_.push_back(index);
+      bucket.list = Bucket::List::kOld;
+      continue;
+    }
+
+    auto packet = codel_dequeue(bucket, now);
+    if (!packet) {
+      // A new flow that emptied goes behind the old ones, so a flow cannot stay new by
+      // sending one packet at a time faster than it is served.
+      list->pop_front();
+      if (list == &new_flows_ && !old_flows_.empty()) {
+        old_flows_.push_back(index);
+        bucket.list = Bucket::List::kOld;
+      } else {
+        bucket.list = Bucket::List::kNone;
+      }
+      continue;
+    }
+    bucket.deficit -= static_cast<std::int64_t>(packet->size());
+    return packet;
+  }
+}
+
+void FqCodelQueue::drop_from_largest_flow() {
+  const auto largest = std::max_element(
+      buckets_.begin(), buckets_.end(),
+      [](const Bucket& a, const Bucket& b) { return a.bytes < b.bytes; });
+  if (largest == buckets_.end() || largest->entries.empty()) {
+    return;
+  }
+  // From the head: the packet that has waited longest, and the sender hears of the
+  // loss soonest.
+  const auto size = largest->entries.front().packet.size();
+  largest->entries.pop_front();
+  largest->bytes -= size;
+  bytes_ -= size;
+  --packets_;
+  ++stats_.overlimit_drops;
+}
+
+std::optional<FqCodelQueue::Entry> FqCodelQueue::pop_head(Bucket& bucket, TimePoint now,
+                                                         bool& ok_to_drop) {
+  ok_to_drop = false;
+  if (bucket.entries.empty()) {
+    bucket.first_above_time = TimePoint{};
+    return std::nullopt;
+  }
+  auto entry = std::move(bucket.entries.front());
+  bucket.entries.pop_front();
+  bucket.bytes -= entry.packet.size();
+  bytes_ -= entry.packet.size();
+  --packets_;
+
+  // Below target, or too little left to form a standing queue: all is well.
+  if (now - entry.enqueued_at < config_.target || bucket.bytes <= config_.quantum) {
+    bucket.first_above_time = TimePoint{};
+  } else if (bucket.first_above_time == TimePoint{}) {
+    bucket.first_above_time = now + config_.interval;
+  } else if (now >= bucket.first_above_time) {
+    ok_to_drop = true;
+  }
+  return entry;
+}
+
+std::optional<std::vector<std::uint8_t>> FqCodelQueue::codel_dequeue(Bucket& bucket,
+                                                                    TimePoint now) {
+  bool ok_to_drop = false;
+  auto entry = pop_head(bucket, now, ok_to_drop);
+  if (!entry) {
+    bucket.dropping = false;
+    return std::nullopt;
+  }
+
+  if (bucket.dropping) {
+    if (!ok_to_drop) {
+      // The wait fell below target: leave the dropping state.
+      bucket.dropping = false;
+    }
+    while (bucket.dropping && now >= bucket.drop_next) {
+      ++bucket.count;
+      if (auto marked = drop_or_mark(std::move(*entry))) {
+        bucket.drop_next = control_law(bucket.drop_next, bucket.count);
+        return marked;
+      }
+      entry = pop_head(bucket, now, ok_to_drop);
+      if (!entry) {
+        bucket.dropping = false;
+        return std::nullopt;
+      }
+      if (!ok_to_drop) {
+        bucket.dropping = false;
+      } else {
+        bucket.drop_next = control_law(bucket.drop_next, bucket.count);
+      }
+    }
+  } else if (ok_to_drop) {
+    // Enter the dropping state. If it was left only recently, resume near the drop
+    // rate reached then rather than from the start.
+    const std::uint32_t delta = bucket.count - bucket.last_count;
+    bucket.count =
+        delta > 1 && now - bucket.drop_next < 16 * config_.interval ? delta : 1;
+    bucket.drop_next = control_law(now, bucket.count);
+    bucket.last_count = bucket.count;
+    bucket.dropping = true;
+    if (auto marked = drop_or_mark(std::move(*entry))) {
+      return marked;
+    }
+    entry = pop_head(bucket, now, ok_to_drop);
+    if (!entry) {
+      return std::nullopt;
+    }
+  }
+  return std::move(entry->packet);
+}
+
+std::optional<std::vector<std::uint8_t>> FqCodelQueue::drop_or_mark(Entry entry) {
+  if (config_.ecn && mark_ecn_ce(entry.packet)) {
+    ++stats_.ecn_marks;
+    return std::move(entry.packet);
+  }
+  ++stats_.codel_drops;
+  return std::nullopt;
+}
+
+FqCodelQueue::TimePoint FqCodelQueue::control_law(TimePoint t, std::uint32_t count) const {
+  // Drops spaced interval / sqrt(count) apart: the rate rises until the queue drains.
+  const auto spacing = std::chrono::duration<double, std::micro>(config_.interval) /
+                       std::sqrt(static_cast<double>(count));
+  return t + std::chrono::duration_cast<Clock::duration>(spacing);
+}
+
+}  // namespace veil::mux
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <optional>
+#include <vector>
+
+namespace veil::mux {
+
+// Configuration for FQ-CoDel queues (RFC 8290). Defaults are the RFC's, except flows.
+struct FqCodelConfig {
+  // CoDel acts once packets have waited longer than target for a full interval.
+  std::chrono::microseconds target{5000};
+  std::chrono::microseconds interval{100000};
+  // Flow buckets: inner flows hash into these, each with its own queue and CoDel state.
+  // One tunnel session carries one client's flows, not a router's (RFC 8290 uses 1024).
+  std::size_t flows{64};
+  // Bytes a flow may send per round.
+  std::size_t quantum{1514};
+  // Mark ECN-capable packets Congestion Experienced instead of dropping them.
+  bool ecn{true};
+};
+
+struct FqCodelStats {
+  // Packets CoDel dropped or marked for having waited too long.
+  std::uint64_t codel_drops{0};
+  std::uint64_t ecn_marks{0};
+  // Packets dropped from the largest flow because the queue was full.
+  std::uint64_t overlimit_drops{0};
+};
+
+// Set the ECN field of an IPv4 or IPv6 packet to Congestion Experienced, updating the
+// IPv4 header checksum. Returns false, leaving the packet alone, if it is not
+// ECN-capable (ECN field 00).
+bool mark_ecn_ce(std::vector<std::uint8_t>& packet);
+
+// Flow queueing with CoDel active queue management (RFC 8290). Packets hash by inner
+// flow into buckets served by deficit round robin, new flows (those that just became
+// active, such as a ping or a DNS lookup) ahead of old ones, so a sparse flow never
+// waits behind a bulk one. Each bucket runs CoDel (RFC 8289) on the time its packets
+// wait: once the head has waited over target for a whole interval, packets are
+// dropped (or ECN-marked) at a rate that grows until the wait falls back below
+// target. A bulk TCP flow through the queue backs off to what the link carries, and
+// the standing queue stays near target instead of the whole buffer.
+class FqCodelQueue {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+
+  explicit FqCodelQueue(FqCodelConfig config = {});
+
+  // Queue a packet of the given flow (any hash of its 5-tuple).
+  void enqueue(std::uint64_t flow, std::vector<std::uint8_t> packet, TimePoint now);
+
+  // The next packet to send, or nullopt once the queue is empty. Packets CoDel drops
+  // on the way are gone.
+  std::optional<std::vector<std::uint8_t>> dequeue(TimePoint now);
+
+  // Drop the oldest packet of the flow with the most bytes queued (a full queue).
+  void drop_from_largest_flow();
+
+  bool empty() const { return packets_ == 0; }
+  std::size_t queued_packets() const { return packets_; }
+  std::size_t queued_bytes() const { return bytes_; }
+  const FqCodelStats& stats() const { return stats_; }
+
+ private:
+  struct Entry {
+    std::vector<std::uint8_t> packet;
+    TimePoint enqueued_at;
+  };
+
+  struct Bucket {
+    std::deque<Entry> entries;
+    std::size_t bytes{0};
+    std::int64_t deficit{0};
+    // Which list the bucket is on.
+    enum class List : std::uint8_t { kNone, kNew, kOld } list{List::kNone};
+    // CoDel state.
+    TimePoint first_above_time{};
+    TimePoint drop_next{};
+    std::uint32_t count{0};
+    std::uint32_t last_count{0};
+    bool dropping{false};
+  };
+
+  // Take the bucket's head packet, and whether CoDel says it may be dropped.
+  std::optional<Entry> pop_head(Bucket& bucket, TimePoint now, bool& ok_to_drop);
+  // CoDel's dequeue for one bucket: the packet to send, after any drops.
+  std::optional<std::vector<std::uint8_t>> codel_dequeue(Bucket& bucket, TimePoint now);
+  // Drop or mark: returns the packet if marked (still to be sent).
+  std::optional<std::vector<std::uint8_t>> drop_or_mark(Entry entry);
+  TimePoint control_law(TimePoint t, std::uint32_t count) const;
+
+  FqCodelConfig config_;
+  std::vector<Bucket> buckets_;
+  std::list<std::size_t> new_flows_;
+  std::list<std::size_t> old_flows_;
+  std::size_t packets_{0};
+  std::size_t bytes_{0};
+  FqCodelStats stats_;
+};
+
+}  // namespace veil::mux
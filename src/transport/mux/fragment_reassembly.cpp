@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <chrono>
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <optional>
 #include <vector>
@@ -19,6 +20,7 @@ bool FragmentReassembly::push(std::uint64_t message_id, Fragment fragment, TimeP
   // Record timestamp of first fragment for this message
   if (entry.fragments.empty()) {
     entry.first_fragment_time = now;
+    entry.stream_id = fragment.stream_id;
   }
 
   if (entry.total_bytes + fragment.data.size() > max_bytes_) {
@@ -64,12 +66,17 @@ std::optional<std::vector<std::uint8_t>> FragmentReassembly::try_reassemble(
   return output;
 }
 
-std::size_t FragmentReassembly::cleanup_expired(TimePoint now) {
+std::size_t FragmentReassembly::cleanup_expired(
+    TimePoint now,
+    const std::function<void(std::uint64_t stream_id, std::size_t bytes)>& on_expired) {
   std::size_t removed = 0;
 
   for (auto it = state_.begin(); it != state_.end();) {
     const auto age = now - it->second.first_fragment_time;
     if (age > fragment_timeout_) {
+      if (on_expired) {
+        on_expired(it->second.stream_id, it->second.total_bytes);
+      }
       it = state_.erase(it);
       ++removed;
     } else {
@@ -2,6 +2,7 @@
 
 #include <chrono>
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <optional>
 #include <vector>
@@ -12,6 +13,8 @@ struct Fragment {
   std::uint16_t offset{0};
   std::vector<std::uint8_t> data;
   bool last{false};
+  // Stream of the message, reported when it expires.
+  std::uint64_t stream_id{0};
 };
 
 class FragmentReassembly {
@@ -29,8 +32,11 @@ class FragmentReassembly {
   std::optional<std::vector<std::uint8_t>> try_reassemble(std::uint64_t message_id);
 
   // Remove fragments that have exceeded the timeout.
-  // Returns number of incomplete messages dropped.
-  std::size_t cleanup_expired(TimePoint now = Clock::now());
+  // Returns number of incomplete messages dropped. on_expired, if set, is called with
+  // the stream and buffered bytes of each.
+  std::size_t cleanup_expired(
+      TimePoint now = Clock::now(),
+      const std::function<void(std::uint64_t stream_id, std::size_t bytes)>& on_expired = {});
 
   // Get number of incomplete messages currently buffered.
   [[nodiscard]] std::size_t pending_count() const { return state_.size(); }
@@ -48,6 +54,7 @@ class FragmentReassembly {
     std::vector<Fragment> fragments;
     std::size_t total_bytes{0};
     bool has_last{false};
+    std::uint64_t stream_id{0};
     TimePoint first_fragment_time{};
   };
 
@@ -2,6 +2,7 @@
 
 #include <chrono>
 #include <cstdint>
+#include <optional>
 #include <span>
 #include <vector>
 
@@ -20,11 +21,123 @@ struct AckFrame {
   std::uint32_t bitmap{0};
 };
 
+// One run of consecutive acknowledged packet sequences, both ends inclusive.
+struct AckRange {
+  std::uint64_t smallest{0};
+  std::uint64_t largest{0};
+};
+
+// ECN codepoints counted by the receiver (RFC 9000 section 13.4).
+struct EcnCounts {
+  std::uint64_t ect0{0};
+  std::uint64_t ect1{0};
+  std::uint64_t ce{0};
+};
+
+inline constexpr std::uint8_t kAckRangesVersion = 1;
+// Most ranges one ACK frame carries; older ranges are dropped first.
+inline constexpr std::size_t kMaxAckRanges = 32;
+
+// Extended ACK frame with QUIC-style ACK ranges (RFC 9000 section 19.3).
+// Unlike AckFrame's 32-bit bitmap, the ranges describe any number of holes across
+// the whole window, so a loss burst on a high-BDP path is repaired in one round trip.
+struct AckRangesFrame {
+  std::uint8_t version{kAckRangesVersion};
+  std::uint64_t stream_id{0};
+  // Time the receiver held the largest acknowledged packet before sending this ACK.
+  // The sender subtracts it from its RTT sample.
+  std::chrono::microseconds ack_delay{0};
+  // Disjoint and descending: ranges.front().largest is the largest acknowledged.
+  std::vector<AckRange> ranges;
+  // Present once the receiver has seen ECN-capable packets.
+  std::optional<EcnCounts> ecn;
+};
+
 struct ControlFrame {
   std::uint8_t type{0};
   std::vector<std::uint8_t> payload;
 };
 
+// Control frame types.
+// Server -> client: a session ticket for 0-RTT resumption (handshake::encode_ticket_message).
+inline constexpr std::uint8_t kControlSessionTicket = 1;
+// Either direction: the sender decodes FEC repair frames (see
+// TransportSession::take_fec_params_frame()). Payload: [version: 1 byte][group size: 1 byte],
+// the protected packets per repair it asks the peer for (re-sent as its loss rate changes).
+inline constexpr std::uint8_t kControlFecParams = 2;
+inline constexpr std::uint8_t kFecParamsVersion = 1;
+// Either direction: flow control credit (see FlowCredit). Payload: [version: 1 byte]
+// [kind: 1 byte][stream_id: 8 bytes][offset: 8 bytes], integers big-endian.
+inline constexpr std::uint8_t kControlFlowCredit = 3;
+inline constexpr std::uint8_t kFlowCreditVersion = 1;
+// Either direction: the sender decodes wire format v2 (see WireFormat). Payload:
+// [version: 1 byte][highest wire format: 1 byte].
+inline constexpr std::uint8_t kControlWireFormat = 4;
+inline constexpr std::uint8_t kWireFormatVersion = 1;
+// Either direction: the sender expands compressed inner headers (see HeaderCompressor).
+// Payload: [version: 1 byte].
+inline constexpr std::uint8_t kControlHeaderCompression = 5;
+inline constexpr std::uint8_t kHeaderCompressionVersion = 1;
+// Either direction: the sender expands compressed payloads (see PayloadCompressor).
+// Payload: [version: 1 byte].
+inline constexpr std::uint8_t kControlPayloadCompression = 6;
+inline constexpr std::uint8_t kPayloadCompressionVersion = 1;
+// Either direction: a path MTU probe (see PathMtuProber), padded to the size it probes.
+// Payload: [version: 1 byte][probe id: 4 bytes, big-endian][padding]. Answered with
+// kControlPathMtuAck, payload [version: 1 byte][probe id: 4 bytes].
+inline constexpr std::uint8_t kControlPathMtuProbe = 7;
+inline constexpr std::uint8_t kControlPathMtuAck = 8;
+inline constexpr std::uint8_t kPathMtuVersion = 1;
+// Either direction: the sender decodes DATAGRAM frames (see
+// TransportSession::take_datagram_mode_frame()). Payload: [version: 1 byte][flags:
+// 1 byte, optional]. kDatagramModeAcks: the sender acknowledges the datagrams it
+// receives on kDatagramStreamId. Older peers send no flags byte and ignore it.
+inline constexpr std::uint8_t kControlDatagramMode = 9;
+inline constexpr std::uint8_t kDatagramModeVersion = 1;
+inline constexpr std::uint8_t kDatagramModeAcks = 0x01;
+// Either direction: the sender decodes packets carrying several frames (see
+// TransportSession::take_frame_packing_frame()). Payload: [version: 1 byte].
+inline constexpr std::uint8_t kControlFramePacking = 10;
+inline constexpr std::uint8_t kFramePackingVersion = 1;
+// Either direction: the sender decodes extended ACK frames (see
+// TransportSession::take_ack_ranges_frame()). Payload: [version: 1 byte].
+inline constexpr std::uint8_t kControlAckRanges = 11;
+inline constexpr std::uint8_t kAckRangesOfferVersion = 1;
+
+// Packet and frame encodings. v1: 8-byte obfuscated packet sequence, fixed-width frame
+// headers. v2, once both peers offer it: the packet sequence truncated relative to the
+// largest acknowledged (2-8 bytes, masked from the AEAD tag), and DATA frames with
+// QUIC-style varint fields (kCompactData). Receivers decode both.
+enum class WireFormat : std::uint8_t {
+  kV1 = 1,
+  kV2 = 2,
+};
+
+// Unreliable datagram frame carrying one tunneled IP packet.
+// Never retransmitted or reordered: the inner protocol (e.g. TCP) provides its own
+// reliability, and a second layer of it only adds delay and duplicates under loss.
+struct DatagramFrame {
+  // Packet sequence the frame arrived with (receive side only, not on the wire).
+  // Used to acknowledge datagrams when loss feedback is enabled.
+  std::uint64_t sequence{0};
+  std::vector<std::uint8_t> payload;
+};
+
+// Forward error correction repair (see FecEncoder): the XOR of the plaintexts of one
+// group of protected packets, each zero-padded to the longest. With it and all but one
+// of them, the receiver rebuilds the missing packet without waiting for a retransmission.
+struct FecRepairFrame {
+  // Protected packet sequences: bit i of mask is first_sequence + i.
+  std::uint64_t first_sequence{0};
+  std::uint64_t mask{0};
+  // XOR of the protected plaintexts' lengths.
+  std::uint16_t length_xor{0};
+  std::vector<std::uint8_t> payload;
+};
+
+// ACKs for datagrams (loss feedback) use this reserved stream id.
+inline constexpr std::uint64_t kDatagramStreamId = ~std::uint64_t{0};
+
 // Heartbeat frame for keep-alive and obfuscation.
 struct HeartbeatFrame {
   std::uint64_t timestamp{0};  // Milliseconds since epoch or relative.
@@ -32,7 +145,17 @@ struct HeartbeatFrame {
   std::vector<std::uint8_t> payload;  // Optional fake telemetry data.
 };
 
-enum class FrameKind : std::uint8_t { kData = 1, kAck = 2, kControl = 3, kHeartbeat = 4 };
+enum class FrameKind : std::uint8_t {
+  kData = 1,
+  kAck = 2,
+  kControl = 3,
+  kHeartbeat = 4,
+  kDatagram = 5,
+  kAckRanges = 6,
+  kFecRepair = 7,
+  // Wire only: a DATA frame in the v2 encoding. Decoded as kData.
+  kCompactData = 8,
+};
 
 struct MuxFrame {
   FrameKind kind{};
@@ -40,6 +163,9 @@ struct MuxFrame {
   AckFrame ack;
   ControlFrame control;
   HeartbeatFrame heartbeat;
+  DatagramFrame datagram;
+  AckRangesFrame ack_ranges;
+  FecRepairFrame fec_repair;
 };
 
 // PERFORMANCE (Issue #97): Zero-copy frame structures using span views.
@@ -58,6 +184,11 @@ struct ControlFrameView {
   std::span<const std::uint8_t> payload;  // View into source buffer (no copy)
 };
 
+struct DatagramFrameView {
+  std::uint64_t sequence{0};
+  std::span<const std::uint8_t> payload;  // View into source buffer (no copy)
+};
+
 struct HeartbeatFrameView {
   std::uint64_t timestamp{0};
   std::uint64_t sequence{0};
@@ -72,6 +203,9 @@ struct MuxFrameView {
   AckFrame ack;  // ACK frames have no payload, so no view needed
   ControlFrameView control;
   HeartbeatFrameView heartbeat;
+  DatagramFrameView datagram;
+  AckRangesFrame ack_ranges;  // Decoded in place; ranges are small
+  FecRepairFrame fec_repair;  // Copied; repairs never take the zero-copy path
 };
 
 }  // namespace veil::mux
@@ -0,0 +1,66 @@
+#include "transport/mux/frame_packer.h"
+
+#include <utility>
+
+#include "transport/mux/mux_codec.h"
+
+namespace veil::mux {
+
+FramePacker::FramePacker(FramePackerConfig config, std::function<TimePoint()> now_fn)
+    : config_(config), now_fn_(std::move(now_fn)) {}
+
+std::vector<MuxFrame> FramePacker::add(MuxFrame frame) {
+  const auto size = MuxCodec::encoded_size(frame);
+  ++stats_.frames_queued;
+
+  if (size > config_.max_batch_size) {
+    // Too large to share a packet; the caller sends it alone. Anything queued
+    // stays queued and keeps its place in time.
+    ++stats_.batches_flushed;
+    std::vector<MuxFrame> single;
+    single.push_back(std::move(frame));
+    return single;
+  }
+
+  std::vector<MuxFrame> full;
+  if (pending_bytes_ + size > config_.max_batch_size) {
+    full = flush();
+    ++stats_.batches_full;
+  }
+
+  if (pending_.empty()) {
+    first_queued_ = now_fn_();
+  }
+  pending_bytes_ += size;
+  pending_.push_back(std::move(frame));
+  return full;
+}
+
+std::vector<MuxFrame> FramePacker::flush() {
+  std::vector<MuxFrame> batch;
+  if (pending_.empty()) {
+    return batch;
+  }
+  batch.swap(pending_);
+  pending_bytes_ = 0;
+  ++stats_.batches_flushed;
+  return batch;
+}
+
+bool FramePacker::flush_due() const {
+  return !pending_.empty() && now_fn_() - first_queued_ >= config_.max_delay;
+}
+
+std::optional<std::chrono::microseconds> FramePacker::time_until_flush() const {
+  if (pending_.empty()) {
+    return std::nullopt;
+  }
+  const auto waited =
+      std::chrono::duration_cast<std::chrono::microseconds>(now_fn_() - first_queued_);
+  if (waited >= config_.max_delay) {
+    return std::chrono::microseconds(0);
+  }
+  return config_.max_delay - waited;
+}
+
+}  // namespace veil::mux
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "transport/mux/frame.h"
+
+namespace veil::mux {
+
+// Configuration for frame packing.
+struct FramePackerConfig {
+  // Maximum encoded size of one batch (the plaintext of one encrypted packet).
+  std::size_t max_batch_size{1376};
+  // Longest a queued frame may wait for more frames before the batch is due.
+  std::chrono::microseconds max_delay{1000};
+};
+
+// Statistics for frame packing.
+struct FramePackerStats {
+  std::uint64_t frames_queued{0};
+  std::uint64_t batches_flushed{0};
+  // Batches flushed because the next frame did not fit behind them.
+  std::uint64_t batches_full{0};
+};
+
+// Coalesces outgoing mux frames into batches that fit one encrypted packet.
+// Several small frames (IP packets as DATAGRAM frames, ACKs, control frames) then
+// share a single sequence number, AEAD tag and UDP/IP header. MuxCodec::decode_all()
+// splits a batch back into frames on the receive side.
+//
+// The packer only decides batch boundaries; TransportSession encrypts the batches.
+class FramePacker {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+
+  explicit FramePacker(FramePackerConfig config = {},
+                       std::function<TimePoint()> now_fn = Clock::now);
+
+  // Queue a frame. If it does not fit behind the frames already queued, those are
+  // returned as a complete batch and the new frame starts the next one. A frame
+  // larger than max_batch_size is returned on its own. Otherwise returns empty.
+  std::vector<MuxFrame> add(MuxFrame frame);
+
+  // Take all queued frames as one batch (empty if nothing is queued).
+  std::vector<MuxFrame> flush();
+
+  // Whether the oldest queued frame has waited max_delay.
+  bool flush_due() const;
+
+  // Time until the queued batch is due, or nullopt if nothing is queued.
+  std::optional<std::chrono::microseconds> time_until_flush() const;
+
+  // Change max_batch_size (path MTU discovery); applies from the next frame queued.
+  void set_max_batch_size(std::size_t size) { config_.max_batch_size = size; }
+
+  bool empty() const { return pending_.empty(); }
+  std::size_t pending_frames() const { return pending_.size(); }
+  std::size_t pending_bytes() const { return pending_bytes_; }
+
+  const FramePackerStats& stats() const { return stats_; }
+
+ private:
+  FramePackerConfig config_;
+  std::function<TimePoint()> now_fn_;
+  std::vector<MuxFrame> pending_;
+  std::size_t pending_bytes_{0};
+  TimePoint first_queued_{};
+  FramePackerStats stats_;
+};
+
+}  // namespace veil::mux
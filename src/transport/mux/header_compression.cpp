@@ -0,0 +1,547 @@
+#include "transport/mux/header_compression.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace veil::mux {
+
+namespace {
+
+constexpr std::size_t kIpv4HeaderSize = 20;
+constexpr std::size_t kTcpHeaderSize = 20;
+constexpr std::size_t kUdpHeaderSize = 8;
+constexpr std::size_t kMaxIpPacketSize = 65535;
+constexpr std::uint8_t kProtocolTcp = 6;
+constexpr std::uint8_t kProtocolUdp = 17;
+constexpr std::uint16_t kDontFragment = 0x4000;
+
+// Connection setup and teardown and urgent data are rare enough to go uncompressed.
+constexpr std::uint8_t kUncompressedTcpFlags = 0x01 | 0x02 | 0x04 | 0x20;  // FIN SYN RST URG
+
+// Low nibble of kCompressedTcp.
+constexpr std::uint8_t kFullSequence = 0x01;
+constexpr std::uint8_t kFullAck = 0x02;
+constexpr std::uint8_t kFullIpId = 0x04;
+constexpr std::uint8_t kWindowPresent = 0x08;
+// Low nibble of kCompressedUdp: ECN in bits 1-2, and this.
+constexpr std::uint8_t kUdpFullIpId = 0x01;
+
+// Least significant bits sent for the fields that are encoded against a reference.
+constexpr unsigned kSequenceBits = 16;
+constexpr unsigned kIpIdBits = 8;
+
+// Packets of a new flow sent with their full header, in case the first is lost.
+constexpr std::uint64_t kInitialRefreshes = 2;
+
+constexpr std::size_t kMaxContexts = 256;
+
+// CRC-8 of RFC 5795 (polynomial x^8 + x^2 + x + 1), over the header a packet rebuilds to.
+constexpr std::array<std::uint8_t, 256> kCrc8Table = [] {
+  std::array<std::uint8_t, 256> table{};
+  for (unsigned i = 0; i < 256; ++i) {
+    unsigned crc = i;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc & 0x80) != 0 ? ((crc << 1) ^ 0x07) : (crc << 1);
+    }
+    table[i] = static_cast<std::uint8_t>(crc);
+  }
+  return table;
+}();
+
+// The fields of an IPv4 TCP or UDP packet this compresses.
+struct ParsedPacket {
+  std::uint8_t protocol{0};
+  std::uint32_t source{0};
+  std::uint32_t destination{0};
+  std::uint16_t source_port{0};
+  std::uint16_t destination_port{0};
+  std::uint8_t dscp{0};
+  std::uint8_t ecn{0};
+  std::uint8_t ttl{0};
+  bool dont_fragment{false};
+  std::uint16_t ip_id{0};
+  std::uint32_t sequence{0};
+  std::uint32_t ack{0};
+  std::uint16_t window{0};
+  std::uint8_t tcp_flags{0};
+  std::uint8_t data_offset{0};
+  std::uint16_t checksum{0};
+  std::span<const std::uint8_t> options;
+  std::span<const std::uint8_t> payload;
+};
+
+std::uint16_t read_u16(const std::uint8_t* in) {
+  return static_cast<std::uint16_t>((in[0] << 8) | in[1]);
+}
+
+std::uint32_t read_u32(const std::uint8_t* in) {
+  return (static_cast<std::uint32_t>(in[0]) << 24) | (static_cast<std::uint32_t>(in[1]) << 16) |
+         (static_cast<std::uint32_t>(in[2]) << 8) | in[3];
+}
+
+void write_u16(std::uint8_t* out, std::uint16_t value) {
+  out[0] = static_cast<std::uint8_t>(value >> 8);
+  out[1] = static_cast<std::uint8_t>(value);
+}
+
+void write_u32(std::uint8_t* out, std::uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    out[i] = static_cast<std::uint8_t>(value >> (24 - 8 * i));
+  }
+}
+
+void put_u16(std::vector<std::uint8_t>& out, std::uint16_t value) {
+  out.push_back(static_cast<std::uint8_t>(value >> 8));
+  out.push_back(static_cast<std::uint8_t>(value));
+}
+
+void put_u32(std::vector<std::uint8_t>& out, std::uint32_t value) {
+  put_u16(out, static_cast<std::uint16_t>(value >> 16));
+  put_u16(out, static_cast<std::uint16_t>(value));
+}
+
+std::optional<ParsedPacket> parse_packet(std::span<const std::uint8_t> packet) {
+  // IPv4 without options, unfragmented, and exactly the packet.
+  if (packet.size() < kIpv4HeaderSize || packet[0] != 0x45 ||
+      read_u16(&packet[2]) != packet.size() || (read_u16(&packet[6]) & ~kDontFragment) != 0) {
+    return std::nullopt;
+  }
+  ParsedPacket parsed;
+  parsed.dscp = packet[1] & 0xFC;
+  parsed.ecn = packet[1] & 0x03;
+  parsed.ip_id = read_u16(&packet[4]);
+  parsed.dont_fragment = (read_u16(&packet[6]) & kDontFragment) != 0;
+  parsed.ttl = packet[8];
+  parsed.protocol = packet[9];
+  parsed.source = read_u32(&packet[12]);
+  parsed.destination = read_u32(&packet[16]);
+
+  const auto segment = packet.subspan(kIpv4HeaderSize);
+  if (parsed.protocol == kProtocolTcp) {
+    if (segment.size() < kTcpHeaderSize) {
+      return std::nullopt;
+    }
+    parsed.data_offset = segment[12] >> 4;
+    const std::size_t header_size = std::size_t{parsed.data_offset} * 4;
+    parsed.tcp_flags = segment[13];
+    // Reserved bits, urgent data and connection setup or teardown: send as is.
+    if ((segment[12] & 0x0F) != 0 || header_size < kTcpHeaderSize || header_size > segment.size() ||
+        (parsed.tcp_flags & kUncompressedTcpFlags) != 0 || read_u16(&segment[18]) != 0) {
+      return std::nullopt;
+    }
+    parsed.source_port = read_u16(&segment[0]);
+    parsed.destination_port = read_u16(&segment[2]);
+    parsed.sequence = read_u32(&segment[4]);
+    parsed.ack = read_u32(&segment[8]);
+    parsed.window = read_u16(&segment[14]);
+    parsed.checksum = read_u16(&segment[16]);
+    parsed.options = segment.subspan(kTcpHeaderSize, header_size - kTcpHeaderSize);
+    parsed.payload = segment.subspan(header_size);
+    return parsed;
+  }
+  if (parsed.protocol == kProtocolUdp) {
+    // Without a checksum, nothing would catch a header rebuilt from a damaged context.
+    if (segment.size() < kUdpHeaderSize || read_u16(&segment[4]) != segment.size() ||
+        read_u16(&segment[6]) == 0) {
+      return std::nullopt;
+    }
+    parsed.source_port = read_u16(&segment[0]);
+    parsed.destination_port = read_u16(&segment[2]);
+    parsed.checksum = read_u16(&segment[6]);
+    parsed.payload = segment.subspan(kUdpHeaderSize);
+    return parsed;
+  }
+  return std::nullopt;
+}
+
+// Whether the low `bits` bits of value decode to it against reference: value lies in
+// [reference - 2^(bits-1), reference + 2^(bits-1)), modulo 2^width.
+bool lsb_decodable(std::uint32_t value, std::uint32_t reference, unsigned bits, unsigned width) {
+  const std::uint64_t mask = (std::uint64_t{1} << width) - 1;
+  const std::uint64_t half = std::uint64_t{1} << (bits - 1);
+  return ((std::uint64_t{value} - reference + half) & mask) < 2 * half;
+}
+
+// The value in that interval around reference whose low `bits` bits are lsb.
+std::uint32_t decode_lsb(std::uint32_t reference, std::uint32_t lsb, unsigned bits, unsigned width) {
+  const std::uint64_t mask = (std::uint64_t{1} << width) - 1;
+  const std::uint64_t low = (std::uint64_t{reference} - (std::uint64_t{1} << (bits - 1))) & mask;
+  const std::uint64_t offset = (std::uint64_t{lsb} - low) & ((std::uint64_t{1} << bits) - 1);
+  return static_cast<std::uint32_t>((low + offset) & mask);
+}
+
+std::uint64_t ones_complement_add(std::span<const std::uint8_t> data, std::uint64_t sum) {
+  std::size_t i = 0;
+  for (; i + 1 < data.size(); i += 2) {
+    sum += read_u16(&data[i]);
+  }
+  if (i < data.size()) {
+    sum += std::uint64_t{data[i]} << 8;
+  }
+  return sum;
+}
+
+std::uint16_t fold(std::uint64_t sum) {
+  while ((sum >> 16) != 0) {
+    sum = (sum & 0xFFFF) + (sum >> 16);
+  }
+  return static_cast<std::uint16_t>(sum);
+}
+
+// CRC of the IPv4 header (but its checksum, which is recomputed) and the transport
+// header. The transport checksum alone misses an IP ID decoded wrong (not covered), and
+// a high sequence word decoded as 0xFFFF for 0 (equal in one's complement).
+std::uint8_t header_crc(std::span<const std::uint8_t> packet) {
+  const std::size_t header_size =
+      kIpv4HeaderSize + (packet[9] == kProtocolTcp ? kTcpHeaderSize : kUdpHeaderSize);
+  std::uint8_t crc = 0xFF;
+  for (std::size_t i = 0; i < header_size; ++i) {
+    if (i != 10 && i != 11) {
+      crc = kCrc8Table[crc ^ packet[i]];
+    }
+  }
+  return crc;
+}
+
+// Whether the TCP or UDP checksum of a rebuilt IPv4 packet holds.
+bool transport_checksum_valid(std::span<const std::uint8_t> packet) {
+  const auto segment = packet.subspan(kIpv4HeaderSize);
+  std::uint64_t sum = ones_complement_add(packet.subspan(12, 8), 0);
+  sum += packet[9];
+  sum += segment.size();
+  return fold(ones_complement_add(segment, sum)) == 0xFFFF;
+}
+
+// Write an IPv4 header for a packet of total_size bytes into out.
+void write_ipv4_header(std::uint8_t* out, std::size_t total_size, std::uint8_t tos,
+                       std::uint16_t ip_id, bool dont_fragment, std::uint8_t ttl,
+                       std::uint8_t protocol, std::uint32_t source, std::uint32_t destination) {
+  out[0] = 0x45;
+  out[1] = tos;
+  write_u16(out + 2, static_cast<std::uint16_t>(total_size));
+  write_u16(out + 4, ip_id);
+  write_u16(out + 6, dont_fragment ? kDontFragment : 0);
+  out[8] = ttl;
+  out[9] = protocol;
+  write_u16(out + 10, 0);
+  write_u32(out + 12, source);
+  write_u32(out + 16, destination);
+  const auto sum = ones_complement_add(std::span<const std::uint8_t>(out, kIpv4HeaderSize), 0);
+  write_u16(out + 10, static_cast<std::uint16_t>(~fold(sum)));
+}
+
+}  // namespace
+
+std::size_t HeaderCompressor::FlowKeyHash::operator()(const FlowKey& key) const {
+  std::uint64_t hash = (std::uint64_t{key.source} << 32) | key.destination;
+  hash ^= ((std::uint64_t{key.source_port} << 24) | (std::uint64_t{key.destination_port} << 8) |
+           key.protocol) * 0x9E3779B97F4A7C15ULL;
+  return static_cast<std::size_t>(hash ^ (hash >> 29));
+}
+
+HeaderCompressor::HeaderCompressor(HeaderCompressionConfig config) : config_(config) {
+  config_.max_contexts = std::clamp<std::size_t>(config_.max_contexts, 1, kMaxContexts);
+  config_.refresh_interval = std::max<std::uint32_t>(config_.refresh_interval, 1);
+  contexts_.reserve(config_.max_contexts);
+}
+
+std::uint8_t HeaderCompressor::context_for(const FlowKey& key, bool& fresh) {
+  if (auto it = flows_.find(key); it != flows_.end()) {
+    fresh = false;
+    contexts_[it->second].last_used = ++clock_;
+    return it->second;
+  }
+  fresh = true;
+  std::size_t id = contexts_.size();
+  if (contexts_.size() < config_.max_contexts) {
+    contexts_.emplace_back();
+  } else {
+    id = static_cast<std::size_t>(
+        std::min_element(contexts_.begin(), contexts_.end(),
+                         [](const Context& a, const Context& b) { return a.last_used < b.last_used; }) -
+        contexts_.begin());
+    flows_.erase(contexts_[id].key);
+  }
+  contexts_[id] = Context{};
+  contexts_[id].key = key;
+  contexts_[id].last_used = ++clock_;
+  const auto cid = static_cast<std::uint8_t>(id);
+  flows_.emplace(key, cid);
+  return cid;
+}
+
+bool HeaderCompressor::compress(std::span<const std::uint8_t> packet, std::vector<std::uint8_t>& out) {
+  const auto parsed = parse_packet(packet);
+  if (!parsed) {
+    return false;
+  }
+  bool fresh = false;
+  const auto cid = context_for(FlowKey{parsed->source, parsed->destination, parsed->source_port,
+                                       parsed->destination_port, parsed->protocol},
+                               fresh);
+  auto& context = contexts_[cid];
+  const bool static_changed = context.dscp != parsed->dscp || context.ttl != parsed->ttl ||
+                              context.dont_fragment != parsed->dont_fragment;
+
+  out.clear();
+  if (fresh || static_changed || context.packets < kInitialRefreshes ||
+      context.since_refresh >= config_.refresh_interval) {
+    context.dscp = parsed->dscp;
+    context.ttl = parsed->ttl;
+    context.dont_fragment = parsed->dont_fragment;
+    context.since_refresh = 0;
+    out.reserve(2 + packet.size());
+    out.push_back(kHeaderRefresh);
+    out.push_back(cid);
+    out.insert(out.end(), packet.begin(), packet.end());
+    ++stats_.refreshes;
+  } else {
+    const auto references = std::span(context.references).first(context.reference_count);
+    auto all_references = [&references](auto predicate) {
+      return std::all_of(references.begin(), references.end(), predicate);
+    };
+    const bool short_ip_id = all_references([&](const Reference& r) {
+      return lsb_decodable(parsed->ip_id, r.ip_id, kIpIdBits, 16);
+    });
+    out.reserve(packet.size());
+
+    if (parsed->protocol == kProtocolTcp) {
+      const bool short_sequence = all_references([&](const Reference& r) {
+        return lsb_decodable(parsed->sequence, r.sequence, kSequenceBits, 32);
+      });
+      const bool short_ack = all_references([&](const Reference& r) {
+        return lsb_decodable(parsed->ack, r.ack, kSequenceBits, 32);
+      });
+      const bool same_window =
+          all_references([&](const Reference& r) { return r.window == parsed->window; });
+      std::uint8_t flags = 0;
+      flags |= short_sequence ? 0 : kFullSequence;
+      flags |= short_ack ? 0 : kFullAck;
+      flags |= short_ip_id ? 0 : kFullIpId;
+      flags |= same_window ? 0 : kWindowPresent;
+
+      out.push_back(kCompressedTcp | flags);
+      out.push_back(cid);
+      out.push_back(header_crc(packet));
+      out.push_back(parsed->tcp_flags);
+      out.push_back(static_cast<std::uint8_t>((parsed->data_offset << 4) | (parsed->ecn << 2)));
+      if (short_ip_id) {
+        out.push_back(static_cast<std::uint8_t>(parsed->ip_id));
+      } else {
+        put_u16(out, parsed->ip_id);
+      }
+      if (short_sequence) {
+        put_u16(out, static_cast<std::uint16_t>(parsed->sequence));
+      } else {
+        put_u32(out, parsed->sequence);
+      }
+      if (short_ack) {
+        put_u16(out, static_cast<std::uint16_t>(parsed->ack));
+      } else {
+        put_u32(out, parsed->ack);
+      }
+      if (!same_window) {
+        put_u16(out, parsed->window);
+      }
+      put_u16(out, parsed->checksum);
+      out.insert(out.end(), parsed->options.begin(), parsed->options.end());
+    } else {
+      out.push_back(static_cast<std::uint8_t>(kCompressedUdp | (parsed->ecn << 1) |
+                                              (short_ip_id ? 0 : kUdpFullIpId)));
+      out.push_back(cid);
+      out.push_back(header_crc(packet));
+      if (short_ip_id) {
+        out.push_back(static_cast<std::uint8_t>(parsed->ip_id));
+      } else {
+        put_u16(out, parsed->ip_id);
+      }
+      put_u16(out, parsed->checksum);
+    }
+    out.insert(out.end(), parsed->payload.begin(), parsed->payload.end());
+    ++stats_.packets_compressed;
+    stats_.bytes_saved += packet.size() - out.size();
+  }
+
+  context.references[context.packets % kReferenceWindow] =
+      Reference{parsed->sequence, parsed->ack, parsed->ip_id, parsed->window};
+  context.reference_count = std::min(context.reference_count + 1, kReferenceWindow);
+  ++context.packets;
+  ++context.since_refresh;
+  return true;
+}
+
+bool HeaderDecompressor::decompress(std::vector<std::uint8_t>& packet) {
+  if (packet.empty()) {
+    return true;
+  }
+  switch (packet[0] & 0xF0) {
+    case kHeaderRefresh:
+      return on_refresh(packet);
+    case kCompressedTcp:
+      return expand_tcp(packet);
+    case kCompressedUdp:
+      return expand_udp(packet);
+    default:
+      return true;
+  }
+}
+
+bool HeaderDecompressor::on_refresh(std::vector<std::uint8_t>& packet) {
+  const auto parsed = packet.size() >= 2 && packet[0] == kHeaderRefresh
+                          ? parse_packet(std::span<const std::uint8_t>(packet).subspan(2))
+                          : std::nullopt;
+  if (!parsed) {
+    ++stats_.context_errors;
+    return false;
+  }
+  const std::uint8_t cid = packet[1];
+  if (cid >= contexts_.size()) {
+    contexts_.resize(std::size_t{cid} + 1);
+  }
+  contexts_[cid] = Context{true,
+                           parsed->protocol,
+                           parsed->source,
+                           parsed->destination,
+                           parsed->source_port,
+                           parsed->destination_port,
+                           parsed->dscp,
+                           parsed->ttl,
+                           parsed->dont_fragment,
+                           parsed->sequence,
+                           parsed->ack,
+                           parsed->ip_id,
+                           parsed->window};
+  packet.erase(packet.begin(), packet.begin() + 2);
+  ++stats_.refreshes;
+  return true;
+}
+
+bool HeaderDecompressor::expand_tcp(std::vector<std::uint8_t>& packet) {
+  const std::uint8_t flags = packet[0] & 0x0F;
+  std::size_t needed = 5U + ((flags & kFullIpId) != 0 ? 2U : 1U) +
+                       ((flags & kFullSequence) != 0 ? 4U : 2U) +
+                       ((flags & kFullAck) != 0 ? 4U : 2U) + ((flags & kWindowPresent) != 0 ? 2U : 0U) + 2U;
+  if (packet.size() < needed || packet[1] >= contexts_.size() || !contexts_[packet[1]].valid ||
+      contexts_[packet[1]].protocol != kProtocolTcp || (packet[4] >> 4) < 5) {
+    ++stats_.context_errors;
+    return false;
+  }
+  auto& context = contexts_[packet[1]];
+  const std::uint8_t crc = packet[2];
+  const std::uint8_t tcp_flags = packet[3];
+  const std::uint8_t data_offset = packet[4] >> 4;
+  const std::uint8_t ecn = (packet[4] >> 2) & 0x03;
+  const std::size_t options_size = (std::size_t{data_offset} - 5) * 4;
+
+  std::size_t pos = 5;
+  std::uint16_t ip_id = 0;
+  if ((flags & kFullIpId) != 0) {
+    ip_id = read_u16(&packet[pos]);
+    pos += 2;
+  } else {
+    ip_id = static_cast<std::uint16_t>(decode_lsb(context.ip_id, packet[pos], kIpIdBits, 16));
+    pos += 1;
+  }
+  auto read_sequence = [&](std::uint32_t reference, std::uint8_t full_flag) {
+    if ((flags & full_flag) != 0) {
+      pos += 4;
+      return read_u32(&packet[pos - 4]);
+    }
+    pos += 2;
+    return decode_lsb(reference, read_u16(&packet[pos - 2]), kSequenceBits, 32);
+  };
+  const std::uint32_t sequence = read_sequence(context.sequence, kFullSequence);
+  const std::uint32_t ack = read_sequence(context.ack, kFullAck);
+  std::uint16_t window = context.window;
+  if ((flags & kWindowPresent) != 0) {
+    window = read_u16(&packet[pos]);
+    pos += 2;
+  }
+  const std::uint16_t checksum = read_u16(&packet[pos]);
+  pos += 2;
+  needed = pos + options_size;
+  const std::size_t total_size = kIpv4HeaderSize + kTcpHeaderSize + packet.size() - pos;
+  if (packet.size() < needed || total_size > kMaxIpPacketSize) {
+    ++stats_.context_errors;
+    return false;
+  }
+
+  scratch_.resize(total_size);
+  auto* out = scratch_.data();
+  write_ipv4_header(out, total_size, static_cast<std::uint8_t>(context.dscp | ecn), ip_id,
+                    context.dont_fragment, context.ttl, kProtocolTcp, context.source,
+                    context.destination);
+  auto* tcp = out + kIpv4HeaderSize;
+  write_u16(tcp, context.source_port);
+  write_u16(tcp + 2, context.destination_port);
+  write_u32(tcp + 4, sequence);
+  write_u32(tcp + 8, ack);
+  tcp[12] = static_cast<std::uint8_t>(data_offset << 4);
+  tcp[13] = tcp_flags;
+  write_u16(tcp + 14, window);
+  write_u16(tcp + 16, checksum);
+  write_u16(tcp + 18, 0);
+  std::copy(packet.begin() + static_cast<std::ptrdiff_t>(pos), packet.end(), tcp + kTcpHeaderSize);
+
+  if (header_crc(scratch_) != crc || !transport_checksum_valid(scratch_)) {
+    ++stats_.context_errors;
+    return false;
+  }
+  context.sequence = sequence;
+  context.ack = ack;
+  context.ip_id = ip_id;
+  context.window = window;
+  packet.swap(scratch_);
+  ++stats_.packets_decompressed;
+  return true;
+}
+
+bool HeaderDecompressor::expand_udp(std::vector<std::uint8_t>& packet) {
+  const bool full_ip_id = (packet[0] & kUdpFullIpId) != 0;
+  const std::size_t header_size = 3 + (full_ip_id ? 2 : 1) + 2;
+  if (packet.size() < header_size || packet[1] >= contexts_.size() || !contexts_[packet[1]].valid ||
+      contexts_[packet[1]].protocol != kProtocolUdp) {
+    ++stats_.context_errors;
+    return false;
+  }
+  auto& context = contexts_[packet[1]];
+  const std::uint8_t crc = packet[2];
+  const std::uint8_t ecn = (packet[0] >> 1) & 0x03;
+  const std::uint16_t ip_id =
+      full_ip_id ? read_u16(&packet[3])
+                 : static_cast<std::uint16_t>(decode_lsb(context.ip_id, packet[3], kIpIdBits, 16));
+  const std::uint16_t checksum = read_u16(&packet[header_size - 2]);
+  const std::size_t total_size = kIpv4HeaderSize + kUdpHeaderSize + packet.size() - header_size;
+  if (total_size > kMaxIpPacketSize) {
+    ++stats_.context_errors;
+    return false;
+  }
+
+  scratch_.resize(total_size);
+  auto* out = scratch_.data();
+  write_ipv4_header(out, total_size, static_cast<std::uint8_t>(context.dscp | ecn), ip_id,
+                    context.dont_fragment, context.ttl, kProtocolUdp, context.source,
+                    context.destination);
+  auto* udp = out + kIpv4HeaderSize;
+  write_u16(udp, context.source_port);
+  write_u16(udp + 2, context.destination_port);
+  write_u16(udp + 4, static_cast<std::uint16_t>(total_size - kIpv4HeaderSize));
+  write_u16(udp + 6, checksum);
+  std::copy(packet.begin() + static_cast<std::ptrdiff_t>(header_size), packet.end(),
+            udp + kUdpHeaderSize);
+
+  if (header_crc(scratch_) != crc || !transport_checksum_valid(scratch_)) {
+    ++stats_.context_errors;
+    return false;
+  }
+  context.ip_id = ip_id;
+  packet.swap(scratch_);
+  ++stats_.packets_decompressed;
+  return true;
+}
+
+}  // namespace veil::mux
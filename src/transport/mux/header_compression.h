@@ -0,0 +1,159 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace veil::mux {
+
+// Configuration for inner IP/TCP/UDP header compression.
+struct HeaderCompressionConfig {
+  // Flows compressed at once (at most 256, the context id is one byte). A new flow
+  // takes over the least recently used context.
+  std::size_t max_contexts{64};
+  // A flow's full header is sent again every this many packets, so a receiver that
+  // lost its context (or the refresh that set it up) resynchronizes.
+  std::uint32_t refresh_interval{64};
+};
+
+// Statistics for the sending side.
+struct HeaderCompressorStats {
+  std::uint64_t packets_compressed{0};
+  // Packets sent with their full header to set up or refresh a context.
+  std::uint64_t refreshes{0};
+  // Header bytes saved by compressed packets (a refresh adds two).
+  std::uint64_t bytes_saved{0};
+};
+
+// Statistics for the receiving side.
+struct HeaderDecompressorStats {
+  std::uint64_t packets_decompressed{0};
+  std::uint64_t refreshes{0};
+  // Compressed packets dropped: no context for them, or the rebuilt header failed the
+  // CRC or transport checksum (context damaged by loss, until the next refresh).
+  std::uint64_t context_errors{0};
+};
+
+// Packet types of a compressed stream. The high nibble never reads as IP version 4 or
+// 6, so uncompressed packets pass through unchanged.
+inline constexpr std::uint8_t kHeaderRefresh = 0x10;
+inline constexpr std::uint8_t kCompressedTcp = 0x20;
+inline constexpr std::uint8_t kCompressedUdp = 0x30;
+
+// Per-flow header compression for tunneled IPv4 TCP and UDP packets, in the spirit of
+// ROHC's unidirectional mode (RFC 5795): both ends keep a context per flow with its
+// static fields (addresses, ports, TTL, DSCP), and compressed packets carry only what
+// changes.
+//
+// Robustness without feedback: sequence number, ACK and IP ID are sent as their low
+// bits (full only when needed), chosen so the value decodes against any of the last
+// kReferenceWindow packets sent (window-based LSB encoding). A receiver that lost up to
+// that many packets in a row still decodes the next one. The TCP or UDP checksum travels
+// unchanged, and a CRC-8 of the original header is added; the rebuilt header must match
+// both, so a damaged context drops packets instead of corrupting them, until the next
+// refresh.
+//
+// Compressed TCP (IPv4 header without options, no SYN/FIN/RST/URG):
+//   [0x20 | flags][cid][crc][tcp flags][data offset: 4 bits, ECN: 2 bits, 0: 2 bits]
+//   [IP ID: 1 or 2][sequence: 2 or 4][ack: 2 or 4][window: 0 or 2][checksum: 2]
+//   [TCP options][payload]
+// Compressed UDP (non-zero checksum):
+//   [0x30 | ECN << 1 | full IP ID][cid][crc][IP ID: 1 or 2][checksum: 2][payload]
+// Refresh: [0x10][cid][the packet, unchanged]
+class HeaderCompressor {
+ public:
+  static constexpr std::size_t kReferenceWindow = 16;
+
+  explicit HeaderCompressor(HeaderCompressionConfig config = {});
+
+  // Compress an IP packet into out. Returns false, leaving out untouched, if the packet
+  // is not one this compresses (it is then sent as is).
+  bool compress(std::span<const std::uint8_t> packet, std::vector<std::uint8_t>& out);
+
+  const HeaderCompressorStats& stats() const { return stats_; }
+
+ private:
+  struct FlowKey {
+    std::uint32_t source{0};
+    std::uint32_t destination{0};
+    std::uint16_t source_port{0};
+    std::uint16_t destination_port{0};
+    std::uint8_t protocol{0};
+
+    bool operator==(const FlowKey&) const = default;
+  };
+
+  struct FlowKeyHash {
+    std::size_t operator()(const FlowKey& key) const;
+  };
+
+  // Dynamic fields of one packet sent.
+  struct Reference {
+    std::uint32_t sequence{0};
+    std::uint32_t ack{0};
+    std::uint16_t ip_id{0};
+    std::uint16_t window{0};
+  };
+
+  struct Context {
+    FlowKey key;
+    std::uint8_t dscp{0};
+    std::uint8_t ttl{0};
+    bool dont_fragment{false};
+    std::uint64_t packets{0};
+    std::uint32_t since_refresh{0};
+    std::uint64_t last_used{0};
+    std::array<Reference, kReferenceWindow> references{};
+    std::size_t reference_count{0};
+  };
+
+  // The context for a flow, taking over the least recently used one for a new flow.
+  std::uint8_t context_for(const FlowKey& key, bool& fresh);
+
+  HeaderCompressionConfig config_;
+  std::vector<Context> contexts_;
+  std::unordered_map<FlowKey, std::uint8_t, FlowKeyHash> flows_;
+  std::uint64_t clock_{0};
+  HeaderCompressorStats stats_;
+};
+
+// Receiving side of HeaderCompressor.
+class HeaderDecompressor {
+ public:
+  // Expand a received packet in place. Uncompressed packets are left as they are.
+  // Returns false if the packet must be dropped (see HeaderDecompressorStats).
+  bool decompress(std::vector<std::uint8_t>& packet);
+
+  const HeaderDecompressorStats& stats() const { return stats_; }
+
+ private:
+  struct Context {
+    bool valid{false};
+    std::uint8_t protocol{0};
+    std::uint32_t source{0};
+    std::uint32_t destination{0};
+    std::uint16_t source_port{0};
+    std::uint16_t destination_port{0};
+    std::uint8_t dscp{0};
+    std::uint8_t ttl{0};
+    bool dont_fragment{false};
+    // Dynamic fields of the last packet rebuilt.
+    std::uint32_t sequence{0};
+    std::uint32_t ack{0};
+    std::uint16_t ip_id{0};
+    std::uint16_t window{0};
+  };
+
+  bool on_refresh(std::vector<std::uint8_t>& packet);
+  bool expand_tcp(std::vector<std::uint8_t>& packet);
+  bool expand_udp(std::vector<std::uint8_t>& packet);
+
+  // Contexts by id, grown as the peer uses them.
+  std::vector<Context> contexts_;
+  std::vector<std::uint8_t> scratch_;
+  HeaderDecompressorStats stats_;
+};
+
+}  // namespace veil::mux
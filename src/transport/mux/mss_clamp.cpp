@@ -0,0 +1,110 @@
+#include "transport/mux/mss_clamp.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace veil::mux {
+
+namespace {
+
+constexpr std::uint8_t kProtocolTcp = 6;
+constexpr std::uint8_t kTcpSyn = 0x02;
+constexpr std::uint8_t kOptionEnd = 0;
+constexpr std::uint8_t kOptionNop = 1;
+constexpr std::uint8_t kOptionMss = 2;
+constexpr std::size_t kTcpChecksumOffset = 16;
+
+std::uint16_t read_u16(std::span<const std::uint8_t> data, std::size_t offset) {
+  return static_cast<std::uint16_t>((data[offset] << 8) | data[offset + 1]);
+}
+
+// One's complement update of a checksum for a 16-bit word going from old_word to
+// new_word: HC' = ~(~HC + ~m + m') (RFC 1624, equation 3).
+std::uint16_t update_checksum(std::uint16_t checksum, std::uint16_t old_word,
+                              std::uint16_t new_word) {
+  std::uint32_t sum = static_cast<std::uint16_t>(~checksum);
+  sum += static_cast<std::uint16_t>(~old_word);
+  sum += new_word;
+  sum = (sum & 0xFFFFU) + (sum >> 16);
+  sum = (sum & 0xFFFFU) + (sum >> 16);
+  return static_cast<std::uint16_t>(~sum);
+}
+
+std::uint16_t swap_bytes(std::uint16_t value) {
+  return static_cast<std::uint16_t>((value << 8) | (value >> 8));
+}
+
+}  // namespace
+
+bool clamp_tcp_mss(std::span<const std::uint8_t> packet, std::size_t max_packet_size,
+                   std::vector<std::uint8_t>& out) {
+  // Where the TCP header starts, and the largest MSS that fits.
+  std::size_t tcp = 0;
+  std::size_t overhead = 0;
+  if (packet.size() >= 20 && (packet[0] >> 4) == 4) {
+    // Later fragments carry no TCP header; a first fragment is not a SYN worth saving.
+    const bool fragment = (read_u16(packet, 6) & 0x3FFFU) != 0;
+    if (packet[9] != kProtocolTcp || fragment) {
+      return false;
+    }
+    tcp = std::size_t{packet[0] & 0x0FU} * 4;
+    overhead = kMssOverheadIpv4;
+  } else if (packet.size() >= 40 && (packet[0] >> 4) == 6) {
+    // TCP right after the fixed header only: SYNs behind extension headers are rare.
+    if (packet[6] != kProtocolTcp) {
+      return false;
+    }
+    tcp = 40;
+    overhead = kMssOverheadIpv6;
+  } else {
+    return false;
+  }
+  if (tcp < 20 || packet.size() < tcp + 20 || (packet[tcp + 13] & kTcpSyn) == 0 ||
+      max_packet_size <= overhead) {
+    return false;
+  }
+  const std::size_t tcp_end = std::min(packet.size(), tcp + (std::size_t{packet[tcp + 12]} >> 4) * 4);
+  const auto limit =
+      static_cast<std::uint16_t>(std::min<std::size_t>(max_packet_size - overhead, 0xFFFF));
+
+  // Find the MSS option.
+  std::size_t pos = tcp + 20;
+  while (pos < tcp_end && packet[pos] != kOptionEnd) {
+    if (packet[pos] == kOptionNop) {
+      ++pos;
+      continue;
+    }
+    if (pos + 1 >= tcp_end || packet[pos + 1] < 2 || pos + packet[pos + 1] > tcp_end) {
+      return false;  // Malformed options: leave the packet to the endpoints.
+    }
+    if (packet[pos] == kOptionMss && packet[pos + 1] == 4) {
+      break;
+    }
+    pos += packet[pos + 1];
+  }
+  if (pos >= tcp_end || packet[pos] != kOptionMss) {
+    return false;
+  }
+  const std::size_t value = pos + 2;
+  const std::uint16_t mss = read_u16(packet, value);
+  if (mss <= limit) {
+    return false;
+  }
+
+  out.assign(packet.begin(), packet.end());
+  out[value] = static_cast<std::uint8_t>(limit >> 8);
+  out[value + 1] = static_cast<std::uint8_t>(limit);
+  // The checksum sums 16-bit words from the start of the TCP header; at an odd offset
+  // the value straddles two words and counts byte-swapped.
+  const bool odd = ((value - tcp) & 1U) != 0;
+  const auto checksum = update_checksum(read_u16(packet, tcp + kTcpChecksumOffset),
+                                        odd ? swap_bytes(mss) : mss,
+                                        odd ? swap_bytes(limit) : limit);
+  out[tcp + kTcpChecksumOffset] = static_cast<std::uint8_t>(checksum >> 8);
+  out[tcp + kTcpChecksumOffset + 1] = static_cast<std::uint8_t>(checksum);
+  return true;
+}
+
+}  // namespace veil::mux
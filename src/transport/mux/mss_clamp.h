@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace veil::mux {
+
+// IPv4 and IPv6 headers without options or extension headers, and the TCP header
+// without options: what the MSS leaves out of the packet size (RFC 879, RFC 8200).
+inline constexpr std::size_t kMssOverheadIpv4 = 20 + 20;
+inline constexpr std::size_t kMssOverheadIpv6 = 40 + 20;
+
+// TCP MSS clamping for tunneled packets. A TCP SYN or SYN-ACK whose MSS option would
+// let a full-size segment exceed max_packet_size is copied into out with the option
+// lowered to fit, and the TCP checksum updated incrementally (RFC 1624), so both ends
+// of the connection send segments that cross the tunnel whole. Returns false, leaving
+// out alone, for anything else: other packets, SYNs without the option, an MSS that
+// already fits. The option is only ever lowered.
+bool clamp_tcp_mss(std::span<const std::uint8_t> packet, std::size_t max_packet_size,
+                   std::vector<std::uint8_t>& out);
+
+}  // namespace veil::mux
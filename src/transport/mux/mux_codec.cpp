@@ -1,9 +1,11 @@
 #include "transport/mux/mux_codec.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cstdint>
 #include <optional>
 #include <span>
+#include <utility>
 #include <vector>
 
 namespace {
@@ -49,7 +51,346 @@ std::uint64_t read_u64(std::span<const std::uint8_t> data, std::size_t offset) {
 
 namespace veil::mux {
 
-std::vector<std::uint8_t> MuxCodec::encode(const MuxFrame& frame) {
+namespace {
+
+// Write helpers for zero-copy encoding.
+void write_u16_at(std::span<std::uint8_t> out, std::size_t offset, std::uint16_t value) {
+  out[offset] = static_cast<std::uint8_t>((value >> 8) & 0xFF);
+  out[offset + 1] = static_cast<std::uint8_t>(value & 0xFF);
+}
+
+void write_u32_at(std::span<std::uint8_t> out, std::size_t offset, std::uint32_t value) {
+  out[offset] = static_cast<std::uint8_t>((value >> 24) & 0xFF);
+  out[offset + 1] = static_cast<std::uint8_t>((value >> 16) & 0xFF);
+  out[offset + 2] = static_cast<std::uint8_t>((value >> 8) & 0xFF);
+  out[offset + 3] = static_cast<std::uint8_t>(value & 0xFF);
+}
+
+void write_u64_at(std::span<std::uint8_t> out, std::size_t offset, std::uint64_t value) {
+  for (int i = 7; i >= 0; --i) {
+    out[offset + static_cast<std::size_t>(7 - i)] =
+        static_cast<std::uint8_t>((value >> (8 * i)) & 0xFF);
+  }
+}
+
+// Walk the ranges that fit the wire format, calling fn(index, gap, length) for each.
+// Stops at kMaxAckRanges, at a malformed or overlapping range, and at a gap too wide
+// for its 32-bit field; an over-long range is shortened. Trimming only under-reports,
+// which the sender treats as not acknowledged yet. Returns the number of ranges.
+template <typename Fn>
+std::size_t visit_wire_ranges(const AckRangesFrame& ack, Fn&& fn) {
+  constexpr std::uint64_t kMaxField = 0xFFFFFFFF;
+  std::size_t count = 0;
+  std::uint64_t prev_smallest = 0;
+  for (const auto& range : ack.ranges) {
+    if (count == kMaxAckRanges || range.largest < range.smallest) {
+      break;
+    }
+    std::uint64_t gap = 0;
+    if (count > 0) {
+      if (prev_smallest < 2 || range.largest > prev_smallest - 2) {
+        break;
+      }
+      gap = prev_smallest - range.largest - 2;
+      if (gap > kMaxField) {
+        break;
+      }
+    }
+    const auto length = std::min(range.largest - range.smallest, kMaxField);
+    fn(count, gap, length);
+    prev_smallest = range.largest - length;
+    ++count;
+  }
+  return count;
+}
+
+std::size_t ack_ranges_wire_size(std::size_t range_count, bool has_ecn) {
+  return MuxCodec::kAckRangesHeaderSize +
+         (range_count > 1 ? range_count - 1 : 0) * MuxCodec::kAckRangeSize +
+         (has_ecn ? MuxCodec::kEcnCountsSize : 0);
+}
+
+std::size_t ack_ranges_size(const AckRangesFrame& ack) {
+  const auto count = visit_wire_ranges(ack, [](std::size_t, std::uint64_t, std::uint64_t) {});
+  return ack_ranges_wire_size(count, ack.ecn.has_value());
+}
+
+// Write a kAckRanges frame body (after the kind byte) at `pos`. Returns the new position.
+std::size_t write_ack_ranges_at(std::span<std::uint8_t> out, std::size_t pos,
+                                const AckRangesFrame& ack) {
+  out[pos++] = ack.version;
+  out[pos++] = ack.ecn ? 0x01 : 0x00;
+  write_u64_at(out, pos, ack.stream_id);
+  pos += 8;
+  write_u64_at(out, pos, ack.ranges.empty() ? 0 : ack.ranges.front().largest);
+  pos += 8;
+  const auto delay_us = static_cast<std::uint64_t>(std::max<std::int64_t>(ack.ack_delay.count(), 0));
+  write_u16_at(out, pos,
+               static_cast<std::uint16_t>(
+                   std::min<std::uint64_t>(delay_us >> MuxCodec::kAckDelayExponent, 0xFFFF)));
+  pos += 2;
+  const auto count_pos = pos++;
+  const auto first_range_pos = pos;
+  write_u32_at(out, first_range_pos, 0);
+  pos += 4;
+  const auto count =
+      visit_wire_ranges(ack, [&](std::size_t index, std::uint64_t gap, std::uint64_t length) {
+        if (index == 0) {
+          write_u32_at(out, first_range_pos, static_cast<std::uint32_t>(length));
+          return;
+        }
+        write_u32_at(out, pos, static_cast<std::uint32_t>(gap));
+        write_u32_at(out, pos + 4, static_cast<std::uint32_t>(length));
+        pos += MuxCodec::kAckRangeSize;
+      });
+  out[count_pos] = static_cast<std::uint8_t>(count);
+  if (ack.ecn) {
+    write_u64_at(out, pos, ack.ecn->ect0);
+    write_u64_at(out, pos + 8, ack.ecn->ect1);
+    write_u64_at(out, pos + 16, ack.ecn->ce);
+    pos += MuxCodec::kEcnCountsSize;
+  }
+  return pos;
+}
+
+// Parse a complete kAckRanges frame (including the kind byte).
+std::optional<AckRangesFrame> read_ack_ranges(std::span<const std::uint8_t> data) {
+  if (data.size() < MuxCodec::kAckRangesHeaderSize) {
+    return std::nullopt;
+  }
+  AckRangesFrame ack;
+  ack.version = data[1];
+  if (ack.version != kAckRangesVersion) {
+    return std::nullopt;
+  }
+  const bool has_ecn = (data[2] & 0x01) != 0;
+  const std::size_t range_count = data[21];
+  if (range_count > kMaxAckRanges || data.size() != ack_ranges_wire_size(range_count, has_ecn)) {
+    return std::nullopt;
+  }
+  ack.stream_id = read_u64(data, 3);
+  const auto largest = read_u64(data, 11);
+  ack.ack_delay = std::chrono::microseconds(
+      static_cast<std::int64_t>(std::uint64_t{read_u16(data, 19)} << MuxCodec::kAckDelayExponent));
+
+  std::size_t pos = MuxCodec::kAckRangesHeaderSize;
+  if (range_count > 0) {
+    const std::uint64_t first_range = read_u32(data, 22);
+    if (first_range > largest) {
+      return std::nullopt;
+    }
+    ack.ranges.reserve(range_count);
+    ack.ranges.push_back(AckRange{.smallest = largest - first_range, .largest = largest});
+    for (std::size_t i = 1; i < range_count; ++i) {
+      const std::uint64_t gap = read_u32(data, pos);
+      const std::uint64_t length = read_u32(data, pos + 4);
+      pos += MuxCodec::kAckRangeSize;
+      const auto prev_smallest = ack.ranges.back().smallest;
+      if (prev_smallest < gap + 2 || prev_smallest - gap - 2 < length) {
+        return std::nullopt;
+      }
+      const auto range_largest = prev_smallest - gap - 2;
+      ack.ranges.push_back(AckRange{.smallest = range_largest - length, .largest = range_largest});
+    }
+  }
+  if (has_ecn) {
+    ack.ecn = EcnCounts{
+        .ect0 = read_u64(data, pos), .ect1 = read_u64(data, pos + 8), .ce = read_u64(data, pos + 16)};
+  }
+  return ack;
+}
+
+// Write a kFecRepair frame body (after the kind byte) at `pos`. Returns the new position.
+std::size_t write_fec_repair_at(std::span<std::uint8_t> out, std::size_t pos,
+                                const FecRepairFrame& repair) {
+  write_u64_at(out, pos, repair.first_sequence);
+  pos += 8;
+  write_u64_at(out, pos, repair.mask);
+  pos += 8;
+  write_u16_at(out, pos, repair.length_xor);
+  pos += 2;
+  write_u16_at(out, pos, static_cast<std::uint16_t>(repair.payload.size()));
+  pos += 2;
+  std::copy(repair.payload.begin(), repair.payload.end(),
+            out.begin() + static_cast<std::ptrdiff_t>(pos));
+  return pos + repair.payload.size();
+}
+
+// Parse a complete kFecRepair frame (including the kind byte).
+std::optional<FecRepairFrame> read_fec_repair(std::span<const std::uint8_t> data) {
+  if (data.size() < MuxCodec::kFecRepairHeaderSize) {
+    return std::nullopt;
+  }
+  FecRepairFrame repair;
+  repair.first_sequence = read_u64(data, 1);
+  repair.mask = read_u64(data, 9);
+  repair.length_xor = read_u16(data, 17);
+  const std::uint16_t payload_len = read_u16(data, 19);
+  if (data.size() != MuxCodec::kFecRepairHeaderSize + payload_len || repair.mask == 0) {
+    return std::nullopt;
+  }
+  repair.payload.assign(data.begin() + MuxCodec::kFecRepairHeaderSize, data.end());
+  return repair;
+}
+
+// QUIC variable-length integers (RFC 9000 section 16): the top two bits of the first
+// byte give the length (1, 2, 4 or 8 bytes), the rest is the value, big-endian.
+constexpr std::uint64_t kMaxVarint = (std::uint64_t{1} << 62) - 1;
+
+std::size_t varint_size(std::uint64_t value) {
+  if (value < (1U << 6)) {
+    return 1;
+  }
+  if (value < (1U << 14)) {
+    return 2;
+  }
+  if (value < (1U << 30)) {
+    return 4;
+  }
+  return 8;
+}
+
+std::size_t write_varint_at(std::span<std::uint8_t> out, std::size_t pos, std::uint64_t value) {
+  const auto size = varint_size(value);
+  const std::uint64_t prefix = size == 1 ? 0 : size == 2 ? 1 : size == 4 ? 2 : 3;
+  value |= prefix << (8 * size - 2);
+  for (std::size_t i = 0; i < size; ++i) {
+    out[pos + i] = static_cast<std::uint8_t>(value >> (8 * (size - 1 - i)));
+  }
+  return pos + size;
+}
+
+std::optional<std::uint64_t> read_varint(std::span<const std::uint8_t> data, std::size_t& pos) {
+  if (pos >= data.size()) {
+    return std::nullopt;
+  }
+  const std::size_t size = std::size_t{1} << (data[pos] >> 6);
+  if (data.size() - pos < size) {
+    return std::nullopt;
+  }
+  std::uint64_t value = data[pos] & 0x3F;
+  for (std::size_t i = 1; i < size; ++i) {
+    value = (value << 8) | data[pos + i];
+  }
+  pos += size;
+  return value;
+}
+
+// kCompactData flags.
+constexpr std::uint8_t kCompactFin = 0x01;
+constexpr std::uint8_t kCompactStream = 0x02;
+constexpr std::uint8_t kCompactFragment = 0x04;
+
+// DATA sequences above 32 bits are fragments: message id << 32 | fragment index
+// (see TransportSession::fragment_data()), sent as two varints.
+constexpr std::uint64_t kFragmentThreshold = 0xFFFFFFFF;
+
+// Size of a kCompactData frame, or 0 if a field does not fit a varint (the frame then
+// goes out as kData).
+std::size_t compact_data_size(std::uint64_t stream_id, std::uint64_t sequence,
+                              std::size_t payload_size) {
+  if (stream_id > kMaxVarint || payload_size > MuxCodec::kMaxPayloadSize) {
+    return 0;
+  }
+  std::size_t size = 1 + 1 + (stream_id != 0 ? varint_size(stream_id) : 0);
+  if (sequence > kFragmentThreshold) {
+    size += varint_size(sequence >> 32) + varint_size(sequence & kFragmentThreshold);
+  } else {
+    size += varint_size(sequence);
+  }
+  return size + varint_size(payload_size) + payload_size;
+}
+
+// Whether a frame goes out as kCompactData.
+bool use_compact_data(const MuxFrame& frame, WireFormat format) {
+  return frame.kind == FrameKind::kData && format == WireFormat::kV2 &&
+         compact_data_size(frame.data.stream_id, frame.data.sequence,
+                           frame.data.payload.size()) != 0;
+}
+
+// Write a kCompactData frame (including the kind byte) at `pos`. Returns the new position.
+std::size_t write_compact_data_at(std::span<std::uint8_t> out, std::size_t pos,
+                                  const DataFrame& data) {
+  out[pos++] = static_cast<std::uint8_t>(FrameKind::kCompactData);
+  std::uint8_t flags = data.fin ? kCompactFin : 0;
+  if (data.stream_id != 0) {
+    flags |= kCompactStream;
+  }
+  if (data.sequence > kFragmentThreshold) {
+    flags |= kCompactFragment;
+  }
+  out[pos++] = flags;
+  if (data.stream_id != 0) {
+    pos = write_varint_at(out, pos, data.stream_id);
+  }
+  if (data.sequence > kFragmentThreshold) {
+    pos = write_varint_at(out, pos, data.sequence >> 32);
+    pos = write_varint_at(out, pos, data.sequence & kFragmentThreshold);
+  } else {
+    pos = write_varint_at(out, pos, data.sequence);
+  }
+  pos = write_varint_at(out, pos, data.payload.size());
+  std::copy(data.payload.begin(), data.payload.end(), out.begin() + static_cast<std::ptrdiff_t>(pos));
+  return pos + data.payload.size();
+}
+
+// Fields of a kCompactData frame, with the payload's position in the frame.
+struct CompactDataHeader {
+  std::uint64_t stream_id{0};
+  std::uint64_t sequence{0};
+  bool fin{false};
+  std::size_t payload_offset{0};
+  std::size_t payload_size{0};
+};
+
+// Parse the header of the kCompactData frame at the start of `data` (which may be
+// followed by more frames).
+std::optional<CompactDataHeader> read_compact_data_header(std::span<const std::uint8_t> data) {
+  if (data.size() < 2) {
+    return std::nullopt;
+  }
+  CompactDataHeader header;
+  const std::uint8_t flags = data[1];
+  header.fin = (flags & kCompactFin) != 0;
+  std::size_t pos = 2;
+  if ((flags & kCompactStream) != 0) {
+    auto stream_id = read_varint(data, pos);
+    if (!stream_id) {
+      return std::nullopt;
+    }
+    header.stream_id = *stream_id;
+  }
+  auto sequence = read_varint(data, pos);
+  if (!sequence) {
+    return std::nullopt;
+  }
+  header.sequence = *sequence;
+  if ((flags & kCompactFragment) != 0) {
+    auto index = read_varint(data, pos);
+    if (!index || header.sequence == 0 || header.sequence > kFragmentThreshold ||
+        *index > kFragmentThreshold) {
+      return std::nullopt;
+    }
+    header.sequence = (header.sequence << 32) | *index;
+  }
+  auto payload_size = read_varint(data, pos);
+  if (!payload_size || *payload_size > MuxCodec::kMaxPayloadSize) {
+    return std::nullopt;
+  }
+  header.payload_offset = pos;
+  header.payload_size = static_cast<std::size_t>(*payload_size);
+  return header;
+}
+
+}  // namespace
+
+std::vector<std::uint8_t> MuxCodec::encode(const MuxFrame& frame, WireFormat format) {
+  if (use_compact_data(frame, format)) {
+    std::vector<std::uint8_t> out(encoded_size(frame, format));
+    write_compact_data_at(out, 0, frame.data);
+    return out;
+  }
+
   std::vector<std::uint8_t> out;
   out.reserve(encoded_size(frame));
   out.push_back(static_cast<std::uint8_t>(frame.kind));
@@ -83,6 +424,28 @@ std::vector<std::uint8_t> MuxCodec::encode(const MuxFrame& frame) {
       out.insert(out.end(), frame.heartbeat.payload.begin(), frame.heartbeat.payload.end());
       break;
     }
+    case FrameKind::kDatagram: {
+      write_u16(out, static_cast<std::uint16_t>(frame.datagram.payload.size()));
+      out.insert(out.end(), frame.datagram.payload.begin(), frame.datagram.payload.end());
+      break;
+    }
+    case FrameKind::kAckRanges: {
+      const auto start = out.size();
+      out.resize(start + ack_ranges_size(frame.ack_ranges) - 1);
+      write_ack_ranges_at(out, start, frame.ack_ranges);
+      break;
+    }
+    case FrameKind::kFecRepair: {
+      write_u64(out, frame.fec_repair.first_sequence);
+      write_u64(out, frame.fec_repair.mask);
+      write_u16(out, frame.fec_repair.length_xor);
+      write_u16(out, static_cast<std::uint16_t>(frame.fec_repair.payload.size()));
+      out.insert(out.end(), frame.fec_repair.payload.begin(), frame.fec_repair.payload.end());
+      break;
+    }
+    case FrameKind::kCompactData:
+      // Never a frame's kind: DATA frames are encoded compactly by wire format.
+      return {};
   }
 
   return out;
@@ -147,6 +510,46 @@ std::optional<MuxFrame> MuxCodec::decode(std::span<const std::uint8_t> data) {
       frame.heartbeat.payload.assign(data.begin() + kHeartbeatHeaderSize, data.end());
       break;
     }
+    case FrameKind::kDatagram: {
+      if (data.size() < kDatagramHeaderSize) {
+        return std::nullopt;
+      }
+      std::uint16_t payload_len = read_u16(data, 1);
+      if (data.size() != kDatagramHeaderSize + payload_len) {
+        return std::nullopt;
+      }
+      frame.datagram.payload.assign(data.begin() + kDatagramHeaderSize, data.end());
+      break;
+    }
+    case FrameKind::kAckRanges: {
+      auto ack = read_ack_ranges(data);
+      if (!ack) {
+        return std::nullopt;
+      }
+      frame.ack_ranges = std::move(*ack);
+      break;
+    }
+    case FrameKind::kFecRepair: {
+      auto repair = read_fec_repair(data);
+      if (!repair) {
+        return std::nullopt;
+      }
+      frame.fec_repair = std::move(*repair);
+      break;
+    }
+    case FrameKind::kCompactData: {
+      auto header = read_compact_data_header(data);
+      if (!header || data.size() != header->payload_offset + header->payload_size) {
+        return std::nullopt;
+      }
+      frame.kind = FrameKind::kData;
+      frame.data.stream_id = header->stream_id;
+      frame.data.sequence = header->sequence;
+      frame.data.fin = header->fin;
+      frame.data.payload.assign(data.begin() + static_cast<std::ptrdiff_t>(header->payload_offset),
+                                data.end());
+      break;
+    }
     default:
       return std::nullopt;
   }
@@ -154,7 +557,10 @@ std::optional<MuxFrame> MuxCodec::decode(std::span<const std::uint8_t> data) {
   return frame;
 }
 
-std::size_t MuxCodec::encoded_size(const MuxFrame& frame) {
+std::size_t MuxCodec::encoded_size(const MuxFrame& frame, WireFormat format) {
+  if (use_compact_data(frame, format)) {
+    return compact_data_size(frame.data.stream_id, frame.data.sequence, frame.data.payload.size());
+  }
   switch (frame.kind) {
     case FrameKind::kData:
       return kDataHeaderSize + frame.data.payload.size();
@@ -164,10 +570,94 @@ std::size_t MuxCodec::encoded_size(const MuxFrame& frame) {
       return kControlHeaderSize + frame.control.payload.size();
     case FrameKind::kHeartbeat:
       return kHeartbeatHeaderSize + frame.heartbeat.payload.size();
+    case FrameKind::kDatagram:
+      return kDatagramHeaderSize + frame.datagram.payload.size();
+    case FrameKind::kAckRanges:
+      return ack_ranges_size(frame.ack_ranges);
+    case FrameKind::kFecRepair:
+      return kFecRepairHeaderSize + frame.fec_repair.payload.size();
+    case FrameKind::kCompactData:
+      return 0;
   }
   return 0;
 }
 
+std::size_t MuxCodec::leading_frame_size(std::span<const std::uint8_t> data) {
+  if (data.empty()) {
+    return 0;
+  }
+
+  std::size_t size = 0;
+  switch (static_cast<FrameKind>(data[0])) {
+    case FrameKind::kData:
+      size = data.size() < kDataHeaderSize ? 0 : kDataHeaderSize + read_u16(data, 18);
+      break;
+    case FrameKind::kAck:
+      size = kAckSize;
+      break;
+    case FrameKind::kControl:
+      size = data.size() < kControlHeaderSize ? 0 : kControlHeaderSize + read_u16(data, 2);
+      break;
+    case FrameKind::kHeartbeat:
+      size = data.size() < kHeartbeatHeaderSize ? 0 : kHeartbeatHeaderSize + read_u16(data, 17);
+      break;
+    case FrameKind::kDatagram:
+      size = data.size() < kDatagramHeaderSize ? 0 : kDatagramHeaderSize + read_u16(data, 1);
+      break;
+    case FrameKind::kAckRanges:
+      size = data.size() < kAckRangesHeaderSize
+                 ? 0
+                 : ack_ranges_wire_size(data[21], (data[2] & 0x01) != 0);
+      break;
+    case FrameKind::kFecRepair:
+      size = data.size() < kFecRepairHeaderSize ? 0 : kFecRepairHeaderSize + read_u16(data, 19);
+      break;
+    case FrameKind::kCompactData: {
+      const auto header = read_compact_data_header(data);
+      size = header ? header->payload_offset + header->payload_size : 0;
+      break;
+    }
+    default:
+      return 0;
+  }
+  return size <= data.size() ? size : 0;
+}
+
+std::vector<std::uint8_t> MuxCodec::encode_all(std::span<const MuxFrame> frames,
+                                               WireFormat format) {
+  std::size_t total = 0;
+  for (const auto& frame : frames) {
+    total += encoded_size(frame, format);
+  }
+
+  std::vector<std::uint8_t> out(total);
+  std::size_t offset = 0;
+  for (const auto& frame : frames) {
+    offset += encode_to(frame, std::span<std::uint8_t>(out).subspan(offset), format);
+  }
+  return out;
+}
+
+std::optional<std::vector<MuxFrame>> MuxCodec::decode_all(std::span<const std::uint8_t> data) {
+  std::vector<MuxFrame> frames;
+  while (!data.empty()) {
+    const auto size = leading_frame_size(data);
+    if (size == 0) {
+      return std::nullopt;
+    }
+    auto frame = decode(data.first(size));
+    if (!frame) {
+      return std::nullopt;
+    }
+    frames.push_back(std::move(*frame));
+    data = data.subspan(size);
+  }
+  if (frames.empty()) {
+    return std::nullopt;
+  }
+  return frames;
+}
+
 MuxFrame make_data_frame(std::uint64_t stream_id, std::uint64_t sequence, bool fin,
                          std::vector<std::uint8_t> payload) {
   MuxFrame frame{};
@@ -206,37 +696,38 @@ MuxFrame make_heartbeat_frame(std::uint64_t timestamp, std::uint64_t sequence,
   return frame;
 }
 
-// PERFORMANCE (Issue #97): Zero-copy encode/decode implementations.
-
-namespace {
-
-// Write helpers for zero-copy encoding.
-void write_u16_at(std::span<std::uint8_t> out, std::size_t offset, std::uint16_t value) {
-  out[offset] = static_cast<std::uint8_t>((value >> 8) & 0xFF);
-  out[offset + 1] = static_cast<std::uint8_t>(value & 0xFF);
+MuxFrame make_datagram_frame(std::vector<std::uint8_t> payload) {
+  MuxFrame frame{};
+  frame.kind = FrameKind::kDatagram;
+  frame.datagram.payload = std::move(payload);
+  return frame;
 }
 
-void write_u32_at(std::span<std::uint8_t> out, std::size_t offset, std::uint32_t value) {
-  out[offset] = static_cast<std::uint8_t>((value >> 24) & 0xFF);
-  out[offset + 1] = static_cast<std::uint8_t>((value >> 16) & 0xFF);
-  out[offset + 2] = static_cast<std::uint8_t>((value >> 8) & 0xFF);
-  out[offset + 3] = static_cast<std::uint8_t>(value & 0xFF);
+MuxFrame make_ack_ranges_frame(AckRangesFrame ack) {
+  MuxFrame frame{};
+  frame.kind = FrameKind::kAckRanges;
+  frame.ack_ranges = std::move(ack);
+  return frame;
 }
 
-void write_u64_at(std::span<std::uint8_t> out, std::size_t offset, std::uint64_t value) {
-  for (int i = 7; i >= 0; --i) {
-    out[offset + static_cast<std::size_t>(7 - i)] =
-        static_cast<std::uint8_t>((value >> (8 * i)) & 0xFF);
-  }
+MuxFrame make_fec_repair_frame(FecRepairFrame repair) {
+  MuxFrame frame{};
+  frame.kind = FrameKind::kFecRepair;
+  frame.fec_repair = std::move(repair);
+  return frame;
 }
 
-}  // namespace
+// PERFORMANCE (Issue #97): Zero-copy encode/decode implementations.
 
-std::size_t MuxCodec::encode_to(const MuxFrame& frame, std::span<std::uint8_t> output) {
-  const std::size_t required = encoded_size(frame);
-  if (output.size() < required) {
+std::size_t MuxCodec::encode_to(const MuxFrame& frame, std::span<std::uint8_t> output,
+                                WireFormat format) {
+  const std::size_t required = encoded_size(frame, format);
+  if (required == 0 || output.size() < required) {
     return 0;  // Buffer too small
   }
+  if (use_compact_data(frame, format)) {
+    return write_compact_data_at(output, 0, frame.data);
+  }
 
   std::size_t pos = 0;
   output[pos++] = static_cast<std::uint8_t>(frame.kind);
@@ -282,6 +773,23 @@ std::size_t MuxCodec::encode_to(const MuxFrame& frame, std::span<std::uint8_t> o
       pos += frame.heartbeat.payload.size();
       break;
     }
+    case FrameKind::kDatagram: {
+      write_u16_at(output, pos, static_cast<std::uint16_t>(frame.datagram.payload.size()));
+      pos += 2;
+      std::copy(frame.datagram.payload.begin(), frame.datagram.payload.end(), output.begin() + static_cast<std::ptrdiff_t>(pos));
+      pos += frame.datagram.payload.size();
+      break;
+    }
+    case FrameKind::kAckRanges: {
+      pos = write_ack_ranges_at(output, pos, frame.ack_ranges);
+      break;
+    }
+    case FrameKind::kFecRepair: {
+      pos = write_fec_repair_at(output, pos, frame.fec_repair);
+      break;
+    }
+    case FrameKind::kCompactData:
+      return 0;
   }
 
   return pos;
@@ -349,6 +857,46 @@ std::optional<MuxFrameView> MuxCodec::decode_view(std::span<const std::uint8_t>
       frame.heartbeat.payload = data.subspan(kHeartbeatHeaderSize, payload_len);
       break;
     }
+    case FrameKind::kDatagram: {
+      if (data.size() < kDatagramHeaderSize) {
+        return std::nullopt;
+      }
+      std::uint16_t payload_len = read_u16(data, 1);
+      if (data.size() != kDatagramHeaderSize + payload_len) {
+        return std::nullopt;
+      }
+      // Zero-copy: create a span view into the source buffer
+      frame.datagram.payload = data.subspan(kDatagramHeaderSize, payload_len);
+      break;
+    }
+    case FrameKind::kAckRanges: {
+      auto ack = read_ack_ranges(data);
+      if (!ack) {
+        return std::nullopt;
+      }
+      frame.ack_ranges = std::move(*ack);
+      break;
+    }
+    case FrameKind::kFecRepair: {
+      auto repair = read_fec_repair(data);
+      if (!repair) {
+        return std::nullopt;
+      }
+      frame.fec_repair = std::move(*repair);
+      break;
+    }
+    case FrameKind::kCompactData: {
+      auto header = read_compact_data_header(data);
+      if (!header || data.size() != header->payload_offset + header->payload_size) {
+        return std::nullopt;
+      }
+      frame.kind = FrameKind::kData;
+      frame.data.stream_id = header->stream_id;
+      frame.data.sequence = header->sequence;
+      frame.data.fin = header->fin;
+      frame.data.payload = data.subspan(header->payload_offset, header->payload_size);
+      break;
+    }
     default:
       return std::nullopt;
   }
@@ -366,6 +914,14 @@ std::size_t MuxCodec::encoded_size_view(const MuxFrameView& frame) {
       return kControlHeaderSize + frame.control.payload.size();
     case FrameKind::kHeartbeat:
       return kHeartbeatHeaderSize + frame.heartbeat.payload.size();
+    case FrameKind::kDatagram:
+      return kDatagramHeaderSize + frame.datagram.payload.size();
+    case FrameKind::kAckRanges:
+      return ack_ranges_size(frame.ack_ranges);
+    case FrameKind::kFecRepair:
+      return kFecRepairHeaderSize + frame.fec_repair.payload.size();
+    case FrameKind::kCompactData:
+      return 0;
   }
   return 0;
 }
@@ -420,6 +976,23 @@ std::size_t MuxCodec::encode_view_to(const MuxFrameView& frame, std::span<std::u
       pos += frame.heartbeat.payload.size();
       break;
     }
+    case FrameKind::kDatagram: {
+      write_u16_at(output, pos, static_cast<std::uint16_t>(frame.datagram.payload.size()));
+      pos += 2;
+      std::copy(frame.datagram.payload.begin(), frame.datagram.payload.end(), output.begin() + static_cast<std::ptrdiff_t>(pos));
+      pos += frame.datagram.payload.size();
+      break;
+    }
+    case FrameKind::kAckRanges: {
+      pos = write_ack_ranges_at(output, pos, frame.ack_ranges);
+      break;
+    }
+    case FrameKind::kFecRepair: {
+      pos = write_fec_repair_at(output, pos, frame.fec_repair);
+      break;
+    }
+    case FrameKind::kCompactData:
+      return 0;
   }
 
   return pos;
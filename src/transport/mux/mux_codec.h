@@ -31,24 +31,70 @@ namespace veil::mux {
 //     [sequence: 8 bytes big-endian]
 //     [payload_len: 2 bytes big-endian]
 //     [payload: payload_len bytes]
+//   For kDatagram:
+//     [payload_len: 2 bytes big-endian]
+//     [payload: payload_len bytes]
+//   For kAckRanges:
+//     [version: 1 byte]
+//     [flags: 1 byte, bit 0 = ECN counts present]
+//     [stream_id: 8 bytes big-endian]
+//     [largest_acked: 8 bytes big-endian]
+//     [ack_delay: 2 bytes big-endian, units of 2^kAckDelayExponent microseconds]
+//     [range_count: 1 byte, 1..kMaxAckRanges]
+//     [first_range: 4 bytes big-endian, largest - smallest of the first range]
+//     range_count - 1 times:
+//       [gap: 4 bytes big-endian, unacked sequences between ranges minus one]
+//       [range_length: 4 bytes big-endian, largest - smallest]
+//     If ECN flag: [ect0: 8 bytes][ect1: 8 bytes][ce: 8 bytes], all big-endian
+//   For kFecRepair:
+//     [first_sequence: 8 bytes big-endian]
+//     [mask: 8 bytes big-endian]
+//     [length_xor: 2 bytes big-endian]
+//     [payload_len: 2 bytes big-endian]
+//     [payload: payload_len bytes]
+//   For kCompactData (wire format v2 DATA, decoded as kData; varints as in RFC 9000
+//   section 16):
+//     [flags: 1 byte, bit 0 = FIN, bit 1 = stream_id present, bit 2 = fragment]
+//     [stream_id: varint, only if bit 1 (otherwise stream 0)]
+//     [sequence: varint], or if bit 2 [message id: varint][fragment index: varint]
+//       for the sequence message id << 32 | fragment index
+//     [payload_len: varint]
+//     [payload: payload_len bytes]
+//
+// A packet may carry several frames back to back (see FramePacker); every frame
+// encodes its own length, so encode_all()/decode_all() need no extra framing.
 
 class MuxCodec {
  public:
-  // Serialize a MuxFrame to bytes.
-  static std::vector<std::uint8_t> encode(const MuxFrame& frame);
+  // Serialize a MuxFrame to bytes. With WireFormat::kV2, DATA frames are sent as
+  // kCompactData (unless a field is too large for a varint); other frames are unchanged.
+  static std::vector<std::uint8_t> encode(const MuxFrame& frame,
+                                          WireFormat format = WireFormat::kV1);
 
   // Parse bytes into a MuxFrame. Returns nullopt on malformed input.
   static std::optional<MuxFrame> decode(std::span<const std::uint8_t> data);
 
   // Returns the expected size needed to encode this frame (for pre-allocation).
-  static std::size_t encoded_size(const MuxFrame& frame);
+  static std::size_t encoded_size(const MuxFrame& frame, WireFormat format = WireFormat::kV1);
+
+  // Serialize several frames back to back into one buffer.
+  static std::vector<std::uint8_t> encode_all(std::span<const MuxFrame> frames,
+                                              WireFormat format = WireFormat::kV1);
+
+  // Parse a buffer of one or more back-to-back frames. Returns nullopt if any frame
+  // is malformed or the buffer has trailing bytes.
+  static std::optional<std::vector<MuxFrame>> decode_all(std::span<const std::uint8_t> data);
+
+  // Size of the frame at the start of `data`, or 0 if it is malformed or truncated.
+  static std::size_t leading_frame_size(std::span<const std::uint8_t> data);
 
   // PERFORMANCE (Issue #97): Zero-copy encode/decode methods.
   // These avoid memory allocations by using pre-allocated buffers or span views.
 
   // Encode into a pre-allocated buffer. Returns the number of bytes written,
   // or 0 if the buffer is too small.
-  static std::size_t encode_to(const MuxFrame& frame, std::span<std::uint8_t> output);
+  static std::size_t encode_to(const MuxFrame& frame, std::span<std::uint8_t> output,
+                               WireFormat format = WireFormat::kV1);
 
   // Decode without copying payload data. Returns a view into the source buffer.
   // IMPORTANT: The source buffer must outlive the returned MuxFrameView.
@@ -65,6 +111,13 @@ class MuxCodec {
   static constexpr std::size_t kAckSize = 1 + 8 + 8 + 4;               // 21 bytes
   static constexpr std::size_t kControlHeaderSize = 1 + 1 + 2;         // 4 bytes
   static constexpr std::size_t kHeartbeatHeaderSize = 1 + 8 + 8 + 2;   // 19 bytes
+  static constexpr std::size_t kDatagramHeaderSize = 1 + 2;            // 3 bytes
+  static constexpr std::size_t kAckRangesHeaderSize = 1 + 1 + 1 + 8 + 8 + 2 + 1 + 4;  // 26 bytes
+  static constexpr std::size_t kAckRangeSize = 4 + 4;                  // Each extra range
+  static constexpr std::size_t kEcnCountsSize = 3 * 8;
+  static constexpr std::size_t kFecRepairHeaderSize = 1 + 8 + 8 + 2 + 2;  // 21 bytes
+  // ack_delay is sent in units of 8 us, saturating at ~524 ms.
+  static constexpr unsigned kAckDelayExponent = 3;
   static constexpr std::size_t kMaxPayloadSize = 65535;
 };
 
@@ -79,4 +132,10 @@ MuxFrame make_control_frame(std::uint8_t type, std::vector<std::uint8_t> payload
 MuxFrame make_heartbeat_frame(std::uint64_t timestamp, std::uint64_t sequence,
                                std::vector<std::uint8_t> payload = {});
 
+MuxFrame make_datagram_frame(std::vector<std::uint8_t> payload);
+
+MuxFrame make_ack_ranges_frame(AckRangesFrame ack);
+
+MuxFrame make_fec_repair_frame(FecRepairFrame repair);
+
 }  // namespace veil::mux
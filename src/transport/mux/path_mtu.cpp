@@ -0,0 +1,126 @@
+#include "transport/mux/path_mtu.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+namespace veil::mux {
+
+PathMtuProber::PathMtuProber(std::size_t base_size, PathMtuConfig config)
+    : config_(config),
+      base_size_(base_size),
+      path_size_(base_size),
+      low_(base_size),
+      high_(std::max(base_size, config.max_size)) {}
+
+std::optional<std::size_t> PathMtuProber::probe_due(TimePoint now) {
+  if (in_flight_ && now - in_flight_->sent_at >= config_.probe_timeout) {
+    const auto size = in_flight_->size;
+    in_flight_.reset();
+    ++stats_.probes_lost;
+    on_probe_failed(size, now);
+  }
+  if (in_flight_ || now < next_probe_at_) {
+    return std::nullopt;
+  }
+
+  if (target_ == 0) {
+    if (state_ == PathMtuState::kSearchComplete && !confirm_pending_) {
+      if (now >= raise_at_) {
+        // Look for more: the path may have changed since the last search.
+        state_ = PathMtuState::kSearching;
+        low_ = path_size_;
+        high_ = std::max(path_size_, config_.max_size);
+        tried_high_ = false;
+      } else if (path_size_ > base_size_) {
+        confirm_pending_ = true;
+      } else {
+        next_probe_at_ = raise_at_;
+        return std::nullopt;
+      }
+    }
+
+    if (confirm_pending_ && path_size_ > base_size_) {
+      confirming_ = true;
+      target_ = path_size_;
+    } else if (high_ < low_ + config_.granularity) {
+      complete_search(now);
+      return std::nullopt;
+    } else {
+      // The top of the range first (a clean path), then halve what is left.
+      target_ = tried_high_ ? low_ + (high_ - low_ + 1) / 2 : high_;
+      tried_high_ = true;
+    }
+    confirm_pending_ = false;
+  }
+  return target_;
+}
+
+void PathMtuProber::on_probe_sent(std::uint32_t id, std::size_t size, TimePoint now) {
+  in_flight_ = InFlight{id, size, now};
+  ++stats_.probes_sent;
+}
+
+void PathMtuProber::on_probe_acked(std::uint32_t id, TimePoint now) {
+  if (!in_flight_ || in_flight_->id != id) {
+    return;
+  }
+  const auto size = in_flight_->size;
+  in_flight_.reset();
+  ++stats_.probes_acked;
+  failures_ = 0;
+  target_ = 0;
+
+  if (confirming_) {
+    confirming_ = false;
+    next_probe_at_ = now + config_.confirm_interval;
+    return;
+  }
+  low_ = std::max(low_, size);
+  path_size_ = std::max(path_size_, size);
+  // Carry on with the search.
+  next_probe_at_ = now;
+}
+
+void PathMtuProber::on_timeout_loss(TimePoint now) {
+  if (path_size_ <= base_size_ || confirming_) {
+    return;
+  }
+  confirm_pending_ = true;
+  if (target_ == 0) {
+    next_probe_at_ = now;
+  }
+}
+
+void PathMtuProber::on_probe_failed(std::size_t size, TimePoint now) {
+  // Retry at once: the probe was lost, not the path found wanting, until max_probes.
+  next_probe_at_ = now;
+  if (++failures_ < config_.max_probes) {
+    return;
+  }
+  failures_ = 0;
+  target_ = 0;
+
+  if (confirming_) {
+    // A black hole: the confirmed size stopped getting through. Fall back to the base
+    // and search again below the size that failed.
+    confirming_ = false;
+    ++stats_.black_holes;
+    path_size_ = base_size_;
+    low_ = base_size_;
+    high_ = std::max(base_size_, size - 1);
+    tried_high_ = false;
+    state_ = PathMtuState::kSearching;
+    return;
+  }
+  high_ = std::max(low_, size - 1);
+}
+
+void PathMtuProber::complete_search(TimePoint now) {
+  state_ = PathMtuState::kSearchComplete;
+  raise_at_ = now + config_.raise_interval;
+  next_probe_at_ = path_size_ > base_size_ ? now + config_.confirm_interval : raise_at_;
+}
+
+}  // namespace veil::mux
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+namespace veil::mux {
+
+// Configuration for packetization layer path MTU discovery. Sizes are whole encrypted
+// packets (the UDP payload), as TransportSessionConfig::mtu.
+struct PathMtuConfig {
+  // Largest size searched for: a 1500-byte Ethernet MTU less the IPv4 and UDP headers.
+  std::size_t max_size{1472};
+  // The search ends once the largest size confirmed and the smallest failed are this
+  // close.
+  std::size_t granularity{8};
+  // A probe not acknowledged within this is lost; max_probes losses in a row and the
+  // size is taken to be too large (RFC 8899 MAX_PROBES).
+  std::chrono::milliseconds probe_timeout{1000};
+  std::uint32_t max_probes{3};
+  // After a search completes, search again for more this often (RFC 8899
+  // PMTU_RAISE_TIMER).
+  std::chrono::seconds raise_interval{600};
+  // While above the base size, confirm the path still carries it this often.
+  std::chrono::seconds confirm_interval{30};
+};
+
+enum class PathMtuState : std::uint8_t {
+  kSearching,
+  kSearchComplete,
+};
+
+struct PathMtuStats {
+  std::uint64_t probes_sent{0};
+  std::uint64_t probes_acked{0};
+  std::uint64_t probes_lost{0};
+  // Confirmed sizes that stopped getting through: dropped back to the base size.
+  std::uint64_t black_holes{0};
+};
+
+// Datagram packetization layer PMTU discovery (RFC 8899). The path size starts at a
+// base size known to work and only grows once a padded probe of a larger size is
+// acknowledged, so a path that drops large packets without ICMP (a black hole) costs
+// lost probes, never lost data. The search tries max_size first, the size of a clean
+// path, and halves the remaining range on each failure.
+//
+// Black holes: while above the base, the current size is confirmed every
+// confirm_interval, and at once after a retransmission timeout. If max_probes
+// confirmations in a row are lost, the size falls back to the base and a new search
+// starts below the size that failed.
+class PathMtuProber {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+
+  PathMtuProber(std::size_t base_size, PathMtuConfig config = {});
+
+  // Size of the probe to send now, if one is due. Also expires a lost probe.
+  std::optional<std::size_t> probe_due(TimePoint now);
+
+  // A probe went out: its id and actual size (at most what probe_due() asked for).
+  void on_probe_sent(std::uint32_t id, std::size_t size, TimePoint now);
+
+  // The peer acknowledged probe id.
+  void on_probe_acked(std::uint32_t id, TimePoint now);
+
+  // A retransmission timeout: possibly a black hole, so confirm the size now.
+  void on_timeout_loss(TimePoint now);
+
+  // Largest packet size confirmed to get through (at least the base size).
+  std::size_t path_size() const { return path_size_; }
+  std::size_t base_size() const { return base_size_; }
+  PathMtuState state() const { return state_; }
+  const PathMtuStats& stats() const { return stats_; }
+
+ private:
+  struct InFlight {
+    std::uint32_t id{0};
+    std::size_t size{0};
+    TimePoint sent_at{};
+  };
+
+  void on_probe_failed(std::size_t size, TimePoint now);
+  void complete_search(TimePoint now);
+
+  PathMtuConfig config_;
+  std::size_t base_size_;
+  std::size_t path_size_;
+  PathMtuState state_{PathMtuState::kSearching};
+  // Search range: low_ works, anything above high_ does not.
+  std::size_t low_;
+  std::size_t high_;
+  bool tried_high_{false};
+  // Size being probed (0 if none) and consecutive losses at it.
+  std::size_t target_{0};
+  std::uint32_t failures_{0};
+  // The target is path_size_ itself, to confirm it; or a confirmation is due next.
+  bool confirming_{false};
+  bool confirm_pending_{false};
+  std::optional<InFlight> in_flight_;
+  TimePoint next_probe_at_{};
+  TimePoint raise_at_{};
+  PathMtuStats stats_;
+};
+
+}  // namespace veil::mux
@@ -0,0 +1,318 @@
+#include "transport/mux/payload_compression.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace veil::mux {
+
+namespace {
+
+constexpr std::size_t kMaxInput = 65535;
+// [kCompressedPayload][original size: 2 bytes]
+constexpr std::size_t kHeaderSize = 3;
+
+// LZ4 block format limits: the last 5 bytes are always literals, and the last match
+// starts at least 12 bytes before the end.
+constexpr std::size_t kMinMatch = 4;
+constexpr std::size_t kLastLiterals = 5;
+constexpr std::size_t kMatchLimit = 12;
+constexpr std::size_t kMaxOffset = 65535;
+// Step through input that does not match ever faster: one more byte every 64 misses.
+constexpr unsigned kSkipShift = 6;
+
+// Entropy sample: 4 chunks of 64 bytes spread over the packet past its first 64 bytes,
+// which mostly hold the inner headers. Smaller packets are sampled whole.
+constexpr std::size_t kSampleChunk = 64;
+constexpr std::size_t kSampleChunks = 4;
+constexpr std::size_t kHeaderSkip = 64;
+constexpr std::size_t kMaxSample = kHeaderSkip + kSampleChunks * kSampleChunk;
+
+std::uint32_t read_u32_le(const std::uint8_t* in) {
+  return static_cast<std::uint32_t>(in[0]) | (static_cast<std::uint32_t>(in[1]) << 8) |
+         (static_cast<std::uint32_t>(in[2]) << 16) | (static_cast<std::uint32_t>(in[3]) << 24);
+}
+
+// Extra length bytes after a 15 in the token: 255 while more follow.
+void put_length(std::vector<std::uint8_t>& out, std::size_t length) {
+  for (; length >= 255; length -= 255) {
+    out.push_back(255);
+  }
+  out.push_back(static_cast<std::uint8_t>(length));
+}
+
+bool read_length(std::span<const std::uint8_t> input, std::size_t& pos, std::size_t& length) {
+  std::uint8_t byte = 0;
+  do {
+    if (pos >= input.size()) {
+      return false;
+    }
+    byte = input[pos++];
+    length += byte;
+    if (length > kMaxInput) {
+      return false;
+    }
+  } while (byte == 255);
+  return true;
+}
+
+// One sequence: literals, then a match of match_length bytes offset back (none for the
+// last sequence, match_length 0).
+void put_sequence(std::vector<std::uint8_t>& out, std::span<const std::uint8_t> literals,
+                  std::size_t offset, std::size_t match_length) {
+  const std::size_t literal_code = std::min<std::size_t>(literals.size(), 15);
+  const std::size_t match_code =
+      match_length == 0 ? 0 : std::min<std::size_t>(match_length - kMinMatch, 15);
+  out.push_back(static_cast<std::uint8_t>((literal_code << 4) | match_code));
+  if (literals.size() >= 15) {
+    put_length(out, literals.size() - 15);
+  }
+  out.insert(out.end(), literals.begin(), literals.end());
+  if (match_length != 0) {
+    out.push_back(static_cast<std::uint8_t>(offset));
+    out.push_back(static_cast<std::uint8_t>(offset >> 8));
+    if (match_length - kMinMatch >= 15) {
+      put_length(out, match_length - kMinMatch - 15);
+    }
+  }
+}
+
+std::uint32_t hash_sequence(std::uint32_t sequence, unsigned bits) {
+  return (sequence * 2654435761U) >> (32 - bits);
+}
+
+// Shannon entropy of a sample of the packet, in bits per byte.
+double sample_entropy(std::span<const std::uint8_t> packet) {
+  // c * log2(c) for every count a sample can reach.
+  static const auto kCountLog = [] {
+    std::array<double, kMaxSample + 1> table{};
+    for (std::size_t c = 1; c < table.size(); ++c) {
+      table[c] = static_cast<double>(c) * std::log2(static_cast<double>(c));
+    }
+    return table;
+  }();
+
+  std::array<std::uint16_t, 256> counts{};
+  std::size_t sampled = 0;
+  const auto count = [&](std::span<const std::uint8_t> bytes) {
+    for (const auto byte : bytes) {
+      ++counts[byte];
+    }
+    sampled += bytes.size();
+  };
+  if (packet.size() <= kMaxSample) {
+    count(packet);
+  } else {
+    const std::size_t stride = (packet.size() - kHeaderSkip - kSampleChunk) / (kSampleChunks - 1);
+    for (std::size_t i = 0; i < kSampleChunks; ++i) {
+      count(packet.subspan(kHeaderSkip + i * stride, kSampleChunk));
+    }
+  }
+
+  // H = log2(N) - sum(c * log2(c)) / N
+  double sum = 0;
+  for (const auto c : counts) {
+    sum += kCountLog[c];
+  }
+  const auto n = static_cast<double>(sampled);
+  return std::log2(n) - sum / n;
+}
+
+}  // namespace
+
+std::uint64_t ip_flow_id(std::span<const std::uint8_t> packet) {
+  // FNV-1a over the addresses, protocol and ports.
+  std::uint64_t hash = 14695981039346656037ULL;
+  const auto mix = [&hash](std::span<const std::uint8_t> bytes) {
+    for (const auto byte : bytes) {
+      hash = (hash ^ byte) * 1099511628211ULL;
+    }
+  };
+  const auto has_ports = [](std::uint8_t protocol) { return protocol == 6 || protocol == 17; };
+
+  if (packet.size() >= 20 && (packet[0] >> 4) == 4) {
+    const std::size_t header_size = std::size_t{packet[0] & 0x0FU} * 4;
+    mix(packet.subspan(9, 1));
+    mix(packet.subspan(12, 8));
+    if (has_ports(packet[9]) && packet.size() >= header_size + 4) {
+      mix(packet.subspan(header_size, 4));
+    }
+  } else if (packet.size() >= 40 && (packet[0] >> 4) == 6) {
+    mix(packet.subspan(6, 1));
+    mix(packet.subspan(8, 32));
+    if (has_ports(packet[6]) && packet.size() >= 44) {
+      mix(packet.subspan(40, 4));
+    }
+  }
+  return hash;
+}
+
+bool Lz4Encoder::encode(std::span<const std::uint8_t> input, std::size_t limit,
+                        std::vector<std::uint8_t>& out) {
+  const std::size_t n = input.size();
+  if (n > kMaxInput) {
+    return false;
+  }
+  // Restart the table before positions could wrap.
+  if (base_ > std::numeric_limits<std::uint32_t>::max() - 2 * (kMaxInput + 1)) {
+    table_.fill(0);
+    base_ = 1;
+  }
+
+  std::size_t anchor = 0;
+  std::size_t pos = 0;
+  while (pos + kMatchLimit <= n && out.size() < limit) {
+    const std::uint32_t sequence = read_u32_le(&input[pos]);
+    auto& slot = table_[hash_sequence(sequence, kHashBits)];
+    const std::uint32_t candidate = slot;
+    slot = base_ + static_cast<std::uint32_t>(pos);
+
+    if (candidate >= base_) {
+      const std::size_t match = candidate - base_;
+      if (pos - match <= kMaxOffset && read_u32_le(&input[match]) == sequence) {
+        std::size_t length = kMinMatch;
+        const std::size_t end = n - kLastLiterals;
+        while (pos + length < end && input[match + length] == input[pos + length]) {
+          ++length;
+        }
+        put_sequence(out, input.subspan(anchor, pos - anchor), pos - match, length);
+        pos += length;
+        anchor = pos;
+        continue;
+      }
+    }
+    pos += 1 + ((pos - anchor) >> kSkipShift);
+  }
+  if (out.size() < limit) {
+    put_sequence(out, input.subspan(anchor), 0, 0);
+  }
+
+  base_ += static_cast<std::uint32_t>(n);
+  return out.size() < limit;
+}
+
+bool lz4_decode(std::span<const std::uint8_t> input, std::size_t size,
+                std::vector<std::uint8_t>& out) {
+  out.resize(size);
+  std::size_t in_pos = 0;
+  std::size_t out_pos = 0;
+  while (in_pos < input.size()) {
+    const std::uint8_t token = input[in_pos++];
+
+    std::size_t literals = token >> 4;
+    if (literals == 15 && !read_length(input, in_pos, literals)) {
+      return false;
+    }
+    if (literals > input.size() - in_pos || literals > size - out_pos) {
+      return false;
+    }
+    std::copy_n(input.begin() + static_cast<std::ptrdiff_t>(in_pos), literals,
+                out.begin() + static_cast<std::ptrdiff_t>(out_pos));
+    in_pos += literals;
+    out_pos += literals;
+    if (in_pos == input.size()) {
+      break;  // The last sequence has no match.
+    }
+
+    if (input.size() - in_pos < 2) {
+      return false;
+    }
+    const std::size_t offset = input[in_pos] | (std::size_t{input[in_pos + 1]} << 8);
+    in_pos += 2;
+    std::size_t length = token & 0x0FU;
+    if (length == 15 && !read_length(input, in_pos, length)) {
+      return false;
+    }
+    length += kMinMatch;
+    if (offset == 0 || offset > out_pos || length > size - out_pos) {
+      return false;
+    }
+    const auto dest = out.begin() + static_cast<std::ptrdiff_t>(out_pos);
+    if (offset >= length) {
+      std::copy_n(dest - static_cast<std::ptrdiff_t>(offset), length, dest);
+    } else {
+      // Byte by byte: the match overlaps the bytes it produces.
+      for (std::size_t i = 0; i < length; ++i) {
+        dest[static_cast<std::ptrdiff_t>(i)] = dest[static_cast<std::ptrdiff_t>(i - offset)];
+      }
+    }
+    out_pos += length;
+  }
+  return out_pos == size;
+}
+
+PayloadCompressor::PayloadCompressor(PayloadCompressionConfig config)
+    : config_(config), decisions_(config.flow_cache_size) {}
+
+bool PayloadCompressor::compress(std::uint64_t flow, std::span<const std::uint8_t> packet,
+                                 std::vector<std::uint8_t>& out) {
+  if (packet.size() < config_.min_size || packet.size() > kMaxInput) {
+    return false;
+  }
+
+  FlowDecision* decision = nullptr;
+  bool known_compressible = false;
+  if (!decisions_.empty()) {
+    decision = &decisions_[flow % decisions_.size()];
+    if (decision->flow == flow && decision->skip > 0) {
+      --decision->skip;
+      ++stats_.skipped_cached;
+      return false;
+    }
+    known_compressible = decision->flow == flow && decision->compressible;
+    *decision = FlowDecision{flow, 0, false};
+  }
+  const auto skip_flow = [&] {
+    if (decision != nullptr) {
+      decision->skip = config_.recheck_interval;
+    }
+  };
+
+  if (!known_compressible && sample_entropy(packet) > config_.max_sample_entropy) {
+    ++stats_.skipped_entropy;
+    skip_flow();
+    return false;
+  }
+
+  // Worth it only if it saves at least 1/16 of the packet.
+  const std::size_t limit = packet.size() - packet.size() / 16;
+  out.clear();
+  out.reserve(limit);
+  out.push_back(kCompressedPayload);
+  out.push_back(static_cast<std::uint8_t>(packet.size() >> 8));
+  out.push_back(static_cast<std::uint8_t>(packet.size()));
+  if (!encoder_.encode(packet, limit, out)) {
+    ++stats_.skipped_incompressible;
+    skip_flow();
+    return false;
+  }
+
+  if (decision != nullptr) {
+    decision->compressible = true;
+  }
+  ++stats_.packets_compressed;
+  stats_.bytes_saved += packet.size() - out.size();
+  return true;
+}
+
+bool PayloadDecompressor::decompress(std::vector<std::uint8_t>& packet) {
+  if (packet.empty() || packet[0] != kCompressedPayload) {
+    return true;
+  }
+  const std::size_t size =
+      packet.size() < kHeaderSize ? 0 : (std::size_t{packet[1]} << 8) | packet[2];
+  if (size == 0 ||
+      !lz4_decode(std::span<const std::uint8_t>(packet).subspan(kHeaderSize), size, scratch_)) {
+    ++stats_.decode_errors;
+    return false;
+  }
+  packet.swap(scratch_);
+  ++stats_.packets_decompressed;
+  return true;
+}
+
+}  // namespace veil::mux
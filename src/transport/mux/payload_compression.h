@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace veil::mux {
+
+// Configuration for tunneled payload compression.
+struct PayloadCompressionConfig {
+  // Smaller packets are sent as they are: there is too little to gain.
+  std::size_t min_size{128};
+  // Packets whose sampled byte entropy (bits per byte) is above this are taken for
+  // compressed or encrypted data and not compressed. A 256-byte sample of random data
+  // measures about 7.3; text and telemetry stay well below 6.
+  double max_sample_entropy{7.0};
+  // Flows remembered by the decision cache (slots, a new flow may take over another's).
+  std::size_t flow_cache_size{256};
+  // Packets of a flow found incompressible that are sent as they are before it is tried
+  // again. 0 tests every packet.
+  std::uint32_t recheck_interval{64};
+};
+
+// Statistics for the sending side.
+struct PayloadCompressorStats {
+  std::uint64_t packets_compressed{0};
+  // Bytes saved by compressed packets, after their 3-byte header.
+  std::uint64_t bytes_saved{0};
+  // Packets not compressed: failed the entropy test, did not shrink by 1/16, or belong
+  // to a flow the cache says is incompressible (no work spent on them at all).
+  std::uint64_t skipped_entropy{0};
+  std::uint64_t skipped_incompressible{0};
+  std::uint64_t skipped_cached{0};
+};
+
+// Statistics for the receiving side.
+struct PayloadDecompressorStats {
+  std::uint64_t packets_decompressed{0};
+  // Compressed packets dropped because their block did not decode to the stated size.
+  std::uint64_t decode_errors{0};
+};
+
+// Packet type of a compressed payload. The high nibble never reads as IP version 4 or
+// 6, nor as a header compression type (kHeaderRefresh..kCompressedUdp).
+inline constexpr std::uint8_t kCompressedPayload = 0x50;
+
+// Flow a tunneled IP packet belongs to (addresses, protocol and ports), for the
+// decision cache. Non-IP input hashes to one flow.
+std::uint64_t ip_flow_id(std::span<const std::uint8_t> packet);
+
+// LZ4 block format (lz4.org, "LZ4 Block Format Description"), the fast path only: one
+// hash probe per position, no match search chains.
+class Lz4Encoder {
+ public:
+  // Append the block for input (at most 65535 bytes) to out. Returns false once out
+  // would reach limit bytes; out then holds a partial block.
+  bool encode(std::span<const std::uint8_t> input, std::size_t limit,
+              std::vector<std::uint8_t>& out);
+
+ private:
+  static constexpr unsigned kHashBits = 12;
+
+  // Positions of recent 4-byte sequences, offset by base_: entries below base_ are from
+  // earlier inputs, so the table is never cleared between packets.
+  std::array<std::uint32_t, std::size_t{1} << kHashBits> table_{};
+  std::uint32_t base_{1};
+};
+
+// Decode an LZ4 block that expands to exactly size bytes. Returns false on malformed
+// input (never reads or writes out of bounds).
+bool lz4_decode(std::span<const std::uint8_t> input, std::size_t size,
+                std::vector<std::uint8_t>& out);
+
+// Adaptive payload compression for tunneled packets. A cheap entropy estimate on a
+// sample of each packet keeps compressed or encrypted payloads (TLS, video, archives)
+// away from the encoder, and a per-flow decision cache remembers the outcome: a flow
+// that compressed skips the test, one that did not is sent as it is until
+// recheck_interval packets later.
+//
+// SECURITY: compressing before encryption makes packet sizes depend on content. An
+// attacker who can inject data into a flow next to a secret (CRIME, BREACH) may
+// recover the secret from the sizes. Use only for bulk traffic that carries no such
+// mix, such as logs and telemetry.
+//
+// Compressed: [0x50][original size: 2 bytes, big-endian][LZ4 block]
+class PayloadCompressor {
+ public:
+  explicit PayloadCompressor(PayloadCompressionConfig config = {});
+
+  // Compress a packet of flow (see ip_flow_id()) into out. Returns false if it goes as
+  // it is (out is then unspecified).
+  bool compress(std::uint64_t flow, std::span<const std::uint8_t> packet,
+                std::vector<std::uint8_t>& out);
+
+  const PayloadCompressorStats& stats() const { return stats_; }
+
+ private:
+  struct FlowDecision {
+    std::uint64_t flow{0};
+    // Packets left to send without trying; non-zero means incompressible.
+    std::uint32_t skip{0};
+    // The last packet compressed: the next skips the entropy test.
+    bool compressible{false};
+  };
+
+  PayloadCompressionConfig config_;
+  std::vector<FlowDecision> decisions_;
+  Lz4Encoder encoder_;
+  PayloadCompressorStats stats_;
+};
+
+// Receiving side of PayloadCompressor.
+class PayloadDecompressor {
+ public:
+  // Expand a received packet in place. Uncompressed packets are left as they are.
+  // Returns false if the packet must be dropped.
+  bool decompress(std::vector<std::uint8_t>& packet);
+
+  const PayloadDecompressorStats& stats() const { return stats_; }
+
+ private:
+  std::vector<std::uint8_t> scratch_;
+  PayloadDecompressorStats stats_;
+};
+
+}  // namespace veil::mux
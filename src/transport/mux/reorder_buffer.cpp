@@ -1,5 +1,7 @@
 #include "transport/mux/reorder_buffer.h"
 
+#include <algorithm>
+#include <bit>
 #include <map>
 #include <optional>
 #include <utility>
@@ -7,8 +9,27 @@
 
 namespace veil::mux {
 
-ReorderBuffer::ReorderBuffer(std::uint64_t initial, std::size_t max_bytes)
-    : next_(initial), max_bytes_(max_bytes) {}
+ReorderBuffer::ReorderBuffer(std::uint64_t initial, std::size_t max_bytes, std::size_t window)
+    : next_(initial),
+      max_bytes_(max_bytes),
+      mask_(std::bit_ceil(std::max<std::uint64_t>(window, 64)) - 1),
+      slots_(static_cast<std::size_t>(mask_ + 1)),
+      occupancy_(static_cast<std::size_t>((mask_ + 1) / 64), 0) {}
+
+bool ReorderBuffer::occupied(std::uint64_t seq) const {
+  const auto slot = static_cast<std::size_t>(seq & mask_);
+  return ((occupancy_[slot / 64] >> (slot % 64)) & 1U) != 0;
+}
+
+void ReorderBuffer::set_occupied(std::uint64_t seq, bool value) {
+  const auto slot = static_cast<std::size_t>(seq & mask_);
+  const auto bit = std::uint64_t{1} << (slot % 64);
+  if (value) {
+    occupancy_[slot / 64] |= bit;
+  } else {
+    occupancy_[slot / 64] &= ~bit;
+  }
+}
 
 bool ReorderBuffer::push(std::uint64_t seq, std::vector<std::uint8_t> payload) {
   if (seq < next_) {
@@ -17,21 +38,37 @@ bool ReorderBuffer::push(std::uint64_t seq, std::vector<std::uint8_t> payload) {
   if (buffered_bytes_ + payload.size() > max_bytes_) {
     return false;
   }
-  auto [it, inserted] = buffer_.emplace(seq, std::move(payload));
-  if (inserted) {
-    buffered_bytes_ += it->second.size();
+  const auto size = payload.size();
+  if (seq - next_ > mask_) {
+    // Beyond the ring: rare, so an ordered map is fine.
+    if (!overflow_.emplace(seq, std::move(payload)).second) {
+      return false;
+    }
+  } else {
+    // Every sequence in [next_, next_ + mask_] has its own slot. One pushed while it was
+    // still beyond the ring sits in the overflow map instead.
+    if (occupied(seq) || (!overflow_.empty() && overflow_.count(seq) != 0)) {
+      return false;
+    }
+    slots_[static_cast<std::size_t>(seq & mask_)] = std::move(payload);
+    set_occupied(seq, true);
   }
-  return inserted;
+  buffered_bytes_ += size;
+  return true;
 }
 
 std::optional<std::vector<std::uint8_t>> ReorderBuffer::pop_next() {
-  auto it = buffer_.find(next_);
-  if (it == buffer_.end()) {
+  std::vector<std::uint8_t> payload;
+  if (occupied(next_)) {
+    payload = std::move(slots_[static_cast<std::size_t>(next_ & mask_)]);
+    set_occupied(next_, false);
+  } else if (!overflow_.empty() && overflow_.begin()->first == next_) {
+    payload = std::move(overflow_.begin()->second);
+    overflow_.erase(overflow_.begin());
+  } else {
     return std::nullopt;
   }
-  auto payload = std::move(it->second);
   buffered_bytes_ -= payload.size();
-  buffer_.erase(it);
   ++next_;
   return payload;
 }
@@ -7,19 +7,40 @@
 
 namespace veil::mux {
 
+// Holds payloads that arrive ahead of the next expected sequence and releases them
+// in order.
+//
+// PERFORMANCE: Sequences are dense, so payloads within `window` of the next expected
+// one live in a ring of slots indexed by seq & mask, with an occupancy bitmap: push
+// and pop_next are O(1) and only move the caller's buffer, with no per-packet node
+// allocation or tree lookup. A sequence further ahead than the ring reaches is kept
+// in an ordered overflow map, so nothing is refused that a plain map would accept.
 class ReorderBuffer {
  public:
-  explicit ReorderBuffer(std::uint64_t initial = 0, std::size_t max_bytes = 1 << 20);
+  // Ring slots by default (rounded up to a power of two).
+  static constexpr std::size_t kDefaultWindow = 1024;
 
+  explicit ReorderBuffer(std::uint64_t initial = 0, std::size_t max_bytes = 1 << 20,
+                         std::size_t window = kDefaultWindow);
+
+  // Buffer a payload. Returns false if seq was already released or buffered, or if it
+  // would take the buffer past max_bytes.
   bool push(std::uint64_t seq, std::vector<std::uint8_t> payload);
   std::optional<std::vector<std::uint8_t>> pop_next();
   std::uint64_t next_expected() const { return next_; }
+  std::size_t buffered_bytes() const { return buffered_bytes_; }
 
  private:
+  bool occupied(std::uint64_t seq) const;
+  void set_occupied(std::uint64_t seq, bool value);
+
   std::uint64_t next_;
   std::size_t max_bytes_;
   std::size_t buffered_bytes_{0};
-  std::map<std::uint64_t, std::vector<std::uint8_t>> buffer_;
+  std::uint64_t mask_;
+  std::vector<std::vector<std::uint8_t>> slots_;
+  std::vector<std::uint64_t> occupancy_;
+  std::map<std::uint64_t, std::vector<std::uint8_t>> overflow_;
 };
 
 }  // namespace veil::mux
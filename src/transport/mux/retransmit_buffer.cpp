@@ -12,6 +12,19 @@
 
 namespace veil::mux {
 
+namespace {
+
+// Floor for the tail loss probe timeout, so a tiny RTT does not probe on every tick.
+constexpr std::chrono::milliseconds kMinProbeTimeout{10};
+
+// Most the RACK reordering window is widened for spurious losses (RFC 8985 6.2).
+constexpr std::uint32_t kMaxReorderWindowMult = 4;
+
+// Genuine losses after which a widened reordering window returns to min RTT / 4.
+constexpr std::uint32_t kReorderWindowDecayLosses = 16;
+
+}  // namespace
+
 RetransmitBuffer::RetransmitBuffer(RetransmitConfig config, std::function<TimePoint()> now_fn)
     : config_(config),
       now_fn_(std::move(now_fn)),
@@ -19,6 +32,51 @@ RetransmitBuffer::RetransmitBuffer(RetransmitConfig config, std::function<TimePo
       current_rto_(config_.initial_rtt),
       rate_limit_window_start_(now_fn_()) {}
 
+template <typename Contains>
+std::optional<RetransmitBuffer::AckedCopy> RetransmitBuffer::acked_copy(const PendingPacket& pkt,
+                                                                        Contains contains) {
+  const auto& copies = pkt.earlier_copies;
+  const bool original = contains(copies.empty() ? pkt.sequence : copies.front().sequence);
+  if (copies.empty() ? original : contains(pkt.sequence)) {
+    return AckedCopy{.sequence = pkt.sequence, .sent = pkt.last_sent, .original = original};
+  }
+  for (auto copy = copies.rbegin(); copy != copies.rend(); ++copy) {
+    if (contains(copy->sequence)) {
+      return AckedCopy{.sequence = copy->sequence, .sent = copy->sent, .original = original};
+    }
+  }
+  return std::nullopt;
+}
+
+RetransmitBuffer::PendingMap::iterator RetransmitBuffer::find_pending(std::uint64_t sequence) {
+  auto it = pending_.find(sequence);
+  if (it == pending_.end()) {
+    if (auto retired = retired_.find(sequence); retired != retired_.end()) {
+      it = pending_.find(retired->second);
+    }
+  }
+  return it;
+}
+
+RetransmitBuffer::PendingMap::iterator RetransmitBuffer::erase_pending(PendingMap::iterator it) {
+  sequences_.erase(it->first);
+  if (it->second.suspected) {
+    --suspected_count_;
+  }
+  return pending_.erase(it);
+}
+
+void RetransmitBuffer::collect_ack_candidates(std::uint64_t smallest, std::uint64_t largest) {
+  for (auto it = sequences_.lower_bound(smallest); it != sequences_.end() && *it <= largest;
+       ++it) {
+    ack_candidates_.push_back(*it);
+  }
+  for (auto it = retired_.lower_bound(smallest); it != retired_.end() && it->first <= largest;
+       ++it) {
+    ack_candidates_.push_back(it->second);
+  }
+}
+
 bool RetransmitBuffer::insert(std::uint64_t sequence, std::vector<std::uint8_t> data) {
   // Changed to DEBUG level to avoid performance impact in hot path (Issue #92)
   LOG_DEBUG("RetransmitBuffer::insert: seq={}, size={}, pending_count={}",
@@ -28,6 +86,8 @@ bool RetransmitBuffer::insert(std::uint64_t sequence, std::vector<std::uint8_t>
 
 bool RetransmitBuffer::insert_with_priority(std::uint64_t sequence, std::vector<std::uint8_t> data,
                                              PacketPriority priority) {
+  const std::size_t size = data.size() + config_.packet_overhead;
+
   // Check rate limit first.
   if (!check_rate_limit()) {
     ++stats_.packets_dropped_rate_limit;
@@ -38,7 +98,7 @@ bool RetransmitBuffer::insert_with_priority(std::uint64_t sequence, std::vector<
   // Check pending count limit.
   if (config_.max_pending_count > 0 && pending_.size() >= config_.max_pending_count) {
     // Try to make room.
-    if (!make_room(data.size())) {
+    if (!make_room(size)) {
       ++stats_.packets_dropped_buffer_full;
       ++stats_.packets_dropped;
       return false;
@@ -46,9 +106,9 @@ bool RetransmitBuffer::insert_with_priority(std::uint64_t sequence, std::vector<
   }
 
   // Check buffer size.
-  if (buffered_bytes_ + data.size() > config_.max_buffer_bytes) {
+  if (buffered_bytes_ + size > config_.max_buffer_bytes) {
     // Try to make room according to drop policy.
-    if (!make_room(data.size())) {
+    if (!make_room(size)) {
       ++stats_.packets_dropped_buffer_full;
       ++stats_.packets_dropped;
       return false;
@@ -68,94 +128,208 @@ bool RetransmitBuffer::insert_with_priority(std::uint64_t sequence, std::vector<
 
   const auto now = now_fn_();
   const auto rto = current_rto_;
+  if (pending_.empty()) {
+    // Nothing in flight: a delivery-rate interval cannot span the idle time.
+    delivered_time_ = now;
+    send_interval_start_ = now;
+  }
   PendingPacket pkt{
       .sequence = sequence,
       .data = std::move(data),
       .first_sent = now,
       .last_sent = now,
+      .first_retransmitted = {},
       .next_retry = now + rto,
       .retry_count = 0,
       .priority = priority,
+      .delivered = delivered_,
+      .delivered_time = delivered_time_,
+      .send_interval_start = send_interval_start_,
   };
 
-  buffered_bytes_ += pkt.data.size();
-  stats_.bytes_sent += pkt.data.size();
+  buffered_bytes_ += size;
+  stats_.bytes_sent += size;
   ++stats_.packets_sent;
   pending_.emplace(sequence, std::move(pkt));
+  sequences_.insert(sequence);
+  probe_anchor_ = now;
   return true;
 }
 
 bool RetransmitBuffer::acknowledge(std::uint64_t sequence) {
-  auto it = pending_.find(sequence);
+  auto it = find_pending(sequence);
   if (it == pending_.end()) {
     return false;
   }
 
   const auto& pkt = it->second;
-  // Only update RTT if this wasn't retransmitted (Karn's algorithm).
-  if (pkt.retry_count == 0) {
-    const auto now = now_fn_();
-    const auto rtt_sample = std::chrono::duration_cast<std::chrono::milliseconds>(now - pkt.first_sent);
+  const auto now = now_fn_();
+  const auto copy = *acked_copy(pkt, [sequence](std::uint64_t seq) { return seq == sequence; });
+  // Only update RTT if the ACK names the copy (Karn's algorithm).
+  if (!pkt.ambiguous) {
+    const auto rtt_sample = std::chrono::duration_cast<std::chrono::milliseconds>(now - copy.sent);
     update_rtt(rtt_sample);
   }
+  record_delivery(pkt, copy, now);
+  record_acked(pkt, copy, now);
 
-  buffered_bytes_ -= pkt.data.size();
+  buffered_bytes_ -= wire_size(pkt);
   ++stats_.packets_acked;
-  pending_.erase(it);
+  erase_pending(it);
   return true;
 }
 
 void RetransmitBuffer::acknowledge_cumulative(std::uint64_t sequence) {
-  // Issue #96: With unordered_map, we need to iterate all entries and check sequence.
-  // This is still efficient because cumulative ACKs typically acknowledge many packets
-  // at once, and the O(1) insert/find/erase on the hot path (per-packet) is more important
-  // than O(n) iteration here.
-
   // Debug logging for cumulative ACK (Issue #72)
   // Changed to DEBUG level to avoid performance impact in hot path (Issue #92)
-  [[maybe_unused]] std::uint64_t min_pending = 0;
-  [[maybe_unused]] std::uint64_t max_pending = 0;
-  if (!pending_.empty()) {
-    min_pending = pending_.begin()->first;
-    max_pending = pending_.begin()->first;
-    for (const auto& [seq, pkt] : pending_) {
-      if (seq < min_pending) min_pending = seq;
-      if (seq > max_pending) max_pending = seq;
-    }
-  }
   LOG_DEBUG("acknowledge_cumulative: ack_seq={}, pending_count={}, pending_range=[{}, {}]",
-            sequence, pending_.size(), min_pending, max_pending);
+            sequence, pending_.size(), sequences_.empty() ? 0 : *sequences_.begin(),
+            sequences_.empty() ? 0 : *sequences_.rbegin());
 
   [[maybe_unused]] std::size_t acked_count = 0;
-  // Iterate and erase entries with sequence <= ack sequence.
-  for (auto it = pending_.begin(); it != pending_.end();) {
-    if (it->first <= sequence) {
-      const auto& pkt = it->second;
-      LOG_DEBUG("  Acknowledging packet seq={}", it->first);
-      if (pkt.retry_count == 0) {
-        const auto now = now_fn_();
+  const auto now = now_fn_();
+  // Only packets sent under a sequence <= ack sequence: walk the oldest up to it.
+  ack_candidates_.clear();
+  collect_ack_candidates(0, sequence);
+  for (const auto candidate : ack_candidates_) {
+    const auto it = pending_.find(candidate);
+    if (it == pending_.end()) {
+      continue;
+    }
+    const auto& pkt = it->second;
+    const auto copy = acked_copy(pkt, [sequence](std::uint64_t seq) { return seq <= sequence; });
+    if (copy) {
+      LOG_DEBUG("  Acknowledging packet seq={}", copy->sequence);
+      if (!pkt.ambiguous) {
         const auto rtt_sample =
-            std::chrono::duration_cast<std::chrono::milliseconds>(now - pkt.first_sent);
+            std::chrono::duration_cast<std::chrono::milliseconds>(now - copy->sent);
         update_rtt(rtt_sample);
       }
-      buffered_bytes_ -= pkt.data.size();
+      record_delivery(pkt, *copy, now);
+      record_acked(pkt, *copy, now);
+      buffered_bytes_ -= wire_size(pkt);
       ++stats_.packets_acked;
       ++acked_count;
-      it = pending_.erase(it);
-    } else {
-      ++it;
+      erase_pending(it);
     }
   }
   LOG_DEBUG("acknowledge_cumulative done: acked={} packets", acked_count);
 }
 
+AckRangesResult RetransmitBuffer::acknowledge_ranges(std::span<const AckRange> ranges,
+                                                     std::chrono::microseconds ack_delay) {
+  AckRangesResult result;
+  if (ranges.empty()) {
+    return result;
+  }
+
+  const auto now = now_fn_();
+  const auto largest = ranges.front().largest;
+  if (auto it = find_pending(largest); it != pending_.end()) {
+    const auto& pkt = it->second;
+    const auto copy = *acked_copy(pkt, [largest](std::uint64_t seq) { return seq == largest; });
+    // Karn's algorithm: no sample unless the ACK names the copy. The receiver's ACK delay
+    // is not path delay; drop it unless it would swallow the whole sample.
+    if (!pkt.ambiguous) {
+      auto rtt_sample = now - copy.sent;
+      if (rtt_sample > ack_delay) {
+        rtt_sample -= ack_delay;
+      }
+      update_rtt(std::chrono::duration_cast<std::chrono::milliseconds>(rtt_sample));
+    }
+    largest_acked_sent_time_ = std::max(largest_acked_sent_time_, copy.sent);
+  }
+
+  // PERFORMANCE: Walk only the pending sequences inside the ranges, not every packet
+  // in flight.
+  ack_candidates_.clear();
+  for (const auto& range : ranges) {
+    collect_ack_candidates(range.smallest, range.largest);
+  }
+  const auto in_ranges = [ranges](std::uint64_t seq) { return ack_ranges_contain(ranges, seq); };
+  for (const auto candidate : ack_candidates_) {
+    const auto it = pending_.find(candidate);
+    if (it == pending_.end()) {
+      continue;
+    }
+    const auto& pkt = it->second;
+    const auto copy = acked_copy(pkt, in_ranges);
+    if (!copy) {
+      continue;
+    }
+    result.acked_bytes += wire_size(pkt);
+    ++result.acked_packets;
+    record_delivery(pkt, *copy, now);
+    if (record_acked(pkt, *copy, now)) {
+      ++result.spurious_losses;
+    } else if (pkt.suspected) {
+      ++result.genuine_losses;
+    }
+    buffered_bytes_ -= wire_size(pkt);
+    ++stats_.packets_acked;
+    erase_pending(it);
+  }
+  largest_acked_ = std::max(largest_acked_, largest);
+
+  mark_lost_packets(now, result);
+
+  LOG_DEBUG("acknowledge_ranges: largest={}, ranges={}, acked={}, lost={}", largest,
+            ranges.size(), result.acked_packets, result.lost_packets);
+  return result;
+}
+
+AckRangesResult RetransmitBuffer::detect_lost_packets() {
+  AckRangesResult result;
+  mark_lost_packets(now_fn_(), result);
+  return result;
+}
+
+std::optional<RateSample> RetransmitBuffer::take_rate_sample() {
+  if (!rate_sample_pending_) {
+    return std::nullopt;
+  }
+  rate_sample_pending_ = false;
+
+  RateSample sample;
+  sample.delivered = static_cast<std::size_t>(delivered_ - rate_prior_delivered_);
+  sample.interval = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::max(rate_send_elapsed_, delivered_time_ - rate_prior_time_));
+  if (sample.interval.count() > 0) {
+    sample.delivery_rate = static_cast<std::uint64_t>(sample.delivered) * 1000000 /
+                           static_cast<std::uint64_t>(sample.interval.count());
+  }
+  sample.rtt = rate_rtt_;
+  sample.prior_delivered = rate_prior_delivered_;
+  sample.bytes_in_flight = buffered_bytes_;
+  return sample;
+}
+
 std::vector<const PendingPacket*> RetransmitBuffer::get_packets_to_retransmit() {
   std::vector<const PendingPacket*> result;
   const auto now = now_fn_();
-  for (const auto& [seq, pkt] : pending_) {
+  PendingPacket* newest = nullptr;
+  bool in_recovery = false;
+  for (auto& [seq, pkt] : pending_) {
     if (now >= pkt.next_retry) {
       result.push_back(&pkt);
     }
+    if (newest == nullptr || seq > newest->sequence) {
+      newest = &pkt;
+    }
+    in_recovery = in_recovery || pkt.retry_count > 0 || pkt.lost;
+  }
+
+  // Tail loss probe: one per silence, and not while losses are already being repaired.
+  // The probe timeout is two smoothed RTTs; when the RTO is shorter it fires first.
+  if (config_.enable_tail_loss_probe && result.empty() && newest != nullptr &&
+      !in_recovery && !probe_outstanding_) {
+    const auto probe_timeout = std::max<Duration>(2 * estimated_rtt_, kMinProbeTimeout);
+    if (now >= probe_anchor_ + probe_timeout) {
+      newest->probe = true;
+      probe_outstanding_ = true;
+      ++stats_.tail_loss_probes;
+      result.push_back(newest);
+    }
   }
   return result;
 }
@@ -165,9 +339,51 @@ bool RetransmitBuffer::mark_retransmitted(std::uint64_t sequence) {
   if (it == pending_.end()) {
     return false;
   }
+  it->second.ambiguous = true;
+  return record_retransmission(it->second);
+}
+
+bool RetransmitBuffer::mark_retransmitted(std::uint64_t sequence, std::uint64_t new_sequence) {
+  if (new_sequence == sequence) {
+    return mark_retransmitted(sequence);
+  }
+  auto it = pending_.find(sequence);
+  if (it == pending_.end() || pending_.count(new_sequence) != 0) {
+    return false;
+  }
+  const SentCopy previous{.sequence = sequence, .sent = it->second.last_sent};
+  if (!record_retransmission(it->second)) {
+    return false;
+  }
 
-  auto& pkt = it->second;
+  // Re-key the entry; the node keeps its address, so PendingPacket pointers from
+  // get_packets_to_retransmit() stay valid.
+  auto node = pending_.extract(it);
+  auto& pkt = node.mapped();
+  pkt.earlier_copies.push_back(previous);
+  for (const auto& copy : pkt.earlier_copies) {
+    retired_[copy.sequence] = new_sequence;
+  }
+  pkt.sequence = new_sequence;
+  node.key() = new_sequence;
+  pending_.insert(std::move(node));
+  sequences_.erase(sequence);
+  sequences_.insert(new_sequence);
+  return true;
+}
+
+bool RetransmitBuffer::record_retransmission(PendingPacket& pkt) {
+  if (pkt.retry_count == 0) {
+    pkt.first_retransmitted = now_fn_();
+  }
   ++pkt.retry_count;
+  // A probe is not a loss: only a loss or a timeout makes the packet suspected.
+  if (!pkt.suspected && !pkt.probe) {
+    pkt.suspected = true;
+    ++suspected_count_;
+  }
+  pkt.lost = false;
+  pkt.probe = false;
   if (pkt.retry_count > config_.max_retries) {
     return false;  // Exceeded max retries
   }
@@ -182,20 +398,155 @@ bool RetransmitBuffer::mark_retransmitted(std::uint64_t sequence) {
   const auto now = now_fn_();
   pkt.last_sent = now;
   pkt.next_retry = now + std::chrono::milliseconds(capped_backoff);
+  pkt.delivered = delivered_;
+  pkt.delivered_time = delivered_time_;
+  pkt.send_interval_start = send_interval_start_;
 
-  stats_.bytes_retransmitted += pkt.data.size();
+  stats_.bytes_retransmitted += wire_size(pkt);
   ++stats_.packets_retransmitted;
   return true;
 }
 
 void RetransmitBuffer::drop_packet(std::uint64_t sequence) {
-  auto it = pending_.find(sequence);
+  auto it = find_pending(sequence);
   if (it == pending_.end()) {
     return;
   }
-  buffered_bytes_ -= it->second.data.size();
+  record_dropped(it->second);
+  buffered_bytes_ -= wire_size(it->second);
   ++stats_.packets_dropped;
-  pending_.erase(it);
+  erase_pending(it);
+}
+
+void RetransmitBuffer::record_delivery(const PendingPacket& pkt, const AckedCopy& copy,
+                                       TimePoint now) {
+  delivered_ += wire_size(pkt);
+  delivered_time_ = now;
+  // The sample is taken over the newest packet acknowledged: the one sent last.
+  if (rate_sample_pending_ &&
+      (pkt.delivered < rate_prior_delivered_ ||
+       (pkt.delivered == rate_prior_delivered_ && pkt.last_sent < send_interval_start_))) {
+    return;
+  }
+  rate_sample_pending_ = true;
+  rate_prior_delivered_ = pkt.delivered;
+  rate_prior_time_ = pkt.delivered_time;
+  rate_send_elapsed_ = pkt.last_sent - pkt.send_interval_start;
+  rate_rtt_ = pkt.ambiguous
+                  ? std::chrono::microseconds{0}
+                  : std::chrono::duration_cast<std::chrono::microseconds>(now - copy.sent);
+  send_interval_start_ = std::max(send_interval_start_, pkt.last_sent);
+}
+
+bool RetransmitBuffer::record_acked(const PendingPacket& pkt, const AckedCopy& copy,
+                                    TimePoint now) {
+  probe_anchor_ = now;
+  probe_outstanding_ = false;
+  forget_copies(pkt);
+
+  const auto rtt = now - copy.sent;
+  if (!pkt.ambiguous) {
+    min_rtt_ = min_rtt_ == Duration::zero() ? rtt : std::min(min_rtt_, rtt);
+  }
+  // A packet retransmitted under its own sequence leaves the copy to be inferred. No
+  // transmission can be acknowledged sooner than the minimum RTT after it was sent
+  // (RFC 8985 6.2 step 2). An ACK that soon after the latest retransmission is for an
+  // earlier copy, whose send time is unknown, so it cannot advance RACK. One that soon
+  // after the first retransmission is for the original (Eifel-style detection).
+  const auto too_soon = [this](Duration elapsed) {
+    return min_rtt_ > Duration::zero() && elapsed < min_rtt_;
+  };
+  const bool acks_original =
+      pkt.ambiguous ? too_soon(now - pkt.first_retransmitted) : copy.original;
+
+  if (!pkt.ambiguous || !too_soon(rtt)) {
+    if (!rack_valid_ || copy.sent > rack_xmit_time_ ||
+        (copy.sent == rack_xmit_time_ && copy.sequence > rack_sequence_)) {
+      rack_valid_ = true;
+      rack_xmit_time_ = copy.sent;
+      rack_sequence_ = copy.sequence;
+      rack_rtt_ = rtt;
+    }
+  }
+  if (pkt.retry_count == 0 && !pkt.lost && pkt.sequence < largest_acked_) {
+    reordering_seen_ = true;
+  }
+
+  if (!pkt.suspected) {
+    return false;
+  }
+  if (!acks_original) {
+    ++stats_.genuine_losses;
+    // Reordering is transient: the widened window decays after enough real losses.
+    if (++genuine_since_widening_ >= kReorderWindowDecayLosses) {
+      reorder_window_mult_ = 1;
+      genuine_since_widening_ = 0;
+    }
+    return false;
+  }
+  ++stats_.spurious_losses;
+  if (pkt.declared_lost) {
+    // The packet was only reordered: allow more before the next declaration.
+    reordering_seen_ = true;
+    reorder_window_mult_ = std::min(reorder_window_mult_ + 1, kMaxReorderWindowMult);
+    genuine_since_widening_ = 0;
+  }
+  LOG_DEBUG("Spurious loss of seq={}, reorder window x{}", pkt.sequence, reorder_window_mult_);
+  return true;
+}
+
+void RetransmitBuffer::record_dropped(const PendingPacket& pkt) {
+  forget_copies(pkt);
+  if (pkt.suspected) {
+    ++stats_.genuine_losses;
+  }
+}
+
+void RetransmitBuffer::forget_copies(const PendingPacket& pkt) {
+  for (const auto& copy : pkt.earlier_copies) {
+    retired_.erase(copy.sequence);
+  }
+}
+
+void RetransmitBuffer::mark_lost_packets(TimePoint now, AckRangesResult& result) {
+  const auto window = reorder_window();
+  // Sequences increase with send time, so a packet past both the largest acknowledged
+  // sequence and the RACK packet was sent after them and cannot be lost by either rule.
+  const auto end = sequences_.upper_bound(std::max(largest_acked_, rack_sequence_));
+  for (auto seq_it = sequences_.begin(); seq_it != end; ++seq_it) {
+    const auto seq = *seq_it;
+    auto& pkt = pending_.find(seq)->second;
+    if (pkt.lost) {
+      continue;
+    }
+    const bool by_count = !reordering_seen_ && seq + config_.reorder_threshold <= largest_acked_ &&
+                          pkt.last_sent <= largest_acked_sent_time_;
+    // RACK: sent before the newest delivered packet, and older than its RTT plus the
+    // reordering window.
+    const bool by_time =
+        config_.enable_rack && rack_valid_ &&
+        (pkt.last_sent < rack_xmit_time_ ||
+         (pkt.last_sent == rack_xmit_time_ && seq < rack_sequence_)) &&
+        now >= pkt.last_sent + rack_rtt_ + window;
+    if (!by_count && !by_time) {
+      continue;
+    }
+    pkt.lost = true;
+    if (!pkt.suspected) {
+      pkt.suspected = true;
+      ++suspected_count_;
+    }
+    pkt.declared_lost = true;
+    pkt.next_retry = now;
+    ++result.lost_packets;
+    result.largest_lost = std::max(result.largest_lost, seq);
+    ++stats_.packets_declared_lost;
+  }
+}
+
+RetransmitBuffer::Duration RetransmitBuffer::reorder_window() const {
+  const Duration window = min_rtt_ / 4 * reorder_window_mult_;
+  return std::min<Duration>(window, estimated_rtt_);
 }
 
 void RetransmitBuffer::update_rtt(std::chrono::milliseconds sample) {
@@ -243,20 +594,14 @@ bool RetransmitBuffer::make_room(std::size_t bytes_needed) {
       return false;
 
     case DropPolicy::kOldest: {
-      // Issue #96: With unordered_map, we need to find the oldest packet manually.
       // Drop oldest packets (lowest sequence numbers) until we have room.
       while (!pending_.empty() && buffered_bytes_ + bytes_needed > config_.max_buffer_bytes) {
-        // Find the entry with the lowest sequence number.
-        auto oldest_it = pending_.begin();
-        for (auto it = pending_.begin(); it != pending_.end(); ++it) {
-          if (it->first < oldest_it->first) {
-            oldest_it = it;
-          }
-        }
-        buffered_bytes_ -= oldest_it->second.data.size();
+        const auto oldest_it = pending_.find(*sequences_.begin());
+        record_dropped(oldest_it->second);
+        buffered_bytes_ -= wire_size(oldest_it->second);
         ++stats_.packets_dropped_buffer_full;
         ++stats_.packets_dropped;
-        pending_.erase(oldest_it);
+        erase_pending(oldest_it);
       }
       return buffered_bytes_ + bytes_needed <= config_.max_buffer_bytes;
     }
@@ -269,10 +614,11 @@ bool RetransmitBuffer::make_room(std::size_t bytes_needed) {
           return true;
         }
         if (it->second.priority == PacketPriority::kLow) {
-          buffered_bytes_ -= it->second.data.size();
+          record_dropped(it->second);
+          buffered_bytes_ -= wire_size(it->second);
           ++stats_.packets_dropped_buffer_full;
           ++stats_.packets_dropped;
-          it = pending_.erase(it);
+          it = erase_pending(it);
         } else {
           ++it;
         }
@@ -284,10 +630,11 @@ bool RetransmitBuffer::make_room(std::size_t bytes_needed) {
           return true;
         }
         if (it->second.priority == PacketPriority::kNormal) {
-          buffered_bytes_ -= it->second.data.size();
+          record_dropped(it->second);
+          buffered_bytes_ -= wire_size(it->second);
           ++stats_.packets_dropped_buffer_full;
           ++stats_.packets_dropped;
-          it = pending_.erase(it);
+          it = erase_pending(it);
         } else {
           ++it;
         }
@@ -299,10 +646,11 @@ bool RetransmitBuffer::make_room(std::size_t bytes_needed) {
           return true;
         }
         if (it->second.priority == PacketPriority::kHigh) {
-          buffered_bytes_ -= it->second.data.size();
+          record_dropped(it->second);
+          buffered_bytes_ -= wire_size(it->second);
           ++stats_.packets_dropped_buffer_full;
           ++stats_.packets_dropped;
-          it = pending_.erase(it);
+          it = erase_pending(it);
         } else {
           ++it;
         }
@@ -351,11 +699,12 @@ std::size_t RetransmitBuffer::force_cleanup(std::size_t target_bytes) {
       break;
     }
     if (it->second.retry_count > config_.max_retries) {
-      buffered_bytes_ -= it->second.data.size();
+      record_dropped(it->second);
+      buffered_bytes_ -= wire_size(it->second);
       ++stats_.packets_dropped_max_retries;
       ++stats_.packets_dropped;
       ++dropped;
-      it = pending_.erase(it);
+      it = erase_pending(it);
     } else {
       ++it;
     }
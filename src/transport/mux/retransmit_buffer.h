@@ -3,10 +3,15 @@
 #include <chrono>
 #include <cstdint>
 #include <functional>
+#include <map>
 #include <optional>
+#include <set>
+#include <span>
 #include <unordered_map>
 #include <vector>
 
+#include "transport/mux/ack_ranges.h"
+
 namespace veil::mux {
 
 // Drop policy when buffer is full.
@@ -34,6 +39,21 @@ struct RetransmitConfig {
   double rtt_alpha{0.125};
   // RTT variance factor (beta for EWMA).
   double rtt_beta{0.25};
+  // Packets acknowledged above an unacknowledged one before acknowledge_ranges()
+  // declares it lost (RFC 9002 kPacketThreshold).
+  std::uint32_t reorder_threshold{3};
+  // Also declare a packet lost once one sent after it is acknowledged and a reordering
+  // window of min RTT / 4 has passed (RFC 8985 RACK). Counts alone cannot catch a lost
+  // retransmission or the tail of a burst; the window widens each time a loss turns
+  // out to be reordering.
+  bool enable_rack{true};
+  // When nothing has been acknowledged for two smoothed RTTs, resend the newest packet
+  // so its ACK exposes losses at the tail of a burst before the RTO (RFC 8985 TLP).
+  bool enable_tail_loss_probe{true};
+  // Bytes a packet occupies on the wire beyond its data, when data is the plaintext
+  // rather than the sent bytes (the session's sequence prefix and AEAD tag). Counted in
+  // buffered_bytes() and delivery-rate samples.
+  std::size_t packet_overhead{0};
 
   // ========== Hardening options (Stage 4) ==========
 
@@ -59,15 +79,43 @@ enum class PacketPriority : std::uint8_t {
   kCritical = 3   // Never drop (handshake, session setup)
 };
 
+// One transmission of a packet: the sequence it was sent under and when.
+struct SentCopy {
+  std::uint64_t sequence{0};
+  std::chrono::steady_clock::time_point sent;
+};
+
 // Entry representing a packet awaiting acknowledgment.
 struct PendingPacket {
   std::uint64_t sequence{0};
   std::vector<std::uint8_t> data;
   std::chrono::steady_clock::time_point first_sent;
   std::chrono::steady_clock::time_point last_sent;
+  // When first retransmitted (valid once retry_count > 0).
+  std::chrono::steady_clock::time_point first_retransmitted;
   std::chrono::steady_clock::time_point next_retry;
   std::uint32_t retry_count{0};
   PacketPriority priority{PacketPriority::kNormal};  // For drop policy
+  // Declared lost by acknowledge_ranges(); due now rather than at next_retry's RTO.
+  bool lost{false};
+  // Due as a tail loss probe rather than as a loss.
+  bool probe{false};
+  // Declared lost or retransmitted on timeout at least once; whether that was spurious
+  // is settled when the packet is acknowledged. A spurious declaration means the path
+  // reorders; a spurious timeout only that the ACK was late or lost.
+  bool suspected{false};
+  bool declared_lost{false};
+  // Earlier transmissions, oldest first, when the packet was retransmitted under new
+  // sequences; sequence is the latest. An ACK of any of them names the copy that arrived.
+  std::vector<SentCopy> earlier_copies{};
+  // Retransmitted under its own sequence at least once: an ACK does not say which copy
+  // arrived (Karn's problem), so it gives no RTT sample.
+  bool ambiguous{false};
+  // Delivery-rate state when last sent (see RateSample): bytes delivered so far, when the
+  // latest of them was acknowledged, and the send time of the newest packet acknowledged.
+  std::uint64_t delivered{0};
+  std::chrono::steady_clock::time_point delivered_time;
+  std::chrono::steady_clock::time_point send_interval_start;
 };
 
 // Statistics for observability.
@@ -78,6 +126,15 @@ struct RetransmitStats {
   std::uint64_t packets_dropped{0};
   std::uint64_t bytes_sent{0};
   std::uint64_t bytes_retransmitted{0};
+  // Packets declared lost from ACK ranges (retransmitted without waiting for the RTO).
+  std::uint64_t packets_declared_lost{0};
+  // Suspected losses that turned out to be reordering or delay: the original
+  // transmission was acknowledged. And those that were real: only a retransmission was,
+  // or the packet was given up on.
+  std::uint64_t spurious_losses{0};
+  std::uint64_t genuine_losses{0};
+  // Tail loss probes sent.
+  std::uint64_t tail_loss_probes{0};
 
   // Hardening statistics.
   std::uint64_t packets_dropped_buffer_full{0};
@@ -87,6 +144,37 @@ struct RetransmitStats {
   std::uint64_t high_water_mark_hits{0};
 };
 
+// Outcome of RetransmitBuffer::acknowledge_ranges().
+struct AckRangesResult {
+  std::size_t acked_packets{0};
+  std::size_t acked_bytes{0};
+  // Packets newly declared lost, and the largest of their sequences.
+  std::size_t lost_packets{0};
+  std::uint64_t largest_lost{0};
+  // Acknowledged packets whose loss had been suspected, by outcome (see RetransmitStats).
+  std::size_t spurious_losses{0};
+  std::size_t genuine_losses{0};
+};
+
+// Delivery rate over the packets acknowledged since the last take_rate_sample(), as in
+// draft-cheng-iccrg-delivery-rate-estimation. The interval is the longer of the send
+// and ACK intervals of the newest acknowledged packet, so ACK compression cannot
+// overstate the rate.
+struct RateSample {
+  std::size_t delivered{0};
+  std::chrono::microseconds interval{0};
+  // Bytes per second; 0 when the interval is empty.
+  std::uint64_t delivery_rate{0};
+  // RTT of the newest acknowledged packet; 0 if it was retransmitted under its own
+  // sequence (Karn's algorithm).
+  std::chrono::microseconds rtt{0};
+  // Total bytes delivered when that packet was sent. Round trips are counted by this
+  // passing the delivered total seen at the start of the previous round.
+  std::uint64_t prior_delivered{0};
+  // Bytes still awaiting acknowledgment.
+  std::size_t bytes_in_flight{0};
+};
+
 /**
  * Manages a buffer of unacknowledged packets with RTT estimation and retransmission.
  *
@@ -116,26 +204,61 @@ class RetransmitBuffer {
                             PacketPriority priority);
 
   // Acknowledge a packet. Updates RTT estimate and removes from buffer.
-  // Returns true if the sequence was found and acknowledged.
+  // Returns true if the sequence was found and acknowledged. The sequence may be one a
+  // packet was sent under before it was retransmitted under a new one.
   bool acknowledge(std::uint64_t sequence);
 
   // Acknowledge all packets up to and including sequence (cumulative ACK).
   void acknowledge_cumulative(std::uint64_t sequence);
 
+  // Acknowledge every pending packet inside the ranges (descending, as in AckRangesFrame),
+  // under its current sequence or an earlier one.
+  // The RTT sample comes from the largest acknowledged packet less the receiver's
+  // ack_delay. Pending packets at least reorder_threshold below the largest acknowledged,
+  // and last sent no later than it, are declared lost and become due immediately, so a
+  // loss burst is repaired within one round trip instead of by successive RTOs. Once
+  // reordering has been seen only the RACK time rule applies (see enable_rack).
+  AckRangesResult acknowledge_ranges(std::span<const AckRange> ranges,
+                                     std::chrono::microseconds ack_delay);
+
+  // Declare lost the packets whose RACK reordering window has passed since the last
+  // ACK. Call before get_packets_to_retransmit(); only lost_packets and largest_lost
+  // are set.
+  AckRangesResult detect_lost_packets();
+
+  // Pending packets whose loss is suspected and not yet settled (see
+  // PendingPacket::suspected).
+  std::size_t suspected_count() const { return suspected_count_; }
+
+  // Delivery-rate sample covering the packets acknowledged since the previous call, or
+  // nullopt if none were. Feeds model-based congestion control (BbrController).
+  std::optional<RateSample> take_rate_sample();
+
   // Get packets that need retransmission now.
-  // Returns references to packets whose next_retry has passed.
+  // Returns references to packets whose next_retry has passed. If none are and ACKs have
+  // stopped for the probe timeout, returns the newest packet as a tail loss probe.
   std::vector<const PendingPacket*> get_packets_to_retransmit();
 
   // Mark a packet as retransmitted (updates retry count and next_retry time).
   // Returns false if max retries exceeded (packet should be dropped).
   bool mark_retransmitted(std::uint64_t sequence);
 
+  // Mark a packet as retransmitted under new_sequence, which it is tracked by from now
+  // on. An ACK of the old sequence still acknowledges it, and says the earlier copy
+  // arrived, so every ACK gives an RTT sample and a spurious loss is recognised exactly.
+  // Returns false, without the new sequence, if max retries exceeded.
+  bool mark_retransmitted(std::uint64_t sequence, std::uint64_t new_sequence);
+
   // Remove a packet that has exceeded max retries.
   void drop_packet(std::uint64_t sequence);
 
   // Get current RTT estimate.
   std::chrono::milliseconds estimated_rtt() const { return estimated_rtt_; }
 
+  // Feed an RTT sample taken outside the buffer (an acknowledged datagram) into the
+  // same estimate and RTO.
+  void add_rtt_sample(std::chrono::milliseconds sample) { update_rtt(sample); }
+
   // Get current RTO (retransmit timeout).
   std::chrono::milliseconds current_rto() const { return current_rto_; }
 
@@ -168,9 +291,60 @@ class RetransmitBuffer {
   }
 
  private:
+  using PendingMap = std::unordered_map<std::uint64_t, PendingPacket>;
+
+  // The transmission of a packet an ACK covered, and whether the original one did.
+  struct AckedCopy {
+    std::uint64_t sequence{0};
+    TimePoint sent{};
+    bool original{false};
+  };
+
+  // The newest transmission of pkt whose sequence satisfies contains, if any.
+  template <typename Contains>
+  static std::optional<AckedCopy> acked_copy(const PendingPacket& pkt, Contains contains);
+
+  // Pending packet sent under sequence, now or before a retransmission.
+  PendingMap::iterator find_pending(std::uint64_t sequence);
+
+  // Remove a pending packet from pending_, sequences_ and suspected_count_.
+  PendingMap::iterator erase_pending(PendingMap::iterator it);
+
+  // Append to ack_candidates_ the current sequence of each pending packet sent under a
+  // sequence in [smallest, largest], now or before a retransmission. A packet may be
+  // listed twice.
+  void collect_ack_candidates(std::uint64_t smallest, std::uint64_t largest);
+
+  // Retry count, backoff and delivery-rate state for a retransmission of pkt.
+  bool record_retransmission(PendingPacket& pkt);
+
+  // Bytes pkt occupies on the wire.
+  std::size_t wire_size(const PendingPacket& pkt) const {
+    return pkt.data.size() + config_.packet_overhead;
+  }
+
   void update_rtt(std::chrono::milliseconds sample);
   std::chrono::milliseconds calculate_rto() const;
 
+  // Account an acknowledged packet for delivery-rate estimation.
+  void record_delivery(const PendingPacket& pkt, const AckedCopy& copy, TimePoint now);
+
+  // Loss-detection bookkeeping for an acknowledged packet: min RTT, RACK state, probe
+  // timer, and the outcome of a suspected loss. Returns true if that loss was spurious.
+  bool record_acked(const PendingPacket& pkt, const AckedCopy& copy, TimePoint now);
+
+  // Count a suspected packet removed without acknowledgment as a genuine loss.
+  void record_dropped(const PendingPacket& pkt);
+
+  // Forget the earlier sequences of a packet leaving the buffer.
+  void forget_copies(const PendingPacket& pkt);
+
+  // Mark packets lost by the packet-count or RACK time rule.
+  void mark_lost_packets(TimePoint now, AckRangesResult& result);
+
+  // RACK reordering window: min RTT / 4 per widening step, at most the smoothed RTT.
+  Duration reorder_window() const;
+
   // Internal: try to make room for new data.
   bool make_room(std::size_t bytes_needed);
 
@@ -184,8 +358,20 @@ class RetransmitBuffer {
   // Trade-off: No ordered iteration, but cumulative ACK and drop policies handle this
   // by collecting and sorting keys when needed (these operations are less frequent
   // than insert/find/erase on the hot path).
-  std::unordered_map<std::uint64_t, PendingPacket> pending_;
+  PendingMap pending_;
   std::size_t buffered_bytes_{0};
+  // PERFORMANCE: The current sequences of pending_, in order, so ACK processing and
+  // loss detection walk only the span from the oldest unacknowledged packet to the
+  // acknowledged ranges instead of every pending packet.
+  std::set<std::uint64_t> sequences_;
+  // Pending packets with PendingPacket::suspected set.
+  std::size_t suspected_count_{0};
+
+  // Earlier sequences of packets retransmitted under new ones, to the current sequence.
+  // Entries leave with their packet, so this is bounded by pending count times retries.
+  std::map<std::uint64_t, std::uint64_t> retired_;
+  // Scratch list of current sequences an ACK covers.
+  std::vector<std::uint64_t> ack_candidates_;
 
   // RTT estimation (RFC 6298 style)
   std::chrono::milliseconds estimated_rtt_;
@@ -193,6 +379,37 @@ class RetransmitBuffer {
   std::chrono::milliseconds current_rto_;
   bool rtt_initialized_{false};
 
+  // Largest sequence acknowledged by acknowledge_ranges(), and when it was last sent.
+  std::uint64_t largest_acked_{0};
+  TimePoint largest_acked_sent_time_{};
+
+  // RACK (RFC 8985): the most recently sent packet known delivered, its RTT, the minimum
+  // RTT seen, and the reordering window. Once a packet is acknowledged below an already
+  // acknowledged one, the packet-count rule is off.
+  bool rack_valid_{false};
+  TimePoint rack_xmit_time_{};
+  std::uint64_t rack_sequence_{0};
+  Duration rack_rtt_{};
+  Duration min_rtt_{};
+  std::uint32_t reorder_window_mult_{1};
+  std::uint32_t genuine_since_widening_{0};
+  bool reordering_seen_{false};
+
+  // Tail loss probe: armed from the last send or ACK, one probe until the next ACK.
+  TimePoint probe_anchor_{};
+  bool probe_outstanding_{false};
+
+  // Delivery-rate estimation: total bytes acknowledged, when the latest was, and the send
+  // time of the newest packet acknowledged. The rate_* fields accumulate the next sample.
+  std::uint64_t delivered_{0};
+  TimePoint delivered_time_{};
+  TimePoint send_interval_start_{};
+  bool rate_sample_pending_{false};
+  std::uint64_t rate_prior_delivered_{0};
+  TimePoint rate_prior_time_{};
+  Duration rate_send_elapsed_{};
+  std::chrono::microseconds rate_rtt_{0};
+
   // Rate limiting state.
   TimePoint rate_limit_window_start_;
   std::uint32_t inserts_in_window_{0};
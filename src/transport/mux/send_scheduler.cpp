@@ -0,0 +1,175 @@
+#include "transport/mux/send_scheduler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "transport/mux/payload_compression.h"
+
+namespace veil::mux {
+
+namespace {
+
+constexpr std::uint8_t kProtocolTcp = 6;
+constexpr std::uint8_t kProtocolUdp = 17;
+constexpr std::uint8_t kProtocolIcmp = 1;
+constexpr std::uint8_t kProtocolIcmpv6 = 58;
+
+TrafficClass classify_dscp(std::uint8_t dscp) {
+  switch (dscp) {
+    case 46:  // EF: voice
+    case 34:  // AF41, AF42, AF43: interactive video
+    case 36:
+    case 38:
+    case 40:  // CS5: signaling
+    case 48:  // CS6, CS7: network control
+    case 56:
+      return TrafficClass::kInteractive;
+    case 8:  // CS1: scavenger
+    case 1:  // LE (RFC 8622)
+      return TrafficClass::kBulk;
+    default:
+      return TrafficClass::kDefault;
+  }
+}
+
+bool interactive_port(std::uint16_t port) {
+  switch (port) {
+    case 22:    // SSH
+    case 53:    // DNS
+    case 123:   // NTP
+    case 3478:  // STUN/TURN
+    case 5060:  // SIP
+    case 5061:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+TrafficClass classify_ip_packet(std::span<const std::uint8_t> packet,
+                                std::size_t small_packet_size) {
+  std::uint8_t dscp = 0;
+  std::uint8_t protocol = 0;
+  std::size_t transport = 0;
+  if (packet.size() >= 20 && (packet[0] >> 4) == 4) {
+    dscp = static_cast<std::uint8_t>(packet[1] >> 2);
+    protocol = packet[9];
+    transport = std::size_t{packet[0] & 0x0FU} * 4;
+  } else if (packet.size() >= 40 && (packet[0] >> 4) == 6) {
+    dscp = static_cast<std::uint8_t>(((packet[0] & 0x0FU) << 2) | (packet[1] >> 6));
+    protocol = packet[6];
+    transport = 40;
+  } else {
+    return TrafficClass::kDefault;
+  }
+
+  // A marking the sender chose wins.
+  const auto marked = classify_dscp(dscp);
+  if (marked != TrafficClass::kDefault) {
+    return marked;
+  }
+  if (packet.size() <= small_packet_size || protocol == kProtocolIcmp ||
+      protocol == kProtocolIcmpv6) {
+    return TrafficClass::kInteractive;
+  }
+  if ((protocol == kProtocolTcp || protocol == kProtocolUdp) && packet.size() >= transport + 4) {
+    const auto source = static_cast<std::uint16_t>((packet[transport] << 8) | packet[transport + 1]);
+    const auto destination =
+        static_cast<std::uint16_t>((packet[transport + 2] << 8) | packet[transport + 3]);
+    if (interactive_port(source) || interactive_port(destination)) {
+      return TrafficClass::kInteractive;
+    }
+  }
+  return TrafficClass::kDefault;
+}
+
+SendScheduler::SendScheduler(SendSchedulerConfig config, std::function<TimePoint()> now_fn)
+    : config_(config),
+      now_fn_(std::move(now_fn)),
+      queues_{ClassQueue{FqCodelQueue(config.fq_codel)}, ClassQueue{FqCodelQueue(config.fq_codel)},
+              ClassQueue{FqCodelQueue(config.fq_codel)}} {
+  // A weight of 0 would starve the class and stall the round.
+  for (auto& weight : config_.weights) {
+    weight = std::max<std::uint32_t>(weight, 1);
+  }
+  config_.quantum = std::max<std::size_t>(config_.quantum, 1);
+}
+
+void SendScheduler::enqueue(TrafficClass traffic_class, std::vector<std::uint8_t> packet) {
+  const auto index = static_cast<std::size_t>(traffic_class);
+  const auto flow = ip_flow_id(packet);
+  queues_[index].flows.enqueue(flow, std::move(packet), now_fn_());
+  ++stats_.packets_queued[index];
+
+  // Over the limit: the longest backlog gives way, so a burst of bulk traffic cannot
+  // push out the few packets of an interactive class. On a tie, the lowest class loses.
+  while (queued_bytes() > config_.max_queued_bytes && queued_packets() > 1) {
+    const auto by_bytes = [](const ClassQueue& a, const ClassQueue& b) {
+      return a.flows.queued_bytes() < b.flows.queued_bytes();
+    };
+    const auto longest = static_cast<std::size_t>(
+        queues_.rend() - std::max_element(queues_.rbegin(), queues_.rend(), by_bytes) - 1);
+    queues_[longest].flows.drop_from_largest_flow();
+    ++stats_.packets_dropped[longest];
+  }
+}
+
+std::optional<std::vector<std::uint8_t>> SendScheduler::dequeue() {
+  const auto now = now_fn_();
+  // CoDel may drop what is queued on the way, so check for packets on every turn.
+  while (!empty()) {
+    auto& queue = queues_[current_];
+    if (queue.flows.empty()) {
+      // An idle class does not bank credit for later.
+      queue.deficit = 0;
+    } else if (queue.deficit > 0) {
+      if (auto packet = queue.flows.dequeue(now)) {
+        queue.deficit -= static_cast<std::int64_t>(packet->size());
+        return packet;
+      }
+      continue;
+    }
+    next_turn();
+  }
+  return std::nullopt;
+}
+
+std::size_t SendScheduler::queued_packets() const {
+  std::size_t packets = 0;
+  for (const auto& queue : queues_) {
+    packets += queue.flows.queued_packets();
+  }
+  return packets;
+}
+
+std::size_t SendScheduler::queued_bytes() const {
+  std::size_t bytes = 0;
+  for (const auto& queue : queues_) {
+    bytes += queue.flows.queued_bytes();
+  }
+  return bytes;
+}
+
+FqCodelStats SendScheduler::fq_codel_stats() const {
+  FqCodelStats total;
+  for (const auto& queue : queues_) {
+    total.codel_drops += queue.flows.stats().codel_drops;
+    total.ecn_marks += queue.flows.stats().ecn_marks;
+    total.overlimit_drops += queue.flows.stats().overlimit_drops;
+  }
+  return total;
+}
+
+void SendScheduler::next_turn() {
+  current_ = (current_ + 1) % kTrafficClasses;
+  queues_[current_].deficit += static_cast<std::int64_t>(config_.weights[current_] * config_.quantum);
+}
+
+}  // namespace veil::mux
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "transport/mux/fq_codel.h"
+
+namespace veil::mux {
+
+// Traffic classes of tunneled IP packets, in the order they are scheduled.
+enum class TrafficClass : std::uint8_t {
+  // Latency-sensitive: voice, video calls, SSH keystrokes, DNS, pure TCP ACKs.
+  kInteractive,
+  kDefault,
+  // Background: marked lower effort by the sender (DSCP CS1 or LE).
+  kBulk,
+};
+
+inline constexpr std::size_t kTrafficClasses = 3;
+
+// Configuration for the per-session send scheduler.
+struct SendSchedulerConfig {
+  // Share of the link each class gets while all have packets waiting, by class.
+  std::array<std::uint32_t, kTrafficClasses> weights{8, 2, 1};
+  // Bytes a class may send per round, per unit of weight.
+  std::size_t quantum{1500};
+  // Packets this small (TCP ACKs, voice frames, DNS) count as interactive whatever else
+  // they carry.
+  std::size_t small_packet_size{256};
+  // Longest backlog held; beyond it the class with the most bytes queued loses the
+  // oldest packet of its largest flow.
+  std::size_t max_queued_bytes{512 * 1024};
+  // Above this backlog the sender should stop reading packets in (see
+  // TransportSession::send_backlogged()), so the queue pushes back on the inner stack.
+  std::size_t backpressure_bytes{64 * 1024};
+  // Flow queueing and CoDel within each class.
+  FqCodelConfig fq_codel{};
+};
+
+struct SendSchedulerStats {
+  std::array<std::uint64_t, kTrafficClasses> packets_queued{};
+  // Dropped for max_queued_bytes.
+  std::array<std::uint64_t, kTrafficClasses> packets_dropped{};
+};
+
+// The class of a tunneled IPv4 or IPv6 packet, from its DSCP, protocol, ports and size.
+// Anything unrecognized is kDefault.
+TrafficClass classify_ip_packet(std::span<const std::uint8_t> packet,
+                                std::size_t small_packet_size);
+
+// Deficit round robin (Shreedhar and Varghese) across traffic classes. On its turn a
+// class sends packets while its deficit, topped up by weight * quantum bytes per
+// round, is positive. A class with little traffic (calls, keystrokes) is served
+// within one round of arriving, however much bulk traffic is queued, while classes
+// with backlogs share the link by weight.
+//
+// Within a class, packets queue per inner flow (5-tuple) under FQ-CoDel (see
+// FqCodelQueue): flows share the class fairly, and a flow whose packets wait too long
+// has them dropped or ECN-marked until its sender slows down.
+class SendScheduler {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+
+  explicit SendScheduler(SendSchedulerConfig config = {},
+                         std::function<TimePoint()> now_fn = Clock::now);
+
+  // Queue a packet of the given class. If the backlog is then over max_queued_bytes,
+  // the class with the most bytes queued drops the oldest packet of its largest flow.
+  void enqueue(TrafficClass traffic_class, std::vector<std::uint8_t> packet);
+
+  // The next packet to send, or nullopt if nothing is queued.
+  std::optional<std::vector<std::uint8_t>> dequeue();
+
+  bool empty() const { return queued_packets() == 0; }
+  std::size_t queued_packets() const;
+  std::size_t queued_bytes() const;
+  // Whether queued_bytes() is over backpressure_bytes.
+  bool backlogged() const { return queued_bytes() > config_.backpressure_bytes; }
+
+  const SendSchedulerStats& stats() const { return stats_; }
+  // CoDel drops and marks, and overlimit drops, over all classes.
+  FqCodelStats fq_codel_stats() const;
+
+ private:
+  struct ClassQueue {
+    FqCodelQueue flows;
+    std::int64_t deficit{0};
+  };
+
+  // Move the turn to the next class and top up its deficit.
+  void next_turn();
+
+  SendSchedulerConfig config_;
+  std::function<TimePoint()> now_fn_;
+  std::array<ClassQueue, kTrafficClasses> queues_;
+  std::size_t current_{0};
+  SendSchedulerStats stats_;
+};
+
+}  // namespace veil::mux
@@ -15,6 +15,8 @@
 #include "common/crypto/crypto_engine.h"
 #include "common/crypto/random.h"
 #include "common/logging/logger.h"
+#include "transport/mux/fq_codel.h"
+#include "transport/mux/mss_clamp.h"
 
 // SECURITY: Nonce overflow threshold.
 // With uint64_t, we can send 2^64 packets before overflow. At 10 Gbps with 1KB packets,
@@ -23,8 +25,84 @@
 // This threshold triggers a warning well before any practical risk of overflow.
 constexpr std::uint64_t kNonceOverflowWarningThreshold = std::numeric_limits<std::uint64_t>::max() - (1ULL << 32);
 
+// Datagram loss feedback: a datagram is declared lost once this many later packets have
+// been acknowledged (packet threshold, as in TCP's three duplicate ACKs).
+constexpr std::uint64_t kDatagramReorderThreshold = 3;
+
+// Upper bound on datagrams awaiting feedback; older ones are forgotten, not counted as lost.
+constexpr std::size_t kMaxTrackedDatagrams = 4096;
+
+// Per-packet overhead on top of the mux frames: obfuscated sequence (8) + AEAD tag (16).
+// Wire format v2 headers are shorter; this stays the upper bound.
+constexpr std::size_t kPacketOverhead = 8 + 16;
+
+// Packet header sizes: v1's obfuscated sequence, and v2's truncated sequence in 2, 3, 4
+// or 8 bytes (indexed by the length code in its top two bits).
+constexpr std::size_t kLongHeaderSize = 8;
+constexpr std::array<std::size_t, 4> kShortHeaderSizes = {2, 3, 4, 8};
+
+// Smallest sealed payload after the header: AEAD tag (16) + one frame type byte.
+constexpr std::size_t kMinSealedSize = 16 + 1;
+
+// DATA frame sequences remembered as received, as disjoint ranges. A retransmission
+// carries a fresh packet sequence, so the replay window no longer stops a copy whose
+// original arrived; this does, for as many holes as loss leaves in flight.
+constexpr std::size_t kReceivedDataRanges = 1024;
+
+// Streams with a flow control window of their own, per direction. A peer opening more
+// is held to the session window alone.
+constexpr std::size_t kMaxFlowStreams = 256;
+
 namespace veil::transport {
 
+namespace {
+
+// The retransmit buffer keeps each packet's plaintext; count it at its size on the wire.
+mux::RetransmitConfig with_packet_overhead(mux::RetransmitConfig config) {
+  config.packet_overhead = kPacketOverhead;
+  return config;
+}
+
+// FEC protects packets that carry data: the ones a retransmission or the inner
+// protocol would otherwise have to recover.
+bool carries_data(std::span<const mux::MuxFrame> frames) {
+  return std::any_of(frames.begin(), frames.end(), [](const mux::MuxFrame& frame) {
+    return frame.kind == mux::FrameKind::kData || frame.kind == mux::FrameKind::kDatagram;
+  });
+}
+
+// Sequence bits in a v2 header of `size` bytes (two bits hold the length code).
+std::size_t short_header_bits(std::size_t size) { return size * 8 - 2; }
+
+// The full sequence closest to `expected` whose low `bits` bits are `truncated`
+// (RFC 9000 appendix A.3).
+std::uint64_t decode_truncated_sequence(std::uint64_t expected, std::uint64_t truncated,
+                                        std::size_t bits) {
+  if (bits >= 62) {
+    return truncated;
+  }
+  const std::uint64_t window = std::uint64_t{1} << bits;
+  const std::uint64_t half = window / 2;
+  const std::uint64_t mask = window - 1;
+  const std::uint64_t candidate = (expected & ~mask) | truncated;
+  if (candidate + half <= expected && candidate < (std::uint64_t{1} << 62) - window) {
+    return candidate + window;
+  }
+  if (candidate > expected + half && candidate >= window) {
+    return candidate - window;
+  }
+  return candidate;
+}
+
+// The v2 header protection sample: the start of the AEAD tag, which ends every sealed
+// packet.
+std::span<const std::uint8_t, crypto::kHeaderProtectionSampleLen> tag_sample(
+    std::span<const std::uint8_t> packet) {
+  return packet.last<16>().first<crypto::kHeaderProtectionSampleLen>();
+}
+
+}  // namespace
+
 TransportSession::TransportSession(const handshake::HandshakeSession& handshake_session,
                                    TransportSessionConfig config, std::function<TimePoint()> now_fn)
     : config_(config),
@@ -35,10 +113,31 @@ TransportSession::TransportSession(const handshake::HandshakeSession& handshake_
       recv_seq_obfuscation_key_(crypto::derive_sequence_obfuscation_key(keys_.recv_key, keys_.recv_nonce)),
       replay_window_(config_.replay_window_size),
       session_rotator_(config_.session_rotation_interval, config_.session_rotation_packets),
+      received_data_(kReceivedDataRanges),
+      received_fragments_(kReceivedDataRanges),
       reorder_buffer_(0, config_.reorder_buffer_size),
       fragment_reassembly_(config_.fragment_buffer_size),
-      retransmit_buffer_(config_.retransmit_config, now_fn_),
-      congestion_controller_(config_.congestion_config, now_fn_) {
+      retransmit_buffer_(with_packet_overhead(config_.retransmit_config), now_fn_),
+      congestion_controller_(mux::make_congestion_control(config_.congestion_algorithm,
+                                                          config_.congestion_config, now_fn_)),
+      frame_packer_(mux::FramePackerConfig{
+                        .max_batch_size = config_.mtu > kPacketOverhead ? config_.mtu - kPacketOverhead : 0,
+                        .max_delay = config_.packing_delay},
+                    now_fn_),
+      fec_encoder_(config_.fec_config, now_fn_),
+      fec_decoder_(config_.fec_config),
+      header_compressor_(config_.header_compression_config),
+      payload_compressor_(config_.payload_compression_config),
+      path_mtu_(config_.mtu, config_.path_mtu_config),
+      max_payload_size_(config_.max_fragment_size),
+      send_scheduler_(config_.send_scheduler_config, now_fn_),
+      session_receive_window_(config_.flow_control.initial_session_window,
+                              config_.flow_control.max_session_window) {
+  // The default stream's credit goes out with the session's on connect.
+  if (config_.enable_flow_control) {
+    receive_window(0);
+  }
+
   // Enhanced diagnostic logging for session creation (Issue #69, #72)
   // Use INFO level so key fingerprints are always logged, not just in verbose mode
   // This helps diagnose key mismatch issues between client and server
@@ -71,6 +170,27 @@ std::vector<std::vector<std::uint8_t>> TransportSession::encrypt_data(
     std::span<const std::uint8_t> plaintext, std::uint64_t stream_id, bool fin) {
   VEIL_DCHECK_THREAD(thread_checker_);
 
+  if (!config_.enable_flow_control) {
+    return send_data(plaintext, stream_id, fin);
+  }
+  // Messages go out in order: behind held ones, or held themselves while the peer's
+  // credit does not cover them.
+  if (flow_blocked_.empty() && flow_allows(stream_id, plaintext.size())) {
+    return send_data(plaintext, stream_id, fin);
+  }
+  if (flow_blocked_bytes_ + plaintext.size() > config_.flow_control.max_blocked_bytes) {
+    ++stats_.flow_control_dropped;
+    return {};
+  }
+  flow_blocked_.push_back(
+      BlockedData{stream_id, std::vector<std::uint8_t>(plaintext.begin(), plaintext.end()), fin});
+  flow_blocked_bytes_ += plaintext.size();
+  ++stats_.flow_control_blocked;
+  return {};
+}
+
+std::vector<std::vector<std::uint8_t>> TransportSession::send_data(
+    std::span<const std::uint8_t> plaintext, std::uint64_t stream_id, bool fin) {
   std::vector<std::vector<std::uint8_t>> result;
 
   // Fragment data if necessary.
@@ -80,11 +200,17 @@ std::vector<std::vector<std::uint8_t>> TransportSession::encrypt_data(
   result.reserve(frames.size());
 
   for (auto& frame : frames) {
-    auto encrypted = build_encrypted_packet(frame);
+    auto encoded = mux::MuxCodec::encode(frame, send_format_);
+    auto encrypted = seal_packet(encoded);
+    protect_packet(encoded);
 
-    // Store in retransmit buffer.
+    // Store in retransmit buffer. The plaintext is kept: a retransmission is sealed again
+    // under a fresh sequence (see get_retransmit_packets()).
     if (retransmit_buffer_.has_capacity(encrypted.size())) {
-      retransmit_buffer_.insert(send_sequence_ - 1, encrypted);
+      retransmit_buffer_.insert(send_sequence_ - 1, std::move(encoded));
+    } else if (config_.enable_flow_control) {
+      // Not tracked, so never abandoned either: a loss would keep its credit for good.
+      abandon_flow_credit(encoded);
     }
 
     ++stats_.packets_sent;
@@ -96,6 +222,7 @@ std::vector<std::vector<std::uint8_t>> TransportSession::encrypt_data(
     result.push_back(std::move(encrypted));
     ++packets_since_rotation_;
   }
+  append_fec_repairs(result);
 
   return result;
 }
@@ -116,80 +243,375 @@ std::vector<std::uint8_t> TransportSession::encrypt_frame(const mux::MuxFrame& f
   return encrypted;
 }
 
-std::optional<std::vector<mux::MuxFrame>> TransportSession::decrypt_packet(
-    std::span<const std::uint8_t> ciphertext) {
+std::vector<std::vector<std::uint8_t>> TransportSession::encrypt_datagram(
+    std::span<const std::uint8_t> packet) {
   VEIL_DCHECK_THREAD(thread_checker_);
 
-  // Minimum packet size: nonce (8 bytes for sequence) + tag (16 bytes) + header (1 byte minimum)
-  constexpr std::size_t kMinPacketSize = 8 + 16 + 1;
-  if (ciphertext.size() < kMinPacketSize) {
-    LOG_DEBUG("Packet too small: {} bytes", ciphertext.size());
-    ++stats_.packets_dropped_decrypt;
-    return std::nullopt;
+  if (packet.size() > max_payload_size_) {
+    return encrypt_data(packet);
+  }
+
+  std::vector<std::vector<std::uint8_t>> result;
+  const auto plaintext = mux::MuxCodec::encode(
+      mux::make_datagram_frame(std::vector<std::uint8_t>(packet.begin(), packet.end())));
+  auto encrypted = seal_packet(plaintext);
+  protect_packet(plaintext);
+
+  track_datagram(encrypted.size());
+
+  ++stats_.packets_sent;
+  ++stats_.datagrams_sent;
+  stats_.bytes_sent += encrypted.size();
+  ++packets_since_rotation_;
+
+  result.push_back(std::move(encrypted));
+  append_fec_repairs(result);
+  return result;
+}
+
+std::vector<std::vector<std::uint8_t>> TransportSession::encrypt_ip_packet(
+    std::span<const std::uint8_t> packet) {
+  const auto wire = compress_ip_packet(packet);
+  return datagram_mode_active_ ? encrypt_datagram(wire) : encrypt_data(wire);
+}
+
+std::span<const std::uint8_t> TransportSession::compress_ip_packet(
+    std::span<const std::uint8_t> packet) {
+  if (config_.clamp_tcp_mss && mux::clamp_tcp_mss(packet, max_payload_size_, mss_buffer_)) {
+    packet = mss_buffer_;
+    ++stats_.tcp_mss_clamped;
   }
+  auto wire = packet;
+  if (header_compression_active_ && header_compressor_.compress(packet, compress_buffer_)) {
+    wire = compress_buffer_;
+  }
+  // The flow comes from the original headers: the compressed ones no longer show it.
+  if (payload_compression_active_ &&
+      payload_compressor_.compress(mux::ip_flow_id(packet), wire, payload_buffer_)) {
+    wire = payload_buffer_;
+  }
+  return wire;
+}
 
-  // Extract obfuscated sequence from first 8 bytes.
-  std::uint64_t obfuscated_sequence = 0;
-  for (int i = 0; i < 8; ++i) {
-    obfuscated_sequence = (obfuscated_sequence << 8) | ciphertext[static_cast<std::size_t>(i)];
+bool TransportSession::expand_ip_packet(std::vector<std::uint8_t>& payload) {
+  if (config_.enable_payload_compression && !payload_decompressor_.decompress(payload)) {
+    return false;
   }
+  return !config_.enable_header_compression || header_decompressor_.decompress(payload);
+}
 
-  // DPI RESISTANCE (Issue #21): Deobfuscate sequence number.
-  // The sender obfuscated the sequence to prevent traffic analysis. We reverse the
-  // obfuscation here to recover the real sequence for nonce derivation and replay checking.
-  const std::uint64_t sequence = crypto::deobfuscate_sequence(obfuscated_sequence, recv_seq_obfuscation_key_);
+void TransportSession::track_datagram(std::size_t bytes) {
+  // Sequence 0 is not tracked: the receiver's AckScheduler cannot report it in a bitmap.
+  if (!datagram_acks_active_ || send_sequence_ <= 1) {
+    return;
+  }
+  if (datagrams_in_flight_.size() >= kMaxTrackedDatagrams) {
+    datagram_bytes_in_flight_ -= datagrams_in_flight_.front().bytes;
+    datagrams_in_flight_.pop_front();
+  }
+  datagrams_in_flight_.push_back(SentDatagram{send_sequence_ - 1, bytes, now_fn_()});
+  datagram_bytes_in_flight_ += bytes;
+  peak_bytes_in_flight_ = std::max(peak_bytes_in_flight_, bytes_in_flight());
+}
 
-  // Enhanced diagnostic logging for decryption debugging (Issue #69, #72)
-  // Changed to DEBUG level to avoid performance impact in hot path (Issue #92)
-  LOG_DEBUG("Decrypt attempt: session_id={}, pkt_size={}, obfuscated_seq={:#018x}, deobfuscated_seq={}",
-            current_session_id_, ciphertext.size(), obfuscated_sequence, sequence);
-  LOG_DEBUG("  recv_seq_obfuscation_key_fp={:02x}{:02x}{:02x}{:02x}, first_8_bytes={:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}",
-            recv_seq_obfuscation_key_[0], recv_seq_obfuscation_key_[1],
-            recv_seq_obfuscation_key_[2], recv_seq_obfuscation_key_[3],
-            ciphertext[0], ciphertext[1], ciphertext[2], ciphertext[3],
-            ciphertext[4], ciphertext[5], ciphertext[6], ciphertext[7]);
-
-  // Replay check.
-  if (!replay_window_.mark_and_check(sequence)) {
-    LOG_DEBUG("Packet replay detected or out of window: sequence={}, highest={}",
-              sequence, replay_window_.highest());
-    ++stats_.packets_dropped_replay;
-    return std::nullopt;
+std::vector<std::uint8_t> TransportSession::encrypt_frames(std::span<const mux::MuxFrame> frames) {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  auto plaintext = mux::MuxCodec::encode_all(frames, send_format_);
+  auto encrypted = seal_packet(plaintext);
+
+  bool has_data = false;
+  bool has_datagram = false;
+  for (const auto& frame : frames) {
+    if (frame.kind == mux::FrameKind::kData) {
+      has_data = true;
+      ++stats_.fragments_sent;
+    } else if (frame.kind == mux::FrameKind::kDatagram) {
+      has_datagram = true;
+      ++stats_.datagrams_sent;
+    }
+  }
+
+  if (has_data || has_datagram) {
+    protect_packet(plaintext);
+  }
+
+  // Retransmission and loss feedback work per packet: the packet is resent (or declared
+  // lost) as a whole, together with any ACKs and datagrams packed alongside.
+  if (has_data && retransmit_buffer_.has_capacity(encrypted.size())) {
+    retransmit_buffer_.insert(send_sequence_ - 1, std::move(plaintext));
+  } else if (has_datagram) {
+    track_datagram(encrypted.size());
+  }
+
+  ++stats_.packets_sent;
+  stats_.bytes_sent += encrypted.size();
+  if (frames.size() > 1) {
+    ++stats_.packed_packets_sent;
+    stats_.packed_frames_sent += frames.size();
+  }
+  ++packets_since_rotation_;
+
+  return encrypted;
+}
+
+void TransportSession::emit_batch(std::vector<mux::MuxFrame> batch,
+                                  std::vector<std::vector<std::uint8_t>>& out) {
+  if (!batch.empty()) {
+    out.push_back(encrypt_frames(batch));
+    append_fec_repairs(out);
+  }
+}
+
+std::vector<std::vector<std::uint8_t>> TransportSession::queue_ip_packet(
+    std::span<const std::uint8_t> packet) {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  // Only a backlog needs scheduling: with room in the window and nothing waiting, the
+  // packet goes straight out without a copy.
+  if (config_.enable_send_scheduler && (!send_scheduler_.empty() || send_budget() == 0)) {
+    window_held_back_ = true;
+    send_scheduler_.enqueue(
+        mux::classify_ip_packet(packet, config_.send_scheduler_config.small_packet_size),
+        std::vector<std::uint8_t>(packet.begin(), packet.end()));
+    std::vector<std::vector<std::uint8_t>> result;
+    drain_send_scheduler(result);
+    return result;
+  }
+  return pack_ip_packet(packet);
+}
+
+std::vector<std::vector<std::uint8_t>> TransportSession::pack_ip_packet(
+    std::span<const std::uint8_t> packet) {
+  if (!frame_packing_active_) {
+    return encrypt_ip_packet(packet);
+  }
+
+  std::vector<std::vector<std::uint8_t>> result;
+  const auto wire = compress_ip_packet(packet);
+  if (!datagram_mode_active_ || wire.size() > max_payload_size_) {
+    // Reliable DATA frames keep one frame per packet so fragment numbering and the
+    // retransmit buffer are unchanged. Flush first to keep the queued frames in order.
+    emit_batch(frame_packer_.flush(), result);
+    for (auto& encrypted : encrypt_data(wire)) {
+      result.push_back(std::move(encrypted));
+    }
+    return result;
+  }
+
+  emit_batch(frame_packer_.add(mux::make_datagram_frame(
+                 std::vector<std::uint8_t>(wire.begin(), wire.end()))),
+             result);
+  return result;
+}
+
+std::vector<std::vector<std::uint8_t>> TransportSession::queue_frame(mux::MuxFrame frame) {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  std::vector<std::vector<std::uint8_t>> result;
+  if (!frame_packing_active_) {
+    result.push_back(encrypt_frame(frame));
+    return result;
+  }
+  emit_batch(frame_packer_.add(std::move(frame)), result);
+  return result;
+}
+
+std::vector<std::vector<std::uint8_t>> TransportSession::flush_packed() {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  std::vector<std::vector<std::uint8_t>> result;
+  drain_send_scheduler(result);
+  emit_batch(frame_packer_.flush(), result);
+  return result;
+}
+
+std::vector<std::vector<std::uint8_t>> TransportSession::flush_packed_if_due() {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  std::vector<std::vector<std::uint8_t>> result;
+  drain_send_scheduler(result);
+  if (frame_packer_.flush_due()) {
+    emit_batch(frame_packer_.flush(), result);
+  }
+  return result;
+}
+
+bool TransportSession::has_packed_frames() const {
+  return !frame_packer_.empty() || (!send_scheduler_.empty() && send_budget() > 0);
+}
+
+std::size_t TransportSession::send_budget() const {
+  // Data held for flow control credit goes first, in order; the scheduler waits too
+  // rather than feed that FIFO.
+  if (!flow_blocked_.empty()) {
+    return 0;
+  }
+  if (!config_.enable_congestion_control) {
+    return std::numeric_limits<std::size_t>::max();
   }
-  LOG_DEBUG("Replay check passed, proceeding to decryption");
+  return congestion_controller_->sendable_bytes(bytes_in_flight());
+}
 
-  // Derive nonce from sequence.
-  const auto nonce = crypto::derive_nonce(keys_.recv_nonce, sequence);
+bool TransportSession::window_limited() const {
+  // As Linux's tcp_is_cwnd_limited(): in slow start, half the window in use is enough;
+  // after it, the window must have held a packet back.
+  if (congestion_controller_->state() == mux::CongestionState::kSlowStart) {
+    return 2 * peak_bytes_in_flight_ >= congestion_controller_->cwnd();
+  }
+  return window_held_back_;
+}
 
-  // Decrypt (skip sequence prefix).
-  auto ciphertext_body = ciphertext.subspan(8);
-  auto decrypted = crypto::aead_decrypt(keys_.recv_key, nonce, {}, ciphertext_body);
-  if (!decrypted) {
+void TransportSession::drain_send_scheduler(std::vector<std::vector<std::uint8_t>>& out) {
+  // The window is checked per packet, so the last one may overshoot it by a packet.
+  while (!send_scheduler_.empty() && send_budget() > 0) {
+    const auto packet = *send_scheduler_.dequeue();
+    for (auto& encrypted : pack_ip_packet(packet)) {
+      out.push_back(std::move(encrypted));
+    }
+  }
+}
+
+std::size_t TransportSession::packet_header_size() const {
+  if (send_format_ == mux::WireFormat::kV1) {
+    return kLongHeaderSize;
+  }
+  // As QUIC (RFC 9000 section 17.1): enough bits for twice the sequences the peer may
+  // not have seen, so it decodes the sequence against its largest received.
+  const std::uint64_t unacked =
+      peer_largest_acked_ ? send_sequence_ - *peer_largest_acked_ : send_sequence_ + 1;
+  for (const auto size : kShortHeaderSizes) {
+    if (size == kShortHeaderSizes.back() || unacked < (std::uint64_t{1} << (short_header_bits(size) - 1))) {
+      return size;
+    }
+  }
+  return kShortHeaderSizes.back();
+}
+
+void TransportSession::write_packet_header(std::span<std::uint8_t> packet,
+                                           std::size_t header_size) const {
+  if (send_format_ == mux::WireFormat::kV1) {
+    // DPI RESISTANCE (Issue #21): Obfuscate sequence number before transmission.
+    // Previously, the sequence was sent in plaintext, creating a DPI signature (monotonically
+    // increasing values). Now we obfuscate it using ChaCha20 with a session-specific key.
+    // The receiver can deobfuscate using the same key to recover the sequence for nonce derivation.
+    const std::uint64_t obfuscated_sequence =
+        crypto::obfuscate_sequence(send_sequence_, send_seq_obfuscation_key_);
+    for (std::size_t i = 0; i < kLongHeaderSize; ++i) {
+      packet[i] = static_cast<std::uint8_t>(obfuscated_sequence >> (8 * (kLongHeaderSize - 1 - i)));
+    }
+    return;
+  }
+  // Truncated sequence, length code in the top two bits, then masked from the tag so
+  // it looks as random as the obfuscated one.
+  const auto bits = short_header_bits(header_size);
+  const auto code = static_cast<std::uint64_t>(
+      std::find(kShortHeaderSizes.begin(), kShortHeaderSizes.end(), header_size) -
+      kShortHeaderSizes.begin());
+  const std::uint64_t value = (code << bits) | (send_sequence_ & ((std::uint64_t{1} << bits) - 1));
+  const auto mask = crypto::header_protection_mask(send_seq_obfuscation_key_, tag_sample(packet));
+  for (std::size_t i = 0; i < header_size; ++i) {
+    packet[i] = static_cast<std::uint8_t>(value >> (8 * (header_size - 1 - i))) ^ mask[i];
+  }
+}
+
+std::array<std::optional<TransportSession::PacketHeader>, 2> TransportSession::read_packet_headers(
+    std::span<const std::uint8_t> packet) const {
+  std::optional<PacketHeader> long_header;
+  if (packet.size() >= kLongHeaderSize + kMinSealedSize) {
+    std::uint64_t obfuscated_sequence = 0;
+    for (std::size_t i = 0; i < kLongHeaderSize; ++i) {
+      obfuscated_sequence = (obfuscated_sequence << 8) | packet[i];
+    }
+    // DPI RESISTANCE (Issue #21): Deobfuscate sequence number.
+    long_header = PacketHeader{
+        crypto::deobfuscate_sequence(obfuscated_sequence, recv_seq_obfuscation_key_),
+        kLongHeaderSize, mux::WireFormat::kV1};
+  }
+
+  std::optional<PacketHeader> short_header;
+  if (config_.compact_wire_format && packet.size() >= kShortHeaderSizes.front() + kMinSealedSize) {
+    const auto mask = crypto::header_protection_mask(recv_seq_obfuscation_key_, tag_sample(packet));
+    const auto size = kShortHeaderSizes[static_cast<std::size_t>((packet[0] ^ mask[0]) >> 6)];
+    if (packet.size() >= size + kMinSealedSize) {
+      std::uint64_t value = 0;
+      for (std::size_t i = 0; i < size; ++i) {
+        value = (value << 8) | static_cast<std::uint8_t>(packet[i] ^ mask[i]);
+      }
+      const auto bits = short_header_bits(size);
+      // Decode against the next sequence expected (RFC 9000 appendix A.3).
+      const std::uint64_t expected = replay_window_.initialized() ? replay_window_.highest() + 1 : 0;
+      short_header = PacketHeader{
+          decode_truncated_sequence(expected, value & ((std::uint64_t{1} << bits) - 1), bits),
+          size, mux::WireFormat::kV2};
+    }
+  }
+
+  // Try the format the peer used last first: the other only while it switches.
+  if (recv_format_ == mux::WireFormat::kV2) {
+    return {short_header, long_header};
+  }
+  return {long_header, short_header};
+}
+
+template <typename Decrypt>
+std::optional<TransportSession::PacketHeader> TransportSession::open_packet(
+    std::span<const std::uint8_t> packet, Decrypt&& decrypt) {
+  bool replayed = false;
+  for (const auto& header : read_packet_headers(packet)) {
+    if (!header) {
+      continue;
+    }
+    // SECURITY: The window is only moved by packets that authenticate, so a forged
+    // header cannot push it ahead of the peer.
+    if (!replay_window_.check(header->sequence)) {
+      replayed = true;
+      continue;
+    }
+    if (decrypt(*header)) {
+      replay_window_.mark_and_check(header->sequence);
+      recv_format_ = header->format;
+      return header;
+    }
+  }
+
+  // Issue #78: A packet that fails to decrypt (e.g., wrong session keys after session
+  // rotation) leaves its sequence unmarked, so a legitimate retransmission is accepted.
+  if (replayed) {
+    LOG_DEBUG("Packet replay detected or out of window: size={}, highest={}", packet.size(),
+              replay_window_.highest());
+    ++stats_.packets_dropped_replay;
+  } else {
     // Enhanced error logging for decryption failures (Issue #69, #72)
-    // Changed to DEBUG level to avoid performance impact in hot path (Issue #92)
     // Log key fingerprints (first 4 bytes) to help diagnose key mismatch issues
-    LOG_DEBUG("Decryption FAILED: session_id={}, sequence={}, ciphertext_size={}, "
-              "recv_key_fp={:02x}{:02x}{:02x}{:02x}, recv_nonce_fp={:02x}{:02x}{:02x}{:02x}",
-              current_session_id_, sequence, ciphertext_body.size(),
+    LOG_DEBUG("Decryption FAILED: session_id={}, size={}, "
+              "recv_key_fp={:02x}{:02x}{:02x}{:02x}, recv_nonce_fp={:02x}{:02x}{:02x}{:02x}, "
+              "recv_seq_obfuscation_key_fp={:02x}{:02x}{:02x}{:02x}",
+              current_session_id_, packet.size(),
               keys_.recv_key[0], keys_.recv_key[1], keys_.recv_key[2], keys_.recv_key[3],
-              keys_.recv_nonce[0], keys_.recv_nonce[1], keys_.recv_nonce[2], keys_.recv_nonce[3]);
-    // Also log the obfuscation key fingerprint and packet header
-    LOG_DEBUG("  recv_seq_obfuscation_key_fp={:02x}{:02x}{:02x}{:02x}, first_pkt_bytes={:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}",
+              keys_.recv_nonce[0], keys_.recv_nonce[1], keys_.recv_nonce[2], keys_.recv_nonce[3],
               recv_seq_obfuscation_key_[0], recv_seq_obfuscation_key_[1],
-              recv_seq_obfuscation_key_[2], recv_seq_obfuscation_key_[3],
-              ciphertext[0], ciphertext[1], ciphertext[2], ciphertext[3],
-              ciphertext[4], ciphertext[5], ciphertext[6], ciphertext[7]);
+              recv_seq_obfuscation_key_[2], recv_seq_obfuscation_key_[3]);
+    ++stats_.packets_dropped_decrypt;
+  }
+  return std::nullopt;
+}
 
-    // Issue #78: Unmark sequence in replay window to allow legitimate retransmission
-    // If decryption fails (e.g., due to wrong session keys after session rotation),
-    // we should allow the server to retransmit this packet rather than permanently
-    // rejecting it as a replay.
-    replay_window_.unmark(sequence);
-    LOG_DEBUG("  Unmarked sequence {} in replay window to allow retransmission", sequence);
+std::optional<std::vector<mux::MuxFrame>> TransportSession::decrypt_packet(
+    std::span<const std::uint8_t> ciphertext) {
+  VEIL_DCHECK_THREAD(thread_checker_);
 
-    ++stats_.packets_dropped_decrypt;
+  // Replay check and decryption, for each header format the peer may have used.
+  std::optional<std::vector<std::uint8_t>> decrypted;
+  const auto header = open_packet(ciphertext, [&](const PacketHeader& candidate) {
+    const auto nonce = crypto::derive_nonce(keys_.recv_nonce, candidate.sequence);
+    decrypted = crypto::aead_decrypt(keys_.recv_key, nonce, {}, ciphertext.subspan(candidate.size));
+    return decrypted.has_value();
+  });
+  if (!header) {
     return std::nullopt;
   }
+  const std::uint64_t sequence = header->sequence;
 
   // Enhanced diagnostic logging for decryption success (Issue #72)
   // Changed to DEBUG level to avoid performance impact in hot path (Issue #92)
@@ -201,8 +623,34 @@ std::optional<std::vector<mux::MuxFrame>> TransportSession::decrypt_packet(
 
   // Parse mux frames from decrypted data.
   std::vector<mux::MuxFrame> frames;
-  auto frame = mux::MuxCodec::decode(*decrypted);
-  if (frame) {
+  // A packet carries one or more frames back to back (see FramePacker).
+  auto decoded = mux::MuxCodec::decode_all(*decrypted);
+  if (decoded) {
+    // FEC: keep the plaintext for rebuilding a lost packet of its group.
+    std::vector<mux::RecoveredPacket> recovered;
+    if (fec_active_ && carries_data(*decoded)) {
+      recovered = fec_decoder_.on_packet(sequence, *decrypted);
+    }
+    frames.reserve(decoded->size());
+    deliver_frames(sequence, *decoded, frames);
+    deliver_recovered(std::move(recovered), frames);
+  } else {
+    // Log frame decode failure for debugging (Issue #72)
+    LOG_DEBUG("  Frame decode FAILED: decrypted_size={}, first_byte={:#04x}",
+              decrypted->size(), decrypted->empty() ? 0 : (*decrypted)[0]);
+  }
+
+  if (sequence > recv_sequence_max_) {
+    recv_sequence_max_ = sequence;
+  }
+
+  return frames;
+}
+
+void TransportSession::deliver_frames(std::uint64_t sequence, std::vector<mux::MuxFrame>& decoded,
+                                      std::vector<mux::MuxFrame>& out) {
+  for (auto& decoded_frame : decoded) {
+    auto* frame = &decoded_frame;
     // Log frame details for debugging (Issue #72)
     LOG_DEBUG("  Frame decoded: kind={}, payload_size={}",
               static_cast<int>(frame->kind),
@@ -210,7 +658,18 @@ std::optional<std::vector<mux::MuxFrame>> TransportSession::decrypt_packet(
 
     if (frame->kind == mux::FrameKind::kData) {
       ++stats_.fragments_received;
-      recv_ack_bitmap_.ack(sequence);
+      record_received(sequence);
+
+      // The packet is ACKed either way, but a copy of a DATA frame already received
+      // (the original of a retransmission that was not needed) is not delivered again.
+      auto& received = frame->data.sequence > 0xFFFFFFFF ? received_fragments_ : received_data_;
+      if (!received.add(frame->data.sequence)) {
+        ++stats_.fragments_dropped_duplicate;
+        continue;
+      }
+      const std::uint64_t stream_id = frame->data.stream_id;
+      const std::size_t payload_size = frame->data.payload.size();
+      on_data_received(stream_id, payload_size);
 
       // Issue #74: Fragment reassembly
       // For fragmented messages, sequence is encoded as (msg_id << 32) | frag_idx.
@@ -239,12 +698,16 @@ std::optional<std::vector<mux::MuxFrame>> TransportSession::decrypt_packet(
         mux::Fragment frag{
             .offset = static_cast<std::uint16_t>(frag_idx * config_.max_fragment_size),
             .data = std::move(frame->data.payload),
-            .last = frame->data.fin};
+            .last = frame->data.fin,
+            .stream_id = stream_id};
 
         LOG_DEBUG("  Fragment: msg_id={}, frag_idx={}, offset={}, size={}, last={}",
                   msg_id, frag_idx, frag.offset, frag.data.size(), frag.last);
 
-        fragment_reassembly_.push(reassembly_id, std::move(frag), now_fn_());
+        if (!fragment_reassembly_.push(reassembly_id, std::move(frag), now_fn_())) {
+          // Rejected: not held, so its credit is free again.
+          on_data_consumed(stream_id, payload_size);
+        }
 
         // Try to reassemble the complete message
         auto reassembled = fragment_reassembly_.try_reassemble(reassembly_id);
@@ -252,6 +715,7 @@ std::optional<std::vector<mux::MuxFrame>> TransportSession::decrypt_packet(
           // Successfully reassembled - create a new data frame with complete payload
           LOG_DEBUG("  Reassembled complete message: msg_id={}, size={}", msg_id, reassembled->size());
           ++stats_.messages_reassembled;
+          on_data_consumed(stream_id, reassembled->size());
 
           mux::MuxFrame complete_frame{};
           complete_frame.kind = mux::FrameKind::kData;
@@ -259,34 +723,470 @@ std::optional<std::vector<mux::MuxFrame>> TransportSession::decrypt_packet(
           complete_frame.data.sequence = frame_seq;  // Use original sequence
           complete_frame.data.fin = true;
           complete_frame.data.payload = std::move(*reassembled);
-          frames.push_back(std::move(complete_frame));
+          if (expand_ip_packet(complete_frame.data.payload)) {
+            out.push_back(std::move(complete_frame));
+          }
         }
         // If not yet complete, don't add to frames - wait for more fragments
       } else {
         // Complete non-fragmented message - return directly
         LOG_DEBUG("  Complete message: sequence={}, size={}", frame_seq, frame->data.payload.size());
-        frames.push_back(std::move(*frame));
+        on_data_consumed(stream_id, payload_size);
+        if (expand_ip_packet(frame->data.payload)) {
+          out.push_back(std::move(*frame));
+        }
+      }
+    } else if (frame->kind == mux::FrameKind::kDatagram) {
+      // Datagrams are delivered as they arrive: no reordering, no reassembly.
+      ++stats_.datagrams_received;
+      frame->datagram.sequence = sequence;
+      if (expand_ip_packet(frame->datagram.payload)) {
+        out.push_back(std::move(*frame));
+      }
+    } else if (frame->kind == mux::FrameKind::kFecRepair) {
+      // Repairs are not acknowledged or returned: they only rebuild lost packets.
+      if (fec_active_) {
+        deliver_recovered(fec_decoder_.on_repair(std::move(frame->fec_repair)), out);
+      }
+    } else if (frame->kind == mux::FrameKind::kControl &&
+               frame->control.type == mux::kControlFecParams) {
+      const auto& payload = frame->control.payload;
+      if (config_.enable_fec && payload.size() >= 2 && payload[0] == mux::kFecParamsVersion) {
+        if (!fec_active_) {
+          // Both sides offered FEC. Offer again in case ours was lost.
+          fec_active_ = true;
+          fec_params_sent_ = 0;
+        }
+        fec_encoder_.set_group_size(payload[1]);
+      }
+    } else if (frame->kind == mux::FrameKind::kControl &&
+               frame->control.type == mux::kControlWireFormat) {
+      const auto& payload = frame->control.payload;
+      if (config_.compact_wire_format && payload.size() >= 2 &&
+          payload[0] == mux::kWireFormatVersion &&
+          payload[1] >= static_cast<std::uint8_t>(mux::WireFormat::kV2) &&
+          send_format_ != mux::WireFormat::kV2) {
+        // Both sides offered v2. Offer again in case ours was lost.
+        send_format_ = mux::WireFormat::kV2;
+        wire_format_sent_ = false;
+      }
+    } else if (frame->kind == mux::FrameKind::kControl &&
+               frame->control.type == mux::kControlDatagramMode) {
+      const auto& payload = frame->control.payload;
+      if (config_.datagram_mode && !payload.empty() &&
+          payload[0] == mux::kDatagramModeVersion && !datagram_mode_active_) {
+        // Both sides offered datagrams. Offer again in case ours was lost.
+        datagram_mode_active_ = true;
+        datagram_mode_sent_ = false;
+        datagram_acks_active_ = payload.size() >= 2 && (payload[1] & mux::kDatagramModeAcks) != 0;
+      }
+    } else if (frame->kind == mux::FrameKind::kControl &&
+               frame->control.type == mux::kControlFramePacking) {
+      const auto& payload = frame->control.payload;
+      if (config_.frame_packing && !payload.empty() &&
+          payload[0] == mux::kFramePackingVersion && !frame_packing_active_) {
+        // Both sides offered frame packing. Offer again in case ours was lost.
+        frame_packing_active_ = true;
+        frame_packing_sent_ = false;
+      }
+    } else if (frame->kind == mux::FrameKind::kControl &&
+               frame->control.type == mux::kControlAckRanges) {
+      const auto& payload = frame->control.payload;
+      if (config_.ack_ranges && !payload.empty() &&
+          payload[0] == mux::kAckRangesOfferVersion && !ack_ranges_active_) {
+        // Both sides offered extended ACKs. Offer again in case ours was lost.
+        ack_ranges_active_ = true;
+        ack_ranges_sent_ = false;
+      }
+    } else if (frame->kind == mux::FrameKind::kControl &&
+               frame->control.type == mux::kControlHeaderCompression) {
+      const auto& payload = frame->control.payload;
+      if (config_.enable_header_compression && !payload.empty() &&
+          payload[0] == mux::kHeaderCompressionVersion && !header_compression_active_) {
+        // Both sides offered header compression. Offer again in case ours was lost.
+        header_compression_active_ = true;
+        header_compression_sent_ = false;
+      }
+    } else if (frame->kind == mux::FrameKind::kControl &&
+               frame->control.type == mux::kControlPayloadCompression) {
+      const auto& payload = frame->control.payload;
+      if (config_.enable_payload_compression && !payload.empty() &&
+          payload[0] == mux::kPayloadCompressionVersion && !payload_compression_active_) {
+        // Both sides offered payload compression. Offer again in case ours was lost.
+        payload_compression_active_ = true;
+        payload_compression_sent_ = false;
+      }
+    } else if (frame->kind == mux::FrameKind::kControl &&
+               (frame->control.type == mux::kControlPathMtuProbe ||
+                frame->control.type == mux::kControlPathMtuAck)) {
+      // Probes are answered whether or not this side searches too.
+      const auto& payload = frame->control.payload;
+      if (payload.size() >= 5 && payload[0] == mux::kPathMtuVersion) {
+        const std::uint32_t id = std::uint32_t{payload[1]} << 24 | std::uint32_t{payload[2]} << 16 |
+                                 std::uint32_t{payload[3]} << 8 | payload[4];
+        if (frame->control.type == mux::kControlPathMtuProbe) {
+          path_mtu_acks_.push_back(id);
+        } else if (config_.enable_path_mtu_discovery) {
+          path_mtu_.on_probe_acked(id, now_fn_());
+          apply_path_mtu();
+        }
+      }
+    } else if (frame->kind == mux::FrameKind::kControl &&
+               frame->control.type == mux::kControlFlowCredit) {
+      if (config_.enable_flow_control) {
+        if (auto credit = mux::parse_flow_credit(frame->control)) {
+          on_flow_credit(*credit);
+        }
       }
     } else {
       // Non-data frames (ACK, control, heartbeat) - return directly
-      frames.push_back(std::move(*frame));
+      out.push_back(std::move(*frame));
     }
-  } else {
-    // Log frame decode failure for debugging (Issue #72)
-    LOG_DEBUG("  Frame decode FAILED: decrypted_size={}, first_byte={:#04x}",
-              decrypted->size(), decrypted->empty() ? 0 : (*decrypted)[0]);
   }
+}
 
-  if (sequence > recv_sequence_max_) {
-    recv_sequence_max_ = sequence;
+void TransportSession::deliver_recovered(std::vector<mux::RecoveredPacket> recovered,
+                                         std::vector<mux::MuxFrame>& out) {
+  for (auto& packet : recovered) {
+    // A rebuilt packet counts as received: a late original is then dropped as a replay.
+    if (!replay_window_.mark_and_check(packet.sequence)) {
+      continue;
+    }
+    auto decoded = mux::MuxCodec::decode_all(packet.plaintext);
+    if (!decoded) {
+      continue;
+    }
+    LOG_DEBUG("FEC rebuilt packet: sequence={}, size={}", packet.sequence, packet.plaintext.size());
+    ++stats_.fec_packets_recovered;
+    if (packet.sequence > recv_sequence_max_) {
+      recv_sequence_max_ = packet.sequence;
+    }
+    deliver_frames(packet.sequence, *decoded, out);
+  }
+}
+
+void TransportSession::protect_packet(std::span<const std::uint8_t> plaintext) {
+  if (!fec_active_) {
+    return;
+  }
+  // The repair is sealed later (append_fec_repairs()), so the caller's packet stays the
+  // last one sealed, at send_sequence_ - 1.
+  if (auto repair = fec_encoder_.protect(send_sequence_ - 1, plaintext)) {
+    fec_repairs_.push_back(std::move(*repair));
+  }
+}
+
+void TransportSession::append_fec_repairs(std::vector<std::vector<std::uint8_t>>& out) {
+  for (auto& repair : fec_repairs_) {
+    auto encrypted = build_encrypted_packet(mux::make_fec_repair_frame(std::move(repair)));
+    ++stats_.packets_sent;
+    ++stats_.fec_repairs_sent;
+    stats_.bytes_sent += encrypted.size();
+    ++packets_since_rotation_;
+    out.push_back(std::move(encrypted));
+  }
+  fec_repairs_.clear();
+}
+
+std::optional<mux::MuxFrame> TransportSession::take_fec_params_frame() {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  if (!config_.enable_fec) {
+    return std::nullopt;
+  }
+  const auto group_size = fec_decoder_.group_size();
+  if (group_size == fec_params_sent_) {
+    return std::nullopt;
+  }
+  fec_params_sent_ = group_size;
+  return mux::make_control_frame(
+      mux::kControlFecParams,
+      {mux::kFecParamsVersion, static_cast<std::uint8_t>(group_size)});
+}
+
+std::optional<mux::MuxFrame> TransportSession::take_wire_format_frame() {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  if (!config_.compact_wire_format || wire_format_sent_) {
+    return std::nullopt;
+  }
+  wire_format_sent_ = true;
+  return mux::make_control_frame(
+      mux::kControlWireFormat,
+      {mux::kWireFormatVersion, static_cast<std::uint8_t>(mux::WireFormat::kV2)});
+}
+
+std::optional<mux::MuxFrame> TransportSession::take_datagram_mode_frame() {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  if (!config_.datagram_mode || datagram_mode_sent_) {
+    return std::nullopt;
   }
+  datagram_mode_sent_ = true;
+  const std::uint8_t flags = config_.datagram_loss_feedback ? mux::kDatagramModeAcks : 0;
+  return mux::make_control_frame(mux::kControlDatagramMode, {mux::kDatagramModeVersion, flags});
+}
+
+std::optional<mux::MuxFrame> TransportSession::take_frame_packing_frame() {
+  VEIL_DCHECK_THREAD(thread_checker_);
 
+  if (!config_.frame_packing || frame_packing_sent_) {
+    return std::nullopt;
+  }
+  frame_packing_sent_ = true;
+  return mux::make_control_frame(mux::kControlFramePacking, {mux::kFramePackingVersion});
+}
+
+std::optional<mux::MuxFrame> TransportSession::take_ack_ranges_frame() {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  if (!config_.ack_ranges || ack_ranges_sent_) {
+    return std::nullopt;
+  }
+  ack_ranges_sent_ = true;
+  return mux::make_control_frame(mux::kControlAckRanges, {mux::kAckRangesOfferVersion});
+}
+
+std::optional<mux::MuxFrame> TransportSession::take_header_compression_frame() {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  if (!config_.enable_header_compression || header_compression_sent_) {
+    return std::nullopt;
+  }
+  header_compression_sent_ = true;
+  return mux::make_control_frame(mux::kControlHeaderCompression,
+                                 {mux::kHeaderCompressionVersion});
+}
+
+std::vector<std::vector<std::uint8_t>> TransportSession::take_path_mtu_packets() {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  const auto probe_payload = [](std::uint32_t id) {
+    return std::vector<std::uint8_t>{mux::kPathMtuVersion, static_cast<std::uint8_t>(id >> 24),
+                                     static_cast<std::uint8_t>(id >> 16),
+                                     static_cast<std::uint8_t>(id >> 8),
+                                     static_cast<std::uint8_t>(id)};
+  };
+
+  std::vector<std::vector<std::uint8_t>> result;
+  for (const auto id : path_mtu_acks_) {
+    for (auto& packet :
+         queue_frame(mux::make_control_frame(mux::kControlPathMtuAck, probe_payload(id)))) {
+      result.push_back(std::move(packet));
+    }
+  }
+  path_mtu_acks_.clear();
+  if (!config_.enable_path_mtu_discovery) {
+    return result;
+  }
+
+  const auto now = now_fn_();
+  if (const auto size = path_mtu_.probe_due(now)) {
+    // Padded up to the probed size, on its own in the packet. The padding is encrypted
+    // like any payload, so a probe looks like a full-sized data packet.
+    std::vector<mux::MuxFrame> probe = {
+        mux::make_control_frame(mux::kControlPathMtuProbe, probe_payload(next_probe_id_))};
+    auto& padded = probe[0].control.payload;
+    const auto unpadded = mux::MuxCodec::encoded_size(probe[0], send_format_) + kPacketOverhead;
+    if (*size > unpadded) {
+      padded.resize(padded.size() + *size - unpadded);
+      // A longer payload may take a longer length field.
+      const auto over = mux::MuxCodec::encoded_size(probe[0], send_format_) + kPacketOverhead;
+      if (over > *size) {
+        padded.resize(padded.size() - (over - *size));
+      }
+    }
+    auto packet = encrypt_frames(probe);
+    path_mtu_.on_probe_sent(next_probe_id_++, packet.size(), now);
+    result.push_back(std::move(packet));
+  }
+  // A lost probe may have been the last confirmation of a black hole.
+  apply_path_mtu();
+  return result;
+}
+
+void TransportSession::apply_path_mtu() {
+  const auto gained = path_mtu_.path_size() - config_.mtu;
+  if (config_.max_fragment_size + gained == max_payload_size_) {
+    return;
+  }
+  LOG_INFO("Path MTU {} (base {}): payload size {} -> {}", path_mtu_.path_size(), config_.mtu,
+           max_payload_size_, config_.max_fragment_size + gained);
+  max_payload_size_ = config_.max_fragment_size + gained;
+  frame_packer_.set_max_batch_size(path_mtu_.path_size() > kPacketOverhead
+                                       ? path_mtu_.path_size() - kPacketOverhead
+                                       : 0);
+}
+
+std::optional<mux::MuxFrame> TransportSession::take_payload_compression_frame() {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  if (!config_.enable_payload_compression || payload_compression_sent_) {
+    return std::nullopt;
+  }
+  payload_compression_sent_ = true;
+  return mux::make_control_frame(mux::kControlPayloadCompression,
+                                 {mux::kPayloadCompressionVersion});
+}
+
+std::vector<mux::MuxFrame> TransportSession::take_flow_control_frames() {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  const auto now = now_fn_();
+  stats_.messages_expired +=
+      fragment_reassembly_.cleanup_expired(now, [this](std::uint64_t stream_id, std::size_t bytes) {
+        on_data_consumed(stream_id, bytes);
+      });
+
+  std::vector<mux::MuxFrame> frames;
+  if (!config_.enable_flow_control) {
+    return frames;
+  }
+  const std::chrono::microseconds rtt = retransmit_buffer_.estimated_rtt();
+  auto add = [&frames](mux::FlowCreditKind kind, std::uint64_t stream_id,
+                       std::optional<std::uint64_t> offset) {
+    if (offset) {
+      frames.push_back(mux::make_flow_credit_frame(mux::FlowCredit{kind, stream_id, *offset}));
+    }
+  };
+  add(mux::FlowCreditKind::kLimit, mux::kSessionCreditId,
+      session_receive_window_.take_update(now, rtt));
+  for (auto& [stream_id, window] : receive_windows_) {
+    add(mux::FlowCreditKind::kLimit, stream_id, window.take_update(now, rtt));
+  }
+  // Blocked reports at most once per round trip, until credit arrives.
+  add(mux::FlowCreditKind::kBlocked, mux::kSessionCreditId,
+      session_send_window_.take_blocked_report(now, rtt));
+  for (auto& [stream_id, window] : send_windows_) {
+    add(mux::FlowCreditKind::kBlocked, stream_id, window.take_blocked_report(now, rtt));
+  }
   return frames;
 }
 
+std::vector<std::vector<std::uint8_t>> TransportSession::release_flow_blocked() {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  std::vector<std::vector<std::uint8_t>> result;
+  while (!flow_blocked_.empty() &&
+         flow_allows(flow_blocked_.front().stream_id, flow_blocked_.front().payload.size())) {
+    auto data = std::move(flow_blocked_.front());
+    flow_blocked_.pop_front();
+    flow_blocked_bytes_ -= data.payload.size();
+    for (auto& encrypted : send_data(data.payload, data.stream_id, data.fin)) {
+      result.push_back(std::move(encrypted));
+    }
+  }
+  return result;
+}
+
+bool TransportSession::flow_allows(std::uint64_t stream_id, std::size_t bytes) {
+  auto* stream = send_window(stream_id);
+  bool allowed = true;
+  if (stream != nullptr && !stream->can_send(bytes)) {
+    stream->set_blocked();
+    allowed = false;
+  }
+  if (!session_send_window_.can_send(bytes)) {
+    session_send_window_.set_blocked();
+    allowed = false;
+  }
+  if (allowed) {
+    if (stream != nullptr) {
+      stream->on_sent(bytes);
+    }
+    session_send_window_.on_sent(bytes);
+  }
+  return allowed;
+}
+
+mux::SendWindow* TransportSession::send_window(std::uint64_t stream_id) {
+  auto it = send_windows_.find(stream_id);
+  if (it == send_windows_.end()) {
+    if (stream_id == mux::kSessionCreditId || send_windows_.size() >= kMaxFlowStreams) {
+      return nullptr;
+    }
+    it = send_windows_.emplace(stream_id, mux::SendWindow{}).first;
+  }
+  return &it->second;
+}
+
+mux::ReceiveWindow* TransportSession::receive_window(std::uint64_t stream_id) {
+  auto it = receive_windows_.find(stream_id);
+  if (it == receive_windows_.end()) {
+    if (stream_id == mux::kSessionCreditId || receive_windows_.size() >= kMaxFlowStreams) {
+      return nullptr;
+    }
+    it = receive_windows_
+             .try_emplace(stream_id, config_.flow_control.initial_stream_window,
+                          config_.flow_control.max_stream_window)
+             .first;
+  }
+  return &it->second;
+}
+
+void TransportSession::on_flow_credit(const mux::FlowCredit& credit) {
+  const bool session = credit.stream_id == mux::kSessionCreditId;
+  if (credit.kind == mux::FlowCreditKind::kLimit) {
+    auto* window = session ? &session_send_window_ : send_window(credit.stream_id);
+    if (window != nullptr) {
+      window->on_limit(credit.offset);
+    }
+    return;
+  }
+  // Blocked reports only concern windows this side has advertised.
+  if (session) {
+    session_receive_window_.on_peer_blocked(credit.offset);
+  } else if (auto it = receive_windows_.find(credit.stream_id); it != receive_windows_.end()) {
+    it->second.on_peer_blocked(credit.offset);
+  }
+}
+
+void TransportSession::on_data_received(std::uint64_t stream_id, std::size_t bytes) {
+  if (!config_.enable_flow_control) {
+    return;
+  }
+  auto* stream = receive_window(stream_id);
+  const bool stream_ok = stream == nullptr || stream->on_received(bytes);
+  if (!session_receive_window_.on_received(bytes) || !stream_ok) {
+    ++stats_.flow_control_violations;
+  }
+}
+
+void TransportSession::on_data_consumed(std::uint64_t stream_id, std::size_t bytes) {
+  if (!config_.enable_flow_control) {
+    return;
+  }
+  if (auto* stream = receive_window(stream_id)) {
+    stream->on_consumed(bytes);
+  }
+  session_receive_window_.on_consumed(bytes);
+}
+
+void TransportSession::abandon_flow_credit(std::span<const std::uint8_t> plaintext) {
+  auto frames = mux::MuxCodec::decode_all(plaintext);
+  if (!frames) {
+    return;
+  }
+  for (const auto& frame : *frames) {
+    if (frame.kind != mux::FrameKind::kData) {
+      continue;
+    }
+    if (auto* stream = send_window(frame.data.stream_id)) {
+      stream->on_abandoned(frame.data.payload.size());
+    }
+    session_send_window_.on_abandoned(frame.data.payload.size());
+  }
+}
+
 std::vector<std::vector<std::uint8_t>> TransportSession::get_retransmit_packets() {
   VEIL_DCHECK_THREAD(thread_checker_);
 
+  // RACK: packets whose reordering window ran out since the last ACK are lost now.
+  const auto lost = retransmit_buffer_.detect_lost_packets();
+  if (config_.enable_congestion_control) {
+    on_packets_lost(lost);
+  }
+
   std::vector<std::vector<std::uint8_t>> result;
   auto to_retransmit = retransmit_buffer_.get_packets_to_retransmit();
 
@@ -296,22 +1196,60 @@ std::vector<std::vector<std::uint8_t>> TransportSession::get_retransmit_packets(
   // Congestion control (Issue #98): Notify controller of timeout-based retransmits.
   // This is a timeout loss event, which should trigger multiplicative decrease.
   bool notified_timeout = false;
+  bool timeout_loss = false;
 
   for (const auto* pkt : to_retransmit) {
-    if (retransmit_buffer_.mark_retransmitted(pkt->sequence)) {
-      result.push_back(pkt->data);
+    // Declared lost by an ACK or the RACK timer: already reported to congestion control.
+    const bool fast = pkt->lost;
+    // A tail loss probe is not a loss; the ACK it draws reports any.
+    const bool probe = pkt->probe;
+    // Each retransmission is sealed under the next send sequence, so its ACK tells it
+    // apart from the original: every ACK is an RTT sample (no Karn ambiguity) and a
+    // spurious loss shows as an ACK of the old sequence. SECURITY: the nonce is derived
+    // from send_sequence_ as for any packet, so it is never reused.
+    const auto original_sequence = pkt->sequence;
+    if (retransmit_buffer_.mark_retransmitted(original_sequence, send_sequence_)) {
+      result.push_back(seal_packet(pkt->data));
+      protect_packet(pkt->data);
+      ++packets_since_rotation_;
       ++stats_.retransmits;
+      if (fast) {
+        ++stats_.fast_retransmits;
+        continue;
+      }
+      if (probe) {
+        ++stats_.tail_loss_probes;
+        continue;
+      }
 
+      timeout_loss = true;
       // Notify congestion controller of timeout loss (once per batch).
       if (config_.enable_congestion_control && !notified_timeout) {
-        congestion_controller_.on_timeout_loss();
+        congestion_controller_->on_timeout_loss();
+        arm_loss_undo();
         notified_timeout = true;
       }
     } else {
       // Exceeded max retries, drop packet.
-      retransmit_buffer_.drop_packet(pkt->sequence);
+      if (config_.enable_flow_control) {
+        abandon_flow_credit(pkt->data);
+      }
+      retransmit_buffer_.drop_packet(original_sequence);
+    }
+  }
+
+  // A retransmission timeout may be a path that stopped carrying the discovered size.
+  if (timeout_loss && config_.enable_path_mtu_discovery) {
+    path_mtu_.on_timeout_loss(now_fn_());
+  }
+
+  // FEC: close a group that has waited long enough, so a burst's tail is protected.
+  if (fec_active_) {
+    if (auto repair = fec_encoder_.poll()) {
+      fec_repairs_.push_back(std::move(*repair));
     }
   }
+  append_fec_repairs(result);
 
   return result;
 }
@@ -324,6 +1262,18 @@ void TransportSession::process_ack(const mux::AckFrame& ack) {
   LOG_DEBUG("process_ack called: stream_id={}, ack={}, bitmap={:#010x}, pending_before={}",
             ack.stream_id, ack.ack, ack.bitmap, retransmit_buffer_.pending_count());
 
+  on_peer_acked(ack.ack);
+  // Plain ACKs carry no ECN counts. Before extended ACKs are negotiated that says nothing
+  // about ECN, which is not sent yet.
+  if (ack_ranges_active_) {
+    validate_ecn(false);
+  }
+  if (ack.stream_id == mux::kDatagramStreamId) {
+    process_datagram_ack(mux::ack_ranges_from_bitmap(ack.ack, ack.bitmap), false,
+                         std::chrono::microseconds{0});
+    return;
+  }
+
   // Track bytes acknowledged for congestion control (Issue #98).
   const std::size_t bytes_before = retransmit_buffer_.buffered_bytes();
 
@@ -331,10 +1281,10 @@ void TransportSession::process_ack(const mux::AckFrame& ack) {
   if (config_.enable_congestion_control && ack.ack == last_ack_seq_ && ack.ack > 0) {
     ++dup_ack_count_;
     // Notify congestion controller of duplicate ACK.
-    if (congestion_controller_.on_duplicate_ack()) {
+    if (congestion_controller_->on_duplicate_ack()) {
       // Trigger fast retransmit.
       LOG_DEBUG("Fast retransmit triggered: dup_ack_count={}, ack_seq={}", dup_ack_count_, ack.ack);
-      congestion_controller_.on_fast_retransmit_loss();
+      congestion_controller_->on_fast_retransmit_loss();
     }
   } else {
     // New ACK - reset duplicate count.
@@ -343,8 +1293,8 @@ void TransportSession::process_ack(const mux::AckFrame& ack) {
 
     // If we were in fast recovery and got a new ACK, recovery is complete.
     if (config_.enable_congestion_control &&
-        congestion_controller_.state() == mux::CongestionState::kFastRecovery) {
-      congestion_controller_.on_recovery_complete();
+        congestion_controller_->state() == mux::CongestionState::kFastRecovery) {
+      congestion_controller_->on_recovery_complete();
     }
   }
 
@@ -366,11 +1316,15 @@ void TransportSession::process_ack(const mux::AckFrame& ack) {
     const std::size_t bytes_after = retransmit_buffer_.buffered_bytes();
     if (bytes_before > bytes_after) {
       const std::size_t acked_bytes = bytes_before - bytes_after;
-      congestion_controller_.on_ack(acked_bytes);
+      congestion_controller_->on_ack(acked_bytes);
+      if (auto sample = retransmit_buffer_.take_rate_sample()) {
+        congestion_controller_->on_rate_sample(*sample);
+      }
 
       // Update pacing rate based on current RTT.
-      congestion_controller_.set_srtt(retransmit_buffer_.estimated_rtt());
+      congestion_controller_->set_srtt(retransmit_buffer_.estimated_rtt());
     }
+    check_loss_undo();
   }
 
   // Debug logging for ACK processing result (Issue #72)
@@ -378,16 +1332,258 @@ void TransportSession::process_ack(const mux::AckFrame& ack) {
   LOG_DEBUG("process_ack done: pending_after={}", retransmit_buffer_.pending_count());
 }
 
+void TransportSession::on_peer_acked(std::uint64_t sequence) {
+  // An ACK for a sequence not sent yet is bogus; it must not shrink the headers.
+  if (sequence < send_sequence_ && (!peer_largest_acked_ || sequence > *peer_largest_acked_)) {
+    peer_largest_acked_ = sequence;
+  }
+}
+
+void TransportSession::process_datagram_ack(std::span<const mux::AckRange> ranges,
+                                            bool new_ce, std::chrono::microseconds ack_delay) {
+  if (ranges.empty()) {
+    return;
+  }
+  const auto largest = ranges.front().largest;
+
+  std::size_t acked_bytes = 0;
+  std::uint64_t lost = 0;
+  std::uint64_t largest_lost = 0;
+  std::optional<TimePoint> largest_sent_at;
+  std::erase_if(datagrams_in_flight_, [&](const SentDatagram& sent) {
+    if (sent.sequence > largest) {
+      return false;
+    }
+    if (mux::ack_ranges_contain(ranges, sent.sequence)) {
+      acked_bytes += sent.bytes;
+      if (sent.sequence == largest) {
+        largest_sent_at = sent.sent_at;
+      }
+    } else if (sent.sequence + kDatagramReorderThreshold <= largest) {
+      ++lost;
+      largest_lost = std::max(largest_lost, sent.sequence);
+    } else {
+      return false;  // Possibly reordered; wait for a later ACK.
+    }
+    datagram_bytes_in_flight_ -= sent.bytes;
+    return true;
+  });
+
+  stats_.datagrams_lost += lost;
+  // Datagrams are never resent, so every newly acknowledged one is an unambiguous RTT
+  // sample; without it the pacing rate would stay at the initial guess of the RTT.
+  if (largest_sent_at) {
+    auto rtt_sample = now_fn_() - *largest_sent_at;
+    if (rtt_sample > ack_delay) {
+      rtt_sample -= ack_delay;
+    }
+    retransmit_buffer_.add_rtt_sample(
+        std::chrono::duration_cast<std::chrono::milliseconds>(rtt_sample));
+  }
+  if (!config_.enable_congestion_control) {
+    return;
+  }
+  // One window reduction per round trip, as for DATA: a later ACK reporting datagrams
+  // sent before the last reduction belongs to the same congestion event.
+  if (lost > 0) {
+    if (largest_lost >= recovery_start_sequence_) {
+      congestion_controller_->on_fast_retransmit_loss();
+      recovery_start_sequence_ = send_sequence_;
+    }
+  } else if (new_ce) {
+    congestion_controller_->on_ecn_ce();
+    recovery_start_sequence_ = send_sequence_;
+  } else if (acked_bytes > 0 && window_limited()) {
+    congestion_controller_->on_ack(acked_bytes);
+  }
+  peak_bytes_in_flight_ = bytes_in_flight();
+  window_held_back_ = false;
+  // Update pacing rate based on current RTT and window.
+  congestion_controller_->set_srtt(retransmit_buffer_.estimated_rtt());
+}
+
+void TransportSession::validate_ecn(bool has_counts) {
+  if (has_counts) {
+    ecn_validated_ = true;
+  } else if (!ecn_validated_ && !ecn_failed_ && config_.enable_ecn) {
+    ecn_failed_ = true;
+    LOG_DEBUG("ECN disabled: the peer's ACKs carry no ECN counts");
+  }
+}
+
+bool TransportSession::take_new_ce(const std::optional<mux::EcnCounts>& ecn,
+                                   std::uint64_t largest) {
+  if (!ecn || ecn->ce <= peer_ecn_ce_) {
+    return false;
+  }
+  peer_ecn_ce_ = ecn->ce;
+  return largest >= recovery_start_sequence_;
+}
+
 mux::AckFrame TransportSession::generate_ack(std::uint64_t stream_id) {
   VEIL_DCHECK_THREAD(thread_checker_);
 
   return mux::AckFrame{
       .stream_id = stream_id,
-      .ack = recv_ack_bitmap_.head(),
-      .bitmap = recv_ack_bitmap_.bitmap(),
+      .ack = recv_ack_ranges_.largest(),
+      .bitmap = recv_ack_ranges_.bitmap(),
   };
 }
 
+mux::AckRangesFrame TransportSession::generate_ack_ranges(std::uint64_t stream_id) {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  mux::AckRangesFrame ack;
+  ack.stream_id = stream_id;
+  ack.ranges = recv_ack_ranges_.ranges();
+  if (!ack.ranges.empty()) {
+    ack.ack_delay =
+        std::chrono::duration_cast<std::chrono::microseconds>(now_fn_() - largest_received_time_);
+  }
+  if (recv_ecn_.ect0 != 0 || recv_ecn_.ect1 != 0 || recv_ecn_.ce != 0) {
+    ack.ecn = recv_ecn_;
+  }
+  return ack;
+}
+
+void TransportSession::process_ack(const mux::AckRangesFrame& ack) {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  if (ack.ranges.empty()) {
+    return;
+  }
+  on_peer_acked(ack.ranges.front().largest);
+  validate_ecn(ack.ecn.has_value());
+  const bool new_ce = take_new_ce(ack.ecn, ack.ranges.front().largest);
+  if (ack.stream_id == mux::kDatagramStreamId) {
+    process_datagram_ack(ack.ranges, new_ce, ack.ack_delay);
+    return;
+  }
+
+  const auto result = retransmit_buffer_.acknowledge_ranges(ack.ranges, ack.ack_delay);
+  LOG_DEBUG("process_ack (ranges): largest={}, ranges={}, ack_delay={}us, acked={}, lost={}, "
+            "pending_after={}",
+            ack.ranges.front().largest, ack.ranges.size(), ack.ack_delay.count(),
+            result.acked_packets, result.lost_packets, retransmit_buffer_.pending_count());
+
+  if (!config_.enable_congestion_control) {
+    return;
+  }
+
+  // One window reduction per round trip: a loss or CE mark on a packet sent before the
+  // last reduction belongs to the congestion event already handled (RFC 9002 7.3.2).
+  const auto largest = ack.ranges.front().largest;
+  if (!on_packets_lost(result)) {
+    if (new_ce) {
+      congestion_controller_->on_ecn_ce();
+      recovery_start_sequence_ = send_sequence_;
+    } else if (congestion_controller_->state() == mux::CongestionState::kFastRecovery &&
+               largest >= recovery_start_sequence_) {
+      // A packet sent after the reduction was acknowledged: the lost window is repaired.
+      congestion_controller_->on_recovery_complete();
+    }
+  }
+
+  if (result.acked_bytes > 0) {
+    // Bytes acknowledged here have left the network, so unlike duplicate ACKs they do
+    // not inflate the window during recovery (RFC 6675).
+    if (congestion_controller_->state() != mux::CongestionState::kFastRecovery) {
+      congestion_controller_->on_ack(result.acked_bytes);
+    }
+    if (auto sample = retransmit_buffer_.take_rate_sample()) {
+      congestion_controller_->on_rate_sample(*sample);
+    }
+    congestion_controller_->set_srtt(retransmit_buffer_.estimated_rtt());
+  }
+  check_loss_undo();
+}
+
+bool TransportSession::on_packets_lost(const mux::AckRangesResult& result) {
+  if (result.lost_packets == 0 || result.largest_lost < recovery_start_sequence_) {
+    return false;
+  }
+  congestion_controller_->on_fast_retransmit_loss();
+  recovery_start_sequence_ = send_sequence_;
+  arm_loss_undo();
+  return true;
+}
+
+void TransportSession::arm_loss_undo() {
+  if (loss_undo_armed_ || retransmit_buffer_.suspected_count() == 0) {
+    return;
+  }
+  loss_undo_armed_ = true;
+  loss_undo_genuine_mark_ = retransmit_buffer_.stats().genuine_losses;
+}
+
+void TransportSession::check_loss_undo() {
+  if (!loss_undo_armed_) {
+    return;
+  }
+  if (retransmit_buffer_.stats().genuine_losses != loss_undo_genuine_mark_) {
+    loss_undo_armed_ = false;
+    congestion_controller_->on_loss_confirmed();
+    return;
+  }
+  if (retransmit_buffer_.suspected_count() != 0) {
+    return;
+  }
+  // Every packet behind the reduction was delivered by its original transmission.
+  loss_undo_armed_ = false;
+  ++stats_.loss_undos;
+  congestion_controller_->on_spurious_loss();
+}
+
+void TransportSession::record_ecn(std::uint8_t ecn) {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  switch (ecn & 0x03) {
+    case 0x01:
+      ++recv_ecn_.ect1;
+      break;
+    case 0x02:
+      ++recv_ecn_.ect0;
+      break;
+    case 0x03:
+      ++recv_ecn_.ce;
+      break;
+    default:
+      break;  // Not-ECT.
+  }
+}
+
+void TransportSession::apply_outer_ecn(std::uint8_t ecn, std::vector<mux::MuxFrame>& frames) {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  record_ecn(ecn);
+  if ((ecn & 0x03) != 0x03) {
+    return;
+  }
+  std::erase_if(frames, [this](mux::MuxFrame& frame) {
+    if (frame.kind != mux::FrameKind::kData && frame.kind != mux::FrameKind::kDatagram) {
+      return false;
+    }
+    auto& payload =
+        frame.kind == mux::FrameKind::kData ? frame.data.payload : frame.datagram.payload;
+    if (mux::mark_ecn_ce(payload)) {
+      ++stats_.ecn_ce_propagated;
+      return false;
+    }
+    if (frame.kind == mux::FrameKind::kData) {
+      return false;
+    }
+    ++stats_.ecn_ce_dropped;
+    return true;
+  });
+}
+
+void TransportSession::record_received(std::uint64_t sequence) {
+  if (recv_ack_ranges_.empty() || sequence > recv_ack_ranges_.largest()) {
+    largest_received_time_ = now_fn_();
+  }
+  recv_ack_ranges_.add(sequence);
+}
+
 bool TransportSession::should_rotate_session() {
   VEIL_DCHECK_THREAD(thread_checker_);
   return session_rotator_.should_rotate(packets_since_rotation_, now_fn_());
@@ -443,6 +1639,12 @@ void TransportSession::rotate_session() {
 }
 
 std::vector<std::uint8_t> TransportSession::build_encrypted_packet(const mux::MuxFrame& frame) {
+  // Serialize the frame.
+  const auto plaintext = mux::MuxCodec::encode(frame, send_format_);
+  return seal_packet(plaintext);
+}
+
+std::vector<std::uint8_t> TransportSession::seal_packet(std::span<const std::uint8_t> plaintext) {
   // SECURITY: Check for sequence number overflow (extremely unlikely but provides defense in depth)
   // At 10 Gbps with 1KB packets, reaching this threshold would take millions of years,
   // but we check anyway to catch any implementation bugs that might cause unexpected growth.
@@ -454,9 +1656,6 @@ std::vector<std::uint8_t> TransportSession::build_encrypted_packet(const mux::Mu
     // A production system might want to force session termination here.
   }
 
-  // Serialize the frame.
-  auto plaintext = mux::MuxCodec::encode(frame);
-
   // Derive nonce from current send sequence.
   // SECURITY: Each packet gets a unique nonce = base_nonce XOR send_sequence_
   // Since send_sequence_ is never reset and always increments, nonces are guaranteed unique.
@@ -465,30 +1664,23 @@ std::vector<std::uint8_t> TransportSession::build_encrypted_packet(const mux::Mu
   // Encrypt using ChaCha20-Poly1305 AEAD.
   auto ciphertext = crypto::aead_encrypt(keys_.send_key, nonce, {}, plaintext);
 
-  // DPI RESISTANCE (Issue #21): Obfuscate sequence number before transmission.
-  // Previously, the sequence was sent in plaintext, creating a DPI signature (monotonically
-  // increasing values). Now we obfuscate it using ChaCha20 with a session-specific key.
-  // The receiver can deobfuscate using the same key to recover the sequence for nonce derivation.
-  const std::uint64_t obfuscated_sequence = crypto::obfuscate_sequence(send_sequence_, send_seq_obfuscation_key_);
-
   // Enhanced diagnostic logging for encryption (Issue #69)
   // Log key fingerprints (first 4 bytes) to help diagnose key mismatch between client and server
-  LOG_DEBUG("Encrypt: session_id={}, sequence={}, obfuscated_seq={:#018x}, plaintext_size={}, "
+  LOG_DEBUG("Encrypt: session_id={}, sequence={}, plaintext_size={}, "
             "send_key_fp={:02x}{:02x}{:02x}{:02x}, send_nonce_fp={:02x}{:02x}{:02x}{:02x}",
-            current_session_id_, send_sequence_, obfuscated_sequence, plaintext.size(),
+            current_session_id_, send_sequence_, plaintext.size(),
             keys_.send_key[0], keys_.send_key[1], keys_.send_key[2], keys_.send_key[3],
             keys_.send_nonce[0], keys_.send_nonce[1], keys_.send_nonce[2], keys_.send_nonce[3]);
   LOG_DEBUG("  send_seq_obfuscation_key_fp={:02x}{:02x}{:02x}{:02x}",
             send_seq_obfuscation_key_[0], send_seq_obfuscation_key_[1],
             send_seq_obfuscation_key_[2], send_seq_obfuscation_key_[3]);
 
-  // Prepend obfuscated sequence number (8 bytes big-endian).
-  std::vector<std::uint8_t> packet;
-  packet.reserve(8 + ciphertext.size());
-  for (int i = 7; i >= 0; --i) {
-    packet.push_back(static_cast<std::uint8_t>((obfuscated_sequence >> (8 * i)) & 0xFF));
-  }
+  // Prepend the packet header (sequence), written once the tag it is masked with is in place.
+  const std::size_t header_size = packet_header_size();
+  std::vector<std::uint8_t> packet(header_size);
+  packet.reserve(header_size + ciphertext.size());
   packet.insert(packet.end(), ciphertext.begin(), ciphertext.end());
+  write_packet_header(packet, header_size);
 
   // SECURITY: Increment AFTER using the sequence number.
   // This ensures each packet uses a unique sequence, and the next packet will use the next value.
@@ -509,12 +1701,15 @@ std::vector<mux::MuxFrame> TransportSession::fragment_data(std::span<const std::
 
   // PERFORMANCE (Issue #94): Pre-calculate number of fragments and reserve capacity.
   // This avoids vector reallocations during fragment generation.
-  if (data.size() > config_.max_fragment_size) {
+  if (data.size() > max_payload_size_) {
     const std::size_t num_fragments = (data.size() + config_.max_fragment_size - 1) / config_.max_fragment_size;
     frames.reserve(num_fragments);
   }
 
-  if (data.size() <= config_.max_fragment_size) {
+  // Up to max_payload_size_ (larger than max_fragment_size once path MTU discovery found
+  // room) goes whole. Fragments are always cut at max_fragment_size: the receiver
+  // places them at index * max_fragment_size.
+  if (data.size() <= max_payload_size_) {
     // No fragmentation needed. Always set fin=true to indicate complete message.
     // Issue #74: Without fin=true, receiver can't distinguish complete messages from fragments.
     frames.push_back(mux::make_data_frame(
@@ -562,88 +1757,88 @@ bool TransportSession::can_send(std::size_t bytes_in_flight) const {
   if (!config_.enable_congestion_control) {
     return true;  // No congestion control, always allow.
   }
-  return congestion_controller_.can_send(bytes_in_flight);
+  return congestion_controller_->can_send(bytes_in_flight);
 }
 
 std::size_t TransportSession::sendable_bytes(std::size_t bytes_in_flight) const {
   if (!config_.enable_congestion_control) {
     return std::numeric_limits<std::size_t>::max();
   }
-  return congestion_controller_.sendable_bytes(bytes_in_flight);
+  return congestion_controller_->sendable_bytes(bytes_in_flight);
 }
 
 bool TransportSession::check_pacing() {
   if (!config_.enable_congestion_control) {
     return true;  // No congestion control, always allow.
   }
-  return congestion_controller_.check_pacing();
+  return congestion_controller_->check_pacing();
 }
 
 std::optional<std::chrono::microseconds> TransportSession::time_until_next_send() const {
   if (!config_.enable_congestion_control) {
     return std::nullopt;  // No congestion control, no pacing delay.
   }
-  return congestion_controller_.time_until_next_send();
+  return congestion_controller_->time_until_next_send();
 }
 
-// ========== Zero-Copy Packet Processing API (Issue #97) ==========
-
-std::optional<std::pair<mux::MuxFrameView, std::size_t>> TransportSession::decrypt_packet_zero_copy(
-    std::span<const std::uint8_t> ciphertext,
-    std::span<std::uint8_t> decrypt_buffer) {
-  VEIL_DCHECK_THREAD(thread_checker_);
-
-  // Minimum packet size: sequence (8 bytes) + tag (16 bytes) + header (1 byte minimum)
-  constexpr std::size_t kMinPacketSize = 8 + 16 + 1;
-  if (ciphertext.size() < kMinPacketSize) {
-    LOG_DEBUG("Zero-copy: Packet too small: {} bytes", ciphertext.size());
-    ++stats_.packets_dropped_decrypt;
-    return std::nullopt;
-  }
-
-  // Extract obfuscated sequence from first 8 bytes.
-  std::uint64_t obfuscated_sequence = 0;
-  for (int i = 0; i < 8; ++i) {
-    obfuscated_sequence = (obfuscated_sequence << 8) | ciphertext[static_cast<std::size_t>(i)];
+TransportSession::TimePoint TransportSession::pace_packet(std::size_t bytes) {
+  const auto now = now_fn_();
+  const auto& cc = config_.congestion_config;
+  const auto rate = congestion_controller_->pacing_rate();
+  if (!config_.enable_congestion_control || !cc.enable_pacing || rate == 0 ||
+      (datagram_mode_active_ && !datagram_acks_active_)) {
+    return now;
   }
+  const auto at_rate = [rate](std::size_t size) {
+    return std::chrono::nanoseconds(static_cast<std::int64_t>(size * 1000000000ULL / rate));
+  };
+  // An idle sender catches up by one burst, no more.
+  next_departure_ = std::max(next_departure_, now - at_rate(cc.max_pacing_burst * cc.mss));
+  const auto departure = std::max(next_departure_, now);
+  next_departure_ += at_rate(bytes);
+  return departure;
+}
 
-  // Deobfuscate sequence number.
-  const std::uint64_t sequence = crypto::deobfuscate_sequence(obfuscated_sequence, recv_seq_obfuscation_key_);
-
-  LOG_DEBUG("Zero-copy decrypt: session_id={}, pkt_size={}, seq={}", current_session_id_, ciphertext.size(), sequence);
-
-  // Replay check.
-  if (!replay_window_.mark_and_check(sequence)) {
-    LOG_DEBUG("Zero-copy: Packet replay detected: sequence={}", sequence);
-    ++stats_.packets_dropped_replay;
-    return std::nullopt;
+std::size_t TransportSession::paced_backlog_bytes() const {
+  const auto ahead = next_departure_ - now_fn_();
+  if (ahead <= TimePoint::duration::zero()) {
+    return 0;
   }
+  const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(ahead).count();
+  return static_cast<std::size_t>(static_cast<std::uint64_t>(ns) *
+                                  congestion_controller_->pacing_rate() / 1000000000ULL);
+}
 
-  // Derive nonce from sequence.
-  const auto nonce = crypto::derive_nonce(keys_.recv_nonce, sequence);
-
-  // Get ciphertext body (skip 8-byte sequence prefix).
-  auto ciphertext_body = ciphertext.subspan(8);
+bool TransportSession::send_backlogged() const {
+  return send_scheduler_.backlogged() ||
+         paced_backlog_bytes() > config_.send_scheduler_config.backpressure_bytes;
+}
 
-  // Check output buffer has enough space for plaintext.
-  const std::size_t max_plaintext_size = crypto::aead_plaintext_size(ciphertext_body.size());
-  if (decrypt_buffer.size() < max_plaintext_size) {
-    LOG_DEBUG("Zero-copy: Decrypt buffer too small: {} < {}", decrypt_buffer.size(), max_plaintext_size);
-    replay_window_.unmark(sequence);
-    ++stats_.packets_dropped_decrypt;
-    return std::nullopt;
-  }
+// ========== Zero-Copy Packet Processing API (Issue #97) ==========
 
-  // PERFORMANCE (Issue #97): Use zero-copy decryption into provided buffer.
-  const std::size_t plaintext_size = crypto::aead_decrypt_to(
-      keys_.recv_key, nonce, {}, ciphertext_body, decrypt_buffer);
+std::optional<std::pair<mux::MuxFrameView, std::size_t>> TransportSession::decrypt_packet_zero_copy(
+    std::span<const std::uint8_t> ciphertext,
+    std::span<std::uint8_t> decrypt_buffer) {
+  VEIL_DCHECK_THREAD(thread_checker_);
 
-  if (plaintext_size == 0) {
-    LOG_DEBUG("Zero-copy: Decryption failed: sequence={}", sequence);
-    replay_window_.unmark(sequence);
-    ++stats_.packets_dropped_decrypt;
+  // Replay check and decryption, for each header format the peer may have used.
+  std::size_t plaintext_size = 0;
+  const auto header = open_packet(ciphertext, [&](const PacketHeader& candidate) {
+    const auto ciphertext_body = ciphertext.subspan(candidate.size);
+    // Check output buffer has enough space for plaintext.
+    if (decrypt_buffer.size() < crypto::aead_plaintext_size(ciphertext_body.size())) {
+      LOG_DEBUG("Zero-copy: Decrypt buffer too small: {}", decrypt_buffer.size());
+      return false;
+    }
+    // PERFORMANCE (Issue #97): Use zero-copy decryption into provided buffer.
+    const auto nonce = crypto::derive_nonce(keys_.recv_nonce, candidate.sequence);
+    plaintext_size = crypto::aead_decrypt_to(keys_.recv_key, nonce, {}, ciphertext_body, decrypt_buffer);
+    return plaintext_size != 0;
+  });
+  if (!header) {
     return std::nullopt;
   }
+  const std::uint64_t sequence = header->sequence;
 
   LOG_DEBUG("Zero-copy decryption SUCCESS: session_id={}, sequence={}, plaintext_size={}",
             current_session_id_, sequence, plaintext_size);
@@ -661,7 +1856,10 @@ std::optional<std::pair<mux::MuxFrameView, std::size_t>> TransportSession::decry
 
   if (frame_view->kind == mux::FrameKind::kData) {
     ++stats_.fragments_received;
-    recv_ack_bitmap_.ack(sequence);
+    record_received(sequence);
+  } else if (frame_view->kind == mux::FrameKind::kDatagram) {
+    ++stats_.datagrams_received;
+    frame_view->datagram.sequence = sequence;
   }
 
   if (sequence > recv_sequence_max_) {
@@ -681,9 +1879,10 @@ std::size_t TransportSession::encrypt_frame_zero_copy(const mux::MuxFrame& frame
   }
 
   // Calculate required sizes.
-  const std::size_t plaintext_size = mux::MuxCodec::encoded_size(frame);
+  const std::size_t plaintext_size = mux::MuxCodec::encoded_size(frame, send_format_);
   const std::size_t ciphertext_size = crypto::aead_ciphertext_size(plaintext_size);
-  const std::size_t total_size = 8 + ciphertext_size;  // 8 bytes for sequence prefix
+  const std::size_t header_size = packet_header_size();
+  const std::size_t total_size = header_size + ciphertext_size;
 
   if (output_buffer.size() < total_size) {
     LOG_DEBUG("Zero-copy encrypt: Output buffer too small: {} < {}", output_buffer.size(), total_size);
@@ -697,7 +1896,7 @@ std::size_t TransportSession::encrypt_frame_zero_copy(const mux::MuxFrame& frame
   encode_scratch_buffer_.resize(plaintext_size);
 
   // Encode frame into scratch buffer.
-  const std::size_t encoded_size = mux::MuxCodec::encode_to(frame, encode_scratch_buffer_);
+  const std::size_t encoded_size = mux::MuxCodec::encode_to(frame, encode_scratch_buffer_, send_format_);
   if (encoded_size == 0) {
     LOG_DEBUG("Zero-copy encrypt: Frame encoding failed");
     return 0;
@@ -706,33 +1905,27 @@ std::size_t TransportSession::encrypt_frame_zero_copy(const mux::MuxFrame& frame
   // Derive nonce from current send sequence.
   const auto nonce = crypto::derive_nonce(keys_.send_nonce, send_sequence_);
 
-  // Obfuscate sequence for DPI resistance.
-  const std::uint64_t obfuscated_sequence = crypto::obfuscate_sequence(send_sequence_, send_seq_obfuscation_key_);
-
-  // Write obfuscated sequence prefix (8 bytes big-endian).
-  for (int i = 7; i >= 0; --i) {
-    output_buffer[static_cast<std::size_t>(7 - i)] =
-        static_cast<std::uint8_t>((obfuscated_sequence >> (8 * i)) & 0xFF);
-  }
-
   // PERFORMANCE (Issue #97): Use zero-copy encryption into output buffer.
   const std::size_t encrypted_size = crypto::aead_encrypt_to(
       keys_.send_key, nonce, {},
       std::span<const std::uint8_t>(encode_scratch_buffer_.data(), encoded_size),
-      output_buffer.subspan(8));
+      output_buffer.subspan(header_size));
 
   if (encrypted_size == 0) {
     LOG_DEBUG("Zero-copy encrypt: Encryption failed");
     return 0;
   }
 
+  // Sequence header, masked from the tag in v2 (obfuscated in v1, for DPI resistance).
+  write_packet_header(output_buffer.first(header_size + encrypted_size), header_size);
+
   LOG_DEBUG("Zero-copy encrypt: session_id={}, sequence={}, plaintext_size={}, total_size={}",
-            current_session_id_, send_sequence_, plaintext_size, 8 + encrypted_size);
+            current_session_id_, send_sequence_, plaintext_size, header_size + encrypted_size);
 
   // Increment sequence after successful encryption.
   ++send_sequence_;
 
-  return 8 + encrypted_size;
+  return header_size + encrypted_size;
 }
 
 }  // namespace veil::transport
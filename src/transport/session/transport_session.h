@@ -1,8 +1,11 @@
 #pragma once
 
+#include <array>
 #include <chrono>
 #include <cstdint>
+#include <deque>
 #include <functional>
+#include <map>
 #include <memory>
 #include <optional>
 #include <span>
@@ -14,12 +17,19 @@
 #include "common/session/session_rotator.h"
 #include "common/utils/packet_pool.h"
 #include "common/utils/thread_checker.h"
-#include "transport/mux/ack_bitmap.h"
+#include "transport/mux/ack_ranges.h"
 #include "transport/mux/congestion_controller.h"
+#include "transport/mux/fec.h"
+#include "transport/mux/flow_control.h"
 #include "transport/mux/fragment_reassembly.h"
+#include "transport/mux/header_compression.h"
+#include "transport/mux/path_mtu.h"
+#include "transport/mux/payload_compression.h"
+#include "transport/mux/frame_packer.h"
 #include "transport/mux/mux_codec.h"
 #include "transport/mux/reorder_buffer.h"
 #include "transport/mux/retransmit_buffer.h"
+#include "transport/mux/send_scheduler.h"
 
 namespace veil::transport {
 
@@ -45,6 +55,74 @@ struct TransportSessionConfig {
   mux::CongestionConfig congestion_config{};
   // Enable congestion control.
   bool enable_congestion_control{true};
+  // Congestion control algorithm. BBR paces at its bandwidth estimate and does not back
+  // off on random loss, which suits long, lossy links better than the loss-based ones.
+  mux::CongestionAlgorithm congestion_algorithm{mux::CongestionAlgorithm::kReno};
+  // Offer to send tunneled IP packets as unreliable DATAGRAM frames (see
+  // take_datagram_mode_frame()). Used only once the peer offers it too; until then they
+  // go as DATA, which every peer decodes.
+  bool datagram_mode{true};
+  // Acknowledge received datagrams on mux::kDatagramStreamId, and say so in the
+  // datagram_mode offer. A peer that does the same has its deliveries and losses fed to
+  // congestion control, so datagrams count against the window, are held by the send
+  // scheduler and paced like DATA. Datagrams are never retransmitted either way.
+  bool datagram_loss_feedback{true};
+  // Offer to coalesce queued frames (see queue_ip_packet()/queue_frame()) into one
+  // packet of up to mtu bytes (see take_frame_packing_frame()). Used only once the peer
+  // offers it too: peers without multi-frame decoding drop packed packets.
+  bool frame_packing{true};
+  // Longest a queued frame may wait for more frames to share its packet.
+  std::chrono::microseconds packing_delay{1000};
+  // Offer to acknowledge with extended ACK frames (generate_ack_ranges()): all received
+  // ranges, ACK delay and ECN counts (see take_ack_ranges_frame()). Used only once the
+  // peer offers it too: peers without kAckRanges support drop those packets.
+  bool ack_ranges{true};
+  // Send outer packets ECN-capable (outgoing_ecn()) so AQM on the path can mark rather
+  // than drop them; CE marks the peer reports then reduce the window as a loss would.
+  // Starts once extended ACKs are negotiated, since only they carry the counts. Stops
+  // once an ACK arrives without ECN counts: the peer does not read them, or the path
+  // clears the field (RFC 9000 section 13.4.2).
+  bool enable_ecn{true};
+  // Offer forward error correction (see take_fec_params_frame()). Used only once the
+  // peer offers it too; costs 1/K extra packets to repair single losses without a
+  // round trip, which pays off on long links with random loss.
+  bool enable_fec{false};
+  mux::FecConfig fec_config{};
+  // Advertise receive credit for DATA (see take_flow_control_frames()) and hold DATA the
+  // peer has not granted credit for. A peer that never advertises credit is not limited.
+  bool enable_flow_control{true};
+  mux::FlowControlConfig flow_control{};
+  // Offer wire format v2 (see take_wire_format_frame()): 2-4 byte packet headers and
+  // varint DATA frames. Used only once the peer offers it too; v1 is always accepted.
+  bool compact_wire_format{true};
+  // Offer inner header compression (see take_header_compression_frame()): tunneled
+  // IPv4 TCP and UDP headers shrink to their changing fields. Used only once the peer
+  // offers it too; saves 20-30 bytes a packet, which counts on metered or satellite links.
+  bool enable_header_compression{false};
+  mux::HeaderCompressionConfig header_compression_config{};
+  // Offer payload compression (see take_payload_compression_frame()): tunneled packets
+  // that look compressible are LZ4-compressed before encryption. Used only once the peer
+  // offers it too.
+  // SECURITY: off by default. Compressed sizes reveal content to an attacker who can
+  // mix chosen data with secrets in one flow (see mux::PayloadCompressor).
+  bool enable_payload_compression{false};
+  mux::PayloadCompressionConfig payload_compression_config{};
+  // Probe for a larger path MTU than mtu (see take_path_mtu_packets()). Peers that do
+  // not answer probes stay at mtu. Off by default: probing needs DF on every packet
+  // (see UdpSocket::set_dont_fragment()) and never searches below mtu, so a path
+  // narrower than mtu would drop every full-size packet. Only for paths known to carry
+  // mtu whole.
+  bool enable_path_mtu_discovery{false};
+  mux::PathMtuConfig path_mtu_config{};
+  // Lower the MSS option of tunneled TCP SYNs to what fits max_payload_size() (see
+  // mux::clamp_tcp_mss()), so inner TCP segments are never split into fragments.
+  bool clamp_tcp_mss{true};
+  // While the congestion window is full, hold tunneled IP packets in a scheduler that
+  // serves traffic classes by weight (see mux::SendScheduler) instead of sending them
+  // first come, first served. ACK and control frames are never held. Datagrams count
+  // against the window once the peer acknowledges them (datagram_loss_feedback).
+  bool enable_send_scheduler{true};
+  mux::SendSchedulerConfig send_scheduler_config{};
 };
 
 // Statistics for observability.
@@ -59,8 +137,40 @@ struct TransportStats {
   std::uint64_t fragments_sent{0};
   std::uint64_t fragments_received{0};
   std::uint64_t messages_reassembled{0};
+  // Fragmented messages dropped incomplete after the reassembly timeout.
+  std::uint64_t messages_expired{0};
   std::uint64_t retransmits{0};
   std::uint64_t session_rotations{0};
+  std::uint64_t datagrams_sent{0};
+  std::uint64_t datagrams_received{0};
+  // Datagrams reported missing by loss feedback (not retransmitted).
+  std::uint64_t datagrams_lost{0};
+  // Packets carrying more than one frame, and the frames they carried.
+  std::uint64_t packed_packets_sent{0};
+  std::uint64_t packed_frames_sent{0};
+  // Retransmits of packets declared lost from ACK ranges, before their RTO.
+  std::uint64_t fast_retransmits{0};
+  // Retransmits sent as tail loss probes (see RetransmitConfig::enable_tail_loss_probe).
+  std::uint64_t tail_loss_probes{0};
+  // Loss reductions undone because every loss behind them was spurious.
+  std::uint64_t loss_undos{0};
+  // DATA frames received before (a retransmission whose earlier copy arrived): ACKed,
+  // not delivered again.
+  std::uint64_t fragments_dropped_duplicate{0};
+  // FEC repair packets sent, and lost packets rebuilt from the peer's repairs.
+  std::uint64_t fec_repairs_sent{0};
+  std::uint64_t fec_packets_recovered{0};
+  // DATA messages held for flow control credit, and those dropped with the hold full.
+  std::uint64_t flow_control_blocked{0};
+  std::uint64_t flow_control_dropped{0};
+  // DATA frames that went past the credit advertised for them.
+  std::uint64_t flow_control_violations{0};
+  // Tunneled TCP SYNs whose MSS option was lowered.
+  std::uint64_t tcp_mss_clamped{0};
+  // Inner packets of CE-marked outer packets: marked CE in turn, or, not ECN-capable,
+  // dropped (RFC 6040).
+  std::uint64_t ecn_ce_propagated{0};
+  std::uint64_t ecn_ce_dropped{0};
 };
 
 /**
@@ -112,12 +222,91 @@ class TransportSession {
   // Returns a single encrypted packet.
   std::vector<std::uint8_t> encrypt_frame(const mux::MuxFrame& frame);
 
+  // Encrypt one tunneled IP packet as a DATAGRAM frame.
+  // PERFORMANCE: Datagrams skip the retransmit buffer and the receiver delivers them as
+  // they arrive, so inner TCP is not stacked on a second reliable layer (TCP-over-TCP
+  // meltdown under loss). Replay protection is unchanged. Packets larger than
+  // max_payload_size() fall back to encrypt_data(), since fragments need the reliable path.
+  std::vector<std::vector<std::uint8_t>> encrypt_datagram(std::span<const std::uint8_t> packet);
+
+  // Whether received datagrams should be acknowledged (datagram_loss_feedback).
+  bool datagram_loss_feedback() const { return config_.datagram_loss_feedback; }
+
+  // Send a tunneled IP packet with the negotiated mode: encrypt_datagram() once both
+  // sides offered datagram_mode, otherwise encrypt_data().
+  std::vector<std::vector<std::uint8_t>> encrypt_ip_packet(std::span<const std::uint8_t> packet);
+
+  // The kControlDatagramMode frame to send, if datagram_mode and not sent since the
+  // peer's offer arrived. Call after each received batch and once on connect.
+  std::optional<mux::MuxFrame> take_datagram_mode_frame();
+
+  // Whether both sides offered datagram_mode: tunneled packets go as DATAGRAM frames.
+  bool datagram_mode_active() const { return datagram_mode_active_; }
+
+  // Whether the peer acknowledges our datagrams, so they are tracked for loss feedback.
+  bool datagram_acks_active() const { return datagram_acks_active_; }
+
+  // Encrypt several frames into one packet (frames are decoded with MuxCodec::decode_all).
+  // The packet enters the retransmit buffer if any frame is a DATA frame.
+  std::vector<std::uint8_t> encrypt_frames(std::span<const mux::MuxFrame> frames);
+
+  // ========== Frame Packing ==========
+  // PERFORMANCE: Small IP packets (TCP ACKs, DNS, VoIP) and ACK/control frames each
+  // cost a sequence number, an AEAD pass and tag, and a UDP/IP header. Once both sides
+  // offered frame_packing, queued frames share one packet up to the MTU. Each queue call
+  // returns the packets that are complete now; call flush_packed() at the end of a
+  // receive/read batch and flush_packed_if_due() from timers. Until then every call
+  // returns its packet immediately.
+
+  // The kControlFramePacking frame to send, if frame_packing and not sent since the
+  // peer's offer arrived. Call after each received batch and once on connect.
+  std::optional<mux::MuxFrame> take_frame_packing_frame();
+
+  // Whether both sides offered frame_packing: queued frames are packed.
+  bool frame_packing_active() const { return frame_packing_active_; }
+
+  // Queue a tunneled IP packet. Only DATAGRAM frames are packed; DATA mode and
+  // packets needing fragmentation go out through encrypt_data() after the queue. With
+  // enable_send_scheduler and the congestion window full, the packet waits in the send
+  // scheduler until the window opens.
+  std::vector<std::vector<std::uint8_t>> queue_ip_packet(std::span<const std::uint8_t> packet);
+
+  // Queue an ACK, control or heartbeat frame.
+  std::vector<std::vector<std::uint8_t>> queue_frame(mux::MuxFrame frame);
+
+  // Send what the congestion window allows from the send scheduler, then encrypt
+  // everything queued in the packer.
+  std::vector<std::vector<std::uint8_t>> flush_packed();
+
+  // As flush_packed(), but the packer only once the oldest queued frame has waited
+  // packing_delay.
+  std::vector<std::vector<std::uint8_t>> flush_packed_if_due();
+
+  // Whether frames are waiting in the packer, or in the send scheduler with room in
+  // the congestion window for them.
+  bool has_packed_frames() const;
+
+  // Packets held by the send scheduler, and its statistics.
+  std::size_t scheduled_packets() const { return send_scheduler_.queued_packets(); }
+  const mux::SendSchedulerStats& send_scheduler_stats() const { return send_scheduler_.stats(); }
+  mux::FqCodelStats fq_codel_stats() const { return send_scheduler_.fq_codel_stats(); }
+
+  // Whether more than backpressure_bytes wait to leave: in the send scheduler, or paced
+  // ahead of now in the caller's calendar (paced_backlog_bytes()). A caller reading
+  // packets from a TUN device should stop reading until it clears, so the inner
+  // stack's own queues fill and its senders slow down.
+  bool send_backlogged() const;
+
+  // Bytes pace_packet() has scheduled to leave after now, at the current pacing rate.
+  std::size_t paced_backlog_bytes() const;
+
   // Decrypt and process a received packet.
   // Returns decrypted mux frames if successful.
   // Performs replay check and decryption.
   std::optional<std::vector<mux::MuxFrame>> decrypt_packet(std::span<const std::uint8_t> ciphertext);
 
-  // Get packets that need retransmission.
+  // Get packets that need retransmission: packets declared lost (also by the RACK
+  // timer, checked here), timed out, or a tail loss probe.
   std::vector<std::vector<std::uint8_t>> get_retransmit_packets();
 
   // Process an ACK frame (acknowledges sent packets).
@@ -126,6 +315,166 @@ class TransportSession {
   // Generate an ACK frame for received packets on a stream.
   mux::AckFrame generate_ack(std::uint64_t stream_id);
 
+  // ========== Extended ACKs ==========
+  // Received DATA packets are acknowledged by packet sequence, which includes
+  // fragments that reassembly absorbs before the caller sees them.
+
+  // Whether ACKs should be sent as extended ACK frames: both sides offered ack_ranges.
+  // Until then plain ACK frames (generate_ack()) are sent, which every peer decodes.
+  bool ack_ranges_enabled() const { return ack_ranges_active_; }
+
+  // The kControlAckRanges frame to send, if ack_ranges and not sent since the peer's
+  // offer arrived. Call after each received batch and once on connect.
+  std::optional<mux::MuxFrame> take_ack_ranges_frame();
+
+  // Extended ACK for the received packets: every range, the time since the largest
+  // arrived, and ECN counts once any were recorded.
+  mux::AckRangesFrame generate_ack_ranges(std::uint64_t stream_id);
+
+  // Process an extended ACK. Acknowledges the ranges, declares packets below the
+  // largest acknowledged lost (see RetransmitBuffer::acknowledge_ranges()) and reduces
+  // the congestion window at most once per round trip for loss or new ECN-CE marks.
+  // If every loss behind a reduction turns out to be spurious, the reduction is undone.
+  void process_ack(const mux::AckRangesFrame& ack);
+
+  // Count the ECN field (low two bits of the outer TOS / traffic class) of a received
+  // packet for the next extended ACK.
+  void record_ecn(std::uint8_t ecn);
+
+  // Record the outer ECN field of a decrypted packet (record_ecn()) and decapsulate it
+  // (RFC 6040): if it is CE, mark its ECN-capable inner IP packets CE too, and drop its
+  // Not-ECT inner datagrams, whose senders only understand loss. DATA frames are
+  // delivered either way; they are acknowledged already, and the window responds.
+  void apply_outer_ecn(std::uint8_t ecn, std::vector<mux::MuxFrame>& frames);
+
+  // ECN field to send outer packets with: ECT(0) with enable_ecn once extended ACKs are
+  // negotiated, until the peer's ACKs show it does not see it; 0 (Not-ECT) otherwise.
+  std::uint8_t outgoing_ecn() const {
+    return config_.enable_ecn && ack_ranges_active_ && !ecn_failed_ ? 0x02 : 0x00;
+  }
+
+  // ========== Forward Error Correction ==========
+  // PERFORMANCE: With FEC, every K packets carrying DATA or DATAGRAM frames are followed
+  // by a repair packet, the XOR of their plaintexts. A receiver missing one packet of
+  // the group rebuilds it on the spot, before ACKs and reordering, instead of waiting a
+  // round trip for a retransmission (or never getting a lost datagram back). K follows
+  // the loss rate the receiver measures, which it sends back in kControlFecParams.
+  // Repair packets are returned along with the packets of the send calls above and
+  // get_retransmit_packets(); decrypt_packet() consumes repairs and FEC parameters.
+
+  // The kControlFecParams frame to send, if enable_fec and the peer has not been told
+  // the current group size yet. Call after each received batch (and once on connect to
+  // make the offer).
+  std::optional<mux::MuxFrame> take_fec_params_frame();
+
+  // Whether both sides offered FEC: packets are protected and repairs decoded.
+  bool fec_active() const { return fec_active_; }
+
+  const mux::FecEncoderStats& fec_encoder_stats() const { return fec_encoder_.stats(); }
+  const mux::FecDecoderStats& fec_decoder_stats() const { return fec_decoder_.stats(); }
+
+  // ========== Flow Control ==========
+  // Receive credit per stream and for the session, in DATA payload bytes. The receiver
+  // advertises limits (kControlFlowCredit) as payload is delivered, and widens a window
+  // while the peer drains it within two round trips (see mux::ReceiveWindow), so its
+  // buffers follow the bandwidth-delay product. Once the peer advertises, encrypt_data()
+  // holds messages that would exceed its credit instead of overrunning its buffers, and
+  // reports the window it is blocked on. Datagrams are not flow controlled: the receiver
+  // delivers them as they arrive.
+
+  // Credit updates and blocked reports to send. Call after each received batch, from
+  // timers, and once on connect to grant the initial credit. Fragmented messages still
+  // incomplete after the reassembly timeout are dropped first, and the credit their
+  // fragments held is granted again: otherwise a message that never completes keeps
+  // its bytes charged, and enough of them close the window for good.
+  std::vector<mux::MuxFrame> take_flow_control_frames();
+
+  // Encrypt held messages the peer's credit now covers. Call after each received batch.
+  std::vector<std::vector<std::uint8_t>> release_flow_blocked();
+
+  // Whether messages are held for credit, and their payload bytes.
+  bool flow_blocked() const { return !flow_blocked_.empty(); }
+  std::size_t flow_blocked_bytes() const { return flow_blocked_bytes_; }
+
+  // ========== Wire Format ==========
+  // Both sides start with v1 (8-byte packet headers) and offer v2 in kControlWireFormat.
+  // Once the peer's offer arrives, packets go out in v2: the packet sequence truncated
+  // to what the peer needs to recover it from its largest received (as QUIC does), and
+  // DATA frames with varint fields. Received packets are decoded in either format, so
+  // the switch needs no further round trip.
+
+  // The kControlWireFormat frame to send, if compact_wire_format and not sent since the
+  // peer's offer arrived. Call after each received batch and once on connect.
+  std::optional<mux::MuxFrame> take_wire_format_frame();
+
+  // The format packets are sent in.
+  mux::WireFormat wire_format() const { return send_format_; }
+
+  // ========== Inner Header Compression ==========
+  // Once both sides offer it (kControlHeaderCompression), encrypt_ip_packet() and
+  // queue_ip_packet() compress the headers of tunneled IPv4 TCP and UDP packets per flow
+  // (see mux::HeaderCompressor), and decrypt_packet() expands the peer's: DATA and
+  // datagram payloads come out as the original IP packets. A packet whose context was
+  // lost is dropped until the peer refreshes it. decrypt_packet_zero_copy() does not
+  // expand packets.
+
+  // The kControlHeaderCompression frame to send, if enable_header_compression and not
+  // sent since the peer's offer arrived. Call after each received batch and once on
+  // connect.
+  std::optional<mux::MuxFrame> take_header_compression_frame();
+
+  // Whether both sides offered header compression: tunneled packets are compressed.
+  bool header_compression_active() const { return header_compression_active_; }
+
+  const mux::HeaderCompressorStats& header_compressor_stats() const {
+    return header_compressor_.stats();
+  }
+  const mux::HeaderDecompressorStats& header_decompressor_stats() const {
+    return header_decompressor_.stats();
+  }
+
+  // ========== Payload Compression ==========
+  // Once both sides offer it (kControlPayloadCompression), tunneled packets are
+  // compressed after their headers (see mux::PayloadCompressor), unless the entropy test
+  // or the flow's cached decision says they will not shrink. decrypt_packet() expands
+  // the peer's; decrypt_packet_zero_copy() does not.
+
+  // The kControlPayloadCompression frame to send, if enable_payload_compression and not
+  // sent since the peer's offer arrived. Call after each received batch and once on
+  // connect.
+  std::optional<mux::MuxFrame> take_payload_compression_frame();
+
+  // Whether both sides offered payload compression.
+  bool payload_compression_active() const { return payload_compression_active_; }
+
+  const mux::PayloadCompressorStats& payload_compressor_stats() const {
+    return payload_compressor_.stats();
+  }
+  const mux::PayloadDecompressorStats& payload_decompressor_stats() const {
+    return payload_decompressor_.stats();
+  }
+
+  // ========== Path MTU Discovery ==========
+  // mtu is the base size, known to work. Larger sizes are probed with control frames
+  // padded to the size (kControlPathMtuProbe), which the peer acknowledges (RFC 8899,
+  // see mux::PathMtuProber). Once a size is confirmed, max_payload_size() and the packed
+  // batch size grow by what it adds to mtu: IP packets up to the larger size go in one
+  // frame instead of fragments. Fragments themselves keep max_fragment_size, which the
+  // peer's reassembly assumes. A black hole drops back to mtu.
+
+  // Acknowledgments of the peer's probes, and this side's next probe if one is due.
+  // Call after each received batch and from timers.
+  std::vector<std::vector<std::uint8_t>> take_path_mtu_packets();
+
+  // Largest encrypted packet confirmed to reach the peer (at least mtu).
+  std::size_t path_mtu() const { return path_mtu_.path_size(); }
+
+  // Largest tunneled packet sent in one frame: max_fragment_size plus what the path
+  // carries beyond mtu.
+  std::size_t max_payload_size() const { return max_payload_size_; }
+
+  const mux::PathMtuStats& path_mtu_stats() const { return path_mtu_.stats(); }
+
   // Check if session should rotate (time or packet count threshold).
   bool should_rotate_session();
 
@@ -149,7 +498,7 @@ class TransportSession {
   const mux::RetransmitStats& retransmit_stats() const { return retransmit_buffer_.stats(); }
 
   // Get congestion control statistics.
-  const mux::CongestionStats& congestion_stats() const { return congestion_controller_.stats(); }
+  const mux::CongestionStats& congestion_stats() const { return congestion_controller_->stats(); }
 
   // ========== Congestion Control API ==========
 
@@ -161,16 +510,23 @@ class TransportSession {
   std::size_t sendable_bytes(std::size_t bytes_in_flight) const;
 
   // Get the current congestion window size.
-  std::size_t cwnd() const { return congestion_controller_.cwnd(); }
+  std::size_t cwnd() const { return congestion_controller_->cwnd(); }
 
   // Get the current slow start threshold.
-  std::size_t ssthresh() const { return congestion_controller_.ssthresh(); }
+  std::size_t ssthresh() const { return congestion_controller_->ssthresh(); }
 
   // Get the current congestion state.
-  mux::CongestionState congestion_state() const { return congestion_controller_.state(); }
+  mux::CongestionState congestion_state() const { return congestion_controller_->state(); }
+
+  // The congestion control algorithm in use (TransportSessionConfig::congestion_algorithm).
+  mux::CongestionAlgorithm congestion_algorithm() const {
+    return congestion_controller_->algorithm();
+  }
 
-  // Get current bytes in flight (buffered bytes awaiting ACK).
-  std::size_t bytes_in_flight() const { return retransmit_buffer_.buffered_bytes(); }
+  // Get current bytes in flight (buffered bytes awaiting ACK, plus tracked datagrams).
+  std::size_t bytes_in_flight() const {
+    return retransmit_buffer_.buffered_bytes() + datagram_bytes_in_flight_;
+  }
 
   // Check if pacing allows sending now.
   bool check_pacing();
@@ -178,11 +534,21 @@ class TransportSession {
   // Get time until pacing allows next send.
   std::optional<std::chrono::microseconds> time_until_next_send() const;
 
+  // Departure time for an encrypted packet of `bytes`, for a PacingCalendar: successive
+  // packets are spaced at the controller's pacing rate, and after idle up to
+  // max_pacing_burst packets may leave at once. Now while pacing is off or the rate is
+  // not yet known, and in datagram mode with a peer that does not acknowledge datagrams
+  // (datagram_acks_active()): the controller never hears of their loss or delivery, so
+  // its rate stays at the initial window per RTT and would only queue traffic it does
+  // not govern.
+  TimePoint pace_packet(std::size_t bytes);
+
   // ========== Zero-Copy Packet Processing API ==========
   // PERFORMANCE (Issue #97): Zero-copy packet processing methods.
   // These methods use pre-allocated buffers from the packet pool to avoid allocations.
 
   // Decrypt packet into a pre-allocated buffer and return frame view.
+  // Handles single-frame packets only; use decrypt_packet() for packed packets.
   // The caller provides the decryption buffer which must outlive the returned frame view.
   // Returns the frame view and the size of plaintext written to decrypt_buffer.
   // Returns nullopt if decryption fails.
@@ -203,6 +569,122 @@ class TransportSession {
   // Build an encrypted packet from mux frame.
   std::vector<std::uint8_t> build_encrypted_packet(const mux::MuxFrame& frame);
 
+  // Encrypt a serialized plaintext (one or more frames) under the next send sequence.
+  std::vector<std::uint8_t> seal_packet(std::span<const std::uint8_t> plaintext);
+
+  // A received packet's sequence as read from its header, in one wire format.
+  struct PacketHeader {
+    std::uint64_t sequence{0};
+    std::size_t size{0};
+    mux::WireFormat format{mux::WireFormat::kV1};
+  };
+
+  // Header size for the next packet sent, and the header written into the front of a
+  // sealed packet (v2 masks it with the AEAD tag, so the ciphertext must be in place).
+  std::size_t packet_header_size() const;
+  void write_packet_header(std::span<std::uint8_t> packet, std::size_t header_size) const;
+
+  // The header read in each format a packet may be in, likeliest first.
+  std::array<std::optional<PacketHeader>, 2> read_packet_headers(
+      std::span<const std::uint8_t> packet) const;
+
+  // Find the header under which decrypt(header) authenticates the packet, and mark its
+  // sequence received; counts the drop if there is none.
+  template <typename Decrypt>
+  std::optional<PacketHeader> open_packet(std::span<const std::uint8_t> packet, Decrypt&& decrypt);
+
+  // The peer's largest acknowledged packet sequence, for truncating v2 headers.
+  void on_peer_acked(std::uint64_t sequence);
+
+  // Start loss-feedback tracking for the datagram packet just sent.
+  void track_datagram(std::size_t bytes);
+
+  // Append the packet for a packed batch to `out` (no-op for an empty batch).
+  void emit_batch(std::vector<mux::MuxFrame> batch, std::vector<std::vector<std::uint8_t>>& out);
+
+  // Process the frames of a packet received (or rebuilt by FEC) under sequence, appending
+  // those for the caller to `out`.
+  void deliver_frames(std::uint64_t sequence, std::vector<mux::MuxFrame>& decoded,
+                      std::vector<mux::MuxFrame>& out);
+
+  // Add the plaintext of the packet just sealed to the FEC group (if fec_active_).
+  void protect_packet(std::span<const std::uint8_t> plaintext);
+
+  // Seal the repairs completed since the last call, appending them to `out`.
+  void append_fec_repairs(std::vector<std::vector<std::uint8_t>>& out);
+
+  // Take a repair frame and deliver the packets it rebuilds.
+  void on_fec_repair(mux::FecRepairFrame repair, std::vector<mux::MuxFrame>& out);
+  void deliver_recovered(std::vector<mux::RecoveredPacket> recovered,
+                         std::vector<mux::MuxFrame>& out);
+
+  // The tunneled IP packet to send: a SYN's MSS clamped into mss_buffer_, its headers
+  // compressed into compress_buffer_, then the result into payload_buffer_, as far as
+  // each is active and applies; otherwise packet itself.
+  std::span<const std::uint8_t> compress_ip_packet(std::span<const std::uint8_t> packet);
+
+  // queue_ip_packet() without the send scheduler.
+  std::vector<std::vector<std::uint8_t>> pack_ip_packet(std::span<const std::uint8_t> packet);
+
+  // Bytes the congestion window has room for (unlimited without congestion control).
+  std::size_t send_budget() const;
+
+  // Send packets from the send scheduler while send_budget() allows.
+  void drain_send_scheduler(std::vector<std::vector<std::uint8_t>>& out);
+
+  // Whether the window was in use since the last datagram ACK, so an ACK may grow it
+  // (RFC 7661).
+  bool window_limited() const;
+
+  // Follow a change of the confirmed path MTU: payload and batch sizes.
+  void apply_path_mtu();
+
+  // Expand a received DATA or datagram payload (see PayloadDecompressor::decompress()
+  // and HeaderDecompressor::decompress()).
+  bool expand_ip_packet(std::vector<std::uint8_t>& payload);
+
+  // Encrypt DATA frames for a message that flow control let through.
+  std::vector<std::vector<std::uint8_t>> send_data(std::span<const std::uint8_t> plaintext,
+                                                   std::uint64_t stream_id, bool fin);
+
+  // Flow control: whether the peer's credit covers bytes more on stream_id (marking the
+  // windows that do not as blocked), and the windows themselves. receive_window() is
+  // nullptr for a stream past kMaxFlowStreams.
+  bool flow_allows(std::uint64_t stream_id, std::size_t bytes);
+  mux::SendWindow* send_window(std::uint64_t stream_id);
+  mux::ReceiveWindow* receive_window(std::uint64_t stream_id);
+  void on_flow_credit(const mux::FlowCredit& credit);
+  // Account received DATA payload, and payload handed to the caller.
+  void on_data_received(std::uint64_t stream_id, std::size_t bytes);
+  void on_data_consumed(std::uint64_t stream_id, std::size_t bytes);
+  // Return the credit of a packet's DATA frames that will never be delivered.
+  void abandon_flow_credit(std::span<const std::uint8_t> plaintext);
+
+  // Record a received DATA packet's sequence for ACK generation.
+  void record_received(std::uint64_t sequence);
+
+  // Loss feedback for datagrams: feed delivered bytes, losses, new CE marks and an RTT
+  // sample from the largest acknowledged to congestion control.
+  void process_datagram_ack(std::span<const mux::AckRange> ranges, bool new_ce,
+                            std::chrono::microseconds ack_delay);
+
+  // ECN validation: an ACK with ECN counts confirms the peer sees our marks; one
+  // without, before any did, turns ECT off for the session.
+  void validate_ecn(bool has_counts);
+
+  // Whether the peer reports CE marks beyond those seen so far on packets sent since the
+  // last window reduction.
+  bool take_new_ce(const std::optional<mux::EcnCounts>& ecn, std::uint64_t largest);
+
+  // Reduce the window for newly declared losses, once per round trip. Returns true if it
+  // did.
+  bool on_packets_lost(const mux::AckRangesResult& result);
+
+  // Start watching the suspected losses behind a window reduction; once all are
+  // settled, undo the reduction if none was real.
+  void arm_loss_undo();
+  void check_loss_undo();
+
   // Fragment large data into multiple frames.
   std::vector<mux::MuxFrame> fragment_data(std::span<const std::uint8_t> data, std::uint64_t stream_id,
                                             bool fin);
@@ -235,18 +717,124 @@ class TransportSession {
   std::uint64_t packets_since_rotation_{0};
 
   // Multiplexing state.
-  mux::AckBitmap recv_ack_bitmap_;
+  mux::AckRangeSet recv_ack_ranges_;
+  TimePoint largest_received_time_{};
+  mux::EcnCounts recv_ecn_{};
+  // DATA frame sequences received, so a retransmitted copy is ACKed but not delivered
+  // twice. Fragments are kept apart so each set grows in order.
+  mux::AckRangeSet received_data_;
+  mux::AckRangeSet received_fragments_;
   mux::ReorderBuffer reorder_buffer_;
   mux::FragmentReassembly fragment_reassembly_;
   mux::RetransmitBuffer retransmit_buffer_;
 
   // Congestion control (Issue #98).
-  mux::CongestionController congestion_controller_;
+  std::unique_ptr<mux::CongestionControl> congestion_controller_;
+
+  // Datagrams awaiting loss feedback (datagram_acks_active() only), oldest first.
+  struct SentDatagram {
+    std::uint64_t sequence;
+    std::size_t bytes;
+    TimePoint sent_at;
+  };
+  std::deque<SentDatagram> datagrams_in_flight_;
+  std::size_t datagram_bytes_in_flight_{0};
+  // Since the last datagram ACK: the most bytes in flight, and whether the window held
+  // a tunneled packet back. Datagrams are often app-limited, and a window that grows
+  // past what is in flight never holds anything back (see window_limited()).
+  std::size_t peak_bytes_in_flight_{0};
+  bool window_held_back_{false};
+
+  // Outgoing frames waiting to share a packet (frame_packing), active once the peer
+  // offers it.
+  mux::FramePacker frame_packer_;
+  bool frame_packing_active_{false};
+  bool frame_packing_sent_{false};
 
   // Track last acknowledged sequence for duplicate ACK detection.
   std::uint64_t last_ack_seq_{0};
   std::uint32_t dup_ack_count_{0};
 
+  // Extended ACKs: sent once the peer offers them.
+  bool ack_ranges_active_{false};
+  bool ack_ranges_sent_{false};
+  // The send sequence at the last window reduction (losses of packets
+  // sent before it are the same congestion event), and the peer's last ECN-CE count.
+  std::uint64_t recovery_start_sequence_{0};
+  std::uint64_t peer_ecn_ce_{0};
+  // ECN validation (enable_ecn): counts seen in an ACK, or an ACK seen without them.
+  bool ecn_validated_{false};
+  bool ecn_failed_{false};
+
+  // pace_packet(): departure of the next paced packet.
+  TimePoint next_departure_{};
+
+  // Spurious loss undo: armed at a loss reduction, with the retransmit buffer's genuine
+  // loss count then. Any new genuine loss confirms the reduction.
+  bool loss_undo_armed_{false};
+  std::uint64_t loss_undo_genuine_mark_{0};
+
+  // Forward error correction (enable_fec): active once the peer's kControlFecParams
+  // arrives. fec_params_sent_ is the group size last advertised (0: none yet).
+  mux::FecEncoder fec_encoder_;
+  mux::FecDecoder fec_decoder_;
+  bool fec_active_{false};
+  std::size_t fec_params_sent_{0};
+  std::vector<mux::FecRepairFrame> fec_repairs_;
+
+  // Wire format: send_format_ becomes kV2 once the peer offers it; recv_format_ is the
+  // one its packets last came in, tried first.
+  mux::WireFormat send_format_{mux::WireFormat::kV1};
+  mux::WireFormat recv_format_{mux::WireFormat::kV1};
+  bool wire_format_sent_{false};
+  std::optional<std::uint64_t> peer_largest_acked_;
+
+  // Datagram mode: active once the peer offers it. DATAGRAM frames are decoded either way.
+  // The peer's offer also says whether it acknowledges datagrams.
+  bool datagram_mode_active_{false};
+  bool datagram_mode_sent_{false};
+  bool datagram_acks_active_{false};
+
+  // Inner header compression: active once the peer offers it. Received packets are
+  // expanded whenever we offered it, in case the peer's offer was lost.
+  mux::HeaderCompressor header_compressor_;
+  mux::HeaderDecompressor header_decompressor_;
+  bool header_compression_active_{false};
+  bool header_compression_sent_{false};
+  std::vector<std::uint8_t> compress_buffer_;
+
+  // Payload compression: as header compression.
+  mux::PayloadCompressor payload_compressor_;
+  mux::PayloadDecompressor payload_decompressor_;
+  bool payload_compression_active_{false};
+  bool payload_compression_sent_{false};
+  std::vector<std::uint8_t> payload_buffer_;
+
+  // Path MTU discovery: the prober, the peer's probes to acknowledge, and the payload
+  // size that follows the confirmed path MTU.
+  mux::PathMtuProber path_mtu_;
+  std::uint32_t next_probe_id_{0};
+  std::vector<std::uint32_t> path_mtu_acks_;
+  std::size_t max_payload_size_;
+  std::vector<std::uint8_t> mss_buffer_;
+
+  // Tunneled IP packets waiting for the congestion window (enable_send_scheduler).
+  mux::SendScheduler send_scheduler_;
+
+  // Flow control (enable_flow_control): windows per stream and for the session on each
+  // side, and messages held for credit, oldest first.
+  struct BlockedData {
+    std::uint64_t stream_id;
+    std::vector<std::uint8_t> payload;
+    bool fin;
+  };
+  std::map<std::uint64_t, mux::ReceiveWindow> receive_windows_;
+  mux::ReceiveWindow session_receive_window_;
+  std::map<std::uint64_t, mux::SendWindow> send_windows_;
+  mux::SendWindow session_send_window_;
+  std::deque<BlockedData> flow_blocked_;
+  std::size_t flow_blocked_bytes_{0};
+
   // Message ID counter for fragmentation.
   std::uint64_t message_id_counter_{0};
 
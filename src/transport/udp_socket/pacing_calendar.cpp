@@ -0,0 +1,139 @@
+#include "transport/udp_socket/pacing_calendar.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace veil::transport {
+
+PacingCalendar::PacingCalendar(PacingCalendarConfig config)
+    : config_(config), slots_(std::max<std::size_t>(config.slots, 1)) {}
+
+std::int64_t PacingCalendar::tick_of(TimePoint t) const {
+  return static_cast<std::int64_t>(t.time_since_epoch() / config_.slot);
+}
+
+std::vector<UdpPacket>& PacingCalendar::slot_at(std::int64_t tick) {
+  return slots_[static_cast<std::uint64_t>(tick) % slots_.size()];
+}
+
+const std::vector<UdpPacket>& PacingCalendar::slot_at(std::int64_t tick) const {
+  return slots_[static_cast<std::uint64_t>(tick) % slots_.size()];
+}
+
+void PacingCalendar::schedule(UdpPacket packet) {
+  const auto horizon = static_cast<std::int64_t>(slots_.size());
+  // A packet the wheel has already passed is due: it goes in the current slot.
+  const auto tick = tick_of(packet.send_at);
+  ++size_;
+  if (tick - cursor_ >= horizon) {
+    overflow_.push_back(std::move(packet));
+    return;
+  }
+  slot_at(std::max(tick, cursor_)).push_back(std::move(packet));
+  ++wheel_size_;
+}
+
+void PacingCalendar::refill_from_overflow() {
+  const auto horizon = static_cast<std::int64_t>(slots_.size());
+  auto kept = overflow_.begin();
+  for (auto it = overflow_.begin(); it != overflow_.end(); ++it) {
+    const auto tick = std::max(tick_of(it->send_at), cursor_);
+    if (tick - cursor_ < horizon) {
+      slot_at(tick).push_back(std::move(*it));
+      ++wheel_size_;
+    } else {
+      if (kept != it) {
+        *kept = std::move(*it);
+      }
+      ++kept;
+    }
+  }
+  overflow_.erase(kept, overflow_.end());
+}
+
+void PacingCalendar::release(TimePoint now, std::vector<UdpPacket>& out) {
+  const auto until = now + config_.release_ahead;
+  const auto until_tick = tick_of(until);
+  while (size_ != 0) {
+    if (wheel_size_ == 0) {
+      // Only far departures left: move the wheel up to the earliest, or to now.
+      auto earliest = tick_of(overflow_.front().send_at);
+      for (const auto& packet : overflow_) {
+        earliest = std::min(earliest, tick_of(packet.send_at));
+      }
+      cursor_ = std::max(cursor_, std::min(earliest, until_tick));
+      refill_from_overflow();
+      if (wheel_size_ == 0) {
+        return;
+      }
+    }
+
+    // Only the slot holding `until` can have packets not yet due. The wheel stops
+    // there, so packets scheduled behind it are released next time.
+    auto& slot = slot_at(cursor_);
+    auto kept = slot.begin();
+    for (auto it = slot.begin(); it != slot.end(); ++it) {
+      if (it->send_at <= until) {
+        out.push_back(std::move(*it));
+      } else {
+        if (kept != it) {
+          *kept = std::move(*it);
+        }
+        ++kept;
+      }
+    }
+    const auto taken = static_cast<std::size_t>(slot.end() - kept);
+    slot.erase(kept, slot.end());
+    wheel_size_ -= taken;
+    size_ -= taken;
+    if (!slot.empty() || cursor_ >= until_tick) {
+      return;
+    }
+    ++cursor_;
+    if (!overflow_.empty()) {
+      refill_from_overflow();
+    }
+  }
+}
+
+std::optional<PacingCalendar::Clock::duration> PacingCalendar::time_until_release(
+    TimePoint now) const {
+  if (size_ == 0) {
+    return std::nullopt;
+  }
+  std::optional<TimePoint> earliest;
+  const auto consider = [&earliest](const UdpPacket& packet) {
+    if (!earliest || packet.send_at < *earliest) {
+      earliest = packet.send_at;
+    }
+  };
+  if (wheel_size_ != 0) {
+    // The first occupied slot holds the earliest departure.
+    for (auto tick = cursor_; !earliest; ++tick) {
+      for (const auto& packet : slot_at(tick)) {
+        consider(packet);
+      }
+    }
+  } else {
+    for (const auto& packet : overflow_) {
+      consider(packet);
+    }
+  }
+  const auto wait = *earliest - config_.release_ahead - now;
+  return std::max(wait, Clock::duration::zero());
+}
+
+void PacingCalendar::clear() {
+  for (auto& slot : slots_) {
+    slot.clear();
+  }
+  overflow_.clear();
+  wheel_size_ = 0;
+  size_ = 0;
+}
+
+}  // namespace veil::transport
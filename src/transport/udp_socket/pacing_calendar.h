@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "transport/udp_socket/udp_socket.h"
+
+namespace veil::transport {
+
+struct PacingCalendarConfig {
+  // Width of one wheel slot. Packets in the same slot leave in the order they were
+  // scheduled.
+  std::chrono::microseconds slot{50};
+  // Slots in the wheel: slot * slots is the horizon (about 200 ms). Later departures
+  // wait in an overflow list until the wheel reaches them.
+  std::size_t slots{4096};
+  // Packets are handed to the socket this long before their departure. With SO_TXTIME
+  // the kernel holds each one until UdpPacket::send_at; without it they leave at once,
+  // so this bounds the burst (the poll loop wakes up at millisecond granularity).
+  std::chrono::microseconds release_ahead{1000};
+};
+
+// Departure calendar for paced packets: a timing wheel keyed by UdpPacket::send_at,
+// shared by every session sending through one socket, so packets of all sessions leave
+// in departure order and each release goes out as one send_batch().
+// Not thread-safe; owned by the loop that sends on the socket.
+class PacingCalendar {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+
+  explicit PacingCalendar(PacingCalendarConfig config = {});
+
+  // Queue a packet to leave at packet.send_at.
+  void schedule(UdpPacket packet);
+
+  // Append the packets due by now + release_ahead to out, earliest slot first.
+  void release(TimePoint now, std::vector<UdpPacket>& out);
+
+  // How long until release() has something to hand out (zero if it has now), or
+  // nullopt if the calendar is empty.
+  std::optional<Clock::duration> time_until_release(TimePoint now) const;
+
+  // Drop everything queued (the session it was for is gone).
+  void clear();
+
+  bool empty() const { return size_ == 0; }
+  std::size_t size() const { return size_; }
+  const PacingCalendarConfig& config() const { return config_; }
+
+ private:
+  std::int64_t tick_of(TimePoint t) const;
+  std::vector<UdpPacket>& slot_at(std::int64_t tick);
+  const std::vector<UdpPacket>& slot_at(std::int64_t tick) const;
+  // Move overflow packets the wheel now reaches into their slots.
+  void refill_from_overflow();
+
+  PacingCalendarConfig config_;
+  std::vector<std::vector<UdpPacket>> slots_;
+  // Packets past the horizon when scheduled.
+  std::vector<UdpPacket> overflow_;
+  // Tick of the slot the wheel is at, never past the last release: every packet in
+  // the wheel is in [cursor_, cursor_ + slots).
+  std::int64_t cursor_{0};
+  std::size_t wheel_size_{0};
+  std::size_t size_{0};
+};
+
+}  // namespace veil::transport
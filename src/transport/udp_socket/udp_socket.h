@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
@@ -19,6 +20,12 @@ struct UdpEndpoint {
 struct UdpPacket {
   std::vector<std::uint8_t> data;
   UdpEndpoint remote;
+  // ECN field of the IP header (RFC 3168): as received, 0 where the platform does not
+  // report it; to send with, in send_batch().
+  std::uint8_t ecn{0};
+  // Earliest departure, for send_batch() on a socket with enable_txtime(); the clock's
+  // epoch (the default) sends at once.
+  std::chrono::steady_clock::time_point send_at{};
 };
 
 class UdpSocket {
@@ -36,8 +43,22 @@ class UdpSocket {
 
   bool open(std::uint16_t bind_port, bool reuse_port, std::error_code& ec);
   bool connect(const UdpEndpoint& remote, std::error_code& ec);
-  bool send(std::span<const std::uint8_t> data, const UdpEndpoint& remote, std::error_code& ec);
+  // ecn: the ECN field to send with (0 for Not-ECT); best effort where the platform
+  // cannot set it per packet.
+  bool send(std::span<const std::uint8_t> data, const UdpEndpoint& remote, std::error_code& ec,
+            std::uint8_t ecn = 0);
   bool send_batch(std::span<const UdpPacket> packets, std::error_code& ec);
+  // Have the kernel hold each batched packet until its send_at (SO_TXTIME on the
+  // monotonic clock, honored by the fq and etf qdiscs). Returns false where the
+  // platform has no such option; packets then leave when handed over.
+  bool enable_txtime(std::error_code& ec);
+  bool txtime_enabled() const { return txtime_enabled_; }
+  // Set DF on every packet sent, so a path MTU probe is dropped rather than fragmented,
+  // without the kernel refusing sizes above its own cached path MTU. Only for sockets
+  // that probe: a path narrower than the sessions' mtu then drops every full-size
+  // packet. With enable false, the platform default: Linux learns the path MTU from
+  // ICMP and fragments above it, Windows sends without DF.
+  bool set_dont_fragment(bool enable, std::error_code& ec);
   bool poll(const ReceiveHandler& handler, int timeout_ms, std::error_code& ec);
   void close();
 
@@ -67,11 +88,14 @@ class UdpSocket {
   // Using uintptr_t provides a portable representation that works with INVALID_SOCKET.
   std::uintptr_t fd_{static_cast<std::uintptr_t>(~0ULL)};  // INVALID_SOCKET
   std::uint32_t bound_interface_index_{0};  // Interface index if bound via IP_BOUND_IF.
+  bool ecn_send_supported_{true};  // Cleared once WSASendMsg rejects IP_ECN.
+  bool dont_fragment_{false};  // Applied again when bind_to_interface() recreates the socket.
 #else
   int fd_{-1};
   int epoll_fd_{-1};  // Persistent epoll FD to avoid creating/destroying on every poll() call.
 #endif
   UdpEndpoint connected_;
+  bool txtime_enabled_{false};
 
   bool configure_socket(bool reuse_port, std::error_code& ec);
 #ifndef _WIN32
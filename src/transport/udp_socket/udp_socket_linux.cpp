@@ -13,10 +13,14 @@
 #include <sys/epoll.h>
 #include <sys/socket.h>
 #include <unistd.h>
+#ifdef __linux__
+#include <linux/net_tstamp.h>
+#endif
 
 #include <array>
 #include <chrono>
 #include <cstring>
+#include <ctime>
 #include <system_error>
 #include <vector>
 
@@ -53,6 +57,76 @@ void fill_endpoint(const sockaddr_in& addr, veil::transport::UdpEndpoint& endpoi
   endpoint.host = (res != nullptr) ? buffer.data() : "";
   endpoint.port = ntohs(addr.sin_port);
 }
+
+// Room for the control messages of one packet: IP_TOS sent or received, and
+// SCM_TXTIME sent.
+struct MessageControl {
+  alignas(cmsghdr) std::array<std::uint8_t, CMSG_SPACE(sizeof(int)) +
+                                                CMSG_SPACE(sizeof(std::uint64_t))> buffer{};
+};
+
+// Send the message with the given ECN field (DSCP 0; nothing for Not-ECT) and, unless
+// txtime is 0, not before that CLOCK_MONOTONIC time in nanoseconds (SO_TXTIME).
+void set_control(msghdr& msg, MessageControl& control, std::uint8_t ecn, std::uint64_t txtime) {
+  std::size_t length = 0;
+  const auto add = [&](int level, int type, const void* data, std::size_t size) {
+    auto* cmsg = reinterpret_cast<cmsghdr*>(control.buffer.data() + length);
+    cmsg->cmsg_level = level;
+    cmsg->cmsg_type = type;
+    cmsg->cmsg_len = CMSG_LEN(size);
+    std::memcpy(CMSG_DATA(cmsg), data, size);
+    length += CMSG_SPACE(size);
+  };
+  if (ecn != 0) {
+    const int tos = ecn & 0x03;
+    add(IPPROTO_IP, IP_TOS, &tos, sizeof(tos));
+  }
+#ifdef SCM_TXTIME
+  if (txtime != 0) {
+    add(SOL_SOCKET, SCM_TXTIME, &txtime, sizeof(txtime));
+  }
+#else
+  (void)txtime;
+#endif
+  msg.msg_control = length == 0 ? nullptr : control.buffer.data();
+  msg.msg_controllen = length;
+}
+
+// Outgoing message for one batched packet; addr, iov and control back it. False if the
+// remote address does not parse.
+bool fill_message(const veil::transport::UdpPacket& packet, bool txtime, sockaddr_in& addr,
+                  iovec& iov, MessageControl& control, msghdr& msg) {
+  if (!resolve(packet.remote, addr)) {
+    return false;
+  }
+  iov.iov_base = const_cast<std::uint8_t*>(packet.data.data());
+  iov.iov_len = packet.data.size();
+  msg = msghdr{};
+  msg.msg_name = &addr;
+  msg.msg_namelen = sizeof(sockaddr_in);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  // steady_clock is CLOCK_MONOTONIC, the clock enable_txtime() sets.
+  const auto send_at = packet.send_at.time_since_epoch();
+  const auto txtime_ns =
+      txtime && send_at.count() > 0
+          ? static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(send_at).count())
+          : 0;
+  set_control(msg, control, packet.ecn, txtime_ns);
+  return true;
+}
+
+// ECN field of a received message, from its IP_TOS control message (see IP_RECVTOS).
+std::uint8_t received_ecn(msghdr& msg) {
+  for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_TOS &&
+        cmsg->cmsg_len >= CMSG_LEN(1)) {
+      return *CMSG_DATA(cmsg) & 0x03;
+    }
+  }
+  return 0;
+}
 }  // namespace
 
 namespace veil::transport {
@@ -80,6 +154,11 @@ bool UdpSocket::configure_socket(bool reuse_port, std::error_code& ec) {
 #else
   (void)reuse_port;
 #endif
+  // Report the TOS byte of received packets for their ECN field. Best effort: without
+  // it everything reads as Not-ECT, and the peer stops sending ECN-capable packets.
+  if (setsockopt(fd_, IPPROTO_IP, IP_RECVTOS, &enable, sizeof(enable)) != 0) {
+    LOG_WARN("[UDP] setsockopt(IP_RECVTOS) failed: {}", last_error().message());
+  }
   return true;
 }
 
@@ -124,15 +203,22 @@ bool UdpSocket::connect(const UdpEndpoint& remote, std::error_code& ec) {
 }
 
 bool UdpSocket::send(std::span<const std::uint8_t> data, const UdpEndpoint& remote,
-                     std::error_code& ec) {
+                     std::error_code& ec, std::uint8_t ecn) {
   sockaddr_in addr{};
   if (!resolve(remote, addr)) {
     ec = std::make_error_code(std::errc::invalid_argument);
     return false;
   }
 
-  const auto sent =
-      ::sendto(fd_, data.data(), data.size(), 0, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+  iovec iov{const_cast<std::uint8_t*>(data.data()), data.size()};
+  msghdr msg{};
+  msg.msg_name = &addr;
+  msg.msg_namelen = sizeof(addr);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  MessageControl control;
+  set_control(msg, control, ecn, 0);
+  const auto sent = ::sendmsg(fd_, &msg, 0);
   if (sent < 0 || static_cast<std::size_t>(sent) != data.size()) {
     ec = last_error();
     return false;
@@ -150,20 +236,13 @@ bool UdpSocket::send_batch(std::span<const UdpPacket> packets, std::error_code&
   std::vector<mmsghdr> messages(packets.size());
   std::vector<sockaddr_in> addrs(packets.size());
   std::vector<iovec> iovecs(packets.size());
+  std::vector<MessageControl> controls(packets.size());
   for (std::size_t i = 0; i < packets.size(); ++i) {
-    if (!resolve(packets[i].remote, addrs[i])) {
+    if (!fill_message(packets[i], txtime_enabled_, addrs[i], iovecs[i], controls[i],
+                      messages[i].msg_hdr)) {
       ec = std::make_error_code(std::errc::invalid_argument);
       return false;
     }
-    iovecs[i].iov_base = const_cast<std::uint8_t*>(packets[i].data.data());
-    iovecs[i].iov_len = packets[i].data.size();
-    messages[i].msg_hdr.msg_name = &addrs[i];
-    messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
-    messages[i].msg_hdr.msg_iov = &iovecs[i];
-    messages[i].msg_hdr.msg_iovlen = 1;
-    messages[i].msg_hdr.msg_control = nullptr;
-    messages[i].msg_hdr.msg_controllen = 0;
-    messages[i].msg_hdr.msg_flags = 0;
     messages[i].msg_len = 0;
   }
   const auto sent =
@@ -185,13 +264,55 @@ bool UdpSocket::send_batch(std::span<const UdpPacket> packets, std::error_code&
 
 fallback:
 #endif
-  // Fallback: send each packet individually with sendto (Windows and non-sendmmsg systems).
+  // Fallback: send each packet individually with sendmsg (non-sendmmsg systems).
   for (const auto& pkt : packets) {
-    if (!send(pkt.data, pkt.remote, ec)) {
+    sockaddr_in addr{};
+    iovec iov{};
+    MessageControl control;
+    msghdr msg{};
+    if (!fill_message(pkt, txtime_enabled_, addr, iov, control, msg)) {
+      ec = std::make_error_code(std::errc::invalid_argument);
       return false;
     }
+    const auto written = ::sendmsg(fd_, &msg, 0);
+    if (written < 0 || static_cast<std::size_t>(written) != pkt.data.size()) {
+      ec = last_error();
+      return false;
+    }
+  }
+  return true;
+}
+
+bool UdpSocket::enable_txtime(std::error_code& ec) {
+#if defined(__linux__) && defined(SO_TXTIME)
+  sock_txtime config{};
+  config.clockid = CLOCK_MONOTONIC;
+  config.flags = 0;
+  if (setsockopt(fd_, SOL_SOCKET, SO_TXTIME, &config, sizeof(config)) != 0) {
+    ec = last_error();
+    return false;
   }
+  txtime_enabled_ = true;
   return true;
+#else
+  ec = std::make_error_code(std::errc::operation_not_supported);
+  return false;
+#endif
+}
+
+bool UdpSocket::set_dont_fragment(bool enable, std::error_code& ec) {
+#ifdef IP_PMTUDISC_PROBE
+  const int pmtu_mode = enable ? IP_PMTUDISC_PROBE : IP_PMTUDISC_WANT;
+  if (setsockopt(fd_, IPPROTO_IP, IP_MTU_DISCOVER, &pmtu_mode, sizeof(pmtu_mode)) != 0) {
+    ec = last_error();
+    return false;
+  }
+  return true;
+#else
+  (void)enable;
+  ec = std::make_error_code(std::errc::operation_not_supported);
+  return false;
+#endif
 }
 
 bool UdpSocket::ensure_epoll(std::error_code& ec) {
@@ -254,15 +375,23 @@ bool UdpSocket::poll(const ReceiveHandler& handler, int timeout_ms, std::error_c
       continue;
     }
     sockaddr_in src{};
-    socklen_t src_len = sizeof(src);
-    const auto read =
-        ::recvfrom(fd_, buffer.data(), buffer.size(), 0, reinterpret_cast<sockaddr*>(&src), &src_len);
+    iovec iov{buffer.data(), buffer.size()};
+    MessageControl control;
+    msghdr msg{};
+    msg.msg_name = &src;
+    msg.msg_namelen = sizeof(src);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buffer.data();
+    msg.msg_controllen = control.buffer.size();
+    const auto read = ::recvmsg(fd_, &msg, 0);
     if (read <= 0) {
       continue;
     }
     UdpEndpoint remote{};
     fill_endpoint(src, remote);
-    handler(UdpPacket{std::vector<std::uint8_t>(buffer.begin(), buffer.begin() + read), remote});
+    handler(UdpPacket{std::vector<std::uint8_t>(buffer.begin(), buffer.begin() + read), remote,
+                      received_ecn(msg)});
   }
 
   return true;
@@ -275,6 +404,7 @@ void UdpSocket::close() {
     ::close(fd_);
     fd_ = -1;
   }
+  txtime_enabled_ = false;
 }
 
 std::uint16_t UdpSocket::local_port() const {
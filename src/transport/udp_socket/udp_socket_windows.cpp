@@ -7,6 +7,7 @@
 
 #include <winsock2.h>
 #include <ws2tcpip.h>
+#include <mswsock.h>   // For WSARecvMsg
 #include <iphlpapi.h>  // For GetBestInterface
 
 #include <array>
@@ -24,6 +25,14 @@
 #define IP_BOUND_IF 31
 #endif
 
+// ECN socket option and control message (Windows 10 SDK 10.0.19041 and later).
+#ifndef IP_RECVECN
+#define IP_RECVECN 50
+#endif
+#ifndef IP_ECN
+#define IP_ECN 50
+#endif
+
 namespace {
 std::error_code last_error() {
   return std::error_code(WSAGetLastError(), std::system_category());
@@ -51,6 +60,60 @@ bool set_nonblocking(SOCKET s) {
   u_long mode = 1;
   return ioctlsocket(s, FIONBIO, &mode) == 0;
 }
+
+// DF on every packet or on none (see UdpSocket::set_dont_fragment()).
+bool set_dont_fragment_option(SOCKET s, bool enable) {
+  const DWORD value = enable ? 1 : 0;
+  return setsockopt(s, IPPROTO_IP, IP_DONTFRAGMENT, reinterpret_cast<const char*>(&value),
+                    sizeof(value)) == 0;
+}
+
+// Report the ECN field of received packets (IP_ECN control messages). Best effort:
+// without it everything reads as Not-ECT, and the peer stops sending ECN-capable
+// packets.
+void set_receive_ecn(SOCKET s) {
+  const DWORD enable = 1;
+  if (setsockopt(s, IPPROTO_IP, IP_RECVECN, reinterpret_cast<const char*>(&enable),
+                 sizeof(enable)) != 0) {
+    LOG_WARN("[UDP] setsockopt(IP_RECVECN) failed: {}", WSAGetLastError());
+  }
+}
+
+// WSARecvMsg is an extension function: look it up once. nullptr if unavailable, and
+// poll() falls back to recvfrom() without ECN.
+LPFN_WSARECVMSG recv_msg_function(SOCKET s) {
+  static const LPFN_WSARECVMSG function = [s] {
+    LPFN_WSARECVMSG result = nullptr;
+    GUID guid = WSAID_WSARECVMSG;
+    DWORD bytes = 0;
+    if (WSAIoctl(s, SIO_GET_EXTENSION_FUNCTION_POINTER, &guid, sizeof(guid), &result,
+                 sizeof(result), &bytes, nullptr, nullptr) != 0) {
+      LOG_WARN("[UDP] WSARecvMsg unavailable: {}", WSAGetLastError());
+      return LPFN_WSARECVMSG{nullptr};
+    }
+    return result;
+  }();
+  return function;
+}
+
+// Room for one IP_ECN control message, sent or received.
+struct EcnControl {
+  alignas(WSACMSGHDR) std::array<char, WSA_CMSG_SPACE(sizeof(INT))> buffer{};
+};
+
+// ECN field of a received message, from its IP_ECN control message.
+std::uint8_t received_ecn(WSAMSG& msg) {
+  for (WSACMSGHDR* cmsg = WSA_CMSG_FIRSTHDR(&msg); cmsg != nullptr;
+       cmsg = WSA_CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_ECN &&
+        cmsg->cmsg_len >= WSA_CMSG_LEN(sizeof(INT))) {
+      INT ecn = 0;
+      std::memcpy(&ecn, WSA_CMSG_DATA(cmsg), sizeof(ecn));
+      return static_cast<std::uint8_t>(ecn & 0x03);
+    }
+  }
+  return 0;
+}
 }  // namespace
 
 namespace veil::transport {
@@ -69,6 +132,7 @@ bool UdpSocket::configure_socket(bool reuse_port, std::error_code& ec) {
   }
   // Windows doesn't support SO_REUSEPORT.
   (void)reuse_port;
+  set_receive_ecn(fd_);
   return true;
 }
 
@@ -241,6 +305,10 @@ bool UdpSocket::bind_to_interface(std::uint32_t interface_index, std::error_code
     fd_ = static_cast<std::uintptr_t>(INVALID_SOCKET);
     return false;
   }
+  if (dont_fragment_ && !set_dont_fragment_option(s, true)) {
+    LOG_WARN("[UDP] setsockopt(IP_DONTFRAGMENT) failed during rebind: {}", WSAGetLastError());
+  }
+  set_receive_ecn(s);
 
   // Bind to the specific interface IP and the same port
   sockaddr_in bind_addr{};
@@ -338,7 +406,7 @@ bool UdpSocket::connect(const UdpEndpoint& remote, std::error_code& ec) {
 }
 
 bool UdpSocket::send(std::span<const std::uint8_t> data, const UdpEndpoint& remote,
-                     std::error_code& ec) {
+                     std::error_code& ec, std::uint8_t ecn) {
   sockaddr_in addr{};
   if (!resolve(remote, addr)) {
     ec = std::make_error_code(std::errc::invalid_argument);
@@ -358,9 +426,39 @@ bool UdpSocket::send(std::span<const std::uint8_t> data, const UdpEndpoint& remo
             static_cast<unsigned long long>(s),
             ntohl(addr.sin_addr.s_addr), ntohs(addr.sin_port));
 
-  const int sent = ::sendto(s, reinterpret_cast<const char*>(data.data()),
-                             static_cast<int>(data.size()), 0,
-                             reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+  int sent = SOCKET_ERROR;
+  if (ecn != 0 && ecn_send_supported_) {
+    // The ECN field goes in an IP_ECN control message (Windows 11 and Server 2022 on).
+    WSABUF buffer{static_cast<ULONG>(data.size()),
+                  const_cast<char*>(reinterpret_cast<const char*>(data.data()))};
+    EcnControl control;
+    WSAMSG msg{};
+    msg.name = reinterpret_cast<sockaddr*>(&addr);
+    msg.namelen = sizeof(addr);
+    msg.lpBuffers = &buffer;
+    msg.dwBufferCount = 1;
+    msg.Control.buf = control.buffer.data();
+    msg.Control.len = static_cast<ULONG>(control.buffer.size());
+    WSACMSGHDR* cmsg = WSA_CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = IPPROTO_IP;
+    cmsg->cmsg_type = IP_ECN;
+    cmsg->cmsg_len = WSA_CMSG_LEN(sizeof(INT));
+    const INT field = ecn & 0x03;
+    std::memcpy(WSA_CMSG_DATA(cmsg), &field, sizeof(field));
+    DWORD bytes = 0;
+    if (WSASendMsg(s, &msg, 0, &bytes, nullptr, nullptr) == 0) {
+      sent = static_cast<int>(bytes);
+    } else if (WSAGetLastError() == WSAEINVAL || WSAGetLastError() == WSAEOPNOTSUPP) {
+      // Older Windows: send Not-ECT from now on. The peer sees no ECN-capable packets
+      // and keeps to loss.
+      LOG_WARN("[UDP] Sending ECN unsupported: WSA error {}", WSAGetLastError());
+      ecn_send_supported_ = false;
+    }
+  }
+  if (sent == SOCKET_ERROR && (ecn == 0 || !ecn_send_supported_)) {
+    sent = ::sendto(s, reinterpret_cast<const char*>(data.data()), static_cast<int>(data.size()),
+                    0, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+  }
 
   if (sent == SOCKET_ERROR) {
     ec = last_error();
@@ -396,13 +494,28 @@ bool UdpSocket::send_batch(std::span<const UdpPacket> packets, std::error_code&
 
   // Windows doesn't have sendmmsg, so send each packet individually.
   for (const auto& pkt : packets) {
-    if (!send(pkt.data, pkt.remote, ec)) {
+    if (!send(pkt.data, pkt.remote, ec, pkt.ecn)) {
       return false;
     }
   }
   return true;
 }
 
+bool UdpSocket::enable_txtime(std::error_code& ec) {
+  // Winsock has no per-packet transmit time; paced packets leave when handed over.
+  ec = std::make_error_code(std::errc::operation_not_supported);
+  return false;
+}
+
+bool UdpSocket::set_dont_fragment(bool enable, std::error_code& ec) {
+  if (!set_dont_fragment_option(static_cast<SOCKET>(fd_), enable)) {
+    ec = last_error();
+    return false;
+  }
+  dont_fragment_ = enable;
+  return true;
+}
+
 bool UdpSocket::poll(const ReceiveHandler& handler, int timeout_ms, std::error_code& ec) {
   SOCKET s = static_cast<SOCKET>(fd_);
   if (s == INVALID_SOCKET) {
@@ -438,12 +551,32 @@ bool UdpSocket::poll(const ReceiveHandler& handler, int timeout_ms, std::error_c
 
   // Read available data - may have multiple packets pending
   int packets_read = 0;
+  const LPFN_WSARECVMSG recv_msg = recv_msg_function(s);
   while (true) {
     std::array<char, 65535> buffer{};
     sockaddr_in src{};
     int src_len = sizeof(src);
-    const int read = ::recvfrom(s, buffer.data(), static_cast<int>(buffer.size()), 0,
-                                 reinterpret_cast<sockaddr*>(&src), &src_len);
+    std::uint8_t ecn = 0;
+    int read = SOCKET_ERROR;
+    if (recv_msg != nullptr) {
+      WSABUF data_buffer{static_cast<ULONG>(buffer.size()), buffer.data()};
+      EcnControl control;
+      WSAMSG msg{};
+      msg.name = reinterpret_cast<sockaddr*>(&src);
+      msg.namelen = src_len;
+      msg.lpBuffers = &data_buffer;
+      msg.dwBufferCount = 1;
+      msg.Control.buf = control.buffer.data();
+      msg.Control.len = static_cast<ULONG>(control.buffer.size());
+      DWORD bytes = 0;
+      if (recv_msg(s, &msg, &bytes, nullptr, nullptr) == 0) {
+        read = static_cast<int>(bytes);
+        ecn = received_ecn(msg);
+      }
+    } else {
+      read = ::recvfrom(s, buffer.data(), static_cast<int>(buffer.size()), 0,
+                        reinterpret_cast<sockaddr*>(&src), &src_len);
+    }
     if (read == SOCKET_ERROR) {
       int err = WSAGetLastError();
       if (err == WSAEWOULDBLOCK || err == WSAEINTR) {
@@ -466,7 +599,7 @@ bool UdpSocket::poll(const ReceiveHandler& handler, int timeout_ms, std::error_c
       handler(UdpPacket{
           std::vector<std::uint8_t>(reinterpret_cast<std::uint8_t*>(buffer.data()),
                                      reinterpret_cast<std::uint8_t*>(buffer.data()) + read),
-          remote});
+          remote, ecn});
       packets_read++;
     } else {
       break;  // No data read
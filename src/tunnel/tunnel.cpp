@@ -1,5 +1,6 @@
 #include "tunnel/tunnel.h"
 
+#include <algorithm>
 #include <array>
 #include <fstream>
 
@@ -18,12 +19,24 @@ namespace veil::tunnel {
 namespace {
 constexpr std::size_t kMaxPacketSize = 65535;
 
-// Helper functions for ACK sending logging (Issue #72 fix)
-// These avoid the bugprone-lambda-function-name clang-tidy warning when LOG_* is used in lambdas
-void log_ack_send_error(const std::error_code& ec) {
-  LOG_WARN("Failed to send ACK to server: {}", ec.message());
+// TUN packets held while reconnecting. Anything older is stale by the time we reconnect.
+constexpr std::size_t kMaxPendingTunPackets = 64;
+
+// TUN packets read per loop iteration; they are packed together before the UDP poll.
+constexpr std::size_t kTunReadBatch = 32;
+
+// How long to wait for a 0-RTT ACCEPT/REJECT before falling back to a full handshake.
+// A server with 0-RTT disabled drops the INIT silently, so keep this short.
+constexpr auto kZeroRttResponseTimeout = std::chrono::milliseconds(3000);
+
+std::uint64_t wall_clock_ms() {
+  return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                        std::chrono::system_clock::now().time_since_epoch())
+                                        .count());
 }
 
+// Helper functions for ACK sending logging (Issue #72 fix)
+// These avoid the bugprone-lambda-function-name clang-tidy warning when LOG_* is used in lambdas
 void log_ack_sent([[maybe_unused]] std::uint64_t ack, [[maybe_unused]] std::uint32_t bitmap) {
   LOG_DEBUG("Sent ACK to server: ack={}, bitmap={:#010x}", ack, bitmap);
 }
@@ -120,6 +133,7 @@ Tunnel::Tunnel(TunnelConfig config, std::function<TimePoint()> now_fn)
     : config_(std::move(config)),
       now_fn_(std::move(now_fn)),
       pmtu_discovery_(config_.pmtu, now_fn_),
+      pacing_calendar_(config_.pacing),
       ack_scheduler_(mux::AckSchedulerConfig{}, now_fn_) {}
 
 Tunnel::~Tunnel() { stop(); }
@@ -146,6 +160,21 @@ bool Tunnel::initialize(std::error_code& ec) {
     LOG_WARN("No pre-shared key file specified - connection will fail!");
   }
 
+  // Load cached session tickets so the first connection can already use 0-RTT.
+  if (config_.enable_zero_rtt && !config_.psk.empty()) {
+    ticket_store_key_ = handshake::SessionTicketStore::derive_storage_key(config_.psk);
+    if (!config_.ticket_cache_file.empty()) {
+      std::error_code cache_ec;
+      if (!ticket_store_.load(config_.ticket_cache_file, ticket_store_key_, cache_ec)) {
+        // Not fatal: the next full handshake issues a fresh ticket.
+        LOG_WARN("Ignoring session ticket cache {}: {}", config_.ticket_cache_file,
+                 cache_ec.message());
+      } else {
+        LOG_DEBUG("Loaded {} session ticket(s)", ticket_store_.size());
+      }
+    }
+  }
+
   // Generate ephemeral key pair for this session.
   key_pair_ = crypto::generate_x25519_keypair();
   LOG_DEBUG("Generated ephemeral key pair");
@@ -180,6 +209,8 @@ bool Tunnel::initialize(std::error_code& ec) {
   } else {
     LOG_INFO("UDP socket opened on port {}", actual_port);
   }
+  enable_kernel_pacing();
+  configure_dont_fragment();
 
   // Create event loop.
   event_loop_ = std::make_unique<transport::EventLoop>(config_.event_loop, now_fn_);
@@ -257,6 +288,7 @@ void Tunnel::run() {
 
       set_state(ConnectionState::kConnected);
       stats_.connected_since = now_fn_();
+      flush_pending_packets();
     }
   }
 
@@ -279,25 +311,41 @@ void Tunnel::run() {
     std::error_code ec;
     loop_iterations++;
 
-    // Check TUN device for incoming packets (only if device is open).
-    if (tun_device_.is_open()) {
+    // Drain a batch of packets from the TUN device (only if device is open). While the
+    // send scheduler is backlogged, leave packets in the device queue: the inner
+    // stack sees it full and slows down instead of filling ours.
+    std::size_t tun_batch = 0;
+    while (tun_device_.is_open() && tun_batch < kTunReadBatch &&
+           !(session_ && session_->send_backlogged())) {
       auto tun_read = tun_device_.read_into(tun_buffer, ec);
       if (tun_read > 0) {
         on_tun_packet(std::span<const std::uint8_t>(tun_buffer.data(), static_cast<std::size_t>(tun_read)));
-      } else if (tun_read < 0) {
-        LOG_ERROR("TUN read error: {}", ec.message());
-        stats_.tun_read_errors++;
+        ++tun_batch;
+      } else {
+        if (tun_read < 0) {
+          LOG_ERROR("TUN read error: {}", ec.message());
+          stats_.tun_read_errors++;
+        }
+        break;
       }
     }
 
-    // Poll UDP socket for incoming packets.
+    // Poll UDP socket for incoming packets. Don't block while packed frames are waiting,
+    // nor past the next paced departure.
+    int poll_timeout_ms = (session_ && session_->has_packed_frames()) ? 0 : 10;
+    if (const auto wait = pacing_calendar_.time_until_release(now_fn_())) {
+      poll_timeout_ms = std::min(
+          poll_timeout_ms,
+          static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(*wait).count()));
+    }
     if (!udp_socket_.poll(
         [this](const transport::UdpPacket& pkt) {
-          on_udp_packet(pkt.data, pkt.remote);
+          on_udp_packet(pkt.data, pkt.remote, pkt.ecn);
         },
-        10, ec)) {
+        poll_timeout_ms, ec)) {
       LOG_ERROR("UDP poll failed: {}", ec.message());
     }
+    release_paced();
 
     // Periodic diagnostic logging (every 5 seconds when connected)
     auto now = now_fn_();
@@ -329,7 +377,7 @@ void Tunnel::run() {
       for (const auto& pkt : retransmits) {
         std::error_code send_ec;
         transport::UdpEndpoint remote{config_.server_address, config_.server_port};
-        if (!udp_socket_.send(pkt, remote, send_ec)) {
+        if (!udp_socket_.send(pkt, remote, send_ec, session_->outgoing_ecn())) {
           LOG_WARN("Failed to send retransmit: {}", send_ec.message());
         }
       }
@@ -338,22 +386,22 @@ void Tunnel::run() {
       // The scheduler uses a timer to batch ACKs, reducing overhead.
       auto stream_id_opt = ack_scheduler_.check_ack_timer();
       if (stream_id_opt) {
-        auto ack_frame_opt = ack_scheduler_.get_pending_ack(*stream_id_opt);
-        if (ack_frame_opt) {
-          auto ack_mux_frame = mux::make_ack_frame(
-              ack_frame_opt->stream_id, ack_frame_opt->ack, ack_frame_opt->bitmap);
-          auto ack_packet = session_->encrypt_frame(ack_mux_frame);
-          transport::UdpEndpoint server_endpoint{config_.server_address, config_.server_port};
-          std::error_code send_ec;
-          if (!udp_socket_.send(ack_packet, server_endpoint, send_ec)) {
-            log_ack_send_error(send_ec);
-          } else {
-            log_ack_sent(ack_frame_opt->ack, ack_frame_opt->bitmap);
-          }
-          ack_scheduler_.ack_sent(*stream_id_opt);
-        }
+        send_pending_ack(*stream_id_opt);
+      }
+
+      // Flow control: repeat blocked reports while the server's credit holds data back.
+      if (session_->flow_blocked()) {
+        send_flow_control();
       }
 
+      // Path MTU: probes are timed, and a lost one is sent again.
+      send_path_mtu();
+
+      // Batch end: send the packed frames (TUN packets and ACKs). While the TUN keeps
+      // filling whole batches, hold the remainder up to packing_delay for the next one.
+      send_paced(tun_batch == kTunReadBatch ? session_->flush_packed_if_due()
+                                            : session_->flush_packed());
+
       // Check for session rotation.
       if (session_->should_rotate_session()) {
         session_->rotate_session();
@@ -392,26 +440,86 @@ void Tunnel::on_tun_packet(std::span<const std::uint8_t> packet) {
   stats_.tun_bytes_received += packet.size();
 
   if (!session_ || state_.load() != ConnectionState::kConnected) {
+    // Hold the packet for the next session (as 0-RTT early data if we have a ticket).
+    if (running_.load()) {
+      if (pending_tun_packets_.size() >= kMaxPendingTunPackets) {
+        pending_tun_packets_.pop_front();
+      }
+      pending_tun_packets_.emplace_back(packet.begin(), packet.end());
+    }
     return;
   }
 
-  // Encrypt and send through UDP.
-  auto encrypted_packets = session_->encrypt_data(packet);
-  for (const auto& enc_pkt : encrypted_packets) {
+  // Encrypt and send through UDP (as a DATAGRAM frame once both sides offered datagram_mode).
+  // Small packets are packed together; the pacing calendar spaces out what is ready.
+  send_paced(session_->queue_ip_packet(packet));
+}
+
+bool Tunnel::send_encrypted(const std::vector<std::vector<std::uint8_t>>& packets) {
+  bool all_sent = true;
+  transport::UdpEndpoint remote{config_.server_address, config_.server_port};
+  for (const auto& enc_pkt : packets) {
     std::error_code ec;
-    transport::UdpEndpoint remote{config_.server_address, config_.server_port};
-    if (!udp_socket_.send(enc_pkt, remote, ec)) {
+    if (!udp_socket_.send(enc_pkt, remote, ec, session_->outgoing_ecn())) {
       LOG_WARN("Failed to send encrypted packet: {}", ec.message());
       stats_.encrypt_errors++;
+      all_sent = false;
       continue;
     }
     stats_.udp_packets_sent++;
     stats_.udp_bytes_sent += enc_pkt.size();
   }
+  return all_sent;
+}
+
+void Tunnel::send_paced(const std::vector<std::vector<std::uint8_t>>& packets) {
+  transport::UdpEndpoint remote{config_.server_address, config_.server_port};
+  for (const auto& enc_pkt : packets) {
+    transport::UdpPacket paced{enc_pkt, remote, session_->outgoing_ecn()};
+    paced.send_at = session_->pace_packet(enc_pkt.size());
+    pacing_calendar_.schedule(std::move(paced));
+  }
+  release_paced();
+}
+
+void Tunnel::release_paced() {
+  paced_batch_.clear();
+  pacing_calendar_.release(now_fn_(), paced_batch_);
+  if (paced_batch_.empty()) {
+    return;
+  }
+  std::error_code ec;
+  if (!udp_socket_.send_batch(paced_batch_, ec)) {
+    LOG_WARN("Failed to send paced packets: {}", ec.message());
+    stats_.encrypt_errors++;
+    return;
+  }
+  for (const auto& pkt : paced_batch_) {
+    stats_.udp_packets_sent++;
+    stats_.udp_bytes_sent += pkt.data.size();
+  }
+}
+
+void Tunnel::enable_kernel_pacing() {
+  std::error_code ec;
+  if (udp_socket_.enable_txtime(ec)) {
+    LOG_DEBUG("Kernel pacing (SO_TXTIME) enabled");
+  } else {
+    LOG_DEBUG("Kernel pacing unavailable ({}); paced packets leave when released",
+              ec.message());
+  }
+}
+
+void Tunnel::configure_dont_fragment() {
+  std::error_code ec;
+  if (!udp_socket_.set_dont_fragment(config_.transport.enable_path_mtu_discovery, ec)) {
+    LOG_WARN("Failed to set DF for path MTU discovery: {}", ec.message());
+  }
 }
 
 void Tunnel::on_udp_packet(std::span<const std::uint8_t> packet,
-                            const transport::UdpEndpoint& remote) {
+                            [[maybe_unused]] const transport::UdpEndpoint& remote,
+                            std::uint8_t ecn) {
   stats_.udp_packets_received++;
   stats_.udp_bytes_received += packet.size();
 
@@ -426,6 +534,8 @@ void Tunnel::on_udp_packet(std::span<const std::uint8_t> packet,
     stats_.decrypt_errors++;
     return;
   }
+  // ECN counts for the next ACK, and a CE mark carried over to the inner packets.
+  session_->apply_outer_ecn(ecn, *frames);
 
   // Process each frame.
   for (const auto& frame : *frames) {
@@ -465,31 +575,76 @@ void Tunnel::on_udp_packet(std::span<const std::uint8_t> packet,
 
       if (should_send_ack) {
         // Scheduler determined immediate ACK is needed (e.g., out-of-order or every N packets)
-        auto ack_frame_opt = ack_scheduler_.get_pending_ack(frame.data.stream_id);
-        if (ack_frame_opt) {
-          // IMPORTANT: Use encrypt_frame() instead of encrypt_data() to preserve the ACK frame kind.
-          // encrypt_data() wraps data in a DATA frame, which would cause the receiver to
-          // incorrectly interpret the ACK as data and try to write it to TUN.
-          auto ack_mux_frame = mux::make_ack_frame(
-              ack_frame_opt->stream_id, ack_frame_opt->ack, ack_frame_opt->bitmap);
-          auto ack_packet = session_->encrypt_frame(ack_mux_frame);
-          transport::UdpEndpoint server_endpoint{config_.server_address, config_.server_port};
-          std::error_code send_ec;
-          if (!udp_socket_.send(ack_packet, server_endpoint, send_ec)) {
-            log_ack_send_error(send_ec);
-          } else {
-            log_ack_sent(ack_frame_opt->ack, ack_frame_opt->bitmap);
-          }
-          ack_scheduler_.ack_sent(frame.data.stream_id);
-        }
+        send_pending_ack(frame.data.stream_id);
+      }
+    } else if (frame.kind == mux::FrameKind::kDatagram) {
+      // Unreliable IP packet: straight to TUN, no reordering.
+      std::error_code ec;
+      if (!tun_device_.write(frame.datagram.payload, ec)) {
+        LOG_ERROR("Failed to write to TUN: {}", ec.message());
+        stats_.tun_write_errors++;
+        continue;
+      }
+      stats_.tun_packets_sent++;
+      stats_.tun_bytes_sent += frame.datagram.payload.size();
+
+      // Loss feedback only: the ACK feeds the server's congestion controller.
+      if (session_->datagram_loss_feedback() &&
+          ack_scheduler_.on_packet_received(mux::kDatagramStreamId, frame.datagram.sequence)) {
+        send_pending_ack(mux::kDatagramStreamId);
       }
     } else if (frame.kind == mux::FrameKind::kAck) {
       session_->process_ack(frame.ack);
+    } else if (frame.kind == mux::FrameKind::kAckRanges) {
+      session_->process_ack(frame.ack_ranges);
+    } else if (frame.kind == mux::FrameKind::kControl &&
+               frame.control.type == mux::kControlSessionTicket) {
+      handle_ticket_message(frame.control.payload);
     }
   }
 
-  // Update PMTU discovery.
-  pmtu_discovery_.handle_probe_success(remote.host, static_cast<int>(packet.size()));
+  // FEC: answer the server's offer, or advertise a new group size.
+  send_fec_params();
+  // Wire format: answer the server's v2 offer.
+  send_wire_format();
+  // Datagram mode, frame packing and extended ACKs: answer the server's offers.
+  send_datagram_mode();
+  send_frame_packing();
+  send_ack_ranges();
+  // Header compression: answer the server's offer.
+  send_header_compression();
+  // Payload compression: answer the server's offer.
+  send_payload_compression();
+  // Path MTU: acknowledge probes, and probe further once one is acknowledged.
+  send_path_mtu();
+  // Flow control: grant the credit just freed, and send what new credit covers.
+  send_flow_control();
+}
+
+void Tunnel::send_pending_ack(std::uint64_t stream_id) {
+  auto ack_frame_opt = ack_scheduler_.get_pending_ack(stream_id);
+  if (!ack_frame_opt) {
+    return;
+  }
+  // IMPORTANT: Queue the ACK frame itself instead of using encrypt_data(), which would
+  // wrap it in a DATA frame that the receiver would try to write to TUN. The ACK rides
+  // in the next packed packet, or goes out alone at batch end.
+  // Extended ACKs carry every received range. Reliable DATA is acknowledged by packet
+  // sequence, which only the session sees (fragments never reach this loop); datagram
+  // sequences are recorded by the scheduler.
+  mux::MuxFrame ack_mux_frame;
+  if (!session_->ack_ranges_enabled()) {
+    ack_mux_frame = mux::make_ack_frame(
+        ack_frame_opt->stream_id, ack_frame_opt->ack, ack_frame_opt->bitmap);
+  } else if (stream_id == mux::kDatagramStreamId) {
+    ack_mux_frame = mux::make_ack_ranges_frame(*ack_scheduler_.get_pending_ack_ranges(stream_id));
+  } else {
+    ack_mux_frame = mux::make_ack_ranges_frame(session_->generate_ack_ranges(stream_id));
+  }
+  if (send_encrypted(session_->queue_frame(std::move(ack_mux_frame)))) {
+    log_ack_sent(ack_frame_opt->ack, ack_frame_opt->bitmap);
+  }
+  ack_scheduler_.ack_sent(stream_id);
 }
 
 bool Tunnel::perform_handshake(std::error_code& ec) {
@@ -508,63 +663,197 @@ bool Tunnel::perform_handshake(std::error_code& ec) {
   }
   LOG_DEBUG("HANDSHAKE: PSK validated (32 bytes)");
 
+  // PERFORMANCE: With a ticket from an earlier session, resume with 0-RTT: no X25519 on
+  // either side, and queued packets ride along in the INIT instead of waiting a round trip.
+  if (config_.enable_zero_rtt) {
+    if (auto ticket = ticket_store_.get_ticket(ticket_server_id())) {
+      if (perform_zero_rtt_handshake(*ticket, ec)) {
+        return true;
+      }
+      if (ec == std::errc::operation_canceled) {
+        return false;
+      }
+      // Only an explicit REJECT says the ticket is no good. A timeout or a garbled answer
+      // says nothing about it, so keep it for the next reconnect.
+      if (ec == std::errc::connection_refused) {
+        LOG_INFO("HANDSHAKE: 0-RTT ticket rejected, falling back to full handshake");
+        ticket_store_.remove_ticket(ticket_server_id());
+        save_ticket_cache();
+      } else {
+        LOG_INFO("HANDSHAKE: 0-RTT not answered ({}), falling back to full handshake",
+                 ec.message());
+      }
+      ec.clear();
+    }
+  }
+
   // Create handshake initiator.
   handshake::HandshakeInitiator initiator(config_.psk, config_.handshake_skew_tolerance);
 
-  // Generate INIT message.
-  auto init_msg = initiator.create_init();
-  if (init_msg.empty()) {
+  transport::UdpEndpoint remote{config_.server_address, config_.server_port};
+  std::optional<handshake::HandshakeSession> hs_session;
+
+  // A server under load answers the first INIT with a stateless RETRY; the second INIT
+  // echoes its cookie.
+  constexpr int kMaxHandshakeAttempts = 2;
+  for (int attempt = 0; attempt < kMaxHandshakeAttempts && !hs_session; ++attempt) {
+    // Generate INIT message.
+    auto init_msg = initiator.create_init();
+    if (init_msg.empty()) {
+      ec = std::make_error_code(std::errc::protocol_error);
+      LOG_ERROR("Failed to create handshake INIT message");
+      return false;
+    }
+
+    LOG_INFO("========================================");
+    LOG_INFO("HANDSHAKE: Generated INIT message");
+    LOG_INFO("  Size: {} bytes", init_msg.size());
+    LOG_INFO("  Target: {}:{}", config_.server_address, config_.server_port);
+    // Log first few bytes of encrypted INIT for debugging (nonce is public, safe to log)
+    if (init_msg.size() >= 12) {
+      LOG_DEBUG("  Nonce (first 12 bytes): {:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}",
+                init_msg[0], init_msg[1], init_msg[2], init_msg[3],
+                init_msg[4], init_msg[5], init_msg[6], init_msg[7],
+                init_msg[8], init_msg[9], init_msg[10], init_msg[11]);
+    }
+    LOG_INFO("========================================");
+
+    // Send INIT message.
+    if (!udp_socket_.send(init_msg, remote, ec)) {
+      LOG_ERROR("HANDSHAKE: Failed to send INIT: {}", ec.message());
+      return false;
+    }
+    LOG_INFO("HANDSHAKE: INIT sent successfully, waiting for RESPONSE...");
+
+    // Wait for RESPONSE.
+    std::vector<std::uint8_t> response;
+    if (!receive_handshake_packet(response, config_.handshake_skew_tolerance, ec)) {
+      if (ec == std::errc::timed_out) {
+        LOG_ERROR("HANDSHAKE: Timeout waiting for RESPONSE after {}ms",
+                  config_.handshake_skew_tolerance.count());
+        LOG_ERROR("HANDSHAKE: No packets received from server");
+      }
+      return false;
+    }
+
+    // Process RESPONSE.
+    hs_session = initiator.consume_response(response);
+    if (!hs_session) {
+      if (attempt + 1 < kMaxHandshakeAttempts && initiator.consume_retry(response)) {
+        LOG_INFO("HANDSHAKE: Server is under load, retrying with cookie");
+        continue;
+      }
+      ec = std::make_error_code(std::errc::protocol_error);
+      LOG_ERROR("Failed to process handshake RESPONSE");
+      return false;
+    }
+  }
+  if (!hs_session) {
     ec = std::make_error_code(std::errc::protocol_error);
-    LOG_ERROR("Failed to create handshake INIT message");
     return false;
   }
 
-  LOG_INFO("========================================");
-  LOG_INFO("HANDSHAKE: Generated INIT message");
-  LOG_INFO("  Size: {} bytes", init_msg.size());
-  LOG_INFO("  Target: {}:{}", config_.server_address, config_.server_port);
-  // Log first few bytes of encrypted INIT for debugging (nonce is public, safe to log)
-  if (init_msg.size() >= 12) {
-    LOG_DEBUG("  Nonce (first 12 bytes): {:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}",
-              init_msg[0], init_msg[1], init_msg[2], init_msg[3],
-              init_msg[4], init_msg[5], init_msg[6], init_msg[7],
-              init_msg[8], init_msg[9], init_msg[10], init_msg[11]);
+  // Create transport session from handshake result.
+  session_keys_ = hs_session->keys;
+  session_ = std::make_unique<transport::TransportSession>(*hs_session, config_.transport, now_fn_);
+
+  LOG_INFO("Handshake completed successfully, session ID: {}", session_->session_id());
+  return true;
+}
+
+bool Tunnel::perform_zero_rtt_handshake(const handshake::SessionTicket& ticket,
+                                        std::error_code& ec) {
+  handshake::ZeroRttInitiator initiator(config_.psk, ticket);
+
+  // Early data: the oldest queued packets, as many as fit in the INIT.
+  std::vector<std::vector<std::uint8_t>> early_data;
+  std::size_t early_bytes = 0;
+  for (const auto& packet : pending_tun_packets_) {
+    early_bytes += 2 + packet.size();
+    if (early_bytes > handshake::kMaxEarlyDataSize) {
+      break;
+    }
+    early_data.push_back(packet);
   }
-  LOG_INFO("========================================");
 
-  // Send INIT message.
   transport::UdpEndpoint remote{config_.server_address, config_.server_port};
-  if (!udp_socket_.send(init_msg, remote, ec)) {
-    LOG_ERROR("HANDSHAKE: Failed to send INIT: {}", ec.message());
+  const auto timeout = std::min<std::chrono::milliseconds>(kZeroRttResponseTimeout,
+                                                           config_.handshake_skew_tolerance);
+  std::optional<handshake::HandshakeSession> hs_session;
+
+  // A server requiring cookies answers the first 0-RTT INIT with a RETRY, exactly as for a
+  // full INIT; the ticket is fine, so echo the cookie in a fresh 0-RTT INIT.
+  constexpr int kMaxZeroRttAttempts = 2;
+  for (int attempt = 0; attempt < kMaxZeroRttAttempts && !hs_session; ++attempt) {
+    auto init_msg = initiator.create_zero_rtt_init(early_data);
+    if (init_msg.empty()) {
+      ec = std::make_error_code(std::errc::protocol_error);
+      return false;
+    }
+    if (!udp_socket_.send(init_msg, remote, ec)) {
+      LOG_ERROR("HANDSHAKE: Failed to send 0-RTT INIT: {}", ec.message());
+      return false;
+    }
+    LOG_INFO("HANDSHAKE: 0-RTT INIT sent ({} bytes, {} early data packet(s))", init_msg.size(),
+             initiator.early_data_packets());
+
+    std::vector<std::uint8_t> response;
+    if (!receive_handshake_packet(response, timeout, ec)) {
+      return false;
+    }
+    hs_session = initiator.consume_zero_rtt_response(response);
+    if (!hs_session) {
+      if (initiator.was_rejected()) {
+        ec = std::make_error_code(std::errc::connection_refused);
+        return false;
+      }
+      if (attempt + 1 < kMaxZeroRttAttempts && initiator.consume_retry(response)) {
+        LOG_INFO("HANDSHAKE: Server is under load, retrying 0-RTT with cookie");
+        continue;
+      }
+      ec = std::make_error_code(std::errc::protocol_error);
+      return false;
+    }
+  }
+  if (!hs_session) {
+    ec = std::make_error_code(std::errc::protocol_error);
     return false;
   }
-  LOG_INFO("HANDSHAKE: INIT sent successfully, waiting for RESPONSE...");
 
-  // Wait for RESPONSE.
+  // The server has the early data; only the rest of the queue still needs sending.
+  pending_tun_packets_.erase(
+      pending_tun_packets_.begin(),
+      pending_tun_packets_.begin() + static_cast<std::ptrdiff_t>(initiator.early_data_packets()));
+
+  session_keys_ = hs_session->keys;
+  session_ = std::make_unique<transport::TransportSession>(*hs_session, config_.transport, now_fn_);
+  LOG_INFO("Handshake resumed with 0-RTT, session ID: {}", session_->session_id());
+  return true;
+}
+
+bool Tunnel::receive_handshake_packet(std::vector<std::uint8_t>& packet,
+                                      std::chrono::milliseconds timeout, std::error_code& ec) {
   // Use short polling intervals to allow checking running_ flag and respond quickly to stop().
-  std::vector<std::uint8_t> response;
   bool received = false;
   transport::UdpEndpoint response_endpoint;
-  int timeout_ms = static_cast<int>(config_.handshake_skew_tolerance.count());
-  LOG_DEBUG("HANDSHAKE: Polling for response (timeout: {}ms)", timeout_ms);
+  LOG_DEBUG("HANDSHAKE: Polling for response (timeout: {}ms)", timeout.count());
 
   auto start_time = now_fn_();
-  const auto timeout_duration = std::chrono::milliseconds(timeout_ms);
   constexpr int poll_interval_ms = 100;  // Poll in 100ms chunks to check running_ flag.
 
   while (!received && running_.load()) {
     auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now_fn_() - start_time);
-    if (elapsed >= timeout_duration) {
+    if (elapsed >= timeout) {
       break;  // Timeout reached.
     }
 
     // Calculate remaining time, but don't exceed poll_interval_ms.
-    auto remaining = timeout_duration - elapsed;
+    auto remaining = timeout - elapsed;
     int current_poll_ms = std::min(poll_interval_ms, static_cast<int>(remaining.count()));
 
     udp_socket_.poll(
-        [&response, &received, &response_endpoint](const transport::UdpPacket& pkt) {
-          response = pkt.data;
+        [&packet, &received, &response_endpoint](const transport::UdpPacket& pkt) {
+          packet = pkt.data;
           response_endpoint = pkt.remote;
           received = true;
         },
@@ -573,38 +862,137 @@ bool Tunnel::perform_handshake(std::error_code& ec) {
     if (received) {
       break;  // Got response!
     }
+  }
 
-    // Check if we should stop (user pressed disconnect).
-    if (!running_.load()) {
-      LOG_INFO("HANDSHAKE: Aborted by user disconnect");
-      ec = std::make_error_code(std::errc::operation_canceled);
-      return false;
-    }
+  // Check if we should stop (user pressed disconnect).
+  if (!running_.load()) {
+    LOG_INFO("HANDSHAKE: Aborted by user disconnect");
+    ec = std::make_error_code(std::errc::operation_canceled);
+    return false;
   }
 
-  if (!received || response.empty()) {
+  if (!received || packet.empty()) {
     ec = std::make_error_code(std::errc::timed_out);
-    LOG_ERROR("HANDSHAKE: Timeout waiting for RESPONSE after {}ms", timeout_ms);
-    LOG_ERROR("HANDSHAKE: No packets received from server");
     return false;
   }
 
   LOG_INFO("HANDSHAKE: Received packet from {}:{}, size: {} bytes",
-           response_endpoint.host, response_endpoint.port, response.size());
+           response_endpoint.host, response_endpoint.port, packet.size());
+  return true;
+}
 
-  // Process RESPONSE.
-  auto hs_session = initiator.consume_response(response);
-  if (!hs_session) {
-    ec = std::make_error_code(std::errc::protocol_error);
-    LOG_ERROR("Failed to process handshake RESPONSE");
-    return false;
+void Tunnel::flush_pending_packets() {
+  while (!pending_tun_packets_.empty()) {
+    if (!send_packet(pending_tun_packets_.front())) {
+      stats_.encrypt_errors++;
+    }
+    pending_tun_packets_.pop_front();
+  }
+  if (session_) {
+    send_fec_params();
+    send_wire_format();
+    send_datagram_mode();
+    send_frame_packing();
+    send_ack_ranges();
+    send_header_compression();
+    send_payload_compression();
+    send_path_mtu();
+    send_flow_control();
+    send_encrypted(session_->flush_packed());
   }
+}
 
-  // Create transport session from handshake result.
-  session_ = std::make_unique<transport::TransportSession>(*hs_session, config_.transport, now_fn_);
+void Tunnel::send_fec_params() {
+  if (auto params = session_->take_fec_params_frame()) {
+    send_encrypted(session_->queue_frame(std::move(*params)));
+  }
+}
 
-  LOG_INFO("Handshake completed successfully, session ID: {}", session_->session_id());
-  return true;
+void Tunnel::send_wire_format() {
+  if (auto offer = session_->take_wire_format_frame()) {
+    send_encrypted(session_->queue_frame(std::move(*offer)));
+  }
+}
+
+void Tunnel::send_datagram_mode() {
+  if (auto offer = session_->take_datagram_mode_frame()) {
+    send_encrypted(session_->queue_frame(std::move(*offer)));
+  }
+}
+
+void Tunnel::send_frame_packing() {
+  if (auto offer = session_->take_frame_packing_frame()) {
+    send_encrypted(session_->queue_frame(std::move(*offer)));
+  }
+}
+
+void Tunnel::send_ack_ranges() {
+  if (auto offer = session_->take_ack_ranges_frame()) {
+    send_encrypted(session_->queue_frame(std::move(*offer)));
+  }
+}
+
+void Tunnel::send_header_compression() {
+  if (auto offer = session_->take_header_compression_frame()) {
+    send_encrypted(session_->queue_frame(std::move(*offer)));
+  }
+}
+
+void Tunnel::send_payload_compression() {
+  if (auto offer = session_->take_payload_compression_frame()) {
+    send_encrypted(session_->queue_frame(std::move(*offer)));
+  }
+}
+
+void Tunnel::send_path_mtu() {
+  send_encrypted(session_->take_path_mtu_packets());
+
+  const auto payload_size = session_->max_payload_size();
+  if (path_payload_size_ == 0) {
+    path_payload_size_ = config_.transport.max_fragment_size;
+  }
+  if (payload_size != path_payload_size_) {
+    path_payload_size_ = payload_size;
+    const auto gained = static_cast<int>(payload_size) -
+                        static_cast<int>(config_.transport.max_fragment_size);
+    pmtu_discovery_.set_mtu(config_.server_address, config_.tun.mtu + gained);
+  }
+}
+
+void Tunnel::send_flow_control() {
+  for (auto& frame : session_->take_flow_control_frames()) {
+    send_encrypted(session_->queue_frame(std::move(frame)));
+  }
+  send_encrypted(session_->release_flow_blocked());
+}
+
+void Tunnel::handle_ticket_message(std::span<const std::uint8_t> body) {
+  if (!config_.enable_zero_rtt) {
+    return;
+  }
+  auto ticket = handshake::decode_ticket_message(body, session_keys_, wall_clock_ms());
+  if (!ticket) {
+    LOG_DEBUG("Ignoring malformed session ticket ({} bytes)", body.size());
+    return;
+  }
+  ticket_store_.store_ticket(ticket_server_id(), std::move(*ticket));
+  LOG_DEBUG("Stored session ticket for {}", ticket_server_id());
+  save_ticket_cache();
+}
+
+void Tunnel::save_ticket_cache() {
+  if (config_.ticket_cache_file.empty()) {
+    return;
+  }
+  std::error_code ec;
+  if (!ticket_store_.save(config_.ticket_cache_file, ticket_store_key_, ec)) {
+    LOG_WARN("Failed to save session ticket cache {}: {}", config_.ticket_cache_file,
+             ec.message());
+  }
+}
+
+std::string Tunnel::ticket_server_id() const {
+  return config_.server_address + ":" + std::to_string(config_.server_port);
 }
 
 void Tunnel::set_state(ConnectionState new_state) {
@@ -623,14 +1011,7 @@ bool Tunnel::send_packet(std::span<const std::uint8_t> data) {
     return false;
   }
 
-  auto encrypted_packets = session_->encrypt_data(data);
-  for (const auto& pkt : encrypted_packets) {
-    std::error_code ec;
-    transport::UdpEndpoint remote{config_.server_address, config_.server_port};
-    if (!udp_socket_.send(pkt, remote, ec)) {
-      return false;
-    }
-  }
+  send_paced(session_->queue_ip_packet(data));
   return true;
 }
 
@@ -679,6 +1060,10 @@ void Tunnel::handle_reconnect() {
     set_state(ConnectionState::kReconnecting);
     return;
   }
+  enable_kernel_pacing();
+  configure_dont_fragment();
+  // Packets paced for the old session are no use to the next one.
+  pacing_calendar_.clear();
 
   // Reconnect.
   transport::UdpEndpoint remote{config_.server_address, config_.server_port};
@@ -712,6 +1097,7 @@ void Tunnel::handle_reconnect() {
   stats_.reconnect_count++;
   stats_.connected_since = now_fn_();
   set_state(ConnectionState::kConnected);
+  flush_pending_packets();
   LOG_INFO("Reconnected successfully");
 }
 
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <span>
@@ -11,11 +13,13 @@
 #include <vector>
 
 #include "common/crypto/crypto_engine.h"
+#include "common/handshake/session_ticket.h"
 #include "common/obfuscation/obfuscation_profile.h"
 #include "transport/event_loop/event_loop.h"
 #include "transport/mux/ack_scheduler.h"
 #include "transport/mux/frame.h"
 #include "transport/session/transport_session.h"
+#include "transport/udp_socket/pacing_calendar.h"
 #include "transport/udp_socket/udp_socket.h"
 #include "tun/mtu_discovery.h"
 #include "tun/routing.h"
@@ -82,6 +86,10 @@ struct TunnelConfig {
   // Event loop configuration.
   transport::EventLoopConfig event_loop;
 
+  // Departure calendar for data packets, paced at the session's congestion controller
+  // rate (TransportSessionConfig::congestion_config.enable_pacing).
+  transport::PacingCalendarConfig pacing;
+
   // PMTU discovery configuration.
   tun::PmtuConfig pmtu;
 
@@ -98,6 +106,13 @@ struct TunnelConfig {
 
   // Timestamp skew tolerance for handshake.
   std::chrono::milliseconds handshake_skew_tolerance{30000};
+
+  // Reconnect with 0-RTT when the server has issued a session ticket, carrying packets
+  // queued while disconnected as early data.
+  bool enable_zero_rtt{true};
+
+  // Encrypted session ticket cache; lets 0-RTT survive a client restart (empty = memory only).
+  std::string ticket_cache_file;
 };
 
 // Callback types.
@@ -157,18 +172,82 @@ class Tunnel {
   // Called when a packet is received from the TUN device.
   virtual void on_tun_packet(std::span<const std::uint8_t> packet);
 
-  // Called when a packet is received from the UDP socket.
-  virtual void on_udp_packet(std::span<const std::uint8_t> packet, const transport::UdpEndpoint& remote);
+  // Called when a packet is received from the UDP socket, with the ECN field of its IP
+  // header.
+  virtual void on_udp_packet(std::span<const std::uint8_t> packet, const transport::UdpEndpoint& remote,
+                             std::uint8_t ecn);
 
   // Called to perform handshake (client initiates, server responds).
   virtual bool perform_handshake(std::error_code& ec);
 
+  // Resume with a cached session ticket, answering a RETRY once. Returns false if the server
+  // did not accept: ec is connection_refused only for an explicit REJECT, timed_out or
+  // protocol_error otherwise, and operation_canceled if the tunnel was stopped meanwhile.
+  bool perform_zero_rtt_handshake(const handshake::SessionTicket& ticket, std::error_code& ec);
+
+  // Wait up to `timeout` for the next handshake packet from the server.
+  bool receive_handshake_packet(std::vector<std::uint8_t>& packet,
+                                std::chrono::milliseconds timeout, std::error_code& ec);
+
+  // Send TUN packets queued while the tunnel was not connected.
+  void flush_pending_packets();
+
+  // Queue the session's FEC parameters, if it has new ones to advertise.
+  void send_fec_params();
+
+  // Queue the session's wire format v2 offer, if not sent since the server's arrived.
+  void send_wire_format();
+
+  // Queue the session's header compression offer, if not sent since the server's arrived.
+  void send_datagram_mode();
+  void send_frame_packing();
+  void send_ack_ranges();
+  void send_header_compression();
+
+  // Queue the session's payload compression offer, if not sent since the server's arrived.
+  void send_payload_compression();
+
+  // Send path MTU probes and acknowledgements. When the discovered size changes, the TUN
+  // MTU follows it, so the inner stack sends packets that fit whole.
+  void send_path_mtu();
+
+  // Queue the session's flow control credit and blocked reports, and send the data
+  // that credit from the server has released.
+  void send_flow_control();
+
+  // Store a session ticket sent by the server.
+  void handle_ticket_message(std::span<const std::uint8_t> body);
+
+  // Write the ticket cache to ticket_cache_file (if configured).
+  void save_ticket_cache();
+
+  std::string ticket_server_id() const;
+
   // Set connection state.
   void set_state(ConnectionState new_state);
 
   // Send packet through the tunnel.
   bool send_packet(std::span<const std::uint8_t> data);
 
+  // Send encrypted packets to the server, updating stats. Returns false if any send failed.
+  bool send_encrypted(const std::vector<std::vector<std::uint8_t>>& packets);
+
+  // Queue data packets on the pacing calendar at their departure times, then send what
+  // is due. Control packets and ACKs go through send_encrypted() and are not held back.
+  void send_paced(const std::vector<std::vector<std::uint8_t>>& packets);
+
+  // Send the calendar's due packets as one batch, updating stats.
+  void release_paced();
+
+  // Best effort: have the kernel hold paced packets until their departure (SO_TXTIME).
+  void enable_kernel_pacing();
+
+  // DF on every packet while path MTU discovery probes, and on none otherwise.
+  void configure_dont_fragment();
+
+  // Send the AckScheduler's pending ACK for a stream, if any.
+  void send_pending_ack(std::uint64_t stream_id);
+
   // Handle reconnection logic.
   void handle_reconnect();
 
@@ -182,7 +261,11 @@ class Tunnel {
   tun::TunDevice tun_device_;
   tun::RouteManager route_manager_;
   tun::PmtuDiscovery pmtu_discovery_;
+  // Session payload size the TUN MTU was last set for.
+  std::size_t path_payload_size_{0};
   transport::UdpSocket udp_socket_;
+  transport::PacingCalendar pacing_calendar_;
+  std::vector<transport::UdpPacket> paced_batch_;
   std::unique_ptr<transport::TransportSession> session_;
   std::unique_ptr<transport::EventLoop> event_loop_;
   mux::AckScheduler ack_scheduler_;
@@ -205,6 +288,16 @@ class Tunnel {
   // Reconnection.
   int reconnect_attempts_{0};
   TimePoint last_reconnect_attempt_;
+
+  // 0-RTT resumption. session_keys_ are this client's keys for the current session, which
+  // the server's ticket for that session resumes.
+  handshake::SessionTicketStore ticket_store_;
+  std::array<std::uint8_t, handshake::kTicketStoreKeySize> ticket_store_key_{};
+  crypto::SessionKeys session_keys_{};
+
+  // TUN packets read while not connected (bounded, oldest dropped first). Sent as 0-RTT
+  // early data, or over the new session once connected.
+  std::deque<std::vector<std::uint8_t>> pending_tun_packets_;
 };
 
 }  // namespace veil::tunnel
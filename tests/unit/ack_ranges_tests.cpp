@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "transport/mux/ack_ranges.h"
+
+namespace veil::tests {
+
+namespace {
+
+bool same_ranges(const std::vector<mux::AckRange>& actual,
+                 const std::vector<mux::AckRange>& expected) {
+  if (actual.size() != expected.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < actual.size(); ++i) {
+    if (actual[i].smallest != expected[i].smallest || actual[i].largest != expected[i].largest) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST(AckRangeSetTests, InOrderSequencesFormOneRange) {
+  mux::AckRangeSet set;
+  for (std::uint64_t seq = 1; seq <= 1000; ++seq) {
+    EXPECT_TRUE(set.add(seq));
+  }
+  EXPECT_EQ(set.largest(), 1000U);
+  EXPECT_TRUE(same_ranges(set.ranges(), {{1, 1000}}));
+  EXPECT_FALSE(set.add(500));  // Duplicate
+}
+
+TEST(AckRangeSetTests, HolesBeyondThirtyTwoPacketsAreKept) {
+  mux::AckRangeSet set;
+  // 0..99 received except 10 and 60: the hole at 10 is far outside a 32-bit bitmap.
+  for (std::uint64_t seq = 0; seq < 100; ++seq) {
+    if (seq != 10 && seq != 60) {
+      set.add(seq);
+    }
+  }
+  EXPECT_TRUE(same_ranges(set.ranges(), {{61, 99}, {11, 59}, {0, 9}}));
+  EXPECT_FALSE(set.contains(10));
+  EXPECT_TRUE(set.contains(11));
+
+  // Filling a hole merges its neighbours.
+  set.add(60);
+  EXPECT_TRUE(same_ranges(set.ranges(), {{11, 99}, {0, 9}}));
+  set.add(10);
+  EXPECT_TRUE(same_ranges(set.ranges(), {{0, 99}}));
+}
+
+TEST(AckRangeSetTests, OldestRangesAreDroppedAtLimit) {
+  mux::AckRangeSet set(4);
+  for (std::uint64_t seq = 0; seq < 20; seq += 2) {
+    set.add(seq);
+  }
+  ASSERT_EQ(set.ranges().size(), 4U);
+  EXPECT_EQ(set.ranges().front().largest, 18U);
+  EXPECT_EQ(set.ranges().back().smallest, 12U);
+}
+
+TEST(AckRangeSetTests, LateSequenceBelowOldestRangeIsKept) {
+  mux::AckRangeSet set(4);
+  for (std::uint64_t seq = 10; seq < 18; seq += 2) {
+    set.add(seq);
+  }
+  // A retransmission of 2 arrives once the set is full: it must be reported.
+  set.add(2);
+  ASSERT_EQ(set.ranges().size(), 4U);
+  EXPECT_TRUE(set.contains(2));
+  EXPECT_FALSE(set.contains(10));
+  EXPECT_TRUE(set.contains(16));
+}
+
+TEST(AckRangeSetTests, BitmapMatchesAckFrameEncoding) {
+  mux::AckRangeSet set;
+  set.add(1);
+  set.add(2);
+  set.add(4);
+  EXPECT_EQ(set.largest(), 4U);
+  EXPECT_EQ(set.bitmap(), 0b110U);  // 2 and 1 received, 3 missing
+}
+
+TEST(AckRangeSetTests, BitmapConversionRoundTrips) {
+  const auto ranges = mux::ack_ranges_from_bitmap(10, 0b1011U);  // 9, 8, 6
+  EXPECT_TRUE(same_ranges(ranges, {{8, 10}, {6, 6}}));
+  EXPECT_TRUE(mux::ack_ranges_contain(ranges, 9));
+  EXPECT_FALSE(mux::ack_ranges_contain(ranges, 7));
+  EXPECT_FALSE(mux::ack_ranges_contain(ranges, 11));
+  EXPECT_FALSE(mux::ack_ranges_contain(ranges, 5));
+}
+
+}  // namespace veil::tests
@@ -184,4 +184,52 @@ TEST_F(AckSchedulerTest, DelayedAckStats) {
   EXPECT_EQ(scheduler.stats().acks_immediate, 1U);
 }
 
+TEST_F(AckSchedulerTest, OutOfOrderPacketSetsBitmapBit) {
+  AckScheduler scheduler(config_, [this]() { return now_; });
+
+  // 1, 2, 4, then the late 3: bit i of the bitmap is ack - 1 - i.
+  scheduler.on_packet_received(0, 1, false);
+  scheduler.on_packet_received(0, 2, false);
+  scheduler.on_packet_received(0, 4, false);
+  auto ack = scheduler.get_pending_ack(0);
+  ASSERT_TRUE(ack.has_value());
+  EXPECT_EQ(ack->ack, 4U);
+  EXPECT_EQ(ack->bitmap, 0b110U);  // 2 and 1 received, 3 missing
+
+  scheduler.on_packet_received(0, 3, false);
+  ack = scheduler.get_pending_ack(0);
+  ASSERT_TRUE(ack.has_value());
+  EXPECT_EQ(ack->ack, 4U);
+  EXPECT_EQ(ack->bitmap, 0b111U);
+}
+
+TEST_F(AckSchedulerTest, PendingAckRangesCoverOldHoles) {
+  AckScheduler scheduler(config_, [this]() { return now_; });
+
+  // A hole at 5, then 60 more packets: far outside the 32-bit bitmap.
+  for (std::uint64_t seq = 1; seq <= 65; ++seq) {
+    if (seq != 5) {
+      scheduler.on_packet_received(0, seq, false);
+    }
+  }
+  now_ += 4ms;
+  auto ack = scheduler.get_pending_ack_ranges(0);
+  ASSERT_TRUE(ack.has_value());
+  EXPECT_EQ(ack->ack_delay, std::chrono::microseconds(4000));
+  ASSERT_EQ(ack->ranges.size(), 2U);
+  EXPECT_EQ(ack->ranges[0].smallest, 6U);
+  EXPECT_EQ(ack->ranges[0].largest, 65U);
+  EXPECT_EQ(ack->ranges[1].smallest, 1U);
+  EXPECT_EQ(ack->ranges[1].largest, 4U);
+
+  // Ranges survive the ACK, so the next one repeats them in case this one is lost.
+  scheduler.ack_sent(0);
+  EXPECT_FALSE(scheduler.get_pending_ack_ranges(0).has_value());
+  scheduler.on_packet_received(0, 66, false);
+  ack = scheduler.get_pending_ack_ranges(0);
+  ASSERT_TRUE(ack.has_value());
+  ASSERT_EQ(ack->ranges.size(), 2U);
+  EXPECT_EQ(ack->ranges[0].largest, 66U);
+}
+
 }  // namespace veil::mux::tests
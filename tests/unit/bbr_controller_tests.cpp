@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+
+#include "transport/mux/bbr_controller.h"
+
+namespace veil::mux::tests {
+
+using namespace std::chrono_literals;
+
+class BbrControllerTest : public ::testing::Test {
+ protected:
+  static constexpr std::uint64_t kBandwidth = 1'400'000;  // 1000 MSS per second
+  static constexpr std::size_t kBdp = 140'000;             // at a 100 ms min RTT
+
+  void SetUp() override {
+    now_ = std::chrono::steady_clock::now();
+    config_.mss = 1400;
+    config_.initial_cwnd = static_cast<std::size_t>(10) * 1400;
+    config_.max_pacing_burst = 1;
+  }
+
+  // One round trip: ACK acked_bytes and report a delivery-rate sample for it.
+  void round_trip(BbrController& cc, std::uint64_t rate, std::size_t in_flight,
+                  std::size_t acked_bytes = 14000) {
+    now_ += 100ms;
+    cc.on_ack(acked_bytes);
+    RateSample sample;
+    sample.delivered = acked_bytes;
+    sample.interval = 100ms;
+    sample.delivery_rate = rate;
+    sample.rtt = 100ms;
+    sample.prior_delivered = round_start_delivered_;
+    sample.bytes_in_flight = in_flight;
+    delivered_ += acked_bytes;
+    round_start_delivered_ = delivered_;
+    cc.on_rate_sample(sample);
+  }
+
+  // Run Startup to a bandwidth plateau, then Drain into ProbeBW.
+  void reach_probe_bw(BbrController& cc) {
+    for (int i = 0; i < 4; ++i) {
+      round_trip(cc, kBandwidth, 2 * kBdp);
+    }
+    ASSERT_EQ(cc.mode(), BbrMode::kDrain);
+    round_trip(cc, kBandwidth, kBdp / 2);
+    ASSERT_EQ(cc.mode(), BbrMode::kProbeBw);
+  }
+
+  std::chrono::steady_clock::time_point now_;
+  CongestionConfig config_;
+  std::uint64_t delivered_{0};
+  std::uint64_t round_start_delivered_{0};
+};
+
+TEST_F(BbrControllerTest, StartupExitsWhenBandwidthStopsGrowing) {
+  BbrController cc(config_, [this]() { return now_; });
+  EXPECT_EQ(cc.mode(), BbrMode::kStartup);
+  EXPECT_EQ(cc.state(), CongestionState::kSlowStart);
+
+  // Bandwidth keeps doubling: stay in Startup.
+  for (std::uint64_t rate = kBandwidth / 8; rate < kBandwidth; rate *= 2) {
+    round_trip(cc, rate, kBdp);
+    EXPECT_EQ(cc.mode(), BbrMode::kStartup);
+  }
+  // A last round of growth, then three without 25% more: the pipe is full.
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(cc.mode(), BbrMode::kStartup);
+    round_trip(cc, kBandwidth, 2 * kBdp);
+  }
+  EXPECT_EQ(cc.mode(), BbrMode::kDrain);
+  EXPECT_EQ(cc.bottleneck_bandwidth(), kBandwidth);
+  EXPECT_EQ(cc.min_rtt(), std::chrono::microseconds(100ms));
+  EXPECT_LT(cc.pacing_rate(), kBandwidth);  // Draining the Startup queue
+
+  // Queue drained: cruise at the bottleneck rate with a 2 BDP window cap.
+  round_trip(cc, kBandwidth, kBdp);
+  EXPECT_EQ(cc.mode(), BbrMode::kProbeBw);
+  EXPECT_EQ(cc.state(), CongestionState::kCongestionAvoidance);
+  EXPECT_EQ(cc.pacing_rate(), kBandwidth);
+  EXPECT_EQ(cc.ssthresh(), 2 * kBdp + 3 * config_.mss);
+}
+
+TEST_F(BbrControllerTest, RandomLossDoesNotShrinkTheWindow) {
+  BbrController cc(config_, [this]() { return now_; });
+  reach_probe_bw(cc);
+  for (int i = 0; i < 30; ++i) {
+    round_trip(cc, kBandwidth, kBdp);
+  }
+  const auto cwnd = cc.cwnd();
+  EXPECT_EQ(cwnd, 2 * kBdp + 3 * config_.mss);
+
+  cc.on_fast_retransmit_loss();
+  cc.on_ecn_ce();
+  EXPECT_EQ(cc.cwnd(), cwnd);
+
+  // A timeout falls back to one packet until the path delivers again.
+  cc.on_timeout_loss();
+  EXPECT_EQ(cc.cwnd(), config_.mss);
+  round_trip(cc, kBandwidth, kBdp);
+  EXPECT_EQ(cc.cwnd(), cwnd);
+}
+
+TEST_F(BbrControllerTest, BandwidthEstimateExpiresAfterTenRounds) {
+  BbrController cc(config_, [this]() { return now_; });
+  reach_probe_bw(cc);
+
+  // The path slows to half: the old maximum ages out of the 10-round window.
+  for (std::size_t i = 0; i < BbrController::kBandwidthWindowRounds; ++i) {
+    EXPECT_EQ(cc.bottleneck_bandwidth(), kBandwidth);
+    round_trip(cc, kBandwidth / 2, kBdp / 2);
+  }
+  EXPECT_EQ(cc.bottleneck_bandwidth(), kBandwidth / 2);
+}
+
+TEST_F(BbrControllerTest, ProbeRttRefreshesStaleMinRtt) {
+  BbrController cc(config_, [this]() { return now_; });
+  reach_probe_bw(cc);
+  const auto cwnd = cc.cwnd();
+
+  now_ += BbrController::kMinRttWindow;
+  round_trip(cc, kBandwidth, kBdp);
+  EXPECT_EQ(cc.mode(), BbrMode::kProbeRtt);
+  EXPECT_LE(cc.cwnd(), 4 * config_.mss);
+
+  // Inflight drains to 4 packets, is held there for 200 ms, then the window returns.
+  round_trip(cc, kBandwidth, 4 * config_.mss);
+  EXPECT_EQ(cc.mode(), BbrMode::kProbeRtt);
+  now_ += BbrController::kProbeRttDuration;
+  round_trip(cc, kBandwidth, 4 * config_.mss);
+  EXPECT_EQ(cc.mode(), BbrMode::kProbeBw);
+  EXPECT_GE(cc.cwnd(), cwnd);
+}
+
+TEST_F(BbrControllerTest, PacesAtEstimatedBandwidth) {
+  BbrController cc(config_, [this]() { return now_; });
+  reach_probe_bw(cc);
+  ASSERT_EQ(cc.pacing_rate(), kBandwidth);
+
+  // 1400 B at 1.4 MB/s: one packet per millisecond.
+  EXPECT_TRUE(cc.check_pacing());
+  EXPECT_FALSE(cc.check_pacing());
+  ASSERT_TRUE(cc.time_until_next_send().has_value());
+  EXPECT_EQ(*cc.time_until_next_send(), 1ms);
+  now_ += 1ms;
+  EXPECT_TRUE(cc.check_pacing());
+  EXPECT_EQ(cc.stats().pacing_delays, 1U);
+}
+
+}  // namespace veil::mux::tests
@@ -171,6 +171,21 @@ TEST_F(CongestionControllerTest, FastRecoveryDeflation) {
   EXPECT_EQ(cc.state(), CongestionState::kCongestionAvoidance);
 }
 
+TEST_F(CongestionControllerTest, EcnCeHalvesWindowWithoutRecovery) {
+  config_.initial_cwnd = static_cast<std::size_t>(20) * 1400;
+
+  CongestionController cc(config_, [this]() { return now_; });
+
+  const std::size_t cwnd_before = cc.cwnd();
+  cc.on_ecn_ce();
+
+  // Nothing was lost, so there is no fast recovery inflation.
+  EXPECT_EQ(cc.ssthresh(), cwnd_before / 2);
+  EXPECT_EQ(cc.cwnd(), cc.ssthresh());
+  EXPECT_EQ(cc.state(), CongestionState::kCongestionAvoidance);
+  EXPECT_EQ(cc.stats().ecn_ce_events, 1U);
+}
+
 // ========== Timeout Tests ==========
 
 TEST_F(CongestionControllerTest, TimeoutReducesCwndToMinimum) {
@@ -384,4 +399,60 @@ TEST_F(CongestionControllerTest, CwndMaxEnforced) {
   EXPECT_LE(cc.cwnd(), config_.max_cwnd);
 }
 
+// ========== Spurious Loss Undo ==========
+
+TEST_F(CongestionControllerTest, SpuriousLossRestoresWindow) {
+  CongestionController cc(config_, [this]() { return now_; });
+  for (int i = 0; i < 10; ++i) {
+    cc.on_ack(config_.mss);
+  }
+  const auto cwnd = cc.cwnd();
+  const auto ssthresh = cc.ssthresh();
+
+  // Two reductions in one episode, then every loss proves spurious.
+  cc.on_fast_retransmit_loss();
+  cc.on_timeout_loss();
+  ASSERT_LT(cc.cwnd(), cwnd);
+  cc.on_spurious_loss();
+  EXPECT_EQ(cc.cwnd(), cwnd);
+  EXPECT_EQ(cc.ssthresh(), ssthresh);
+  EXPECT_EQ(cc.state(), CongestionState::kSlowStart);
+  EXPECT_EQ(cc.stats().loss_undos, 1U);
+
+  // Nothing left to undo.
+  cc.on_spurious_loss();
+  EXPECT_EQ(cc.stats().loss_undos, 1U);
+}
+
+TEST_F(CongestionControllerTest, ConfirmedOrEcnReductionIsNotUndone) {
+  CongestionController cc(config_, [this]() { return now_; });
+  cc.on_fast_retransmit_loss();
+  cc.on_loss_confirmed();
+  const auto confirmed = cc.cwnd();
+  cc.on_spurious_loss();
+  EXPECT_EQ(cc.cwnd(), confirmed);
+
+  cc.on_recovery_complete();
+  cc.on_fast_retransmit_loss();
+  cc.on_ecn_ce();
+  const auto marked = cc.cwnd();
+  cc.on_spurious_loss();
+  EXPECT_EQ(cc.cwnd(), marked);
+  EXPECT_EQ(cc.stats().loss_undos, 0U);
+}
+
+// ========== Algorithm Selection ==========
+
+TEST_F(CongestionControllerTest, FactorySelectsAlgorithm) {
+  auto now_fn = [this]() { return now_; };
+  for (auto algorithm : {CongestionAlgorithm::kReno, CongestionAlgorithm::kCubic,
+                         CongestionAlgorithm::kBbr}) {
+    auto cc = make_congestion_control(algorithm, config_, now_fn);
+    ASSERT_NE(cc, nullptr);
+    EXPECT_EQ(cc->algorithm(), algorithm);
+    EXPECT_EQ(cc->cwnd(), config_.initial_cwnd);
+    EXPECT_EQ(cc->state(), CongestionState::kSlowStart);
+  }
+}
+
 }  // namespace veil::mux::tests
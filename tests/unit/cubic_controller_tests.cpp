@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+#include "transport/mux/cubic_controller.h"
+
+namespace veil::mux::tests {
+
+using namespace std::chrono_literals;
+
+class CubicControllerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    now_ = std::chrono::steady_clock::now();
+    config_.initial_cwnd = static_cast<std::size_t>(100) * 1400;
+    config_.initial_ssthresh = static_cast<std::size_t>(50) * 1400;  // Start in avoidance
+    config_.mss = 1400;
+    config_.enable_pacing = false;
+  }
+
+  // ACK one window's worth of data, one MSS at a time.
+  void ack_window(CongestionControl& cc) {
+    const std::size_t segments = cc.cwnd() / config_.mss;
+    for (std::size_t i = 0; i < segments; ++i) {
+      cc.on_ack(config_.mss);
+    }
+  }
+
+  std::chrono::steady_clock::time_point now_;
+  CongestionConfig config_;
+};
+
+TEST_F(CubicControllerTest, LossReducesWindowByBeta) {
+  CubicController cc(config_, [this]() { return now_; });
+  const auto before = cc.cwnd();
+
+  cc.on_fast_retransmit_loss();
+  EXPECT_EQ(cc.ssthresh(), static_cast<std::size_t>(static_cast<double>(before) * 0.7));
+  EXPECT_DOUBLE_EQ(cc.w_max(), static_cast<double>(before));
+  EXPECT_EQ(cc.state(), CongestionState::kFastRecovery);
+
+  cc.on_recovery_complete();
+  EXPECT_EQ(cc.cwnd(), cc.ssthresh());
+  EXPECT_EQ(cc.state(), CongestionState::kCongestionAvoidance);
+}
+
+TEST_F(CubicControllerTest, FastConvergenceLowersWmaxOnRepeatedLoss) {
+  CubicController cc(config_, [this]() { return now_; });
+  cc.on_ecn_ce();
+  const auto reduced = static_cast<double>(cc.cwnd());
+  // Lost again below the previous maximum: release bandwidth to competing flows.
+  cc.on_ecn_ce();
+  EXPECT_DOUBLE_EQ(cc.w_max(), reduced * (1.0 + CubicController::kBeta) / 2.0);
+}
+
+TEST_F(CubicControllerTest, RegrowsToPreviousMaximumInTimeK) {
+  CubicController cc(config_, [this]() { return now_; });
+  cc.set_srtt(100ms);
+  const auto w_max = cc.cwnd();
+  cc.on_ecn_ce();
+
+  // K = cbrt(W_max * (1 - beta) / C) seconds, with W_max in segments: ~4.2 s here.
+  const double k = std::cbrt(100.0 * (1.0 - CubicController::kBeta) / CubicController::kC);
+  const auto rtts = static_cast<int>(k * 10);
+  for (int i = 0; i < rtts - 5; ++i) {
+    now_ += 100ms;
+    ack_window(cc);
+  }
+  EXPECT_LT(cc.cwnd(), w_max);
+  EXPECT_GT(cc.cwnd(), static_cast<std::size_t>(static_cast<double>(w_max) * 0.9));
+
+  // Plateau around W_max, then probe beyond it.
+  for (int i = 0; i < 30; ++i) {
+    now_ += 100ms;
+    ack_window(cc);
+  }
+  EXPECT_GT(cc.cwnd(), w_max);
+}
+
+TEST_F(CubicControllerTest, GrowsFasterThanRenoOnLongRtt) {
+  auto now_fn = [this]() { return now_; };
+  CongestionController reno(config_, now_fn);
+  CubicController cubic(config_, now_fn);
+  reno.set_srtt(300ms);
+  cubic.set_srtt(300ms);
+  reno.on_ecn_ce();
+  cubic.on_ecn_ce();
+  const auto reno_start = reno.cwnd();
+  const auto cubic_start = cubic.cwnd();
+
+  // 20 round trips of 300 ms after the same congestion event: Reno gains 1 MSS per RTT,
+  // CUBIC's growth depends on elapsed time only.
+  for (int i = 0; i < 20; ++i) {
+    now_ += 300ms;
+    ack_window(reno);
+    ack_window(cubic);
+  }
+  EXPECT_GT(cubic.cwnd() - cubic_start, reno.cwnd() - reno_start);
+}
+
+TEST_F(CubicControllerTest, SpuriousLossRestoresWmax) {
+  CubicController cc(config_, [this]() { return now_; });
+  cc.on_fast_retransmit_loss();
+  cc.on_loss_confirmed();  // The first loss was real.
+  const auto w_max = cc.w_max();
+  cc.on_recovery_complete();
+  const auto cwnd = cc.cwnd();
+
+  cc.on_fast_retransmit_loss();
+  EXPECT_LT(cc.w_max(), w_max);
+  cc.on_spurious_loss();
+  EXPECT_DOUBLE_EQ(cc.w_max(), w_max);
+  EXPECT_GE(cc.cwnd(), cwnd);
+}
+
+}  // namespace veil::mux::tests
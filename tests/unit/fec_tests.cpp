@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "transport/mux/fec.h"
+
+namespace veil::tests {
+
+using namespace std::chrono_literals;
+
+namespace {
+
+std::vector<std::uint8_t> packet_of(std::uint64_t sequence) {
+  // Varying sizes exercise the length recovery.
+  return std::vector<std::uint8_t>(20 + sequence % 7, static_cast<std::uint8_t>(sequence * 31));
+}
+
+}  // namespace
+
+TEST(FecTests, RepairRebuildsOneLostPacket) {
+  mux::FecConfig config;
+  config.initial_group_size = 4;
+  mux::FecEncoder encoder(config);
+  mux::FecDecoder decoder(config);
+
+  std::optional<mux::FecRepairFrame> repair;
+  for (std::uint64_t seq = 10; seq < 14; ++seq) {
+    repair = encoder.protect(seq, packet_of(seq));
+    if (seq != 12) {
+      EXPECT_TRUE(decoder.on_packet(seq, packet_of(seq)).empty());
+    }
+  }
+  ASSERT_TRUE(repair.has_value());
+  EXPECT_EQ(repair->first_sequence, 10U);
+  EXPECT_EQ(repair->mask, 0b1111U);
+
+  auto recovered = decoder.on_repair(*repair);
+  ASSERT_EQ(recovered.size(), 1U);
+  EXPECT_EQ(recovered[0].sequence, 12U);
+  EXPECT_EQ(recovered[0].plaintext, packet_of(12));
+  EXPECT_EQ(decoder.stats().packets_recovered, 1U);
+}
+
+TEST(FecTests, RepairWaitsForLatePacket) {
+  mux::FecConfig config;
+  config.initial_group_size = 4;
+  mux::FecEncoder encoder(config);
+  mux::FecDecoder decoder(config);
+
+  std::optional<mux::FecRepairFrame> repair;
+  for (std::uint64_t seq = 0; seq < 4; ++seq) {
+    repair = encoder.protect(seq, packet_of(seq));
+  }
+  ASSERT_TRUE(repair.has_value());
+
+  // Two packets missing: the repair is held until one of them arrives.
+  decoder.on_packet(0, packet_of(0));
+  decoder.on_packet(3, packet_of(3));
+  EXPECT_TRUE(decoder.on_repair(*repair).empty());
+  auto recovered = decoder.on_packet(1, packet_of(1));
+  ASSERT_EQ(recovered.size(), 1U);
+  EXPECT_EQ(recovered[0].sequence, 2U);
+  EXPECT_EQ(recovered[0].plaintext, packet_of(2));
+}
+
+TEST(FecTests, GroupClosedByDelayAndSpan) {
+  auto now = std::chrono::steady_clock::now();
+  mux::FecConfig config;
+  config.initial_group_size = 8;
+  mux::FecEncoder encoder(config, [&now]() { return now; });
+
+  encoder.protect(1, packet_of(1));
+  EXPECT_FALSE(encoder.poll().has_value());
+  now += config.max_group_delay;
+  auto repair = encoder.poll();
+  ASSERT_TRUE(repair.has_value());
+  EXPECT_EQ(repair->mask, 1U);
+
+  // A packet beyond the 64 sequences a mask covers closes the group without it.
+  encoder.protect(100, packet_of(100));
+  repair = encoder.protect(164, packet_of(164));
+  ASSERT_TRUE(repair.has_value());
+  EXPECT_EQ(repair->first_sequence, 100U);
+  EXPECT_EQ(repair->mask, 1U);
+  EXPECT_EQ(encoder.stats().repairs_sent, 2U);
+}
+
+TEST(FecTests, GroupSizeFollowsMeasuredLoss) {
+  mux::FecConfig config;
+  mux::FecDecoder decoder(config);
+  EXPECT_EQ(decoder.group_size(), config.initial_group_size);
+
+  // A clean path: the largest groups.
+  std::uint64_t seq = 0;
+  auto run = [&](std::uint64_t loss_every, int groups) {
+    for (int g = 0; g < groups; ++g) {
+      mux::FecRepairFrame repair;
+      repair.first_sequence = seq;
+      repair.mask = 0xFFFF;
+      for (int i = 0; i < 16; ++i, ++seq) {
+        if (loss_every == 0 || seq % loss_every != 0) {
+          decoder.on_packet(seq, packet_of(seq));
+        }
+      }
+      decoder.on_repair(repair);
+    }
+  };
+  run(0, 64);
+  EXPECT_EQ(decoder.group_size(), config.max_group_size);
+
+  // 5% loss: small groups.
+  run(20, 256);
+  EXPECT_NEAR(decoder.loss_rate(), 0.05, 0.01);
+  EXPECT_EQ(decoder.group_size(), config.min_group_size);
+}
+
+TEST(FecTests, EncoderGroupSizeStaysWithinBounds) {
+  mux::FecConfig config;
+  mux::FecEncoder encoder(config);
+  encoder.set_group_size(1);
+  EXPECT_EQ(encoder.group_size(), config.min_group_size);
+  encoder.set_group_size(200);
+  EXPECT_EQ(encoder.group_size(), config.max_group_size);
+}
+
+}  // namespace veil::tests
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+
+#include "transport/mux/flow_control.h"
+
+namespace veil::tests {
+
+using namespace std::chrono_literals;
+
+TEST(FlowControlTests, CreditFrameRoundTrip) {
+  const mux::FlowCredit credit{mux::FlowCreditKind::kBlocked, mux::kSessionCreditId,
+                               0x0102030405060708ULL};
+  const auto frame = mux::make_flow_credit_frame(credit);
+  ASSERT_EQ(frame.kind, mux::FrameKind::kControl);
+  EXPECT_EQ(frame.control.type, mux::kControlFlowCredit);
+
+  auto parsed = mux::parse_flow_credit(frame.control);
+  ASSERT_TRUE(parsed.has_value());
+  EXPECT_EQ(parsed->kind, credit.kind);
+  EXPECT_EQ(parsed->stream_id, credit.stream_id);
+  EXPECT_EQ(parsed->offset, credit.offset);
+
+  auto truncated = frame.control;
+  truncated.payload.pop_back();
+  EXPECT_FALSE(mux::parse_flow_credit(truncated).has_value());
+}
+
+TEST(FlowControlTests, UpdateDueAfterHalfWindowConsumed) {
+  const auto start = std::chrono::steady_clock::now();
+  mux::ReceiveWindow window(1000, 1000);
+
+  // The first call grants the initial window.
+  EXPECT_EQ(window.take_update(start, 10ms), 1000U);
+  EXPECT_FALSE(window.take_update(start, 10ms).has_value());
+
+  EXPECT_TRUE(window.on_received(600));
+  window.on_consumed(400);
+  EXPECT_FALSE(window.take_update(start + 1s, 10ms).has_value());
+  window.on_consumed(200);
+  EXPECT_EQ(window.take_update(start + 1s, 10ms), 1600U);
+
+  // Past the limit: the peer ignored its credit.
+  EXPECT_FALSE(window.on_received(1100));
+}
+
+TEST(FlowControlTests, WindowGrowsOnlyWhileDrainedWithinTwoRoundTrips) {
+  auto now = std::chrono::steady_clock::now();
+  mux::ReceiveWindow window(1000, 8000);
+  window.take_update(now, 100ms);
+
+  // Half a window per round trip: the window limits the sender, so it doubles each
+  // update, up to the maximum.
+  for (int i = 0; i < 5; ++i) {
+    now += 100ms;
+    window.on_received(window.window() / 2);
+    window.on_consumed(window.window() / 2);
+    ASSERT_TRUE(window.take_update(now, 100ms).has_value());
+  }
+  EXPECT_EQ(window.window(), 8000U);
+
+  // A slow drain leaves a small window small.
+  mux::ReceiveWindow slow(1000, 8000);
+  slow.take_update(now, 100ms);
+  now += 500ms;
+  slow.on_received(500);
+  slow.on_consumed(500);
+  EXPECT_EQ(slow.take_update(now, 100ms), 1500U);
+  EXPECT_EQ(slow.window(), 1000U);
+}
+
+TEST(FlowControlTests, BlockedReportResendsLostLimit) {
+  const auto now = std::chrono::steady_clock::now();
+  mux::ReceiveWindow window(1000, 1000);
+  window.take_update(now, 10ms);
+  window.on_received(500);
+  window.on_consumed(500);
+  EXPECT_EQ(window.take_update(now + 1s, 10ms), 1500U);
+
+  // The peer is blocked at the first limit: the update was lost, send it again.
+  window.on_peer_blocked(1000);
+  EXPECT_EQ(window.take_update(now + 1s, 10ms), 1500U);
+  // Blocked at the current limit: nothing more to grant yet.
+  window.on_peer_blocked(1500);
+  EXPECT_FALSE(window.take_update(now + 1s, 10ms).has_value());
+}
+
+TEST(FlowControlTests, SendWindowBlocksAtLimit) {
+  const auto now = std::chrono::steady_clock::now();
+  mux::SendWindow window;
+
+  // Unlimited until the peer advertises.
+  EXPECT_TRUE(window.can_send(1 << 30));
+  window.on_limit(1000);
+  window.on_sent(800);
+  EXPECT_TRUE(window.can_send(200));
+  EXPECT_FALSE(window.can_send(201));
+
+  window.set_blocked();
+  EXPECT_EQ(window.take_blocked_report(now, 100ms), 800U);
+  EXPECT_FALSE(window.take_blocked_report(now + 50ms, 100ms).has_value());
+  EXPECT_EQ(window.take_blocked_report(now + 100ms, 100ms), 800U);
+
+  // A reordered, lower limit is ignored; a higher one unblocks.
+  window.on_limit(900);
+  EXPECT_TRUE(window.blocked());
+  window.on_limit(2000);
+  EXPECT_FALSE(window.blocked());
+  EXPECT_FALSE(window.take_blocked_report(now + 1s, 100ms).has_value());
+
+  // Credit of abandoned payload comes back.
+  window.on_abandoned(300);
+  EXPECT_EQ(window.sent(), 500U);
+}
+
+}  // namespace veil::tests
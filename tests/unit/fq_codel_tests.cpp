@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "transport/mux/fq_codel.h"
+
+namespace veil::tests {
+
+namespace {
+
+using namespace std::chrono_literals;
+using TimePoint = mux::FqCodelQueue::TimePoint;
+
+// IPv4 header of the given size, ECN field and tag byte, with a valid checksum.
+std::vector<std::uint8_t> ipv4(std::size_t size, std::uint8_t ecn, std::uint8_t tag) {
+  std::vector<std::uint8_t> packet(size, 0);
+  packet[0] = 0x45;
+  packet[1] = ecn;
+  packet[2] = static_cast<std::uint8_t>(size >> 8);
+  packet[3] = static_cast<std::uint8_t>(size);
+  packet[8] = 64;
+  packet[9] = 17;
+  packet[12] = 10;
+  packet[15] = 2;
+  packet[16] = 10;
+  packet[19] = 1;
+  packet[20] = tag;
+  std::uint32_t sum = 0;
+  for (std::size_t i = 0; i < 20; i += 2) {
+    sum += static_cast<std::uint32_t>((packet[i] << 8) | packet[i + 1]);
+  }
+  sum = (sum & 0xFFFFU) + (sum >> 16);
+  sum = (sum & 0xFFFFU) + (sum >> 16);
+  packet[10] = static_cast<std::uint8_t>(~sum >> 8);
+  packet[11] = static_cast<std::uint8_t>(~sum);
+  return packet;
+}
+
+bool checksum_valid(const std::vector<std::uint8_t>& packet) {
+  std::uint32_t sum = 0;
+  for (std::size_t i = 0; i < 20; i += 2) {
+    sum += static_cast<std::uint32_t>((packet[i] << 8) | packet[i + 1]);
+  }
+  sum = (sum & 0xFFFFU) + (sum >> 16);
+  sum = (sum & 0xFFFFU) + (sum >> 16);
+  return sum == 0xFFFFU;
+}
+
+}  // namespace
+
+TEST(FqCodelTests, SparseFlowGoesAheadOfBulkFlow) {
+  mux::FqCodelQueue queue;
+  const TimePoint now = TimePoint{} + 1s;
+  for (int i = 0; i < 50; ++i) {
+    queue.enqueue(1, ipv4(1400, 0, 1), now);
+  }
+  ASSERT_TRUE(queue.dequeue(now).has_value());
+  queue.enqueue(2, ipv4(84, 0, 2), now);
+
+  // The ping is a new flow: it goes next, or after the one packet that used up the bulk
+  // flow's quantum.
+  int before = 0;
+  for (;;) {
+    const auto packet = queue.dequeue(now);
+    ASSERT_TRUE(packet.has_value());
+    if ((*packet)[20] == 2) {
+      break;
+    }
+    ++before;
+  }
+  EXPECT_LE(before, 1);
+}
+
+TEST(FqCodelTests, StandingQueueIsDroppedBackToTarget) {
+  mux::FqCodelQueue queue(mux::FqCodelConfig{.ecn = false});
+  TimePoint now = TimePoint{} + 1s;
+  // A link of one packet per ms, and a sender that starts at twice that, speeds up a
+  // little every 0.1 ms and halves its rate on each drop, as TCP would.
+  double rate = 2.0;
+  double credit = 0;
+  std::uint64_t drops = 0;
+  std::size_t sent = 0;
+  std::size_t longest = 0;
+  for (int tick = 0; tick < 10000; ++tick) {
+    for (credit += rate / 10; credit >= 1; credit -= 1) {
+      queue.enqueue(1, ipv4(1400, 0, 1), now);
+    }
+    now += 100us;
+    if (tick % 10 == 9 && queue.dequeue(now)) {
+      ++sent;
+    }
+    if (queue.stats().codel_drops != drops) {
+      drops = queue.stats().codel_drops;
+      rate /= 2;
+    } else {
+      rate += 0.0002;
+    }
+    if (tick >= 5000) {
+      longest = std::max(longest, queue.queued_packets());
+    }
+  }
+  EXPECT_GT(drops, 0U);
+  EXPECT_EQ(queue.stats().ecn_marks, 0U);
+  // Once settled the queue holds tens of ms, not the seconds the sender would build
+  // up without drops, and the link stays mostly busy.
+  EXPECT_LT(longest, 30U);
+  EXPECT_GT(sent, 750U);
+}
+
+TEST(FqCodelTests, EcnCapablePacketsAreMarkedNotDropped) {
+  mux::FqCodelQueue queue;
+  TimePoint now = TimePoint{} + 1s;
+  for (int i = 0; i < 200; ++i) {
+    queue.enqueue(1, ipv4(1400, 0x02, 1), now);
+  }
+  // Served slowly: every packet waits well over target.
+  std::size_t marked = 0;
+  std::size_t sent = 0;
+  while (!queue.empty()) {
+    now += 2ms;
+    const auto packet = queue.dequeue(now);
+    ASSERT_TRUE(packet.has_value());
+    ++sent;
+    if (((*packet)[1] & 0x03) == 0x03) {
+      ++marked;
+      EXPECT_TRUE(checksum_valid(*packet));
+    }
+  }
+  EXPECT_EQ(sent, 200U);
+  EXPECT_GT(marked, 0U);
+  EXPECT_EQ(queue.stats().ecn_marks, marked);
+  EXPECT_EQ(queue.stats().codel_drops, 0U);
+}
+
+TEST(FqCodelTests, MarkEcnCeLeavesNotEctPacketsAlone) {
+  auto not_ect = ipv4(100, 0, 1);
+  EXPECT_FALSE(mux::mark_ecn_ce(not_ect));
+  EXPECT_EQ(not_ect[1], 0);
+
+  auto ect = ipv4(100, 0x01, 1);
+  EXPECT_TRUE(mux::mark_ecn_ce(ect));
+  EXPECT_EQ(ect[1] & 0x03, 0x03);
+  EXPECT_TRUE(checksum_valid(ect));
+
+  std::vector<std::uint8_t> v6(60, 0);
+  v6[0] = 0x60;
+  v6[1] = 0x20;
+  EXPECT_TRUE(mux::mark_ecn_ce(v6));
+  EXPECT_EQ(v6[1], 0x30);
+}
+
+TEST(FqCodelTests, OverlimitDropsFromLargestFlow) {
+  mux::FqCodelQueue queue;
+  const TimePoint now = TimePoint{} + 1s;
+  for (int i = 0; i < 10; ++i) {
+    queue.enqueue(1, ipv4(1400, 0, 1), now);
+  }
+  queue.enqueue(2, ipv4(84, 0, 2), now);
+  queue.drop_from_largest_flow();
+  queue.drop_from_largest_flow();
+  EXPECT_EQ(queue.queued_packets(), 9U);
+  EXPECT_EQ(queue.queued_bytes(), 8U * 1400 + 84);
+  EXPECT_EQ(queue.stats().overlimit_drops, 2U);
+}
+
+}  // namespace veil::tests
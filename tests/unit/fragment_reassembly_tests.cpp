@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <cstdint>
+#include <utility>
 #include <vector>
 
 #include "transport/mux/fragment_reassembly.h"
@@ -29,4 +32,22 @@ TEST(FragmentReassemblyTests, RespectsLimit) {
   EXPECT_FALSE(r.push(1, mux::Fragment{1, {2, 3}, true}));
 }
 
+TEST(FragmentReassemblyTests, CleanupReportsExpiredBytesPerStream) {
+  using namespace std::chrono_literals;
+  const auto start = mux::FragmentReassembly::TimePoint{} + 10s;
+  mux::FragmentReassembly r(1 << 20, 100ms);
+  EXPECT_TRUE(r.push(1, mux::Fragment{0, {1, 2, 3}, false, 7}, start));
+  EXPECT_TRUE(r.push(1, mux::Fragment{3, {4}, false, 7}, start));
+  EXPECT_TRUE(r.push(2, mux::Fragment{0, {5}, false, 9}, start + 50ms));
+
+  std::vector<std::pair<std::uint64_t, std::size_t>> expired;
+  const auto record = [&expired](std::uint64_t stream_id, std::size_t bytes) {
+    expired.emplace_back(stream_id, bytes);
+  };
+  EXPECT_EQ(r.cleanup_expired(start + 120ms, record), 1U);
+  ASSERT_EQ(expired.size(), 1U);
+  EXPECT_EQ(expired[0], (std::pair<std::uint64_t, std::size_t>{7, 4}));
+  EXPECT_EQ(r.pending_count(), 1U);
+}
+
 }  // namespace veil::tests
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "transport/mux/frame_packer.h"
+#include "transport/mux/mux_codec.h"
+
+namespace veil::mux::tests {
+
+using namespace std::chrono_literals;
+
+class FramePackerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    now_ = std::chrono::steady_clock::now();
+    config_.max_batch_size = 100;
+    config_.max_delay = 1000us;
+  }
+
+  static MuxFrame datagram(std::size_t payload_size) {
+    return make_datagram_frame(std::vector<std::uint8_t>(payload_size, 0x45));
+  }
+
+  std::chrono::steady_clock::time_point now_;
+  FramePackerConfig config_;
+};
+
+TEST_F(FramePackerTest, QueuesFramesThatFit) {
+  FramePacker packer(config_, [this]() { return now_; });
+
+  EXPECT_TRUE(packer.add(datagram(20)).empty());
+  EXPECT_TRUE(packer.add(make_ack_frame(0, 5, 0)).empty());
+  EXPECT_EQ(packer.pending_frames(), 2U);
+  EXPECT_EQ(packer.pending_bytes(), 23U + MuxCodec::kAckSize);
+
+  auto batch = packer.flush();
+  ASSERT_EQ(batch.size(), 2U);
+  EXPECT_EQ(batch[0].kind, FrameKind::kDatagram);
+  EXPECT_EQ(batch[1].kind, FrameKind::kAck);
+  EXPECT_TRUE(packer.empty());
+  EXPECT_TRUE(packer.flush().empty());
+}
+
+TEST_F(FramePackerTest, ReturnsFullBatchWhenNextFrameDoesNotFit) {
+  FramePacker packer(config_, [this]() { return now_; });
+
+  EXPECT_TRUE(packer.add(datagram(40)).empty());  // 43 bytes
+  EXPECT_TRUE(packer.add(datagram(40)).empty());  // 86 bytes
+  auto full = packer.add(datagram(40));           // would be 129 > 100
+  ASSERT_EQ(full.size(), 2U);
+  EXPECT_EQ(packer.pending_frames(), 1U);
+  EXPECT_EQ(packer.stats().batches_full, 1U);
+
+  // Every batch fits the budget when encoded.
+  EXPECT_LE(MuxCodec::encode_all(full).size(), config_.max_batch_size);
+}
+
+TEST_F(FramePackerTest, OversizedFrameReturnedAlone) {
+  FramePacker packer(config_, [this]() { return now_; });
+
+  EXPECT_TRUE(packer.add(datagram(10)).empty());
+  auto single = packer.add(datagram(200));
+  ASSERT_EQ(single.size(), 1U);
+  EXPECT_EQ(single[0].datagram.payload.size(), 200U);
+  // The small frame is still queued.
+  EXPECT_EQ(packer.pending_frames(), 1U);
+}
+
+TEST_F(FramePackerTest, FlushDueAfterMaxDelay) {
+  FramePacker packer(config_, [this]() { return now_; });
+
+  EXPECT_FALSE(packer.flush_due());
+  EXPECT_FALSE(packer.time_until_flush().has_value());
+
+  packer.add(datagram(10));
+  EXPECT_FALSE(packer.flush_due());
+  ASSERT_TRUE(packer.time_until_flush().has_value());
+  EXPECT_EQ(*packer.time_until_flush(), 1000us);
+
+  now_ += 400us;
+  packer.add(datagram(10));  // Does not restart the clock.
+  EXPECT_EQ(*packer.time_until_flush(), 600us);
+
+  now_ += 600us;
+  EXPECT_TRUE(packer.flush_due());
+  EXPECT_EQ(*packer.time_until_flush(), 0us);
+
+  EXPECT_EQ(packer.flush().size(), 2U);
+  EXPECT_FALSE(packer.flush_due());
+}
+
+}  // namespace veil::mux::tests
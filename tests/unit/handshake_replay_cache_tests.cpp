@@ -66,62 +66,51 @@ TEST_F(HandshakeReplayCacheTest, AllowsDifferentTimestamps) {
   EXPECT_TRUE(cache.mark_and_check(3000, key));
 }
 
-TEST_F(HandshakeReplayCacheTest, EvictsLRUWhenAtCapacity) {
-  // Use longer time window to prevent auto-cleanup during test
-  HandshakeReplayCache cache(3, std::chrono::milliseconds(100000));  // Small capacity
-  const auto key1 = make_key(0x01);
-  const auto key2 = make_key(0x02);
-  const auto key3 = make_key(0x03);
-  const auto key4 = make_key(0x04);
-
-  // Fill cache to capacity
-  EXPECT_FALSE(cache.mark_and_check(1000, key1));
-  EXPECT_FALSE(cache.mark_and_check(2000, key2));
-  EXPECT_FALSE(cache.mark_and_check(3000, key3));
-  EXPECT_EQ(cache.size(), 3);
-
-  // Add fourth entry - should evict key1 (least recently used)
-  EXPECT_FALSE(cache.mark_and_check(4000, key4));
-  EXPECT_EQ(cache.size(), 3);
+TEST_F(HandshakeReplayCacheTest, RetainsCapacityEntriesPerBucket) {
+  // Use longer time window so all entries share one time bucket
+  HandshakeReplayCache cache(64, std::chrono::milliseconds(100000));
 
-  // Others should still be there (check these BEFORE key1 to avoid cache modification)
-  EXPECT_TRUE(cache.mark_and_check(2000, key2));
-  EXPECT_TRUE(cache.mark_and_check(3000, key3));
-  EXPECT_TRUE(cache.mark_and_check(4000, key4));
+  for (std::uint8_t i = 0; i < 64; ++i) {
+    EXPECT_FALSE(cache.mark_and_check(1000 + i, make_key(i)));
+  }
+  EXPECT_EQ(cache.size(), 64);
 
-  // key1 should have been evicted - will not detect as replay
-  EXPECT_FALSE(cache.mark_and_check(1000, key1));
+  // Every entry up to capacity is still detected
+  for (std::uint8_t i = 0; i < 64; ++i) {
+    EXPECT_TRUE(cache.mark_and_check(1000 + i, make_key(i)));
+  }
 }
 
-TEST_F(HandshakeReplayCacheTest, LRUOrderingUpdatedOnAccess) {
-  HandshakeReplayCache cache(3);
-  const auto key1 = make_key(0x01);
-  const auto key2 = make_key(0x02);
-  const auto key3 = make_key(0x03);
-  const auto key4 = make_key(0x04);
-
-  // Fill cache: key1, key2, key3 (key1 is LRU)
-  EXPECT_FALSE(cache.mark_and_check(1000, key1));
-  EXPECT_FALSE(cache.mark_and_check(2000, key2));
-  EXPECT_FALSE(cache.mark_and_check(3000, key3));
+TEST_F(HandshakeReplayCacheTest, OverflowIsBoundedAndDoesNotFail) {
+  HandshakeReplayCache cache(3, std::chrono::milliseconds(100000));  // Small capacity
 
-  // Access key1 (moves it to MRU)
-  EXPECT_TRUE(cache.mark_and_check(1000, key1));
+  // Far more distinct INITs than capacity in one bucket: all are accepted as new,
+  // memory stays fixed, and the most recent entry is still detected.
+  for (std::uint64_t i = 0; i < 1000; ++i) {
+    EXPECT_FALSE(cache.mark_and_check(1000 + i, make_key(static_cast<std::uint8_t>(i))));
+  }
+  EXPECT_LE(cache.size(), 8);  // 2 * bit_ceil(capacity) slots in the bucket
+  EXPECT_TRUE(cache.mark_and_check(1999, make_key(static_cast<std::uint8_t>(999))));
+}
 
-  // Add key4 - should evict key2 (now LRU), not key1
-  EXPECT_FALSE(cache.mark_and_check(4000, key4));
+TEST_F(HandshakeReplayCacheTest, OldBucketsRotateOut) {
+  const auto time_window = std::chrono::milliseconds(3000);  // 1000ms buckets
+  HandshakeReplayCache cache(1, time_window);                 // 2 slots per bucket
 
-  // key1, key3, key4 should still be in cache
-  EXPECT_TRUE(cache.mark_and_check(1000, key1));
-  EXPECT_TRUE(cache.mark_and_check(3000, key3));
-  EXPECT_TRUE(cache.mark_and_check(4000, key4));
+  // Fill the bucket for epoch 10
+  EXPECT_FALSE(cache.mark_and_check(10000, make_key(0x01)));
+  EXPECT_FALSE(cache.mark_and_check(10000, make_key(0x02)));
 
-  // key2 should have been evicted
-  EXPECT_FALSE(cache.mark_and_check(2000, key2));
+  // Epoch 14 maps to the same bucket: the expired slots are reused, nothing live is evicted
+  EXPECT_FALSE(cache.mark_and_check(14000, make_key(0x03)));
+  EXPECT_FALSE(cache.mark_and_check(14000, make_key(0x04)));
+  EXPECT_TRUE(cache.mark_and_check(14000, make_key(0x03)));
+  EXPECT_TRUE(cache.mark_and_check(14000, make_key(0x04)));
+  EXPECT_EQ(cache.size(), 2);
 }
 
 TEST_F(HandshakeReplayCacheTest, CleansUpExpiredEntries) {
-  const auto time_window = std::chrono::milliseconds(1000);
+  const auto time_window = std::chrono::milliseconds(1000);  // 333ms buckets
   HandshakeReplayCache cache(100, time_window);
   const auto key1 = make_key(0x01);
   const auto key2 = make_key(0x02);
@@ -133,13 +122,10 @@ TEST_F(HandshakeReplayCacheTest, CleansUpExpiredEntries) {
   EXPECT_FALSE(cache.mark_and_check(2000, key3));
   EXPECT_EQ(cache.size(), 3);
 
-  // Cleanup with current_time = 3100
-  // Cutoff = 3100 - 1000 = 2100
-  // key1 (1000 < 2100): remove
-  // key2 (1500 < 2100): remove
-  // key3 (2000 < 2100): remove (2000 is also < 2100!)
-  // All entries should be removed
-  const auto removed = cache.cleanup_expired(3100);
+  // Cleanup with current_time = 3500
+  // Cutoff = 3500 - 1000 = 2500, in bucket epoch 7
+  // key1 (epoch 3), key2 (epoch 4), key3 (epoch 6) are all in older buckets
+  const auto removed = cache.cleanup_expired(3500);
   EXPECT_EQ(removed, 3);
   EXPECT_EQ(cache.size(), 0);
 
@@ -149,6 +135,52 @@ TEST_F(HandshakeReplayCacheTest, CleansUpExpiredEntries) {
   EXPECT_FALSE(cache.mark_and_check(2000, key3));
 }
 
+TEST_F(HandshakeReplayCacheTest, CleanupKeepsEntriesInsideWindow) {
+  HandshakeReplayCache cache(100, std::chrono::milliseconds(1000));
+  const auto key = make_key(0x01);
+
+  EXPECT_FALSE(cache.mark_and_check(2000, key));
+  EXPECT_EQ(cache.cleanup_expired(2900), 0);
+  EXPECT_TRUE(cache.mark_and_check(2000, key));
+}
+
+TEST_F(HandshakeReplayCacheTest, HashesWholeEphemeralKey) {
+  HandshakeReplayCache cache(100);
+  auto key1 = make_key(0x42);
+  auto key2 = key1;
+  key2.back() ^= 0x01;  // Differs only in the last byte
+
+  EXPECT_FALSE(cache.mark_and_check(1000, key1));
+  EXPECT_FALSE(cache.mark_and_check(1000, key2));
+  EXPECT_TRUE(cache.mark_and_check(1000, key2));
+}
+
+TEST_F(HandshakeReplayCacheTest, ConcurrentDuplicateDetectedExactlyOnce) {
+  HandshakeReplayCache cache(4096);
+  constexpr int num_threads = 4;
+  constexpr int iterations = 500;
+
+  std::atomic<int> fresh{0};
+  std::vector<std::thread> threads;
+  threads.reserve(static_cast<std::size_t>(num_threads));
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&cache, &fresh]() {
+      // All threads race on the same keys: each key must be "new" exactly once.
+      for (int i = 0; i < iterations; ++i) {
+        auto key = make_key(static_cast<std::uint8_t>(i));
+        key[1] = static_cast<std::uint8_t>(i >> 8);
+        if (!cache.mark_and_check(5000, key)) {
+          fresh.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(fresh.load(), iterations);
+}
+
 TEST_F(HandshakeReplayCacheTest, ClearRemovesAllEntries) {
   HandshakeReplayCache cache(100);
   const auto key1 = make_key(0x01);
@@ -0,0 +1,261 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "transport/mux/header_compression.h"
+
+namespace veil::tests {
+
+namespace {
+
+struct TcpFields {
+  std::uint32_t sequence{1000};
+  std::uint32_t ack{5000};
+  std::uint16_t ip_id{1};
+  std::uint16_t window{65535};
+  std::uint8_t flags{0x10};  // ACK
+  std::uint16_t source_port{443};
+  std::vector<std::uint8_t> options;
+  std::size_t payload_size{100};
+};
+
+void put16(std::vector<std::uint8_t>& out, std::size_t at, std::uint32_t value) {
+  out[at] = static_cast<std::uint8_t>(value >> 8);
+  out[at + 1] = static_cast<std::uint8_t>(value);
+}
+
+void put32(std::vector<std::uint8_t>& out, std::size_t at, std::uint32_t value) {
+  put16(out, at, value >> 16);
+  put16(out, at + 2, value & 0xFFFF);
+}
+
+std::uint16_t checksum(const std::vector<std::uint8_t>& data, std::size_t from, std::uint32_t sum) {
+  for (std::size_t i = from; i < data.size(); i += 2) {
+    sum += static_cast<std::uint32_t>(data[i] << 8) | (i + 1 < data.size() ? data[i + 1] : 0U);
+  }
+  while ((sum >> 16) != 0) {
+    sum = (sum & 0xFFFF) + (sum >> 16);
+  }
+  return static_cast<std::uint16_t>(~sum);
+}
+
+// IPv4 10.0.0.2 -> 93.184.216.34 with valid IP and transport checksums.
+std::vector<std::uint8_t> ipv4_packet(std::uint8_t protocol, std::uint16_t ip_id,
+                                      std::vector<std::uint8_t> segment,
+                                      std::size_t checksum_offset) {
+  std::vector<std::uint8_t> packet(20);
+  packet[0] = 0x45;
+  put16(packet, 2, static_cast<std::uint32_t>(20 + segment.size()));
+  put16(packet, 4, ip_id);
+  put16(packet, 6, 0x4000);
+  packet[8] = 64;
+  packet[9] = protocol;
+  put32(packet, 12, 0x0A000002);
+  put32(packet, 16, 0x5DB8D822);
+  put16(packet, 10, checksum(std::vector<std::uint8_t>(packet.begin(), packet.begin() + 20), 0, 0));
+  packet.insert(packet.end(), segment.begin(), segment.end());
+
+  std::uint32_t pseudo = 0x0A00 + 0x0002 + 0x5DB8 + 0xD822 + protocol +
+                         static_cast<std::uint32_t>(segment.size());
+  put16(packet, 20 + checksum_offset, checksum(packet, 20, pseudo));
+  return packet;
+}
+
+std::vector<std::uint8_t> tcp_packet(const TcpFields& f) {
+  std::vector<std::uint8_t> segment(20 + f.options.size());
+  put16(segment, 0, f.source_port);
+  put16(segment, 2, 51000);
+  put32(segment, 4, f.sequence);
+  put32(segment, 8, f.ack);
+  segment[12] = static_cast<std::uint8_t>(((20 + f.options.size()) / 4) << 4);
+  segment[13] = f.flags;
+  put16(segment, 14, f.window);
+  std::copy(f.options.begin(), f.options.end(), segment.begin() + 20);
+  for (std::size_t i = 0; i < f.payload_size; ++i) {
+    segment.push_back(static_cast<std::uint8_t>(i * 7 + f.sequence));
+  }
+  return ipv4_packet(6, f.ip_id, std::move(segment), 16);
+}
+
+std::vector<std::uint8_t> udp_packet(std::uint16_t ip_id, std::size_t payload_size) {
+  std::vector<std::uint8_t> segment(8);
+  put16(segment, 0, 5004);
+  put16(segment, 2, 5004);
+  put16(segment, 4, static_cast<std::uint32_t>(8 + payload_size));
+  for (std::size_t i = 0; i < payload_size; ++i) {
+    segment.push_back(static_cast<std::uint8_t>(i + ip_id));
+  }
+  return ipv4_packet(17, ip_id, std::move(segment), 6);
+}
+
+// Compress and expand one packet; returns the compressed size (0 if lost on the way).
+std::size_t round_trip(mux::HeaderCompressor& compressor, mux::HeaderDecompressor& decompressor,
+                       const std::vector<std::uint8_t>& packet, bool lose = false) {
+  std::vector<std::uint8_t> wire;
+  EXPECT_TRUE(compressor.compress(packet, wire));
+  if (lose) {
+    return 0;
+  }
+  const auto size = wire.size();
+  EXPECT_TRUE(decompressor.decompress(wire));
+  EXPECT_EQ(wire, packet);
+  return size;
+}
+
+}  // namespace
+
+TEST(HeaderCompressionTests, TcpRoundTripSavesHeaderBytes) {
+  mux::HeaderCompressor compressor;
+  mux::HeaderDecompressor decompressor;
+  TcpFields fields;
+  fields.options = {1, 1, 8, 10, 0, 0, 0, 1, 0, 0, 0, 2};  // NOP NOP timestamps
+
+  for (int i = 0; i < 20; ++i) {
+    const auto packet = tcp_packet(fields);
+    const auto size = round_trip(compressor, decompressor, packet);
+    if (i < 2) {
+      EXPECT_EQ(size, packet.size() + 2);  // Refresh: full header plus type and context.
+    } else {
+      // 40 header bytes down to 12; options travel as they are.
+      EXPECT_EQ(size, packet.size() - 28);
+    }
+    fields.sequence += 1448;
+    fields.ack += 1;
+    ++fields.ip_id;
+  }
+  EXPECT_EQ(compressor.stats().refreshes, 2U);
+  EXPECT_EQ(compressor.stats().packets_compressed, 18U);
+  EXPECT_EQ(compressor.stats().bytes_saved, 18U * 28U);
+  EXPECT_EQ(decompressor.stats().packets_decompressed, 18U);
+
+  // A large jump or a new window travels in full.
+  fields.sequence += 1U << 20;
+  fields.window = 1024;
+  const auto packet = tcp_packet(fields);
+  EXPECT_EQ(round_trip(compressor, decompressor, packet), packet.size() - 28 + 2 + 2);
+}
+
+TEST(HeaderCompressionTests, UdpRoundTrip) {
+  mux::HeaderCompressor compressor;
+  mux::HeaderDecompressor decompressor;
+  for (std::uint16_t id = 100; id < 110; ++id) {
+    const auto packet = udp_packet(id, 172);  // G.711 RTP, 20 ms
+    const auto size = round_trip(compressor, decompressor, packet);
+    if (id >= 102) {
+      EXPECT_EQ(size, packet.size() - 22);  // 28 header bytes down to 6
+    }
+  }
+}
+
+TEST(HeaderCompressionTests, DecodesAfterLossWithinReferenceWindow) {
+  mux::HeaderCompressor compressor;
+  mux::HeaderDecompressor decompressor;
+  TcpFields fields;
+  for (int i = 0; i < 40; ++i) {
+    // Ten packets in a row lost, one of them changing the window.
+    const bool lose = i >= 10 && i < 20;
+    if (i == 15) {
+      fields.window = 30000;
+    }
+    round_trip(compressor, decompressor, tcp_packet(fields), lose);
+    fields.sequence += 1448;
+    ++fields.ip_id;
+  }
+  EXPECT_EQ(decompressor.stats().context_errors, 0U);
+}
+
+TEST(HeaderCompressionTests, DamagedContextDropsUntilRefresh) {
+  mux::HeaderCompressor compressor(mux::HeaderCompressionConfig{.refresh_interval = 40});
+  mux::HeaderDecompressor decompressor;
+  TcpFields fields;
+  fields.payload_size = 1448;
+
+  std::size_t delivered = 0;
+  std::size_t dropped = 0;
+  for (int i = 0; i < 80; ++i) {
+    const auto packet = tcp_packet(fields);
+    std::vector<std::uint8_t> wire;
+    ASSERT_TRUE(compressor.compress(packet, wire));
+    fields.sequence += 1448;
+    ++fields.ip_id;
+    // Packets 5-29 lost: past the reference window, and 36 KB of sequence space on.
+    if (i >= 5 && i < 30) {
+      continue;
+    }
+    if (decompressor.decompress(wire)) {
+      // Never a corrupted packet: either the original or nothing.
+      EXPECT_EQ(wire, packet);
+      ++delivered;
+    } else {
+      ++dropped;
+    }
+  }
+  // Packets 30-40 decode against a stale reference and fail the checksum; the periodic
+  // refresh (packet 41) resynchronizes the context.
+  EXPECT_EQ(dropped, 11U);
+  EXPECT_EQ(dropped, decompressor.stats().context_errors);
+  EXPECT_EQ(delivered, 5U + 39U);
+}
+
+TEST(HeaderCompressionTests, UnknownContextIsDropped) {
+  mux::HeaderCompressor compressor;
+  mux::HeaderDecompressor decompressor;
+  TcpFields fields;
+  std::vector<std::uint8_t> wire;
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(compressor.compress(tcp_packet(fields), wire));
+    ++fields.ip_id;
+  }
+  // The refreshes never arrived.
+  EXPECT_FALSE(decompressor.decompress(wire));
+  EXPECT_EQ(decompressor.stats().context_errors, 1U);
+}
+
+TEST(HeaderCompressionTests, PassesOtherPacketsThrough) {
+  mux::HeaderCompressor compressor;
+  mux::HeaderDecompressor decompressor;
+  std::vector<std::uint8_t> wire;
+
+  TcpFields syn;
+  syn.flags = 0x02;
+  EXPECT_FALSE(compressor.compress(tcp_packet(syn), wire));
+
+  auto fragment = udp_packet(1, 100);
+  fragment[6] |= 0x20;  // More fragments
+  EXPECT_FALSE(compressor.compress(fragment, wire));
+
+  std::vector<std::uint8_t> ipv6(60, 0);
+  ipv6[0] = 0x60;
+  EXPECT_FALSE(compressor.compress(ipv6, wire));
+  EXPECT_TRUE(wire.empty());
+
+  // Uncompressed packets come out of the decompressor unchanged.
+  auto copy = ipv6;
+  EXPECT_TRUE(decompressor.decompress(copy));
+  EXPECT_EQ(copy, ipv6);
+  copy = fragment;
+  EXPECT_TRUE(decompressor.decompress(copy));
+  EXPECT_EQ(copy, fragment);
+}
+
+TEST(HeaderCompressionTests, NewFlowTakesLeastRecentlyUsedContext) {
+  mux::HeaderCompressor compressor(mux::HeaderCompressionConfig{.max_contexts = 2});
+  mux::HeaderDecompressor decompressor;
+  std::vector<TcpFields> flows(3);
+  for (std::size_t f = 0; f < flows.size(); ++f) {
+    flows[f].source_port = static_cast<std::uint16_t>(1000 + f);
+  }
+  for (int round = 0; round < 6; ++round) {
+    for (auto& fields : flows) {
+      round_trip(compressor, decompressor, tcp_packet(fields));
+      fields.sequence += 100;
+      ++fields.ip_id;
+    }
+  }
+  // Three flows over two contexts: every packet refreshes, and all arrive intact.
+  EXPECT_EQ(compressor.stats().packets_compressed, 0U);
+  EXPECT_EQ(decompressor.stats().context_errors, 0U);
+}
+
+}  // namespace veil::tests
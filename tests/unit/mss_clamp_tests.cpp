@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "transport/mux/mss_clamp.h"
+
+namespace veil::tests {
+
+namespace {
+
+// Full TCP checksum over the IPv4 or IPv6 pseudo-header and the segment.
+std::uint16_t tcp_checksum(const std::vector<std::uint8_t>& packet) {
+  const bool ipv6 = (packet[0] >> 4) == 6;
+  const std::size_t tcp = ipv6 ? 40 : std::size_t{packet[0] & 0x0FU} * 4;
+  const std::size_t length = packet.size() - tcp;
+  std::uint32_t sum = 0;
+  const auto add = [&sum](std::size_t begin, std::size_t end, const std::vector<std::uint8_t>& data) {
+    for (std::size_t i = begin; i < end; i += 2) {
+      sum += static_cast<std::uint32_t>(data[i] << 8);
+      if (i + 1 < end) {
+        sum += data[i + 1];
+      }
+    }
+  };
+  if (ipv6) {
+    add(8, 40, packet);
+  } else {
+    add(12, 20, packet);
+  }
+  sum += 6 + static_cast<std::uint32_t>(length);
+  auto segment = packet;
+  segment[tcp + 16] = 0;
+  segment[tcp + 17] = 0;
+  add(tcp, packet.size(), segment);
+  while (sum >> 16) {
+    sum = (sum & 0xFFFFU) + (sum >> 16);
+  }
+  return static_cast<std::uint16_t>(~sum);
+}
+
+// A SYN with the given options, its checksum set.
+std::vector<std::uint8_t> syn(bool ipv6, std::vector<std::uint8_t> options,
+                              std::uint8_t flags = 0x02) {
+  const std::size_t ip = ipv6 ? 40 : 20;
+  std::vector<std::uint8_t> packet(ip + 20, 0);
+  if (ipv6) {
+    packet[0] = 0x60;
+    packet[6] = 6;
+    packet[23] = 1;
+    packet[39] = 2;
+  } else {
+    packet[0] = 0x45;
+    packet[9] = 6;
+    packet[12] = 10;
+    packet[15] = 1;
+    packet[16] = 10;
+    packet[19] = 2;
+  }
+  packet[ip + 1] = 0xC3;  // Ports, sequence: anything
+  packet[ip + 3] = 0x50;
+  packet[ip + 5] = 0x7A;
+  packet[ip + 12] = static_cast<std::uint8_t>((20 + options.size()) / 4 << 4);
+  packet[ip + 13] = flags;
+  packet.insert(packet.end(), options.begin(), options.end());
+  const auto checksum = tcp_checksum(packet);
+  packet[ip + 16] = static_cast<std::uint8_t>(checksum >> 8);
+  packet[ip + 17] = static_cast<std::uint8_t>(checksum);
+  return packet;
+}
+
+std::uint16_t mss_at(const std::vector<std::uint8_t>& packet, std::size_t offset) {
+  return static_cast<std::uint16_t>(packet[offset] << 8 | packet[offset + 1]);
+}
+
+}  // namespace
+
+TEST(MssClampTests, LowersMssToFitAndKeepsChecksumValid) {
+  // MSS 1460 (0x05B4), then window scale, SACK permitted and timestamps, as Linux sends.
+  const auto packet = syn(false, {2, 4, 0x05, 0xB4, 1, 3, 3, 7, 4, 2, 8, 10, 0, 0, 0, 1, 0, 0,
+                                  0, 0});
+  std::vector<std::uint8_t> out;
+  ASSERT_TRUE(mux::clamp_tcp_mss(packet, 1350, out));
+  EXPECT_EQ(mss_at(out, 42), 1350 - mux::kMssOverheadIpv4);
+  EXPECT_EQ(mss_at(out, 36), tcp_checksum(out));
+  // Nothing else changed.
+  out[42] = packet[42];
+  out[43] = packet[43];
+  out[36] = packet[36];
+  out[37] = packet[37];
+  EXPECT_EQ(out, packet);
+
+  // SYN-ACKs are clamped too.
+  ASSERT_TRUE(mux::clamp_tcp_mss(syn(false, {2, 4, 0x05, 0xB4}, 0x12), 1350, out));
+  EXPECT_EQ(mss_at(out, 42), 1310);
+}
+
+TEST(MssClampTests, OddOffsetAndIpv6) {
+  // A NOP first puts the MSS value at an odd offset in the TCP header.
+  const auto odd = syn(false, {1, 2, 4, 0xFF, 0xFF, 1, 1, 1});
+  std::vector<std::uint8_t> out;
+  ASSERT_TRUE(mux::clamp_tcp_mss(odd, 1400, out));
+  EXPECT_EQ(mss_at(out, 43), 1360);
+  EXPECT_EQ(mss_at(out, 36), tcp_checksum(out));
+
+  const auto v6 = syn(true, {2, 4, 0x05, 0xA0});
+  ASSERT_TRUE(mux::clamp_tcp_mss(v6, 1400, out));
+  EXPECT_EQ(mss_at(out, 62), 1400 - mux::kMssOverheadIpv6);
+  EXPECT_EQ(mss_at(out, 56), tcp_checksum(out));
+}
+
+TEST(MssClampTests, LeavesOtherPacketsAlone) {
+  std::vector<std::uint8_t> out{1, 2, 3};
+  const std::vector<std::uint8_t> untouched = out;
+  // Already fits.
+  EXPECT_FALSE(mux::clamp_tcp_mss(syn(false, {2, 4, 0x04, 0x00}), 1350, out));
+  // Not a SYN.
+  EXPECT_FALSE(mux::clamp_tcp_mss(syn(false, {2, 4, 0x05, 0xB4}, 0x10), 1350, out));
+  // No MSS option, or options cut short.
+  EXPECT_FALSE(mux::clamp_tcp_mss(syn(false, {1, 1, 1, 0}), 1350, out));
+  EXPECT_FALSE(mux::clamp_tcp_mss(syn(false, {8, 10, 0, 0}), 1350, out));
+  // UDP.
+  auto udp = syn(false, {2, 4, 0x05, 0xB4});
+  udp[9] = 17;
+  EXPECT_FALSE(mux::clamp_tcp_mss(udp, 1350, out));
+  // A later fragment.
+  auto fragment = syn(false, {2, 4, 0x05, 0xB4});
+  fragment[7] = 1;
+  EXPECT_FALSE(mux::clamp_tcp_mss(fragment, 1350, out));
+  EXPECT_FALSE(mux::clamp_tcp_mss(std::vector<std::uint8_t>(10, 0x45), 1350, out));
+  EXPECT_EQ(out, untouched);
+}
+
+}  // namespace veil::tests
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <cstdint>
 #include <vector>
 
@@ -294,4 +295,231 @@ TEST(MuxCodecTests, EncodeViewToRoundTrip) {
   EXPECT_EQ(buffer, encoded);
 }
 
+TEST(MuxCodecTests, DatagramFrameRoundTrip) {
+  std::vector<std::uint8_t> payload{0x45, 0x00, 0x00, 0x1C, 0xAB};
+  auto frame = mux::make_datagram_frame(payload);
+  auto encoded = mux::MuxCodec::encode(frame);
+  EXPECT_EQ(encoded.size(), mux::MuxCodec::kDatagramHeaderSize + payload.size());
+  EXPECT_EQ(encoded.size(), mux::MuxCodec::encoded_size(frame));
+
+  auto decoded = mux::MuxCodec::decode(encoded);
+  ASSERT_TRUE(decoded.has_value());
+  EXPECT_EQ(decoded->kind, mux::FrameKind::kDatagram);
+  EXPECT_EQ(decoded->datagram.payload, payload);
+
+  auto view = mux::MuxCodec::decode_view(encoded);
+  ASSERT_TRUE(view.has_value());
+  EXPECT_EQ(view->kind, mux::FrameKind::kDatagram);
+  EXPECT_EQ(view->datagram.payload.data(), encoded.data() + mux::MuxCodec::kDatagramHeaderSize);
+
+  std::vector<std::uint8_t> buffer(mux::MuxCodec::encoded_size_view(*view));
+  EXPECT_EQ(mux::MuxCodec::encode_view_to(*view, buffer), buffer.size());
+  EXPECT_EQ(buffer, encoded);
+}
+
+TEST(MuxCodecTests, RejectsTruncatedDatagramFrame) {
+  auto encoded = mux::MuxCodec::encode(mux::make_datagram_frame({0x01, 0x02, 0x03}));
+  encoded.pop_back();
+  EXPECT_FALSE(mux::MuxCodec::decode(encoded).has_value());
+  EXPECT_FALSE(mux::MuxCodec::decode_view(encoded).has_value());
+}
+
+TEST(MuxCodecTests, MultipleFramesRoundTrip) {
+  std::vector<mux::MuxFrame> frames{
+      mux::make_datagram_frame({0x45, 0x00, 0x00, 0x14}),
+      mux::make_ack_frame(3, 77, 0x5),
+      mux::make_data_frame(1, 2, true, {0xAA, 0xBB}),
+      mux::make_control_frame(mux::kControlSessionTicket, {0x01}),
+      mux::make_heartbeat_frame(123, 4),
+  };
+  auto encoded = mux::MuxCodec::encode_all(frames);
+
+  std::size_t expected_size = 0;
+  for (const auto& frame : frames) {
+    expected_size += mux::MuxCodec::encoded_size(frame);
+  }
+  EXPECT_EQ(encoded.size(), expected_size);
+  EXPECT_EQ(mux::MuxCodec::leading_frame_size(encoded), mux::MuxCodec::encoded_size(frames[0]));
+
+  auto decoded = mux::MuxCodec::decode_all(encoded);
+  ASSERT_TRUE(decoded.has_value());
+  ASSERT_EQ(decoded->size(), frames.size());
+  EXPECT_EQ((*decoded)[0].datagram.payload, frames[0].datagram.payload);
+  EXPECT_EQ((*decoded)[1].ack.ack, 77U);
+  EXPECT_EQ((*decoded)[2].data.payload, frames[2].data.payload);
+  EXPECT_EQ((*decoded)[3].control.type, mux::kControlSessionTicket);
+  EXPECT_EQ((*decoded)[4].heartbeat.timestamp, 123U);
+}
+
+TEST(MuxCodecTests, DecodeAllSingleFrameMatchesDecode) {
+  auto encoded = mux::MuxCodec::encode(mux::make_ack_frame(7, 200, 0xDEADBEEF));
+  auto decoded = mux::MuxCodec::decode_all(encoded);
+  ASSERT_TRUE(decoded.has_value());
+  ASSERT_EQ(decoded->size(), 1U);
+  EXPECT_EQ((*decoded)[0].ack.bitmap, 0xDEADBEEFU);
+}
+
+TEST(MuxCodecTests, DecodeAllRejectsTruncatedTrailingFrame) {
+  std::vector<mux::MuxFrame> frames{mux::make_ack_frame(1, 1, 0),
+                                    mux::make_datagram_frame({0x01, 0x02, 0x03})};
+  auto encoded = mux::MuxCodec::encode_all(frames);
+  encoded.pop_back();
+  EXPECT_FALSE(mux::MuxCodec::decode_all(encoded).has_value());
+  EXPECT_FALSE(mux::MuxCodec::decode_all({}).has_value());
+}
+
+TEST(MuxCodecTests, AckRangesFrameRoundTrip) {
+  mux::AckRangesFrame ack;
+  ack.stream_id = 3;
+  ack.ack_delay = std::chrono::microseconds(1600);
+  ack.ranges = {{900, 1000}, {500, 850}, {7, 7}};
+  ack.ecn = mux::EcnCounts{.ect0 = 40, .ect1 = 0, .ce = 2};
+
+  const auto frame = mux::make_ack_ranges_frame(ack);
+  auto encoded = mux::MuxCodec::encode(frame);
+  EXPECT_EQ(encoded.size(), mux::MuxCodec::encoded_size(frame));
+  EXPECT_EQ(mux::MuxCodec::leading_frame_size(encoded), encoded.size());
+
+  auto decoded = mux::MuxCodec::decode(encoded);
+  ASSERT_TRUE(decoded.has_value());
+  ASSERT_EQ(decoded->kind, mux::FrameKind::kAckRanges);
+  const auto& out = decoded->ack_ranges;
+  EXPECT_EQ(out.version, mux::kAckRangesVersion);
+  EXPECT_EQ(out.stream_id, 3U);
+  EXPECT_EQ(out.ack_delay, std::chrono::microseconds(1600));
+  ASSERT_EQ(out.ranges.size(), 3U);
+  EXPECT_EQ(out.ranges[0].smallest, 900U);
+  EXPECT_EQ(out.ranges[0].largest, 1000U);
+  EXPECT_EQ(out.ranges[1].smallest, 500U);
+  EXPECT_EQ(out.ranges[1].largest, 850U);
+  EXPECT_EQ(out.ranges[2].smallest, 7U);
+  EXPECT_EQ(out.ranges[2].largest, 7U);
+  ASSERT_TRUE(out.ecn.has_value());
+  EXPECT_EQ(out.ecn->ect0, 40U);
+  EXPECT_EQ(out.ecn->ce, 2U);
+
+  // The zero-copy paths agree.
+  std::vector<std::uint8_t> buffer(encoded.size());
+  EXPECT_EQ(mux::MuxCodec::encode_to(frame, buffer), encoded.size());
+  EXPECT_EQ(buffer, encoded);
+  auto view = mux::MuxCodec::decode_view(encoded);
+  ASSERT_TRUE(view.has_value());
+  EXPECT_EQ(view->ack_ranges.ranges.size(), 3U);
+}
+
+TEST(MuxCodecTests, AckRangesFrameLimitsAndSaturation) {
+  mux::AckRangesFrame ack;
+  ack.ack_delay = std::chrono::seconds(5);  // Beyond the 16-bit field
+  for (std::uint64_t i = 0; i < 2 * mux::kMaxAckRanges; ++i) {
+    const std::uint64_t seq = 10000 - 3 * i;
+    ack.ranges.push_back({seq, seq});
+  }
+  auto decoded = mux::MuxCodec::decode(mux::MuxCodec::encode(mux::make_ack_ranges_frame(ack)));
+  ASSERT_TRUE(decoded.has_value());
+  EXPECT_EQ(decoded->ack_ranges.ranges.size(), mux::kMaxAckRanges);
+  EXPECT_EQ(decoded->ack_ranges.ack_delay,
+            std::chrono::microseconds(0xFFFF << mux::MuxCodec::kAckDelayExponent));
+  EXPECT_FALSE(decoded->ack_ranges.ecn.has_value());
+}
+
+TEST(MuxCodecTests, RejectsMalformedAckRangesFrame) {
+  mux::AckRangesFrame ack;
+  ack.ranges = {{10, 20}, {2, 5}};
+  const auto encoded = mux::MuxCodec::encode(mux::make_ack_ranges_frame(ack));
+  ASSERT_TRUE(mux::MuxCodec::decode(encoded).has_value());
+
+  auto bad_version = encoded;
+  bad_version[1] = mux::kAckRangesVersion + 1;
+  EXPECT_FALSE(mux::MuxCodec::decode(bad_version).has_value());
+
+  auto truncated = encoded;
+  truncated.pop_back();
+  EXPECT_FALSE(mux::MuxCodec::decode(truncated).has_value());
+
+  // A first range longer than the largest acknowledged sequence underflows.
+  auto underflow = encoded;
+  underflow[25] = 0xFF;
+  EXPECT_FALSE(mux::MuxCodec::decode(underflow).has_value());
+}
+
+TEST(MuxCodecTests, FecRepairFrameRoundTrip) {
+  mux::FecRepairFrame repair;
+  repair.first_sequence = 1000;
+  repair.mask = 0b1011;
+  repair.length_xor = 0x1234;
+  repair.payload = {0xDE, 0xAD, 0xBE, 0xEF};
+
+  const auto frame = mux::make_fec_repair_frame(repair);
+  auto encoded = mux::MuxCodec::encode(frame);
+  EXPECT_EQ(encoded.size(), mux::MuxCodec::encoded_size(frame));
+  EXPECT_EQ(mux::MuxCodec::leading_frame_size(encoded), encoded.size());
+
+  auto decoded = mux::MuxCodec::decode(encoded);
+  ASSERT_TRUE(decoded.has_value());
+  ASSERT_EQ(decoded->kind, mux::FrameKind::kFecRepair);
+  EXPECT_EQ(decoded->fec_repair.first_sequence, 1000U);
+  EXPECT_EQ(decoded->fec_repair.mask, 0b1011U);
+  EXPECT_EQ(decoded->fec_repair.length_xor, 0x1234U);
+  EXPECT_EQ(decoded->fec_repair.payload, repair.payload);
+
+  std::vector<std::uint8_t> buffer(encoded.size());
+  EXPECT_EQ(mux::MuxCodec::encode_to(frame, buffer), encoded.size());
+  EXPECT_EQ(buffer, encoded);
+  auto view = mux::MuxCodec::decode_view(encoded);
+  ASSERT_TRUE(view.has_value());
+  EXPECT_EQ(view->fec_repair.mask, 0b1011U);
+
+  // A repair covering no packet is malformed.
+  repair.mask = 0;
+  EXPECT_FALSE(mux::MuxCodec::decode(mux::MuxCodec::encode(mux::make_fec_repair_frame(repair)))
+                   .has_value());
+}
+
+TEST(MuxCodecTests, CompactDataFrameRoundTrip) {
+  const std::vector<std::uint8_t> payload = {1, 2, 3, 4, 5};
+  const std::vector<mux::MuxFrame> frames = {
+      mux::make_data_frame(0, 1, true, payload),
+      mux::make_data_frame(300, 70000, false, payload),
+      // A fragment: message id << 32 | fragment index.
+      mux::make_data_frame(0, (std::uint64_t{123456} << 32) | 3, true, payload),
+  };
+  for (const auto& frame : frames) {
+    const auto v1 = mux::MuxCodec::encode(frame);
+    const auto v2 = mux::MuxCodec::encode(frame, mux::WireFormat::kV2);
+    EXPECT_LT(v2.size(), v1.size());
+    EXPECT_EQ(v2.size(), mux::MuxCodec::encoded_size(frame, mux::WireFormat::kV2));
+    EXPECT_EQ(mux::MuxCodec::leading_frame_size(v2), v2.size());
+
+    auto decoded = mux::MuxCodec::decode(v2);
+    ASSERT_TRUE(decoded.has_value());
+    ASSERT_EQ(decoded->kind, mux::FrameKind::kData);
+    EXPECT_EQ(decoded->data.stream_id, frame.data.stream_id);
+    EXPECT_EQ(decoded->data.sequence, frame.data.sequence);
+    EXPECT_EQ(decoded->data.fin, frame.data.fin);
+    EXPECT_EQ(decoded->data.payload, payload);
+
+    std::vector<std::uint8_t> buffer(v2.size());
+    EXPECT_EQ(mux::MuxCodec::encode_to(frame, buffer, mux::WireFormat::kV2), v2.size());
+    EXPECT_EQ(buffer, v2);
+    auto view = mux::MuxCodec::decode_view(v2);
+    ASSERT_TRUE(view.has_value());
+    ASSERT_EQ(view->kind, mux::FrameKind::kData);
+    EXPECT_EQ(view->data.sequence, frame.data.sequence);
+  }
+
+  // Unchanged frames and compact DATA mix in one packet.
+  std::vector<mux::MuxFrame> mixed = frames;
+  mixed.push_back(mux::make_ack_frame(0, 42, 0x3));
+  auto decoded = mux::MuxCodec::decode_all(mux::MuxCodec::encode_all(mixed, mux::WireFormat::kV2));
+  ASSERT_TRUE(decoded.has_value());
+  ASSERT_EQ(decoded->size(), mixed.size());
+  EXPECT_EQ((*decoded)[1].data.stream_id, 300U);
+  EXPECT_EQ((*decoded)[3].ack.ack, 42U);
+
+  // A truncated compact frame is malformed.
+  auto truncated = mux::MuxCodec::encode(frames[1], mux::WireFormat::kV2);
+  truncated.pop_back();
+  EXPECT_FALSE(mux::MuxCodec::decode(truncated).has_value());
+}
+
 }  // namespace veil::tests
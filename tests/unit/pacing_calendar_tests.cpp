@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "transport/udp_socket/pacing_calendar.h"
+
+namespace veil::tests {
+
+namespace {
+
+using namespace std::chrono_literals;
+using TimePoint = transport::PacingCalendar::TimePoint;
+
+const TimePoint kStart = TimePoint{} + 10s;
+
+transport::UdpPacket packet(std::uint8_t id, const char* host, TimePoint send_at) {
+  transport::UdpPacket pkt{{id}, {host, 4433}, 0};
+  pkt.send_at = send_at;
+  return pkt;
+}
+
+std::vector<std::uint8_t> ids(const std::vector<transport::UdpPacket>& packets) {
+  std::vector<std::uint8_t> out;
+  for (const auto& pkt : packets) {
+    out.push_back(pkt.data[0]);
+  }
+  return out;
+}
+
+}  // namespace
+
+TEST(PacingCalendarTests, ReleasesSessionsInDepartureOrder) {
+  transport::PacingCalendar calendar;
+  // Two sessions scheduling in turn; departures interleave.
+  calendar.schedule(packet(1, "10.0.0.1", kStart + 2ms));
+  calendar.schedule(packet(2, "10.0.0.2", kStart + 1ms));
+  calendar.schedule(packet(3, "10.0.0.1", kStart + 4ms));
+  calendar.schedule(packet(4, "10.0.0.2", kStart + 3ms));
+  EXPECT_EQ(calendar.size(), 4U);
+
+  std::vector<transport::UdpPacket> out;
+  calendar.release(kStart + 10ms, out);
+  EXPECT_EQ(ids(out), (std::vector<std::uint8_t>{2, 1, 4, 3}));
+  EXPECT_EQ(out[0].remote.host, "10.0.0.2");
+  EXPECT_TRUE(calendar.empty());
+}
+
+TEST(PacingCalendarTests, HoldsPacketsUntilReleaseAhead) {
+  transport::PacingCalendar calendar(transport::PacingCalendarConfig{
+      .slot = 50us, .slots = 4096, .release_ahead = 1ms});
+  for (std::uint8_t i = 0; i < 10; ++i) {
+    calendar.schedule(packet(i, "10.0.0.1", kStart + i * 500us));
+  }
+
+  std::vector<transport::UdpPacket> out;
+  // Due by kStart + 1 ms: the packets at 0, 0.5 and 1 ms.
+  calendar.release(kStart, out);
+  EXPECT_EQ(ids(out), (std::vector<std::uint8_t>{0, 1, 2}));
+  EXPECT_EQ(calendar.time_until_release(kStart), 500us);
+
+  out.clear();
+  calendar.release(kStart + 250us, out);
+  EXPECT_TRUE(out.empty());
+  calendar.release(kStart + 2ms, out);
+  EXPECT_EQ(ids(out), (std::vector<std::uint8_t>{3, 4, 5, 6}));
+  EXPECT_EQ(calendar.size(), 3U);
+  EXPECT_EQ(calendar.time_until_release(kStart + 2ms), 500us);
+  // Late: everything due at once.
+  EXPECT_EQ(calendar.time_until_release(kStart + 1s), 0ns);
+}
+
+TEST(PacingCalendarTests, DepartureBeyondHorizonWaitsInOverflow) {
+  transport::PacingCalendar calendar(transport::PacingCalendarConfig{
+      .slot = 50us, .slots = 64, .release_ahead = 0us});
+  calendar.schedule(packet(1, "10.0.0.1", kStart + 1s));
+  calendar.schedule(packet(2, "10.0.0.1", kStart));
+  calendar.schedule(packet(3, "10.0.0.1", kStart + 20ms));
+
+  std::vector<transport::UdpPacket> out;
+  calendar.release(kStart, out);
+  EXPECT_EQ(ids(out), (std::vector<std::uint8_t>{2}));
+  EXPECT_EQ(calendar.time_until_release(kStart), 20ms);
+
+  out.clear();
+  calendar.release(kStart + 500ms, out);
+  EXPECT_EQ(ids(out), (std::vector<std::uint8_t>{3}));
+  EXPECT_EQ(calendar.time_until_release(kStart + 500ms), 500ms);
+  calendar.release(kStart + 1s - 1us, out);
+  EXPECT_EQ(calendar.size(), 1U);
+  calendar.release(kStart + 1s, out);
+  EXPECT_EQ(ids(out), (std::vector<std::uint8_t>{3, 1}));
+  EXPECT_FALSE(calendar.time_until_release(kStart + 1s).has_value());
+}
+
+TEST(PacingCalendarTests, PastDepartureGoesOutNext) {
+  transport::PacingCalendar calendar;
+  calendar.schedule(packet(1, "10.0.0.1", kStart + 5ms));
+  std::vector<transport::UdpPacket> out;
+  calendar.release(kStart + 3ms, out);
+  ASSERT_TRUE(out.empty());
+
+  // Scheduled behind the wheel: due right away, ahead of the later packet.
+  calendar.schedule(packet(2, "10.0.0.2", kStart));
+  EXPECT_EQ(calendar.time_until_release(kStart + 3ms), 0ns);
+  calendar.release(kStart + 3ms, out);
+  EXPECT_EQ(ids(out), (std::vector<std::uint8_t>{2}));
+
+  calendar.clear();
+  EXPECT_TRUE(calendar.empty());
+  calendar.release(kStart + 10ms, out);
+  EXPECT_EQ(out.size(), 1U);
+}
+
+}  // namespace veil::tests
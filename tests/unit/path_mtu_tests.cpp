@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+
+#include "transport/mux/path_mtu.h"
+
+namespace veil::tests {
+
+namespace {
+
+using namespace std::chrono_literals;
+using TimePoint = mux::PathMtuProber::TimePoint;
+
+// Runs the prober against a path that carries packets up to path_limit, acknowledging
+// after 10 ms, until nothing is due before `until`. Returns the time reached.
+TimePoint run(mux::PathMtuProber& prober, std::size_t path_limit, TimePoint now,
+              TimePoint until) {
+  std::uint32_t id = 0;
+  while (now < until) {
+    const auto size = prober.probe_due(now);
+    if (!size) {
+      now += 100ms;
+      continue;
+    }
+    prober.on_probe_sent(id, *size, now);
+    now += 10ms;
+    if (*size <= path_limit) {
+      prober.on_probe_acked(id, now);
+    }
+    ++id;
+  }
+  return now;
+}
+
+}  // namespace
+
+TEST(PathMtuTests, CleanPathReachesMaxSizeWithOneProbe) {
+  mux::PathMtuProber prober(1400);
+  const TimePoint start{};
+  run(prober, 1500, start, start + 1s);
+  EXPECT_EQ(prober.path_size(), 1472U);
+  EXPECT_EQ(prober.state(), mux::PathMtuState::kSearchComplete);
+  EXPECT_EQ(prober.stats().probes_sent, 1U);
+  EXPECT_EQ(prober.stats().probes_lost, 0U);
+}
+
+TEST(PathMtuTests, SearchFindsPathLimit) {
+  mux::PathMtuProber prober(1200, mux::PathMtuConfig{.max_size = 1472, .granularity = 4});
+  const TimePoint start{};
+  run(prober, 1420, start, start + 60s);
+  EXPECT_EQ(prober.state(), mux::PathMtuState::kSearchComplete);
+  EXPECT_LE(prober.path_size(), 1420U);
+  EXPECT_GT(prober.path_size(), 1420U - 4);
+  // Every lost probe was at a size the path does not carry, max_probes times each.
+  EXPECT_EQ(prober.stats().probes_lost % 3, 0U);
+}
+
+TEST(PathMtuTests, PathAtBaseSizeStaysThere) {
+  mux::PathMtuProber prober(1400);
+  const TimePoint start{};
+  run(prober, 1400, start, start + 60s);
+  EXPECT_EQ(prober.path_size(), 1400U);
+  EXPECT_EQ(prober.state(), mux::PathMtuState::kSearchComplete);
+  // Nothing more until the raise interval.
+  EXPECT_FALSE(prober.probe_due(start + 120s).has_value());
+}
+
+TEST(PathMtuTests, BlackHoleFallsBackToBase) {
+  mux::PathMtuConfig config;
+  mux::PathMtuProber prober(1400, config);
+  TimePoint now = run(prober, 1500, TimePoint{}, TimePoint{} + 1s);
+  ASSERT_EQ(prober.path_size(), 1472U);
+
+  // The path now drops anything over 1440 without telling anyone. A retransmission
+  // timeout triggers a confirmation probe; its losses bring the size back down.
+  prober.on_timeout_loss(now);
+  for (std::uint32_t i = 0; i < config.max_probes; ++i) {
+    const auto size = prober.probe_due(now);
+    ASSERT_TRUE(size.has_value());
+    EXPECT_EQ(*size, 1472U);
+    prober.on_probe_sent(100 + i, *size, now);
+    now += config.probe_timeout;
+  }
+  EXPECT_TRUE(prober.probe_due(now).has_value());
+  EXPECT_EQ(prober.path_size(), 1400U);
+  EXPECT_EQ(prober.stats().black_holes, 1U);
+
+  // The new search settles below the size that failed.
+  run(prober, 1440, now, now + 60s);
+  EXPECT_LE(prober.path_size(), 1440U);
+  EXPECT_GT(prober.path_size(), 1440U - config.granularity);
+}
+
+TEST(PathMtuTests, ConfirmsPeriodicallyAndRaisesAfterInterval) {
+  mux::PathMtuConfig config{.max_size = 1472,
+                            .raise_interval = std::chrono::seconds(600),
+                            .confirm_interval = std::chrono::seconds(30)};
+  mux::PathMtuProber prober(1400, config);
+  const TimePoint start{};
+  TimePoint now = run(prober, 1440, start, start + 60s);
+  const auto found = prober.path_size();
+  ASSERT_GT(found, 1400U);
+  const auto sent = prober.stats().probes_sent;
+
+  // Confirmations at the found size keep it.
+  now = run(prober, 1440, now, start + 300s);
+  EXPECT_EQ(prober.path_size(), found);
+  EXPECT_GT(prober.stats().probes_sent, sent);
+
+  // The path grows; the next search after raise_interval finds it.
+  run(prober, 1500, now, start + 700s);
+  EXPECT_EQ(prober.path_size(), 1472U);
+}
+
+TEST(PathMtuTests, StaleAckIsIgnored) {
+  mux::PathMtuProber prober(1400);
+  const TimePoint start{};
+  const auto size = prober.probe_due(start);
+  ASSERT_TRUE(size.has_value());
+  prober.on_probe_sent(1, *size, start);
+  prober.on_probe_acked(2, start + 10ms);
+  EXPECT_EQ(prober.path_size(), 1400U);
+  prober.on_probe_acked(1, start + 10ms);
+  EXPECT_EQ(prober.path_size(), *size);
+}
+
+}  // namespace veil::tests
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "transport/mux/payload_compression.h"
+
+namespace veil::tests {
+
+namespace {
+
+std::vector<std::uint8_t> log_lines(std::size_t size) {
+  std::vector<std::uint8_t> out;
+  for (int line = 0; out.size() < size; ++line) {
+    const auto text = "2026-10-18T12:00:" + std::to_string(10 + line % 50) +
+                      "Z INFO collector: flushed " + std::to_string(line * 37 % 1000) +
+                      " samples to /var/lib/telemetry/shard-" + std::to_string(line % 4) + "\n";
+    out.insert(out.end(), text.begin(), text.end());
+  }
+  out.resize(size);
+  return out;
+}
+
+std::vector<std::uint8_t> random_bytes(std::size_t size, unsigned alphabet, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<unsigned> byte(0, alphabet - 1);
+  std::vector<std::uint8_t> out(size);
+  for (auto& b : out) {
+    b = static_cast<std::uint8_t>(byte(rng));
+  }
+  return out;
+}
+
+}  // namespace
+
+TEST(PayloadCompressionTests, Lz4RoundTrip) {
+  mux::Lz4Encoder encoder;
+  // Text, a long run (match lengths past 15 + 255), and a long literal run followed by a
+  // repeat of it.
+  auto literal_run = random_bytes(600, 256, 1);
+  literal_run.insert(literal_run.end(), literal_run.begin(), literal_run.end());
+  for (const auto& input : {log_lines(1400), std::vector<std::uint8_t>(3000, 0x41), literal_run,
+                            std::vector<std::uint8_t>{1, 2, 3}}) {
+    std::vector<std::uint8_t> block;
+    ASSERT_TRUE(encoder.encode(input, 2 * input.size() + 16, block));
+    std::vector<std::uint8_t> decoded;
+    ASSERT_TRUE(mux::lz4_decode(block, input.size(), decoded));
+    EXPECT_EQ(decoded, input);
+  }
+
+  std::vector<std::uint8_t> block;
+  ASSERT_TRUE(encoder.encode(log_lines(1400), 1400, block));
+  EXPECT_LT(block.size(), 700U);
+  // Over the limit: reported, not produced.
+  block.clear();
+  EXPECT_FALSE(encoder.encode(random_bytes(1400, 256, 2), 1400, block));
+}
+
+TEST(PayloadCompressionTests, Lz4DecodeRejectsMalformedBlocks) {
+  std::vector<std::uint8_t> out;
+  // One literal, then a match at offset 0 or past the start of the output.
+  EXPECT_FALSE(mux::lz4_decode(std::vector<std::uint8_t>{0x10, 'a', 0x00, 0x00, 0x00}, 6, out));
+  EXPECT_FALSE(mux::lz4_decode(std::vector<std::uint8_t>{0x10, 'a', 0x02, 0x00, 0x00}, 6, out));
+  // More literals than the block holds.
+  EXPECT_FALSE(mux::lz4_decode(std::vector<std::uint8_t>{0x50, 'a', 'b'}, 5, out));
+  // Decodes to a different size than stated.
+  EXPECT_FALSE(mux::lz4_decode(std::vector<std::uint8_t>{0x20, 'a', 'b'}, 3, out));
+  // Length bytes running off the end.
+  EXPECT_FALSE(mux::lz4_decode(std::vector<std::uint8_t>{0xF0, 255, 255}, 600, out));
+  // Valid: "a" then a 5-byte overlapping match.
+  ASSERT_TRUE(mux::lz4_decode(std::vector<std::uint8_t>{0x11, 'a', 0x01, 0x00, 0x00}, 6, out));
+  EXPECT_EQ(out, std::vector<std::uint8_t>(6, 'a'));
+}
+
+TEST(PayloadCompressionTests, CompressesTextAndPassesOtherPacketsThrough) {
+  mux::PayloadCompressor compressor;
+  mux::PayloadDecompressor decompressor;
+  const auto packet = log_lines(1400);
+
+  std::vector<std::uint8_t> wire;
+  ASSERT_TRUE(compressor.compress(1, packet, wire));
+  EXPECT_EQ(wire[0], mux::kCompressedPayload);
+  EXPECT_EQ(compressor.stats().bytes_saved, packet.size() - wire.size());
+  ASSERT_TRUE(decompressor.decompress(wire));
+  EXPECT_EQ(wire, packet);
+
+  // Too small to be worth it.
+  EXPECT_FALSE(compressor.compress(1, log_lines(100), wire));
+
+  // Uncompressed packets come out unchanged; a damaged block is dropped.
+  auto ipv4 = packet;
+  ipv4[0] = 0x45;
+  auto copy = ipv4;
+  EXPECT_TRUE(decompressor.decompress(copy));
+  EXPECT_EQ(copy, ipv4);
+  ASSERT_TRUE(compressor.compress(1, packet, wire));
+  wire[2] ^= 0x01;  // Stated size
+  EXPECT_FALSE(decompressor.decompress(wire));
+  EXPECT_EQ(decompressor.stats().decode_errors, 1U);
+}
+
+TEST(PayloadCompressionTests, IncompressibleFlowIsCachedUntilRecheck) {
+  mux::PayloadCompressor compressor(mux::PayloadCompressionConfig{.recheck_interval = 8});
+  std::vector<std::uint8_t> wire;
+
+  // Encrypted-looking payload: rejected by the entropy test without running the encoder.
+  EXPECT_FALSE(compressor.compress(7, random_bytes(1200, 256, 3), wire));
+  EXPECT_EQ(compressor.stats().skipped_entropy, 1U);
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_FALSE(compressor.compress(7, log_lines(1200), wire));
+  }
+  EXPECT_EQ(compressor.stats().skipped_cached, 8U);
+  // Tried again after recheck_interval packets: the flow turned compressible.
+  EXPECT_TRUE(compressor.compress(7, log_lines(1200), wire));
+
+  // Low entropy but no repeats for LZ4 to use: the encoder runs, then the flow is cached.
+  EXPECT_FALSE(compressor.compress(9, random_bytes(1200, 64, 4), wire));
+  EXPECT_EQ(compressor.stats().skipped_incompressible, 1U);
+  EXPECT_FALSE(compressor.compress(9, log_lines(1200), wire));
+  EXPECT_EQ(compressor.stats().skipped_cached, 9U);
+  // Other flows are unaffected.
+  EXPECT_TRUE(compressor.compress(10, log_lines(1200), wire));
+}
+
+TEST(PayloadCompressionTests, FlowIdCoversAddressesAndPorts) {
+  std::vector<std::uint8_t> packet(40, 0);
+  packet[0] = 0x45;
+  packet[9] = 6;
+  packet[15] = 2;
+  packet[21] = 80;
+  const auto id = mux::ip_flow_id(packet);
+  auto other_port = packet;
+  other_port[21] = 81;
+  EXPECT_NE(mux::ip_flow_id(other_port), id);
+  // Payload bytes do not matter.
+  auto other_payload = packet;
+  other_payload[39] = 1;
+  EXPECT_EQ(mux::ip_flow_id(other_payload), id);
+}
+
+}  // namespace veil::tests
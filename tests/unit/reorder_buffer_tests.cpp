@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include <cstdint>
 #include <vector>
 
 #include "transport/mux/reorder_buffer.h"
@@ -34,4 +35,57 @@ TEST(ReorderBufferTests, RespectsBufferLimit) {
   EXPECT_FALSE(buf.push(2, {1, 2}));
 }
 
+TEST(ReorderBufferTests, RejectsDuplicatesAndReleased) {
+  mux::ReorderBuffer buf(0);
+  EXPECT_TRUE(buf.push(3, {3}));
+  EXPECT_FALSE(buf.push(3, {3}));
+  EXPECT_TRUE(buf.push(0, {}));  // Empty payloads are held too
+  EXPECT_FALSE(buf.push(0, {}));
+  ASSERT_TRUE(buf.pop_next().has_value());
+  EXPECT_FALSE(buf.push(0, {}));
+  EXPECT_EQ(buf.next_expected(), 1U);
+}
+
+TEST(ReorderBufferTests, WrapsAroundTheRing) {
+  mux::ReorderBuffer buf(0, 1 << 20, 64);
+  // Each round leaves one hole and fills it last, across many turns of the ring.
+  for (std::uint64_t base = 0; base < 640; base += 40) {
+    for (std::uint64_t seq = base + 1; seq < base + 40; ++seq) {
+      ASSERT_TRUE(buf.push(seq, {static_cast<std::uint8_t>(seq)}));
+    }
+    EXPECT_FALSE(buf.pop_next().has_value());
+    ASSERT_TRUE(buf.push(base, {static_cast<std::uint8_t>(base)}));
+    for (std::uint64_t seq = base; seq < base + 40; ++seq) {
+      auto value = buf.pop_next();
+      ASSERT_TRUE(value.has_value());
+      EXPECT_EQ(value->at(0), static_cast<std::uint8_t>(seq));
+    }
+  }
+  EXPECT_EQ(buf.buffered_bytes(), 0U);
+}
+
+TEST(ReorderBufferTests, KeepsSequencesBeyondTheRing) {
+  mux::ReorderBuffer buf(0, 1 << 20, 64);
+  EXPECT_TRUE(buf.push(100, {100}));
+  EXPECT_TRUE(buf.push(70, {70}));
+  for (std::uint64_t seq = 0; seq < 70; ++seq) {
+    ASSERT_TRUE(buf.push(seq, {static_cast<std::uint8_t>(seq)}));
+    ASSERT_TRUE(buf.pop_next().has_value());
+  }
+  // 100 is within the ring now, but its first copy is still held.
+  EXPECT_FALSE(buf.push(100, {100}));
+  auto v70 = buf.pop_next();
+  ASSERT_TRUE(v70.has_value());
+  EXPECT_EQ(v70->at(0), 70);
+  for (std::uint64_t seq = 71; seq < 100; ++seq) {
+    ASSERT_TRUE(buf.push(seq, {static_cast<std::uint8_t>(seq)}));
+  }
+  for (std::uint64_t seq = 71; seq <= 100; ++seq) {
+    auto value = buf.pop_next();
+    ASSERT_TRUE(value.has_value());
+    EXPECT_EQ(value->at(0), static_cast<std::uint8_t>(seq));
+  }
+  EXPECT_EQ(buf.buffered_bytes(), 0U);
+}
+
 }  // namespace veil::tests
@@ -1,7 +1,10 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
+#include <random>
+#include <set>
 #include <thread>
 
 #include "common/session/replay_window.h"
@@ -67,6 +70,52 @@ TEST(ReplayWindowTests, UnmarkWithWindowAdvancement) {
   EXPECT_TRUE(window.mark_and_check(100));
 }
 
+TEST(ReplayWindowTests, CheckDoesNotMark) {
+  session::ReplayWindow window(64);
+  EXPECT_TRUE(window.check(5));
+  EXPECT_TRUE(window.mark_and_check(5));
+  EXPECT_FALSE(window.check(5));
+  EXPECT_TRUE(window.check(4));
+  EXPECT_TRUE(window.check(4));
+  EXPECT_TRUE(window.mark_and_check(100));
+  EXPECT_FALSE(window.check(4));
+  EXPECT_TRUE(window.check(99));
+}
+
+TEST(ReplayWindowTests, MatchesReferenceModelAcrossRingWraps) {
+  // Random sequences around a moving head, checked against a set of seen sequences.
+  for (const std::size_t size : {8U, 64U, 100U, 1024U, 65536U}) {
+    session::ReplayWindow window(size);
+    std::set<std::uint64_t> seen;
+    std::uint64_t highest = 0;
+    std::mt19937_64 rng(size);
+    const auto span = static_cast<std::int64_t>(size) * 2;
+    std::uniform_int_distribution<std::int64_t> offset(-span, span / 4);
+    for (int i = 0; i < 20000; ++i) {
+      const auto candidate = static_cast<std::int64_t>(highest) + offset(rng);
+      const auto seq = static_cast<std::uint64_t>(std::max<std::int64_t>(candidate, 1));
+      const bool expected = (seen.empty() || seq > highest || highest - seq < size) &&
+                            seen.count(seq) == 0;
+      ASSERT_EQ(window.mark_and_check(seq), expected) << "window " << size << " seq " << seq;
+      if (expected) {
+        seen.insert(seq);
+        highest = std::max(highest, seq);
+      }
+    }
+  }
+}
+
+TEST(ReplayWindowTests, LargeJumpClearsWholeRing) {
+  session::ReplayWindow window(65536);
+  EXPECT_TRUE(window.mark_and_check(5));
+  EXPECT_TRUE(window.mark_and_check(1000000));
+  // 5 is far outside the window now; sequences just below the new head are fresh.
+  EXPECT_FALSE(window.mark_and_check(5));
+  EXPECT_TRUE(window.mark_and_check(1000000 - 65535));
+  EXPECT_FALSE(window.mark_and_check(1000000 - 65536));
+  EXPECT_FALSE(window.mark_and_check(1000000));
+}
+
 TEST(SessionRotatorTests, RotatesAfterThresholds) {
   using namespace std::chrono_literals;
   session::SessionRotator rotator(1s, 2);
@@ -240,4 +240,343 @@ TEST(RetransmitBufferTests, MinMaxRtoClamping) {
   EXPECT_LE(buffer.current_rto().count(), 500);
 }
 
+TEST(RetransmitBufferTests, AcknowledgeRangesDeclaresHolesLost) {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  mux::RetransmitBuffer buffer({}, now_fn);
+  for (std::uint64_t seq = 1; seq <= 100; ++seq) {
+    buffer.insert(seq, {static_cast<std::uint8_t>(seq)});
+  }
+
+  // 10 and 40..49 lost: holes far apart, beyond what a 32-bit bitmap covers.
+  now += 20ms;
+  const std::vector<mux::AckRange> ranges{{50, 100}, {11, 39}, {1, 9}};
+  const auto result = buffer.acknowledge_ranges(ranges, 0us);
+  EXPECT_EQ(result.acked_packets, 89U);
+  EXPECT_EQ(result.acked_bytes, 89U);
+  EXPECT_EQ(result.lost_packets, 11U);
+  EXPECT_EQ(result.largest_lost, 49U);
+  EXPECT_EQ(buffer.pending_count(), 11U);
+
+  // All holes are due immediately, long before the RTO.
+  auto due = buffer.get_packets_to_retransmit();
+  EXPECT_EQ(due.size(), 11U);
+  for (const auto* pkt : due) {
+    EXPECT_TRUE(pkt->lost);
+    EXPECT_TRUE(buffer.mark_retransmitted(pkt->sequence));
+  }
+  EXPECT_TRUE(buffer.get_packets_to_retransmit().empty());
+
+  // A repeated ACK does not declare the retransmitted packets lost again.
+  EXPECT_EQ(buffer.acknowledge_ranges(ranges, 0us).lost_packets, 0U);
+  EXPECT_EQ(buffer.stats().packets_declared_lost, 11U);
+}
+
+TEST(RetransmitBufferTests, AcknowledgeRangesWaitsForReorderThreshold) {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  mux::RetransmitBuffer buffer({}, now_fn);
+  for (std::uint64_t seq = 1; seq <= 4; ++seq) {
+    buffer.insert(seq, {1});
+  }
+  now += 20ms;
+  // 2 is missing but only two later packets are acknowledged: maybe reordered.
+  const std::vector<mux::AckRange> ranges{{3, 4}, {1, 1}};
+  EXPECT_EQ(buffer.acknowledge_ranges(ranges, 0us).lost_packets, 0U);
+
+  buffer.insert(5, {1});
+  const std::vector<mux::AckRange> more{{3, 5}, {1, 1}};
+  EXPECT_EQ(buffer.acknowledge_ranges(more, 0us).lost_packets, 1U);
+}
+
+TEST(RetransmitBufferTests, AcknowledgeRangesSubtractsAckDelay) {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  mux::RetransmitBuffer buffer({}, now_fn);
+  buffer.insert(1, {1});
+  now += 80ms;
+  // The receiver held the packet for 30ms before acknowledging it.
+  const std::vector<mux::AckRange> ranges{{1, 1}};
+  buffer.acknowledge_ranges(ranges, 30ms);
+  EXPECT_EQ(buffer.estimated_rtt(), 50ms);
+}
+
+TEST(RetransmitBufferTests, RateSampleMeasuresDeliveryRate) {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  mux::RetransmitBuffer buffer({}, now_fn);
+  EXPECT_FALSE(buffer.take_rate_sample().has_value());
+
+  // 10 x 1000 bytes, one every millisecond, acknowledged 100 ms after each was sent.
+  for (std::uint64_t seq = 1; seq <= 10; ++seq) {
+    buffer.insert(seq, std::vector<std::uint8_t>(1000));
+    now += 1ms;
+  }
+  now += 90ms;
+  for (std::uint64_t seq = 1; seq <= 10; ++seq) {
+    buffer.acknowledge(seq);
+    if (seq < 10) {
+      now += 1ms;
+    }
+  }
+
+  const auto sample = buffer.take_rate_sample();
+  ASSERT_TRUE(sample.has_value());
+  EXPECT_EQ(sample->delivered, 10000U);
+  EXPECT_EQ(sample->rtt, 100ms);
+  EXPECT_EQ(sample->prior_delivered, 0U);
+  EXPECT_EQ(sample->bytes_in_flight, 0U);
+  // 10 KB over the longer of the 9 ms send and 109 ms ACK intervals.
+  EXPECT_EQ(sample->interval, 109ms);
+  EXPECT_EQ(sample->delivery_rate, 10000U * 1000 / 109);
+  EXPECT_FALSE(buffer.take_rate_sample().has_value());
+
+  // The next flight's sample starts from what was delivered when it was sent.
+  buffer.insert(11, std::vector<std::uint8_t>(1000));
+  now += 100ms;
+  buffer.acknowledge(11);
+  const auto next = buffer.take_rate_sample();
+  ASSERT_TRUE(next.has_value());
+  EXPECT_EQ(next->prior_delivered, 10000U);
+  EXPECT_EQ(next->delivered, 1000U);
+  EXPECT_EQ(next->interval, 100ms);
+}
+
+TEST(RetransmitBufferTests, RateSampleSkipsRttOfRetransmittedPacket) {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  mux::RetransmitConfig config;
+  config.initial_rtt = 100ms;
+  mux::RetransmitBuffer buffer(config, now_fn);
+  buffer.insert(1, std::vector<std::uint8_t>(500));
+  now += 150ms;
+  ASSERT_EQ(buffer.get_packets_to_retransmit().size(), 1U);
+  ASSERT_TRUE(buffer.mark_retransmitted(1));
+  now += 20ms;
+  buffer.acknowledge(1);
+
+  const auto sample = buffer.take_rate_sample();
+  ASSERT_TRUE(sample.has_value());
+  EXPECT_EQ(sample->delivered, 500U);
+  EXPECT_EQ(sample->rtt.count(), 0);  // Ambiguous: the ACK may be for either copy.
+}
+
+TEST(RetransmitBufferTests, RetransmitUnderNewSequenceGivesRttSample) {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  mux::RetransmitConfig config;
+  config.initial_rtt = 100ms;
+  mux::RetransmitBuffer buffer(config, now_fn);
+  buffer.insert(1, std::vector<std::uint8_t>(500));
+  now += 150ms;
+  ASSERT_EQ(buffer.get_packets_to_retransmit().size(), 1U);
+  ASSERT_TRUE(buffer.mark_retransmitted(1, 7));
+  const auto due_later = buffer.get_packets_to_retransmit();
+  EXPECT_TRUE(due_later.empty());
+
+  // Only the retransmission arrives: the ACK names it, so its RTT is known.
+  now += 20ms;
+  const std::vector<mux::AckRange> ranges{{7, 7}};
+  const auto result = buffer.acknowledge_ranges(ranges, 0us);
+  EXPECT_EQ(result.acked_packets, 1U);
+  EXPECT_EQ(result.genuine_losses, 1U);
+  EXPECT_EQ(buffer.estimated_rtt(), 20ms);
+  const auto sample = buffer.take_rate_sample();
+  ASSERT_TRUE(sample.has_value());
+  EXPECT_EQ(sample->rtt, 20ms);
+  EXPECT_EQ(buffer.pending_count(), 0U);
+}
+
+TEST(RetransmitBufferTests, AckOfOldSequenceIsSpuriousLoss) {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  mux::RetransmitConfig config;
+  config.initial_rtt = 100ms;
+  mux::RetransmitBuffer buffer(config, now_fn);
+  buffer.insert(1, {1});
+  buffer.insert(2, {1});
+  now += 150ms;
+  ASSERT_TRUE(buffer.mark_retransmitted(1, 3));
+  ASSERT_TRUE(buffer.mark_retransmitted(2, 4));
+
+  // The originals were only late, however long after the retransmissions they arrive.
+  now += 200ms;
+  const std::vector<mux::AckRange> originals{{1, 2}};
+  const auto result = buffer.acknowledge_ranges(originals, 0us);
+  EXPECT_EQ(result.acked_packets, 2U);
+  EXPECT_EQ(result.spurious_losses, 2U);
+  EXPECT_EQ(buffer.estimated_rtt(), 350ms);
+  EXPECT_EQ(buffer.pending_count(), 0U);
+
+  // Later ACKs of either sequence find nothing.
+  EXPECT_FALSE(buffer.acknowledge(1));
+  EXPECT_FALSE(buffer.acknowledge(3));
+}
+
+TEST(RetransmitBufferTests, RackDeclaresLossAfterReorderWindow) {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  mux::RetransmitBuffer buffer({}, now_fn);
+  buffer.insert(1, {1});
+  now += 1ms;
+  buffer.insert(2, {1});
+  now += 50ms;
+  // Only one later packet is acknowledged: too few for the packet-count rule.
+  const std::vector<mux::AckRange> ranges{{2, 2}};
+  EXPECT_EQ(buffer.acknowledge_ranges(ranges, 0us).lost_packets, 0U);
+
+  // Lost once its send time plus the RTT and min RTT / 4 has passed, before the RTO.
+  now += 11ms;
+  EXPECT_EQ(buffer.detect_lost_packets().lost_packets, 0U);
+  now += 1ms;
+  const auto result = buffer.detect_lost_packets();
+  EXPECT_EQ(result.lost_packets, 1U);
+  EXPECT_EQ(result.largest_lost, 1U);
+  const auto due = buffer.get_packets_to_retransmit();
+  ASSERT_EQ(due.size(), 1U);
+  EXPECT_TRUE(due[0]->lost);
+}
+
+TEST(RetransmitBufferTests, ReorderingWidensWindowAndStopsPacketCount) {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  mux::RetransmitBuffer buffer({}, now_fn);
+  for (std::uint64_t seq = 1; seq <= 5; ++seq) {
+    buffer.insert(seq, {1});
+  }
+  now += 20ms;
+  const std::vector<mux::AckRange> first{{2, 5}};
+  EXPECT_EQ(buffer.acknowledge_ranges(first, 0us).lost_packets, 1U);
+
+  // 1 was only reordered: its original transmission is acknowledged.
+  now += 1ms;
+  const std::vector<mux::AckRange> all{{1, 5}};
+  EXPECT_EQ(buffer.acknowledge_ranges(all, 0us).spurious_losses, 1U);
+  EXPECT_EQ(buffer.stats().spurious_losses, 1U);
+  EXPECT_EQ(buffer.stats().genuine_losses, 0U);
+
+  // The same pattern again is no longer a loss by count, and the time rule now waits
+  // min RTT / 2.
+  for (std::uint64_t seq = 6; seq <= 10; ++seq) {
+    buffer.insert(seq, {1});
+  }
+  now += 20ms;
+  const std::vector<mux::AckRange> second{{7, 10}, {1, 5}};
+  EXPECT_EQ(buffer.acknowledge_ranges(second, 0us).lost_packets, 0U);
+  now += 9ms;
+  EXPECT_EQ(buffer.detect_lost_packets().lost_packets, 0U);
+  now += 1ms;
+  EXPECT_EQ(buffer.detect_lost_packets().lost_packets, 1U);
+}
+
+TEST(RetransmitBufferTests, SpuriousAndGenuineTimeoutsAreCounted) {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  mux::RetransmitBuffer buffer({}, now_fn);
+  buffer.insert(1, {1});
+  now += 50ms;
+  const std::vector<mux::AckRange> warmup{{1, 1}};
+  buffer.acknowledge_ranges(warmup, 0us);
+  ASSERT_EQ(buffer.current_rto(), 150ms);
+
+  buffer.insert(2, {1});
+  buffer.insert(3, {1});
+  now += 150ms;
+  for (const auto* pkt : buffer.get_packets_to_retransmit()) {
+    EXPECT_FALSE(pkt->probe);
+    EXPECT_TRUE(buffer.mark_retransmitted(pkt->sequence));
+  }
+  EXPECT_EQ(buffer.suspected_count(), 2U);
+
+  // 2 is acknowledged sooner than any retransmission could be: the timeout was spurious.
+  now += 10ms;
+  const std::vector<mux::AckRange> two{{2, 2}, {1, 1}};
+  const auto spurious = buffer.acknowledge_ranges(two, 0us);
+  EXPECT_EQ(spurious.spurious_losses, 1U);
+  EXPECT_EQ(spurious.lost_packets, 0U);
+
+  // 3 only arrives a round trip after its retransmission: it was really lost.
+  now += 40ms;
+  const std::vector<mux::AckRange> three{{1, 3}};
+  EXPECT_EQ(buffer.acknowledge_ranges(three, 0us).genuine_losses, 1U);
+  EXPECT_EQ(buffer.stats().spurious_losses, 1U);
+  EXPECT_EQ(buffer.stats().genuine_losses, 1U);
+  EXPECT_EQ(buffer.suspected_count(), 0U);
+}
+
+TEST(RetransmitBufferTests, SuspectedCountFollowsRetransmittedPackets) {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  mux::RetransmitBuffer buffer({}, now_fn);
+  for (std::uint64_t seq = 1; seq <= 6; ++seq) {
+    buffer.insert(seq, {1});
+  }
+  now += 20ms;
+  const std::vector<mux::AckRange> tail{{4, 6}};
+  ASSERT_EQ(buffer.acknowledge_ranges(tail, 0us).lost_packets, 3U);
+  EXPECT_EQ(buffer.suspected_count(), 3U);
+  ASSERT_TRUE(buffer.mark_retransmitted(1, 7));
+  ASSERT_TRUE(buffer.mark_retransmitted(2, 8));
+  EXPECT_EQ(buffer.suspected_count(), 3U);
+
+  // Dropped under its new sequence, acknowledged under its old one.
+  buffer.drop_packet(8);
+  EXPECT_EQ(buffer.suspected_count(), 2U);
+  buffer.acknowledge_cumulative(1);
+  EXPECT_EQ(buffer.suspected_count(), 1U);
+  const std::vector<mux::AckRange> three{{3, 3}};
+  EXPECT_EQ(buffer.acknowledge_ranges(three, 0us).acked_packets, 1U);
+  EXPECT_EQ(buffer.suspected_count(), 0U);
+  EXPECT_EQ(buffer.pending_count(), 0U);
+}
+
+TEST(RetransmitBufferTests, TailLossProbeResendsNewestPacket) {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  mux::RetransmitConfig config;
+  config.min_rto = 200ms;
+  mux::RetransmitBuffer buffer(config, now_fn);
+  buffer.insert(1, {1});
+  now += 20ms;
+  const std::vector<mux::AckRange> warmup{{1, 1}};
+  buffer.acknowledge_ranges(warmup, 0us);
+
+  // The tail of a burst is lost: no later packet is acknowledged to reveal it.
+  buffer.insert(2, {1});
+  buffer.insert(3, {1});
+  now += 39ms;
+  EXPECT_TRUE(buffer.get_packets_to_retransmit().empty());
+
+  // Two smoothed RTTs without an ACK: probe with the newest packet, long before the RTO.
+  now += 1ms;
+  auto due = buffer.get_packets_to_retransmit();
+  ASSERT_EQ(due.size(), 1U);
+  EXPECT_EQ(due[0]->sequence, 3U);
+  EXPECT_TRUE(due[0]->probe);
+  EXPECT_TRUE(buffer.mark_retransmitted(3));
+  EXPECT_EQ(buffer.stats().tail_loss_probes, 1U);
+  EXPECT_EQ(buffer.suspected_count(), 0U);  // A probe is not a loss.
+  now += 1ms;
+  EXPECT_TRUE(buffer.get_packets_to_retransmit().empty());
+
+  // The probe's ACK shows 2 missing, and RACK declares it lost at once.
+  now += 19ms;
+  const std::vector<mux::AckRange> probe_ack{{3, 3}, {1, 1}};
+  const auto result = buffer.acknowledge_ranges(probe_ack, 0us);
+  EXPECT_EQ(result.lost_packets, 1U);
+  EXPECT_EQ(result.largest_lost, 2U);
+}
+
 }  // namespace veil::tests
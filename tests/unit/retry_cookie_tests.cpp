@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/handshake/handshake_processor.h"
+#include "common/handshake/retry_cookie.h"
+#include "common/utils/graceful_degradation.h"
+#include "common/utils/rate_limiter.h"
+
+namespace veil::tests {
+
+namespace {
+std::vector<std::uint8_t> make_psk() { return std::vector<std::uint8_t>(32, 0xAA); }
+}  // namespace
+
+class RetryCookieTest : public ::testing::Test {
+ protected:
+  using Clock = handshake::RetryCookieGenerator::Clock;
+
+  Clock::time_point now() const { return now_; }
+
+  Clock::time_point now_{std::chrono::hours(1000)};
+};
+
+TEST_F(RetryCookieTest, IssuedCookieVerifiesForSameSource) {
+  handshake::RetryCookieGenerator gen(std::chrono::seconds(10), [this] { return now(); });
+  const auto cookie = gen.issue("192.0.2.1:5000");
+  EXPECT_TRUE(gen.verify(cookie, "192.0.2.1:5000"));
+}
+
+TEST_F(RetryCookieTest, CookieBoundToSourceAddressAndPort) {
+  handshake::RetryCookieGenerator gen(std::chrono::seconds(10), [this] { return now(); });
+  const auto cookie = gen.issue("192.0.2.1:5000");
+  EXPECT_FALSE(gen.verify(cookie, "192.0.2.2:5000"));
+  EXPECT_FALSE(gen.verify(cookie, "192.0.2.1:5001"));
+}
+
+TEST_F(RetryCookieTest, CookieExpiresAfterTwoWindows) {
+  handshake::RetryCookieGenerator gen(std::chrono::seconds(10), [this] { return now(); });
+  const auto cookie = gen.issue("192.0.2.1:5000");
+
+  now_ += std::chrono::seconds(10);
+  EXPECT_TRUE(gen.verify(cookie, "192.0.2.1:5000"));
+
+  now_ += std::chrono::seconds(10);
+  EXPECT_FALSE(gen.verify(cookie, "192.0.2.1:5000"));
+}
+
+TEST_F(RetryCookieTest, CookiesFromAnotherServerRejected) {
+  handshake::RetryCookieGenerator gen_a(std::chrono::seconds(10), [this] { return now(); });
+  handshake::RetryCookieGenerator gen_b(std::chrono::seconds(10), [this] { return now(); });
+  EXPECT_FALSE(gen_b.verify(gen_a.issue("192.0.2.1:5000"), "192.0.2.1:5000"));
+}
+
+TEST_F(RetryCookieTest, StripReturnsInitAfterCookie) {
+  handshake::RetryCookieGenerator gen(std::chrono::seconds(10), [this] { return now(); });
+  const auto cookie = gen.issue("192.0.2.1:5000");
+
+  std::vector<std::uint8_t> packet(cookie.begin(), cookie.end());
+  packet.insert(packet.end(), {1, 2, 3, 4});
+
+  auto init = gen.strip(packet, "192.0.2.1:5000");
+  ASSERT_TRUE(init.has_value());
+  EXPECT_EQ(std::vector<std::uint8_t>(init->begin(), init->end()),
+            (std::vector<std::uint8_t>{1, 2, 3, 4}));
+
+  EXPECT_FALSE(gen.strip(std::vector<std::uint8_t>(64, 0x11), "192.0.2.1:5000").has_value());
+  EXPECT_FALSE(gen.strip(cookie, "192.0.2.1:5000").has_value());
+}
+
+TEST(HandshakeRetryTest, RetryRoundTripCompletesHandshake) {
+  handshake::RetryCookieGenerator gen;
+  handshake::HandshakeInitiator initiator(make_psk(), std::chrono::milliseconds(1000));
+  handshake::HandshakeResponder responder(make_psk(), std::chrono::milliseconds(1000),
+                                          utils::TokenBucket(10.0, std::chrono::milliseconds(100)));
+  const std::string source = "192.0.2.1:5000";
+
+  // First INIT carries no cookie: server answers with a RETRY, never larger than the INIT.
+  const auto init1 = initiator.create_init();
+  EXPECT_FALSE(gen.strip(init1, source).has_value());
+  const auto retry = responder.create_retry(gen.issue(source), init1.size());
+  ASSERT_FALSE(retry.empty());
+  EXPECT_LE(retry.size(), init1.size());
+
+  // A RETRY is not a RESPONSE.
+  EXPECT_FALSE(initiator.consume_response(retry).has_value());
+  ASSERT_TRUE(initiator.consume_retry(retry));
+
+  // Second INIT echoes the cookie; the server strips it and runs the real handshake.
+  const auto init2 = initiator.create_init();
+  EXPECT_GT(init2.size(), handshake::kRetryCookieSize);
+  auto stripped = gen.strip(init2, source);
+  ASSERT_TRUE(stripped.has_value());
+  auto result = responder.handle_init(*stripped);
+  ASSERT_TRUE(result.has_value());
+  auto session = initiator.consume_response(result->response);
+  ASSERT_TRUE(session.has_value());
+  EXPECT_EQ(session->session_id, result->session.session_id);
+
+  // The cookie is echoed only once.
+  const auto init3 = initiator.create_init();
+  EXPECT_FALSE(gen.strip(init3, source).has_value());
+}
+
+TEST(HandshakeRetryTest, ZeroRttRetryKeepsTicketAndResumes) {
+  handshake::RetryCookieGenerator gen;
+  handshake::HandshakeResponder responder(make_psk(), std::chrono::milliseconds(1000),
+                                          utils::TokenBucket(10.0, std::chrono::milliseconds(100)));
+  auto ticket_manager =
+      std::make_shared<handshake::SessionTicketManager>(std::chrono::milliseconds(60000));
+  handshake::ZeroRttResponder zero_rtt_responder(
+      make_psk(), ticket_manager, std::chrono::milliseconds(1000),
+      utils::TokenBucket(10.0, std::chrono::milliseconds(100)));
+  const std::string source = "192.0.2.1:5000";
+
+  handshake::HandshakeInitiator full(make_psk(), std::chrono::milliseconds(1000));
+  auto first = responder.handle_init(full.create_init());
+  ASSERT_TRUE(first.has_value());
+  auto session = full.consume_response(first->response);
+  ASSERT_TRUE(session.has_value());
+
+  handshake::ZeroRttInitiator initiator(make_psk(), ticket_manager->issue_ticket(session->keys));
+  const std::vector<std::vector<std::uint8_t>> early_data{{1, 2, 3}};
+
+  // The server requires a cookie: the first 0-RTT INIT gets a RETRY, which is not a REJECT.
+  const auto init1 = initiator.create_zero_rtt_init(early_data);
+  EXPECT_FALSE(gen.strip(init1, source).has_value());
+  const auto retry = responder.create_retry(gen.issue(source), init1.size());
+  ASSERT_FALSE(retry.empty());
+  EXPECT_FALSE(initiator.consume_zero_rtt_response(retry).has_value());
+  EXPECT_FALSE(initiator.was_rejected());
+  ASSERT_TRUE(initiator.consume_retry(retry));
+
+  // The resent 0-RTT INIT echoes the cookie, and the same ticket resumes.
+  const auto init2 = initiator.create_zero_rtt_init(early_data);
+  auto stripped = gen.strip(init2, source);
+  ASSERT_TRUE(stripped.has_value());
+  auto result = zero_rtt_responder.handle_zero_rtt_init(*stripped);
+  ASSERT_TRUE(result.has_value());
+  EXPECT_TRUE(result->accepted);
+  EXPECT_EQ(result->early_data, early_data);
+  auto resumed = initiator.consume_zero_rtt_response(result->response);
+  ASSERT_TRUE(resumed.has_value());
+  EXPECT_EQ(resumed->keys.send_key, session->keys.send_key);
+  EXPECT_EQ(initiator.early_data_packets(), 1U);
+}
+
+TEST(HandshakeRetryTest, RetryWithWrongPskRejected) {
+  handshake::HandshakeInitiator initiator(make_psk(), std::chrono::milliseconds(1000));
+  handshake::HandshakeResponder responder(std::vector<std::uint8_t>(32, 0xBB),
+                                          std::chrono::milliseconds(1000),
+                                          utils::TokenBucket(10.0, std::chrono::milliseconds(100)));
+  const auto init = initiator.create_init();
+  const auto retry = responder.create_retry(handshake::RetryCookie{}, init.size());
+  EXPECT_FALSE(initiator.consume_retry(retry));
+}
+
+TEST(HandshakeRetryTest, RetryNotSentForTinyInit) {
+  handshake::HandshakeResponder responder(make_psk(), std::chrono::milliseconds(1000),
+                                          utils::TokenBucket(10.0, std::chrono::milliseconds(100)));
+  EXPECT_TRUE(responder.create_retry(handshake::RetryCookie{}, 40).empty());
+}
+
+TEST(HandshakeRetryTest, DegradationLevelDrivesCookieRequirement) {
+  EXPECT_FALSE(utils::get_default_actions(utils::DegradationLevel::kNormal).require_handshake_cookie);
+  EXPECT_FALSE(utils::get_default_actions(utils::DegradationLevel::kLight).require_handshake_cookie);
+  EXPECT_TRUE(utils::get_default_actions(utils::DegradationLevel::kModerate).require_handshake_cookie);
+  EXPECT_TRUE(utils::get_default_actions(utils::DegradationLevel::kCritical).require_handshake_cookie);
+}
+
+TEST(HandshakeRetryTest, HandshakeQueuePressureEscalatesDegradation) {
+  auto now = std::chrono::steady_clock::now();
+  utils::DegradationConfig config;
+  config.escalation_delay = std::chrono::seconds(0);
+  config.recovery_delay = std::chrono::seconds(0);
+  utils::GracefulDegradation degradation(config, {}, [&now] { return now; });
+
+  utils::SystemMetrics metrics;
+  metrics.max_packet_queue = 256;
+  metrics.pending_packets = 256;
+  degradation.update(metrics);
+  EXPECT_EQ(degradation.level(), utils::DegradationLevel::kCritical);
+  EXPECT_TRUE(degradation.current_actions().require_handshake_cookie);
+
+  // Recovery waits until the queue has drained below the moderate threshold.
+  metrics.pending_packets = 10;
+  now += std::chrono::seconds(1);
+  degradation.update(metrics);
+  EXPECT_EQ(degradation.level(), utils::DegradationLevel::kNormal);
+}
+
+}  // namespace veil::tests
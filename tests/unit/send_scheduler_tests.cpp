@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "transport/mux/send_scheduler.h"
+
+namespace veil::tests {
+
+namespace {
+
+// IPv4 packet of the given size, DSCP, protocol and ports.
+std::vector<std::uint8_t> ipv4(std::size_t size, std::uint8_t dscp, std::uint8_t protocol,
+                               std::uint16_t source_port, std::uint16_t destination_port) {
+  std::vector<std::uint8_t> packet(size, 0);
+  packet[0] = 0x45;
+  packet[1] = static_cast<std::uint8_t>(dscp << 2);
+  packet[9] = protocol;
+  packet[20] = static_cast<std::uint8_t>(source_port >> 8);
+  packet[21] = static_cast<std::uint8_t>(source_port);
+  packet[22] = static_cast<std::uint8_t>(destination_port >> 8);
+  packet[23] = static_cast<std::uint8_t>(destination_port);
+  return packet;
+}
+
+std::vector<std::uint8_t> tagged(std::size_t size, std::uint8_t tag) {
+  return std::vector<std::uint8_t>(size, tag);
+}
+
+// A clock that stands still, so CoDel never sees a packet wait.
+mux::SendScheduler::TimePoint frozen_clock() { return mux::SendScheduler::TimePoint{}; }
+
+}  // namespace
+
+TEST(SendSchedulerTests, ClassifiesByDscpPortsAndSize) {
+  constexpr std::size_t kSmall = 256;
+  using mux::TrafficClass;
+  // DSCP marks win over everything else.
+  EXPECT_EQ(mux::classify_ip_packet(ipv4(1200, 46, 17, 40000, 40002), kSmall),
+            TrafficClass::kInteractive);
+  EXPECT_EQ(mux::classify_ip_packet(ipv4(100, 8, 6, 40000, 22), kSmall), TrafficClass::kBulk);
+  // Well-known interactive ports, either direction.
+  EXPECT_EQ(mux::classify_ip_packet(ipv4(600, 0, 6, 22, 51000), kSmall),
+            TrafficClass::kInteractive);
+  EXPECT_EQ(mux::classify_ip_packet(ipv4(300, 0, 17, 51000, 53), kSmall),
+            TrafficClass::kInteractive);
+  // Small packets (TCP ACKs) are interactive, full-size HTTPS is not.
+  EXPECT_EQ(mux::classify_ip_packet(ipv4(52, 0, 6, 443, 51000), kSmall),
+            TrafficClass::kInteractive);
+  EXPECT_EQ(mux::classify_ip_packet(ipv4(1400, 0, 6, 443, 51000), kSmall),
+            TrafficClass::kDefault);
+
+  // IPv6 traffic class: EF.
+  std::vector<std::uint8_t> v6(1200, 0);
+  v6[0] = 0x6B;
+  v6[1] = 0x80;
+  v6[6] = 17;
+  EXPECT_EQ(mux::classify_ip_packet(v6, kSmall), TrafficClass::kInteractive);
+  EXPECT_EQ(mux::classify_ip_packet(std::vector<std::uint8_t>(1200, 0), kSmall),
+            TrafficClass::kDefault);
+}
+
+TEST(SendSchedulerTests, InteractivePacketSkipsBulkBacklog) {
+  mux::SendScheduler scheduler({}, frozen_clock);
+  for (int i = 0; i < 100; ++i) {
+    scheduler.enqueue(mux::TrafficClass::kDefault, tagged(1400, 1));
+  }
+  // Two default packets out, then an interactive one arrives.
+  ASSERT_TRUE(scheduler.dequeue().has_value());
+  ASSERT_TRUE(scheduler.dequeue().has_value());
+  scheduler.enqueue(mux::TrafficClass::kInteractive, tagged(200, 2));
+
+  // Served within one round: at most weight * quantum bytes of default traffic first.
+  int before = 0;
+  for (;;) {
+    const auto packet = scheduler.dequeue();
+    ASSERT_TRUE(packet.has_value());
+    if ((*packet)[0] == 2) {
+      break;
+    }
+    ++before;
+  }
+  EXPECT_LE(before, 2);
+  EXPECT_EQ(scheduler.queued_packets(), 98U - static_cast<std::size_t>(before));
+}
+
+TEST(SendSchedulerTests, BackloggedClassesShareByWeight) {
+  mux::SendScheduler scheduler(
+      mux::SendSchedulerConfig{
+          .weights = {4, 2, 1}, .quantum = 1000, .max_queued_bytes = 1024 * 1024},
+      frozen_clock);
+  for (int i = 0; i < 300; ++i) {
+    scheduler.enqueue(mux::TrafficClass::kInteractive, tagged(1000, 0));
+    scheduler.enqueue(mux::TrafficClass::kDefault, tagged(1000, 1));
+    scheduler.enqueue(mux::TrafficClass::kBulk, tagged(1000, 2));
+  }
+  std::size_t sent[3] = {0, 0, 0};
+  for (int i = 0; i < 350; ++i) {
+    ++sent[(*scheduler.dequeue())[0]];
+  }
+  EXPECT_NEAR(static_cast<double>(sent[0]) / static_cast<double>(sent[2]), 4.0, 0.2);
+  EXPECT_NEAR(static_cast<double>(sent[1]) / static_cast<double>(sent[2]), 2.0, 0.2);
+}
+
+TEST(SendSchedulerTests, FullBacklogDropsFromLongestClass) {
+  mux::SendScheduler scheduler(mux::SendSchedulerConfig{.max_queued_bytes = 10000},
+                               frozen_clock);
+  scheduler.enqueue(mux::TrafficClass::kInteractive, tagged(500, 0));
+  for (int i = 0; i < 9; ++i) {
+    scheduler.enqueue(mux::TrafficClass::kDefault, tagged(1000, 1));
+  }
+  EXPECT_EQ(scheduler.stats().packets_dropped[1], 0U);
+  // Over the limit: the default class is longest, so one of its packets goes.
+  scheduler.enqueue(mux::TrafficClass::kDefault, tagged(1000, 1));
+  // An interactive packet gets in at the expense of a default one.
+  scheduler.enqueue(mux::TrafficClass::kInteractive, tagged(600, 0));
+  EXPECT_LE(scheduler.queued_bytes(), 10000U);
+  EXPECT_EQ(scheduler.queued_packets(), 10U);
+  EXPECT_EQ(scheduler.stats().packets_dropped[1], 2U);
+  EXPECT_EQ(scheduler.stats().packets_dropped[0], 0U);
+  EXPECT_EQ(scheduler.fq_codel_stats().overlimit_drops, 2U);
+}
+
+TEST(SendSchedulerTests, BackloggedAboveBackpressureBytes) {
+  mux::SendScheduler scheduler(mux::SendSchedulerConfig{.backpressure_bytes = 3000},
+                               frozen_clock);
+  scheduler.enqueue(mux::TrafficClass::kDefault, tagged(1400, 1));
+  scheduler.enqueue(mux::TrafficClass::kDefault, tagged(1400, 1));
+  EXPECT_FALSE(scheduler.backlogged());
+  scheduler.enqueue(mux::TrafficClass::kDefault, tagged(1400, 1));
+  EXPECT_TRUE(scheduler.backlogged());
+  ASSERT_TRUE(scheduler.dequeue().has_value());
+  EXPECT_FALSE(scheduler.backlogged());
+}
+
+}  // namespace veil::tests
@@ -3,6 +3,9 @@
 #include <array>
 #include <chrono>
 #include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
 #include <string>
 #include <vector>
 
@@ -29,6 +32,28 @@ crypto::SessionKeys make_test_keys() {
   return keys;
 }
 
+std::uint64_t to_ms(std::chrono::system_clock::time_point tp) {
+  return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count());
+}
+
+// Per-test scratch file, removed on destruction.
+class TempFile {
+ public:
+  explicit TempFile(const std::string& name)
+      : path_((std::filesystem::temp_directory_path() / name).string()) {
+    std::filesystem::remove(path_);
+  }
+  ~TempFile() {
+    std::error_code ec;
+    std::filesystem::remove(path_, ec);
+  }
+  const std::string& path() const { return path_; }
+
+ private:
+  std::string path_;
+};
+
 }  // namespace
 
 // =============================================================================
@@ -176,6 +201,24 @@ TEST(SessionTicketManagerTests, AntiReplayNonceDetectsReplay) {
   EXPECT_TRUE(manager.check_and_mark_nonce(nonce));
 }
 
+TEST(SessionTicketManagerTests, AntiReplayNonceDetectedAcrossEpochBoundary) {
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  // 60 s lifetime: the nonce table rotates 20 s epochs.
+  handshake::SessionTicketManager manager(std::chrono::milliseconds(60000), now_fn);
+
+  std::array<std::uint8_t, handshake::kAntiReplayNonceSize> nonce{};
+  nonce.fill(0x5A);
+  EXPECT_FALSE(manager.check_and_mark_nonce(nonce));
+
+  // Replayed in the next epochs, still inside the ticket lifetime.
+  now += std::chrono::seconds(25);
+  EXPECT_TRUE(manager.check_and_mark_nonce(nonce));
+  now += std::chrono::seconds(30);
+  EXPECT_TRUE(manager.check_and_mark_nonce(nonce));
+}
+
 TEST(SessionTicketManagerTests, DifferentNoncesNotDetectedAsReplay) {
   auto now = std::chrono::system_clock::now();
   auto now_fn = [&]() { return now; };
@@ -381,4 +424,207 @@ TEST(SessionTicketTests, IsExpiredReturnsTrueWhenExpired) {
   EXPECT_TRUE(ticket.is_expired(10000));  // Well after expiry
 }
 
+// =============================================================================
+// Ticket Key Rotation and Persistence Tests
+// =============================================================================
+
+TEST(SessionTicketKeyTests, PreviousKeyAcceptedAfterOneRotation) {
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  handshake::SessionTicketManager manager(std::chrono::milliseconds(60000), now_fn);
+  auto ticket = manager.issue_ticket(make_test_keys());
+
+  manager.rotate_keys();
+  EXPECT_TRUE(manager.validate_ticket(ticket.ticket_data).has_value());
+
+  // New tickets use the new key and validate too.
+  auto fresh = manager.issue_ticket(make_test_keys());
+  EXPECT_TRUE(manager.validate_ticket(fresh.ticket_data).has_value());
+
+  // Two rotations retire the original key.
+  manager.rotate_keys();
+  EXPECT_FALSE(manager.validate_ticket(ticket.ticket_data).has_value());
+  EXPECT_TRUE(manager.validate_ticket(fresh.ticket_data).has_value());
+}
+
+TEST(SessionTicketKeyTests, MaybeRotateHonoursInterval) {
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  handshake::SessionTicketManager manager(std::chrono::milliseconds(60000), now_fn,
+                                          std::chrono::milliseconds(10000));
+  auto ticket = manager.issue_ticket(make_test_keys());
+
+  now += std::chrono::seconds(5);
+  EXPECT_FALSE(manager.maybe_rotate_keys());
+
+  now += std::chrono::seconds(5);
+  EXPECT_TRUE(manager.maybe_rotate_keys());
+  EXPECT_FALSE(manager.maybe_rotate_keys());
+  EXPECT_TRUE(manager.validate_ticket(ticket.ticket_data).has_value());
+}
+
+TEST(SessionTicketKeyTests, RestartedManagerAcceptsPersistedKeys) {
+  TempFile file("veil_ticket_keys_test.bin");
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  std::vector<std::uint8_t> ticket_data;
+  std::vector<std::uint8_t> old_ticket_data;
+  {
+    handshake::SessionTicketManager manager(std::chrono::milliseconds(60000), now_fn);
+    std::error_code ec;
+    ASSERT_TRUE(manager.load_or_create_keys(file.path(), ec)) << ec.message();
+    old_ticket_data = manager.issue_ticket(make_test_keys()).ticket_data;
+    manager.rotate_keys();
+    ticket_data = manager.issue_ticket(make_test_keys(), "client").ticket_data;
+    ASSERT_TRUE(manager.save_keys(file.path(), ec)) << ec.message();
+  }
+
+  // Simulated restart: a fresh manager has a new random key until it loads.
+  handshake::SessionTicketManager restarted(std::chrono::milliseconds(60000), now_fn);
+  EXPECT_FALSE(restarted.validate_ticket(ticket_data).has_value());
+
+  std::error_code ec;
+  ASSERT_TRUE(restarted.load_or_create_keys(file.path(), ec)) << ec.message();
+  auto payload = restarted.validate_ticket(ticket_data);
+  ASSERT_TRUE(payload.has_value());
+  EXPECT_EQ(payload->send_key, make_test_keys().send_key);
+  EXPECT_TRUE(restarted.validate_ticket(old_ticket_data).has_value());
+
+  EXPECT_EQ(std::filesystem::status(file.path()).permissions() & std::filesystem::perms::all,
+            std::filesystem::perms::owner_read | std::filesystem::perms::owner_write);
+}
+
+TEST(SessionTicketKeyTests, SaveIgnoresPreexistingTempFile) {
+  TempFile file("veil_ticket_keys_tmp_test.bin");
+  TempFile decoy("veil_ticket_keys_tmp_test.bin.tmp");
+  {
+    std::ofstream out(decoy.path(), std::ios::binary);
+    out << "decoy";
+  }
+  handshake::SessionTicketManager manager;
+  std::error_code ec;
+  ASSERT_TRUE(manager.save_keys(file.path(), ec)) << ec.message();
+
+  // The keys never pass through a file someone else could have created or opened.
+  std::ifstream in(decoy.path(), std::ios::binary);
+  const std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  EXPECT_EQ(contents, "decoy");
+  EXPECT_EQ(std::filesystem::status(file.path()).permissions() & std::filesystem::perms::all,
+            std::filesystem::perms::owner_read | std::filesystem::perms::owner_write);
+}
+
+TEST(SessionTicketKeyTests, CorruptKeyFileRejected) {
+  TempFile file("veil_ticket_keys_corrupt_test.bin");
+  {
+    std::ofstream out(file.path(), std::ios::binary);
+    out << "not a key file";
+  }
+  handshake::SessionTicketManager manager;
+  auto ticket = manager.issue_ticket(make_test_keys());
+
+  std::error_code ec;
+  EXPECT_FALSE(manager.load_keys(file.path(), ec));
+  EXPECT_TRUE(ec);
+  // The existing key ring is left untouched.
+  EXPECT_TRUE(manager.validate_ticket(ticket.ticket_data).has_value());
+}
+
+TEST(SessionTicketStoreTests, SaveAndLoadRoundTrip) {
+  TempFile file("veil_ticket_store_test.bin");
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+  const std::vector<std::uint8_t> psk(32, 0x5A);
+  const auto storage_key = handshake::SessionTicketStore::derive_storage_key(psk);
+
+  handshake::SessionTicketManager manager(std::chrono::milliseconds(60000), now_fn);
+  handshake::SessionTicketStore store(now_fn);
+  store.store_ticket("server1:4430", manager.issue_ticket(make_test_keys(), "alice"));
+  store.store_ticket("server2:4430", manager.issue_ticket(make_test_keys()));
+
+  std::error_code ec;
+  ASSERT_TRUE(store.save(file.path(), storage_key, ec)) << ec.message();
+
+  handshake::SessionTicketStore reloaded(now_fn);
+  ASSERT_TRUE(reloaded.load(file.path(), storage_key, ec)) << ec.message();
+  EXPECT_EQ(reloaded.size(), 2u);
+
+  auto ticket = reloaded.get_ticket("server1:4430");
+  ASSERT_TRUE(ticket.has_value());
+  EXPECT_EQ(ticket->client_id, "alice");
+  EXPECT_EQ(ticket->lifetime_ms, 60000u);
+  EXPECT_EQ(ticket->cached_keys.send_key, make_test_keys().send_key);
+  EXPECT_EQ(ticket->cached_keys.recv_nonce, make_test_keys().recv_nonce);
+  EXPECT_TRUE(manager.validate_ticket(ticket->ticket_data).has_value());
+}
+
+TEST(SessionTicketStoreTests, LoadWithWrongKeyFails) {
+  TempFile file("veil_ticket_store_wrong_key_test.bin");
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  handshake::SessionTicketStore store(now_fn);
+  store.store_ticket("server1:4430", handshake::SessionTicket{
+                                         .ticket_data = {1, 2, 3},
+                                         .issued_at_ms = to_ms(now),
+                                         .lifetime_ms = 60000,
+                                         .cached_keys = make_test_keys(),
+                                         .client_id = {},
+                                     });
+
+  std::error_code ec;
+  const std::vector<std::uint8_t> psk(32, 0x11);
+  const std::vector<std::uint8_t> other_psk(32, 0x22);
+  ASSERT_TRUE(store.save(file.path(), handshake::SessionTicketStore::derive_storage_key(psk), ec));
+
+  handshake::SessionTicketStore reloaded(now_fn);
+  EXPECT_FALSE(
+      reloaded.load(file.path(), handshake::SessionTicketStore::derive_storage_key(other_psk), ec));
+  EXPECT_TRUE(ec);
+  EXPECT_EQ(reloaded.size(), 0u);
+}
+
+TEST(SessionTicketStoreTests, LoadSkipsExpiredTickets) {
+  TempFile file("veil_ticket_store_expired_test.bin");
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+  const auto storage_key =
+      handshake::SessionTicketStore::derive_storage_key(std::vector<std::uint8_t>(32, 0x33));
+
+  handshake::SessionTicketStore store(now_fn);
+  auto make_ticket = [&](std::uint64_t lifetime_ms) {
+    return handshake::SessionTicket{
+        .ticket_data = {1, 2, 3},
+        .issued_at_ms = to_ms(now),
+        .lifetime_ms = lifetime_ms,
+        .cached_keys = make_test_keys(),
+        .client_id = {},
+    };
+  };
+  store.store_ticket("short:4430", make_ticket(1000));
+  store.store_ticket("long:4430", make_ticket(60000));
+
+  std::error_code ec;
+  ASSERT_TRUE(store.save(file.path(), storage_key, ec));
+
+  now += std::chrono::seconds(5);
+  handshake::SessionTicketStore reloaded(now_fn);
+  ASSERT_TRUE(reloaded.load(file.path(), storage_key, ec));
+  EXPECT_EQ(reloaded.size(), 1u);
+  EXPECT_TRUE(reloaded.get_ticket("long:4430").has_value());
+}
+
+TEST(SessionTicketStoreTests, LoadMissingFileIsEmpty) {
+  TempFile file("veil_ticket_store_missing_test.bin");
+  handshake::SessionTicketStore store;
+  std::error_code ec;
+  const auto storage_key =
+      handshake::SessionTicketStore::derive_storage_key(std::vector<std::uint8_t>(32, 0x44));
+  EXPECT_TRUE(store.load(file.path(), storage_key, ec));
+  EXPECT_FALSE(ec);
+  EXPECT_EQ(store.size(), 0u);
+}
+
 }  // namespace veil::tests
@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/handshake/handshake_processor.h"
+#include "common/utils/rate_limiter.h"
+#include "common/utils/source_admission.h"
+
+namespace veil::tests {
+
+class SourceAdmissionTest : public ::testing::Test {
+ protected:
+  using Clock = utils::SourceAdmissionFilter::Clock;
+
+  utils::SourceAdmissionConfig make_config(std::uint16_t threshold) const {
+    utils::SourceAdmissionConfig config;
+    config.threshold = threshold;
+    config.decay_interval = std::chrono::milliseconds(1000);
+    return config;
+  }
+
+  Clock::time_point now_{std::chrono::hours(1)};
+};
+
+TEST_F(SourceAdmissionTest, AdmitsUpToThresholdThenDrops) {
+  utils::SourceAdmissionFilter filter(make_config(8), [this] { return now_; });
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_TRUE(filter.admit_host("198.51.100.7")) << "attempt " << i;
+  }
+  EXPECT_FALSE(filter.admit_host("198.51.100.7"));
+  EXPECT_EQ(filter.admitted(), 8U);
+  EXPECT_EQ(filter.dropped(), 1U);
+}
+
+TEST_F(SourceAdmissionTest, SourcesInSamePrefixShareBudget) {
+  utils::SourceAdmissionFilter filter(make_config(4), [this] { return now_; });
+  EXPECT_TRUE(filter.admit_host("198.51.100.1"));
+  EXPECT_TRUE(filter.admit_host("198.51.100.2"));
+  EXPECT_TRUE(filter.admit_host("198.51.100.3"));
+  EXPECT_TRUE(filter.admit_host("198.51.100.4"));
+  EXPECT_FALSE(filter.admit_host("198.51.100.200"));
+
+  // A different /24 is unaffected.
+  EXPECT_TRUE(filter.admit_host("198.51.101.1"));
+  EXPECT_TRUE(filter.admit_host("203.0.113.9"));
+}
+
+TEST_F(SourceAdmissionTest, Ipv6GroupedBySlash48) {
+  utils::SourceAdmissionFilter filter(make_config(2), [this] { return now_; });
+  EXPECT_TRUE(filter.admit_host("2001:db8:1:1::1"));
+  EXPECT_TRUE(filter.admit_host("2001:db8:1:ffff::2"));
+  EXPECT_FALSE(filter.admit_host("2001:db8:1:2::3"));
+  EXPECT_TRUE(filter.admit_host("2001:db8:2::1"));
+}
+
+TEST_F(SourceAdmissionTest, PrefixKeyNormalizesAddresses) {
+  utils::SourceAdmissionFilter filter(make_config(8), [this] { return now_; });
+  EXPECT_EQ(filter.prefix_key("192.0.2.1"), filter.prefix_key("192.0.2.254"));
+  EXPECT_NE(filter.prefix_key("192.0.2.1"), filter.prefix_key("192.0.3.1"));
+  EXPECT_EQ(filter.prefix_key("::ffff:192.0.2.1"), filter.prefix_key("192.0.2.9"));
+  EXPECT_EQ(filter.prefix_key("[2001:db8::1]"), filter.prefix_key("2001:db8::2"));
+  EXPECT_FALSE(filter.prefix_key("not-an-address").has_value());
+  EXPECT_FALSE(filter.prefix_key("").has_value());
+
+  // Unparseable hosts are not grouped and therefore never dropped.
+  EXPECT_TRUE(filter.admit_host("not-an-address"));
+}
+
+TEST_F(SourceAdmissionTest, CountersDecayOverTime) {
+  utils::SourceAdmissionFilter filter(make_config(8), [this] { return now_; });
+  const auto key = *filter.prefix_key("198.51.100.7");
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_TRUE(filter.admit(key));
+  }
+  EXPECT_FALSE(filter.admit(key));
+  EXPECT_EQ(filter.estimate(key), 8);
+
+  // One interval halves the counters: half the burst is available again.
+  now_ += std::chrono::milliseconds(1000);
+  EXPECT_TRUE(filter.admit(key));
+  EXPECT_EQ(filter.estimate(key), 5);
+
+  // After a long idle period the whole burst is available again (decay is applied
+  // lazily, when the prefix reaches its limit).
+  now_ += std::chrono::seconds(30);
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_TRUE(filter.admit(key)) << "attempt " << i;
+  }
+  EXPECT_LE(filter.estimate(key), 8);
+}
+
+TEST_F(SourceAdmissionTest, FloodFromOnePrefixDoesNotBlockOthers) {
+  utils::SourceAdmissionFilter filter(make_config(64), [this] { return now_; });
+  for (int i = 0; i < 100000; ++i) {
+    (void)filter.admit_host("198.51.100." + std::to_string(i % 256));
+  }
+  EXPECT_GE(filter.dropped(), 100000U - 64U);
+
+  // Thousands of innocent prefixes still get through: fixed-size sketch, low collision rate.
+  int admitted = 0;
+  for (int a = 0; a < 16; ++a) {
+    for (int b = 0; b < 256; ++b) {
+      const auto host = "10." + std::to_string(a) + "." + std::to_string(b) + ".1";
+      admitted += filter.admit_host(host) ? 1 : 0;
+    }
+  }
+  EXPECT_EQ(admitted, 16 * 256);
+}
+
+TEST_F(SourceAdmissionTest, ConcurrentAdmitStillCutsOffFlood) {
+  utils::SourceAdmissionFilter filter(make_config(100));
+  const auto key = *filter.prefix_key("198.51.100.7");
+  std::atomic<int> admitted{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < 1000; ++i) {
+        if (filter.admit(key)) {
+          admitted.fetch_add(1);
+        }
+      }
+    });
+  }
+  for (auto& th : threads) {
+    th.join();
+  }
+  // Racing updates may lose increments, so some extra admissions are tolerated; the
+  // flood is still cut off. (Decay cannot fire: the test runs well under a second.)
+  EXPECT_GE(admitted.load(), 100);
+  EXPECT_LT(admitted.load(), 2000);
+}
+
+TEST(HandshakeSourceAdmissionTest, ResponderDropsOverLimitPrefix) {
+  utils::SourceAdmissionConfig config;
+  config.threshold = 3;
+  handshake::HandshakeResponder responder(
+      std::vector<std::uint8_t>(32, 0xAA), std::chrono::milliseconds(1000),
+      utils::TokenBucket(10.0, std::chrono::milliseconds(100)),
+      handshake::HandshakeResponder::Clock::now, config);
+  EXPECT_TRUE(responder.admit_source("192.0.2.1"));
+  EXPECT_TRUE(responder.admit_source("192.0.2.2"));
+  EXPECT_TRUE(responder.admit_source("192.0.2.3"));
+  EXPECT_FALSE(responder.admit_source("192.0.2.4"));
+  EXPECT_TRUE(responder.admit_source("192.0.3.1"));
+  EXPECT_EQ(responder.source_admission().dropped(), 1U);
+}
+
+}  // namespace veil::tests
@@ -1,11 +1,14 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <vector>
 
 #include "common/handshake/handshake_processor.h"
 #include "common/utils/rate_limiter.h"
+#include "transport/mux/ack_scheduler.h"
+#include "transport/mux/mss_clamp.h"
 #include "transport/session/transport_session.h"
 
 namespace veil::tests {
@@ -43,6 +46,21 @@ class TransportSessionTest : public ::testing::Test {
     server_handshake_ = resp->session;
   }
 
+  // Exchange the datagram_mode, frame_packing and ack_ranges offers, as the tunnel and
+  // server do on connect.
+  static void negotiate(transport::TransportSession& client,
+                        transport::TransportSession& server) {
+    for (auto* side : {&client, &server}) {
+      auto* peer = side == &client ? &server : &client;
+      for (auto offer : {side->take_datagram_mode_frame(), side->take_frame_packing_frame(),
+                         side->take_ack_ranges_frame()}) {
+        if (offer) {
+          ASSERT_TRUE(peer->decrypt_packet(side->encrypt_frame(*offer)).has_value());
+        }
+      }
+    }
+  }
+
   std::chrono::system_clock::time_point now_;
   std::chrono::steady_clock::time_point steady_now_;
   std::vector<std::uint8_t> psk_;
@@ -873,4 +891,1378 @@ TEST_F(TransportSessionTest, ZeroCopyMultiplePackets) {
   EXPECT_EQ(server.stats().packets_dropped_decrypt, 0U);
 }
 
+TEST_F(TransportSessionTest, IpPacketsSentAsDatagramsOnceNegotiated) {
+  auto now_fn = [this]() { return steady_now_; };
+
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+
+  // Until the peer offers datagrams too, packets go as DATA, which any peer decodes.
+  std::vector<std::uint8_t> ip_packet(100, 0x45);
+  auto early = client.encrypt_ip_packet(ip_packet);
+  ASSERT_EQ(early.size(), 1U);
+  EXPECT_EQ(client.stats().datagrams_sent, 0U);
+  auto early_frames = server.decrypt_packet(early[0]);
+  ASSERT_TRUE(early_frames.has_value());
+  EXPECT_EQ((*early_frames)[0].kind, mux::FrameKind::kData);
+
+  negotiate(client, server);
+  EXPECT_TRUE(client.datagram_mode_active());
+  EXPECT_TRUE(server.datagram_mode_active());
+  const auto in_flight = client.bytes_in_flight();
+  auto encrypted_packets = client.encrypt_ip_packet(ip_packet);
+  ASSERT_EQ(encrypted_packets.size(), 1U);
+
+  // Nothing is buffered for retransmission; the datagram counts in flight until the
+  // peer's loss feedback reports it.
+  EXPECT_TRUE(client.datagram_acks_active());
+  EXPECT_EQ(client.bytes_in_flight(), in_flight + encrypted_packets[0].size());
+  EXPECT_EQ(client.stats().datagrams_sent, 1U);
+
+  auto decrypted = server.decrypt_packet(encrypted_packets[0]);
+  ASSERT_TRUE(decrypted.has_value());
+  ASSERT_EQ(decrypted->size(), 1U);
+  EXPECT_EQ((*decrypted)[0].kind, mux::FrameKind::kDatagram);
+  EXPECT_EQ((*decrypted)[0].datagram.payload, ip_packet);
+  EXPECT_EQ(server.stats().datagrams_received, 1U);
+
+  // Replay protection still applies to datagrams.
+  EXPECT_FALSE(server.decrypt_packet(encrypted_packets[0]).has_value());
+  EXPECT_EQ(server.stats().packets_dropped_replay, 1U);
+}
+
+TEST_F(TransportSessionTest, IpPacketsSentAsDataWhenDatagramModeDisabled) {
+  auto now_fn = [this]() { return steady_now_; };
+
+  transport::TransportSessionConfig config;
+  config.datagram_mode = false;
+  transport::TransportSession client(client_handshake_, config, now_fn);
+  transport::TransportSession server(server_handshake_, config, now_fn);
+
+  std::vector<std::uint8_t> ip_packet(100, 0x45);
+  auto encrypted_packets = client.encrypt_ip_packet(ip_packet);
+  ASSERT_EQ(encrypted_packets.size(), 1U);
+  EXPECT_GT(client.bytes_in_flight(), 0U);
+
+  auto decrypted = server.decrypt_packet(encrypted_packets[0]);
+  ASSERT_TRUE(decrypted.has_value());
+  EXPECT_EQ((*decrypted)[0].kind, mux::FrameKind::kData);
+}
+
+TEST_F(TransportSessionTest, OversizedDatagramFallsBackToFragmentedData) {
+  auto now_fn = [this]() { return steady_now_; };
+
+  transport::TransportSessionConfig config;
+  config.max_fragment_size = 10;
+  transport::TransportSession client(client_handshake_, config, now_fn);
+
+  std::vector<std::uint8_t> ip_packet(25, 0x45);
+  auto encrypted_packets = client.encrypt_datagram(ip_packet);
+  EXPECT_GE(encrypted_packets.size(), 2U);
+  EXPECT_EQ(client.stats().datagrams_sent, 0U);
+  EXPECT_EQ(client.stats().fragments_sent, encrypted_packets.size());
+}
+
+TEST_F(TransportSessionTest, DatagramLossFeedbackReachesCongestionControl) {
+  auto now_fn = [this]() { return steady_now_; };
+
+  transport::TransportSessionConfig config;
+  config.datagram_loss_feedback = true;
+  transport::TransportSession client(client_handshake_, config, now_fn);
+  transport::TransportSession server(server_handshake_, config, now_fn);
+  negotiate(client, server);
+
+  // Send 8 datagrams and drop the third on the way.
+  std::vector<std::uint8_t> ip_packet(100, 0x45);
+  mux::AckScheduler receiver;
+  for (int i = 0; i < 8; ++i) {
+    auto encrypted_packets = client.encrypt_ip_packet(ip_packet);
+    ASSERT_EQ(encrypted_packets.size(), 1U);
+    if (i == 2) {
+      continue;
+    }
+    auto decrypted = server.decrypt_packet(encrypted_packets[0]);
+    ASSERT_TRUE(decrypted.has_value());
+    receiver.on_packet_received(mux::kDatagramStreamId, (*decrypted)[0].datagram.sequence);
+  }
+  EXPECT_GT(client.bytes_in_flight(), 0U);
+
+  const auto cwnd_before = client.cwnd();
+  auto ack = receiver.get_pending_ack(mux::kDatagramStreamId);
+  ASSERT_TRUE(ack.has_value());
+  client.process_ack(*ack);
+
+  EXPECT_EQ(client.stats().datagrams_lost, 1U);
+  EXPECT_EQ(client.bytes_in_flight(), 0U);
+  EXPECT_LT(client.cwnd(), cwnd_before);
+  // Datagrams are never retransmitted, lost or not.
+  EXPECT_TRUE(client.get_retransmit_packets().empty());
+}
+
+TEST_F(TransportSessionTest, DatagramLossReducesWindowOncePerRoundTrip) {
+  auto now_fn = [this]() { return steady_now_; };
+
+  transport::TransportSessionConfig config;
+  config.datagram_loss_feedback = true;
+  transport::TransportSession client(client_handshake_, config, now_fn);
+  transport::TransportSession server(server_handshake_, config, now_fn);
+  negotiate(client, server);
+
+  std::vector<std::uint64_t> seq;
+  std::vector<std::uint8_t> ip_packet(100, 0x45);
+  for (int i = 0; i < 10; ++i) {
+    auto encrypted_packets = client.encrypt_ip_packet(ip_packet);
+    ASSERT_EQ(encrypted_packets.size(), 1U);
+    auto decrypted = server.decrypt_packet(encrypted_packets[0]);
+    ASSERT_TRUE(decrypted.has_value());
+    seq.push_back((*decrypted)[0].datagram.sequence);
+  }
+
+  // The third datagram is reported lost: one reduction.
+  const auto cwnd_before = client.cwnd();
+  mux::AckRangesFrame first;
+  first.stream_id = mux::kDatagramStreamId;
+  first.ranges = {{seq[3], seq[5]}, {seq[0], seq[1]}};
+  client.process_ack(first);
+  const auto cwnd_reduced = client.cwnd();
+  EXPECT_LT(cwnd_reduced, cwnd_before);
+
+  // The seventh, sent before that reduction, is the same congestion event.
+  mux::AckRangesFrame second;
+  second.stream_id = mux::kDatagramStreamId;
+  second.ranges = {{seq[7], seq[9]}, {seq[3], seq[5]}, {seq[0], seq[1]}};
+  client.process_ack(second);
+  EXPECT_EQ(client.stats().datagrams_lost, 2U);
+  EXPECT_EQ(client.cwnd(), cwnd_reduced);
+}
+
+TEST_F(TransportSessionTest, DatagramAcksNegotiatedWithDatagramMode) {
+  auto now_fn = [this]() { return steady_now_; };
+
+  // By default both sides acknowledge datagrams and say so in their offers.
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+  negotiate(client, server);
+  EXPECT_TRUE(client.datagram_acks_active());
+  EXPECT_TRUE(server.datagram_acks_active());
+
+  // A peer that does not acknowledge them: datagrams stay out of the window, which
+  // would otherwise never drain.
+  transport::TransportSessionConfig silent;
+  silent.datagram_loss_feedback = false;
+  transport::TransportSession sender(client_handshake_, {}, now_fn);
+  transport::TransportSession receiver(server_handshake_, silent, now_fn);
+  negotiate(sender, receiver);
+  ASSERT_TRUE(sender.datagram_mode_active());
+  EXPECT_FALSE(sender.datagram_acks_active());
+  EXPECT_TRUE(receiver.datagram_acks_active());
+  const auto in_flight = sender.bytes_in_flight();
+  std::vector<std::uint8_t> ip_packet(100, 0x45);
+  ASSERT_EQ(sender.encrypt_ip_packet(ip_packet).size(), 1U);
+  EXPECT_EQ(sender.bytes_in_flight(), in_flight);
+
+  // Neither does a peer whose offer has no flags byte.
+  transport::TransportSession legacy(client_handshake_, {}, now_fn);
+  ASSERT_TRUE(legacy
+                  .decrypt_packet(server.encrypt_frame(mux::make_control_frame(
+                      mux::kControlDatagramMode, {mux::kDatagramModeVersion})))
+                  .has_value());
+  EXPECT_TRUE(legacy.datagram_mode_active());
+  EXPECT_FALSE(legacy.datagram_acks_active());
+}
+
+TEST_F(TransportSessionTest, DatagramsBackUpInSchedulerInDefaultConfig) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+  negotiate(client, server);
+  ASSERT_TRUE(client.datagram_mode_active());
+
+  // Unacknowledged datagrams fill the window; the rest waits in the scheduler until it
+  // pushes back on the inner stack.
+  std::vector<std::uint8_t> ip_packet(1200, 0);
+  ip_packet[0] = 0x45;
+  std::vector<std::vector<std::uint8_t>> sent;
+  for (int i = 0; i < 1000 && !client.send_backlogged(); ++i) {
+    for (auto& packet : client.queue_ip_packet(ip_packet)) {
+      sent.push_back(std::move(packet));
+    }
+  }
+  ASSERT_TRUE(client.send_backlogged());
+  EXPECT_GT(client.scheduled_packets(), 0U);
+  EXPECT_GE(client.bytes_in_flight(), client.cwnd());
+
+  // Datagram ACKs open the window again and release the backlog.
+  mux::AckScheduler receiver;
+  for (const auto& packet : sent) {
+    auto frames = server.decrypt_packet(packet);
+    ASSERT_TRUE(frames.has_value());
+    receiver.on_packet_received(mux::kDatagramStreamId, (*frames)[0].datagram.sequence);
+  }
+  const auto queued = client.scheduled_packets();
+  steady_now_ += 20ms;
+  auto ack = receiver.get_pending_ack(mux::kDatagramStreamId);
+  ASSERT_TRUE(ack.has_value());
+  client.process_ack(*ack);
+  EXPECT_FALSE(client.flush_packed().empty());
+  EXPECT_LT(client.scheduled_packets(), queued);
+  EXPECT_EQ(client.stats().datagrams_lost, 0U);
+}
+
+TEST_F(TransportSessionTest, AppLimitedDatagramAcksDoNotGrowWindow) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+  negotiate(client, server);
+  ASSERT_TRUE(client.datagram_acks_active());
+
+  // A trickle that never comes near the window says nothing about the path, so its
+  // acknowledgements leave the window where it is.
+  const auto cwnd = client.cwnd();
+  std::vector<std::uint8_t> ip_packet(200, 0x45);
+  mux::AckScheduler receiver;
+  for (int round = 0; round < 20; ++round) {
+    for (const auto& packet : client.encrypt_ip_packet(ip_packet)) {
+      auto frames = server.decrypt_packet(packet);
+      ASSERT_TRUE(frames.has_value());
+      receiver.on_packet_received(mux::kDatagramStreamId, (*frames)[0].datagram.sequence);
+    }
+    steady_now_ += 20ms;
+    auto ack = receiver.get_pending_ack(mux::kDatagramStreamId);
+    ASSERT_TRUE(ack.has_value());
+    client.process_ack(*ack);
+  }
+  EXPECT_EQ(client.cwnd(), cwnd);
+  EXPECT_EQ(client.stats().datagrams_lost, 0U);
+}
+
+TEST_F(TransportSessionTest, QueuedFramesShareOnePacket) {
+  auto now_fn = [this]() { return steady_now_; };
+
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+  negotiate(client, server);
+  const auto sent_before = client.stats().packets_sent;
+
+  // Three small IP packets and an ACK stay queued until the batch is flushed.
+  std::vector<std::uint8_t> ip_packet(60, 0x45);
+  EXPECT_TRUE(client.queue_ip_packet(ip_packet).empty());
+  EXPECT_TRUE(client.queue_ip_packet(ip_packet).empty());
+  EXPECT_TRUE(client.queue_frame(mux::make_ack_frame(0, 9, 0x3)).empty());
+  EXPECT_TRUE(client.queue_ip_packet(ip_packet).empty());
+  EXPECT_TRUE(client.has_packed_frames());
+
+  auto packets = client.flush_packed();
+  ASSERT_EQ(packets.size(), 1U);
+  EXPECT_FALSE(client.has_packed_frames());
+  EXPECT_EQ(client.stats().packets_sent, sent_before + 1);
+  EXPECT_EQ(client.stats().packed_frames_sent, 4U);
+  EXPECT_EQ(client.stats().datagrams_sent, 3U);
+
+  auto frames = server.decrypt_packet(packets[0]);
+  ASSERT_TRUE(frames.has_value());
+  ASSERT_EQ(frames->size(), 4U);
+  EXPECT_EQ((*frames)[0].kind, mux::FrameKind::kDatagram);
+  EXPECT_EQ((*frames)[0].datagram.payload, ip_packet);
+  EXPECT_EQ((*frames)[2].kind, mux::FrameKind::kAck);
+  EXPECT_EQ((*frames)[2].ack.ack, 9U);
+  EXPECT_EQ(server.stats().datagrams_received, 3U);
+}
+
+TEST_F(TransportSessionTest, PackedPacketsStayWithinMtu) {
+  auto now_fn = [this]() { return steady_now_; };
+
+  transport::TransportSessionConfig config;
+  config.mtu = 400;
+  transport::TransportSession client(client_handshake_, config, now_fn);
+  transport::TransportSession server(server_handshake_, config, now_fn);
+  negotiate(client, server);
+
+  std::vector<std::vector<std::uint8_t>> packets;
+  std::vector<std::uint8_t> ip_packet(100, 0x45);
+  for (int i = 0; i < 20; ++i) {
+    for (auto& pkt : client.queue_ip_packet(ip_packet)) {
+      packets.push_back(std::move(pkt));
+    }
+  }
+  for (auto& pkt : client.flush_packed()) {
+    packets.push_back(std::move(pkt));
+  }
+
+  std::size_t delivered = 0;
+  for (const auto& pkt : packets) {
+    EXPECT_LE(pkt.size(), config.mtu);
+    auto frames = server.decrypt_packet(pkt);
+    ASSERT_TRUE(frames.has_value());
+    delivered += frames->size();
+  }
+  EXPECT_EQ(delivered, 20U);
+  EXPECT_LT(packets.size(), 20U);
+}
+
+TEST_F(TransportSessionTest, PackingDelayAndDisabledPacking) {
+  auto now_fn = [this]() { return steady_now_; };
+
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+  // Nothing is packed before the peer offers packing too.
+  EXPECT_EQ(client.queue_frame(mux::make_ack_frame(0, 1, 0)).size(), 1U);
+  negotiate(client, server);
+  EXPECT_TRUE(client.frame_packing_active());
+  std::vector<std::uint8_t> ip_packet(60, 0x45);
+  EXPECT_TRUE(client.queue_ip_packet(ip_packet).empty());
+  EXPECT_TRUE(client.flush_packed_if_due().empty());
+  steady_now_ += 1ms;
+  EXPECT_EQ(client.flush_packed_if_due().size(), 1U);
+
+  transport::TransportSessionConfig config;
+  config.frame_packing = false;
+  transport::TransportSession unpacked(client_handshake_, config, now_fn);
+  EXPECT_EQ(unpacked.queue_ip_packet(ip_packet).size(), 1U);
+  EXPECT_EQ(unpacked.queue_frame(mux::make_ack_frame(0, 1, 0)).size(), 1U);
+  EXPECT_FALSE(unpacked.has_packed_frames());
+}
+
+TEST_F(TransportSessionTest, ReliableDataIsNotPacked) {
+  auto now_fn = [this]() { return steady_now_; };
+
+  transport::TransportSessionConfig config;
+  config.datagram_mode = false;
+  transport::TransportSession client(client_handshake_, config, now_fn);
+  transport::TransportSession server(server_handshake_, config, now_fn);
+  negotiate(client, server);
+
+  // A queued ACK is flushed ahead of the DATA packet to keep order.
+  EXPECT_TRUE(client.queue_frame(mux::make_ack_frame(0, 1, 0)).empty());
+  std::vector<std::uint8_t> ip_packet(60, 0x45);
+  auto packets = client.queue_ip_packet(ip_packet);
+  ASSERT_EQ(packets.size(), 2U);
+
+  auto ack = server.decrypt_packet(packets[0]);
+  ASSERT_TRUE(ack.has_value());
+  EXPECT_EQ((*ack)[0].kind, mux::FrameKind::kAck);
+  auto data = server.decrypt_packet(packets[1]);
+  ASSERT_TRUE(data.has_value());
+  EXPECT_EQ((*data)[0].kind, mux::FrameKind::kData);
+  EXPECT_GT(client.bytes_in_flight(), 0U);
+}
+
+TEST_F(TransportSessionTest, ExtendedAckRepairsBurstLossWithoutRto) {
+  auto now_fn = [this]() { return steady_now_; };
+
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+
+  // 100 reliable packets; a burst of 50 is lost, more than a 32-bit bitmap can describe.
+  std::vector<std::uint8_t> payload(200, 0x42);
+  std::vector<std::vector<std::uint8_t>> lost;
+  for (int i = 0; i < 100; ++i) {
+    auto packets = client.encrypt_data(payload, 0, false);
+    ASSERT_EQ(packets.size(), 1U);
+    if (i >= 10 && i < 60) {
+      lost.push_back(std::move(packets[0]));
+    } else {
+      ASSERT_TRUE(server.decrypt_packet(packets[0]).has_value());
+    }
+  }
+
+  steady_now_ += 20ms;  // Well below the RTO.
+  auto ack = server.generate_ack_ranges(0);
+  ASSERT_EQ(ack.ranges.size(), 2U);
+  client.process_ack(ack);
+
+  // Every hole is retransmitted at once, and the window is cut once, not per packet.
+  auto retransmits = client.get_retransmit_packets();
+  EXPECT_EQ(retransmits.size(), lost.size());
+  EXPECT_EQ(client.stats().fast_retransmits, lost.size());
+  EXPECT_EQ(client.congestion_stats().cwnd_decreases, 1U);
+  EXPECT_EQ(client.congestion_stats().timeout_retransmits, 0U);
+  EXPECT_EQ(client.congestion_state(), mux::CongestionState::kFastRecovery);
+
+  for (const auto& packet : retransmits) {
+    ASSERT_TRUE(server.decrypt_packet(packet).has_value());
+  }
+  steady_now_ += 20ms;
+  client.process_ack(server.generate_ack_ranges(0));
+  EXPECT_EQ(client.retransmit_stats().packets_acked, 100U);
+  EXPECT_EQ(client.bytes_in_flight(), 0U);
+  EXPECT_TRUE(client.get_retransmit_packets().empty());
+}
+
+TEST_F(TransportSessionTest, BbrSelectedByConfigKeepsWindowOnLoss) {
+  auto now_fn = [this]() { return steady_now_; };
+
+  transport::TransportSessionConfig config;
+  config.congestion_algorithm = mux::CongestionAlgorithm::kBbr;
+  transport::TransportSession client(client_handshake_, config, now_fn);
+  transport::TransportSession server(server_handshake_, config, now_fn);
+  EXPECT_EQ(client.congestion_algorithm(), mux::CongestionAlgorithm::kBbr);
+
+  // 20 packets, every fourth lost.
+  std::vector<std::uint8_t> payload(1000, 0x42);
+  for (int i = 0; i < 20; ++i) {
+    auto packets = client.encrypt_data(payload, 0, false);
+    ASSERT_EQ(packets.size(), 1U);
+    if (i % 4 != 1) {
+      ASSERT_TRUE(server.decrypt_packet(packets[0]).has_value());
+    }
+  }
+  const auto cwnd = client.cwnd();
+
+  steady_now_ += 20ms;
+  client.process_ack(server.generate_ack_ranges(0));
+  // The last hole is within the reorder threshold of the largest ACKed packet.
+  EXPECT_EQ(client.get_retransmit_packets().size(), 4U);
+  // Random loss is not congestion to BBR: the window is not cut.
+  EXPECT_EQ(client.congestion_stats().cwnd_decreases, 0U);
+  EXPECT_GE(client.cwnd(), cwnd);
+  EXPECT_EQ(client.congestion_state(), mux::CongestionState::kSlowStart);
+}
+
+TEST_F(TransportSessionTest, ReorderedPacketUndoesLossReduction) {
+  auto now_fn = [this]() { return steady_now_; };
+
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+
+  // The first of five packets is overtaken by the other four.
+  std::vector<std::uint8_t> payload(1000, 0x42);
+  std::vector<std::uint8_t> late;
+  for (int i = 0; i < 5; ++i) {
+    auto packets = client.encrypt_data(payload, 0, false);
+    ASSERT_EQ(packets.size(), 1U);
+    if (i == 0) {
+      late = packets[0];
+    } else {
+      ASSERT_TRUE(server.decrypt_packet(packets[0]).has_value());
+    }
+  }
+  const auto cwnd = client.cwnd();
+
+  steady_now_ += 20ms;
+  client.process_ack(server.generate_ack_ranges(0));
+  EXPECT_EQ(client.congestion_stats().cwnd_decreases, 1U);
+  EXPECT_LT(client.cwnd(), cwnd);
+  EXPECT_EQ(client.get_retransmit_packets().size(), 1U);
+
+  // The original arrives and is acknowledged sooner than the retransmission could be.
+  steady_now_ += 1ms;
+  ASSERT_TRUE(server.decrypt_packet(late).has_value());
+  client.process_ack(server.generate_ack_ranges(0));
+  EXPECT_EQ(client.retransmit_stats().spurious_losses, 1U);
+  EXPECT_EQ(client.retransmit_stats().genuine_losses, 0U);
+  EXPECT_EQ(client.stats().loss_undos, 1U);
+  EXPECT_GE(client.cwnd(), cwnd);
+  EXPECT_EQ(client.congestion_state(), mux::CongestionState::kSlowStart);
+}
+
+TEST_F(TransportSessionTest, TailLossProbeRepairsTailWithoutTimeout) {
+  auto now_fn = [this]() { return steady_now_; };
+
+  transport::TransportSessionConfig config;
+  config.retransmit_config.min_rto = 200ms;
+  transport::TransportSession client(client_handshake_, config, now_fn);
+  transport::TransportSession server(server_handshake_, config, now_fn);
+
+  std::vector<std::uint8_t> payload(1000, 0x42);
+  auto send = [&](bool delivered) {
+    auto packets = client.encrypt_data(payload, 0, false);
+    ASSERT_EQ(packets.size(), 1U);
+    if (delivered) {
+      ASSERT_TRUE(server.decrypt_packet(packets[0]).has_value());
+    }
+  };
+
+  send(true);
+  steady_now_ += 20ms;
+  client.process_ack(server.generate_ack_ranges(0));
+
+  // The last two packets of a burst are lost: nothing after them reveals the hole.
+  send(true);
+  send(false);
+  send(false);
+  steady_now_ += 20ms;
+  client.process_ack(server.generate_ack_ranges(0));
+  EXPECT_TRUE(client.get_retransmit_packets().empty());
+
+  // Two RTTs of silence: a probe, not a timeout.
+  steady_now_ += 40ms;
+  auto probe = client.get_retransmit_packets();
+  ASSERT_EQ(probe.size(), 1U);
+  EXPECT_EQ(client.stats().tail_loss_probes, 1U);
+  EXPECT_EQ(client.congestion_stats().timeout_retransmits, 0U);
+
+  // Its ACK exposes the other loss, repaired by fast retransmit well before the RTO.
+  ASSERT_TRUE(server.decrypt_packet(probe[0]).has_value());
+  steady_now_ += 20ms;
+  client.process_ack(server.generate_ack_ranges(0));
+  EXPECT_EQ(client.get_retransmit_packets().size(), 1U);
+  EXPECT_EQ(client.stats().fast_retransmits, 1U);
+  EXPECT_EQ(client.congestion_stats().timeout_retransmits, 0U);
+}
+
+TEST_F(TransportSessionTest, RetransmissionIsSealedUnderFreshSequence) {
+  auto now_fn = [this]() { return steady_now_; };
+
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+
+  std::vector<std::uint8_t> payload(100, 0x42);
+  auto original = client.encrypt_data(payload, 0, false);
+  ASSERT_EQ(original.size(), 1U);
+
+  // The original is delayed past the RTO.
+  steady_now_ += 150ms;
+  auto retransmit = client.get_retransmit_packets();
+  ASSERT_EQ(retransmit.size(), 1U);
+  EXPECT_NE(retransmit[0], original[0]);
+
+  auto frames = server.decrypt_packet(retransmit[0]);
+  ASSERT_TRUE(frames.has_value());
+  ASSERT_EQ(frames->size(), 1U);
+  EXPECT_EQ((*frames)[0].data.payload, payload);
+
+  // The late original is a new packet to the replay window: ACKed, not delivered again.
+  auto late = server.decrypt_packet(original[0]);
+  ASSERT_TRUE(late.has_value());
+  EXPECT_TRUE(late->empty());
+  EXPECT_EQ(server.stats().packets_dropped_replay, 0U);
+  EXPECT_EQ(server.stats().fragments_dropped_duplicate, 1U);
+
+  // Both copies are acknowledged: the loss was spurious and nothing is left to resend.
+  steady_now_ += 20ms;
+  client.process_ack(server.generate_ack_ranges(0));
+  EXPECT_EQ(client.retransmit_stats().packets_acked, 1U);
+  EXPECT_EQ(client.retransmit_stats().spurious_losses, 1U);
+  EXPECT_EQ(client.bytes_in_flight(), 0U);
+  steady_now_ += 1s;
+  EXPECT_TRUE(client.get_retransmit_packets().empty());
+}
+
+TEST_F(TransportSessionTest, FecRebuildsLostPacketWithoutRetransmission) {
+  auto now_fn = [this]() { return steady_now_; };
+
+  transport::TransportSessionConfig config;
+  config.enable_fec = true;
+  config.fec_config.initial_group_size = 4;
+  transport::TransportSession client(client_handshake_, config, now_fn);
+  transport::TransportSession server(server_handshake_, config, now_fn);
+
+  // Negotiation: each side offers, and is active once the other's offer arrives.
+  auto exchange = [](transport::TransportSession& from, transport::TransportSession& to) {
+    auto params = from.take_fec_params_frame();
+    ASSERT_TRUE(params.has_value());
+    auto frames = to.decrypt_packet(from.encrypt_frame(*params));
+    ASSERT_TRUE(frames.has_value());
+    EXPECT_TRUE(frames->empty());
+  };
+  exchange(client, server);
+  exchange(server, client);
+  EXPECT_TRUE(client.fec_active());
+  EXPECT_TRUE(server.fec_active());
+
+  // Four DATA packets, the third lost: the fourth send also returns the repair.
+  std::vector<std::vector<std::uint8_t>> delivered;
+  for (std::uint8_t i = 0; i < 4; ++i) {
+    std::vector<std::uint8_t> payload(100 + i, i);
+    auto packets = client.encrypt_data(payload, 0, false);
+    ASSERT_EQ(packets.size(), i == 3 ? 2U : 1U);
+    for (std::size_t p = 0; p < packets.size(); ++p) {
+      if (i == 2) {
+        continue;
+      }
+      auto frames = server.decrypt_packet(packets[p]);
+      ASSERT_TRUE(frames.has_value());
+      for (const auto& frame : *frames) {
+        delivered.push_back(frame.data.payload);
+      }
+    }
+  }
+  EXPECT_EQ(client.stats().fec_repairs_sent, 1U);
+  EXPECT_EQ(server.stats().fec_packets_recovered, 1U);
+  ASSERT_EQ(delivered.size(), 4U);
+  EXPECT_EQ(delivered[3], std::vector<std::uint8_t>(102, 2));
+
+  // The rebuilt packet is acknowledged like the others: nothing to retransmit.
+  steady_now_ += 20ms;
+  client.process_ack(server.generate_ack_ranges(0));
+  EXPECT_EQ(client.bytes_in_flight(), 0U);
+  steady_now_ += 1s;
+  EXPECT_TRUE(client.get_retransmit_packets().empty());
+  EXPECT_EQ(client.stats().retransmits, 0U);
+}
+
+TEST_F(TransportSessionTest, FlowControlHoldsDataUntilCredit) {
+  auto now_fn = [this]() { return steady_now_; };
+
+  transport::TransportSessionConfig config;
+  config.flow_control.initial_stream_window = 4000;
+  config.flow_control.max_stream_window = 4000;
+  config.flow_control.initial_session_window = 6000;
+  config.flow_control.max_session_window = 6000;
+  transport::TransportSession client(client_handshake_, config, now_fn);
+  transport::TransportSession server(server_handshake_, config, now_fn);
+
+  auto grant = [&]() {
+    auto credit = server.take_flow_control_frames();
+    ASSERT_FALSE(credit.empty());
+    auto frames = client.decrypt_packet(server.encrypt_frames(credit));
+    ASSERT_TRUE(frames.has_value());
+    EXPECT_TRUE(frames->empty());
+  };
+  // Session and default stream credit, as sent on connect.
+  grant();
+
+  // The stream window holds four 1000-byte messages; the rest wait for credit.
+  std::vector<std::vector<std::uint8_t>> in_flight;
+  const std::vector<std::uint8_t> payload(1000, 0x42);
+  for (int i = 0; i < 6; ++i) {
+    for (auto& packet : client.encrypt_data(payload, 0, false)) {
+      in_flight.push_back(std::move(packet));
+    }
+  }
+  EXPECT_EQ(in_flight.size(), 4U);
+  EXPECT_TRUE(client.flow_blocked());
+  EXPECT_EQ(client.flow_blocked_bytes(), 2000U);
+  EXPECT_EQ(client.stats().flow_control_blocked, 2U);
+
+  // The client reports the stream it is blocked on (after its own initial credit), once
+  // per round trip.
+  std::vector<mux::FlowCredit> reports;
+  for (const auto& frame : client.take_flow_control_frames()) {
+    auto credit = mux::parse_flow_credit(frame.control);
+    ASSERT_TRUE(credit.has_value());
+    if (credit->kind == mux::FlowCreditKind::kBlocked) {
+      reports.push_back(*credit);
+    }
+  }
+  ASSERT_EQ(reports.size(), 1U);
+  EXPECT_EQ(reports[0].stream_id, 0U);
+  EXPECT_EQ(reports[0].offset, 4000U);
+  EXPECT_TRUE(client.take_flow_control_frames().empty());
+
+  // Nothing is released before the server has consumed the data and granted more.
+  EXPECT_TRUE(client.release_flow_blocked().empty());
+  for (const auto& packet : in_flight) {
+    ASSERT_TRUE(server.decrypt_packet(packet).has_value());
+  }
+  grant();
+  EXPECT_EQ(client.release_flow_blocked().size(), 2U);
+  EXPECT_FALSE(client.flow_blocked());
+  EXPECT_EQ(server.stats().flow_control_violations, 0U);
+}
+
+TEST_F(TransportSessionTest, ExpiredFragmentsReturnFlowCredit) {
+  auto now_fn = [this]() { return steady_now_; };
+
+  transport::TransportSessionConfig config;
+  config.max_fragment_size = 500;
+  config.flow_control.initial_stream_window = 4000;
+  config.flow_control.max_stream_window = 4000;
+  config.flow_control.initial_session_window = 6000;
+  config.flow_control.max_session_window = 6000;
+  transport::TransportSession client(client_handshake_, config, now_fn);
+  transport::TransportSession server(server_handshake_, config, now_fn);
+
+  auto grant = [&]() {
+    auto credit = server.take_flow_control_frames();
+    if (!credit.empty()) {
+      ASSERT_TRUE(client.decrypt_packet(server.encrypt_frames(credit)).has_value());
+    }
+  };
+  grant();
+
+  // Four messages of two fragments fill the stream window; the second fragment of each
+  // is lost for good.
+  const std::vector<std::uint8_t> payload(1000, 0x42);
+  std::vector<std::vector<std::uint8_t>> in_flight;
+  for (int i = 0; i < 5; ++i) {
+    for (auto& packet : client.encrypt_data(payload, 0, false)) {
+      in_flight.push_back(std::move(packet));
+    }
+  }
+  ASSERT_EQ(in_flight.size(), 8U);
+  ASSERT_TRUE(client.flow_blocked());
+  for (std::size_t i = 0; i < in_flight.size(); i += 2) {
+    auto frames = server.decrypt_packet(in_flight[i]);
+    ASSERT_TRUE(frames.has_value());
+    EXPECT_TRUE(frames->empty());
+  }
+
+  // The halves held in reassembly keep their credit until the timeout drops them.
+  grant();
+  EXPECT_TRUE(client.release_flow_blocked().empty());
+  steady_now_ += 6s;
+  grant();
+  EXPECT_EQ(server.stats().messages_expired, 4U);
+  EXPECT_EQ(client.release_flow_blocked().size(), 2U);
+  EXPECT_FALSE(client.flow_blocked());
+}
+
+TEST_F(TransportSessionTest, ExtendedAckDelayAndEcnCounts) {
+  auto now_fn = [this]() { return steady_now_; };
+
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+
+  std::vector<std::uint8_t> payload(100, 0x42);
+  auto deliver = [&]() {
+    auto packets = client.encrypt_data(payload, 0, false);
+    ASSERT_EQ(packets.size(), 1U);
+    ASSERT_TRUE(server.decrypt_packet(packets[0]).has_value());
+  };
+
+  deliver();
+  steady_now_ += 5ms;
+  auto ack = server.generate_ack_ranges(0);
+  EXPECT_EQ(ack.ack_delay, 5ms);
+  EXPECT_FALSE(ack.ecn.has_value());
+
+  server.record_ecn(0x02);  // ECT(0)
+  server.record_ecn(0x03);  // CE
+  ack = server.generate_ack_ranges(0);
+  ASSERT_TRUE(ack.ecn.has_value());
+  EXPECT_EQ(ack.ecn->ect0, 1U);
+  EXPECT_EQ(ack.ecn->ce, 1U);
+  client.process_ack(ack);
+  EXPECT_EQ(client.congestion_stats().ecn_ce_events, 1U);
+
+  // More marks on packets from the same round trip are the same congestion event.
+  server.record_ecn(0x03);
+  client.process_ack(server.generate_ack_ranges(0));
+  EXPECT_EQ(client.congestion_stats().ecn_ce_events, 1U);
+
+  // Once a packet sent after the reduction is acknowledged, a new mark counts again.
+  deliver();
+  server.record_ecn(0x03);
+  client.process_ack(server.generate_ack_ranges(0));
+  EXPECT_EQ(client.congestion_stats().ecn_ce_events, 2U);
+}
+
+TEST_F(TransportSessionTest, EcnTurnsOffWithoutPeerCounts) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+  transport::TransportSession old_server(server_handshake_, {}, now_fn);
+  transport::TransportSessionConfig no_ecn;
+  no_ecn.enable_ecn = false;
+  EXPECT_EQ(transport::TransportSession(client_handshake_, no_ecn, now_fn).outgoing_ecn(), 0U);
+
+  // Not sent until extended ACKs, which carry the counts, are negotiated. Plain ACKs
+  // before that do not turn it off.
+  EXPECT_EQ(client.outgoing_ecn(), 0U);
+  EXPECT_FALSE(client.ack_ranges_enabled());
+  client.process_ack(mux::AckFrame{.stream_id = 0, .ack = 0, .bitmap = 0});
+  negotiate(client, server);
+  EXPECT_TRUE(client.ack_ranges_enabled());
+  EXPECT_TRUE(server.ack_ranges_enabled());
+
+  // A peer that reads the ECN field reports counts: the client keeps sending ECT(0).
+  EXPECT_EQ(client.outgoing_ecn(), 0x02U);
+  auto packets = client.encrypt_data(std::vector<std::uint8_t>(100, 0x42), 0, false);
+  auto frames = server.decrypt_packet(packets[0]);
+  ASSERT_TRUE(frames.has_value());
+  server.apply_outer_ecn(client.outgoing_ecn(), *frames);
+  client.process_ack(server.generate_ack_ranges(0));
+  EXPECT_EQ(client.outgoing_ecn(), 0x02U);
+  // Validated: a later ACK without counts (a plain one) changes nothing.
+  client.process_ack(mux::AckFrame{.stream_id = 0, .ack = 0, .bitmap = 0});
+  EXPECT_EQ(client.outgoing_ecn(), 0x02U);
+
+  // One that does not (an older peer, or a path clearing the field): Not-ECT from then on.
+  transport::TransportSession other(client_handshake_, {}, now_fn);
+  negotiate(other, old_server);
+  EXPECT_EQ(other.outgoing_ecn(), 0x02U);
+  packets = other.encrypt_data(std::vector<std::uint8_t>(100, 0x42), 0, false);
+  ASSERT_TRUE(old_server.decrypt_packet(packets[0]).has_value());
+  other.process_ack(old_server.generate_ack_ranges(0));
+  EXPECT_EQ(other.outgoing_ecn(), 0U);
+}
+
+TEST_F(TransportSessionTest, OuterCeIsCopiedToInnerPackets) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+  negotiate(client, server);
+
+  // IPv4 UDP packet with the given ECN field and a valid header checksum.
+  const auto inner = [](std::uint8_t ecn) {
+    std::vector<std::uint8_t> packet(100, 0);
+    packet[0] = 0x45;
+    packet[1] = ecn;
+    packet[3] = 100;
+    packet[8] = 64;
+    packet[9] = 17;
+    packet[12] = 10;
+    packet[19] = 1;
+    std::uint32_t sum = 0;
+    for (std::size_t i = 0; i < 20; i += 2) {
+      sum += static_cast<std::uint32_t>((packet[i] << 8) | packet[i + 1]);
+    }
+    sum = (sum & 0xFFFFU) + (sum >> 16);
+    packet[10] = static_cast<std::uint8_t>(~sum >> 8);
+    packet[11] = static_cast<std::uint8_t>(~sum);
+    return packet;
+  };
+  const auto receive = [&](const std::vector<std::uint8_t>& packet, std::uint8_t outer_ecn) {
+    auto packets = client.encrypt_ip_packet(packet);
+    EXPECT_EQ(packets.size(), 1U);
+    auto frames = server.decrypt_packet(packets[0]);
+    EXPECT_TRUE(frames.has_value());
+    server.apply_outer_ecn(outer_ecn, *frames);
+    return *frames;
+  };
+
+  // Not CE outside: the inner packet is untouched.
+  auto frames = receive(inner(0x02), 0x02);
+  ASSERT_EQ(frames.size(), 1U);
+  EXPECT_EQ(frames[0].datagram.payload, inner(0x02));
+
+  // CE outside, ECN-capable inside: marked CE, checksum still valid.
+  frames = receive(inner(0x02), 0x03);
+  ASSERT_EQ(frames.size(), 1U);
+  auto expected = inner(0x03);
+  EXPECT_EQ(frames[0].datagram.payload, expected);
+  EXPECT_EQ(server.stats().ecn_ce_propagated, 1U);
+
+  // CE outside, Not-ECT inside: dropped (RFC 6040).
+  frames = receive(inner(0x00), 0x03);
+  EXPECT_TRUE(frames.empty());
+  EXPECT_EQ(server.stats().ecn_ce_dropped, 1U);
+  EXPECT_EQ(server.generate_ack_ranges(0).ecn->ce, 2U);
+}
+
+TEST_F(TransportSessionTest, DatagramAckCeReducesWindow) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSessionConfig config;
+  config.datagram_loss_feedback = true;
+  transport::TransportSession client(client_handshake_, config, now_fn);
+  transport::TransportSession server(server_handshake_, config, now_fn);
+
+  // Four datagrams arrive, the last marked CE on the way.
+  std::vector<std::uint8_t> ip_packet(100, 0x45);
+  mux::AckRangesFrame ack;
+  ack.stream_id = mux::kDatagramStreamId;
+  for (int i = 0; i < 4; ++i) {
+    auto packets = client.encrypt_ip_packet(ip_packet);
+    ASSERT_EQ(packets.size(), 1U);
+    auto frames = server.decrypt_packet(packets[0]);
+    ASSERT_TRUE(frames.has_value());
+    server.apply_outer_ecn(i == 3 ? 0x03 : 0x02, *frames);
+    const auto sequence = (*frames)[0].datagram.sequence;
+    ack.ranges = {mux::AckRange{.smallest = i == 0 ? sequence : ack.ranges[0].smallest,
+                                .largest = sequence}};
+  }
+  ack.ecn = server.generate_ack_ranges(0).ecn;
+  const auto cwnd_before = client.cwnd();
+  client.process_ack(ack);
+  EXPECT_EQ(client.congestion_stats().ecn_ce_events, 1U);
+  EXPECT_LT(client.cwnd(), cwnd_before);
+  EXPECT_EQ(client.stats().datagrams_lost, 0U);
+}
+
+TEST_F(TransportSessionTest, PacePacketSpacesDeparturesAtPacingRate) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+
+  // No rate before an RTT sample: everything leaves now.
+  EXPECT_EQ(client.pace_packet(1200), steady_now_);
+  EXPECT_EQ(client.pace_packet(1200), steady_now_);
+
+  const std::vector<std::uint8_t> payload(100, 0x5A);
+  for (const auto& packet : client.encrypt_data(payload, 0, false)) {
+    ASSERT_TRUE(server.decrypt_packet(packet).has_value());
+  }
+  steady_now_ += std::chrono::milliseconds(20);
+  client.process_ack(server.generate_ack(0));
+
+  // A burst of max_pacing_burst full packets leaves now, then one per 1200 bytes at the
+  // rate.
+  const auto burst = transport::TransportSessionConfig{}.congestion_config.max_pacing_burst;
+  std::vector<transport::TransportSession::TimePoint> departures;
+  for (std::size_t i = 0; i < 2 * burst + 10; ++i) {
+    departures.push_back(client.pace_packet(1200));
+  }
+  EXPECT_EQ(departures[0], steady_now_);
+  EXPECT_EQ(departures[burst - 1], steady_now_);
+  const auto gap = departures.back() - departures[departures.size() - 2];
+  EXPECT_GT(gap, std::chrono::microseconds(0));
+  for (std::size_t i = 2 * burst; i < departures.size(); ++i) {
+    EXPECT_EQ(departures[i] - departures[i - 1], gap);
+  }
+
+  // Pacing off: no spacing.
+  transport::TransportSessionConfig unpaced;
+  unpaced.congestion_config.enable_pacing = false;
+  transport::TransportSession plain(client_handshake_, unpaced, now_fn);
+  EXPECT_EQ(plain.pace_packet(1200), steady_now_);
+}
+
+TEST_F(TransportSessionTest, DatagramsArePacedFromDatagramAcks) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+  negotiate(client, server);
+  ASSERT_TRUE(client.datagram_acks_active());
+
+  // Default configuration, datagrams only: no rate until the peer acknowledges one.
+  std::vector<std::uint8_t> ip_packet(1200, 0);
+  ip_packet[0] = 0x45;
+  mux::AckScheduler receiver;
+  for (int i = 0; i < 4; ++i) {
+    for (const auto& packet : client.queue_ip_packet(ip_packet)) {
+      EXPECT_EQ(client.pace_packet(packet.size()), steady_now_);
+      auto frames = server.decrypt_packet(packet);
+      ASSERT_TRUE(frames.has_value());
+      receiver.on_packet_received(mux::kDatagramStreamId, (*frames)[0].datagram.sequence);
+    }
+  }
+  steady_now_ += 20ms;
+  auto ack = receiver.get_pending_ack(mux::kDatagramStreamId);
+  ASSERT_TRUE(ack.has_value());
+  client.process_ack(*ack);
+
+  // The datagram ACK gives an RTT sample: past the burst, departures are spaced.
+  const auto burst = transport::TransportSessionConfig{}.congestion_config.max_pacing_burst;
+  std::vector<transport::TransportSession::TimePoint> departures;
+  for (std::size_t i = 0; i < 2 * burst + 10; ++i) {
+    departures.push_back(client.pace_packet(1200));
+  }
+  EXPECT_EQ(departures[0], steady_now_);
+  const auto gap = departures.back() - departures[departures.size() - 2];
+  EXPECT_GT(gap, std::chrono::microseconds(0));
+  for (std::size_t i = 2 * burst; i < departures.size(); ++i) {
+    EXPECT_EQ(departures[i] - departures[i - 1], gap);
+  }
+  EXPECT_GT(client.paced_backlog_bytes(), 0U);
+}
+
+TEST_F(TransportSessionTest, DatagramsWithoutLossFeedbackAreNotPaced) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSessionConfig config;
+  config.datagram_loss_feedback = false;
+  transport::TransportSession client(client_handshake_, config, now_fn);
+  transport::TransportSession server(server_handshake_, config, now_fn);
+  const std::vector<std::uint8_t> payload(100, 0x5A);
+  for (const auto& packet : client.encrypt_data(payload, 0, false)) {
+    ASSERT_TRUE(server.decrypt_packet(packet).has_value());
+  }
+  steady_now_ += std::chrono::milliseconds(20);
+  client.process_ack(server.generate_ack(0));
+  // The RTT sample gives the controller a rate: DATA packets are spaced.
+  const auto burst = transport::TransportSessionConfig{}.congestion_config.max_pacing_burst;
+  transport::TransportSession::TimePoint departure{};
+  for (std::size_t i = 0; i < 2 * burst; ++i) {
+    departure = client.pace_packet(1200);
+  }
+  ASSERT_GT(departure, steady_now_);
+  steady_now_ += std::chrono::seconds(1);
+
+  // Datagrams never feed the controller: they leave as they come, and nothing backs up
+  // on the calendar.
+  negotiate(client, server);
+  ASSERT_TRUE(client.datagram_mode_active());
+
+  std::vector<std::uint8_t> ip_packet(1200, 0);
+  ip_packet[0] = 0x45;
+  for (int i = 0; i < 200; ++i) {
+    for (const auto& packet : client.queue_ip_packet(ip_packet)) {
+      EXPECT_EQ(client.pace_packet(packet.size()), steady_now_);
+    }
+  }
+  EXPECT_EQ(client.paced_backlog_bytes(), 0U);
+  EXPECT_FALSE(client.send_backlogged());
+}
+
+TEST_F(TransportSessionTest, PacedBacklogEngagesBackpressure) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSessionConfig config;
+  config.send_scheduler_config.backpressure_bytes = 12000;
+  transport::TransportSession client(client_handshake_, config, now_fn);
+  transport::TransportSession server(server_handshake_, config, now_fn);
+
+  const std::vector<std::uint8_t> payload(100, 0x5A);
+  for (const auto& packet : client.encrypt_data(payload, 0, false)) {
+    ASSERT_TRUE(server.decrypt_packet(packet).has_value());
+  }
+  steady_now_ += std::chrono::milliseconds(20);
+  client.process_ack(server.generate_ack(0));
+
+  // Departures pile up ahead of now: the calendar backlog pushes back like a full
+  // scheduler, although the scheduler holds nothing.
+  EXPECT_EQ(client.paced_backlog_bytes(), 0U);
+  while (!client.send_backlogged()) {
+    client.pace_packet(1200);
+    ASSERT_LT(client.paced_backlog_bytes(), 2U * 12000U);
+  }
+  EXPECT_EQ(client.scheduled_packets(), 0U);
+  EXPECT_GT(client.paced_backlog_bytes(), 12000U);
+
+  // Once the departures pass, it clears.
+  steady_now_ += std::chrono::seconds(1);
+  EXPECT_EQ(client.paced_backlog_bytes(), 0U);
+  EXPECT_FALSE(client.send_backlogged());
+}
+
+TEST_F(TransportSessionTest, CompactWireFormatNegotiation) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+  transport::TransportSessionConfig v1_config;
+  v1_config.compact_wire_format = false;
+  transport::TransportSession v1_client(client_handshake_, v1_config, now_fn);
+
+  const std::vector<std::uint8_t> payload(100, 0x5A);
+  const auto v1_size = v1_client.encrypt_data(payload, 0, false).front().size();
+
+  // A v1 packet sent before the switch, delivered late.
+  const auto late_v1 = server.encrypt_data(payload, 0, false).front();
+
+  auto offer = client.take_wire_format_frame();
+  ASSERT_TRUE(offer.has_value());
+  EXPECT_FALSE(client.take_wire_format_frame().has_value());
+  ASSERT_TRUE(server.decrypt_packet(client.encrypt_frames(std::vector<mux::MuxFrame>{*offer})).has_value());
+  EXPECT_EQ(server.wire_format(), mux::WireFormat::kV2);
+
+  // The server answers in v2; the client decodes it and switches too.
+  auto answer = server.take_wire_format_frame();
+  ASSERT_TRUE(answer.has_value());
+  ASSERT_TRUE(client.decrypt_packet(server.encrypt_frames(std::vector<mux::MuxFrame>{*answer})).has_value());
+  EXPECT_EQ(client.wire_format(), mux::WireFormat::kV2);
+  // Ours is offered again, in case the first was lost.
+  EXPECT_TRUE(client.take_wire_format_frame().has_value());
+
+  // 6 bytes of packet header and 8 of DATA header saved.
+  const auto packets = client.encrypt_data(payload, 0, false);
+  ASSERT_EQ(packets.size(), 1U);
+  EXPECT_LE(packets[0].size() + 14, v1_size);
+  auto frames = server.decrypt_packet(packets[0]);
+  ASSERT_TRUE(frames.has_value());
+  ASSERT_EQ(frames->size(), 1U);
+  EXPECT_EQ((*frames)[0].data.payload, payload);
+
+  // Replays are still caught, and v1 packets still accepted.
+  EXPECT_FALSE(server.decrypt_packet(packets[0]).has_value());
+  EXPECT_EQ(server.stats().packets_dropped_replay, 1U);
+  EXPECT_TRUE(client.decrypt_packet(late_v1).has_value());
+}
+
+TEST_F(TransportSessionTest, CompactHeaderWidensUntilAcked) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+  for (auto* side : {&client, &server}) {
+    auto* peer = side == &client ? &server : &client;
+    const std::vector<mux::MuxFrame> offer = {*side->take_wire_format_frame()};
+    ASSERT_TRUE(peer->decrypt_packet(side->encrypt_frames(offer)).has_value());
+  }
+  ASSERT_EQ(client.wire_format(), mux::WireFormat::kV2);
+
+  const std::vector<mux::MuxFrame> heartbeat = {mux::make_ack_frame(0, 0, 0)};
+  const auto small = client.encrypt_frames(heartbeat);
+  ASSERT_TRUE(server.decrypt_packet(small).has_value());
+
+  // Nothing acknowledged: past 2^13 packets the 14-bit sequence cannot be decoded
+  // unambiguously any more, so the header grows a byte.
+  for (int i = 0; i < 8200; ++i) {
+    client.encrypt_frames(heartbeat);
+  }
+  const auto wide = client.encrypt_frames(heartbeat);
+  EXPECT_EQ(wide.size(), small.size() + 1);
+  ASSERT_TRUE(server.decrypt_packet(wide).has_value());
+
+  // Once the peer acknowledges, it shrinks back.
+  mux::AckRangesFrame ack;
+  ack.ranges = {{8201, 8202}};
+  client.process_ack(ack);
+  EXPECT_EQ(client.encrypt_frames(heartbeat).size(), small.size());
+}
+
+namespace {
+
+// IPv4 UDP packet 10.0.0.2:5004 -> 10.0.0.1:5004 with a valid UDP checksum (IP header
+// checksum left zero: the decompressor recomputes it, so compare from byte 12 on).
+std::vector<std::uint8_t> rtp_like_packet(std::uint16_t ip_id) {
+  std::vector<std::uint8_t> packet = {0x45, 0, 0, 0, static_cast<std::uint8_t>(ip_id >> 8),
+                                      static_cast<std::uint8_t>(ip_id), 0x40, 0, 64, 17, 0, 0,
+                                      10, 0, 0, 2, 10, 0, 0, 1,
+                                      0x13, 0x8C, 0x13, 0x8C, 0, 0, 0, 0};
+  packet.resize(28 + 160, 0x55);
+  packet[3] = static_cast<std::uint8_t>(packet.size());
+  packet[2] = static_cast<std::uint8_t>(packet.size() >> 8);
+  packet[25] = static_cast<std::uint8_t>(packet.size() - 20);
+  auto sum = static_cast<std::uint32_t>(0x0A00 + 0x0002 + 0x0A00 + 0x0001 + 17 + packet.size() - 20);
+  for (std::size_t i = 20; i < packet.size(); i += 2) {
+    sum += static_cast<std::uint32_t>(packet[i] << 8 | packet[i + 1]);
+  }
+  while ((sum >> 16) != 0) {
+    sum = (sum & 0xFFFF) + (sum >> 16);
+  }
+  packet[26] = static_cast<std::uint8_t>(~sum >> 8);
+  packet[27] = static_cast<std::uint8_t>(~sum);
+  return packet;
+}
+
+}  // namespace
+
+TEST_F(TransportSessionTest, HeaderCompressionNegotiation) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSessionConfig config;
+  config.datagram_mode = true;
+  config.enable_header_compression = true;
+  transport::TransportSession client(client_handshake_, config, now_fn);
+  transport::TransportSession server(server_handshake_, config, now_fn);
+  negotiate(client, server);
+
+  // Not compressed before the peer's offer arrives.
+  const auto first = rtp_like_packet(1);
+  const auto plain = client.encrypt_ip_packet(first);
+  ASSERT_EQ(plain.size(), 1U);
+  EXPECT_FALSE(client.header_compression_active());
+
+  for (auto* side : {&client, &server}) {
+    auto* peer = side == &client ? &server : &client;
+    const std::vector<mux::MuxFrame> offer = {*side->take_header_compression_frame()};
+    ASSERT_TRUE(peer->decrypt_packet(side->encrypt_frames(offer)).has_value());
+  }
+  EXPECT_TRUE(client.header_compression_active());
+  EXPECT_TRUE(server.header_compression_active());
+
+  // Two refreshes set up the flow, then packets go out 22 bytes smaller.
+  std::vector<std::size_t> sizes;
+  for (std::uint16_t id = 2; id < 6; ++id) {
+    auto packet = rtp_like_packet(id);
+    const auto encrypted = client.encrypt_ip_packet(packet);
+    ASSERT_EQ(encrypted.size(), 1U);
+    sizes.push_back(encrypted[0].size());
+    auto frames = server.decrypt_packet(encrypted[0]);
+    ASSERT_TRUE(frames.has_value());
+    ASSERT_EQ(frames->size(), 1U);
+    const auto& delivered = (*frames)[0].datagram.payload;
+    ASSERT_EQ(delivered.size(), packet.size());
+    EXPECT_TRUE(std::equal(delivered.begin() + 12, delivered.end(), packet.begin() + 12));
+  }
+  EXPECT_EQ(sizes[0], plain[0].size() + 2);
+  EXPECT_EQ(sizes[3], plain[0].size() - 22);
+  EXPECT_EQ(server.header_decompressor_stats().packets_decompressed, 2U);
+  EXPECT_EQ(client.header_compressor_stats().refreshes, 2U);
+}
+
+TEST_F(TransportSessionTest, PayloadCompressionNegotiation) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSessionConfig config;
+  config.datagram_mode = true;
+  config.enable_payload_compression = true;
+  transport::TransportSession client(client_handshake_, config, now_fn);
+  transport::TransportSession server(server_handshake_, config, now_fn);
+  negotiate(client, server);
+
+  // Compressible: the RTP-like packet carries a run of one byte value.
+  const auto packet = rtp_like_packet(1);
+  const auto plain = client.encrypt_ip_packet(packet);
+  ASSERT_EQ(plain.size(), 1U);
+  EXPECT_FALSE(client.payload_compression_active());
+
+  for (auto* side : {&client, &server}) {
+    auto* peer = side == &client ? &server : &client;
+    const std::vector<mux::MuxFrame> offer = {*side->take_payload_compression_frame()};
+    ASSERT_TRUE(peer->decrypt_packet(side->encrypt_frames(offer)).has_value());
+  }
+  EXPECT_TRUE(client.payload_compression_active());
+  EXPECT_TRUE(server.payload_compression_active());
+
+  const auto encrypted = client.encrypt_ip_packet(packet);
+  ASSERT_EQ(encrypted.size(), 1U);
+  EXPECT_LT(encrypted[0].size(), plain[0].size() - 100);
+  auto frames = server.decrypt_packet(encrypted[0]);
+  ASSERT_TRUE(frames.has_value());
+  ASSERT_EQ(frames->size(), 1U);
+  EXPECT_EQ((*frames)[0].datagram.payload, packet);
+  EXPECT_EQ(client.payload_compressor_stats().packets_compressed, 1U);
+  EXPECT_EQ(server.payload_decompressor_stats().packets_decompressed, 1U);
+}
+
+TEST_F(TransportSessionTest, PathMtuProbeRaisesPayloadSize) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSessionConfig config;
+  config.datagram_mode = true;
+  config.enable_path_mtu_discovery = true;
+  transport::TransportSession client(client_handshake_, config, now_fn);
+  transport::TransportSession server(server_handshake_, config, now_fn);
+  negotiate(client, server);
+  EXPECT_EQ(client.path_mtu(), config.mtu);
+  EXPECT_EQ(client.max_payload_size(), config.max_fragment_size);
+
+  // The first probe is the largest size searched for, padded to it.
+  const auto probes = client.take_path_mtu_packets();
+  ASSERT_EQ(probes.size(), 1U);
+  EXPECT_EQ(probes[0].size(), config.path_mtu_config.max_size);
+  ASSERT_TRUE(server.decrypt_packet(probes[0]).has_value());
+
+  // The ack is queued like any control frame (the server's own first probe goes out
+  // alongside it).
+  auto acks = server.take_path_mtu_packets();
+  for (auto& packet : server.flush_packed()) {
+    acks.push_back(std::move(packet));
+  }
+  for (const auto& ack : acks) {
+    ASSERT_TRUE(client.decrypt_packet(ack).has_value());
+  }
+  EXPECT_EQ(client.path_mtu(), config.path_mtu_config.max_size);
+  EXPECT_EQ(client.max_payload_size(),
+            config.max_fragment_size + config.path_mtu_config.max_size - config.mtu);
+  EXPECT_EQ(client.path_mtu_stats().probes_acked, 1U);
+  // The server did not search: its own size is unchanged.
+  EXPECT_EQ(server.path_mtu(), config.mtu);
+
+  // A packet over max_fragment_size now goes as one datagram.
+  const std::vector<std::uint8_t> packet(config.max_fragment_size + 40, 0x45);
+  const auto encrypted = client.encrypt_ip_packet(packet);
+  ASSERT_EQ(encrypted.size(), 1U);
+  EXPECT_LE(encrypted[0].size(), client.path_mtu());
+  auto frames = server.decrypt_packet(encrypted[0]);
+  ASSERT_TRUE(frames.has_value());
+  ASSERT_EQ(frames->size(), 1U);
+  EXPECT_EQ((*frames)[0].datagram.payload, packet);
+}
+
+TEST_F(TransportSessionTest, ClampsTcpMssToPayloadSize) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSessionConfig config;
+  config.datagram_mode = true;
+  transport::TransportSession client(client_handshake_, config, now_fn);
+  transport::TransportSession server(server_handshake_, config, now_fn);
+  negotiate(client, server);
+
+  // IPv4 TCP SYN offering MSS 1460.
+  std::vector<std::uint8_t> syn(44, 0);
+  syn[0] = 0x45;
+  syn[9] = 6;
+  syn[32] = 0x60;
+  syn[33] = 0x02;
+  syn[40] = 2;
+  syn[41] = 4;
+  syn[42] = 0x05;
+  syn[43] = 0xB4;
+
+  const auto encrypted = client.encrypt_ip_packet(syn);
+  ASSERT_EQ(encrypted.size(), 1U);
+  auto frames = server.decrypt_packet(encrypted[0]);
+  ASSERT_TRUE(frames.has_value());
+  ASSERT_EQ(frames->size(), 1U);
+  const auto& received = (*frames)[0].datagram.payload;
+  ASSERT_EQ(received.size(), syn.size());
+  EXPECT_EQ(received[42] << 8 | received[43], config.max_fragment_size - mux::kMssOverheadIpv4);
+  EXPECT_EQ(client.stats().tcp_mss_clamped, 1U);
+}
+
+TEST_F(TransportSessionTest, SendSchedulerServesInteractiveFirstWhenWindowIsFull) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSessionConfig config;
+  config.datagram_mode = false;
+  transport::TransportSession client(client_handshake_, config, now_fn);
+  transport::TransportSession server(server_handshake_, config, now_fn);
+
+  const auto tcp_packet = [](std::size_t size, std::uint8_t port) {
+    std::vector<std::uint8_t> packet(size, 0);
+    packet[0] = 0x45;
+    packet[9] = 6;
+    packet[21] = 0xBB;
+    packet[23] = port;
+    return packet;
+  };
+
+  // A bulk transfer fills the congestion window, then backs up in the scheduler.
+  const auto bulk = tcp_packet(1200, 80);
+  std::vector<std::vector<std::uint8_t>> sent;
+  for (int i = 0; i < 1000 && client.scheduled_packets() < 10; ++i) {
+    for (auto& packet : client.queue_ip_packet(bulk)) {
+      sent.push_back(std::move(packet));
+    }
+  }
+  ASSERT_EQ(client.scheduled_packets(), 10U);
+  const auto ssh = tcp_packet(600, 22);
+  EXPECT_TRUE(client.queue_ip_packet(ssh).empty());
+  EXPECT_FALSE(client.has_packed_frames());
+
+  // ACKs open the window: the SSH packet goes within one scheduling round (the default
+  // class's 3000 bytes, and the packet that crosses it), ahead of the rest of the
+  // backlog.
+  for (const auto& packet : sent) {
+    ASSERT_TRUE(server.decrypt_packet(packet).has_value());
+  }
+  steady_now_ += 20ms;
+  client.process_ack(server.generate_ack_ranges(0));
+  EXPECT_TRUE(client.has_packed_frames());
+  const auto released = client.flush_packed();
+  ASSERT_GE(released.size(), 4U);
+  std::size_t position = released.size();
+  for (std::size_t i = 0; i < released.size(); ++i) {
+    auto frames = server.decrypt_packet(released[i]);
+    ASSERT_TRUE(frames.has_value());
+    if ((*frames)[0].data.payload == ssh) {
+      position = i;
+    }
+  }
+  EXPECT_LE(position, 3U);
+  EXPECT_EQ(client.send_scheduler_stats().packets_queued[0], 1U);
+}
+
+TEST_F(TransportSessionTest, SendSchedulerServesInteractiveFirstInDefaultDatagramMode) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+  negotiate(client, server);
+  ASSERT_TRUE(client.datagram_acks_active());
+
+  const auto tcp_packet = [](std::size_t size, std::uint8_t port) {
+    std::vector<std::uint8_t> packet(size, 0);
+    packet[0] = 0x45;
+    packet[9] = 6;
+    packet[21] = 0xBB;
+    packet[23] = port;
+    return packet;
+  };
+
+  // Bulk datagrams fill the window and back up in the scheduler, as DATA does.
+  const auto bulk = tcp_packet(1200, 80);
+  mux::AckScheduler receiver;
+  const auto deliver = [&](const std::vector<std::uint8_t>& packet) {
+    auto frames = server.decrypt_packet(packet);
+    EXPECT_TRUE(frames.has_value());
+    if (!frames.has_value()) {
+      return std::vector<std::uint8_t>{};
+    }
+    receiver.on_packet_received(mux::kDatagramStreamId, (*frames)[0].datagram.sequence);
+    return (*frames)[0].datagram.payload;
+  };
+  for (int i = 0; i < 1000 && client.scheduled_packets() < 10; ++i) {
+    for (const auto& packet : client.queue_ip_packet(bulk)) {
+      deliver(packet);
+    }
+  }
+  ASSERT_EQ(client.scheduled_packets(), 10U);
+  const auto ssh = tcp_packet(600, 22);
+  EXPECT_TRUE(client.queue_ip_packet(ssh).empty());
+
+  // Datagram ACKs open the window: the SSH packet goes as soon as the default class has
+  // spent its turn (the credit it had left plus 3000 bytes), ahead of the rest of the
+  // bulk backlog.
+  steady_now_ += 20ms;
+  auto ack = receiver.get_pending_ack(mux::kDatagramStreamId);
+  ASSERT_TRUE(ack.has_value());
+  client.process_ack(*ack);
+  const auto released = client.flush_packed();
+  ASSERT_GE(released.size(), 4U);
+  std::size_t position = released.size();
+  for (std::size_t i = 0; i < released.size(); ++i) {
+    if (deliver(released[i]) == ssh) {
+      position = i;
+    }
+  }
+  EXPECT_LE(position, 4U);
+  EXPECT_EQ(client.send_scheduler_stats().packets_queued[0], 1U);
+}
+
 }  // namespace veil::tests
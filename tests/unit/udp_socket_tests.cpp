@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <system_error>
 #include <thread>
+#include <vector>
 
 #ifdef _WIN32
 #include <winsock2.h>
@@ -60,6 +61,104 @@ TEST(UdpSocketTests, SendAndReceiveLoopback) {
   EXPECT_TRUE(received);
 }
 
+#ifndef _WIN32
+// Windows reports and sets ECN only from Windows 11 and Server 2022 on.
+TEST(UdpSocketTests, EcnFieldRoundTripsOnLoopback) {
+  transport::UdpSocket server;
+  transport::UdpSocket client;
+  std::error_code ec;
+  if (!server.open(0, false, ec) || !client.open(0, false, ec)) {
+    if (ec == std::errc::operation_not_permitted) {
+      GTEST_SKIP() << "UDP sockets not permitted in this environment";
+    }
+    FAIL() << ec.message();
+  }
+
+  transport::UdpEndpoint server_ep{"127.0.0.1", server.local_port()};
+  const std::vector<std::uint8_t> payload{1, 2, 3};
+  std::vector<std::uint8_t> received;
+  const auto receive = [&] {
+    received.clear();
+    server.poll([&](const transport::UdpPacket& pkt) { received.push_back(pkt.ecn); }, 100, ec);
+  };
+
+  ASSERT_TRUE(client.send(payload, server_ep, ec, 0x02)) << ec.message();
+  receive();
+  EXPECT_EQ(received, std::vector<std::uint8_t>{0x02});
+
+  ASSERT_TRUE(client.send(payload, server_ep, ec)) << ec.message();
+  receive();
+  EXPECT_EQ(received, std::vector<std::uint8_t>{0x00});
+
+  const std::vector<transport::UdpPacket> batch{{payload, server_ep, 0x01}};
+  ASSERT_TRUE(client.send_batch(batch, ec)) << ec.message();
+  receive();
+  EXPECT_EQ(received, std::vector<std::uint8_t>{0x01});
+}
+
+TEST(UdpSocketTests, TxtimeBatchIsDelivered) {
+  transport::UdpSocket server;
+  transport::UdpSocket client;
+  std::error_code ec;
+  if (!server.open(0, false, ec) || !client.open(0, false, ec)) {
+    if (ec == std::errc::operation_not_permitted) {
+      GTEST_SKIP() << "UDP sockets not permitted in this environment";
+    }
+    FAIL() << ec.message();
+  }
+  if (!client.enable_txtime(ec)) {
+    GTEST_SKIP() << "SO_TXTIME not supported: " << ec.message();
+  }
+  EXPECT_TRUE(client.txtime_enabled());
+
+  // Departures now and just ahead, each with an ECN mark: both control messages ride
+  // along. Loopback has no fq qdisc, so the times are accepted but not enforced.
+  transport::UdpEndpoint server_ep{"127.0.0.1", server.local_port()};
+  const auto now = std::chrono::steady_clock::now();
+  std::vector<transport::UdpPacket> batch{{{1}, server_ep, 0x02}, {{2}, server_ep, 0x02}};
+  batch[0].send_at = now;
+  batch[1].send_at = now + std::chrono::microseconds(500);
+  ASSERT_TRUE(client.send_batch(batch, ec)) << ec.message();
+
+  std::vector<std::uint8_t> received;
+  for (int i = 0; i < 5 && received.size() < 2; ++i) {
+    server.poll(
+        [&](const transport::UdpPacket& pkt) {
+          received.push_back(pkt.data[0]);
+          EXPECT_EQ(pkt.ecn, 0x02);
+        },
+        100, ec);
+  }
+  EXPECT_EQ(received, (std::vector<std::uint8_t>{1, 2}));
+
+  client.close();
+  EXPECT_FALSE(client.txtime_enabled());
+}
+#endif
+
+#ifdef IP_PMTUDISC_PROBE
+TEST(UdpSocketTests, DontFragmentOnlyWhenProbing) {
+  transport::UdpSocket socket;
+  std::error_code ec;
+  if (!socket.open(0, false, ec)) {
+    if (ec == std::errc::operation_not_permitted) {
+      GTEST_SKIP() << "UDP sockets not permitted in this environment";
+    }
+    FAIL() << ec.message();
+  }
+  const auto pmtu_mode = [&socket]() {
+    int mode = -1;
+    socklen_t len = sizeof(mode);
+    EXPECT_EQ(getsockopt(socket.fd(), IPPROTO_IP, IP_MTU_DISCOVER, &mode, &len), 0);
+    return mode;
+  };
+  ASSERT_TRUE(socket.set_dont_fragment(true, ec)) << ec.message();
+  EXPECT_EQ(pmtu_mode(), IP_PMTUDISC_PROBE);
+  ASSERT_TRUE(socket.set_dont_fragment(false, ec)) << ec.message();
+  EXPECT_EQ(pmtu_mode(), IP_PMTUDISC_WANT);
+}
+#endif
+
 TEST(UdpSocketTests, PollTimeout) {
   transport::UdpSocket socket;
   std::error_code ec;
@@ -3,6 +3,7 @@
 #include <array>
 #include <chrono>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -170,6 +171,48 @@ TEST(ZeroRttHandshakeTests, RateLimiterDropsExcessZeroRtt) {
   EXPECT_FALSE(result2.has_value());
 }
 
+TEST(ZeroRttHandshakeTests, SharedOpenInitDispatchesBothKindsOnOneToken) {
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  auto ticket_manager = std::make_shared<handshake::SessionTicketManager>(
+      std::chrono::milliseconds(60000), now_fn);
+  crypto::SessionKeys keys{};
+  keys.send_key.fill(0x11);
+  auto ticket = ticket_manager->issue_ticket(keys);
+
+  // One token per INIT (on a frozen clock): the 0-RTT path must not take a second one.
+  const auto frozen = std::chrono::steady_clock::now();
+  handshake::HandshakeResponder responder(
+      make_psk(), std::chrono::milliseconds(1000),
+      utils::TokenBucket(2.0, std::chrono::milliseconds(1000), [frozen] { return frozen; }),
+      now_fn);
+  handshake::ZeroRttResponder zero_rtt_responder(make_psk(), ticket_manager,
+                                                  std::chrono::milliseconds(1000),
+                                                  make_bucket(0.0), now_fn);
+
+  handshake::ZeroRttInitiator zero_rtt_initiator(make_psk(), ticket, now_fn);
+  const auto resumed_plaintext = responder.open_init(zero_rtt_initiator.create_zero_rtt_init());
+  ASSERT_TRUE(resumed_plaintext.has_value());
+  EXPECT_EQ(handshake::init_message_type(*resumed_plaintext),
+            handshake::MessageType::kZeroRttInit);
+  auto resumed = zero_rtt_responder.handle_decrypted_zero_rtt_init(*resumed_plaintext);
+  ASSERT_TRUE(resumed.has_value());
+  EXPECT_TRUE(resumed->accepted);
+
+  handshake::HandshakeInitiator initiator(make_psk(), std::chrono::milliseconds(1000), now_fn);
+  const auto plaintext = responder.open_init(initiator.create_init());
+  ASSERT_TRUE(plaintext.has_value());
+  EXPECT_EQ(handshake::init_message_type(*plaintext), handshake::MessageType::kInit);
+  EXPECT_FALSE(zero_rtt_responder.handle_decrypted_zero_rtt_init(*plaintext).has_value());
+  auto result = responder.handle_decrypted_init(*plaintext);
+  ASSERT_TRUE(result.has_value());
+  EXPECT_TRUE(initiator.consume_response(result->response).has_value());
+
+  // Both tokens spent.
+  EXPECT_FALSE(responder.open_init(initiator.create_init()).has_value());
+}
+
 TEST(ZeroRttHandshakeTests, CorruptedZeroRttInitDropped) {
   auto now = std::chrono::system_clock::now();
   auto now_fn = [&]() { return now; };
@@ -446,11 +489,14 @@ TEST(ZeroRttHandshakeTests, ClientAndServerHaveMatchingFreshNonces) {
 
   const auto& server_session = zero_rtt_result->session;
 
-  // Client and server must agree on the fresh nonces for communication to work
-  EXPECT_EQ(client_session->keys.send_nonce, server_session.keys.send_nonce)
-      << "Client and server must derive identical send_nonce";
-  EXPECT_EQ(client_session->keys.recv_nonce, server_session.keys.recv_nonce)
-      << "Client and server must derive identical recv_nonce";
+  // Client and server must agree on the fresh nonces for communication to work:
+  // what the client sends with, the server receives with.
+  EXPECT_EQ(client_session->keys.send_nonce, server_session.keys.recv_nonce)
+      << "Server must receive with the client's fresh send_nonce";
+  EXPECT_EQ(client_session->keys.recv_nonce, server_session.keys.send_nonce)
+      << "Server must send with the client's fresh recv_nonce";
+  EXPECT_EQ(client_session->keys.send_key, server_session.keys.recv_key);
+  EXPECT_EQ(client_session->keys.recv_key, server_session.keys.send_key);
 }
 
 TEST(ZeroRttHandshakeTests, TwoResumptionsProduceDifferentNonces) {
@@ -571,4 +617,144 @@ TEST(ZeroRttHandshakeTests, DeriveResumedNoncesDiffersWithSessionId) {
   EXPECT_NE(result1.recv_nonce, result2.recv_nonce);
 }
 
+// =============================================================================
+// 0-RTT Early Data Tests
+// =============================================================================
+
+namespace {
+struct ResumableSession {
+  handshake::SessionTicket ticket;
+  std::shared_ptr<handshake::SessionTicketManager> manager;
+};
+
+ResumableSession make_resumable_session(
+    const std::function<std::chrono::system_clock::time_point()>& now_fn) {
+  handshake::HandshakeInitiator initiator(make_psk(), std::chrono::milliseconds(1000), now_fn);
+  handshake::HandshakeResponder responder(make_psk(), std::chrono::milliseconds(1000),
+                                          make_bucket(), now_fn);
+  auto resp = responder.handle_init(initiator.create_init());
+  EXPECT_TRUE(resp.has_value());
+  auto session = initiator.consume_response(resp->response);
+  EXPECT_TRUE(session.has_value());
+
+  ResumableSession out;
+  out.manager = std::make_shared<handshake::SessionTicketManager>(
+      std::chrono::milliseconds(60000), now_fn);
+  // The server issues tickets from its own keys, reversed into the client's view.
+  out.ticket = out.manager->issue_ticket(handshake::reverse_session_keys(resp->session.keys));
+  EXPECT_EQ(out.ticket.cached_keys.send_key, session->keys.send_key);
+  return out;
+}
+}  // namespace
+
+TEST(ZeroRttHandshakeTests, EarlyDataDeliveredOnAccept) {
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+  auto resumable = make_resumable_session(now_fn);
+
+  const std::vector<std::vector<std::uint8_t>> packets{
+      std::vector<std::uint8_t>(60, 0x45), std::vector<std::uint8_t>(120, 0x46)};
+
+  handshake::ZeroRttInitiator initiator(make_psk(), resumable.ticket, now_fn);
+  handshake::ZeroRttResponder responder(make_psk(), resumable.manager,
+                                        std::chrono::milliseconds(1000), make_bucket(), now_fn);
+
+  const auto init = initiator.create_zero_rtt_init(packets);
+  EXPECT_EQ(initiator.early_data_packets(), 2U);
+
+  auto result = responder.handle_zero_rtt_init(init);
+  ASSERT_TRUE(result.has_value());
+  ASSERT_TRUE(result->accepted);
+  EXPECT_EQ(result->early_data, packets);
+
+  auto session = initiator.consume_zero_rtt_response(result->response);
+  ASSERT_TRUE(session.has_value());
+  EXPECT_EQ(session->keys.send_key, result->session.keys.recv_key);
+  EXPECT_EQ(session->keys.send_nonce, result->session.keys.recv_nonce);
+}
+
+TEST(ZeroRttHandshakeTests, EarlyDataNotDeliveredOnReject) {
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+  auto resumable = make_resumable_session(now_fn);
+
+  // A server that never issued this ticket (e.g. restarted without persisted keys).
+  auto other_manager = std::make_shared<handshake::SessionTicketManager>(
+      std::chrono::milliseconds(60000), now_fn);
+  handshake::ZeroRttInitiator initiator(make_psk(), resumable.ticket, now_fn);
+  handshake::ZeroRttResponder responder(make_psk(), other_manager,
+                                        std::chrono::milliseconds(1000), make_bucket(), now_fn);
+
+  const std::vector<std::vector<std::uint8_t>> packets{std::vector<std::uint8_t>(80, 0x45)};
+  auto result = responder.handle_zero_rtt_init(initiator.create_zero_rtt_init(packets));
+  ASSERT_TRUE(result.has_value());
+  EXPECT_FALSE(result->accepted);
+  EXPECT_TRUE(result->early_data.empty());
+  EXPECT_FALSE(initiator.consume_zero_rtt_response(result->response).has_value());
+  EXPECT_TRUE(initiator.was_rejected());
+}
+
+TEST(ZeroRttHandshakeTests, EarlyDataLimitedToBudget) {
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+  auto resumable = make_resumable_session(now_fn);
+
+  // 300 + 2 fits, 300 + 2 more does not; later packets are not reordered in.
+  const std::vector<std::vector<std::uint8_t>> packets{
+      std::vector<std::uint8_t>(300, 0x01), std::vector<std::uint8_t>(300, 0x02),
+      std::vector<std::uint8_t>(10, 0x03)};
+
+  handshake::ZeroRttInitiator initiator(make_psk(), resumable.ticket, now_fn);
+  handshake::ZeroRttResponder responder(make_psk(), resumable.manager,
+                                        std::chrono::milliseconds(1000), make_bucket(), now_fn);
+
+  auto result = responder.handle_zero_rtt_init(initiator.create_zero_rtt_init(packets));
+  EXPECT_EQ(initiator.early_data_packets(), 1U);
+  ASSERT_TRUE(result.has_value());
+  ASSERT_TRUE(result->accepted);
+  ASSERT_EQ(result->early_data.size(), 1U);
+  EXPECT_EQ(result->early_data[0], packets[0]);
+}
+
+TEST(ZeroRttHandshakeTests, ReplayedInitDoesNotRedeliverEarlyData) {
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+  auto resumable = make_resumable_session(now_fn);
+
+  handshake::ZeroRttInitiator initiator(make_psk(), resumable.ticket, now_fn);
+  handshake::ZeroRttResponder responder(make_psk(), resumable.manager,
+                                        std::chrono::milliseconds(1000), make_bucket(), now_fn);
+
+  const std::vector<std::vector<std::uint8_t>> packets{std::vector<std::uint8_t>(40, 0x45)};
+  const auto init = initiator.create_zero_rtt_init(packets);
+  auto first = responder.handle_zero_rtt_init(init);
+  ASSERT_TRUE(first.has_value());
+  EXPECT_EQ(first->early_data.size(), 1U);
+
+  auto replay = responder.handle_zero_rtt_init(init);
+  if (replay.has_value()) {
+    EXPECT_FALSE(replay->accepted);
+    EXPECT_TRUE(replay->early_data.empty());
+  }
+}
+
+TEST(ZeroRttHandshakeTests, TicketMessageRoundTrip) {
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+  auto resumable = make_resumable_session(now_fn);
+
+  const auto body = handshake::encode_ticket_message(resumable.ticket);
+  auto decoded =
+      handshake::decode_ticket_message(body, resumable.ticket.cached_keys, 1234);
+  ASSERT_TRUE(decoded.has_value());
+  EXPECT_EQ(decoded->ticket_data, resumable.ticket.ticket_data);
+  EXPECT_EQ(decoded->lifetime_ms, resumable.ticket.lifetime_ms);
+  EXPECT_EQ(decoded->issued_at_ms, 1234U);
+  EXPECT_EQ(decoded->cached_keys.send_key, resumable.ticket.cached_keys.send_key);
+
+  const std::vector<std::uint8_t> truncated(body.begin(), body.begin() + 8);
+  EXPECT_FALSE(
+      handshake::decode_ticket_message(truncated, resumable.ticket.cached_keys, 1234).has_value());
+}
+
 }  // namespace veil::tests